@@ -0,0 +1,583 @@
+/*
+===============================================================================
+   SQUARED — API REST JSON (modalità STA)
+   Endpoint letti dalla dashboard lato browser (web/home.js) e dal form
+   impostazioni (web/settings.js):
+
+     • GET   /api/state    stato runtime, tempi di boot, modalità notte,
+                           pagine con età dei dati, dati correnti di ogni
+                           pagina, metriche (heap, RSSI, traffico HTTP)
+     • GET   /api/config   configurazione con le stesse chiavi del form
+                           (i segreti compaiono solo come "impostato")
+     • PATCH /api/config   oggetto JSON con le sole chiavi da cambiare;
+                           risponde con la configurazione aggiornata
+     • GET   /events       Server-Sent Events: un campione JSON ogni
+                           ?ms=250..10000 (default 1000) con heap, RSSI,
+                           pagina ed eventi dall'anello metriche
+
+   Serializzazione con JsonWriter (chunked, buffer fisso) da una copia
+   delle globali presa sotto StateLock: nessun documento JSON costruito
+   in RAM, lock rilasciato prima di scrivere sul socket.
+
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+*/
+
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <esp_timer.h>
+#include <new>
+#include <lwip/sockets.h>
+#include "handlers/globals.h"
+#include "handlers/jsonwriter.h"
+#include "handlers/metrics.h"
+
+extern AsyncWeb web;
+extern uint32_t g_fetchMs[PAGES];
+extern uint32_t lastPageSwitch;
+
+// Valore massimo di una chiave in PATCH (URL ICS/RSS, post-it)
+static constexpr size_t API_VAL_MAX = 768;
+
+// "p_WEATHER" → "WEATHER"
+static inline const char* apiPageKey(int i) {
+  return PAGE_KEYS[i] + 2;
+}
+
+static void apiError(int code, const char* err, const char* key) {
+  HtmlWriter w(web);
+  w.begin(code, "application/json");
+  JsonWriter j(w);
+  j.obj();
+  j.key("error").str(err);
+  if (key) j.key("key").str(key);
+  j.endObj();
+  w.end();
+}
+
+/* ---------------------------------------------------------------------------
+   GET /api/state
+
+   Globali e dati pagina copiati in api_snap sotto StateLock, poi
+   web.unlock(): il JSON va sul socket a lock rilasciato
+--------------------------------------------------------------------------- */
+struct ApiSnap {
+  uint32_t now, shown, pageMs;
+  int page;
+  bool synced, approx;
+  BootTimes boot;
+  const char* wlState;
+  uint16_t wlDrops;
+  uint8_t wlFails, wlReason;
+  bool wlCached;
+  bool night, nightIn, nightPs;
+  uint8_t backlight;
+  uint32_t wake;
+  uint32_t lyHits, lyMisses, lyRenders;
+  bool show[PAGES];
+  uint32_t fetchMs[PAGES];
+
+  float temp;
+  String desc;
+  float aq[4];
+  float price, chg24;
+  double owned;
+  String fiat;
+  double fx[8];  // stesso ordine di API_FX
+  String qText, qAuthor;
+  bool qAi;
+  char rise[6], set[6], len[16];
+  float t24[24];
+  String news[NEWS_MAX];
+  IcsEntry cal[CAL_MAX];
+  uint8_t calN;
+  HAEntry ha[HA_MAX_ENTRIES];
+  uint8_t haN;
+  String note;
+};
+
+static const char* const API_FX[8] = { "CHF", "EUR", "USD", "GBP", "JPY", "CAD", "CNY", "INR" };
+
+// In PSRAM alla prima richiesta, poi riusata (un handler per volta)
+static ApiSnap* api_snap = nullptr;
+
+static void apiSnap(ApiSnap& s) {
+  s.now = millis();
+  s.shown = s.now - lastPageSwitch;
+  s.pageMs = PAGE_INTERVAL_MS;
+  s.page = g_page;
+  s.synced = g_timeSynced;
+  s.approx = g_timeApprox;
+  s.boot = g_boot;
+
+  s.wlState = wlStateName();
+  s.wlDrops = wl.drops;
+  s.wlFails = wl.fails;
+  s.wlReason = wl_reason;
+  s.wlCached = wl.cached;
+
+  s.night = nmNight();
+  s.nightIn = nm_in;
+  s.nightPs = nm_ps;
+  s.backlight = nmBacklight();
+  s.wake = nm_wake;
+
+  s.lyHits = ly_hits;
+  s.lyMisses = ly_misses;
+  s.lyRenders = ly_renders;
+
+  for (int i = 0; i < PAGES; i++) {
+    s.show[i] = g_show[i];
+    s.fetchMs[i] = g_fetchMs[i];
+  }
+
+  s.temp = w_now_tempC;
+  s.desc = w_now_desc;
+  memcpy(s.aq, aq_val, sizeof(s.aq));
+  s.price = cr_price;
+  s.chg24 = cr_chg24;
+  s.owned = g_btc_owned;
+  s.fiat = g_fiat;
+  const double fx[8] = { fx_chf, fx_eur, fx_usd, fx_gbp, fx_jpy, fx_cad, fx_cny, fx_inr };
+  memcpy(s.fx, fx, sizeof(s.fx));
+  s.qText = qod_text;
+  s.qAuthor = qod_author;
+  s.qAi = qod_from_ai;
+  memcpy(s.rise, sun_rise, sizeof(s.rise));
+  memcpy(s.set, sun_set, sizeof(s.set));
+  memcpy(s.len, sun_len, sizeof(s.len));
+  memcpy(s.t24, t24, sizeof(s.t24));
+  for (uint8_t i = 0; i < NEWS_MAX; i++) s.news[i] = news_title[i];
+  s.calN = cal_count;
+  memcpy(s.cal, cal, cal_count * sizeof(IcsEntry));
+  s.haN = ha_count;
+  memcpy(s.ha, ha_entries, ha_count * sizeof(HAEntry));
+  s.note = g_note;
+}
+
+static void apiStateData(JsonWriter& j, const ApiSnap& s) {
+  j.key("weather").obj();
+  j.key("temp").num(s.temp, 1);
+  j.key("desc").str(s.desc);
+  j.endObj();
+
+  j.key("air").obj();
+  j.key("pm25").num(s.aq[0], 1);
+  j.key("pm10").num(s.aq[1], 1);
+  j.key("o3").num(s.aq[2], 1);
+  j.key("no2").num(s.aq[3], 1);
+  j.endObj();
+
+  j.key("btc").obj();
+  j.key("price").num(s.price, 2);
+  j.key("chg24").num(s.chg24, 2);
+  j.key("owned").num(s.owned, 8);
+  j.endObj();
+
+  j.key("fx").obj();
+  j.key("base").str(s.fiat);
+  for (uint8_t i = 0; i < 8; i++) j.key(API_FX[i]).num(s.fx[i], 4);
+  j.endObj();
+
+  j.key("qod").obj();
+  j.key("text").str(s.qText);
+  j.key("author").str(s.qAuthor);
+  j.key("ai").boolean(s.qAi);
+  j.endObj();
+
+  j.key("sun").obj();
+  j.key("rise").str(s.rise);
+  j.key("set").str(s.set);
+  j.key("length").str(s.len);
+  j.endObj();
+
+  j.key("t24").arr();
+  for (uint8_t i = 0; i < 24; i++) j.num(s.t24[i], 1);
+  j.endArr();
+
+  j.key("news").arr();
+  for (uint8_t i = 0; i < NEWS_MAX; i++)
+    if (s.news[i].length()) j.str(s.news[i]);
+  j.endArr();
+
+  j.key("cal").arr();
+  for (uint8_t i = 0; i < s.calN; i++) {
+    j.obj();
+    j.key("start").num((long)s.cal[i].start);
+    j.key("all_day").boolean(s.cal[i].allDay);
+    j.key("summary").str(s.cal[i].summary);
+    j.endObj();
+  }
+  j.endArr();
+
+  j.key("ha").arr();
+  for (uint8_t i = 0; i < s.haN; i++) {
+    j.obj();
+    j.key("name").str(s.ha[i].name);
+    j.key("state").str(s.ha[i].state);
+    j.endObj();
+  }
+  j.endArr();
+
+  j.key("note").str(s.note);
+}
+
+static void handleApiState() {
+  if (!api_snap) {
+    void* p = heap_caps_malloc(sizeof(ApiSnap), MALLOC_CAP_SPIRAM);
+    if (!p) {
+      apiError(503, "no_memory", nullptr);
+      return;
+    }
+    api_snap = new (p) ApiSnap();
+  }
+  apiSnap(*api_snap);
+  web.unlock();
+  const ApiSnap& s = *api_snap;
+
+  HtmlWriter w(web);
+  w.begin(200, "application/json");
+  JsonWriter j(w);
+
+  j.obj();
+  j.key("fw").str(FW_VERSION);
+  j.key("uptime").num((long)(s.now / 1000));
+  if (s.synced || s.approx) j.key("time").num((long)time(nullptr));
+  else j.key("time").null();
+  j.key("time_approx").boolean(s.approx);
+  j.key("page").str(apiPageKey(s.page));
+  j.key("next_s").num((long)(s.shown < s.pageMs ? (s.pageMs - s.shown) / 1000 : 0));
+
+  // --- Tempi di boot (ms dal reset, null = non ancora) ---
+  j.key("boot").obj();
+  const uint32_t bt[4] = { s.boot.firstFrame, s.boot.wifi, s.boot.time, s.boot.fresh };
+  static const char* const BK[4] = { "first_frame_ms", "wifi_ms", "time_ms", "fresh_ms" };
+  for (uint8_t i = 0; i < 4; i++) {
+    j.key(BK[i]);
+    if (bt[i]) j.num((long)bt[i]);
+    else j.null();
+  }
+  j.endObj();
+
+  // --- Wi-Fi: stato della riconnessione ---
+  j.key("wifi").obj();
+  j.key("state").str(s.wlState);
+  j.key("drops").num((long)s.wlDrops);
+  j.key("fails").num((long)s.wlFails);
+  j.key("reason").num((long)s.wlReason);
+  j.key("cached").boolean(s.wlCached);
+  j.endObj();
+
+  // --- Modalità notte ---
+  j.key("night").obj();
+  j.key("active").boolean(s.night);
+  j.key("window").boolean(s.nightIn);
+  j.key("backlight").num((long)s.backlight);
+  j.key("modem_sleep").boolean(s.nightPs);
+  j.key("wake_s");  // secondi di sveglia da tocco rimasti
+  if (s.wake && (int32_t)(s.wake - s.now) > 0) j.num((long)((s.wake - s.now) / 1000));
+  else j.null();
+  j.endObj();
+
+  // --- Metriche ---
+  j.key("metrics").obj();
+  j.key("heap").num((long)ESP.getFreeHeap());
+  j.key("heap_min").num((long)ESP.getMinFreeHeap());
+  j.key("psram").num((long)ESP.getFreePsram());
+  j.key("rssi").num((long)WiFi.RSSI());
+  j.key("http_wire").num((long)http_wireBytes);
+  j.key("http_body").num((long)http_bodyBytes);
+  j.key("touch_reads").num((long)touch_reads.load());
+  j.key("touch_dropped").num((long)touch_q.dropped);
+  j.key("layer_hits").num((long)s.lyHits);
+  j.key("layer_misses").num((long)s.lyMisses);
+  j.key("layer_renders").num((long)s.lyRenders);
+  j.endObj();
+
+  // --- Pagine: attive + età dell'ultimo fetch riuscito (null = mai) ---
+  j.key("pages").arr();
+  for (int i = 0; i < PAGES; i++) {
+    j.obj();
+    j.key("key").str(apiPageKey(i));
+    j.key("on").boolean(s.show[i]);
+    if (s.fetchMs[i]) j.key("age").num((long)((s.now - s.fetchMs[i]) / 1000));
+    else j.key("age").null();
+    j.endObj();
+  }
+  j.endArr();
+
+  // --- Dati correnti delle pagine ---
+  j.key("data").obj();
+  apiStateData(j, s);
+  j.endObj();
+
+  j.endObj();
+  w.end();
+}
+
+/* ---------------------------------------------------------------------------
+   GET / PATCH /api/config
+--------------------------------------------------------------------------- */
+static void sendApiConfig() {
+  CfgSnap c;
+  cfgSnap(c);
+  web.unlock();
+
+  HtmlWriter w(web);
+  w.begin(200, "application/json");
+  JsonWriter j(w);
+
+  j.obj();
+  j.key("city").str(c.city);
+  j.key("lang").str(c.lang);
+  j.key("ics").str(c.ics);
+  j.key("page_s").num((long)(c.pageMs / 1000));
+  j.key("note").str(c.note);
+  j.key("fiat").str(c.fiat);
+  j.key("ha_ip").str(c.haIp);
+  j.key("ha_ents").str(c.haEnts);
+  j.key("btc_owned").num(c.btc, 8);
+  j.key("openai_topic").str(c.oaTopic);
+  j.key("rss_url").str(c.rss);
+  j.key("splash_enabled").boolean(c.splash);
+  j.key("night_enabled").boolean(c.night.on);
+  j.key("night_from").num((long)c.night.from);
+  j.key("night_to").num((long)c.night.to);
+  j.key("night_dim").num((long)c.night.dim);
+  j.key("night_ramp").num((long)c.night.ramp);
+
+  // Segreti: solo scrivibili
+  j.key("secrets").obj();
+  j.key("ha_token").boolean(c.haToken.length() > 0);
+  j.key("openai_key").boolean(c.oaKey.length() > 0);
+  j.endObj();
+
+  char k[6];
+  for (int i = 0; i < 8; i++) {
+    snprintf(k, sizeof(k), "cd%dn", i + 1);
+    j.key(k).str(c.cd[i].name);
+    snprintf(k, sizeof(k), "cd%dt", i + 1);
+    j.key(k).str(c.cd[i].whenISO);
+  }
+
+  for (int i = 0; i < PAGES; i++)
+    j.key(PAGE_KEYS[i]).boolean(c.show[i]);
+
+  j.endObj();
+  w.end();
+}
+
+// Chiave successiva dell'oggetto PATCH in k (false a fine oggetto / errore)
+static bool apiNextKey(JsonPull& jp, char* k, size_t cap, bool& bad) {
+  const JsonTok t = jp.next();
+  if (t == JT_OBJ_END) return false;
+  if (t != JT_KEY || jp.len >= cap) {
+    bad = true;
+    return false;
+  }
+  memcpy(k, jp.tok, jp.len);
+  k[jp.len] = 0;
+  return true;
+}
+
+// Valore scalare → testo come dal form: stringhe decodificate, numeri così
+// come sono, true → "1", false / null → ""
+static bool apiValue(JsonPull& jp, char* out, size_t cap) {
+  const JsonTok t = jp.next();
+  out[0] = 0;
+  if (t == JT_STR) {
+    jsonUnescape(jp.tok, jp.len, out, cap);
+    return true;
+  }
+  if (t == JT_NUM && jp.len < cap) {
+    memcpy(out, jp.tok, jp.len);
+    out[jp.len] = 0;
+    return true;
+  }
+  if (t == JT_LIT) {
+    if (jp.len == 4 && !memcmp(jp.tok, "true", 4)) strcpy(out, "1");
+    return true;
+  }
+  return false;
+}
+
+static void handleApiConfigPatch() {
+  static char val[API_VAL_MAX];
+  const String& body = web.arg("plain");
+  char k[16];
+  bool bad = false;
+
+  // 1) validazione: oggetto piatto, chiavi note, valori scalari
+  JsonPull jp(body);
+  if (jp.next() != JT_OBJ) {
+    apiError(400, "expected_object", nullptr);
+    return;
+  }
+  while (apiNextKey(jp, k, sizeof(k), bad)) {
+    if (cfgFind(k) < 0) {
+      apiError(400, "unknown_key", k);
+      return;
+    }
+    if (!apiValue(jp, val, sizeof(val))) {
+      apiError(400, "bad_value", k);
+      return;
+    }
+  }
+  if (bad) {
+    apiError(400, "bad_json", nullptr);
+    return;
+  }
+
+  // 2) applicazione: tutto o niente
+  uint8_t res = 0;
+  JsonPull ap(body);
+  ap.next();
+  while (apiNextKey(ap, k, sizeof(k), bad)) {
+    apiValue(ap, val, sizeof(val));
+    res |= cfgSet(cfgFind(k), val);
+  }
+
+  if (res) cfgCommit(res & CFG_REFETCH);
+  sendApiConfig();
+}
+
+/* ---------------------------------------------------------------------------
+   GET /events (Server-Sent Events)
+
+   Il socket esce dal ciclo richiesta/risposta (web.detach) e resta al
+   task del server: un esp_timer accoda ssePush ogni SSE_TICK_MS, che per
+   ogni client in scadenza compone il campione nel buffer fisso sse_buf e
+   lo invia con send() non bloccante. Invio parziale o buffer TCP pieno
+   (client che non legge) → socket chiuso subito; client spariti senza
+   FIN → keepalive TCP di pochi secondi.
+
+   data:{"t":…,"heap":…,"heap_min":…,"psram":…,"rssi":…,"page":"CLOCK",
+         "ev":[["f","CLOCK",1830,120],["x","AIR",640,3100],…],"lost":0}
+
+   ev: [tipo, chiave, valore, età ms]   f = disegno pagina (µs)
+                                         x = fetch (ms, negativo = fallito)
+                                         p = cambio pagina
+                                         h = handler web (ms, chiave = URI)
+--------------------------------------------------------------------------- */
+static constexpr uint8_t SSE_MAX = 2;     // httpd ha 5 socket in tutto
+static constexpr uint32_t SSE_TICK_MS = 250;
+static constexpr size_t SSE_BUF = 1024;
+
+struct SseClient {
+  int fd;         // -1 = libero
+  uint16_t every; // ms fra due campioni
+  uint32_t next;
+  uint32_t tail;  // prossimo evento da leggere nell'anello
+};
+
+// Toccati solo dal task del server (handler, lavori accodati, close_fn)
+static SseClient sse[SSE_MAX];
+static char sse_buf[SSE_BUF];
+static esp_timer_handle_t sse_timer = nullptr;
+static volatile uint8_t sse_count = 0;
+
+static void sseFree(uint8_t i) {
+  if (sse[i].fd < 0) return;
+  sse[i].fd = -1;
+  sse_count--;
+}
+
+static void ssePush(void*) {
+  const uint32_t now = millis();
+  for (uint8_t i = 0; i < SSE_MAX; i++) {
+    SseClient& c = sse[i];
+    if (c.fd < 0 || (int32_t)(now - c.next) < 0) continue;
+    c.next = now + c.every;
+
+    size_t n = snprintf(sse_buf, SSE_BUF,
+                        "data:{\"t\":%lu,\"heap\":%lu,\"heap_min\":%lu,"
+                        "\"psram\":%lu,\"rssi\":%d,\"page\":\"%s\",\"ev\":[",
+                        (unsigned long)now, (unsigned long)ESP.getFreeHeap(),
+                        (unsigned long)ESP.getMinFreeHeap(),
+                        (unsigned long)ESP.getFreePsram(), (int)WiFi.RSSI(),
+                        apiPageKey(g_page));
+
+    uint32_t skipped = 0;
+    bool first = true;
+    const uint32_t lost = metricDrain(c.tail, [&](MetricKind k, uint8_t id, int32_t v, uint32_t ms) {
+      if (n > SSE_BUF - 96) {  // spazio per l'evento più lungo e la chiusura
+        skipped++;
+        return;
+      }
+      const char* key = k == MK_HTTP ? web.routeUri(id)
+                        : id < PAGES ? apiPageKey(id) : "?";
+      n += snprintf(sse_buf + n, SSE_BUF - n, "%s[\"%c\",\"%.24s\",%ld,%lu]",
+                    first ? "" : ",", "fxph"[k], key, (long)v,
+                    (unsigned long)(now - ms));
+      first = false;
+    });
+    n += snprintf(sse_buf + n, SSE_BUF - n, "],\"lost\":%lu}\n\n",
+                  (unsigned long)(lost + skipped));
+
+    if (send(c.fd, sse_buf, n, MSG_DONTWAIT) != (int)n) {
+      web.drop(c.fd);
+      sseFree(i);
+    }
+  }
+}
+
+static void sseTick(void*) {
+  if (sse_count) web.queue(ssePush, nullptr);
+}
+
+static void handleEvents() {
+  int8_t slot = -1;
+  for (uint8_t i = 0; i < SSE_MAX && slot < 0; i++)
+    if (sse[i].fd < 0) slot = i;
+  if (slot < 0) {
+    web.send(503, "text/plain", "Troppi client su /events");
+    return;
+  }
+
+  long every = web.arg("ms").toInt();
+  if (!every) every = 1000;
+  every = constrain(every, 250L, 10000L);
+
+  const int fd = web.detach("HTTP/1.1 200 OK\r\n"
+                            "Content-Type: text/event-stream\r\n"
+                            "Cache-Control: no-store\r\n"
+                            "Connection: keep-alive\r\n\r\n"
+                            "retry: 3000\n\n");
+  if (fd < 0) return;
+
+  // client spariti senza chiudere (Wi-Fi spento): socket libero in ~10 s
+  int on = 1, idle = 5, intvl = 2, cnt = 2;
+  setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on));
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &intvl, sizeof(intvl));
+  setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &cnt, sizeof(cnt));
+
+  sse[slot].fd = fd;
+  sse[slot].every = every;
+  sse[slot].next = millis();
+  sse[slot].tail = metricHead();
+  sse_count++;
+
+  if (!sse_timer) {
+    esp_timer_create_args_t a = {};
+    a.callback = sseTick;
+    a.name = "sse";
+    if (esp_timer_create(&a, &sse_timer) == ESP_OK)
+      esp_timer_start_periodic(sse_timer, SSE_TICK_MS * 1000ULL);
+  }
+}
+
+static void registerApi() {
+  for (uint8_t i = 0; i < SSE_MAX; i++) sse[i].fd = -1;
+  web.onClose([](int fd) {
+    for (uint8_t i = 0; i < SSE_MAX; i++)
+      if (sse[i].fd == fd) sseFree(i);
+  });
+
+  web.on("/api/state", HTTP_GET, handleApiState);
+  web.on("/api/config", HTTP_GET, sendApiConfig);
+  web.on("/api/config", HTTP_PATCH, handleApiConfigPatch);
+  web.on("/events", HTTP_GET, handleEvents, false);
+}
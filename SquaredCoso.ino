@@ -12,11 +12,12 @@
 #include <Preferences.h>
 #include <WiFi.h>
 #include <WiFiClientSecure.h>
-#include <WebServer.h>
 #include <DNSServer.h>
 #include <HTTPClient.h>
 #include <Arduino_GFX_Library.h>
 #include <time.h>
+#include <sys/time.h>
+#include <esp_sntp.h>
 #include <math.h>
 
 // =============================================================================
@@ -25,13 +26,26 @@
 const char FW_NAME[] PROGMEM = "SquaredCoso";
 const char FW_VERSION[] PROGMEM = "b1.2.0";
 
-int indexOfCI(const String& src, const String& key, int from = 0);
+// Server di record/replay (tools/mock_api.py): decommentare per dirottare
+// tutte le richieste HTTP(S) verso il mock in LAN.
+// #define SQUARED_MOCK_API "192.168.1.50:8080"
+
+// IP statico in STA (ip,gateway,mask,dns): riconnessione senza DHCP.
+// #define SQUARED_STATIC_IP "192.168.1.60,192.168.1.1,255.255.255.0,192.168.1.1"
 
 // handlers
 #include "handlers/settingshandler.h"
 #include "handlers/displayhelpers.h"
 #include "handlers/jsonhelpers.h"
+#include "handlers/httpstream.h"
+#include "handlers/nightmode.h"
+#include "handlers/widgets.h"
 #include "handlers/touch_menu.h"
+#include "handlers/htmlwriter.h"
+#include "handlers/jsonwriter.h"
+#include "handlers/layers.h"
+#include "handlers/screencap.h"
+#include "handlers/wifilink.h"
 
 // immagini
 #include "images/SquaredCoso.h"
@@ -58,6 +72,9 @@ int indexOfCI(const String& src, const String& key, int from = 0);
 #include "pages/SquaredNotes.h"
 #include "pages/SquaredChronos.h"
 
+// snapshot dati (dopo le pagine: ne serializza lo stato)
+#include "handlers/snapshot.h"
+
 // =============================================================================
 // CONFIG APPLICAZIONE
 // =============================================================================
@@ -81,6 +98,7 @@ String g_lon;
 String g_rss_url = F("https://feeds.bbci.co.uk/news/rss.xml");
 String g_ha_ip;
 String g_ha_token;
+String g_ha_ents; // entity_id mostrati (vuoto = filtro automatico)
 String g_oa_key;
 String g_oa_topic;
 
@@ -100,44 +118,70 @@ bool g_show[PAGES] = {
 
 bool g_pageDirty[PAGES] = { false };
 
+// --- Ultimo fetch riuscito per pagina (millis, 0 = mai; per /api/state) -----
+uint32_t g_fetchMs[PAGES] = { 0 };
+
+// Esegue il fetch, ne registra latenza (metriche /events) ed esito
+// Chiamata senza StateLock: il fetch prende il lock solo per leggere la
+// configurazione e pubblicare i dati, mai attorno alla rete
+static bool noteFetch(uint8_t p, bool (*fetch)()) {
+  const uint32_t t0 = millis();
+  const bool ok = fetch();
+  const int32_t dt = millis() - t0;
+  StateLock lock;
+  metricPush(MK_FETCH, p, ok ? dt : -dt);
+  if (ok) {
+    g_fetchMs[p] = millis() | 1;
+    snapMark(p);
+    lyInvalidate(p);
+  }
+  return ok;
+}
+
 // --- Flag runtime (extern in altri file - DEVONO essere bool normali) --------
 volatile bool g_dataRefreshPending = false;
+volatile bool g_forceQodPending = false; // /force_qod → fetch + ridisegno nel loop
+volatile bool g_rebootPending = false;   // /reboot → riavvio dal loop
 bool g_splash_enabled = true;
 bool g_timeSynced = false;
+volatile bool g_timeApprox = false; // ora dal flash (snapshot), SNTP non ancora arrivato
+NightCfg g_night = { false, 23, 7, 15, 45 }; // 23–7, 15 %, rampe di 45 min
+
+// --- Boot a stadi ------------------------------------------------------------
+BootTimes g_boot = {};
 
 // --- Solo interni (non usati altrove) -----------------------------------
-static bool g_bootPhase = true;
 static int8_t lastSecond = -1;
 
 // =============================================================================
 // GEOCODING OPEN-METEO
 // =============================================================================
+// Fuori lock: la configurazione si legge e si aggiorna sotto StateLock,
+// la richiesta no
 bool geocodeIfNeeded() {
-  if (g_lat.length() && g_lon.length()) return true;
-
   String url = F("https://geocoding-api.open-meteo.com/v1/search?count=1&format=json&name=");
-  url += g_city;
-  url += F("&language=");
-  url += g_lang;
+  {
+    StateLock lock;
+    if (g_lat.length() && g_lon.length()) return true;
+    url += g_city;
+    url += F("&language=");
+    url += g_lang;
+  }
 
   String body;
   if (!httpGET(url, body, 10000)) return false;
 
-  int p = indexOfCI(body, F("\"latitude\""), 0);
-  if (p < 0) return false;
-  int c = body.indexOf(':', p);
-  int e = body.indexOf(',', c + 1);
-  g_lat = sanitizeText(body.substring(c + 1, e));
-
-  p = indexOfCI(body, F("\"longitude\""), 0);
-  if (p < 0) return false;
-  c = body.indexOf(':', p);
-  e = body.indexOf(',', c + 1);
-  g_lon = sanitizeText(body.substring(c + 1, e));
+  // testo numerico originale, senza passare da float
+  char lat[16], lon[16];
+  JsonQuery q[] = { jqStr("results[0].latitude", lat, sizeof(lat)),
+                    jqStr("results[0].longitude", lon, sizeof(lon)) };
+  if (jsonExtract(body, q, 2) != 2) return false;
 
-  if (!g_lat.length() || !g_lon.length()) return false;
+  StateLock lock;
+  g_lat = lat;
+  g_lon = lon;
 
-  saveAppConfig();
+  nvSave(NV_LAT, NV_LON + 1); // solo le coordinate
   return true;
 }
 
@@ -156,7 +200,7 @@ Arduino_ESP32RGBPanel* rgbpanel = new Arduino_ESP32RGBPanel(
   1, 10, 8, 20,
   0, 12000000, false, 0, 0, 0);
 
-Arduino_RGB_Display* gfx = new Arduino_RGB_Display(
+Arduino_RGB_Display* gfx = new SqRGBDisplay(
   480, 480, rgbpanel, 0, true, bus, GFX_NOT_DEFINED,
   st7701_type9_init_operations, sizeof(st7701_type9_init_operations));
 
@@ -203,26 +247,43 @@ static const char NTP_SERVER[] PROGMEM = "pool.ntp.org";
 static const long GMT_OFFSET_SEC = 3600;
 static const int DAYLIGHT_OFFSET_SEC = 3600;
 
-static bool waitForValidTime(uint16_t timeoutMs = 8000) {
-  uint32_t t0 = millis();
+// Ora approssimata (g_timeApprox) non conta: vale solo RTC o SNTP
+static bool timeIsValid() {
+  if (g_timeApprox) return false;
   time_t now;
   struct tm info;
+  time(&now);
+  localtime_r(&now, &info);
+  return info.tm_year + 1900 > 2020;
+}
 
-  while ((millis() - t0) < timeoutMs) {
-    time(&now);
-    localtime_r(&now, &info);
-    if (info.tm_year + 1900 > 2020) return true;
-    delay(100);
-  }
-  return false;
+// Risposta SNTP (task lwIP): da qui in poi l'ora è esatta
+static void onNtpSync(struct timeval* tv) {
+  g_timeApprox = false;
 }
 
-void syncTimeFromNTP() {
-  if (g_timeSynced) return;
+// Avvia SNTP (asincrono, gira nel task lwIP)
+static void startNTP() {
   char buf[20];
   strcpy_P(buf, NTP_SERVER);
+  sntp_set_time_sync_notification_cb(onNtpSync);
   configTime(GMT_OFFSET_SEC, DAYLIGHT_OFFSET_SEC, buf);
-  g_timeSynced = waitForValidTime(8000);
+}
+
+// Dopo un'interruzione di corrente l'RTC riparte dal 1970: orologio e
+// Chronos mostrano l'ultima ora salvata (snapshot o /clock.bin) finché
+// SNTP non risponde. Fuso come configTime() (offset in ore intere), che
+// qui non si può chiamare: la rete non è ancora pronta.
+static void seedClock() {
+  const uint32_t e = snapLastEpoch();
+  if (!e) return;
+  char tz[24];
+  snprintf(tz, sizeof(tz), "UTC%ldDST", -GMT_OFFSET_SEC / 3600);
+  setenv("TZ", tz, 1);
+  tzset();
+  struct timeval tv = { (time_t)e, 0 };
+  settimeofday(&tv, nullptr);
+  g_timeApprox = true;
 }
 
 // =============================================================================
@@ -230,7 +291,7 @@ void syncTimeFromNTP() {
 // =============================================================================
 Preferences prefs;
 DNSServer dnsServer;
-WebServer web(80);
+AsyncWeb web(80);
 
 String sta_ssid, sta_pass;
 String ap_ssid, ap_pass;
@@ -282,32 +343,18 @@ static void startAPWithPortal() {
 }
 
 // =============================================================================
-// CONNESSIONE STA
+// TRANSIZIONI (fade asincroni, vedi backlight.h)
 // =============================================================================
-static bool tryConnectSTA(uint16_t timeoutMs = 8000) {
-  prefs.begin("wifi", true);
-  sta_ssid = prefs.getString("ssid", "");
-  sta_pass = prefs.getString("pass", "");
-  prefs.end();
+// TR_PAGE: fade attorno a una pagina, il loop può disegnarla
+// TR_SCENE: a schermo splash o conferma, il loop non disegna pagine
+enum : uint8_t { TR_NONE, TR_PAGE, TR_SCENE };
+static uint8_t g_trans = TR_NONE;
 
-  if (sta_ssid.isEmpty()) return false;
-
-  WiFi.persistent(false);
-  WiFi.mode(WIFI_STA);
-  WiFi.setSleep(false);
-  WiFi.begin(sta_ssid.c_str(), sta_pass.c_str());
-
-  uint32_t t0 = millis();
-  while (WiFi.status() != WL_CONNECTED && (millis() - t0) < timeoutMs) {
-    delay(100);
-    yield();
-  }
-
-  return WiFi.status() == WL_CONNECTED;
+static void transEnd() {
+  g_trans = TR_NONE;
+  lastPageSwitch = millis();
 }
 
-bool httpGET(const String& url, String& body, uint32_t timeoutMs = 10000);
-
 // =============================================================================
 // SOFT REBOOT
 // =============================================================================
@@ -319,19 +366,27 @@ static void showSettingsOK() {
   gfx->print(F("Updating..."));
 }
 
-void softReboot() {
-  showSettingsOK();
-  delay(600);
-  quickFadeOut();
-
+static void softRebootDark() {
+  StateLock lock;
   ensureCurrentPageEnabled();
   g_page = firstEnabledPage();
-  lastPageSwitch = millis();
   g_dataRefreshPending = true;
+  lyInvalidateAll();
 
   gfx->fillScreen(COL_BG);
   drawCurrentPage();
-  quickFadeIn();
+  g_trans = TR_PAGE;
+  blFadeTo(nmBacklight(), BL_QUICK_MS, transEnd);
+}
+
+static void softRebootShown() {
+  blFadeTo(0, BL_QUICK_MS, softRebootDark);
+}
+
+void softReboot() {
+  g_trans = TR_SCENE;
+  showSettingsOK();
+  blHold(600, softRebootShown);
 }
 
 // =============================================================================
@@ -359,11 +414,20 @@ static uint32_t refreshDelay = 0;
 
 void pageCountdowns();
 
-void drawCurrentPage() {
-  ensureCurrentPageEnabled();
+// Cambio pagina a schermo (metriche /events)
+static void notePageShown() {
+  static int lastDrawn = -1;
+  if (g_page != lastDrawn) {
+    metricPush(MK_PAGE, g_page, 0);
+    lastDrawn = g_page;
+  }
+}
+
+// Disegna la pagina p sul target attuale di gfx (schermo o layer)
+static void drawPage(int p) {
   gfx->fillScreen(COL_BG);
 
-  switch (g_page) {
+  switch (p) {
     case P_WEATHER: pageWeather(); break;
     case P_AIR: pageAir(); break;
     case P_CLOCK: pageClock(); break;
@@ -387,55 +451,37 @@ void drawCurrentPage() {
   }
 }
 
-// =============================================================================
-// REFRESH DATI
-// =============================================================================
-void refreshAll() {
-  if (g_show[P_WEATHER]) {
-    fetchWeather();
-    g_pageDirty[P_WEATHER] = true;
-  }
-
-  if (g_show[P_AIR] && fetchAir())
-    g_pageDirty[P_AIR] = true;
-
-  fetchICS();
-  g_pageDirty[P_CAL] = true;
-
-  if (g_show[P_BTC] && fetchCryptoWrapper())
-    g_pageDirty[P_BTC] = true;
-
-  if (g_show[P_QOD] && fetchQOD())
-    g_pageDirty[P_QOD] = true;
-
-  if (g_show[P_FX] && fetchFX())
-    g_pageDirty[P_FX] = true;
-
-  if (g_show[P_T24] && fetchTemp24())
-    g_pageDirty[P_T24] = true;
-
-  if (g_show[P_SUN] && fetchSun())
-    g_pageDirty[P_SUN] = true;
-
-  if (g_show[P_NEWS] && fetchNews())
-    g_pageDirty[P_NEWS] = true;
-
-  if (g_show[P_HA] && fetchHA())
-    g_pageDirty[P_HA] = true;
+void drawCurrentPage() {
+  ensureCurrentPageEnabled();
+  notePageShown();
+  const uint32_t t0 = micros();
+  drawPage(g_page);
+  metricPush(MK_FRAME, g_page, micros() - t0);
+}
 
-  if (g_bootPhase) {
-    gfx->fillScreen(COL_BG);
+// Pagina corrente dal layer pre-renderizzato se pronto, altrimenti disegnata
+static void showCurrentPage() {
+  ensureCurrentPageEnabled();
+  const uint32_t t0 = micros();
+  if (!lyPresent(g_page)) {
     drawCurrentPage();
-    lastPageSwitch = millis();
     return;
   }
+  notePageShown();
+  metricPush(MK_FRAME, g_page, micros() - t0);
+}
 
-  if (g_pageDirty[g_page]) {
-    g_pageDirty[g_page] = false;
-    gfx->fillScreen(COL_BG);
-    drawCurrentPage();
-    lastPageSwitch = millis();
-  }
+// Swipe dal touch: pagina successiva (dir = 1) o precedente (dir = -1).
+// Ignorato durante una transizione: rotateDark/cycleDark cambierebbero
+// pagina a schermo spento sopra quella scelta dallo swipe
+void swipeToPage(int8_t dir) {
+  if (g_trans != TR_NONE) return;
+  const int p = adjacentEnabledPage(g_page, dir);
+  if (p < 0 || p == g_page) return;
+  g_page = p;
+  if (g_page == P_T24) resetTemp24Anim();
+  showCurrentPage();
+  lastPageSwitch = millis();
 }
 
 // =============================================================================
@@ -450,13 +496,88 @@ static CosinoRLE pickRandomCosino() {
 }
 
 // =============================================================================
-// SETUP
+// ROTAZIONE A SCHERMO SPENTO
 // =============================================================================
-void setup() {
-  panelKickstart();
-  showSplashFadeInOnly(SquaredCoso, SquaredCoso_count, 2000);
+// Pagina successiva, o fine giro con splash. Le callback girano nel loop
+// (blTick) e si passano il testimone.
+static void cycleDark() {
+  {
+    StateLock lock;
+    gfx->fillScreen(COL_BG);
+    int first = firstEnabledPage();
+    g_page = (first < 0) ? P_CLOCK : first;
+    g_cycleCompleted = false;
+
+    drawCurrentPage();
+  }
+  g_trans = TR_PAGE;
+  blFadeTo(nmBacklight(), BL_SLOW_MS, transEnd);
+}
+
+static void cycleSplashHeld() {
+  blFadeTo(0, BL_SLOW_MS, cycleDark);
+}
+
+static void cycleSplashShown() {
+  blHold(1500, cycleSplashHeld);
+}
+
+static void rotateDark() {
+  if (touchPaused) {  // menu aperto durante il fade: resta il menu
+    blFadeTo(nmBacklight(), BL_QUICK_MS, transEnd);
+    return;
+  }
+
+  bool cycle;
+  {
+    StateLock lock;
+    int oldPage = g_page;
+    bool ok = advanceToNextEnabled();
 
-  // Versione firmware
+    if (ok && g_page == P_T24 && oldPage != P_T24)
+      resetTemp24Anim();
+
+    if (!ok || g_page <= oldPage)
+      g_cycleCompleted = true;
+
+    cycle = g_cycleCompleted;
+    if (!cycle) showCurrentPage();
+  }
+
+  if (!cycle) {
+    blFadeTo(nmBacklight(), BL_QUICK_MS, transEnd);
+  } else if (g_splash_enabled && !nmNight()) {  // di notte niente splash
+    g_trans = TR_SCENE;
+    CosinoRLE c = pickRandomCosino();
+    drawSplash(c.data, c.runs);
+    blFadeTo(nmBacklight(), BL_SPLASH_MS, cycleSplashShown);
+  } else {
+    cycleDark();
+  }
+}
+
+// =============================================================================
+// BOOT A STADI
+// =============================================================================
+// setup() porta a schermo la prima pagina con i dati già in memoria; Wi-Fi,
+// ora e fetch avanzano da bootStep() nel loop, un controllo per giro,
+// mentre rotazione e animazioni continuano.
+//
+//   SPLASH (facoltativo, BOOT_SPLASH_MS) → prima pagina
+//   WIFI   connessione in corso; dopo BOOT_WIFI_MS → portale AP
+//   TIME   SNTP avviato; fetch al primo orario valido o dopo BOOT_NTP_MS
+//          (intanto l'ora approssimata di seedClock() tiene vivo l'orologio)
+//   FETCH  giro di refresh a passi (un fetch per giro di loop)
+//   DONE   tempi in g_boot (/api/state)
+enum BootStage : uint8_t { BOOT_SPLASH, BOOT_WIFI, BOOT_TIME, BOOT_FETCH, BOOT_DONE };
+
+static BootStage g_bootStage = BOOT_SPLASH;
+static uint32_t bootT0 = 0;
+static const uint32_t BOOT_SPLASH_MS = 600;
+static const uint32_t BOOT_WIFI_MS = 8000;
+static const uint32_t BOOT_NTP_MS = 8000;
+
+static void drawFwVersion() {
   gfx->setTextSize(2);
   gfx->setTextColor(COL_TEXT);
 
@@ -465,136 +586,269 @@ void setup() {
   int fwLen = strlen(verBuf) * BASE_CHAR_W * 2;
   gfx->setCursor(480 - fwLen - 38, 480 - BASE_CHAR_H * 2 - 8);
   gfx->print(verBuf);
+}
 
+static void bootShown() {
+  transEnd();
+  g_boot.firstFrame = millis();
+}
+
+static void bootDark() {
+  {
+    StateLock lock;
+    g_page = firstEnabledPage();
+    if (g_page < 0) g_page = P_CLOCK;
+    drawCurrentPage();
+  }
+  g_trans = TR_PAGE;
+  blFadeTo(nmBacklight(), BL_QUICK_MS, bootShown);
+}
+
+// Splash → prima pagina: il loop gira già durante i fade
+static void bootFirstFrame() {
+  if (!g_splash_enabled) {
+    bootDark();
+    return;
+  }
+  g_trans = TR_SCENE;
+  blFadeTo(0, BL_QUICK_MS, bootDark);
+}
+
+static void bootStep() {
+  const uint32_t now = millis();
+
+  // Ora valida arrivata in qualunque momento (SNTP in background)
+  if (!g_timeSynced && timeIsValid()) {
+    g_timeSynced = true;
+    g_boot.time = now;
+    snapRestoreAges();
+  }
+
+  switch (g_bootStage) {
+    case BOOT_SPLASH:
+      if (now - bootT0 < BOOT_SPLASH_MS) return;
+      bootFirstFrame();
+      g_bootStage = BOOT_WIFI;
+      return;
+
+    case BOOT_WIFI:
+      if (wlUp()) {
+        g_boot.wifi = now;
+        startSTAWeb();
+        startNTP();
+        bootT0 = now;
+        g_bootStage = BOOT_TIME;
+      } else if (now - bootT0 > BOOT_WIFI_MS) {
+        StateLock lock;
+        startAPWithPortal();
+        g_bootStage = BOOT_DONE;
+      }
+      return;
+
+    case BOOT_TIME:
+      if (!g_timeSynced && now - bootT0 < BOOT_NTP_MS) return;
+      {
+        StateLock lock;
+        lastRefresh = now;
+        refreshStep = R_WEATHER;
+        refreshDelay = now;
+      }
+      g_bootStage = BOOT_FETCH;
+      return;
+
+    case BOOT_FETCH:
+      if (refreshStep != R_DONE) return;
+      g_boot.fresh = now;
+      g_bootStage = BOOT_DONE;
+      return;
+
+    case BOOT_DONE:
+      return;
+  }
+}
+
+// =============================================================================
+// SETUP
+// =============================================================================
+void setup() {
+  panelKickstart();
+  stateLockInit();
   loadAppConfig();
   touchInit();
 
-  if (!tryConnectSTA(8000)) {
-    startAPWithPortal();
-  } else {
-    startSTAWeb();
-    syncTimeFromNTP();
-    g_dataRefreshPending = true;
+  // Reset software: l'RTC ha conservato l'ora, niente attesa di NTP
+  if (timeIsValid()) {
+    g_timeSynced = true;
+    g_boot.time = millis();
   }
 
-  refreshAll();
-  g_pageDirty[g_page] = true;
+  // Dati dell'ultima sessione: la prima pagina non parte vuota
+  snapLoadAll();
+  if (!g_timeSynced) seedClock();
 
-  if (countEnabledPages() == 1) {
-    g_bootPhase = false;
-    g_page = firstEnabledPage();
-    fadeInUI();
-    gfx->fillScreen(COL_BG);
-    drawCurrentPage();
-    lastPageSwitch = millis();
+  if (g_splash_enabled) {
+    showSplashNow(SquaredCoso, SquaredCoso_count);
+    drawFwVersion();
+  }
+  bootT0 = millis();
+
+  // Senza credenziali: portale AP subito
+  if (!wlBegin()) {
+    if (!g_splash_enabled) blFadeTo(nmBacklight(), BL_QUICK_MS);
+    startAPWithPortal();
+    g_bootStage = BOOT_DONE;
     return;
   }
 
-  fadeInUI();
-  g_bootPhase = false;
-  gfx->fillScreen(COL_BG);
-  drawCurrentPage();
+  // Splash disattivato: prima pagina già qui
+  if (!g_splash_enabled) {
+    bootFirstFrame();
+    g_bootStage = BOOT_WIFI;
+  }
 }
 
 // =============================================================================
 // LOOP
 // =============================================================================
 void loop() {
+  // Riavvio chiesto dalla WebUI (risposta già inviata dal task web)
+  if (g_rebootPending) {
+    snapFlush();
+    delay(300);
+    ESP.restart();
+  }
+
+  // Retroilluminazione: fine rampa → passo successivo della transizione
+  blTick();
+
+  // Wi-Fi: un passo della macchina a stati, mai bloccante
+  const bool linkBack = WiFi.getMode() == WIFI_STA && wlTick();
+
+  bootStep();
+  if (g_bootStage == BOOT_SPLASH) {
+    delay(5);
+    return;
+  }
+
+  // Snapshot su LittleFS a fine giro di refresh
+  snapTick();
+
   // AP mode
   if (WiFi.getMode() == WIFI_AP) {
     dnsServer.processNextRequest();
-    web.handleClient();
     delay(10);
     return;
   }
 
-  web.handleClient();
+  // Modalità notte: fascia oraria, curva della retroilluminazione (a
+  // schermo fermo) e modem sleep fuori dai fetch
+  nmTick(g_trans == TR_NONE && !touchPaused,
+         refreshStep != R_DONE || g_dataRefreshPending || g_forceQodPending);
 
-  // Riconnessione WiFi
-  if (WiFi.status() != WL_CONNECTED) {
-    static uint32_t nextTry = 0;
-    if (millis() > nextTry) {
-      nextTry = millis() + 5000;
-      if (tryConnectSTA(5000)) {
-        if (!g_timeSynced) syncTimeFromNTP();
-        g_dataRefreshPending = true;
-      }
-    }
-    delay(30);
-    return;
+  // Link tornato dopo un'interruzione (al boot ci pensa bootStep): ora e
+  // dati aggiornati. Finché è giù pagine e animazioni proseguono con i dati
+  // in memoria, i fetch restano in attesa.
+  if (linkBack && g_bootStage == BOOT_DONE) {
+    if (!g_timeSynced) startNTP();
+    g_dataRefreshPending = true;
   }
 
-  // Refresh immediato
-  if (g_dataRefreshPending) {
-    g_dataRefreshPending = false;
-    refreshAll();
-  }
+  // Refresh dati: un fetch per giro di loop, mai tutta la serie. Rete
+  // senza lock: ogni fetch lo prende solo per leggere la configurazione e
+  // pubblicare i dati, la WebUI non aspetta mai un download
+  if (wlUp()) {
+    // Nuova frase richiesta dalla WebUI
+    if (g_forceQodPending) {
+      g_forceQodPending = false;
+      noteFetch(P_QOD, forceQOD);
+      StateLock lock;
+      if (g_page == P_QOD && g_trans != TR_SCENE) drawCurrentPage();
+    }
 
-  // Scheduler refresh
-  if (millis() - lastRefresh >= REFRESH_MS) {
-    lastRefresh = millis();
-    refreshStep = R_WEATHER;
-    refreshDelay = millis() + 200;
-  }
+    // Refresh immediato: riparte lo scheduler a passi, senza attesa
+    if (g_dataRefreshPending) {
+      g_dataRefreshPending = false;
+      lastRefresh = millis();
+      refreshStep = R_WEATHER;
+      refreshDelay = millis();
+    }
 
-  // Step refresh distribuito
-  if (refreshStep != R_DONE && millis() > refreshDelay) {
-    switch (refreshStep) {
-      case R_WEATHER:
-        if (g_show[P_WEATHER]) {
-          fetchWeather();
-          g_pageDirty[P_WEATHER] = true;
-        }
-        refreshStep = R_AIR;
-        break;
-      case R_AIR:
-        if (g_show[P_AIR] && fetchAir()) g_pageDirty[P_AIR] = true;
-        refreshStep = R_ICS;
-        break;
-      case R_ICS:
-        fetchICS();
-        g_pageDirty[P_CAL] = true;
-        refreshStep = R_BTC;
-        break;
-      case R_BTC:
-        if (g_show[P_BTC] && fetchCryptoWrapper()) g_pageDirty[P_BTC] = true;
-        refreshStep = R_QOD;
-        break;
-      case R_QOD:
-        if (g_show[P_QOD] && fetchQOD()) g_pageDirty[P_QOD] = true;
-        refreshStep = R_FX;
-        break;
-      case R_FX:
-        if (g_show[P_FX] && fetchFX()) g_pageDirty[P_FX] = true;
-        refreshStep = R_T24;
-        break;
-      case R_T24:
-        if (g_show[P_T24] && fetchTemp24()) g_pageDirty[P_T24] = true;
-        refreshStep = R_SUN;
-        break;
-      case R_SUN:
-        if (g_show[P_SUN] && fetchSun()) g_pageDirty[P_SUN] = true;
-        refreshStep = R_NEWS;
-        break;
-      case R_NEWS:
-        if (g_show[P_NEWS] && fetchNews()) g_pageDirty[P_NEWS] = true;
-        refreshStep = R_HA;
-        break;
-      case R_HA:
-        if (g_show[P_HA] && fetchHA()) g_pageDirty[P_HA] = true;
-        refreshStep = R_DONE;
-        break;
-      default:
-        break;
+    // Scheduler refresh
+    if (millis() - lastRefresh >= nmRefreshMs(REFRESH_MS)) {
+      lastRefresh = millis();
+      refreshStep = R_WEATHER;
+      refreshDelay = millis() + 200;
     }
-    refreshDelay = millis() + 200;
-  }
 
-  // Rotazione pagine
-  if (!touchPaused && millis() - lastPageSwitch >= PAGE_INTERVAL_MS) {
-    uint8_t enabled = countEnabledPages();
+    // Step refresh distribuito
+    if (refreshStep != R_DONE && millis() > refreshDelay) {
+      switch (refreshStep) {
+        case R_WEATHER:
+          if (g_show[P_WEATHER]) {
+            noteFetch(P_WEATHER, fetchWeather);
+            g_pageDirty[P_WEATHER] = true;
+          }
+          refreshStep = R_AIR;
+          break;
+        case R_AIR:
+          if (g_show[P_AIR] && noteFetch(P_AIR, fetchAir)) g_pageDirty[P_AIR] = true;
+          refreshStep = R_ICS;
+          break;
+        case R_ICS:
+          noteFetch(P_CAL, fetchICS);
+          g_pageDirty[P_CAL] = true;
+          refreshStep = R_BTC;
+          break;
+        case R_BTC:
+          if (g_show[P_BTC] && noteFetch(P_BTC, fetchCryptoWrapper)) g_pageDirty[P_BTC] = true;
+          refreshStep = R_QOD;
+          break;
+        case R_QOD:
+          if (g_show[P_QOD] && noteFetch(P_QOD, fetchQOD)) g_pageDirty[P_QOD] = true;
+          refreshStep = R_FX;
+          break;
+        case R_FX:
+          if (g_show[P_FX] && noteFetch(P_FX, fetchFX)) g_pageDirty[P_FX] = true;
+          refreshStep = R_T24;
+          break;
+        case R_T24:
+          if (g_show[P_T24] && noteFetch(P_T24, fetchTemp24)) g_pageDirty[P_T24] = true;
+          refreshStep = R_SUN;
+          break;
+        case R_SUN:
+          if (g_show[P_SUN] && noteFetch(P_SUN, fetchSun)) g_pageDirty[P_SUN] = true;
+          refreshStep = R_NEWS;
+          break;
+        case R_NEWS:
+          if (g_show[P_NEWS] && noteFetch(P_NEWS, fetchNews)) g_pageDirty[P_NEWS] = true;
+          refreshStep = R_HA;
+          break;
+        case R_HA:
+          if (g_show[P_HA] && noteFetch(P_HA, fetchHA) && !haListPending())
+            g_pageDirty[P_HA] = true;
+          // lista HA via REST: una entità per passo fino alla fine
+          refreshStep = g_show[P_HA] && haListPending() ? R_HA : R_DONE;
+          break;
+        default:
+          break;
+      }
+      refreshDelay = millis() + 200;
 
-    if (enabled <= 1) {
+      // Pagina a schermo aggiornata subito, appena arrivano i suoi dati
+      StateLock lock;
+      if (g_pageDirty[g_page] && !touchPaused && g_trans != TR_SCENE) {
+        g_pageDirty[g_page] = false;
+        drawCurrentPage();
+      }
+    }
+  }
+
+  // Rotazione pagine: fade asincrono, cambio pagina a schermo spento
+  // (rotateDark), intanto il loop continua
+  if (!touchPaused && g_trans == TR_NONE &&
+      millis() - lastPageSwitch >= PAGE_INTERVAL_MS) {
+    if (countEnabledPages() <= 1) {
+      StateLock lock;
       time_t now = time(nullptr);
       struct tm ti;
       localtime_r(&now, &ti);
@@ -615,93 +869,85 @@ void loop() {
       return;
     }
 
-    quickFadeOut();
-    int oldPage = g_page;
-    bool ok = advanceToNextEnabled();
-
-    if (ok && g_page == P_T24 && oldPage != P_T24)
-      resetTemp24Anim();
-
-    if (!ok || g_page <= oldPage)
-      g_cycleCompleted = true;
+    g_trans = TR_PAGE;
+    blFadeTo(0, BL_QUICK_MS, rotateDark);
+  }
 
-    if (g_cycleCompleted) {
-      if (g_splash_enabled) {
-        CosinoRLE c = pickRandomCosino();
-        showCycleSplash(c.data, c.runs, 1500);
-        splashFadeOut();
+  // Home Assistant: WebSocket letto anche a pagina non visibile; senza
+  // lock, serviceHA() lo prende solo attorno a configurazione e stati
+  if (g_show[P_HA] && !touchPaused && g_trans != TR_SCENE) serviceHA();
+
+  {
+    StateLock lock;
+
+    // Touch (splash o conferma a schermo: eventi lasciati in coda)
+    if (g_trans != TR_SCENE) touchLoop();
+
+    if (!touchPaused && g_trans != TR_SCENE) {
+      // Animazioni pagina corrente (particelle rallentate di notte)
+      switch (g_page) {
+        case P_HA:
+          tickHA();
+          break;
+
+        case P_WEATHER:
+          if (nmFrame()) pageWeatherParticlesTick();
+          if (g_pageDirty[P_WEATHER]) {
+            g_pageDirty[P_WEATHER] = false;
+            gfx->fillScreen(COL_BG);
+            pageWeather();
+          }
+          break;
+
+        case P_AIR:
+          if (nmFrame()) tickLeaves(g_air_bg);
+          break;
+
+        case P_FX:
+          if (nmFrame()) tickFXDataStream(COL_BG);
+          break;
+
+        case P_COUNT:
+          if (nmFrame()) tickCountdownSnake();
+          break;
+
+        case P_STELLAR:
+          tickStellar();
+          break;
+
+        case P_INFO:
+          tickInfo();
+          break;
+
+        case P_CHRONOS:
+          tickChronos();
+          break;
+
+        case P_T24:
+          {
+            int old = temp24_progress;
+            tickTemp24Anim();
+            if (temp24_progress != old) {
+              gfx->fillScreen(COL_BG);
+              pageTemp24();
+            }
+            break;
+          }
+
+        default:
+          break;
       }
 
-      int first = firstEnabledPage();
-      g_page = (first < 0) ? P_CLOCK : first;
-      g_cycleCompleted = false;
-
-      drawCurrentPage();
-      fadeInUI();
-      lastPageSwitch = millis();
-      return;
+      // Giro libero: pagina precedente/successiva nei layer PSRAM
+      if ((refreshStep == R_DONE || !wlUp()) &&
+          millis() - lastPageSwitch >= LY_SETTLE_MS)
+        lyIdle(g_page, drawPage, millis() - touchDown.ms < LY_PREV_MS);
     }
-
-    drawCurrentPage();
-    quickFadeIn();
-    lastPageSwitch = millis();
   }
 
-  // Touch
-  touchLoop();
-
-  if (touchPaused) {
+  // Menu aperto o schermo spento di notte: rotazione ferma
+  if (touchPaused || !nmBacklight())
     lastPageSwitch = millis();
-    delay(5);
-    return;
-  }
 
-  // Animazioni pagina corrente
-  switch (g_page) {
-    case P_HA:
-      tickHA();
-      pageHA();
-      break;
-
-    case P_WEATHER:
-      pageWeatherParticlesTick();
-      if (g_pageDirty[P_WEATHER]) {
-        g_pageDirty[P_WEATHER] = false;
-        gfx->fillScreen(COL_BG);
-        pageWeather();
-      }
-      break;
-
-    case P_AIR:
-      tickLeaves(g_air_bg);
-      break;
-
-    case P_FX:
-      tickFXDataStream(COL_BG);
-      break;
-
-    case P_COUNT:
-      tickCountdownSnake();
-      break;
-
-    case P_STELLAR:
-      tickStellar();
-      break;
-
-    case P_T24:
-      {
-        int old = temp24_progress;
-        tickTemp24Anim();
-        if (temp24_progress != old) {
-          gfx->fillScreen(COL_BG);
-          pageTemp24();
-        }
-        break;
-      }
-
-    default:
-      break;
-  }
-
-  delay(5);
-}
\ No newline at end of file
+  delay(nmLoopMs());
+}
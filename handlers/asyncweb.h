@@ -0,0 +1,497 @@
+/*
+===============================================================================
+   SQUARED — ASYNC WEB (adattatore esp_http_server)
+   Descrizione: server HTTP nel proprio task (esp_http_server di ESP-IDF,
+                più connessioni aperte, select() sui socket) con la stessa
+                API del WebServer Arduino usata dagli handler: on(),
+                arg(), send(), send_P(), sendHeader(), sendContent().
+                Il loop non chiama più handleClient(): animazioni, fade e
+                fetch non ritardano la WebUI e un browser lento non
+                blocca il pannello (le scritture sul socket avvengono
+                sempre a lock rilasciato).
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • Ogni richiesta: lettura completa di query e body (form urlencoded →
+     argomenti, altri tipi → arg("plain")) FUORI dal lock, poi l'handler
+     gira con StateLock preso: globali, NVS e dati pagina sono coerenti.
+     send() e sendContent() di un handler con lock non toccano il socket:
+     la risposta finisce nel buffer web_out (PSRAM, max WEB_MAX_RESP) e
+     parte dopo il rilascio del lock, con Content-Length. Un client che
+     legge piano tiene occupato solo il task del server.
+
+   • Pagine lunghe (impostazioni, /api/state, /api/config): l'handler
+     copia sotto lock le globali che gli servono e chiama unlock(); da lì
+     il lock torna al loop e i chunk vanno dritti al socket, senza
+     raccogliere la pagina intera in web_out.
+
+   • Rotte senza lock (locked = false): asset PROGMEM, framebuffer, SSE;
+     scrivono direttamente sul socket.
+
+   • StateLock è un mutex ricorsivo condiviso col loop, che lo prende
+     attorno a disegno e touch e, nei fetch, solo per leggere la
+     configurazione e pubblicare i dati: mai durante la rete, fade e
+     splash.
+
+   • Gli handler non toccano il display: azioni che disegnano (nuova
+     frase, riavvio) passano al loop tramite flag.
+
+   • Un solo handler alla volta (task unico del server): html_buf di
+     HtmlWriter resta condivisibile.
+
+   • Stream lunghi (/events): detach() lascia il socket aperto dopo
+     l'handler, i dati partono da lavori accodati nel task del server.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>
+#include <esp_http_server.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <functional>
+#include <lwip/sockets.h>
+#include "metrics.h"
+
+#ifndef HTTP_ANY
+#define HTTP_ANY ((httpd_method_t)255)
+#endif
+#define CONTENT_LENGTH_UNKNOWN ((size_t)-1)
+
+static constexpr uint8_t WEB_MAX_ROUTES = 24;
+static constexpr uint8_t WEB_MAX_ARGS = 64;
+static constexpr uint8_t WEB_MAX_HEADERS = 4;
+static constexpr size_t WEB_MAX_BODY = 16384;
+static constexpr size_t WEB_MAX_RESP = 16384; // risposta raccolta sotto lock
+
+// =============================================================================
+// LOCK STATO CONDIVISO (task HTTP ↔ loop)
+// =============================================================================
+static SemaphoreHandle_t state_mux = nullptr;
+
+static inline void stateLockInit() {
+  if (!state_mux)
+    state_mux = xSemaphoreCreateRecursiveMutex();
+}
+
+struct StateLock {
+  StateLock() { xSemaphoreTakeRecursive(state_mux, portMAX_DELAY); }
+  ~StateLock() { xSemaphoreGiveRecursive(state_mux); }
+  StateLock(const StateLock &) = delete;
+  StateLock &operator=(const StateLock &) = delete;
+};
+
+// =============================================================================
+// SERVER
+// =============================================================================
+class AsyncWeb {
+public:
+  typedef std::function<void()> Handler;
+
+  explicit AsyncWeb(uint16_t port) : port(port) {}
+
+  // --------------------------------------------------------------------------
+  // Rotte
+  // --------------------------------------------------------------------------
+  // locked = false: l'handler gira senza StateLock (solo per chi legge
+  // dati che il loop non rialloca, es. il framebuffer)
+  void on(const char *uri, httpd_method_t m, Handler fn, bool locked = true) {
+    if (nRoutes < WEB_MAX_ROUTES)
+      routes[nRoutes++] = {uri, m, fn, locked};
+  }
+
+  void onNotFound(Handler fn) { notFound = fn; }
+
+  // URI della rotta i (indice registrato nelle metriche MK_HTTP)
+  const char *routeUri(uint8_t i) const { return i < nRoutes ? routes[i].uri : "*"; }
+
+  bool begin() {
+    stateLockInit();
+    if (srv)
+      return true;
+
+    httpd_config_t cfg = HTTPD_DEFAULT_CONFIG();
+    cfg.server_port = port;
+    cfg.stack_size = 10240;
+    cfg.core_id = 0;           // loop() e disegno su core 1
+    cfg.max_open_sockets = 5;  // restano socket per HA, HTTPS e DNS
+    cfg.lru_purge_enable = true;
+    cfg.recv_wait_timeout = 3; // client fermi: socket liberato in fretta
+    cfg.send_wait_timeout = 3;
+    cfg.max_uri_handlers = 3;
+    cfg.uri_match_fn = httpd_uri_match_wildcard;
+    cfg.close_fn = sessClosed;
+    cfg.global_user_ctx = this;
+    cfg.global_user_ctx_free_fn = [](void *) {}; // istanza statica
+
+    if (httpd_start(&srv, &cfg) != ESP_OK) {
+      srv = nullptr;
+      return false;
+    }
+
+    // Un solo handler per metodo: il routing lo fa dispatch()
+    static const httpd_method_t methods[] = {HTTP_GET, HTTP_POST, HTTP_PATCH};
+    for (httpd_method_t m : methods) {
+      httpd_uri_t u = {};
+      u.uri = "/*";
+      u.method = m;
+      u.handler = entry;
+      u.user_ctx = this;
+      httpd_register_uri_handler(srv, &u);
+    }
+    return true;
+  }
+
+  // --------------------------------------------------------------------------
+  // Richiesta corrente
+  // --------------------------------------------------------------------------
+  httpd_method_t method() const { return (httpd_method_t)req->method; }
+
+  int args() const { return nArgs; }
+  const String &argName(int i) const { return argK[i]; }
+  const String &arg(int i) const { return argV[i]; }
+
+  const String &arg(const char *name) const {
+    static const String none;
+    const int i = find(name);
+    return i < 0 ? none : argV[i];
+  }
+
+  bool hasArg(const char *name) const { return find(name) >= 0; }
+
+  // --------------------------------------------------------------------------
+  // Risposta (stringhe di header/tipo: letterali, restano valide)
+  // --------------------------------------------------------------------------
+  void sendHeader(const char *k, const char *v) {
+    if (nHdr < WEB_MAX_HEADERS) {
+      hdrK[nHdr] = k;
+      hdrV[nHdr++] = v;
+    }
+  }
+  void sendHeader(const __FlashStringHelper *k, const __FlashStringHelper *v) {
+    sendHeader(reinterpret_cast<const char *>(k),
+               reinterpret_cast<const char *>(v));
+  }
+
+  void setContentLength(size_t n) { chunked = (n == CONTENT_LENGTH_UNKNOWN); }
+
+  void send(int code, const char *type, const char *body, size_t len) {
+    httpd_resp_set_status(req, status(code));
+    httpd_resp_set_type(req, type);
+    for (uint8_t i = 0; i < nHdr; i++)
+      httpd_resp_set_hdr(req, hdrK[i], hdrV[i]);
+    if (chunked)
+      return; // header inviati col primo sendContent()
+    if (buffered) {
+      if (!outAppend(body, len))
+        aborted = true;
+    } else {
+      httpd_resp_send(req, body, len);
+    }
+    done = true;
+  }
+  void send(int code, const char *type, const char *body) {
+    send(code, type, body, strlen(body));
+  }
+  void send(int code, const char *type, const String &body) {
+    send(code, type, body.c_str(), body.length());
+  }
+
+  // Flash mappata in memoria: PROGMEM si legge direttamente
+  void send_P(int code, const char *type, PGM_P data, size_t len) {
+    send(code, type, data, len);
+  }
+  void send_P(int code, const char *type, PGM_P data) {
+    send(code, type, data, strlen(data));
+  }
+
+  // Risposta chunked: len 0 = chunk finale
+  void sendContent(const char *d, size_t len) {
+    if (!aborted && !(buffered ? outAppend(d, len)
+                               : httpd_resp_send_chunk(req, len ? d : nullptr, len) == ESP_OK))
+      aborted = true;
+    if (!len)
+      done = true;
+  }
+  void sendContent(const char *d) { sendContent(d, strlen(d)); }
+
+  // Client sparito durante una risposta chunked: gli handler lunghi
+  // smettono di produrre dati
+  bool clientGone() const { return aborted; }
+
+  // Fine della parte con lock di un handler (globali già copiate): il
+  // lock torna al loop, quanto scritto finora parte e il resto della
+  // risposta va direttamente sul socket. Da chiamare fuori da altri
+  // StateLock; senza effetto nelle rotte senza lock
+  void unlock() {
+    if (!buffered)
+      return;
+    buffered = false;
+    xSemaphoreGiveRecursive(state_mux);
+
+    if (aborted) { // oltre WEB_MAX_RESP o PSRAM esaurita
+      httpd_resp_set_status(req, status(500));
+      httpd_resp_set_type(req, "text/plain");
+      httpd_resp_send(req, "Risposta troppo grande", HTTPD_RESP_USE_STRLEN);
+      done = true;
+    } else if (done) {
+      if (httpd_resp_send(req, web_out, outLen) != ESP_OK)
+        aborted = true;
+    } else if (chunked && outLen) {
+      if (httpd_resp_send_chunk(req, web_out, outLen) != ESP_OK)
+        aborted = true;
+    }
+    outLen = 0;
+  }
+
+  // --------------------------------------------------------------------------
+  // Stream lunghi (SSE): header grezzi, poi il socket resta aperto fuori
+  // dal ciclo richiesta/risposta. Si scrive con send() non bloccante da
+  // un lavoro accodato (queue), si chiude con drop(); onClose() avvisa
+  // quando httpd chiude il socket (client uscito, LRU, errore).
+  // --------------------------------------------------------------------------
+  int detach(const char *head) {
+    const int fd = httpd_req_to_sockfd(req);
+    if (fd < 0 || httpd_send(req, head, strlen(head)) < 0) {
+      aborted = true;
+      return -1;
+    }
+    done = true;
+    return fd;
+  }
+
+  void onClose(std::function<void(int)> fn) { closeHook = fn; }
+
+  bool queue(httpd_work_fn_t fn, void *arg) {
+    return srv && httpd_queue_work(srv, fn, arg) == ESP_OK;
+  }
+
+  void drop(int fd) {
+    if (srv)
+      httpd_sess_trigger_close(srv, fd);
+  }
+
+private:
+  struct Route {
+    const char *uri;
+    httpd_method_t method;
+    Handler fn;
+    bool locked;
+  };
+
+  static esp_err_t entry(httpd_req_t *r) {
+    return static_cast<AsyncWeb *>(r->user_ctx)->dispatch(r);
+  }
+
+  // Con close_fn impostato il socket lo chiude il callback
+  static void sessClosed(httpd_handle_t hd, int fd) {
+    AsyncWeb *self = static_cast<AsyncWeb *>(httpd_get_global_user_ctx(hd));
+    if (self && self->closeHook)
+      self->closeHook(fd);
+    close(fd);
+  }
+
+  esp_err_t dispatch(httpd_req_t *r) {
+    req = r;
+    nArgs = 0;
+    nHdr = 0;
+    chunked = false;
+    done = false;
+    aborted = false;
+    buffered = false;
+    outLen = 0;
+
+    // Percorso senza query string
+    const char *q = strchr(r->uri, '?');
+    const size_t plen = q ? (size_t)(q - r->uri) : strlen(r->uri);
+    if (q)
+      parseForm(q + 1, strlen(q + 1));
+
+    // Body letto per intero prima di prendere il lock
+    if (r->content_len) {
+      if (r->content_len > WEB_MAX_BODY) {
+        httpd_resp_set_status(r, "413 Payload Too Large");
+        httpd_resp_send(r, nullptr, 0);
+        return ESP_OK;
+      }
+      if (!readBody(r))
+        return ESP_FAIL; // socket chiuso da httpd
+    }
+
+    const Route *hit = nullptr;
+    for (uint8_t i = 0; i < nRoutes && !hit; i++) {
+      const Route &rt = routes[i];
+      if ((rt.method == HTTP_ANY || rt.method == r->method) &&
+          strlen(rt.uri) == plen && !strncmp(rt.uri, r->uri, plen))
+        hit = &rt;
+    }
+
+    const uint32_t t0 = millis();
+    if (hit && !hit->locked) {
+      hit->fn();
+    } else {
+      xSemaphoreTakeRecursive(state_mux, portMAX_DELAY);
+      buffered = true;
+      if (hit)
+        hit->fn();
+      else if (notFound)
+        notFound();
+      unlock(); // risposta raccolta sotto lock: al socket ora
+    }
+    metricPush(MK_HTTP, hit ? (uint8_t)(hit - routes) : 0xFF, millis() - t0);
+
+    // Handler senza risposta completa: chiusura pulita
+    if (!done && !aborted) {
+      if (chunked)
+        httpd_resp_send_chunk(r, nullptr, 0);
+      else
+        httpd_resp_send_404(r);
+    }
+    req = nullptr;
+    return aborted ? ESP_FAIL : ESP_OK; // ESP_FAIL: httpd chiude il socket
+  }
+
+  // Buffer della risposta: cresce a raddoppi in PSRAM e resta allocato
+  // (un handler per volta, vedi task del server)
+  bool outAppend(const char *d, size_t n) {
+    if (outLen + n > outCap) {
+      size_t cap = outCap ? outCap : 8192;
+      while (cap < outLen + n)
+        cap *= 2;
+      if (cap > WEB_MAX_RESP)
+        return false;
+      char *p = (char *)heap_caps_realloc(web_out, cap, MALLOC_CAP_SPIRAM);
+      if (!p)
+        return false;
+      web_out = p;
+      outCap = cap;
+    }
+    memcpy(web_out + outLen, d, n);
+    outLen += n;
+    return true;
+  }
+
+  bool readBody(httpd_req_t *r) {
+    String body;
+    if (!body.reserve(r->content_len))
+      return false;
+
+    char buf[512];
+    size_t left = r->content_len;
+    uint8_t retry = 0;
+    while (left) {
+      const int n = httpd_req_recv(r, buf, left < sizeof(buf) ? left : sizeof(buf));
+      if (n == HTTPD_SOCK_ERR_TIMEOUT && ++retry < 3)
+        continue;
+      if (n <= 0)
+        return false;
+      body.concat(buf, n);
+      left -= n;
+    }
+
+    char ct[48] = "";
+    httpd_req_get_hdr_value_str(r, "Content-Type", ct, sizeof(ct));
+    if (!strncmp(ct, "application/x-www-form-urlencoded", 33))
+      parseForm(body.c_str(), body.length());
+    else
+      addArg("plain", 5, body.c_str(), body.length(), false);
+    return true;
+  }
+
+  // a=1&b=x%20y → argomenti decodificati
+  void parseForm(const char *s, size_t n) {
+    const char *e = s + n;
+    while (s < e) {
+      const char *amp = (const char *)memchr(s, '&', e - s);
+      if (!amp)
+        amp = e;
+      const char *eq = (const char *)memchr(s, '=', amp - s);
+      if (amp > s) {
+        if (eq)
+          addArg(s, eq - s, eq + 1, amp - eq - 1, true);
+        else
+          addArg(s, amp - s, "", 0, true);
+      }
+      s = amp + 1;
+    }
+  }
+
+  void addArg(const char *k, size_t kn, const char *v, size_t vn, bool enc) {
+    if (nArgs >= WEB_MAX_ARGS)
+      return;
+    decode(argK[nArgs], k, kn, enc);
+    decode(argV[nArgs], v, vn, enc);
+    nArgs++;
+  }
+
+  static void decode(String &out, const char *s, size_t n, bool enc) {
+    out = "";
+    if (!enc) {
+      out.concat(s, n);
+      return;
+    }
+    out.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+      char c = s[i];
+      if (c == '+') {
+        c = ' ';
+      } else if (c == '%' && i + 2 < n && isxdigit((uint8_t)s[i + 1]) &&
+                 isxdigit((uint8_t)s[i + 2])) {
+        const char h[3] = {s[i + 1], s[i + 2], 0};
+        c = (char)strtol(h, nullptr, 16);
+        i += 2;
+      }
+      out += c;
+    }
+  }
+
+  int find(const char *name) const {
+    for (int i = 0; i < nArgs; i++)
+      if (argK[i] == name)
+        return i;
+    return -1;
+  }
+
+  static const char *status(int code) {
+    switch (code) {
+    case 200: return "200 OK";
+    case 204: return "204 No Content";
+    case 302: return "302 Found";
+    case 400: return "400 Bad Request";
+    case 404: return "404 Not Found";
+    case 409: return "409 Conflict";
+    case 413: return "413 Payload Too Large";
+    case 429: return "429 Too Many Requests";
+    case 503: return "503 Service Unavailable";
+    default: return "500 Internal Server Error";
+    }
+  }
+
+  httpd_handle_t srv = nullptr;
+  uint16_t port;
+
+  Route routes[WEB_MAX_ROUTES];
+  uint8_t nRoutes = 0;
+  Handler notFound;
+  std::function<void(int)> closeHook;
+
+  // stato della richiesta in corso (task del server)
+  httpd_req_t *req = nullptr;
+  String argK[WEB_MAX_ARGS];
+  String argV[WEB_MAX_ARGS];
+  int nArgs = 0;
+  const char *hdrK[WEB_MAX_HEADERS];
+  const char *hdrV[WEB_MAX_HEADERS];
+  uint8_t nHdr = 0;
+  bool chunked = false;
+  bool done = false;
+  bool aborted = false;
+  bool buffered = false; // handler con lock: risposta in web_out
+  char *web_out = nullptr;
+  size_t outLen = 0, outCap = 0;
+};
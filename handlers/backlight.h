@@ -0,0 +1,160 @@
+/*
+===============================================================================
+   SQUARED — BACKLIGHT (fade asincroni su LEDC)
+   Descrizione: retroilluminazione PWM sul pin 38 con fade eseguiti
+                dall'hardware LEDC: blFadeTo() avvia la rampa e ritorna
+                subito, il loop continua a servire web, touch e fetch e a
+                preparare la pagina successiva. A fine rampa blTick()
+                chiama la callback nel contesto del loop, così le
+                transizioni si concatenano senza delay().
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • blBegin()               LEDC + servizio fade (idempotente)
+   • blFadeTo(duty, ms, cb)  rampa verso duty; cb a fine rampa (nel loop)
+   • blHold(ms, cb)          stesso livello per ms, poi cb (attese)
+   • blTick()                nel loop: fine rampa → callback
+   • blBusy() / blLevel()    rampa in corso / duty attuale
+   • blTarget()              duty a fine rampa (o attuale)
+
+   Una richiesta durante una rampa attende la fine di quella in corso e
+   di quella che la sua callback avvia (ultima richiesta vince): il driver
+   LEDC di IDF 4.4 bloccherebbe fino alla fine della rampa precedente. La
+   fine arriva dall'interrupt LEDC (LEDC_FADE_END_EVT); se manca, la
+   chiude il tempo previsto + margine.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+#include <driver/ledc.h>
+
+#define GFX_BL 38
+#define PWM_CHANNEL 0
+#define PWM_FREQ 1000
+#define PWM_BITS 8
+
+static constexpr uint8_t BL_MAX = (1 << PWM_BITS) - 1;
+static constexpr uint16_t BL_QUICK_MS = 100; // cambio pagina
+static constexpr uint16_t BL_SLOW_MS = 1250; // uscita splash, rientro UI
+static constexpr uint16_t BL_SPLASH_MS = 2500;
+static constexpr uint16_t BL_MARGIN_MS = 30; // fine rampa senza interrupt
+
+typedef void (*BlDone)();
+
+// ============================================================================
+// RAMPA (nessuna chiamata al driver: provabile su host)
+// ============================================================================
+struct BlRamp {
+  uint8_t from = 0, to = 0;
+  uint32_t t0 = 0, ms = 0;
+  bool active = false;
+  BlDone done = nullptr;
+
+  // Livello previsto all'istante now (il duty vero lo muove l'hardware)
+  uint8_t level(uint32_t now) const {
+    if (!active || now - t0 >= ms)
+      return to;
+    return from + ((int32_t)to - from) * (int32_t)(now - t0) / (int32_t)ms;
+  }
+
+  bool expired(uint32_t now) const {
+    return active && now - t0 >= ms + BL_MARGIN_MS;
+  }
+};
+
+struct BlReq {
+  uint8_t to;
+  uint16_t ms;
+  BlDone done;
+  bool valid;
+};
+
+// ============================================================================
+// DRIVER
+// ============================================================================
+static BlRamp bl_ramp;
+static BlReq bl_next = {0, 0, nullptr, false};
+static std::atomic<int16_t> bl_hw_end{-1}; // duty a fine rampa (interrupt)
+static bool bl_ready = false;
+
+static constexpr ledc_mode_t BL_MODE = LEDC_LOW_SPEED_MODE;
+static constexpr ledc_channel_t BL_CH = (ledc_channel_t)PWM_CHANNEL;
+
+static bool IRAM_ATTR blFadeEnd(const ledc_cb_param_t *p, void *) {
+  if (p->event == LEDC_FADE_END_EVT)
+    bl_hw_end.store(p->duty);
+  return false;
+}
+
+static void blBegin() {
+  if (bl_ready)
+    return;
+  ledcSetup(PWM_CHANNEL, PWM_FREQ, PWM_BITS);
+  ledcAttachPin(GFX_BL, PWM_CHANNEL);
+  ledcWrite(PWM_CHANNEL, 0);
+  ledc_fade_func_install(0);
+  ledc_cbs_t cbs = {blFadeEnd};
+  ledc_cb_register(BL_MODE, BL_CH, &cbs, nullptr);
+  bl_ready = true;
+}
+
+static inline uint8_t blLevel() { return bl_ramp.level(millis()); }
+static inline bool blBusy() { return bl_ramp.active; }
+static inline uint8_t blTarget() { return bl_ramp.to; }
+
+static void blStart(uint8_t to, uint16_t ms, BlDone done) {
+  blBegin();
+  const uint32_t now = millis();
+  bl_ramp.from = bl_ramp.level(now);
+  bl_ramp.to = to;
+  bl_ramp.t0 = now;
+  bl_ramp.ms = ms;
+  bl_ramp.done = done;
+  bl_ramp.active = true;
+  bl_hw_end.store(-1);
+
+  if (to != bl_ramp.from && ms) {
+    ledc_set_fade_with_time(BL_MODE, BL_CH, to, ms);
+    ledc_fade_start(BL_MODE, BL_CH, LEDC_FADE_NO_WAIT);
+  } else {
+    ledcWrite(PWM_CHANNEL, to); // attesa o salto: niente rampa hardware
+  }
+}
+
+static void blFadeTo(uint8_t to, uint16_t ms, BlDone done = nullptr) {
+  if (bl_ramp.active) {
+    bl_next = {to, ms, done, true};
+    return;
+  }
+  blStart(to, ms, done);
+}
+
+static inline void blHold(uint16_t ms, BlDone done) {
+  blFadeTo(bl_ramp.to, ms, done);
+}
+
+static void blTick() {
+  if (!bl_ramp.active)
+    return;
+  const uint32_t now = millis();
+  // un interrupt tardivo della rampa precedente ha un altro duty
+  const bool hw = bl_hw_end.exchange(-1) == bl_ramp.to;
+  const bool held = bl_ramp.to == bl_ramp.from || !bl_ramp.ms;
+  if (!(held ? now - bl_ramp.t0 >= bl_ramp.ms : hw || bl_ramp.expired(now)))
+    return;
+
+  bl_ramp.active = false;
+  const BlDone done = bl_ramp.done;
+  if (done)
+    done(); // può avviare la rampa successiva
+  if (bl_next.valid && !bl_ramp.active) {
+    bl_next.valid = false;
+    blStart(bl_next.to, bl_next.ms, bl_next.done);
+  }
+}
@@ -1,11 +1,11 @@
 /*
 ===============================================================================
    SQUARED — DISPLAY HELPERS (Core grafico)
-   Descrizione: Inizializzazione pannello ST7701, gestione backlight con
-                fade-in/out, splash RLE 480×480, rendering testi (bold,
+   Descrizione: Inizializzazione pannello ST7701, splash RLE 480×480
+                (backlight e fade in backlight.h), rendering testi (bold,
                 header, paragraph), sanitizzazione UTF-8, escape JSON,
-                helper data/ora, mini-parser JSON KV e funzioni paging
-                (mask ↔ array) condivise da tutte le pagine.
+                helper data/ora e funzioni paging (mask ↔ array) condivise
+                da tutte le pagine.
    Autore: Davide “gat” Nasato
    Repository: https://github.com/davidegat/SquaredCoso
    Licenza: CC BY-NC 4.0
@@ -14,21 +14,16 @@
 
 #pragma once
 
+#include "backlight.h"
 #include "globals.h"
+#include "strview.h"
+#include "translit.h"
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 
 // Display condiviso
 extern Arduino_RGB_Display *gfx;
 
-/* ============================================================================
-   BACKLIGHT (PWM su pin 38)
-============================================================================ */
-#define GFX_BL 38
-#define PWM_CHANNEL 0
-#define PWM_FREQ 1000
-#define PWM_BITS 8
-
 /* ============================================================================
    drawRLE — Decodifica immagini RLE 480×480 RGB565 (splash/logo)
    Ogni "run" contiene: colore + conteggio pixel consecutivi
@@ -64,25 +59,6 @@ inline void drawRLE(int x, int y, int w, int h, const RLERun *data,
   }
 }
 
-/* ============================================================================
-   FADE VELOCI (transizioni pagina)
-============================================================================ */
-inline void quickFadeOut() {
-  const int maxDuty = (1 << PWM_BITS) - 1;
-  for (int i = 50; i >= 0; i--) {
-    ledcWrite(PWM_CHANNEL, (maxDuty * i) / 50);
-    delay(2);
-  }
-}
-
-inline void quickFadeIn() {
-  const int maxDuty = (1 << PWM_BITS) - 1;
-  for (int i = 0; i <= 50; i++) {
-    ledcWrite(PWM_CHANNEL, (maxDuty * i) / 50);
-    delay(2);
-  }
-}
-
 /* ============================================================================
    Kickstart pannello ST7701 (inizializzazione sequenza)
 ============================================================================ */
@@ -96,158 +72,36 @@ inline void panelKickstart() {
 }
 
 /* ============================================================================
-   SPLASH pieni
+   SPLASH pieni (la retroilluminazione la gestisce chi chiama)
 ============================================================================ */
-inline void showSplashFadeInOnly(const RLERun *rle, size_t runs,
-                                 uint16_t holdMs) {
+inline void drawSplash(const RLERun *rle, size_t runs) {
   gfx->fillScreen(RGB565_BLACK);
   drawRLE(0, 0, 480, 480, rle, runs);
-
-  ledcSetup(PWM_CHANNEL, PWM_FREQ, PWM_BITS);
-  ledcAttachPin(GFX_BL, PWM_CHANNEL);
-
-  const int maxDuty = (1 << PWM_BITS) - 1;
-
-  // fade-in lento
-  for (int i = 0; i <= 500; i++) {
-    ledcWrite(PWM_CHANNEL, (maxDuty * i) / 500);
-    delay(5);
-  }
-
-  delay(holdMs);
 }
 
-inline void splashFadeOut() {
-  const int maxDuty = (1 << PWM_BITS) - 1;
-
-  for (int i = 250; i >= 0; i--) {
-    ledcWrite(PWM_CHANNEL, (maxDuty * i) / 250);
-    delay(5);
-  }
-
-  gfx->fillScreen(COL_BG);
+// Splash di avvio: disegno + accensione rapida, la durata la decide il
+// boot a stadi nel loop (nessuna attesa qui)
+inline void showSplashNow(const RLERun *rle, size_t runs) {
+  drawSplash(rle, runs);
+  blFadeTo(BL_MAX, BL_QUICK_MS);
 }
 
 /* ============================================================================
-   FADE-IN UI (dopo splash o cambio pagina)
-============================================================================ */
-inline void fadeInUI() {
-  ledcSetup(PWM_CHANNEL, PWM_FREQ, PWM_BITS);
-  ledcAttachPin(GFX_BL, PWM_CHANNEL);
-
-  const int maxDuty = (1 << PWM_BITS) - 1;
-
-  ledcWrite(PWM_CHANNEL, 0);
-  for (int i = 0; i <= 250; i++) {
-    ledcWrite(PWM_CHANNEL, (maxDuty * i) / 250);
-    delay(5);
-  }
-}
-
-/* ============================================================================
-   Splash “cosino” per rotazione pagina (fade-in + hold)
-============================================================================ */
-inline void showCycleSplash(const RLERun *data, size_t runs, uint16_t holdMs) {
-  gfx->fillScreen(RGB565_BLACK);
-  drawRLE(0, 0, 480, 480, data, runs);
-
-  ledcSetup(PWM_CHANNEL, PWM_FREQ, PWM_BITS);
-  ledcAttachPin(GFX_BL, PWM_CHANNEL);
-
-  const int maxDuty = (1 << PWM_BITS) - 1;
-
-  for (int i = 0; i <= 500; i++) {
-    ledcWrite(PWM_CHANNEL, (maxDuty * i) / 500);
-    delay(5);
-  }
-
-  delay(holdMs);
-}
-
-/* ============================================================================
-   sanitizeText — converte UTF-8 accentate in ASCII safe
-   Usato da: News, Meteo, QOD
+   sanitizeText — UTF-8 → ASCII per il font del pannello (vedi translit.h)
+   Da chiamare una volta all'ingresso del dato: i render stampano così com'è
 ============================================================================ */
 inline String sanitizeText(const String &in) {
-  String out;
-  out.reserve(in.length());
+  const size_t n = in.length();
+  char stackBuf[256];
+  char *buf = n < sizeof(stackBuf) ? stackBuf : (char *)malloc(n + 1);
+  if (!buf)
+    return String();
 
-  for (int i = 0; i < in.length();) {
-    uint8_t c = (uint8_t)in[i];
+  tlToAscii(in.c_str(), n, buf, n + 1);
+  String out(buf);
 
-    if (c < 0x80) {
-      out += (char)c;
-      i++;
-      continue;
-    }
-
-    if (c == 0xC3 && i + 1 < in.length()) {
-      uint8_t c2 = (uint8_t)in[i + 1];
-      switch (c2) {
-      case 0xA0:
-      case 0xA1:
-        out += 'a';
-        break;
-      case 0xA8:
-      case 0xA9:
-        out += 'e';
-        break;
-      case 0xAC:
-      case 0xAD:
-        out += 'i';
-        break;
-      case 0xB2:
-      case 0xB3:
-        out += 'o';
-        break;
-      case 0xB9:
-      case 0xBA:
-        out += 'u';
-        break;
-      default:
-        out += '?';
-      }
-      i += 2;
-      continue;
-    }
-
-    out += '?';
-    i++;
-  }
-
-  while (out.indexOf("  ") >= 0)
-    out.replace("  ", " ");
-  out.trim();
-  return out;
-}
-
-/* ============================================================================
-   decodeJsonUnicode — converte sequenze \uXXXX in UTF-8 reale
-   Usato nel parsing OpenAI JSON
-============================================================================ */
-inline String decodeJsonUnicode(const String &s) {
-  String out;
-  out.reserve(s.length());
-
-  for (int i = 0; i < s.length(); i++) {
-    if (s[i] == '\\' && i + 5 < s.length() && s[i + 1] == 'u') {
-      int code = strtol(s.substring(i + 2, i + 6).c_str(), nullptr, 16);
-
-      if (code < 0x80)
-        out += char(code);
-      else if (code < 0x800) {
-        out += char(0xC0 | (code >> 6));
-        out += char(0x80 | (code & 0x3F));
-      } else {
-        out += char(0xE0 | (code >> 12));
-        out += char(0x80 | ((code >> 6) & 0x3F));
-        out += char(0x80 | (code & 0x3F));
-      }
-
-      i += 5;
-    } else
-      out += s[i];
-  }
+  if (buf != stackBuf)
+    free(buf);
   return out;
 }
 
@@ -276,11 +130,10 @@ inline String jsonEscape(const String &s) {
 /* ============================================================================
    TEXT RENDERING — bold offset 4px e paragrafi word-wrap
 ============================================================================ */
-inline void drawBoldTextColored(int16_t x, int16_t y, const String &raw,
+// Testo già sanitizzato all'ingresso (sanitizeText): stampato così com'è
+inline void drawBoldTextColored(int16_t x, int16_t y, const String &s,
                                 uint16_t fg, uint16_t bg,
                                 uint8_t scale = TEXT_SCALE) {
-  String s = sanitizeText(raw);
-
   gfx->setTextSize(scale);
   gfx->setTextColor(fg, bg);
 
@@ -307,10 +160,10 @@ inline void drawBoldMain(int16_t x, int16_t y, const String &raw) {
 ============================================================================ */
 inline String getFormattedDateTime(); // forward
 
-inline void drawHeader(const String &titleRaw) {
+inline void drawHeader(const String &title) {
   gfx->fillRect(0, 0, 480, 50, COL_HEADER);
 
-  drawBoldTextColored(16, 20, sanitizeText(titleRaw), COL_TEXT, COL_HEADER);
+  drawBoldTextColored(16, 20, title, COL_TEXT, COL_HEADER);
 
   String dt = getFormattedDateTime();
   if (dt.length()) {
@@ -330,7 +183,7 @@ inline void drawHLine(int y) {
    drawParagraph — testo multi-linea con word-wrap
    NO background, solo colore testo
 ============================================================================ */
-inline void drawParagraph(int16_t x, int16_t y, int16_t w, const String &text,
+inline void drawParagraph(int16_t x, int16_t y, int16_t w, const String &s,
                           uint8_t scale) {
   int maxChars = w / (BASE_CHAR_W * scale);
   if (maxChars < 8)
@@ -339,7 +192,6 @@ inline void drawParagraph(int16_t x, int16_t y, int16_t w, const String &text,
   gfx->setTextSize(scale);
   gfx->setTextColor(COL_TEXT, COL_TEXT); // nessuno sfondo visibile
 
-  String s = sanitizeText(text);
   int start = 0;
 
   while (start < s.length()) {
@@ -353,11 +205,10 @@ inline void drawParagraph(int16_t x, int16_t y, int16_t w, const String &text,
         cut = sp;
     }
 
-    String line = s.substring(start, cut);
-    line.trim();
+    const StrView line = StrView(s).sub(start, cut - start).trim();
 
     gfx->setCursor(x, y);
-    gfx->print(line);
+    gfx->write((const uint8_t *)line.begin(), line.size());
 
     y += BASE_CHAR_H * scale + 6;
     start = (cut < s.length() && s[cut] == ' ') ? cut + 1 : cut;
@@ -406,55 +257,6 @@ inline String formatShortDate(time_t tt) {
   return String(buf);
 }
 
-/* ============================================================================
-   JSON HELPERS — mini-parser manuali
-============================================================================ */
-inline bool jsonFindStringKV(const String &body, const String &key, int from,
-                             String &outVal) {
-  String k = "\"" + key + "\"";
-  int p = body.indexOf(k, from);
-  if (p < 0)
-    return false;
-  p = body.indexOf(':', p);
-  if (p < 0)
-    return false;
-
-  int q1 = body.indexOf('"', p + 1);
-  if (q1 < 0)
-    return false;
-  int q2 = body.indexOf('"', q1 + 1);
-  if (q2 < 0)
-    return false;
-
-  outVal = body.substring(q1 + 1, q2);
-  return true;
-}
-
-inline bool jsonFindIntKV(const String &body, const String &key, int from,
-                          int &outVal) {
-  String k = "\"" + key + "\"";
-  int p = body.indexOf(k, from);
-  if (p < 0)
-    return false;
-  p = body.indexOf(':', p);
-  if (p < 0)
-    return false;
-
-  int s = p + 1;
-  while (s < body.length() && isspace(body[s]))
-    s++;
-
-  int e = s;
-  while (e < body.length() && isdigit(body[e]))
-    e++;
-
-  if (e <= s)
-    return false;
-
-  outVal = body.substring(s, e).toInt();
-  return true;
-}
-
 /* ============================================================================
    PAGING HELPERS — gestione pagine attive
 ============================================================================ */
@@ -507,6 +309,17 @@ inline bool advanceToNextEnabled() {
   return false;
 }
 
+// Pagina attiva successiva (dir = 1) o precedente (dir = -1) di p; -1 se
+// nessuna
+inline int adjacentEnabledPage(int p, int dir) {
+  for (int k = 0; k < PAGES; k++) {
+    p = (p + dir + PAGES) % PAGES;
+    if (g_show[p])
+      return p;
+  }
+  return -1;
+}
+
 inline void ensureCurrentPageEnabled() {
   if (g_show[g_page])
     return;
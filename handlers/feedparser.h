@@ -0,0 +1,372 @@
+/*
+===============================================================================
+   SQUARED — FEED PARSER (RSS / Atom in streaming)
+   Descrizione: macchina a stati XML a memoria limitata che gira direttamente
+                sui blocchi ricevuti dal socket. Estrae i titoli di <item>
+                (RSS) e <entry> (Atom), gestisce CDATA, commenti, entità
+                nominali e numeriche in un solo passaggio e segnala quando ha
+                raccolto abbastanza titoli per chiudere la connessione.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • FeedScanner fs(out, max)       out = array di String da riempire
+     fs.feed(data, len)             false quando ha max titoli (stop HTTP)
+     fs.count                       titoli raccolti
+
+   • Memoria: stato fisso (~240 byte), nessuna String temporanea durante
+     la scansione. I titoli oltre FEED_TITLE_MAX byte vengono troncati.
+
+   • Prefissi atom: e rss: scartati ("atom:title" = "title"); i tag con
+     altri prefissi (media:title, itunes:title, dc:title) sono ignorati e
+     non toccano il titolo. Attributi saltati, tag annidati nel titolo
+     rimossi, spazi multipli compressi.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+
+#include "jsonhelpers.h"
+
+static constexpr uint8_t FEED_TITLE_MAX = 192;
+static constexpr uint8_t FEED_NAME_MAX = 8; // basta per item/entry/title
+static constexpr uint8_t FEED_ENT_MAX = 10;
+
+// Prefissi namespace che portano gli stessi tag di RSS/Atom
+static inline bool feedKnownNs(const char *n, uint8_t len) {
+  return (len == 4 && !memcmp(n, "atom", 4)) ||
+         (len == 3 && !memcmp(n, "rss", 3));
+}
+
+enum FeedState : uint8_t {
+  FS_TEXT = 0,
+  FS_ENTITY,   // &...;
+  FS_TAG_OPEN, // subito dopo '<'
+  FS_NAME,     // nome del tag
+  FS_ATTRS,    // attributi fino a '>'
+  FS_BANG,     // "<!" → CDATA / commento / dichiarazione
+  FS_CDATA,
+  FS_COMMENT,
+  FS_DECL,
+  FS_PI // <? ... ?>
+};
+
+struct FeedScanner {
+  String *out;
+  uint8_t max;
+  uint8_t count;
+
+  uint8_t st;
+  bool closing;  // </tag>
+  bool inEntry;  // dentro <item>/<entry>
+  bool inTitle;  // dentro <title> di un item
+  bool gotTitle; // titolo completo per l'item corrente
+  char quote;    // virgolette aperte negli attributi
+  char prev;     // ultimo carattere del tag ('/' → self-closing)
+  uint8_t run;   // contatore per terminatori ("]]>", "-->", "[CDATA[")
+
+  char name[FEED_NAME_MAX + 1];
+  uint8_t nameLen;
+  bool nameLong;
+
+  char ent[FEED_ENT_MAX + 1];
+  uint8_t entLen;
+
+  char title[FEED_TITLE_MAX + 1];
+  uint8_t tlen;
+
+  FeedScanner(String *dst, uint8_t n)
+      : out(dst), max(n), count(0), st(FS_TEXT), closing(false),
+        inEntry(false), inTitle(false), gotTitle(false), quote(0), prev(0),
+        run(0), nameLen(0), nameLong(false), entLen(0), tlen(0) {
+    name[0] = ent[0] = title[0] = 0;
+  }
+
+  bool full() const { return count >= max; }
+
+  // -------------------------------------------------------------------------
+  // Testo del titolo (spazi compressi, troncamento silenzioso)
+  // -------------------------------------------------------------------------
+  void putc_(char c) {
+    if (!inTitle)
+      return;
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+      if (!tlen || title[tlen - 1] == ' ')
+        return;
+      c = ' ';
+    }
+    if (tlen < FEED_TITLE_MAX)
+      title[tlen++] = c;
+  }
+
+  void putn_(const char *s, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++)
+      putc_(s[i]);
+  }
+
+  // -------------------------------------------------------------------------
+  // Entità: &amp; &lt; &gt; &quot; &apos; &nbsp; &#NN; &#xHH;
+  // -------------------------------------------------------------------------
+  void flushEntity() {
+    ent[entLen] = 0;
+    char tmp[4];
+
+    if (ent[0] == '#') {
+      uint32_t cp = 0;
+      const bool hex = (ent[1] == 'x' || ent[1] == 'X');
+      const char *p = ent + (hex ? 2 : 1);
+      bool ok = *p != 0;
+      for (; *p && ok; p++) {
+        char c = *p;
+        if (c >= '0' && c <= '9')
+          cp = cp * (hex ? 16 : 10) + (c - '0');
+        else if (hex && (c | 32) >= 'a' && (c | 32) <= 'f')
+          cp = cp * 16 + ((c | 32) - 'a' + 10);
+        else
+          ok = false;
+      }
+      if (ok && cp && cp < 0x110000) {
+        putn_(tmp, jsonPutUtf8(cp == 0xA0 ? ' ' : cp, tmp));
+        return;
+      }
+    } else if (!strcmp(ent, "amp")) {
+      putc_('&');
+      return;
+    } else if (!strcmp(ent, "lt")) {
+      putc_('<');
+      return;
+    } else if (!strcmp(ent, "gt")) {
+      putc_('>');
+      return;
+    } else if (!strcmp(ent, "quot")) {
+      putc_('"');
+      return;
+    } else if (!strcmp(ent, "apos")) {
+      putc_('\'');
+      return;
+    } else if (!strcmp(ent, "nbsp")) {
+      putc_(' ');
+      return;
+    }
+
+    // sconosciuta: copiata com'era
+    putc_('&');
+    putn_(ent, entLen);
+    putc_(';');
+  }
+
+  // -------------------------------------------------------------------------
+  // Eventi tag
+  // -------------------------------------------------------------------------
+  bool nameIs(const char *s) const { return !nameLong && !strcmp(name, s); }
+
+  void emit() {
+    title[tlen] = 0;
+
+    // Atom type="html": markup arrivato come &lt;b&gt; → rimosso qui.
+    // Solo '<' seguito da lettera, '/' o '!': "3 &lt; 5" resta testo.
+    if (memchr(title, '<', tlen)) {
+      uint8_t w = 0;
+      bool tag = false;
+      for (uint8_t i = 0; i < tlen; i++) {
+        const char nx = i + 1 < tlen ? title[i + 1] : 0;
+        if (!tag && title[i] == '<' &&
+            (isalpha((uint8_t)nx) || nx == '/' || nx == '!'))
+          tag = true;
+        else if (tag && title[i] == '>')
+          tag = false;
+        else if (!tag)
+          title[w++] = title[i];
+      }
+      tlen = w;
+      title[tlen] = 0;
+    }
+
+    while (tlen && title[tlen - 1] == ' ')
+      title[--tlen] = 0;
+
+    if (tlen && count < max)
+      out[count++] = title;
+  }
+
+  void onTag(bool selfClose) {
+    if (!closing) {
+      if (nameIs("item") || nameIs("entry")) {
+        inEntry = !selfClose;
+        gotTitle = false;
+        tlen = 0;
+      } else if (inEntry && !gotTitle && nameIs("title") && !selfClose) {
+        inTitle = true;
+        tlen = 0;
+      }
+      return;
+    }
+
+    if (inTitle && nameIs("title")) {
+      inTitle = false;
+      gotTitle = true;
+    } else if (inEntry && (nameIs("item") || nameIs("entry"))) {
+      if (gotTitle)
+        emit();
+      inEntry = inTitle = gotTitle = false;
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  // Scansione di un blocco (può interrompersi in qualsiasi punto)
+  // -------------------------------------------------------------------------
+  bool feed(const char *d, size_t n) {
+    for (size_t i = 0; i < n && !full(); i++) {
+      const char c = d[i];
+
+      switch (st) {
+      case FS_TEXT:
+        if (c == '<')
+          st = FS_TAG_OPEN;
+        else if (c == '&' && inTitle) {
+          st = FS_ENTITY;
+          entLen = 0;
+        } else
+          putc_(c);
+        break;
+
+      case FS_ENTITY:
+        if (c == ';') {
+          flushEntity();
+          st = FS_TEXT;
+        } else if (entLen < FEED_ENT_MAX && c != '<' && c != '&' &&
+                   c != ' ') {
+          ent[entLen++] = c;
+        } else {
+          // '&' isolato: testo letterale, il carattere va rielaborato
+          putc_('&');
+          putn_(ent, entLen);
+          st = FS_TEXT;
+          i--;
+        }
+        break;
+
+      case FS_TAG_OPEN:
+        closing = false;
+        nameLen = 0;
+        nameLong = false;
+        prev = 0;
+        if (c == '/') {
+          closing = true;
+          st = FS_NAME;
+        } else if (c == '!') {
+          st = FS_BANG;
+          run = 0;
+        } else if (c == '?') {
+          st = FS_PI;
+          run = 0;
+        } else {
+          st = FS_NAME;
+          i--;
+        }
+        break;
+
+      case FS_NAME:
+        if (c == '>' || c == '/' || c == ' ' || c == '\t' || c == '\r' ||
+            c == '\n') {
+          name[nameLen] = 0;
+          st = FS_ATTRS;
+          quote = 0;
+          i--;
+        } else if (c == ':') {
+          if (!nameLong && feedKnownNs(name, nameLen)) {
+            nameLen = 0; // atom:/rss: scartato, resta il nome locale
+          } else {
+            nameLong = true; // media:, itunes:, dc:… → tag ignorato
+          }
+        } else if (nameLen < FEED_NAME_MAX) {
+          name[nameLen++] = (c >= 'A' && c <= 'Z') ? c + 32 : c;
+        } else {
+          nameLong = true;
+        }
+        break;
+
+      case FS_ATTRS:
+        if (quote) {
+          if (c == quote)
+            quote = 0;
+        } else if (c == '"' || c == '\'') {
+          quote = c;
+        } else if (c == '>') {
+          onTag(prev == '/');
+          st = FS_TEXT;
+        }
+        if (!quote && c != ' ')
+          prev = c;
+        break;
+
+      case FS_BANG: {
+        // prev = '-' (commento) o '[' (CDATA) dopo il primo carattere
+        static const char CD[] = "[CDATA[";
+        if (run == 0) {
+          if (c == '-' || c == '[') {
+            prev = c;
+            run = 1;
+          } else {
+            st = (c == '>') ? FS_TEXT : FS_DECL;
+          }
+        } else if (prev == '-') {
+          st = (c == '-') ? FS_COMMENT : FS_DECL;
+          run = 0;
+        } else if (c == CD[run]) {
+          if (++run == 7) {
+            st = FS_CDATA;
+            run = 0;
+          }
+        } else {
+          st = (c == '>') ? FS_TEXT : FS_DECL;
+        }
+        break;
+      }
+
+      case FS_CDATA:
+        // "]]>" chiude; le ']' in sospeso tornano testo se non segue '>'
+        if (c == ']') {
+          if (run < 2)
+            run++;
+          else
+            putc_(']');
+        } else if (c == '>' && run == 2) {
+          st = FS_TEXT;
+          run = 0;
+        } else {
+          for (; run; run--)
+            putc_(']');
+          putc_(c);
+        }
+        break;
+
+      case FS_COMMENT:
+        if (c == '-')
+          run = run < 2 ? run + 1 : 2;
+        else if (c == '>' && run == 2)
+          st = FS_TEXT;
+        else
+          run = 0;
+        break;
+
+      case FS_DECL:
+        if (c == '>')
+          st = FS_TEXT;
+        break;
+
+      case FS_PI:
+        if (c == '>' && run)
+          st = FS_TEXT;
+        run = (c == '?');
+        break;
+      }
+    }
+    return !full();
+  }
+};
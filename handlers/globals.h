@@ -33,7 +33,7 @@ struct CosinoRLE {
    FUNZIONI GLOBALI
 ============================================================================ */
 String sanitizeText(const String &in);
-String htmlSettings(bool saved, const String &msg);
+void sendSettings(bool saved, const String &msg);
 extern String g_note;
 
 /* ============================================================================
@@ -94,10 +94,9 @@ bool geocodeIfNeeded();
 extern String formatShortDate(time_t t);
 inline bool isHttpOk(int code) { return code >= 200 && code < 300; }
 
-extern bool jsonFindStringKV(const String &body, const String &key, int from,
-                             String &outVal);
 extern String g_ha_ip;
 extern String g_ha_token;
+extern String g_ha_ents;
 
 void softReboot();
 extern int temp24_progress;
@@ -131,8 +130,20 @@ extern bool g_show[PAGES];
 extern int g_page;
 extern uint16_t g_air_bg;
 extern bool g_timeSynced;
+extern volatile bool g_timeApprox; // ora ripresa dal flash, in attesa di SNTP
 extern bool g_splash_enabled;
 
+/* ============================================================================
+   MODALITÀ NOTTE (vedi nightmode.h)
+============================================================================ */
+struct NightCfg {
+  bool on;
+  uint8_t from, to; // ore locali, fascia [from, to) anche oltre mezzanotte
+  uint8_t dim;      // % di retroilluminazione a metà notte
+  uint8_t ramp;     // minuti di passaggio graduale a inizio e fine fascia
+};
+extern NightCfg g_night;
+
 uint32_t pagesMaskFromArray();
 void pagesArrayFromMask(uint32_t mask);
 int firstEnabledPage();
@@ -143,9 +154,22 @@ void pageBinaryClock();
 void pageChronos();
 
 /* ============================================================================
-   REFRESH FLAG
+   REFRESH FLAG / RICHIESTE DAL TASK WEB AL LOOP
 ============================================================================ */
 extern volatile bool g_dataRefreshPending;
+extern volatile bool g_forceQodPending;
+extern volatile bool g_rebootPending;
+
+/* ============================================================================
+   BOOT A STADI — tempi in ms dal reset (0 = non ancora), per /api/state
+============================================================================ */
+struct BootTimes {
+  uint32_t firstFrame; // prima pagina visibile
+  uint32_t wifi;       // Wi-Fi connesso
+  uint32_t time;       // ora valida (RTC sopravvissuto al reset o NTP)
+  uint32_t fresh;      // primo giro completo di fetch
+};
+extern BootTimes g_boot;
 
 /* ============================================================================
    REFRESH DISTRIBUITO (scheduler)
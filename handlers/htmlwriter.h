@@ -0,0 +1,124 @@
+/*
+===============================================================================
+   SQUARED — HTML WRITER (risposte chunked a buffer fisso)
+   Descrizione: scrive pagine HTML in risposta chunked
+                (CONTENT_LENGTH_UNKNOWN) passando da un buffer statico di
+                1 KB: frammenti di template in PROGMEM, valori dinamici
+                con escape HTML scritti nel buffer senza String
+                temporanee. Ogni KB pieno va ad AsyncWeb come chunk.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • HtmlWriter w(web);
+     w.begin(200);                   header + avvio chunked
+     w.P(FRAGMENT)                   frammento PROGMEM così com'è
+     w.s("testo") / w.s(String)      testo fidato (etichette, markup)
+     w.esc(valore)                   valore utente con & < > " ' escapati
+     w.num(v) / w.num(f, decimali)
+     w.end();                        ultimo chunk + chunk vuoto finale
+
+   Il buffer è unico e statico: un solo writer attivo alla volta (il
+   server esegue un handler per volta nel suo task, vedi asyncweb.h).
+   Dove finiscono i chunk:
+     - rotte senza lock, o handler che ha già chiamato web.unlock():
+       subito sul socket, la pagina non sta mai tutta in RAM;
+     - handler ancora sotto StateLock: nel buffer di risposta di
+       AsyncWeb (web_out, max WEB_MAX_RESP), al socket a lock rilasciato.
+   Le pagine lunghe copiano le globali e chiamano web.unlock() prima di
+   w.begin() (impostazioni, /api/state, /api/config).
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include "asyncweb.h"
+
+static constexpr size_t HTML_CHUNK = 1024;
+static char html_buf[HTML_CHUNK];
+
+class HtmlWriter {
+public:
+  explicit HtmlWriter(AsyncWeb &srv) : srv(srv) {}
+
+  void begin(int code, const char *type = "text/html; charset=utf-8") {
+    n = 0;
+    srv.sendHeader(F("Cache-Control"), F("no-store"));
+    srv.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    srv.send(code, type, "");
+  }
+
+  // Testo fidato in RAM/flash mappata
+  void s(const char *t, size_t len) {
+    while (len) {
+      size_t k = HTML_CHUNK - n;
+      if (k > len)
+        k = len;
+      memcpy(html_buf + n, t, k);
+      n += k;
+      t += k;
+      len -= k;
+      if (n == HTML_CHUNK)
+        flush();
+    }
+  }
+  void s(const char *t) { s(t, strlen(t)); }
+  void s(const String &t) { s(t.c_str(), t.length()); }
+
+  // Frammento PROGMEM
+  void P(PGM_P t) {
+    char c;
+    while ((c = pgm_read_byte(t++)))
+      put(c);
+  }
+
+  // Valore dinamico: escape HTML direttamente nel buffer
+  void esc(const char *t) {
+    for (; *t; t++) {
+      switch (*t) {
+      case '&': s("&amp;", 5); break;
+      case '<': s("&lt;", 4); break;
+      case '>': s("&gt;", 4); break;
+      case '"': s("&quot;", 6); break;
+      case '\'': s("&#39;", 5); break;
+      default: put(*t);
+      }
+    }
+  }
+  void esc(const String &t) { esc(t.c_str()); }
+
+  void num(long v) {
+    char tmp[12];
+    s(tmp, snprintf(tmp, sizeof(tmp), "%ld", v));
+  }
+  void num(double v, uint8_t decimals) {
+    char tmp[32];
+    const int k = snprintf(tmp, sizeof(tmp), "%.*f", decimals, v);
+    s(tmp, k < (int)sizeof(tmp) ? k : sizeof(tmp) - 1);
+  }
+
+  void flush() {
+    if (!n)
+      return;
+    srv.sendContent(html_buf, n);
+    n = 0;
+  }
+
+  void end() {
+    flush();
+    srv.sendContent(""); // chunk vuoto: fine risposta
+  }
+
+private:
+  inline void put(char c) {
+    html_buf[n++] = c;
+    if (n == HTML_CHUNK)
+      flush();
+  }
+
+  AsyncWeb &srv;
+  size_t n = 0;
+};
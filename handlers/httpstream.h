@@ -0,0 +1,393 @@
+/*
+===============================================================================
+   SQUARED — HTTP STREAM (fetch in streaming + gzip/deflate)
+   Descrizione: GET HTTP(S) con negoziazione automatica Accept-Encoding,
+                decompressione incrementale gzip/zlib/deflate tramite tinfl
+                (miniz in ROM) con finestra 32 KB in PSRAM e consegna dei
+                blocchi decompressi direttamente al parser chiamante, senza
+                mai materializzare il body compresso.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • httpStream(url, timeoutMs, sink [,bearer [,status]])
+       Scarica url e chiama sink(data, len) per ogni blocco di testo già
+       decompresso. Se sink ritorna false la connessione viene chiusa
+       subito (parser che hanno già tutto quello che serve) e la chiamata
+       riesce: un sink che fallisce (es. heap esaurito) deve ricordarselo
+       e farlo fallire lui. status, se indicato, riceve il codice HTTP
+       (≤ 0 = errore di connessione).
+
+   • httpGET(url, out [,timeoutMs])
+       Come httpStream, con il body (già decompresso) accumulato in out;
+       fallisce anche se out non riesce a crescere (heap esaurito).
+
+   • Body troncato = errore: connessione chiusa prima di Content-Length
+     o prima della fine dello stream compresso.
+
+   • La richiesta usa HTTP/1.0: niente chunked transfer, header
+     Accept-Encoding gestito da noi e stream leggibile direttamente dal
+     socket.
+
+   • Decompressore e dizionario vengono allocati una sola volta (PSRAM se
+     presente) al primo body compresso e poi riusati.
+
+   • Con SQUARED_MOCK_API definito ogni URL viene dirottato sul server di
+     record/replay in tools/mock_api.py (vedi httpMockUrl).
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <esp_heap_caps.h>
+#include <functional>
+
+#if CONFIG_IDF_TARGET_ESP32S3
+#include "esp32s3/rom/miniz.h"
+#else
+#include "rom/miniz.h"
+#endif
+
+typedef std::function<bool(const char *data, size_t len)> HttpSink;
+
+// ---------------------------------------------------------------------------
+// Contatori cumulativi (byte ricevuti dal socket / byte consegnati ai parser)
+// ---------------------------------------------------------------------------
+static uint32_t http_wireBytes = 0;
+static uint32_t http_bodyBytes = 0;
+
+// ---------------------------------------------------------------------------
+// Stato inflate
+// ---------------------------------------------------------------------------
+static constexpr size_t HTTP_DICT_SIZE = TINFL_LZ_DICT_SIZE; // 32 KB
+static constexpr size_t HTTP_RX_CHUNK = 1024;
+
+enum HttpEnc : uint8_t { HE_IDENTITY = 0, HE_GZIP, HE_DEFLATE };
+
+enum GzStage : uint8_t {
+  GZ_FIXED = 0,
+  GZ_EXTRA_LEN,
+  GZ_EXTRA,
+  GZ_NAME,
+  GZ_COMMENT,
+  GZ_HCRC,
+  GZ_BODY
+};
+
+static tinfl_decompressor *http_tinfl = nullptr;
+static uint8_t *http_dict = nullptr;
+
+struct HttpInflate {
+  HttpEnc enc;
+  uint8_t gzStage;
+  uint8_t gzFlags;
+  uint16_t gzNeed; // byte ancora da saltare nello stage corrente
+  uint32_t flags;  // flag tinfl
+  size_t dictOfs;
+  uint8_t head[2]; // primi byte deflate (detect zlib/raw)
+  uint8_t headLen;
+  bool done;
+};
+
+static void *httpBigAlloc(size_t n) {
+  void *p = heap_caps_malloc(n, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  return p ? p : malloc(n);
+}
+
+static bool httpInflateBegin(HttpInflate &z, HttpEnc enc) {
+  z.enc = enc;
+  z.gzStage = GZ_FIXED;
+  z.gzFlags = 0;
+  z.gzNeed = 10;
+  z.flags = TINFL_FLAG_HAS_MORE_INPUT;
+  z.dictOfs = 0;
+  z.headLen = 0;
+  z.done = false;
+
+  if (enc == HE_IDENTITY)
+    return true;
+
+  if (!http_tinfl)
+    http_tinfl = (tinfl_decompressor *)httpBigAlloc(sizeof(tinfl_decompressor));
+  if (!http_dict)
+    http_dict = (uint8_t *)httpBigAlloc(HTTP_DICT_SIZE);
+  if (!http_tinfl || !http_dict)
+    return false;
+
+  tinfl_init(http_tinfl);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Header gzip (RFC 1952) consumato byte per byte, anche a cavallo di chunk
+// ---------------------------------------------------------------------------
+static size_t gzSkipHeader(HttpInflate &z, const uint8_t *p, size_t n) {
+  size_t i = 0;
+
+  while (i < n && z.gzStage != GZ_BODY) {
+    const uint8_t c = p[i++];
+
+    switch (z.gzStage) {
+    case GZ_FIXED:
+      if (z.gzNeed == 7) // byte FLG (ID1 ID2 CM FLG …)
+        z.gzFlags = c;
+      if (--z.gzNeed == 0) {
+        z.gzStage = GZ_EXTRA_LEN;
+        z.gzNeed = 2;
+        if (!(z.gzFlags & 0x04))
+          z.gzStage = GZ_NAME;
+      }
+      break;
+
+    case GZ_EXTRA_LEN:
+      // XLEN little-endian: primo byte basso, poi alto
+      if (z.gzNeed == 2) {
+        z.gzNeed = 0x100 | c; // marker "ho già il byte basso"
+      } else {
+        z.gzNeed = ((uint16_t)c << 8) | (z.gzNeed & 0xFF);
+        z.gzStage = z.gzNeed ? GZ_EXTRA : GZ_NAME;
+      }
+      break;
+
+    case GZ_EXTRA:
+      if (--z.gzNeed == 0)
+        z.gzStage = GZ_NAME;
+      break;
+
+    case GZ_NAME:
+      if (!(z.gzFlags & 0x08) || c == 0) {
+        z.gzStage = GZ_COMMENT;
+        if (!(z.gzFlags & 0x08))
+          i--; // nessun nome: il byte appartiene allo stage successivo
+      }
+      break;
+
+    case GZ_COMMENT:
+      if (!(z.gzFlags & 0x10) || c == 0) {
+        z.gzStage = GZ_HCRC;
+        z.gzNeed = 2;
+        if (!(z.gzFlags & 0x10))
+          i--;
+      }
+      break;
+
+    case GZ_HCRC:
+      if (!(z.gzFlags & 0x02)) {
+        z.gzStage = GZ_BODY;
+        i--;
+      } else if (--z.gzNeed == 0) {
+        z.gzStage = GZ_BODY;
+      }
+      break;
+    }
+  }
+  return i;
+}
+
+// ---------------------------------------------------------------------------
+// tinfl su n byte compressi → sink, a blocchi della finestra circolare
+// ---------------------------------------------------------------------------
+static bool httpInflateRun(HttpInflate &z, const uint8_t *p, size_t n,
+                           const HttpSink &sink, bool &stopped) {
+  while (true) {
+    size_t inBytes = n;
+    size_t outBytes = HTTP_DICT_SIZE - z.dictOfs;
+
+    tinfl_status st =
+        tinfl_decompress(http_tinfl, p, &inBytes, http_dict,
+                         http_dict + z.dictOfs, &outBytes, z.flags);
+
+    p += inBytes;
+    n -= inBytes;
+
+    if (outBytes) {
+      http_bodyBytes += outBytes;
+      if (!sink((const char *)(http_dict + z.dictOfs), outBytes)) {
+        stopped = true;
+        return false;
+      }
+      z.dictOfs = (z.dictOfs + outBytes) & (HTTP_DICT_SIZE - 1);
+    }
+
+    if (st == TINFL_STATUS_DONE) {
+      z.done = true;
+      return true;
+    }
+    if (st < TINFL_STATUS_DONE)
+      return false;
+    if (st == TINFL_STATUS_NEEDS_MORE_INPUT && n == 0)
+      return true;
+  }
+}
+
+// ---------------------------------------------------------------------------
+// Inflate di un blocco dal socket → sink. false = errore o sink fermato.
+// ---------------------------------------------------------------------------
+static bool httpInflateFeed(HttpInflate &z, const uint8_t *p, size_t n,
+                            const HttpSink &sink, bool &stopped) {
+  if (z.enc == HE_IDENTITY) {
+    http_bodyBytes += n;
+    if (!sink((const char *)p, n)) {
+      stopped = true;
+      return false;
+    }
+    return true;
+  }
+
+  if (z.done)
+    return true; // trailer gzip/adler: ignorato
+
+  if (z.enc == HE_GZIP && z.gzStage != GZ_BODY) {
+    size_t k = gzSkipHeader(z, p, n);
+    p += k;
+    n -= k;
+    if (!n)
+      return true;
+  }
+
+  if (z.enc == HE_DEFLATE && z.headLen < 2) {
+    // "deflate" via HTTP è quasi sempre zlib (RFC 1950), a volte raw: la
+    // scelta dipende dai primi due byte, anche se arrivano separati
+    while (z.headLen < 2 && n) {
+      z.head[z.headLen++] = *p++;
+      n--;
+    }
+    if (z.headLen < 2)
+      return true;
+    if ((z.head[0] & 0x0F) == 8 && ((z.head[0] << 8) | z.head[1]) % 31 == 0)
+      z.flags |= TINFL_FLAG_PARSE_ZLIB_HEADER;
+    if (!httpInflateRun(z, z.head, 2, sink, stopped))
+      return false;
+    if (z.done)
+      return true;
+  }
+
+  return httpInflateRun(z, p, n, sink, stopped);
+}
+
+// ---------------------------------------------------------------------------
+// Mock API: "https://host/path" → "http://<SQUARED_MOCK_API>/https/host/path"
+// ---------------------------------------------------------------------------
+String httpMockUrl(const String &url) {
+#ifdef SQUARED_MOCK_API
+  int p = url.indexOf(F("://"));
+  if (p < 0)
+    return url;
+
+  String m = F("http://" SQUARED_MOCK_API "/");
+  m += url.substring(0, p);
+  m += '/';
+  m += url.substring(p + 3);
+  return m;
+#else
+  return url;
+#endif
+}
+
+// ---------------------------------------------------------------------------
+// httpStream — GET con Accept-Encoding e consegna incrementale al parser
+// ---------------------------------------------------------------------------
+bool httpStream(const String &url, uint32_t timeoutMs, const HttpSink &sink,
+                const char *bearer = nullptr, int *status = nullptr) {
+  HTTPClient http;
+  http.setTimeout(timeoutMs);
+  http.useHTTP10(true);
+
+  if (!http.begin(httpMockUrl(url)))
+    return false;
+
+  http.addHeader(F("Accept-Encoding"), F("gzip, deflate"));
+  if (bearer && *bearer) {
+    String auth = F("Bearer ");
+    auth += bearer;
+    http.addHeader(F("Authorization"), auth);
+  }
+
+  static const char *HDRS[] = {"Content-Encoding"};
+  http.collectHeaders(HDRS, 1);
+
+  int code = http.GET();
+  if (status)
+    *status = code;
+  if (code < 200 || code >= 300) {
+    http.end();
+    return false;
+  }
+
+  HttpEnc enc = HE_IDENTITY;
+  {
+    String ce = http.header("Content-Encoding");
+    ce.toLowerCase();
+    if (ce.indexOf(F("gzip")) >= 0)
+      enc = HE_GZIP;
+    else if (ce.indexOf(F("deflate")) >= 0)
+      enc = HE_DEFLATE;
+  }
+
+  HttpInflate z;
+  if (!httpInflateBegin(z, enc)) {
+    http.end();
+    return false;
+  }
+
+  WiFiClient *s = http.getStreamPtr();
+  int remaining = http.getSize(); // -1 = fino a chiusura connessione
+  uint8_t buf[HTTP_RX_CHUNK];
+
+  bool ok = true;
+  bool stopped = false;
+  uint32_t lastRx = millis();
+
+  while (remaining != 0 && (http.connected() || s->available())) {
+    size_t avail = s->available();
+    if (!avail) {
+      if (millis() - lastRx > timeoutMs) {
+        ok = false;
+        break;
+      }
+      delay(1);
+      continue;
+    }
+
+    size_t want = avail < sizeof(buf) ? avail : sizeof(buf);
+    if (remaining > 0 && want > (size_t)remaining)
+      want = remaining;
+
+    int got = s->read(buf, want);
+    if (got <= 0)
+      continue;
+
+    lastRx = millis();
+    http_wireBytes += got;
+    if (remaining > 0)
+      remaining -= got;
+
+    if (!httpInflateFeed(z, buf, got, sink, stopped)) {
+      ok = stopped;
+      break;
+    }
+  }
+
+  // Chiuso dal server prima della fine: dati parziali, non un fetch riuscito
+  if (ok && !stopped && (remaining > 0 || (enc != HE_IDENTITY && !z.done)))
+    ok = false;
+
+  http.end();
+  return ok;
+}
+
+// ---------------------------------------------------------------------------
+// httpGET() — body completo in out (per i JSON piccoli delle pagine)
+// ---------------------------------------------------------------------------
+bool httpGET(const String &url, String &out, uint32_t timeout = 10000) {
+  out = "";
+  bool full = true; // concat fallito: body troncato, non "basta così"
+  const bool ok = httpStream(url, timeout, [&](const char *d, size_t n) {
+    return full = out.concat(d, n);
+  });
+  return ok && full;
+}
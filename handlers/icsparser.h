@@ -0,0 +1,924 @@
+/*
+===============================================================================
+   SQUARED — ICS PARSER (streaming, fusi orari, ricorrenze)
+   Descrizione: parser iCalendar (RFC 5545) a memoria limitata che lavora sui
+                blocchi ricevuti dal socket: unfolding delle righe, DTSTART /
+                DTEND / DURATION con TZID (VTIMEZONE), 'Z' o ora flottante,
+                espansione RRULE (FREQ, INTERVAL, COUNT, UNTIL, BYDAY,
+                BYMONTHDAY, BYMONTH), EXDATE, RECURRENCE-ID e STATUS.
+                Le occorrenze che cadono nella finestra richiesta finiscono in
+                un indice compatto ordinato per inizio.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • IcsParser ics(out, cap, winStart, winEnd)
+       ics.feed(data, len)       da chiamare per ogni blocco (sink HTTP)
+       n = ics.finish()          ultima riga + override, ritorna n eventi
+
+   • out[] resta ordinato per start: a indice pieno vengono tenuti solo i
+     cap eventi più vicini, quindi calendari condivisi da diversi MB
+     occupano sempre la stessa RAM (riga corrente + evento + indice).
+
+   • Fusi: ogni VTIMEZONE viene ridotto a offset standard/legale e alle
+     due regole annuali (mese, n-esimo giorno della settimana, ora).
+     TZID sconosciuti vengono trattati come ora locale del dispositivo.
+
+   • Summary copiata in UTF-8 (escape ICS risolti); la traslitterazione
+     per il display resta al chiamante.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+
+#include "strview.h"
+
+static constexpr uint16_t ICS_LINE_MAX = 320;   // riga "logica" (troncata)
+static constexpr uint8_t ICS_SUMMARY_MAX = 48;
+static constexpr uint8_t ICS_MAX_TZ = 4;
+static constexpr uint8_t ICS_MAX_EXDATE = 8;
+static constexpr uint8_t ICS_MAX_OVERRIDE = 16;
+static constexpr uint8_t ICS_MAX_BYDAY = 8;
+static constexpr uint16_t ICS_MAX_PERIODS = 4000; // limite iterazioni RRULE
+
+// ============================================================================
+// CALENDARIO CIVILE
+// ============================================================================
+
+// Inverso di svDaysFromCivil
+static inline void icsCivilFromDays(int32_t z, int &y, uint8_t &m,
+                                    uint8_t &d) {
+  z += 719468;
+  const int32_t era = (z >= 0 ? z : z - 146096) / 146097;
+  const uint32_t doe = (uint32_t)(z - era * 146097);
+  const uint32_t yoe =
+      (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+  const uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+  const uint32_t mp = (5 * doy + 2) / 153;
+  d = doy - (153 * mp + 2) / 5 + 1;
+  m = mp < 10 ? mp + 3 : mp - 9;
+  y = (int)yoe + era * 400 + (m <= 2);
+}
+
+// 0 = domenica … 6 = sabato
+static inline uint8_t icsWeekday(int32_t days) {
+  return (uint8_t)((days % 7 + 11) % 7);
+}
+
+static inline uint8_t icsMonthLen(int y, uint8_t m) {
+  return m == 12 ? 31
+                 : (uint8_t)(svDaysFromCivil(y, m + 1, 1) -
+                             svDaysFromCivil(y, m, 1));
+}
+
+// nth > 0: n-esimo wday del mese; nth < 0: contando dalla fine
+static int32_t icsNthWeekday(int y, uint8_t m, int8_t nth, uint8_t wd) {
+  const int32_t first = svDaysFromCivil(y, m, 1);
+  const uint8_t len = icsMonthLen(y, m);
+
+  if (nth > 0) {
+    int32_t d = first + (wd - icsWeekday(first) + 7) % 7 + (nth - 1) * 7;
+    return d < first + len ? d : INT32_MIN;
+  }
+
+  const int32_t last = first + len - 1;
+  int32_t d = last - (icsWeekday(last) - wd + 7) % 7 + (nth + 1) * 7;
+  return d >= first ? d : INT32_MIN;
+}
+
+static inline int8_t icsWeekdayCode(StrView s) {
+  static const char *const WD[] = {"SU", "MO", "TU", "WE", "TH", "FR", "SA"};
+  for (uint8_t i = 0; i < 7; i++)
+    if (s.equalsCI(WD[i]))
+      return i;
+  return -1;
+}
+
+// ============================================================================
+// TIPI
+// ============================================================================
+enum : int8_t { ICS_FLOAT = -1, ICS_UTC = -2 }; // >= 0: indice in tz[]
+
+enum IcsFreq : uint8_t {
+  IF_NONE = 0,
+  IF_DAILY,
+  IF_WEEKLY,
+  IF_MONTHLY,
+  IF_YEARLY
+};
+
+struct IcsDate {
+  int32_t days; // giorni dal 1970-01-01 (data "a muro" nel fuso)
+  int32_t secs; // secondi dalla mezzanotte
+  int8_t zone;
+  bool hasTime;
+  bool ok;
+};
+
+struct IcsByDay {
+  int8_t nth; // 0 = ogni occorrenza nel periodo
+  uint8_t wd;
+};
+
+struct IcsRule {
+  uint8_t freq;
+  uint16_t interval;
+  uint16_t count;
+  IcsDate until;
+  uint8_t dayMask; // BYDAY senza ordinale (bit = wday)
+  IcsByDay byday[ICS_MAX_BYDAY];
+  uint8_t nByday;
+  uint32_t monthDays; // BYMONTHDAY: bit 1..31, bit 0 = ultimo giorno (-1)
+  uint16_t months;    // BYMONTH: bit 1..12
+};
+
+struct IcsTzRule {
+  int16_t off;     // TZOFFSETTO in minuti
+  uint8_t mon;     // mese della transizione
+  int8_t nth;      // 0 = giorno fisso (mday)
+  uint8_t wd;      //
+  uint8_t mday;    //
+  uint16_t minute; // ora locale della transizione
+};
+
+struct IcsTz {
+  uint32_t id; // hash TZID
+  IcsTzRule std, dst;
+  bool hasDst;
+};
+
+struct IcsEntry {
+  time_t start;
+  time_t end;
+  uint32_t uid;
+  bool allDay;
+  bool override; // istanza modificata (RECURRENCE-ID)
+  char summary[ICS_SUMMARY_MAX];
+};
+
+static inline uint32_t icsHash(StrView s) {
+  uint32_t h = 2166136261u;
+  for (size_t i = 0; i < s.size(); i++)
+    h = (h ^ (uint8_t)s[i]) * 16777619u;
+  return h;
+}
+
+// ============================================================================
+// PARSER
+// ============================================================================
+class IcsParser {
+public:
+  IcsParser(IcsEntry *out, uint8_t cap, time_t winStart, time_t winEnd)
+      : out_(out), cap_(cap), n_(0), winStart_(winStart), winEnd_(winEnd),
+        len_(0), nl_(false), comp_(C_NONE), alarm_(false), nTz_(0),
+        nOvr_(0) {}
+
+  // Sink HTTP: unfolding CRLF + spazio/tab iniziale
+  bool feed(const char *d, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+      const char c = d[i];
+      if (c == '\r')
+        continue;
+
+      if (nl_) {
+        nl_ = false;
+        if (c == ' ' || c == '\t')
+          continue; // riga piegata: prosegue la precedente
+        line();
+        len_ = 0;
+      }
+
+      if (c == '\n')
+        nl_ = true;
+      else if (len_ < ICS_LINE_MAX)
+        buf_[len_++] = c;
+    }
+    return true;
+  }
+
+  uint8_t finish() {
+    if (len_)
+      line();
+    len_ = 0;
+    applyOverrides();
+    return n_;
+  }
+
+private:
+  enum Comp : uint8_t { C_NONE, C_EVENT, C_TZ, C_TZ_STD, C_TZ_DST };
+
+  struct Event {
+    char summary[ICS_SUMMARY_MAX];
+    uint32_t uid;
+    IcsDate start, end, recurId;
+    int32_t dur;
+    bool hasDur;
+    bool cancelled;
+    IcsRule rule;
+    IcsDate ex[ICS_MAX_EXDATE];
+    uint8_t nEx;
+  };
+
+  IcsEntry *out_;
+  uint8_t cap_, n_;
+  time_t winStart_, winEnd_;
+
+  char buf_[ICS_LINE_MAX];
+  uint16_t len_;
+  bool nl_;
+
+  uint8_t comp_;
+  bool alarm_;
+  Event ev_;
+
+  IcsTz tz_[ICS_MAX_TZ];
+  uint8_t nTz_;
+  IcsTzRule tzRule_; // sotto-componente STANDARD/DAYLIGHT in corso
+  bool tzRuleRR_;
+  uint32_t tzId_;
+  IcsTz tzCur_;
+
+  struct Ovr {
+    uint32_t uid;
+    time_t orig;
+  } ovr_[ICS_MAX_OVERRIDE];
+  uint8_t nOvr_;
+
+  // -------------------------------------------------------------------------
+  // Riga "NOME;PARAM=..:VALORE"
+  // -------------------------------------------------------------------------
+  static bool split(StrView l, StrView &name, StrView &params,
+                    StrView &value) {
+    size_t i = 0;
+    while (i < l.size() && l[i] != ';' && l[i] != ':')
+      i++;
+    if (i == l.size())
+      return false;
+    name = l.sub(0, i);
+
+    size_t ps = i;
+    bool q = false;
+    for (; i < l.size(); i++) {
+      if (l[i] == '"')
+        q = !q;
+      else if (l[i] == ':' && !q)
+        break;
+    }
+    if (i == l.size())
+      return false;
+
+    params = l.sub(ps, i - ps);
+    value = l.sub(i + 1);
+    return true;
+  }
+
+  // Valore di un parametro (";TZID=Europe/Rome;VALUE=DATE")
+  static StrView param(StrView params, const char *key) {
+    const size_t kl = strlen(key);
+    size_t i = 0;
+    while (i < params.size()) {
+      if (params[i] != ';') {
+        i++;
+        continue;
+      }
+      const StrView rest = params.sub(i + 1);
+      if (rest.size() > kl && rest[kl] == '=' &&
+          rest.sub(0, kl).equalsCI(key)) {
+        size_t a = kl + 1, b = a;
+        bool q = false;
+        while (b < rest.size() && (q || rest[b] != ';')) {
+          if (rest[b] == '"')
+            q = !q;
+          b++;
+        }
+        StrView v = rest.sub(a, b - a);
+        if (v.size() >= 2 && v[0] == '"')
+          v = v.sub(1, v.size() - 2);
+        return v;
+      }
+      i++;
+    }
+    return StrView();
+  }
+
+  int8_t zoneFor(StrView params) const {
+    const StrView tzid = param(params, "TZID");
+    if (tzid.empty())
+      return ICS_FLOAT;
+    const uint32_t h = icsHash(tzid);
+    for (uint8_t i = 0; i < nTz_; i++)
+      if (tz_[i].id == h)
+        return i;
+    return ICS_FLOAT;
+  }
+
+  static IcsDate parseDate(StrView v, int8_t zone) {
+    IcsDate d = {0, 0, zone, false, false};
+    IsoTime t;
+    if (!svParseIso8601(v.trim(), t).ok)
+      return d;
+    d.days = svDaysFromCivil(t.year, t.mon, t.day);
+    d.secs = t.hour * 3600 + t.min * 60 + t.sec;
+    d.hasTime = t.hasTime;
+    if (t.hasOffset)
+      d.zone = ICS_UTC;
+    d.ok = true;
+    return d;
+  }
+
+  // -------------------------------------------------------------------------
+  // Conversione data "a muro" → epoch UTC
+  // -------------------------------------------------------------------------
+  static int64_t ruleLocal(const IcsTzRule &r, int y) {
+    int32_t d = r.nth ? icsNthWeekday(y, r.mon, r.nth, r.wd)
+                      : svDaysFromCivil(y, r.mon, r.mday);
+    if (d == INT32_MIN)
+      d = svDaysFromCivil(y, r.mon, 1);
+    return (int64_t)d * 86400 + r.minute * 60;
+  }
+
+  int16_t tzOffset(const IcsTz &z, int64_t civil, int y) const {
+    if (!z.hasDst)
+      return z.std.off;
+    // transizioni espresse nell'ora in vigore prima del cambio
+    const int64_t on = ruleLocal(z.dst, y);
+    const int64_t off = ruleLocal(z.std, y);
+    const bool in = on < off ? (civil >= on && civil < off)
+                             : (civil >= on || civil < off); // emisfero sud
+    return in ? z.dst.off : z.std.off;
+  }
+
+  time_t epochOf(int32_t days, int32_t secs, int8_t zone,
+                 bool hasTime) const {
+    if (hasTime && zone == ICS_UTC)
+      return (time_t)((int64_t)days * 86400 + secs);
+
+    int y;
+    uint8_t m, d;
+    icsCivilFromDays(days, y, m, d);
+
+    if (hasTime && zone >= 0) {
+      const int64_t civil = (int64_t)days * 86400 + secs;
+      return (time_t)(civil - (int64_t)tzOffset(tz_[zone], civil, y) * 60);
+    }
+
+    // ora flottante / giornata intera: ora locale del dispositivo
+    IsoTime t = {};
+    t.year = y;
+    t.mon = m;
+    t.day = d;
+    t.hour = secs / 3600;
+    t.min = (secs / 60) % 60;
+    t.sec = secs % 60;
+    return isoToLocalEpoch(t);
+  }
+
+  time_t epochOf(const IcsDate &d) const {
+    return epochOf(d.days, d.secs, d.zone, d.hasTime);
+  }
+
+  // -------------------------------------------------------------------------
+  // RRULE / DURATION
+  // -------------------------------------------------------------------------
+  static void parseRule(StrView v, IcsRule &r) {
+    memset(&r, 0, sizeof(r));
+    r.interval = 1;
+
+    while (!v.empty()) {
+      int sc = v.find(';');
+      StrView part = sc < 0 ? v : v.sub(0, sc);
+      v = sc < 0 ? StrView() : v.sub(sc + 1);
+
+      int eq = part.find('=');
+      if (eq < 0)
+        continue;
+      const StrView k = part.sub(0, eq);
+      StrView val = part.sub(eq + 1);
+      int32_t num = 0;
+
+      if (k.equalsCI("FREQ")) {
+        r.freq = val.equalsCI("DAILY")     ? IF_DAILY
+                 : val.equalsCI("WEEKLY")  ? IF_WEEKLY
+                 : val.equalsCI("MONTHLY") ? IF_MONTHLY
+                 : val.equalsCI("YEARLY")  ? IF_YEARLY
+                                           : IF_NONE;
+      } else if (k.equalsCI("INTERVAL")) {
+        if (svFromChars(val.begin(), val.end(), num).ok && num > 0)
+          r.interval = num;
+      } else if (k.equalsCI("COUNT")) {
+        if (svFromChars(val.begin(), val.end(), num).ok && num > 0)
+          r.count = num;
+      } else if (k.equalsCI("UNTIL")) {
+        r.until = parseDate(val, ICS_FLOAT);
+      } else {
+        // liste separate da virgola
+        while (!val.empty()) {
+          int cm = val.find(',');
+          StrView it = cm < 0 ? val : val.sub(0, cm);
+          val = cm < 0 ? StrView() : val.sub(cm + 1);
+
+          if (k.equalsCI("BYDAY")) {
+            if (it.size() < 2)
+              continue;
+            const int8_t wd = icsWeekdayCode(it.sub(it.size() - 2));
+            if (wd < 0)
+              continue;
+            num = 0;
+            if (it.size() > 2)
+              svFromChars(it.begin(), it.end() - 2, num);
+            if (num == 0)
+              r.dayMask |= 1 << wd;
+            if (r.nByday < ICS_MAX_BYDAY)
+              r.byday[r.nByday++] = {(int8_t)num, (uint8_t)wd};
+          } else if (k.equalsCI("BYMONTHDAY")) {
+            if (svFromChars(it.begin(), it.end(), num).ok) {
+              if (num >= 1 && num <= 31)
+                r.monthDays |= 1UL << num;
+              else if (num == -1)
+                r.monthDays |= 1;
+            }
+          } else if (k.equalsCI("BYMONTH")) {
+            if (svFromChars(it.begin(), it.end(), num).ok && num >= 1 &&
+                num <= 12)
+              r.months |= 1 << num;
+          }
+        }
+      }
+    }
+  }
+
+  // P[n]W | P[n]DT[n]H[n]M[n]S (segno opzionale)
+  static bool parseDuration(StrView v, int32_t &out) {
+    v = v.trim();
+    bool neg = false;
+    if (!v.empty() && (v[0] == '+' || v[0] == '-')) {
+      neg = v[0] == '-';
+      v = v.sub(1);
+    }
+    if (v.empty() || (v[0] != 'P' && v[0] != 'p'))
+      return false;
+
+    int32_t total = 0;
+    const char *p = v.begin() + 1;
+    while (p < v.end()) {
+      if (*p == 'T' || *p == 't') {
+        p++;
+        continue;
+      }
+      int32_t n;
+      SvParse r = svFromChars(p, v.end(), n);
+      if (!r.ok || r.ptr >= v.end())
+        return false;
+      switch (*r.ptr | 32) {
+      case 'w': total += n * 604800; break;
+      case 'd': total += n * 86400; break;
+      case 'h': total += n * 3600; break;
+      case 'm': total += n * 60; break;
+      case 's': total += n; break;
+      default: return false;
+      }
+      p = r.ptr + 1;
+    }
+    out = neg ? -total : total;
+    return true;
+  }
+
+  // -------------------------------------------------------------------------
+  // Indice ordinato
+  // -------------------------------------------------------------------------
+  void insert(time_t s, time_t e, bool isOverride) {
+    if (n_ == cap_ && s >= out_[n_ - 1].start)
+      return;
+
+    uint8_t i = (n_ < cap_) ? n_++ : n_ - 1;
+    while (i > 0 && out_[i - 1].start > s) {
+      out_[i] = out_[i - 1];
+      i--;
+    }
+
+    IcsEntry &x = out_[i];
+    x.start = s;
+    x.end = e;
+    x.uid = ev_.uid;
+    x.allDay = !ev_.start.hasTime;
+    x.override = isOverride;
+    memcpy(x.summary, ev_.summary, ICS_SUMMARY_MAX);
+  }
+
+  void applyOverrides() {
+    for (uint8_t k = 0; k < nOvr_; k++) {
+      uint8_t w = 0;
+      for (uint8_t i = 0; i < n_; i++) {
+        const IcsEntry &x = out_[i];
+        if (!x.override && x.uid == ovr_[k].uid && x.start == ovr_[k].orig)
+          continue;
+        if (w != i)
+          out_[w] = x;
+        w++;
+      }
+      n_ = w;
+    }
+  }
+
+  // -------------------------------------------------------------------------
+  // Occorrenza (data "a muro"): false = oltre finestra / UNTIL
+  // -------------------------------------------------------------------------
+  bool occurrence(int32_t day, time_t until, const time_t *ex) {
+    const time_t s = epochOf(day, ev_.start.secs, ev_.start.zone,
+                             ev_.start.hasTime);
+    if (s > until || s >= winEnd_)
+      return false;
+    if (s + ev_.dur <= winStart_)
+      return true;
+    for (uint8_t i = 0; i < ev_.nEx; i++)
+      if (ex[i] == s)
+        return true;
+    insert(s, s + ev_.dur, false);
+    return true;
+  }
+
+  // Giorni candidati di un mese, ordinati (BYDAY / BYMONTHDAY / default)
+  uint8_t monthDays(int y, uint8_t m, uint8_t defDay, int32_t *d) const {
+    const IcsRule &r = ev_.rule;
+    const int32_t first = svDaysFromCivil(y, m, 1);
+    const uint8_t len = icsMonthLen(y, m);
+    uint8_t n = 0;
+
+    if (r.nByday) {
+      for (uint8_t i = 0; i < r.nByday; i++) {
+        if (r.byday[i].nth) {
+          int32_t x = icsNthWeekday(y, m, r.byday[i].nth, r.byday[i].wd);
+          if (x != INT32_MIN)
+            d[n++] = x;
+        } else {
+          for (int32_t x = icsNthWeekday(y, m, 1, r.byday[i].wd);
+               x < first + len && n < 31; x += 7)
+            d[n++] = x;
+        }
+        if (n >= 31 - 5)
+          break;
+      }
+    } else if (r.monthDays) {
+      for (uint8_t k = 1; k <= len; k++)
+        if (r.monthDays & (1UL << k))
+          d[n++] = first + k - 1;
+      if ((r.monthDays & 1) && !(r.monthDays & (1UL << len)))
+        d[n++] = first + len - 1;
+    } else if (defDay <= len) {
+      d[n++] = first + defDay - 1;
+    }
+
+    // insertion sort + dedup (n ≤ 31)
+    for (uint8_t i = 1; i < n; i++) {
+      int32_t k = d[i];
+      int8_t j = i - 1;
+      while (j >= 0 && d[j] > k) {
+        d[j + 1] = d[j];
+        j--;
+      }
+      d[j + 1] = k;
+    }
+    uint8_t w = 0;
+    for (uint8_t i = 0; i < n; i++)
+      if (!w || d[w - 1] != d[i])
+        d[w++] = d[i];
+    return w;
+  }
+
+  void expand() {
+    const IcsRule &r = ev_.rule;
+    const int32_t day0 = ev_.start.days;
+    const uint16_t iv = r.interval;
+
+    time_t ex[ICS_MAX_EXDATE];
+    for (uint8_t i = 0; i < ev_.nEx; i++)
+      ex[i] = epochOf(ev_.ex[i]);
+
+    time_t until = LONG_MAX;
+    if (r.until.ok) {
+      IcsDate u = r.until;
+      if (u.zone != ICS_UTC)
+        u.zone = ev_.start.zone;
+      if (!u.hasTime) { // data: inclusiva fino a fine giornata
+        u.days++;
+        u.secs = 0;
+        until = epochOf(u.days, 0, u.zone, false) - 1;
+      } else {
+        until = epochOf(u);
+      }
+    }
+
+    if (r.freq == IF_NONE) {
+      occurrence(day0, LONG_MAX, ex);
+      return;
+    }
+
+    int y0;
+    uint8_t m0, d0;
+    icsCivilFromDays(day0, y0, m0, d0);
+
+    // Senza COUNT si può saltare direttamente a ridosso della finestra
+    // (due giorni di margine per fusi diversi da quello locale)
+    uint32_t p = 0;
+    if (!r.count) {
+      const int32_t ws = (int32_t)(winStart_ / 86400) - 2 - ev_.dur / 86400;
+      if (ws > day0) {
+        const int32_t span = ws - day0;
+        switch (r.freq) {
+        case IF_DAILY: p = span / iv; break;
+        case IF_WEEKLY: p = span / (7 * iv); break;
+        case IF_MONTHLY: p = span / 31 / iv; break;
+        case IF_YEARLY: p = span / 366 / iv; break;
+        }
+        p = p ? p - 1 : 0;
+      }
+    }
+
+    const int32_t wkStart0 = day0 - (icsWeekday(day0) + 6) % 7; // WKST=MO
+    const int32_t lastDay = (int32_t)(winEnd_ / 86400) + 2;
+    uint16_t counted = 0;
+    int32_t cand[31];
+
+    for (uint16_t it = 0; it < ICS_MAX_PERIODS; it++, p++) {
+      uint8_t nc = 0;
+
+      switch (r.freq) {
+      case IF_DAILY: {
+        const int32_t d = day0 + (int32_t)(p * iv);
+        if (d > lastDay)
+          return;
+        int y;
+        uint8_t m, dd;
+        icsCivilFromDays(d, y, m, dd);
+        if ((!r.dayMask || (r.dayMask & (1 << icsWeekday(d)))) &&
+            (!r.months || (r.months & (1 << m))))
+          cand[nc++] = d;
+        break;
+      }
+
+      case IF_WEEKLY: {
+        const int32_t ws = wkStart0 + (int32_t)(p * 7 * iv);
+        if (ws > lastDay)
+          return;
+        const uint8_t mask = r.dayMask ? r.dayMask : (1 << icsWeekday(day0));
+        for (uint8_t k = 0; k < 7; k++)
+          if (mask & (1 << icsWeekday(ws + k)))
+            cand[nc++] = ws + k;
+        break;
+      }
+
+      case IF_MONTHLY: {
+        const int32_t mi = y0 * 12 + (m0 - 1) + (int32_t)(p * iv);
+        const int y = mi / 12;
+        const uint8_t m = mi % 12 + 1;
+        if (svDaysFromCivil(y, m, 1) > lastDay)
+          return;
+        if (!r.months || (r.months & (1 << m)))
+          nc = monthDays(y, m, d0, cand);
+        break;
+      }
+
+      case IF_YEARLY: {
+        const int y = y0 + (int32_t)(p * iv);
+        if (svDaysFromCivil(y, 1, 1) > lastDay)
+          return;
+        // un mese alla volta: l'ordine resta crescente
+        const uint16_t months = r.months ? r.months : (1 << m0);
+        for (uint8_t m = 1; m <= 12; m++) {
+          if (!(months & (1 << m)))
+            continue;
+          nc = monthDays(y, m, d0, cand);
+          if (!emit(cand, nc, day0, counted, until, ex))
+            return;
+        }
+        nc = 0;
+        break;
+      }
+      }
+
+      if (!emit(cand, nc, day0, counted, until, ex))
+        return;
+    }
+  }
+
+  bool emit(const int32_t *cand, uint8_t nc, int32_t day0, uint16_t &counted,
+            time_t until, const time_t *ex) {
+    for (uint8_t i = 0; i < nc; i++) {
+      if (cand[i] < day0)
+        continue;
+      if (ev_.rule.count && ++counted > ev_.rule.count)
+        return false;
+      if (!occurrence(cand[i], until, ex))
+        return false;
+    }
+    return true;
+  }
+
+  // -------------------------------------------------------------------------
+  // Fine VEVENT
+  // -------------------------------------------------------------------------
+  void endEvent() {
+    if (!ev_.start.ok)
+      return;
+
+    const time_t s0 = epochOf(ev_.start);
+    if (!ev_.hasDur) {
+      if (ev_.end.ok)
+        ev_.dur = (int32_t)(epochOf(ev_.end) - s0);
+      else
+        ev_.dur = ev_.start.hasTime ? 0 : 86400;
+    }
+    if (ev_.dur < 0)
+      ev_.dur = 0;
+
+    // Istanza modificata: sostituisce l'occorrenza originale del master
+    if (ev_.recurId.ok) {
+      if (nOvr_ < ICS_MAX_OVERRIDE)
+        ovr_[nOvr_++] = {ev_.uid, epochOf(ev_.recurId)};
+      if (!ev_.cancelled && s0 < winEnd_ && s0 + ev_.dur > winStart_)
+        insert(s0, s0 + ev_.dur, true);
+      return;
+    }
+
+    if (ev_.cancelled || !ev_.summary[0])
+      return;
+
+    if (!ev_.rule.freq && (s0 >= winEnd_ || s0 + ev_.dur <= winStart_))
+      return;
+
+    expand();
+  }
+
+  // Testo ICS: \n \, \; \\ risolti, troncato a ICS_SUMMARY_MAX
+  static void unescape(StrView v, char *o, size_t cap) {
+    size_t w = 0;
+    for (size_t i = 0; i < v.size() && w + 1 < cap; i++) {
+      char c = v[i];
+      if (c == '\\' && i + 1 < v.size()) {
+        c = v[++i];
+        if (c == 'n' || c == 'N')
+          c = ' ';
+      }
+      o[w++] = c;
+    }
+    // sequenza UTF-8 incompleta in coda (troncamento) rimossa
+    size_t k = w;
+    while (k && ((uint8_t)o[k - 1] & 0xC0) == 0x80)
+      k--;
+    if (k) {
+      const uint8_t lead = (uint8_t)o[k - 1];
+      const size_t need = lead >= 0xF0 ? 4 : lead >= 0xE0 ? 3 : lead >= 0xC0 ? 2 : 1;
+      if (w - (k - 1) < need)
+        w = k - 1;
+    }
+    o[w] = 0;
+  }
+
+  // -------------------------------------------------------------------------
+  // Dispatch di una riga logica
+  // -------------------------------------------------------------------------
+  void line() {
+    StrView name, params, value;
+    if (!split(StrView(buf_, len_), name, params, value))
+      return;
+
+    if (name.equalsCI("BEGIN")) {
+      if (value.equalsCI("VEVENT") && comp_ == C_NONE) {
+        comp_ = C_EVENT;
+        alarm_ = false;
+        memset(&ev_, 0, sizeof(ev_));
+      } else if (value.equalsCI("VALARM")) {
+        alarm_ = true;
+      } else if (value.equalsCI("VTIMEZONE") && comp_ == C_NONE) {
+        comp_ = C_TZ;
+        tzId_ = 0;
+        memset(&tzCur_, 0, sizeof(tzCur_));
+      } else if (comp_ == C_TZ &&
+                 (value.equalsCI("STANDARD") || value.equalsCI("DAYLIGHT"))) {
+        comp_ = value.equalsCI("STANDARD") ? C_TZ_STD : C_TZ_DST;
+        memset(&tzRule_, 0, sizeof(tzRule_));
+        tzRuleRR_ = false;
+      }
+      return;
+    }
+
+    if (name.equalsCI("END")) {
+      if (value.equalsCI("VALARM")) {
+        alarm_ = false;
+      } else if (value.equalsCI("VEVENT") && comp_ == C_EVENT) {
+        endEvent();
+        comp_ = C_NONE;
+      } else if (comp_ == C_TZ_STD) {
+        tzCur_.std = tzRule_;
+        comp_ = C_TZ;
+      } else if (comp_ == C_TZ_DST) {
+        // DAYLIGHT senza RRULE = transizione storica, ignorata
+        if (tzRuleRR_) {
+          tzCur_.dst = tzRule_;
+          tzCur_.hasDst = true;
+        }
+        comp_ = C_TZ;
+      } else if (value.equalsCI("VTIMEZONE") && comp_ == C_TZ) {
+        if (tzId_ && nTz_ < ICS_MAX_TZ) {
+          tzCur_.id = tzId_;
+          tz_[nTz_++] = tzCur_;
+        }
+        comp_ = C_NONE;
+      }
+      return;
+    }
+
+    switch (comp_) {
+    case C_EVENT:
+      if (!alarm_)
+        eventProp(name, params, value);
+      break;
+
+    case C_TZ:
+      if (name.equalsCI("TZID"))
+        tzId_ = icsHash(value.trim());
+      break;
+
+    case C_TZ_STD:
+    case C_TZ_DST:
+      tzProp(name, value);
+      break;
+    }
+  }
+
+  void eventProp(StrView name, StrView params, StrView value) {
+    if (name.equalsCI("SUMMARY")) {
+      unescape(value.trim(), ev_.summary, sizeof(ev_.summary));
+    } else if (name.equalsCI("UID")) {
+      ev_.uid = icsHash(value.trim());
+    } else if (name.equalsCI("DTSTART")) {
+      ev_.start = parseDate(value, zoneFor(params));
+    } else if (name.equalsCI("DTEND")) {
+      ev_.end = parseDate(value, zoneFor(params));
+    } else if (name.equalsCI("DURATION")) {
+      ev_.hasDur = parseDuration(value, ev_.dur);
+    } else if (name.equalsCI("RRULE")) {
+      parseRule(value.trim(), ev_.rule);
+    } else if (name.equalsCI("RECURRENCE-ID")) {
+      ev_.recurId = parseDate(value, zoneFor(params));
+    } else if (name.equalsCI("STATUS")) {
+      ev_.cancelled = value.trim().equalsCI("CANCELLED");
+    } else if (name.equalsCI("EXDATE")) {
+      const int8_t z = zoneFor(params);
+      while (!value.empty() && ev_.nEx < ICS_MAX_EXDATE) {
+        int cm = value.find(',');
+        IcsDate d = parseDate(cm < 0 ? value : value.sub(0, cm), z);
+        if (d.ok)
+          ev_.ex[ev_.nEx++] = d;
+        value = cm < 0 ? StrView() : value.sub(cm + 1);
+      }
+    }
+  }
+
+  static bool parseOffset(StrView v, int16_t &out) {
+    v = v.trim();
+    int hh, mm;
+    if (v.size() < 5 || (v[0] != '+' && v[0] != '-') ||
+        !svDigits(v.begin() + 1, v.end(), 2, hh) ||
+        !svDigits(v.begin() + 3, v.end(), 2, mm))
+      return false;
+    out = (v[0] == '-' ? -1 : 1) * (hh * 60 + mm);
+    return true;
+  }
+
+  void tzProp(StrView name, StrView value) {
+    if (name.equalsCI("TZOFFSETTO")) {
+      parseOffset(value, tzRule_.off);
+    } else if (name.equalsCI("DTSTART")) {
+      IcsDate d = parseDate(value, ICS_FLOAT);
+      if (d.ok) {
+        int y;
+        uint8_t m, dd;
+        icsCivilFromDays(d.days, y, m, dd);
+        tzRule_.mon = m;
+        tzRule_.mday = dd;
+        tzRule_.minute = d.secs / 60;
+      }
+    } else if (name.equalsCI("RRULE")) {
+      IcsRule r;
+      parseRule(value.trim(), r);
+      tzRuleRR_ = true;
+      for (uint8_t m = 1; m <= 12; m++)
+        if (r.months & (1 << m)) {
+          tzRule_.mon = m;
+          break;
+        }
+      if (r.nByday) {
+        tzRule_.nth = r.byday[0].nth ? r.byday[0].nth : 1;
+        tzRule_.wd = r.byday[0].wd;
+      }
+    }
+  }
+};
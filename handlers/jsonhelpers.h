@@ -1,10 +1,10 @@
 /*
 ===============================================================================
    SQUARED — JSON HELPERS (Header-only)
-   Parser JSON ultra-leggero per ESP32-S3 basato su String Arduino.
-   Nessuna allocazione dinamica, nessuna dipendenza esterna, funzioni pensate
-   per risposte compatte dalle API (Open-Meteo, ZenQuotes, Home Assistant, BTC,
-   FX, RSS, ICS, ecc.).
+   Tokenizer JSON "pull" ultra-leggero per ESP32-S3 su const char*.
+   Nessuna allocazione dinamica, nessuna dipendenza esterna: una sola passata
+   sul body riempie tutti i campi richiesti dalle API (Open-Meteo, ZenQuotes,
+   Home Assistant, CoinGecko, Frankfurter, sunrise-sunset, OpenAI).
    Repository: https://github.com/davidegat/SquaredCoso
    Licenza: CC BY-NC 4.0
 ===============================================================================
@@ -13,54 +13,40 @@
    ELENCO FUNZIONI E UTILIZZO
    ------------------------------------------------------------
 
-   • extractJsonNumber(body, key, out [,from])
-       Cerca "key" nel JSON e legge il numero subito dopo il ':'.
-       Utile per JSON molto semplici o cerchi generici.
+   • JsonPull jp(body); jp.next()
+       Tokenizer pull: restituisce un token alla volta (JT_OBJ, JT_KEY,
+       JT_STR, JT_NUM, …) con puntatore e lunghezza nel buffer originale.
+       jp.skip() salta l'intero valore successivo.
+       Usato dove serve iterare liste (Home Assistant /api/states).
 
-   • extractJsonString2(body, key, out)
-       Estrae la stringa associata a "key": "value" con parsing lineare.
-       Funziona anche con leggeri formati non standard.
+   • jsonExtract(body, queries, n)
+       Estrazione multi-chiave in una sola passata. Ogni JsonQuery ha un
+       percorso compilato tipo:
+         "current_weather.temperature"
+         "daily.weathercode"          (array → jqFloats)
+         "results[0].latitude"
+         "[0].q"
+       e una destinazione (float, double, buffer char, array di float).
+       La scansione si ferma appena tutte le query sono soddisfatte.
 
-   • jsonNum(src, "key", out [,from])
-       Metodo principale raccomandato per leggere "key": NUMBER.
-       Robusto, veloce, usa ricerca con "key" racchiusa tra doppi apici.
+   • jqFloat / jqDouble / jqStr / jqFloats
+       Costruttori delle query.
 
-   • jsonKV(src, "key", out)
-       Estrazione sicura di "key": "value".
-       Usato ovunque serva solo testo (RSS, QOD, Home Assistant, ecc.).
+   • jsonToDouble(p, len, out)
+       Conversione numero JSON → double in place (svFromChars).
 
-   • jsonArrFirstNumber(src, "key", out)
-       Raccoglie il primo numero dopo "key":[…].
-       Fondamentale per API tipo Open-Meteo o forecast a grana fine.
-
-   • extractObjectBlock(body, "key", out)
-       Trova "key":{ ... } e restituisce l’intero oggetto annidato.
-       Usato per analisi più strutturate senza JSON parser pesanti.
-
-   • jsonDailyFirstNumber(src, "key", out)
-       Variante per Open-Meteo: gestisce array giornalieri più complessi
-       (temperature, UV, AQI, precipitazioni).
-
-   • findMatchingBracket(src, pos)
-       Trova la ']' corrispondente alla '[' iniziale.
-       Essenziale per array lunghi o contenenti più blocchi
-       (anch’essa usata nella pagina Temperature 24h).
+   • jsonUnescape(p, len, out, cap)
+       Copia una stringa JSON decodificando escape e \uXXXX (UTF-8).
 
    ------------------------------------------------------------
    NOTE IMPORTANTI
    ------------------------------------------------------------
 
-   • Le funzioni NON sono un parser JSON formale, ma una soluzione ultra-veloce
-     adatta a dispositivi embedded (ESP32-S3 con display RGB DMA).
-
-   • Tutti i parser assumono JSON ben formati e non protetti contro contenuti
-     volutamente corrotti (perfettamente adeguato per API standard).
+   • Non è un validatore: JSON malformati producono campi mancanti, mai
+     accessi fuori dal buffer.
 
-   • Usare SEMPRE:
-       - jsonNum()      per numeri
-       - jsonKV()       per stringhe
-       - jsonArrFirstNumber() per il primo valore in array
-       - jsonDailyFirstNumber() per dati giornalieri Open-Meteo
+   • I percorsi supportano al massimo JSON_MAX_SEG segmenti e la scansione
+     tiene traccia dei primi JSON_MAX_DEPTH livelli di annidamento.
 
    • Tutto è header-only: nessun .cpp, nessun overhead, inline ovunque.
 
@@ -69,268 +55,508 @@
 
 #pragma once
 
+#include "strview.h"
 #include <Arduino.h>
+#include <string.h>
 
-static inline bool extractJsonNumber(const String &body, const String &key,
-                                     float &out, int from = 0) {
-  int p = body.indexOf(key, from);
-  if (p < 0)
-    return false;
-
-  p = body.indexOf(':', p);
-  if (p < 0)
-    return false;
-
-  const int len = body.length();
-  int s = p + 1;
+static constexpr uint8_t JSON_MAX_SEG = 6;
+static constexpr uint8_t JSON_MAX_DEPTH = 16;
 
-  while (s < len && (body[s] == ' ' || body[s] == '\"'))
-    s++;
-
-  int e = s;
-
-  while (e < len && (isdigit(body[e]) || body[e] == '-' || body[e] == '+' ||
-                     body[e] == '.'))
-    e++;
-
-  if (e <= s)
-    return false;
-
-  out = body.substring(s, e).toFloat();
-  return true;
+// ============================================================
+// 1) NUMERI – via svFromChars (strview.h)
+// ============================================================
+static inline bool jsonToDouble(const char *s, size_t n, double &out) {
+  return svFromChars(s, s + n, out).ok;
 }
 
 // ============================================================
-// 2) PRIMITIVE – estrazione stringa "key": "value"
+// 2) STRINGHE – escape JSON → UTF-8
 // ============================================================
-static inline bool extractJsonString2(const String &body, const String &key,
-                                      String &out) {
-  int p = body.indexOf(key);
-  if (p < 0)
-    return false;
-
-  p = body.indexOf(':', p);
-  if (p < 0)
-    return false;
-
-  int s = body.indexOf('\"', p);
-  if (s < 0)
-    return false;
-  s++;
-
-  int e = body.indexOf('\"', s);
-  if (e < 0)
-    return false;
+static inline uint8_t jsonPutUtf8(uint32_t cp, char *o) {
+  if (cp < 0x80) {
+    o[0] = (char)cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    o[0] = (char)(0xC0 | (cp >> 6));
+    o[1] = (char)(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    o[0] = (char)(0xE0 | (cp >> 12));
+    o[1] = (char)(0x80 | ((cp >> 6) & 0x3F));
+    o[2] = (char)(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  o[0] = (char)(0xF0 | (cp >> 18));
+  o[1] = (char)(0x80 | ((cp >> 12) & 0x3F));
+  o[2] = (char)(0x80 | ((cp >> 6) & 0x3F));
+  o[3] = (char)(0x80 | (cp & 0x3F));
+  return 4;
+}
 
-  out = body.substring(s, e);
-  out.trim();
-  return out.length() > 0;
+static inline int jsonHex4(const char *p, const char *e) {
+  if (e - p < 4)
+    return -1;
+  int v = 0;
+  for (uint8_t i = 0; i < 4; i++) {
+    char c = p[i];
+    v <<= 4;
+    if (c >= '0' && c <= '9')
+      v |= c - '0';
+    else if (c >= 'a' && c <= 'f')
+      v |= c - 'a' + 10;
+    else if (c >= 'A' && c <= 'F')
+      v |= c - 'A' + 10;
+    else
+      return -1;
+  }
+  return v;
 }
 
-// ============================================================
-// 3) jsonNum – "key": NUMBER
-// ============================================================
-static inline bool jsonNum(const String &src, const char *key, float &out,
-                           int from = 0) {
-  String k;
-  k.reserve(strlen(key) + 2);
-  k = '\"';
-  k += key;
-  k += '\"';
-
-  int p = src.indexOf(k, from);
-  if (p < 0)
-    return false;
+static inline size_t jsonUnescape(const char *s, size_t n, char *out,
+                                  size_t cap) {
+  if (!cap)
+    return 0;
 
-  p = src.indexOf(':', p);
-  if (p < 0)
-    return false;
+  const char *p = s;
+  const char *e = s + n;
+  size_t o = 0;
 
-  const int N = src.length();
-  int s = p + 1;
+  while (p < e && o + 1 < cap) {
+    char c = *p++;
+    if (c != '\\' || p >= e) {
+      out[o++] = c;
+      continue;
+    }
 
-  while (s < N && (src[s] == ' ' || src[s] == '\"'))
-    s++;
+    c = *p++;
+    switch (c) {
+    case 'n':
+    case 'r':
+    case 't':
+    case 'b':
+    case 'f':
+      out[o++] = ' ';
+      break;
 
-  int e = s;
+    case 'u': {
+      int cp = jsonHex4(p, e);
+      if (cp < 0)
+        break;
+      p += 4;
+
+      // coppia surrogata
+      if (cp >= 0xD800 && cp <= 0xDBFF && e - p >= 6 && p[0] == '\\' &&
+          p[1] == 'u') {
+        int lo = jsonHex4(p + 2, e);
+        if (lo >= 0xDC00 && lo <= 0xDFFF) {
+          cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00);
+          p += 6;
+        }
+      }
 
-  while (e < N &&
-         (isdigit(src[e]) || src[e] == '-' || src[e] == '+' || src[e] == '.'))
-    e++;
+      char tmp[4];
+      uint8_t k = jsonPutUtf8((uint32_t)cp, tmp);
+      if (o + k + 1 > cap)
+        goto done;
+      memcpy(out + o, tmp, k);
+      o += k;
+      break;
+    }
 
-  if (e <= s)
-    return false;
+    default: // \" \\ \/
+      out[o++] = c;
+      break;
+    }
+  }
 
-  out = src.substring(s, e).toFloat();
-  return true;
+done:
+  out[o] = 0;
+  return o;
 }
 
 // ============================================================
-// 4) jsonKV – "key": "value"
+// 3) TOKENIZER PULL
 // ============================================================
-static inline bool jsonKV(const String &src, const char *key, String &out) {
-  String k;
-  k.reserve(strlen(key) + 2);
-  k = '\"';
-  k += key;
-  k += '\"';
-
-  int p = src.indexOf(k);
-  if (p < 0)
-    return false;
+enum JsonTok : uint8_t {
+  JT_END = 0,
+  JT_ERR,
+  JT_OBJ,
+  JT_OBJ_END,
+  JT_ARR,
+  JT_ARR_END,
+  JT_KEY,
+  JT_STR,
+  JT_NUM,
+  JT_LIT // true / false / null
+};
+
+static inline bool jsonIsWs(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+}
 
-  p = src.indexOf('\"', p + k.length());
-  if (p < 0)
-    return false;
+struct JsonPull {
+  const char *p;
+  const char *end;
+  const char *tok; // inizio token (stringhe: senza apici)
+  uint16_t len;    // lunghezza token
+  uint8_t depth;
+
+  JsonPull(const char *s, size_t n)
+      : p(s), end(s + n), tok(s), len(0), depth(0) {}
+  explicit JsonPull(const String &s) : JsonPull(s.c_str(), s.length()) {}
+
+  JsonTok next() {
+    while (p < end && (jsonIsWs(*p) || *p == ',' || *p == ':'))
+      p++;
+    if (p >= end)
+      return JT_END;
+
+    tok = p;
+    len = 1;
+
+    switch (*p) {
+    case '{':
+      p++;
+      depth++;
+      return JT_OBJ;
+    case '[':
+      p++;
+      depth++;
+      return JT_ARR;
+    case '}':
+      p++;
+      depth--;
+      return JT_OBJ_END;
+    case ']':
+      p++;
+      depth--;
+      return JT_ARR_END;
+
+    case '"': {
+      const char *s = ++p;
+
+      // apice di chiusura: il primo non preceduto da un numero dispari di '\'
+      while (true) {
+        const char *q = (const char *)memchr(p, '"', end - p);
+        if (!q) {
+          p = end;
+          return JT_ERR;
+        }
+        const char *b = q;
+        while (b > s && b[-1] == '\\')
+          b--;
+        p = q + 1;
+        if (((q - b) & 1) == 0)
+          break;
+      }
 
-  int q = src.indexOf('\"', p + 1);
-  if (q < 0)
-    return false;
+      tok = s;
+      len = (uint16_t)(p - 1 - s);
 
-  out = src.substring(p + 1, q);
-  return true;
-}
+      const char *q = p;
+      while (q < end && jsonIsWs(*q))
+        q++;
+      if (q < end && *q == ':') {
+        p = q + 1;
+        return JT_KEY;
+      }
+      return JT_STR;
+    }
 
-// ============================================================
-// 5) jsonArrFirstNumber – "key":[ NUMBER, ... ]
-// ============================================================
-static inline bool jsonArrFirstNumber(const String &src, const char *key,
-                                      float &out) {
-  String k;
-  k.reserve(strlen(key) + 3);
-  k = '\"';
-  k += key;
-  k += "\":[";
-
-  int p = src.indexOf(k);
-  if (p < 0)
-    return false;
+    default: {
+      const char c = *p;
+      while (p < end && !jsonIsWs(*p) && *p != ',' && *p != ']' && *p != '}' &&
+             *p != ':')
+        p++;
+      len = (uint16_t)(p - tok);
+      return (c == '-' || (c >= '0' && c <= '9')) ? JT_NUM : JT_LIT;
+    }
+    }
+  }
+
+  bool keyIs(const char *k) const {
+    const size_t n = strlen(k);
+    return len == n && memcmp(tok, k, n) == 0;
+  }
 
-  p += k.length();
-  const int N = src.length();
+  // Legge il valore successivo come stringa (decodificata); altri tipi
+  // vengono saltati interi e lasciano out invariato
+  bool str(char *out, size_t cap) {
+    const char *save = p;
+    const uint8_t d = depth;
+    JsonTok t = next();
+    if (t == JT_STR) {
+      jsonUnescape(tok, len, out, cap);
+      return true;
+    }
+    if (t == JT_OBJ || t == JT_ARR) {
+      p = save;
+      depth = d;
+      skip();
+    }
+    return false;
+  }
 
-  int s = p;
+  // Salta il valore successivo (scalare, oggetto o array completo)
+  void skip() {
+    JsonTok t = next();
+    if (t != JT_OBJ && t != JT_ARR)
+      return;
 
-  while (s < N && !(isdigit(src[s]) || src[s] == '-' || src[s] == '+' ||
-                    src[s] == '.')) {
-    if (src[s] == ']' || src[s] == 'n')
-      return false;
-    s++;
+    const uint8_t d = depth - 1;
+    while (depth > d) {
+      if (next() <= JT_ERR)
+        return;
+    }
   }
-  if (s >= N)
-    return false;
+};
 
-  int e = s;
+// ============================================================
+// 4) QUERY COMPILATE + ESTRAZIONE IN UNA PASSATA
+// ============================================================
+enum JsonQType : uint8_t { JQ_FLOAT = 0, JQ_DOUBLE, JQ_STR, JQ_FARR };
+
+struct JsonQuery {
+  const char *path;
+  void *out;
+  uint16_t cap;   // JQ_STR: byte del buffer, JQ_FARR: elementi
+  uint16_t count; // valori scritti (JQ_FARR: elementi visitati)
+  uint8_t type;
+  bool done;
+
+  // percorso compilato
+  uint8_t nseg;
+  int8_t matched; // segmenti già soddisfatti dai contenitori aperti
+  uint8_t segOfs[JSON_MAX_SEG];
+  uint8_t segLen[JSON_MAX_SEG];
+  int16_t segIdx[JSON_MAX_SEG]; // -1 = chiave, >=0 = indice array
+};
+
+static inline JsonQuery jqMake(const char *path, uint8_t type, void *out,
+                               uint16_t cap) {
+  JsonQuery q;
+  memset(&q, 0, sizeof(q));
+  q.path = path;
+  q.type = type;
+  q.out = out;
+  q.cap = cap;
+  q.matched = -1;
+
+  const char *p = path;
+  while (*p && q.nseg < JSON_MAX_SEG) {
+    if (*p == '.') {
+      p++;
+      continue;
+    }
 
-  while (e < N &&
-         (isdigit(src[e]) || src[e] == '-' || src[e] == '+' || src[e] == '.'))
-    e++;
+    const uint8_t i = q.nseg++;
+    if (*p == '[') {
+      int v = 0;
+      for (p++; *p >= '0' && *p <= '9'; p++)
+        v = v * 10 + (*p - '0');
+      if (*p == ']')
+        p++;
+      q.segIdx[i] = (int16_t)v;
+    } else {
+      const char *s = p;
+      while (*p && *p != '.' && *p != '[')
+        p++;
+      q.segOfs[i] = (uint8_t)(s - path);
+      q.segLen[i] = (uint8_t)(p - s);
+      q.segIdx[i] = -1;
+    }
+  }
+  return q;
+}
 
-  out = src.substring(s, e).toFloat();
-  return true;
+static inline JsonQuery jqFloat(const char *path, float &out) {
+  out = NAN;
+  return jqMake(path, JQ_FLOAT, &out, 1);
 }
 
-// ============================================================
-// 6) extractObjectBlock – trova oggetto { ... } dopo una chiave
-// ============================================================
-static inline bool extractObjectBlock(const String &body, const char *key,
-                                      String &out) {
-  const String k = String('\"') + key + '\"';
-  const int p = indexOfCI(body, k, 0);
-  if (p < 0)
-    return false;
+static inline JsonQuery jqDouble(const char *path, double &out) {
+  out = NAN;
+  return jqMake(path, JQ_DOUBLE, &out, 1);
+}
 
-  const int b = body.indexOf('{', p);
-  if (b < 0)
-    return false;
+static inline JsonQuery jqStr(const char *path, char *out, size_t cap) {
+  if (cap)
+    out[0] = 0;
+  return jqMake(path, JQ_STR, out, (uint16_t)cap);
+}
 
-  int depth = 0;
-  const int len = body.length();
+static inline JsonQuery jqFloats(const char *path, float *out, uint16_t n) {
+  for (uint16_t i = 0; i < n; i++)
+    out[i] = NAN;
+  return jqMake(path, JQ_FARR, out, n);
+}
 
-  for (int i = b; i < len; i++) {
-    char c = body.charAt(i);
+// componente corrente di un contenitore aperto
+struct JsonFrame {
+  const char *key;
+  uint16_t keyLen;
+  int16_t idx; // -1 = oggetto
+};
+
+static inline bool jqSegMatch(const JsonQuery &q, uint8_t s,
+                              const JsonFrame &f) {
+  if (q.segIdx[s] >= 0)
+    return f.idx == q.segIdx[s];
+  return f.idx < 0 && f.key && f.keyLen == q.segLen[s] &&
+         memcmp(f.key, q.path + q.segOfs[s], f.keyLen) == 0;
+}
 
-    if (c == '{')
-      depth++;
-    else if (c == '}') {
-      depth--;
-      if (depth == 0) {
-        out = body.substring(b, i + 1);
-        return true;
-      }
+static inline void jqStore(JsonQuery &q, JsonTok t, const JsonPull &jp) {
+  switch (q.type) {
+  case JQ_STR:
+    if (t == JT_STR)
+      jsonUnescape(jp.tok, jp.len, (char *)q.out, q.cap);
+    else if (t == JT_NUM) {
+      uint16_t n = jp.len < q.cap - 1 ? jp.len : q.cap - 1;
+      memcpy(q.out, jp.tok, n);
+      ((char *)q.out)[n] = 0;
+    } else
+      return;
+    q.count = 1;
+    break;
+
+  case JQ_FLOAT:
+  case JQ_DOUBLE: {
+    double v;
+    if ((t == JT_NUM || t == JT_STR) && jsonToDouble(jp.tok, jp.len, v)) {
+      if (q.type == JQ_FLOAT)
+        *(float *)q.out = (float)v;
+      else
+        *(double *)q.out = v;
+      q.count = 1;
     }
+    break;
+  }
   }
-  return false;
 }
 
-// ============================================================
-// 7) jsonDailyFirstNumber – variante per Open-Meteo
-// ============================================================
-static inline bool jsonDailyFirstNumber(const String &src, const char *key,
-                                        float &out) {
-  String k;
-  k.reserve(strlen(key) + 4);
-  k = '\"';
-  k += key;
-  k += "\":[";
-
-  int p = src.indexOf(k);
-  if (p < 0)
-    return false;
+static inline uint8_t jsonExtract(const char *src, size_t n, JsonQuery *qs,
+                                  uint8_t nq) {
+  JsonPull jp(src, n);
+  JsonFrame st[JSON_MAX_DEPTH];
+  uint8_t lvl = 0;
+  uint8_t pending = nq;
 
-  p += k.length();
-  const int N = src.length();
+  while (pending) {
+    JsonTok t = jp.next();
+    if (t <= JT_ERR)
+      break;
 
-  int start = -1;
+    if (t == JT_KEY) {
+      if (lvl && lvl <= JSON_MAX_DEPTH) {
+        st[lvl - 1].key = jp.tok;
+        st[lvl - 1].keyLen = jp.len;
+      }
+      continue;
+    }
 
-  for (int i = p; i < N; i++) {
-    char c = src[i];
-    if ((c >= '0' && c <= '9') || c == '+' || c == '-') {
-      start = i;
-      break;
+    if (t == JT_OBJ_END || t == JT_ARR_END) {
+      if (!lvl)
+        break;
+      lvl--;
+      for (uint8_t i = 0; i < nq; i++) {
+        JsonQuery &q = qs[i];
+        if (q.matched > (int8_t)lvl - 1) {
+          // chiusura dell'array target di un jqFloats
+          if (!q.done && q.type == JQ_FARR && q.matched == q.nseg &&
+              lvl == q.nseg) {
+            q.done = true;
+            pending--;
+          }
+          q.matched = (int8_t)lvl - 1;
+        }
+      }
+      if (lvl && lvl <= JSON_MAX_DEPTH && st[lvl - 1].idx >= 0)
+        st[lvl - 1].idx++;
+      continue;
     }
-    if (c == 'n')
-      return false;
-  }
-  if (start < 0)
-    return false;
 
-  int end = start + 1;
+    // --- inizio di un valore (scalare o contenitore) al livello lvl ---
+    const bool container = (t == JT_OBJ || t == JT_ARR);
 
-  while (end < N) {
-    char c = src[end];
-    if ((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' ||
-        c == '+' || c == '-') {
-      end++;
-    } else
-      break;
-  }
+    for (uint8_t i = 0; i < nq; i++) {
+      JsonQuery &q = qs[i];
+      if (q.done)
+        continue;
 
-  out = src.substring(start, end).toFloat();
-  return true;
-}
+      if (lvl == 0) {
+        if (container)
+          q.matched = 0;
+        continue;
+      }
+      if (q.matched != (int8_t)lvl - 1 || lvl > JSON_MAX_DEPTH)
+        continue;
+
+      // elemento dell'array target di jqFloats
+      if (q.type == JQ_FARR && lvl == q.nseg + 1) {
+        if (!container) {
+          uint16_t k = (uint16_t)st[lvl - 1].idx;
+          double v;
+          if (k < q.cap && t == JT_NUM && jsonToDouble(jp.tok, jp.len, v))
+            ((float *)q.out)[k] = (float)v;
+          if (k < q.cap)
+            q.count = k + 1;
+          if (q.count >= q.cap) {
+            q.done = true;
+            pending--;
+          }
+        }
+        continue;
+      }
 
-// ============================================================
-// 8) findMatchingBracket – chiusura di '['
-// ============================================================
-static inline int findMatchingBracket(const String &src, int start) {
-  const int N = src.length();
-  if (start < 0 || start >= N || src[start] != '[')
-    return -1;
+      if (lvl > q.nseg || !jqSegMatch(q, lvl - 1, st[lvl - 1]))
+        continue;
+
+      if (lvl < q.nseg) {
+        if (container)
+          q.matched = lvl;
+        continue;
+      }
 
-  int depth = 0;
+      // lvl == nseg → valore target
+      if (q.type == JQ_FARR) {
+        if (t == JT_ARR)
+          q.matched = lvl;
+        else {
+          q.done = true;
+          pending--;
+        }
+        continue;
+      }
 
-  for (int i = start; i < N; i++) {
-    char c = src[i];
+      if (!container)
+        jqStore(q, t, jp);
+      q.done = true;
+      pending--;
+    }
 
-    if (c == '[')
-      depth++;
-    else if (c == ']') {
-      depth--;
-      if (depth == 0)
-        return i;
+    if (container) {
+      if (lvl < JSON_MAX_DEPTH) {
+        st[lvl].key = nullptr;
+        st[lvl].keyLen = 0;
+        st[lvl].idx = (t == JT_ARR) ? 0 : -1;
+      }
+      lvl++;
+    } else if (lvl && lvl <= JSON_MAX_DEPTH && st[lvl - 1].idx >= 0) {
+      st[lvl - 1].idx++;
     }
   }
 
-  return -1;
+  uint8_t found = 0;
+  for (uint8_t i = 0; i < nq; i++)
+    if (qs[i].count)
+      found++;
+  return found;
+}
+
+static inline uint8_t jsonExtract(const String &body, JsonQuery *qs,
+                                  uint8_t nq) {
+  return jsonExtract(body.c_str(), body.length(), qs, nq);
 }
@@ -0,0 +1,145 @@
+/*
+===============================================================================
+   SQUARED — JSON WRITER (streaming sopra HtmlWriter)
+   Descrizione: serializza oggetti e array JSON direttamente nel buffer
+                chunked di HtmlWriter: niente documento in RAM, niente
+                String temporanee. Virgole e annidamento gestiti da una
+                maschera di bit per livello.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • HtmlWriter w(web); w.begin(200, "application/json");
+     JsonWriter j(w);
+     j.obj();
+       j.key("city").str(g_city);
+       j.key("temp").num(w_now_tempC, 1);     NaN / inf → null
+       j.key("list").arr(); j.num(1L); j.num(2L); j.endArr();
+     j.endObj();
+     w.end();
+
+   Profondità massima 31 livelli (bit per livello in un uint32_t).
+
+===============================================================================
+*/
+
+#pragma once
+
+#include "htmlwriter.h"
+#include <Arduino.h>
+#include <math.h>
+
+class JsonWriter {
+public:
+  explicit JsonWriter(HtmlWriter &w) : w(w) {}
+
+  // --------------------------------------------------------------------------
+  // Contenitori
+  // --------------------------------------------------------------------------
+  JsonWriter &obj() { return open('{'); }
+  JsonWriter &arr() { return open('['); }
+  JsonWriter &endObj() { return close('}'); }
+  JsonWriter &endArr() { return close(']'); }
+
+  // Chiave: il valore successivo non riceve la virgola
+  JsonWriter &key(const char *k) {
+    sep();
+    w.s("\"", 1);
+    w.s(k);
+    w.s("\":", 2);
+    keyed = true;
+    return *this;
+  }
+
+  // --------------------------------------------------------------------------
+  // Valori
+  // --------------------------------------------------------------------------
+  JsonWriter &str(const char *v) {
+    sep();
+    w.s("\"", 1);
+    escape(v);
+    w.s("\"", 1);
+    return *this;
+  }
+  JsonWriter &str(const String &v) { return str(v.c_str()); }
+
+  JsonWriter &num(long v) {
+    sep();
+    w.num(v);
+    return *this;
+  }
+  JsonWriter &num(double v, uint8_t decimals) {
+    if (!isfinite(v))
+      return null();
+    sep();
+    w.num(v, decimals);
+    return *this;
+  }
+
+  JsonWriter &boolean(bool v) {
+    sep();
+    w.s(v ? "true" : "false");
+    return *this;
+  }
+
+  JsonWriter &null() {
+    sep();
+    w.s("null", 4);
+    return *this;
+  }
+
+private:
+  JsonWriter &open(char c) {
+    sep();
+    w.s(&c, 1);
+    depth++;
+    more &= ~(1UL << depth);
+    return *this;
+  }
+
+  JsonWriter &close(char c) {
+    depth--;
+    w.s(&c, 1);
+    return *this;
+  }
+
+  // Virgola prima di ogni elemento tranne il primo del livello
+  void sep() {
+    if (keyed) {
+      keyed = false;
+      return;
+    }
+    const uint32_t bit = 1UL << depth;
+    if (more & bit)
+      w.s(",", 1);
+    more |= bit;
+  }
+
+  // Escape JSON a tratti: i caratteri sicuri escono a blocchi
+  void escape(const char *t) {
+    const char *run = t;
+    for (; *t; t++) {
+      const uint8_t c = (uint8_t)*t;
+      if (c >= 0x20 && c != '"' && c != '\\')
+        continue;
+      w.s(run, t - run);
+      run = t + 1;
+      if (c == '"') {
+        w.s("\\\"", 2);
+      } else if (c == '\\') {
+        w.s("\\\\", 2);
+      } else {
+        char u[7];
+        snprintf(u, sizeof(u), "\\u%04x", c);
+        w.s(u, 6);
+      }
+    }
+    w.s(run, t - run);
+  }
+
+  HtmlWriter &w;
+  uint32_t more = 0; // bit d: il livello d ha già almeno un elemento
+  uint8_t depth = 0;
+  bool keyed = false;
+};
@@ -0,0 +1,200 @@
+/*
+===============================================================================
+   SQUARED — LAYERS (pagine adiacenti pre-renderizzate in PSRAM)
+   Descrizione: due buffer 480×480 RGB565 in PSRAM con la pagina precedente
+                e la successiva (ordine di advanceToNextEnabled). Nei giri
+                di loop senza lavoro la pagina viene disegnata nel layer
+                spostando il target di gfx; swipe e rotazione poi copiano il
+                buffer pronto nel framebuffer invece di ridisegnare.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • lyIdle(cur, draw, prev) un solo layer mancante o scaduto per chiamata
+   • lyPresent(p)          layer pronto → schermo (≈ memcpy); false = miss
+   • lyInvalidate(p)       dati della pagina cambiati (fetch riuscito);
+                           se p è a schermo scarta anche la copia sotto
+                           il menu, che va ridisegnata
+   • lyScreen()            framebuffer reale (anche durante un render)
+   • lySaveScreen()        copia dello schermo (sotto il menu touch)
+   • lyRestoreScreen()     copia → schermo, una volta; false se assente
+
+   Pagine a orologio o dal vivo (orologi, countdown, HA, Stellar, Info)
+   non vengono pre-renderizzate: sarebbero vecchie già alla copia.
+   Un layer vale al massimo LY_MAX_AGE_MS.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include "globals.h"
+#include <Arduino.h>
+#include <Arduino_GFX_Library.h>
+#include <esp_heap_caps.h>
+#if CONFIG_IDF_TARGET_ESP32S3
+#include <esp32s3/rom/cache.h>
+#endif
+
+// Display RGB con target di disegno intercambiabile
+class SqRGBDisplay : public Arduino_RGB_Display {
+public:
+  using Arduino_RGB_Display::Arduino_RGB_Display;
+
+  // Ritorna il target precedente
+  uint16_t *retarget(uint16_t *fb) {
+    uint16_t *old = _framebuffer;
+    _framebuffer = fb;
+    return old;
+  }
+};
+
+static constexpr uint8_t LY_SLOTS = 2;
+static constexpr size_t LY_PIXELS = 480 * 480;
+static constexpr uint32_t LY_MAX_AGE_MS = 60000;
+static constexpr uint32_t LY_SETTLE_MS = 400; // dopo un cambio pagina
+static constexpr uint32_t LY_PREV_MS = 300000; // precedente: tocchi negli ultimi 5 min
+
+struct LySlot {
+  uint16_t *buf;
+  int8_t page; // -1 = vuoto
+  bool stale;
+  uint32_t ms;
+};
+
+static LySlot ly[LY_SLOTS] = {{nullptr, -1, false, 0}, {nullptr, -1, false, 0}};
+static uint16_t *ly_screen = nullptr;
+static uint16_t *ly_saved = nullptr; // schermo sotto un overlay
+static bool ly_saved_ok = false;
+static uint32_t ly_hits = 0, ly_misses = 0, ly_renders = 0;
+
+static inline SqRGBDisplay *lyGfx() { return static_cast<SqRGBDisplay *>(gfx); }
+
+static const uint16_t *lyScreen() {
+  return ly_screen ? ly_screen : (gfx ? gfx->getFramebuffer() : nullptr);
+}
+
+static bool lyCacheable(int p) {
+  switch (p) {
+  case P_WEATHER: case P_AIR: case P_CAL: case P_BTC: case P_QOD:
+  case P_FX: case P_T24: case P_SUN: case P_NEWS: case P_NOTES:
+    return true;
+  default:
+    return false;
+  }
+}
+
+static int8_t lyFind(int p) {
+  for (uint8_t i = 0; i < LY_SLOTS; i++)
+    if (ly[i].page == p)
+      return i;
+  return -1;
+}
+
+static bool lyFresh(int8_t s) {
+  return s >= 0 && !ly[s].stale && millis() - ly[s].ms < LY_MAX_AGE_MS;
+}
+
+static void lyInvalidate(int p) {
+  const int8_t s = lyFind(p);
+  if (s >= 0)
+    ly[s].stale = true;
+  if (p == g_page)
+    ly_saved_ok = false; // menu aperto durante il fetch: copia vecchia
+}
+
+static void lyInvalidateAll() {
+  for (uint8_t i = 0; i < LY_SLOTS; i++)
+    ly[i].stale = true;
+}
+
+// Disegna p nel layer s con draw(p); gfx torna sempre allo schermo
+static bool lyRender(uint8_t s, int p, void (*draw)(int)) {
+  if (!ly[s].buf) {
+    ly[s].buf = (uint16_t *)heap_caps_malloc(LY_PIXELS * 2, MALLOC_CAP_SPIRAM);
+    if (!ly[s].buf)
+      return false;
+  }
+  if (!ly_screen)
+    ly_screen = gfx->getFramebuffer();
+
+  lyGfx()->retarget(ly[s].buf);
+  draw(p);
+  lyGfx()->retarget(ly_screen);
+
+  ly[s].page = p;
+  ly[s].stale = false;
+  ly[s].ms = millis();
+  ly_renders++;
+  return true;
+}
+
+// Precedente e successiva di cur: la successiva prima (serve anche alla
+// rotazione automatica), un render per chiamata. La precedente serve solo
+// allo swipe a destra: senza tocchi recenti (withPrev false) non si rende.
+static void lyIdle(int cur, void (*draw)(int), bool withPrev) {
+  const int want[2] = {adjacentEnabledPage(cur, 1),
+                       withPrev ? adjacentEnabledPage(cur, -1) : -1};
+
+  for (uint8_t w = 0; w < 2; w++) {
+    const int p = want[w];
+    if (p < 0 || p == cur || !lyCacheable(p))
+      continue;
+    int8_t s = lyFind(p);
+    if (lyFresh(s))
+      continue;
+    // slot libero: vuoto, o né la successiva né la precedente
+    for (uint8_t i = 0; s < 0 && i < LY_SLOTS; i++)
+      if (ly[i].page < 0 || (ly[i].page != want[0] && ly[i].page != want[1]))
+        s = i;
+    if (s >= 0)
+      lyRender(s, p, draw);
+    return;
+  }
+}
+
+// Layer pronto di p → framebuffer; conta hit e miss
+static bool lyPresent(int p) {
+  if (!lyCacheable(p))
+    return false;
+  const int8_t s = lyFind(p);
+  if (!ly_screen || !lyFresh(s)) {
+    ly_misses++;
+    return false;
+  }
+  memcpy(ly_screen, ly[s].buf, LY_PIXELS * 2);
+#if CONFIG_IDF_TARGET_ESP32S3
+  Cache_WriteBack_Addr((uint32_t)ly_screen, LY_PIXELS * 2);
+#endif
+  ly[s].page = -1; // ora è la pagina a schermo: slot riusabile
+  ly_hits++;
+  return true;
+}
+
+// ============================================================================
+// SCHERMO SOTTO UN OVERLAY
+// ============================================================================
+static bool lySaveScreen() {
+  ly_saved_ok = false;
+  if (!ly_saved)
+    ly_saved = (uint16_t *)heap_caps_malloc(LY_PIXELS * 2, MALLOC_CAP_SPIRAM);
+  const uint16_t *src = lyScreen();
+  if (!ly_saved || !src)
+    return false;
+  memcpy(ly_saved, src, LY_PIXELS * 2);
+  ly_saved_ok = true;
+  return true;
+}
+
+static bool lyRestoreScreen() {
+  uint16_t *dst = (uint16_t *)lyScreen();
+  if (!ly_saved_ok || !dst)
+    return false;
+  ly_saved_ok = false;
+  memcpy(dst, ly_saved, LY_PIXELS * 2);
+#if CONFIG_IDF_TARGET_ESP32S3
+  Cache_WriteBack_Addr((uint32_t)dst, LY_PIXELS * 2);
+#endif
+  return true;
+}
@@ -0,0 +1,90 @@
+/*
+===============================================================================
+   SQUARED — METRICS (anello di eventi senza lock)
+   Descrizione: campioni runtime (tempo di disegno, latenza dei fetch,
+                cambi pagina, durata degli handler web) scritti da loop e
+                task HTTP in un anello fisso di METRIC_RING elementi, letti
+                dallo stream /events. Nessun mutex: un producer prenota lo
+                slot con un fetch_add, il lettore scarta gli slot a metà
+                scrittura o già sovrascritti.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • metricPush(MK_FETCH, P_AIR, ms)     da qualunque task, O(1)
+   • metricDrain(tail, fn)               fn(kind, id, val, ms) per ogni
+                                         evento dopo tail; ritorna quanti
+                                         eventi sono andati persi
+
+   Unità di val:  MK_FRAME µs di disegno, MK_FETCH ms (negativo = fetch
+                  fallito), MK_PAGE 0, MK_HTTP ms dell'handler.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <atomic>
+
+enum MetricKind : uint8_t {
+  MK_FRAME = 0,
+  MK_FETCH,
+  MK_PAGE,
+  MK_HTTP
+};
+
+static constexpr uint32_t METRIC_RING = 64; // potenza di due
+
+struct MetricSlot {
+  std::atomic<uint32_t> seq; // indice + 1 a scrittura completa, 0 = in corso
+  std::atomic<uint32_t> ms;
+  std::atomic<uint32_t> val;
+  std::atomic<uint32_t> tag; // kind << 8 | id
+};
+
+static MetricSlot metric_ring[METRIC_RING];
+static std::atomic<uint32_t> metric_head{0};
+
+static inline void metricPush(MetricKind k, uint8_t id, int32_t v) {
+  const uint32_t n = metric_head.fetch_add(1, std::memory_order_relaxed);
+  MetricSlot &s = metric_ring[n & (METRIC_RING - 1)];
+  s.seq.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  s.ms.store(millis(), std::memory_order_relaxed);
+  s.val.store((uint32_t)v, std::memory_order_relaxed);
+  s.tag.store(((uint32_t)k << 8) | id, std::memory_order_relaxed);
+  s.seq.store(n + 1, std::memory_order_release);
+}
+
+static inline uint32_t metricHead() {
+  return metric_head.load(std::memory_order_acquire);
+}
+
+// Legge gli eventi in [tail, head) e avanza tail; ritorna gli eventi persi
+// (sovrascritti prima della lettura o ancora in scrittura)
+template <class F>
+static uint32_t metricDrain(uint32_t &tail, F fn) {
+  const uint32_t head = metricHead();
+  uint32_t lost = 0;
+  if (head - tail > METRIC_RING) {
+    lost = head - tail - METRIC_RING;
+    tail = head - METRIC_RING;
+  }
+
+  for (; tail != head; tail++) {
+    const MetricSlot &s = metric_ring[tail & (METRIC_RING - 1)];
+    const uint32_t seq = s.seq.load(std::memory_order_acquire);
+    const uint32_t ms = s.ms.load(std::memory_order_relaxed);
+    const uint32_t val = s.val.load(std::memory_order_relaxed);
+    const uint32_t tag = s.tag.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (seq != tail + 1 || s.seq.load(std::memory_order_relaxed) != seq) {
+      lost++;
+      continue;
+    }
+    fn((MetricKind)(tag >> 8), (uint8_t)tag, (int32_t)val, ms);
+  }
+  return lost;
+}
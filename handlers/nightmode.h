@@ -0,0 +1,161 @@
+/*
+===============================================================================
+   SQUARED — NIGHT MODE (fascia notturna a basso consumo)
+   Descrizione: nella fascia oraria impostata il pannello lavora al minimo:
+                particelle a pochi fotogrammi al secondo, giro di loop più
+                lungo, refresh dati più rari, modem sleep del Wi-Fi fra un
+                fetch e l'altro e retroilluminazione che scende lungo una
+                curva (rampa in entrata, fondo, rampa in uscita). Un tocco
+                riporta tutto al giorno per NM_WAKE_MS.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • nmTick(idle, fetching)  nel loop: fascia, curva, modem sleep; con
+                             idle (nessuna transizione) segue la curva
+   • nmNight()               fascia attiva e nessun tocco recente
+   • nmBacklight()           duty "acceso" attuale (BL_MAX di giorno)
+   • nmFrame()               fotogramma di particelle dovuto (sempre di
+                             giorno, mai a schermo spento)
+   • nmRefreshMs(ms)         intervallo refresh, ×NM_REFRESH_X di notte
+   • nmLoopMs()              pausa a fine giro di loop
+   • nmTouch()               tocco: sveglia; true se lo schermo era spento
+                             (il tocco accende soltanto)
+
+   Curva (g_night, minuti dall'inizio della fascia):
+
+     BL_MAX ─┐                               ┌─ BL_MAX
+              \_____________________________/
+              ramp      dim % di BL_MAX      ramp
+
+   Senza ora valida la fascia non scatta mai.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include "backlight.h"
+#include "globals.h"
+#include <Arduino.h>
+#include <WiFi.h>
+#include <time.h>
+
+static constexpr uint32_t NM_TICK_MS = 1000;   // ricalcolo fascia e curva
+static constexpr uint32_t NM_WAKE_MS = 60000;  // giorno dopo un tocco
+static constexpr uint32_t NM_FRAME_MS = 250;   // particelle di notte (4 fps)
+static constexpr uint32_t NM_LOOP_MS = 20;     // pausa del loop di notte
+static constexpr uint32_t NM_DAY_LOOP_MS = 5;
+static constexpr uint8_t NM_REFRESH_X = 3;     // 10 min → 30 min
+static constexpr uint16_t NM_FADE_MS = 2000;   // passo lungo la curva
+static constexpr uint8_t NM_STEP = 2;          // scarto minimo di duty
+
+// ============================================================================
+// CURVA (nessuna chiamata al driver: provabile su host)
+// ============================================================================
+
+// Minuti dall'inizio della fascia, o -1 se m (minuto del giorno) è fuori
+static int16_t nmInside(const NightCfg &c, uint16_t m) {
+  if (!c.on || c.from == c.to)
+    return -1;
+  const uint16_t len = ((c.to + 24 - c.from) % 24) * 60;
+  const uint16_t in = (m + 1440 - c.from * 60) % 1440;
+  return in < len ? in : -1;
+}
+
+// Duty della retroilluminazione al minuto m del giorno
+static uint8_t nmCurve(const NightCfg &c, uint16_t m) {
+  const int16_t in = nmInside(c, m);
+  if (in < 0)
+    return BL_MAX;
+  const uint16_t len = ((c.to + 24 - c.from) % 24) * 60;
+  const uint16_t ramp = min<uint16_t>(c.ramp, len / 2);
+  const uint8_t low = BL_MAX * c.dim / 100;
+  const uint16_t edge = min<uint16_t>(in, len - in); // bordo più vicino
+  if (edge >= ramp)
+    return low;
+  return BL_MAX - (BL_MAX - low) * edge / ramp;
+}
+
+// ============================================================================
+// STATO
+// ============================================================================
+static bool nm_in = false;       // dentro la fascia
+static bool nm_night = false;    // fascia e nessun tocco recente
+static bool nm_ps = false;       // modem sleep attivo
+static uint8_t nm_level = BL_MAX;
+static uint32_t nm_next = 0;     // prossimo ricalcolo
+static uint32_t nm_wake = 0;     // fine della sveglia da tocco (0 = nessuna)
+static uint32_t nm_frame = 0;
+
+static inline bool nmNight() { return nm_night; }
+static inline uint8_t nmBacklight() { return nm_level; }
+static inline uint32_t nmLoopMs() { return nm_night ? NM_LOOP_MS : NM_DAY_LOOP_MS; }
+
+static inline uint32_t nmRefreshMs(uint32_t ms) {
+  return nm_night ? ms * NM_REFRESH_X : ms;
+}
+
+static bool nmFrame() {
+  if (!nm_night)
+    return true;
+  if (!nm_level) // schermo spento: niente particelle
+    return false;
+  const uint32_t now = millis();
+  if (now - nm_frame < NM_FRAME_MS)
+    return false;
+  nm_frame = now;
+  return true;
+}
+
+// Modem sleep solo in STA, di notte e fra un fetch e l'altro
+static void nmRadio(bool fetching) {
+  const bool ps = nm_night && !fetching && WiFi.getMode() == WIFI_STA;
+  if (ps == nm_ps)
+    return;
+  nm_ps = ps;
+  WiFi.setSleep(ps);
+}
+
+static void nmTick(bool idle, bool fetching) {
+  const uint32_t now = millis();
+  if (nm_wake && (int32_t)(now - nm_wake) >= 0) {
+    nm_wake = 0; // sveglia scaduta: fascia e curva subito
+    nm_next = now;
+  }
+
+  if ((int32_t)(now - nm_next) >= 0) {
+    nm_next = now + NM_TICK_MS;
+    uint8_t level = BL_MAX;
+    nm_in = false;
+    if (g_timeSynced) {
+      const time_t t = time(nullptr);
+      struct tm ti;
+      localtime_r(&t, &ti);
+      const uint16_t m = ti.tm_hour * 60 + ti.tm_min;
+      nm_in = nmInside(g_night, m) >= 0;
+      level = nmCurve(g_night, m);
+    }
+    nm_night = nm_in && !nm_wake;
+    nm_level = nm_wake ? BL_MAX : level;
+  }
+
+  nmRadio(fetching);
+
+  // Segue la curva solo a schermo fermo: le transizioni usano nmBacklight()
+  if (idle && !blBusy() && abs((int)blTarget() - nm_level) >= NM_STEP)
+    blFadeTo(nm_level, NM_FADE_MS);
+}
+
+static bool nmTouch() {
+  const bool dark = nm_night && nm_level == 0;
+  nm_wake = (millis() + NM_WAKE_MS) | 1;
+  if (nm_in) {
+    nm_night = false;
+    nm_level = BL_MAX;
+    nm_next = millis() + NM_TICK_MS;
+    blFadeTo(BL_MAX, BL_QUICK_MS);
+  }
+  return dark;
+}
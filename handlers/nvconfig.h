@@ -0,0 +1,371 @@
+/*
+===============================================================================
+   SQUARED — NV CONFIG (persistenza a differenze)
+   Descrizione: tabella delle chiavi NVS del namespace “app” con lettura,
+                scrittura e serializzazione uniformi. Per ogni chiave si
+                tiene l'hash FNV-1a del valore letto o scritto l'ultima
+                volta: un salvataggio scrive solo le chiavi cambiate e non
+                apre nemmeno NVS se non è cambiato niente.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • nvLoadAll()                 globali ← NVS, snapshot degli hash
+   • nvSave(first, last)         scrive le chiavi cambiate in [first, last);
+                                 ritorna il numero di scritture NVS
+   • nvSave(NV_LAT, NV_LON + 1)  es. solo coordinate dopo il geocoding
+
+   • CFG_BLOB 1 (opzionale): tutta la configurazione in un unico blob
+     "cfg" con versione e CRC32, scritto con una sola putBytes (NVS
+     scrive i blob in modo atomico: al riavvio c'è il blob vecchio o
+     quello nuovo). Blob assente o corrotto → chiavi singole, quindi la
+     migrazione avviene al primo salvataggio.
+
+     Formato: "SQCF" u8 versione u8 n u16 len u32 crc | n × (u8 id,
+              u16 len, testo)   (little-endian, crc sul solo payload)
+
+===============================================================================
+*/
+
+#pragma once
+
+#include "globals.h"
+#include <Arduino.h>
+#include <Preferences.h>
+
+#ifndef CFG_BLOB
+#define CFG_BLOB 0
+#endif
+
+extern Preferences prefs;
+extern uint32_t pagesMaskFromArray();
+extern void pagesArrayFromMask(uint32_t mask);
+
+// ============================================================================
+// TABELLA CHIAVI
+// ============================================================================
+enum NvId : uint8_t {
+  NV_FIAT = 0,
+  NV_CITY,
+  NV_LANG,
+  NV_ICS,
+  NV_LAT,
+  NV_LON,
+  NV_RSS,
+  NV_OA_KEY,
+  NV_OA_TOPIC,
+  NV_NOTE,
+  NV_HA_IP,
+  NV_HA_TOKEN,
+  NV_HA_ENTS,
+  NV_BTC,
+  NV_CD,                 // cd1n, cd1t … cd8n, cd8t
+  NV_SPLASH = NV_CD + 16,
+  NV_PAGE_MS,
+  NV_MASK,
+  NV_NIGHT,
+  NV_COUNT
+};
+
+enum NvType : uint8_t { NV_STR, NV_BOOL, NV_U32 };
+
+static const char *const NV_KEYS[NV_CD] = {
+    "fiat",  "city",     "lang",  "ics",    "lat",      "lon",   "rss_url",
+    "oa_key", "oa_topic", "note", "ha_ip", "ha_token", "ha_ents", "btc_owned"};
+
+static uint32_t nv_hash[NV_COUNT]; // valore presente in NVS (0 = sconosciuto)
+
+static const char *nvKey(uint8_t id, char *buf) {
+  if (id < NV_CD)
+    return NV_KEYS[id];
+  if (id < NV_SPLASH) {
+    snprintf(buf, 6, "cd%d%c", (id - NV_CD) / 2 + 1, (id - NV_CD) & 1 ? 't' : 'n');
+    return buf;
+  }
+  return id == NV_SPLASH    ? "splash"
+         : id == NV_PAGE_MS ? "page_ms"
+         : id == NV_MASK    ? "pages_mask"
+                            : "night";
+}
+
+static inline NvType nvType(uint8_t id) {
+  return id < NV_SPLASH ? NV_STR : id == NV_SPLASH ? NV_BOOL : NV_U32;
+}
+
+// Stringa globale dietro una chiave testuale (nullptr: btc e numeriche)
+static String *nvStr(uint8_t id) {
+  static String *const REFS[NV_CD] = {
+      &g_fiat,   &g_city,     &g_lang, &g_ics,   &g_lat,      &g_lon,
+      &g_rss_url, &g_oa_key, &g_oa_topic, &g_note, &g_ha_ip, &g_ha_token,
+      &g_ha_ents, nullptr};
+  if (id < NV_CD)
+    return REFS[id];
+  if (id < NV_SPLASH) {
+    CDEvent &e = cd[(id - NV_CD) / 2];
+    return (id - NV_CD) & 1 ? &e.whenISO : &e.name;
+  }
+  return nullptr;
+}
+
+// g_night in un u32: ramp | dim | to | from, bit 7 di from = attiva
+static uint32_t nvNightPack() {
+  return (uint32_t)g_night.ramp << 24 | (uint32_t)g_night.dim << 16 |
+         g_night.to << 8 | g_night.from | (g_night.on ? 0x80 : 0);
+}
+
+static uint32_t nvU32(uint8_t id) {
+  switch (id) {
+  case NV_SPLASH:
+    return g_splash_enabled;
+  case NV_PAGE_MS:
+    return PAGE_INTERVAL_MS;
+  case NV_MASK:
+    return pagesMaskFromArray();
+  default:
+    return nvNightPack();
+  }
+}
+
+static void nvSetU32(uint8_t id, uint32_t v) {
+  switch (id) {
+  case NV_SPLASH:
+    g_splash_enabled = v != 0;
+    break;
+  case NV_PAGE_MS:
+    PAGE_INTERVAL_MS = v;
+    break;
+  case NV_MASK:
+    pagesArrayFromMask(v);
+    break;
+  default:
+    g_night.on = v & 0x80;
+    g_night.from = v & 0x7F;
+    g_night.to = v >> 8;
+    g_night.dim = v >> 16;
+    g_night.ramp = v >> 24;
+    break;
+  }
+}
+
+// Valore corrente come testo (formato del blob e dell'hash)
+static void nvText(uint8_t id, String &out) {
+  if (String *s = nvStr(id))
+    out = *s;
+  else if (id == NV_BTC)
+    out = String(g_btc_owned, 8);
+  else
+    out = String(nvU32(id));
+}
+
+static void nvApply(uint8_t id, const String &v) {
+  if (String *s = nvStr(id))
+    *s = v;
+  else if (id == NV_BTC)
+    g_btc_owned = v.length() ? v.toDouble() : NAN;
+  else
+    nvSetU32(id, strtoul(v.c_str(), nullptr, 10));
+}
+
+static uint32_t nvHashOf(const char *p, size_t n) {
+  uint32_t h = 2166136261UL;
+  while (n--)
+    h = (h ^ (uint8_t)*p++) * 16777619UL;
+  return h | 1; // 0 resta "sconosciuto"
+}
+
+static uint32_t nvHash(uint8_t id) {
+  if (String *s = nvStr(id))
+    return nvHashOf(s->c_str(), s->length());
+  String t;
+  nvText(id, t);
+  return nvHashOf(t.c_str(), t.length());
+}
+
+static void nvSnapshot() {
+  for (uint8_t id = 0; id < NV_COUNT; id++)
+    nv_hash[id] = nvHash(id);
+}
+
+// ============================================================================
+// CHIAVI SINGOLE
+// ============================================================================
+static void nvReadKey(uint8_t id) {
+  char kb[6];
+  const char *k = nvKey(id, kb);
+  switch (nvType(id)) {
+  case NV_STR:
+    if (String *s = nvStr(id)) {
+      *s = prefs.getString(k, *s);
+    } else { // btc_owned: testo, come il form
+      String v = prefs.getString(k, "");
+      v.trim();
+      nvApply(id, v);
+    }
+    break;
+  case NV_BOOL:
+    nvSetU32(id, prefs.getBool(k, nvU32(id)));
+    break;
+  case NV_U32:
+    nvSetU32(id, prefs.getUInt(k, id == NV_MASK ? 0xFFFFFFFF : nvU32(id)));
+    break;
+  }
+}
+
+static void nvWriteKey(uint8_t id) {
+  char kb[6];
+  const char *k = nvKey(id, kb);
+  switch (nvType(id)) {
+  case NV_STR: {
+    String t;
+    nvText(id, t);
+    prefs.putString(k, t);
+    break;
+  }
+  case NV_BOOL:
+    prefs.putBool(k, nvU32(id));
+    break;
+  case NV_U32:
+    prefs.putUInt(k, nvU32(id));
+    break;
+  }
+}
+
+// ============================================================================
+// BLOB UNICO (CFG_BLOB)
+// ============================================================================
+static constexpr uint8_t NV_BLOB_VER = 1;
+static constexpr size_t NV_BLOB_HDR = 12;
+
+static uint32_t nvCrc32(const uint8_t *p, size_t n) {
+  uint32_t c = 0xFFFFFFFF;
+  while (n--) {
+    c ^= *p++;
+    for (uint8_t k = 0; k < 8; k++)
+      c = (c >> 1) ^ (0xEDB88320 & (0 - (c & 1)));
+  }
+  return ~c;
+}
+
+// Blob valido → globali; false se assente, di altra versione o corrotto
+static bool nvReadBlob() {
+  const size_t len = prefs.getBytesLength("cfg");
+  if (len < NV_BLOB_HDR)
+    return false;
+  uint8_t *b = (uint8_t *)malloc(len);
+  if (!b)
+    return false;
+  prefs.getBytes("cfg", b, len);
+
+  const uint16_t plen = b[6] | (b[7] << 8);
+  const uint32_t crc = b[8] | (b[9] << 8) | (b[10] << 16) | ((uint32_t)b[11] << 24);
+  bool ok = !memcmp(b, "SQCF", 4) && b[4] == NV_BLOB_VER &&
+            plen == len - NV_BLOB_HDR && nvCrc32(b + NV_BLOB_HDR, plen) == crc;
+
+  // prima i soli confini dei record: un blob rifiutato non lascia
+  // valori a metà sotto le chiavi singole
+  for (size_t i = NV_BLOB_HDR; ok && i < len;) {
+    ok = i + 3 <= len;
+    if (ok)
+      i += 3 + (b[i + 1] | (b[i + 2] << 8));
+    ok = ok && i <= len;
+  }
+
+  for (size_t i = NV_BLOB_HDR; ok && i < len;) {
+    const uint8_t id = b[i];
+    const uint16_t n = b[i + 1] | (b[i + 2] << 8);
+    i += 3;
+    if (id < NV_COUNT) { // id sconosciuti (versioni future): ignorati
+      String v;
+      v.concat((const char *)b + i, n);
+      nvApply(id, v);
+    }
+    i += n;
+  }
+  free(b);
+  return ok;
+}
+
+static bool nvWriteBlob() {
+  String t[NV_COUNT];
+  size_t len = NV_BLOB_HDR;
+  for (uint8_t id = 0; id < NV_COUNT; id++) {
+    nvText(id, t[id]);
+    len += 3 + t[id].length();
+  }
+
+  uint8_t *b = (uint8_t *)malloc(len);
+  if (!b)
+    return false;
+  size_t i = NV_BLOB_HDR;
+  for (uint8_t id = 0; id < NV_COUNT; id++) {
+    const uint16_t n = t[id].length();
+    b[i++] = id;
+    b[i++] = n & 0xFF;
+    b[i++] = n >> 8;
+    memcpy(b + i, t[id].c_str(), n);
+    i += n;
+  }
+
+  const uint16_t plen = len - NV_BLOB_HDR;
+  const uint32_t crc = nvCrc32(b + NV_BLOB_HDR, plen);
+  memcpy(b, "SQCF", 4);
+  b[4] = NV_BLOB_VER;
+  b[5] = NV_COUNT;
+  b[6] = plen & 0xFF;
+  b[7] = plen >> 8;
+  for (uint8_t k = 0; k < 4; k++)
+    b[8 + k] = crc >> (8 * k);
+
+  const bool ok = prefs.putBytes("cfg", b, len) == len;
+  free(b);
+  return ok;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+static void nvLoadAll() {
+  prefs.begin("app", true);
+  const bool blob = CFG_BLOB && nvReadBlob();
+  if (!blob)
+    for (uint8_t id = 0; id < NV_COUNT; id++)
+      nvReadKey(id);
+  prefs.end();
+
+  nvSnapshot();
+  // CFG_BLOB senza blob valido: il primo salvataggio lo crea
+  if (CFG_BLOB && !blob)
+    memset(nv_hash, 0, sizeof(nv_hash));
+}
+
+static uint8_t nvSave(uint8_t first, uint8_t last) {
+  uint32_t h[NV_COUNT];
+  bool dirty = false;
+  for (uint8_t id = first; id < last; id++) {
+    h[id] = nvHash(id);
+    dirty |= h[id] != nv_hash[id];
+  }
+  if (!dirty)
+    return 0;
+
+  uint8_t writes = 0;
+  prefs.begin("app", false);
+#if CFG_BLOB
+  // il blob contiene tutto: si riscrive intero, una volta sola
+  if (nvWriteBlob()) {
+    nvSnapshot();
+    writes = 1;
+  }
+#else
+  for (uint8_t id = first; id < last; id++) {
+    if (h[id] == nv_hash[id])
+      continue;
+    nvWriteKey(id);
+    nv_hash[id] = h[id];
+    writes++;
+  }
+#endif
+  prefs.end();
+  return writes;
+}
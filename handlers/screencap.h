@@ -0,0 +1,441 @@
+/*
+===============================================================================
+   SQUARED — SCREENCAP (framebuffer → /screen.bin, /screen.png)
+   Descrizione: cattura di quello che il pannello mostra in questo momento,
+                codificata riga per riga direttamente dal framebuffer RGB
+                (PSRAM) verso la risposta chunked: nessuna seconda copia
+                del frame, solo buffer di una riga.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • GET /screen.png              PNG 480×480 RGB, deflate a Huffman fisso
+                                  (run con distanza 1, filtro Sub / Up)
+
+   • GET /screen.bin[?since=G]    RGB565 little-endian, righe PackBits a 16 bit.
+                                  Con since=G (generazione di un frame già
+                                  ricevuto) escono solo le righe cambiate.
+
+     Formato .bin:
+       "SQF1"  u16 w  u16 h  u32 gen  u32 base     (base 0 = frame completo)
+       ripetuto:  u16 y  + riga PackBits:
+                    c < 0x80   → c+1 pixel letterali
+                    c ≥ 0x80   → (c & 0x7F)+1 copie del pixel seguente
+       u16 0xFFFF  fine frame
+
+   • Delta: per ogni frame servito si tiene l'hash FNV-1a di ogni riga
+     (SCR_SLOTS generazioni recenti, ~2 KB l'una in PSRAM). Una base più
+     vecchia o sconosciuta → frame completo.
+
+   • Limiti: un frame ogni SCR_MIN_MS (429 + Retry-After), pausa di un
+     tick ogni SCR_BAND righe per non contendere la PSRAM al DMA del
+     pannello, stop immediato se il client chiude.
+
+   • Le rotte girano senza StateLock (leggono solo il framebuffer): un
+     frame può catturare un disegno a metà, mai bloccare il loop.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Arduino_GFX_Library.h>
+#include <esp_heap_caps.h>
+#include "htmlwriter.h"
+#include "layers.h"
+
+extern AsyncWeb web;
+extern Arduino_RGB_Display *gfx;
+
+static constexpr uint16_t SCR_W = 480;
+static constexpr uint16_t SCR_H = 480;
+static constexpr uint8_t SCR_BAND = 16;
+static constexpr uint32_t SCR_MIN_MS = 1000;
+static constexpr uint8_t SCR_SLOTS = 4;
+static constexpr size_t SCR_IDAT = 1024;
+
+// =============================================================================
+// CHECKSUM
+// =============================================================================
+static uint32_t scrCrc32(uint32_t crc, const uint8_t *p, size_t n) {
+  static const uint32_t T[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4,
+    0x4DB26158, 0x5005713C, 0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C};
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    crc = (crc >> 4) ^ T[crc & 15];
+    crc = (crc >> 4) ^ T[crc & 15];
+  }
+  return ~crc;
+}
+
+static inline uint32_t scrRowHash(const uint16_t *px) {
+  uint32_t h = 2166136261UL;
+  for (uint16_t x = 0; x < SCR_W; x++) {
+    h = (h ^ (px[x] & 0xFF)) * 16777619UL;
+    h = (h ^ (px[x] >> 8)) * 16777619UL;
+  }
+  return h;
+}
+
+static inline void scrPut16(uint8_t *d, uint16_t v) {
+  d[0] = v & 0xFF;
+  d[1] = v >> 8;
+}
+static inline void scrPut32(uint8_t *d, uint32_t v) {
+  scrPut16(d, v & 0xFFFF);
+  scrPut16(d + 2, v >> 16);
+}
+
+// =============================================================================
+// RIGA PACKBITS (RGB565)
+// =============================================================================
+template <class Out>
+static void scrPackRow(Out &out, const uint16_t *px, uint16_t n) {
+  uint16_t i = 0;
+  while (i < n) {
+    // run di pixel uguali
+    uint16_t r = 1;
+    while (i + r < n && r < 128 && px[i + r] == px[i])
+      r++;
+    if (r >= 2) {
+      uint8_t t[3] = {(uint8_t)(0x80 | (r - 1))};
+      scrPut16(t + 1, px[i]);
+      out.s((const char *)t, 3);
+      i += r;
+      continue;
+    }
+
+    // letterali fino al prossimo run (o 128)
+    uint16_t k = 1;
+    while (i + k < n && k < 128 &&
+           !(i + k + 1 < n && px[i + k] == px[i + k + 1]))
+      k++;
+    const uint8_t c = k - 1;
+    out.s((const char *)&c, 1);
+    out.s((const char *)(px + i), k * 2); // ESP32: già little-endian
+    i += k;
+  }
+}
+
+// =============================================================================
+// PNG IN STREAMING (zlib, un blocco deflate a Huffman fisso)
+// =============================================================================
+template <class Out>
+class ScrPng {
+public:
+  explicit ScrPng(Out &out) : out(out) {}
+
+  void begin(uint16_t w, uint16_t h) {
+    static const uint8_t SIG[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.s((const char *)SIG, 8);
+
+    uint8_t ihdr[13] = {0};
+    be32(ihdr, w);
+    be32(ihdr + 4, h);
+    ihdr[8] = 8; // bit per canale
+    ihdr[9] = 2; // RGB
+    chunk("IHDR", ihdr, sizeof(ihdr));
+
+    n = 0;
+    bitbuf = 0;
+    bitcnt = 0;
+    adlerA = 1;
+    adlerB = 0;
+    run = 0;
+    have = false;
+    width = w;
+    first = true;
+    byteOut(0x78); // zlib: deflate, finestra 32 KB
+    byteOut(0x01);
+    bits(1, 1);    // BFINAL
+    bits(1, 2);    // BTYPE = Huffman fisso
+  }
+
+  // Una riga RGB565 → filtro Up se identica alla precedente, altrimenti Sub
+  void row(const uint16_t *px) {
+    const bool same = !first && !memcmp(px, prev, width * 2);
+    data(same ? 2 : 1);
+    uint8_t l[3] = {0, 0, 0};
+    for (uint16_t x = 0; x < width; x++) {
+      const uint16_t p = px[x];
+      uint8_t c[3];
+      c[0] = ((p >> 8) & 0xF8) | (p >> 13);
+      c[1] = ((p >> 3) & 0xFC) | ((p >> 9) & 0x03);
+      c[2] = ((p << 3) & 0xF8) | ((p >> 2) & 0x07);
+      for (uint8_t k = 0; k < 3; k++) {
+        data(same ? 0 : (uint8_t)(c[k] - l[k]));
+        l[k] = c[k];
+      }
+    }
+    memcpy(prev, px, width * 2);
+    first = false;
+  }
+
+  void end() {
+    flushRun();
+    sym(256);
+    if (bitcnt)
+      byteOut(bitbuf);
+    bitbuf = 0;
+    bitcnt = 0;
+    uint8_t a[4];
+    be32(a, (adlerB << 16) | adlerA);
+    for (uint8_t i = 0; i < 4; i++)
+      byteOut(a[i]);
+    flushIdat();
+    chunk("IEND", nullptr, 0);
+  }
+
+private:
+  // --- byte non compressi → run a distanza 1 o letterali ---
+  void data(uint8_t b) {
+    adlerA = (adlerA + b) % 65521;
+    adlerB = (adlerB + adlerA) % 65521;
+    if (have && b == last) {
+      if (++run == 258)
+        flushRun();
+      return;
+    }
+    flushRun();
+    lit(b);
+    last = b;
+    have = true;
+  }
+
+  void flushRun() {
+    if (run >= 3) {
+      match(run);
+    } else {
+      while (run) {
+        lit(last);
+        run--;
+      }
+    }
+    run = 0;
+  }
+
+  // --- codici Huffman fissi (RFC 1951 §3.2.6) ---
+  void code(uint16_t c, uint8_t len) {
+    uint16_t r = 0;
+    for (uint8_t i = 0; i < len; i++, c >>= 1)
+      r = (r << 1) | (c & 1);
+    bits(r, len);
+  }
+
+  void lit(uint8_t b) {
+    if (b < 144)
+      code(0x30 + b, 8);
+    else
+      code(0x190 + b - 144, 9);
+  }
+
+  void sym(uint16_t s) {
+    if (s < 280)
+      code(s - 256, 7);
+    else
+      code(0xC0 + s - 280, 8);
+  }
+
+  void match(uint16_t len) {
+    static const uint16_t BASE[29] = {3,  4,  5,  6,   7,   8,   9,   10,
+                                      11, 13, 15, 17,  19,  23,  27,  31,
+                                      35, 43, 51, 59,  67,  83,  99,  115,
+                                      131, 163, 195, 227, 258};
+    static const uint8_t EXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+                                      1, 1, 2, 2, 2, 2, 3, 3, 3, 3,
+                                      4, 4, 4, 4, 5, 5, 5, 5, 0};
+    uint8_t i = 28;
+    while (BASE[i] > len)
+      i--;
+    sym(257 + i);
+    bits(len - BASE[i], EXTRA[i]);
+    code(0, 5); // distanza 1
+  }
+
+  void bits(uint32_t v, uint8_t cnt) {
+    bitbuf |= v << bitcnt;
+    bitcnt += cnt;
+    while (bitcnt >= 8) {
+      byteOut(bitbuf & 0xFF);
+      bitbuf >>= 8;
+      bitcnt -= 8;
+    }
+  }
+
+  // --- IDAT a blocchi fissi ---
+  void byteOut(uint8_t b) {
+    idat[n++] = b;
+    if (n == SCR_IDAT)
+      flushIdat();
+  }
+
+  void flushIdat() {
+    if (n)
+      chunk("IDAT", idat, n);
+    n = 0;
+  }
+
+  void chunk(const char *type, const uint8_t *d, size_t len) {
+    uint8_t h[8];
+    be32(h, len);
+    memcpy(h + 4, type, 4);
+    out.s((const char *)h, 8);
+    if (len)
+      out.s((const char *)d, len);
+    uint8_t c[4];
+    be32(c, scrCrc32(scrCrc32(0, h + 4, 4), d, len));
+    out.s((const char *)c, 4);
+  }
+
+  static void be32(uint8_t *d, uint32_t v) {
+    d[0] = v >> 24;
+    d[1] = v >> 16;
+    d[2] = v >> 8;
+    d[3] = v;
+  }
+
+  Out &out;
+  uint8_t idat[SCR_IDAT];
+  uint16_t prev[SCR_W];
+  size_t n = 0;
+  uint32_t bitbuf = 0;
+  uint8_t bitcnt = 0;
+  uint32_t adlerA = 1, adlerB = 0;
+  uint16_t run = 0;
+  uint8_t last = 0;
+  bool have = false;
+  bool first = true;
+  uint16_t width = SCR_W;
+};
+
+// =============================================================================
+// STATO DELTA (solo task del server web)
+// =============================================================================
+struct ScrSlot {
+  uint32_t gen;
+  uint32_t hash[SCR_H];
+};
+
+static ScrSlot *scr_slots = nullptr;
+static uint32_t scr_gen = 0;
+static uint32_t scr_lastMs = 0;
+static bool scr_served = false;
+
+static bool scrRateLimited() {
+  const uint32_t now = millis();
+  if (scr_served && now - scr_lastMs < SCR_MIN_MS) {
+    web.sendHeader("Retry-After", "1");
+    web.send(429, "text/plain", "Troppo presto");
+    return true;
+  }
+  scr_lastMs = now;
+  scr_served = true;
+  return false;
+}
+
+static const uint16_t *scrFramebuffer() {
+  const uint16_t *fb = lyScreen(); // non il layer in render
+  if (!fb)
+    web.send(503, "text/plain", "Framebuffer non disponibile");
+  return fb;
+}
+
+// Pausa ogni SCR_BAND righe; false se il client ha chiuso
+static inline bool scrBand(uint16_t y) {
+  if ((y + 1) % SCR_BAND)
+    return true;
+  vTaskDelay(1);
+  return !web.clientGone();
+}
+
+// =============================================================================
+// HANDLER
+// =============================================================================
+static void handleScreenPng() {
+  if (scrRateLimited())
+    return;
+  const uint16_t *fb = scrFramebuffer();
+  if (!fb)
+    return;
+
+  HtmlWriter w(web);
+  w.begin(200, "image/png");
+  ScrPng<HtmlWriter> enc(w); // ~2 KB sullo stack del task httpd (10 KB)
+  enc.begin(SCR_W, SCR_H);
+  static uint16_t line[SCR_W];
+  for (uint16_t y = 0; y < SCR_H; y++) {
+    memcpy(line, fb + (size_t)y * SCR_W, sizeof(line));
+    enc.row(line);
+    if (!scrBand(y))
+      return;
+  }
+  enc.end();
+  w.end();
+}
+
+static void handleScreenBin() {
+  if (scrRateLimited())
+    return;
+  const uint16_t *fb = scrFramebuffer();
+  if (!fb)
+    return;
+
+  if (!scr_slots) {
+    scr_slots = (ScrSlot *)heap_caps_calloc(
+      SCR_SLOTS, sizeof(ScrSlot), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!scr_slots) {
+      web.send(503, "text/plain", "Memoria insufficiente");
+      return;
+    }
+  }
+
+  // base valida solo se la sua generazione è ancora in memoria
+  uint32_t base = strtoul(web.arg("since").c_str(), nullptr, 10);
+  const ScrSlot *bs = base ? &scr_slots[base % SCR_SLOTS] : nullptr;
+  if (!bs || bs->gen != base) {
+    bs = nullptr;
+    base = 0;
+  }
+
+  const uint32_t gen = ++scr_gen ? scr_gen : ++scr_gen; // 0 riservato
+  ScrSlot &cur = scr_slots[gen % SCR_SLOTS];
+  cur.gen = 0; // non valido finché il frame non è completo
+
+  HtmlWriter w(web);
+  w.begin(200, "application/octet-stream");
+
+  uint8_t hdr[16] = {'S', 'Q', 'F', '1'};
+  scrPut16(hdr + 4, SCR_W);
+  scrPut16(hdr + 6, SCR_H);
+  scrPut32(hdr + 8, gen);
+  scrPut32(hdr + 12, base);
+  w.s((const char *)hdr, sizeof(hdr));
+
+  static uint16_t line[SCR_W];
+  for (uint16_t y = 0; y < SCR_H; y++) {
+    memcpy(line, fb + (size_t)y * SCR_W, sizeof(line));
+    const uint32_t h = scrRowHash(line);
+    // con base == gen - SCR_SLOTS lo slot è lo stesso: prima confronto,
+    // poi sovrascrivo la stessa riga
+    const bool changed = !bs || bs->hash[y] != h;
+    cur.hash[y] = h;
+    if (changed) {
+      uint8_t yy[2];
+      scrPut16(yy, y);
+      w.s((const char *)yy, 2);
+      scrPackRow(w, line, SCR_W);
+    }
+    if (!scrBand(y))
+      return;
+  }
+
+  const uint8_t eof[2] = {0xFF, 0xFF};
+  w.s((const char *)eof, 2);
+  w.end();
+  cur.gen = gen;
+}
@@ -1,7 +1,8 @@
 /*
 ===============================================================================
    SQUARED — SETTINGS HANDLER (NVS + WebUI)
-   Descrizione: Parsing POST dalla WebUI, aggiornamento variabili globali,
+   Descrizione: Modello chiavi di configurazione (form WebUI e PATCH
+                /api/config), parsing POST, aggiornamento variabili globali,
                 caricamento/salvataggio su NVS (namespace “app”), gestione
                 mask 32-bit per pagine visibili, boot-restore e validazione
                 dati essenziali. Modulo centrale della configurazione.
@@ -13,10 +14,12 @@
 
 #pragma once
 
+#include "asyncweb.h"
 #include "globals.h"
+#include "nvconfig.h"
+#include "strview.h"
 #include <Arduino.h>
 #include <Preferences.h>
-#include <WebServer.h>
 
 // ---------------------------------------------------------------------------
 // CHIAVI NVS PER LE PAGINE
@@ -26,7 +29,7 @@ static const char *PAGE_KEYS[PAGES] = {
     "p_QOD",     "p_INFO", "p_COUNT",   "p_FX",     "p_T24",    "p_SUN",
     "p_NEWS",    "p_HA",   "p_STELLAR", "p_NOTES",  "p_CHRONOS"};
 
-extern WebServer web;
+extern AsyncWeb web;
 extern Preferences prefs;
 
 extern bool g_splash_enabled;
@@ -35,242 +38,307 @@ extern bool g_forceRedraw;
 extern void ensureCurrentPageEnabled();
 extern uint32_t pagesMaskFromArray();
 extern void pagesArrayFromMask(uint32_t mask);
+void saveAppConfig();
 
 // ============================================================================
-// handleSettings() — Gestione POST e salvataggio su NVS
+// MODELLO CONFIGURAZIONE — chiavi comuni a form WebUI e PATCH /api/config
 // ============================================================================
-void handleSettings() {
+enum CfgId : int8_t {
+  CF_CITY = 0,
+  CF_LANG,
+  CF_ICS,
+  CF_PAGE_S,
+  CF_NOTE,
+  CF_FIAT,
+  CF_HA_IP,
+  CF_HA_TOKEN,
+  CF_HA_ENTS,
+  CF_BTC,
+  CF_OA_KEY,
+  CF_OA_TOPIC,
+  CF_RSS,
+  CF_SPLASH,
+  CF_NIGHT,
+  CF_NIGHT_FROM,
+  CF_NIGHT_TO,
+  CF_NIGHT_DIM,
+  CF_NIGHT_RAMP,
+  CF_SIMPLE,            // fine chiavi semplici
+  CF_CD = CF_SIMPLE,    // cd1n, cd1t … cd8n, cd8t
+  CF_PAGE = CF_CD + 16, // p_WEATHER …
+  CF_END = CF_PAGE + PAGES
+};
+
+static const char *const CFG_KEYS[CF_SIMPLE] = {
+    "city",     "lang",       "ics",          "page_s",  "note",
+    "fiat",     "ha_ip",      "ha_token",     "ha_ents", "btc_owned",
+    "openai_key", "openai_topic", "rss_url", "splash_enabled",
+    "night_enabled", "night_from", "night_to", "night_dim", "night_ramp"};
+
+// Esito di cfgSet()
+static constexpr uint8_t CFG_SET = 1;     // valore applicato
+static constexpr uint8_t CFG_REFETCH = 2; // serve riscaricare i dati
+
+// Nome chiave → id (-1 se sconosciuta)
+static int8_t cfgFind(const char *key) {
+  for (int8_t i = 0; i < CF_SIMPLE; i++)
+    if (!strcmp(key, CFG_KEYS[i]))
+      return i;
+
+  // cdNn / cdNt
+  if (key[0] == 'c' && key[1] == 'd' && key[2] >= '1' && key[2] <= '8' &&
+      (key[3] == 'n' || key[3] == 't') && !key[4])
+    return CF_CD + (key[2] - '1') * 2 + (key[3] == 't');
+
+  for (int8_t i = 0; i < PAGES; i++)
+    if (!strcmp(key, PAGE_KEYS[i]))
+      return CF_PAGE + i;
+
+  return -1;
+}
 
-  bool saved = false;
+static inline bool cfgBool(const char *v) {
+  return v[0] && strcmp(v, "0") && strcmp(v, "false");
+}
 
-  if (web.method() == HTTP_POST) {
+// Intero limitato a [lo, hi] (testo non numerico → lo)
+static int32_t cfgInt(const String &s, int32_t lo, int32_t hi) {
+  int32_t v = lo;
+  svFromChars(s.c_str(), s.c_str() + s.length(), v);
+  return constrain(v, lo, hi);
+}
 
-    // ----------------------------------------------------------
-    // PARAMETRI BASE
-    // ----------------------------------------------------------
-    String city = web.arg("city");
-    city.trim();
-    String lang = web.arg("lang");
-    lang.trim();
-    String ics = web.arg("ics");
-    ics.trim();
-
-    if (city.length())
-      g_city = city;
-    g_lang = (lang == "it" || lang == "en") ? lang : "it";
-    g_ics = ics;
-
-    // Intervallo pagina (5–600s)
-    if (web.hasArg("page_s")) {
-      long ps = web.arg("page_s").toInt();
-      if (ps < 5)
-        ps = 5;
-      if (ps > 600)
-        ps = 600;
-      PAGE_INTERVAL_MS = ps * 1000UL;
-    }
+// Host HA senza schema né '/' finale
+static void cfgHaHost(String &h) {
+  h.trim();
+  if (h.startsWith("http://"))
+    h.remove(0, 7);
+  if (h.startsWith("https://"))
+    h.remove(0, 8);
+  if (h.endsWith("/"))
+    h.remove(h.length() - 1);
+}
 
-    // -------- Post-it --------
-    if (web.hasArg("note"))
-      g_note = sanitizeText(web.arg("note"));
-    else
-      g_note = "";
-
-    // -------- Fiat base --------
-    if (web.hasArg("fiat")) {
-      g_fiat = web.arg("fiat");
-      g_fiat.trim();
-      g_fiat.toUpperCase();
-    }
+// Applica un valore (testo) alla globale corrispondente, con le stesse
+// normalizzazioni della WebUI; ritorna CFG_SET / CFG_SET | CFG_REFETCH
+static uint8_t cfgSet(int8_t id, const char *v) {
+  String s(v);
 
-    // ----------------------------------------------------------
-    // HOME ASSISTANT
-    // ----------------------------------------------------------
-    if (web.hasArg("ha_ip")) {
-      g_ha_ip = sanitizeText(web.arg("ha_ip"));
-      g_ha_ip.trim();
-      if (g_ha_ip.startsWith("http://"))
-        g_ha_ip.remove(0, 7);
-      if (g_ha_ip.startsWith("https://"))
-        g_ha_ip.remove(0, 8);
-      if (g_ha_ip.endsWith("/"))
-        g_ha_ip.remove(g_ha_ip.length() - 1);
-    }
+  if (id >= CF_PAGE) {
+    const bool on = cfgBool(v);
+    const bool enabling = on && !g_show[id - CF_PAGE];
+    g_show[id - CF_PAGE] = on;
+    return enabling ? CFG_SET | CFG_REFETCH : CFG_SET;
+  }
 
-    if (web.hasArg("ha_token")) {
-      g_ha_token = sanitizeText(web.arg("ha_token"));
-      g_ha_token.trim();
-    }
+  if (id >= CF_CD) {
+    CDEvent &e = cd[(id - CF_CD) / 2];
+    ((id - CF_CD) & 1 ? e.whenISO : e.name) = sanitizeText(s);
+    return CFG_SET;
+  }
 
-    // ----------------------------------------------------------
-    // BITCOIN
-    // ----------------------------------------------------------
-    if (web.hasArg("btc_owned")) {
-      String s = web.arg("btc_owned");
-      s.trim();
-      g_btc_owned = s.length() ? s.toDouble() : NAN;
-    }
+  switch (id) {
+  case CF_CITY:
+    s.trim();
+    if (s.length())
+      g_city = sanitizeText(s);
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_LANG:
+    s.trim();
+    g_lang = (s == "it" || s == "en") ? s : "it";
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_ICS:
+    s.trim();
+    g_ics = s;
+    return CFG_SET | CFG_REFETCH;
+
+  // Intervallo pagina (5–600s)
+  case CF_PAGE_S: {
+    int32_t ps = 0;
+    svFromChars(s.c_str(), s.c_str() + s.length(), ps);
+    if (ps < 5)
+      ps = 5;
+    if (ps > 600)
+      ps = 600;
+    PAGE_INTERVAL_MS = ps * 1000UL;
+    return CFG_SET;
+  }
 
-    // ----------------------------------------------------------
-    // OPENAI
-    // ----------------------------------------------------------
-    g_oa_key = sanitizeText(web.arg("openai_key"));
-    g_oa_topic = sanitizeText(web.arg("openai_topic"));
-
-    // ----------------------------------------------------------
-    // RSS
-    // ----------------------------------------------------------
-    if (web.hasArg("rss_url")) {
-      g_rss_url = sanitizeText(web.arg("rss_url"));
-      g_rss_url.trim();
-    }
+  case CF_NOTE:
+    g_note = sanitizeText(s);
+    return CFG_SET;
+
+  case CF_FIAT:
+    s.trim();
+    s.toUpperCase();
+    g_fiat = s;
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_HA_IP:
+    g_ha_ip = sanitizeText(s);
+    cfgHaHost(g_ha_ip);
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_HA_TOKEN:
+    g_ha_token = sanitizeText(s);
+    g_ha_token.trim();
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_HA_ENTS:
+    g_ha_ents = sanitizeText(s);
+    g_ha_ents.trim();
+    g_ha_ents.toLowerCase(); // entity_id sempre minuscoli in HA
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_BTC:
+    s.trim();
+    g_btc_owned = s.length() ? s.toDouble() : NAN;
+    return CFG_SET;
+
+  case CF_OA_KEY:
+    g_oa_key = sanitizeText(s);
+    return CFG_SET;
+
+  case CF_OA_TOPIC:
+    g_oa_topic = sanitizeText(s);
+    return CFG_SET;
+
+  case CF_RSS:
+    g_rss_url = sanitizeText(s);
+    g_rss_url.trim();
+    return CFG_SET | CFG_REFETCH;
+
+  case CF_SPLASH:
+    g_splash_enabled = cfgBool(v);
+    return CFG_SET;
+
+  // Modalità notte: fascia oraria e curva della retroilluminazione
+  case CF_NIGHT:
+    g_night.on = cfgBool(v);
+    return CFG_SET;
+
+  case CF_NIGHT_FROM:
+    g_night.from = cfgInt(s, 0, 23);
+    return CFG_SET;
+
+  case CF_NIGHT_TO:
+    g_night.to = cfgInt(s, 0, 23);
+    return CFG_SET;
+
+  case CF_NIGHT_DIM:
+    g_night.dim = cfgInt(s, 0, 100);
+    return CFG_SET;
+
+  case CF_NIGHT_RAMP:
+    g_night.ramp = cfgInt(s, 0, 180);
+    return CFG_SET;
+  }
+  return 0;
+}
 
-    // ----------------------------------------------------------
-    // SPLASH IMAGES
-    // ----------------------------------------------------------
-    g_splash_enabled = web.hasArg("splash_enabled");
-
-    // ----------------------------------------------------------
-    // COUNTDOWN
-    // ----------------------------------------------------------
-    for (int i = 0; i < 8; i++) {
-      char kn[6], kt[6];
-      snprintf(kn, sizeof(kn), "cd%dn", i + 1);
-      snprintf(kt, sizeof(kt), "cd%dt", i + 1);
-      cd[i].name = sanitizeText(web.arg(kn));
-      cd[i].whenISO = sanitizeText(web.arg(kt));
+// Dopo una serie di cfgSet(): vincoli, NVS, pagina corrente, refresh
+static void cfgCommit(bool refetch) {
+  // Almeno una pagina deve restare attiva
+  bool any = false;
+  for (int i = 0; i < PAGES; i++)
+    if (g_show[i]) {
+      any = true;
+      break;
     }
 
-    // ----------------------------------------------------------
-    // PAGINE VISIBILI
-    // ----------------------------------------------------------
-    for (int i = 0; i < PAGES; i++)
-      g_show[i] = web.hasArg(PAGE_KEYS[i]);
+  if (!any)
+    g_show[P_CLOCK] = true;
 
-    // Almeno una pagina deve restare attiva
-    bool any = false;
-    for (int i = 0; i < PAGES; i++)
-      if (g_show[i]) {
-        any = true;
-        break;
-      }
-
-    if (!any)
-      g_show[P_CLOCK] = true;
-
-    // ----------------------------------------------------------
-    // SALVATAGGIO SU NVS
-    // ----------------------------------------------------------
-    prefs.begin("app", false);
-
-    prefs.putString("city", g_city);
-    prefs.putString("lang", g_lang);
-    prefs.putString("ics", g_ics);
-    prefs.putString("lat", g_lat);
-    prefs.putString("lon", g_lon);
-
-    prefs.putBool("splash", g_splash_enabled);
-
-    prefs.putString("ha_ip", g_ha_ip);
-    prefs.putString("ha_token", g_ha_token);
-
-    prefs.putULong("page_ms", PAGE_INTERVAL_MS);
-
-    prefs.putString("fiat", g_fiat);
-    prefs.putString("rss_url", g_rss_url);
-    prefs.putString("oa_key", g_oa_key);
-    prefs.putString("oa_topic", g_oa_topic);
-    prefs.putString("note", g_note);
-
-    // BTC — salvato come stringa con precisione a 8 decimali
-    prefs.putString("btc_owned", String(g_btc_owned, 8));
-
-    // Countdown
-    for (int i = 0; i < 8; i++) {
-      char kn[6], kt[6];
-      snprintf(kn, sizeof(kn), "cd%dn", i + 1);
-      snprintf(kt, sizeof(kt), "cd%dt", i + 1);
-      prefs.putString(kn, cd[i].name);
-      prefs.putString(kt, cd[i].whenISO);
-    }
+  saveAppConfig();
+  ensureCurrentPageEnabled();
+  if (refetch)
+    g_dataRefreshPending = true;
+}
 
-    // Maschera pagine
-    prefs.putUInt("pages_mask", pagesMaskFromArray());
+// Copia della configurazione per le risposte lunghe (pagina impostazioni,
+// GET /api/config): presa sotto StateLock, poi web.unlock() e la pagina
+// si scrive sul socket dalla copia
+struct CfgSnap {
+  String city, lang, ics, note, fiat;
+  String haIp, haToken, haEnts;
+  String oaKey, oaTopic, rss;
+  uint32_t pageMs;
+  double btc;
+  bool splash;
+  NightCfg night;
+  bool show[PAGES];
+  CDEvent cd[8];
+};
+
+static void cfgSnap(CfgSnap &c) {
+  c.city = g_city;
+  c.lang = g_lang;
+  c.ics = g_ics;
+  c.note = g_note;
+  c.fiat = g_fiat;
+  c.haIp = g_ha_ip;
+  c.haToken = g_ha_token;
+  c.haEnts = g_ha_ents;
+  c.oaKey = g_oa_key;
+  c.oaTopic = g_oa_topic;
+  c.rss = g_rss_url;
+  c.pageMs = PAGE_INTERVAL_MS;
+  c.btc = g_btc_owned;
+  c.splash = g_splash_enabled;
+  c.night = g_night;
+  for (int i = 0; i < PAGES; i++)
+    c.show[i] = g_show[i];
+  for (int i = 0; i < 8; i++)
+    c.cd[i] = cd[i];
+}
+
+// ============================================================================
+// handleSettings() — Gestione POST e salvataggio su NVS
+// ============================================================================
+void handleSettings() {
 
-    prefs.end();
+  bool saved = false;
 
-    ensureCurrentPageEnabled();
-    g_dataRefreshPending = true;
+  if (web.method() == HTTP_POST) {
+
+    // Checkbox: assenti dal form = disattivate
+    g_splash_enabled = false;
+    g_night.on = false;
+    for (int i = 0; i < PAGES; i++)
+      g_show[i] = false;
+
+    for (int i = 0; i < web.args(); i++) {
+      const int8_t id = cfgFind(web.argName(i).c_str());
+      if (id >= 0)
+        cfgSet(id, web.arg(i).c_str());
+    }
+
+    cfgCommit(true);
     saved = true;
   }
 
-  web.send(200, "text/html; charset=utf-8", htmlSettings(saved, ""));
+  sendSettings(saved, "");
 }
 
 // ============================================================================
 // loadAppConfig() — Caricamento completo configurazione NVS
 // ============================================================================
 void loadAppConfig() {
+  nvLoadAll();
 
-  prefs.begin("app", true);
-
-  g_city = prefs.getString("city", g_city);
-  g_lang = prefs.getString("lang", g_lang);
-  g_ics = prefs.getString("ics", g_ics);
-  g_lat = prefs.getString("lat", g_lat);
-  g_lon = prefs.getString("lon", g_lon);
-
-  g_note = prefs.getString("note", "");
+  // Normalizzazioni (valori scritti da firmware precedenti)
+  g_city = sanitizeText(g_city);
 
-  g_fiat = prefs.getString("fiat", "CHF");
   g_fiat.trim();
   g_fiat.toUpperCase();
 
-  g_splash_enabled = prefs.getBool("splash", true);
-
-  g_ha_ip = prefs.getString("ha_ip", "");
-  g_ha_token = prefs.getString("ha_token", "");
-
-  g_ha_ip.trim();
   g_ha_token.trim();
-  if (g_ha_ip.startsWith("http://"))
-    g_ha_ip.remove(0, 7);
-  if (g_ha_ip.startsWith("https://"))
-    g_ha_ip.remove(0, 8);
-  if (g_ha_ip.endsWith("/"))
-    g_ha_ip.remove(g_ha_ip.length() - 1);
-
-  PAGE_INTERVAL_MS = prefs.getULong("page_ms", PAGE_INTERVAL_MS);
-
-  g_oa_key = prefs.getString("oa_key", g_oa_key);
-  g_oa_topic = prefs.getString("oa_topic", g_oa_topic);
+  cfgHaHost(g_ha_ip);
 
-  g_rss_url = prefs.getString("rss_url", g_rss_url);
   g_rss_url.trim();
 
-  // BTC — letto simmetricamente come stringa
-  {
-    String btc = prefs.getString("btc_owned", "");
-    btc.trim();
-    g_btc_owned = btc.length() ? btc.toDouble() : NAN;
-  }
-
-  // Countdown
-  for (int i = 0; i < 8; i++) {
-    char kn[6], kt[6];
-    snprintf(kn, sizeof(kn), "cd%dn", i + 1);
-    snprintf(kt, sizeof(kt), "cd%dt", i + 1);
-    cd[i].name = prefs.getString(kn, "");
-    cd[i].whenISO = prefs.getString(kt, "");
-  }
-
-  // Pagine visibili
-  uint32_t mask = prefs.getUInt("pages_mask", 0xFFFFFFFF);
-
-  prefs.end();
-
-  pagesArrayFromMask(mask);
-
   // intervallo pagina
   uint32_t s = PAGE_INTERVAL_MS / 1000;
   if (s < 5)
@@ -280,45 +348,15 @@ void loadAppConfig() {
 
   g_oa_key.trim();
   g_oa_topic.trim();
+
+  // modalità notte (valori fuori scala da NVS)
+  g_night.from %= 24;
+  g_night.to %= 24;
+  g_night.dim = min<uint8_t>(g_night.dim, 100);
+  g_night.ramp = min<uint8_t>(g_night.ramp, 180);
 }
 
 // ============================================================================
-// saveAppConfig() — Salvataggio rapido
+// saveAppConfig() — Salvataggio delle sole chiavi cambiate (nvconfig.h)
 // ============================================================================
-void saveAppConfig() {
-
-  prefs.begin("app", false);
-
-  prefs.putString("fiat", g_fiat);
-  prefs.putString("city", g_city);
-  prefs.putString("lang", g_lang);
-  prefs.putString("ics", g_ics);
-  prefs.putString("lat", g_lat);
-  prefs.putString("lon", g_lon);
-
-  prefs.putString("rss_url", g_rss_url);
-  prefs.putString("oa_key", g_oa_key);
-  prefs.putString("oa_topic", g_oa_topic);
-
-  prefs.putString("ha_ip", g_ha_ip);
-  prefs.putString("ha_token", g_ha_token);
-
-  prefs.putULong("page_ms", PAGE_INTERVAL_MS);
-
-  // BTC simmetrico
-  prefs.putString("btc_owned", String(g_btc_owned, 8));
-
-  // Countdown
-  for (int i = 0; i < 8; i++) {
-    char kn[6], kt[6];
-    snprintf(kn, sizeof(kn), "cd%dn", i + 1);
-    snprintf(kt, sizeof(kt), "cd%dt", i + 1);
-    prefs.putString(kn, cd[i].name);
-    prefs.putString(kt, cd[i].whenISO);
-  }
-
-  // Maschera pagine su 32 bit
-  prefs.putUInt("pages_mask", pagesMaskFromArray());
-
-  prefs.end();
-}
+void saveAppConfig() { nvSave(0, NV_COUNT); }
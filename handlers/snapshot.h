@@ -0,0 +1,568 @@
+/*
+===============================================================================
+   SQUARED — SNAPSHOT (avvio a caldo dei dati)
+   Descrizione: copia binaria compatta dell'ultimo fetch riuscito di ogni
+                sorgente (meteo, aria, T24, BTC, FX, news, calendario,
+                sole/luna, QOD) su LittleFS. Al boot le pagine ripartono con
+                i dati dell'ultima sessione invece che vuote; il refresh
+                normale li sostituisce appena arriva la rete.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • snapLoadAll()        setup(): monta LittleFS e ricarica gli snapshot
+   • snapMark(p)          noteFetch() riuscito: pagina da salvare
+   • snapTick()           loop(): scrive le pagine segnate SNAP_DEBOUNCE_MS
+                          dopo l'ultimo fetch (un giro di refresh = una
+                          sola scrittura per sorgente)
+   • snapFlush()          scrittura immediata (prima di ESP.restart)
+   • snapRestoreAges()    ora valida: età dei dati in g_fetchMs (/api/state)
+   • snapLastEpoch()      ultima ora nota (fetch più recente o /clock.bin,
+                          salvato al più ogni SNAP_CLOCK_S): seme dell'ora
+                          approssimata dopo un'interruzione di corrente
+
+   File /snapNN.bin (NN = pagina), scritto in .tmp e poi rinominato:
+   dopo un'interruzione di corrente resta il file vecchio o quello nuovo.
+
+     "SQSN" u8 versione u8 pagina u16 len u32 crc u32 epoch u32 cfg | payload
+
+   Tutto little-endian, float/double come bit IEEE-754, time_t su 64 bit,
+   stringhe u16 len + byte. crc = CRC32 del payload; epoch = ora UTC del
+   fetch (0 = sconosciuta); cfg = hash delle impostazioni da cui dipende
+   la sorgente (città, valuta, feed…): se cambiano lo snapshot è scartato.
+   Versione diversa → snapshot ignorato e riscritto al fetch successivo.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include "asyncweb.h"
+#include "globals.h"
+#include <Arduino.h>
+#include <FS.h>
+#include <LittleFS.h>
+
+extern uint32_t g_fetchMs[PAGES];
+
+static constexpr uint8_t SNAP_VER = 1;
+static constexpr size_t SNAP_HDR = 20;
+static constexpr size_t SNAP_BUF = 2048;            // payload massimo (calendario ≈ 1,1 KB)
+static constexpr uint32_t SNAP_DEBOUNCE_MS = 30000; // quiete prima di scrivere
+static constexpr uint32_t SNAP_MAX_AGE_S = 2 * 86400;
+static constexpr uint32_t SNAP_REWRITE_S = 3600; // dati identici: epoch al più ogni ora
+static constexpr uint32_t SNAP_CLOCK_S = 3600;   // /clock.bin al più ogni ora
+
+static bool snap_fs = false;
+static uint32_t snap_dirty = 0;   // bit per pagina
+static uint32_t snap_markMs = 0;  // ultimo snapMark
+static uint32_t snap_epoch[PAGES];
+static uint32_t snap_crc[PAGES];  // payload su flash (evita riscritture uguali)
+static uint32_t snap_clock = 0;   // epoch in /clock.bin
+
+// ============================================================================
+// CODIFICA LITTLE-ENDIAN
+// ============================================================================
+struct SnapW {
+  uint8_t *b;
+  size_t cap;
+  size_t n = 0;
+  bool ok = true;
+
+  SnapW(uint8_t *buf, size_t c) : b(buf), cap(c) {}
+
+  void raw(const void *p, size_t k) {
+    if (n + k > cap) {
+      ok = false;
+      return;
+    }
+    memcpy(b + n, p, k);
+    n += k;
+  }
+  void u8(uint8_t v) { raw(&v, 1); }
+  void u16(uint16_t v) {
+    const uint8_t t[2] = {(uint8_t)v, (uint8_t)(v >> 8)};
+    raw(t, 2);
+  }
+  void u32(uint32_t v) {
+    u16(v);
+    u16(v >> 16);
+  }
+  void u64(uint64_t v) {
+    u32(v);
+    u32(v >> 32);
+  }
+  void f32(float v) {
+    uint32_t u;
+    memcpy(&u, &v, 4);
+    u32(u);
+  }
+  void f64(double v) {
+    uint64_t u;
+    memcpy(&u, &v, 8);
+    u64(u);
+  }
+  void str(const char *s, size_t len) {
+    u16(len);
+    raw(s, len);
+  }
+  void str(const char *s) { str(s, strlen(s)); }
+  void str(const String &s) { str(s.c_str(), s.length()); }
+};
+
+struct SnapR {
+  const uint8_t *b;
+  size_t len;
+  size_t i = 0;
+  bool ok = true;
+
+  SnapR(const uint8_t *buf, size_t l) : b(buf), len(l) {}
+
+  const uint8_t *take(size_t k) {
+    if (!ok || i + k > len) {
+      ok = false;
+      return nullptr;
+    }
+    const uint8_t *p = b + i;
+    i += k;
+    return p;
+  }
+  uint8_t u8() {
+    const uint8_t *p = take(1);
+    return p ? p[0] : 0;
+  }
+  uint16_t u16() {
+    const uint8_t *p = take(2);
+    return p ? p[0] | (p[1] << 8) : 0;
+  }
+  uint32_t u32() {
+    const uint32_t lo = u16();
+    return lo | ((uint32_t)u16() << 16);
+  }
+  uint64_t u64() {
+    const uint64_t lo = u32();
+    return lo | ((uint64_t)u32() << 32);
+  }
+  float f32() {
+    const uint32_t u = u32();
+    float v;
+    memcpy(&v, &u, 4);
+    return v;
+  }
+  double f64() {
+    const uint64_t u = u64();
+    double v;
+    memcpy(&v, &u, 8);
+    return v;
+  }
+  void str(String &out) {
+    const uint16_t n = u16();
+    const uint8_t *p = take(n);
+    out = "";
+    if (p)
+      out.concat((const char *)p, n);
+  }
+  // Su buffer fisso: tronca a cap - 1
+  void str(char *out, size_t cap) {
+    const uint16_t n = u16();
+    const uint8_t *p = take(n);
+    const size_t k = p ? min((size_t)n, cap - 1) : 0;
+    memcpy(out, p, k);
+    out[k] = 0;
+  }
+};
+
+static uint32_t snapCrc32(const uint8_t *p, size_t n) {
+  uint32_t c = 0xFFFFFFFF;
+  while (n--) {
+    c ^= *p++;
+    for (uint8_t k = 0; k < 8; k++)
+      c = (c >> 1) ^ (0xEDB88320 & (0 - (c & 1)));
+  }
+  return ~c;
+}
+
+static uint32_t snapFnv(uint32_t h, const String &s) {
+  for (size_t i = 0; i < s.length(); i++)
+    h = (h ^ (uint8_t)s[i]) * 16777619UL;
+  return (h ^ 0xFF) * 16777619UL; // separatore: "ab"+"c" ≠ "a"+"bc"
+}
+
+// ============================================================================
+// SORGENTI
+// ============================================================================
+static bool snapHas(uint8_t p) {
+  switch (p) {
+  case P_WEATHER: case P_AIR: case P_T24: case P_BTC: case P_FX:
+  case P_NEWS: case P_CAL: case P_SUN: case P_QOD:
+    return true;
+  default:
+    return false;
+  }
+}
+
+// Impostazioni da cui dipendono i dati della pagina
+static uint32_t snapCfg(uint8_t p) {
+  uint32_t h = 2166136261UL;
+  switch (p) {
+  case P_WEATHER:
+  case P_SUN:
+    h = snapFnv(h, g_lang); // descrizioni e nomi localizzati
+    // fallthrough
+  case P_AIR:
+  case P_T24:
+    h = snapFnv(h, g_city);
+    h = snapFnv(h, g_lat);
+    return snapFnv(h, g_lon);
+  case P_BTC:
+  case P_FX:
+    return snapFnv(h, g_fiat);
+  case P_NEWS:
+    return snapFnv(h, g_rss_url);
+  case P_CAL:
+    return snapFnv(h, g_ics);
+  case P_QOD:
+    h = snapFnv(h, g_lang);
+    return snapFnv(h, g_oa_topic);
+  }
+  return h;
+}
+
+static void snapPut(uint8_t p, SnapW &w) {
+  switch (p) {
+  case P_WEATHER:
+    w.f32(w_now_tempC);
+    w.str(w_now_desc);
+    for (uint8_t i = 0; i < 3; i++)
+      w.str(w_desc[i]);
+    break;
+  case P_AIR:
+    for (uint8_t i = 0; i < 4; i++)
+      w.f32(aq_val[i]);
+    break;
+  case P_T24:
+    for (uint8_t i = 0; i < 24; i++)
+      w.f32(t24[i]);
+    break;
+  case P_BTC:
+    w.f32(cr_price);
+    w.f32(cr_chg24);
+    break;
+  case P_FX: {
+    const double v[8] = {fx_chf, fx_eur, fx_usd, fx_gbp,
+                         fx_jpy, fx_cad, fx_cny, fx_inr};
+    for (uint8_t i = 0; i < 8; i++)
+      w.f64(v[i]);
+    break;
+  }
+  case P_NEWS:
+    w.u8(NEWS_MAX);
+    for (uint8_t i = 0; i < NEWS_MAX; i++)
+      w.str(news_title[i]);
+    break;
+  case P_CAL:
+    w.u8(cal_count);
+    for (uint8_t i = 0; i < cal_count; i++) {
+      const IcsEntry &e = cal[i];
+      w.u64((uint64_t)(int64_t)e.start);
+      w.u64((uint64_t)(int64_t)e.end);
+      w.u32(e.uid);
+      w.u8(e.allDay | (e.override << 1));
+      w.str(e.summary);
+    }
+    break;
+  case P_SUN:
+    w.str(sun_rise);
+    w.str(sun_set);
+    w.str(sun_noon);
+    w.str(sun_cb);
+    w.str(sun_ce);
+    w.str(sun_len);
+    w.str(sun_uvi);
+    w.f32(g_moon_illum01);
+    w.u8(g_moon_waxing);
+    w.u8(g_moon_phase_idx);
+    break;
+  case P_QOD:
+    w.str(qod_text);
+    w.str(qod_author);
+    w.str(qod_date_ymd);
+    w.u8(qod_from_ai);
+    break;
+  }
+}
+
+static void snapGet(uint8_t p, SnapR &r) {
+  switch (p) {
+  case P_WEATHER:
+    w_now_tempC = r.f32();
+    r.str(w_now_desc);
+    for (uint8_t i = 0; i < 3; i++)
+      r.str(w_desc[i]);
+    break;
+  case P_AIR:
+    for (uint8_t i = 0; i < 4; i++)
+      aq_val[i] = r.f32();
+    break;
+  case P_T24:
+    for (uint8_t i = 0; i < 24; i++)
+      t24[i] = r.f32();
+    break;
+  case P_BTC:
+    cr_price = r.f32();
+    cr_chg24 = r.f32();
+    break;
+  case P_FX: {
+    double *const v[8] = {&fx_chf, &fx_eur, &fx_usd, &fx_gbp,
+                          &fx_jpy, &fx_cad, &fx_cny, &fx_inr};
+    for (uint8_t i = 0; i < 8; i++)
+      *v[i] = r.f64();
+    break;
+  }
+  case P_NEWS: {
+    const uint8_t n = r.u8();
+    for (uint8_t i = 0; i < n; i++) {
+      String t;
+      r.str(t);
+      if (i < NEWS_MAX)
+        news_title[i] = t;
+    }
+    break;
+  }
+  case P_CAL: {
+    const uint8_t n = r.u8();
+    cal_count = 0;
+    for (uint8_t i = 0; i < n && r.ok; i++) {
+      IcsEntry e;
+      e.start = (time_t)(int64_t)r.u64();
+      e.end = (time_t)(int64_t)r.u64();
+      e.uid = r.u32();
+      const uint8_t f = r.u8();
+      e.allDay = f & 1;
+      e.override = f & 2;
+      r.str(e.summary, sizeof(e.summary));
+      if (r.ok && cal_count < CAL_MAX)
+        cal[cal_count++] = e;
+    }
+    break;
+  }
+  case P_SUN:
+    r.str(sun_rise, sizeof(sun_rise));
+    r.str(sun_set, sizeof(sun_set));
+    r.str(sun_noon, sizeof(sun_noon));
+    r.str(sun_cb, sizeof(sun_cb));
+    r.str(sun_ce, sizeof(sun_ce));
+    r.str(sun_len, sizeof(sun_len));
+    r.str(sun_uvi, sizeof(sun_uvi));
+    g_moon_illum01 = r.f32();
+    g_moon_waxing = r.u8();
+    g_moon_phase_idx = r.u8() % 8;
+    break;
+  case P_QOD:
+    r.str(qod_text);
+    r.str(qod_author);
+    r.str(qod_date_ymd);
+    qod_from_ai = r.u8();
+    break;
+  }
+}
+
+// ============================================================================
+// FILE
+// ============================================================================
+static void snapPath(uint8_t p, char *out, const char *ext) {
+  snprintf(out, 16, "/snap%02u.%s", p, ext);
+}
+
+static uint32_t snapNow() {
+  return g_timeSynced ? (uint32_t)time(nullptr) : 0;
+}
+
+// Serializza sotto StateLock, scrive fuori (il loop non blocca la WebUI)
+static bool snapWrite(uint8_t p) {
+  static uint8_t buf[SNAP_HDR + SNAP_BUF];
+  SnapW w(buf + SNAP_HDR, SNAP_BUF);
+  uint32_t cfg;
+  {
+    StateLock lock;
+    snapPut(p, w);
+    cfg = snapCfg(p);
+  }
+  if (!w.ok)
+    return false;
+
+  const uint32_t crc = snapCrc32(buf + SNAP_HDR, w.n);
+  const uint32_t epoch = snapNow();
+  if (crc == snap_crc[p] && epoch - snap_epoch[p] < SNAP_REWRITE_S)
+    return true;
+
+  memcpy(buf, "SQSN", 4);
+  SnapW h(buf + 4, SNAP_HDR - 4);
+  h.u8(SNAP_VER);
+  h.u8(p);
+  h.u16(w.n);
+  h.u32(crc);
+  h.u32(epoch);
+  h.u32(cfg);
+
+  char tmp[16], dst[16];
+  snapPath(p, tmp, "tmp");
+  snapPath(p, dst, "bin");
+  File f = LittleFS.open(tmp, "w");
+  if (!f)
+    return false;
+  const size_t len = SNAP_HDR + w.n;
+  const bool ok = f.write(buf, len) == len;
+  f.close();
+  if (!ok || !LittleFS.rename(tmp, dst)) {
+    LittleFS.remove(tmp);
+    return false;
+  }
+  snap_crc[p] = crc;
+  snap_epoch[p] = epoch;
+  return true;
+}
+
+static bool snapRead(uint8_t p) {
+  char path[16];
+  snapPath(p, path, "bin");
+  if (!LittleFS.exists(path))
+    return false;
+  File f = LittleFS.open(path, "r");
+  if (!f)
+    return false;
+
+  const size_t len = f.size();
+  uint8_t *b = (len >= SNAP_HDR && len <= SNAP_HDR + SNAP_BUF)
+                   ? (uint8_t *)malloc(len)
+                   : nullptr;
+  const bool got = b && f.read(b, len) == len;
+  f.close();
+  if (!got) {
+    free(b);
+    return false;
+  }
+
+  SnapR h(b + 4, SNAP_HDR - 4);
+  const uint8_t ver = h.u8();
+  const uint8_t page = h.u8();
+  const uint16_t plen = h.u16();
+  const uint32_t crc = h.u32();
+  const uint32_t epoch = h.u32();
+  const uint32_t cfg = h.u32();
+
+  bool ok = !memcmp(b, "SQSN", 4) && ver == SNAP_VER && page == p &&
+            plen == len - SNAP_HDR && snapCrc32(b + SNAP_HDR, plen) == crc &&
+            cfg == snapCfg(p);
+  // Troppo vecchio (verificabile solo con l'ora già valida)
+  const uint32_t now = snapNow();
+  if (ok && now && epoch && now - epoch > SNAP_MAX_AGE_S)
+    ok = false;
+
+  if (ok) {
+    SnapR r(b + SNAP_HDR, plen);
+    snapGet(p, r);
+    ok = r.ok;
+    snap_crc[p] = crc;
+    snap_epoch[p] = epoch;
+  }
+  free(b);
+  return ok;
+}
+
+// ============================================================================
+// ORA PERSISTENTE (/clock.bin: u32 epoch, u32 ~epoch)
+// ============================================================================
+static void snapClockSave(uint32_t epoch) {
+  uint8_t b[8];
+  SnapW w(b, sizeof(b));
+  w.u32(epoch);
+  w.u32(~epoch);
+  File f = LittleFS.open("/clock.tmp", "w");
+  if (!f)
+    return;
+  const bool ok = f.write(b, sizeof(b)) == sizeof(b);
+  f.close();
+  if (!ok || !LittleFS.rename("/clock.tmp", "/clock.bin")) {
+    LittleFS.remove("/clock.tmp");
+    return;
+  }
+  snap_clock = epoch;
+}
+
+static void snapClockLoad() {
+  File f = LittleFS.open("/clock.bin", "r");
+  if (!f)
+    return;
+  uint8_t b[8];
+  const bool got = f.read(b, sizeof(b)) == sizeof(b);
+  f.close();
+  SnapR r(b, sizeof(b));
+  const uint32_t e = r.u32();
+  if (got && r.u32() == ~e)
+    snap_clock = e;
+}
+
+// ============================================================================
+// API
+// ============================================================================
+static uint32_t snapLastEpoch() {
+  uint32_t e = snap_clock;
+  for (uint8_t p = 0; p < PAGES; p++)
+    if (snap_epoch[p] > e)
+      e = snap_epoch[p];
+  return e;
+}
+
+static void snapRestoreAges() {
+  const uint32_t now = snapNow();
+  if (!now)
+    return;
+  for (uint8_t p = 0; p < PAGES; p++) {
+    if (g_fetchMs[p] || !snap_epoch[p] || now < snap_epoch[p])
+      continue;
+    // aritmetica modulo 2^32: millis() - g_fetchMs resta l'età corretta
+    g_fetchMs[p] = (millis() - (now - snap_epoch[p]) * 1000) | 1;
+  }
+}
+
+static uint8_t snapLoadAll() {
+  snap_fs = LittleFS.begin(true);
+  if (!snap_fs)
+    return 0;
+  if (LittleFS.exists("/clock.bin"))
+    snapClockLoad();
+  uint8_t n = 0;
+  for (uint8_t p = 0; p < PAGES; p++)
+    if (snapHas(p) && snapRead(p))
+      n++;
+  snapRestoreAges();
+  return n;
+}
+
+static inline void snapMark(uint8_t p) {
+  if (!snapHas(p))
+    return;
+  snap_dirty |= 1UL << p;
+  snap_markMs = millis();
+}
+
+static void snapFlush() {
+  if (!snap_fs)
+    return;
+  for (uint8_t p = 0; snap_dirty && p < PAGES; p++) {
+    if (!(snap_dirty & (1UL << p)))
+      continue;
+    snap_dirty &= ~(1UL << p);
+    snapWrite(p);
+  }
+}
+
+static void snapTick() {
+  if (snap_dirty && millis() - snap_markMs >= SNAP_DEBOUNCE_MS)
+    snapFlush();
+  const uint32_t now = snapNow();
+  if (snap_fs && now && now - snap_clock >= SNAP_CLOCK_S)
+    snapClockSave(now);
+}
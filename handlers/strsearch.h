@@ -0,0 +1,198 @@
+/*
+===============================================================================
+   SQUARED — SUBSTRING SEARCH (Header-only)
+   Descrizione: ricerca di sottostringhe su buffer grandi (ICS, RSS, JSON)
+                con salto sul primo byte (memchr / SWAR a 32 bit), shift
+                Horspool per pattern lunghi e variante case-insensitive con
+                pattern minuscolo precalcolato. Nessuna allocazione.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • ssFind(hay, n, pat, m [,from])     → indice o -1
+   • ssFindCI(hay, n, pat, m [,from])   → indice o -1 (ASCII case-fold)
+
+   • StrSearch s(pat, ci)               pattern compilato (tabella shift +
+     s.in(hay, n, from)                 copia minuscola) da riusare nei loop
+
+   Strategia: pattern corti o buffer piccoli → skip sul primo byte +
+   confronto; altrimenti Horspool (tabella 256 byte sullo stack).
+   Pattern oltre SS_MAX_PAT (64 byte) sono cercati per intero con il solo
+   skip sul primo byte: nessun troncamento, nessuna tabella.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+
+static constexpr uint8_t SS_MAX_PAT = 64;   // oltre: solo skip primo byte
+static constexpr size_t SS_HORSPOOL_MIN = 256; // buffer minimo per Horspool
+
+static inline uint8_t ssFold(uint8_t c) {
+  return (c >= 'A' && c <= 'Z') ? c + 32 : c;
+}
+
+// ---------------------------------------------------------------------------
+// Primo byte uguale ad a oppure b (SWAR su parole a 32 bit allineate)
+// ---------------------------------------------------------------------------
+static inline const char *ssFindByte2(const char *p, const char *e, uint8_t a,
+                                      uint8_t b) {
+  while (p < e && ((uintptr_t)p & 3)) {
+    if ((uint8_t)*p == a || (uint8_t)*p == b)
+      return p;
+    p++;
+  }
+
+  const uint32_t ma = a * 0x01010101u;
+  const uint32_t mb = b * 0x01010101u;
+
+  while (e - p >= 4) {
+    const uint32_t w = *(const uint32_t *)p;
+    const uint32_t xa = w ^ ma;
+    const uint32_t xb = w ^ mb;
+    // byte nullo in xa o xb ⇔ il byte di w vale a o b
+    if (((xa - 0x01010101u) & ~xa & 0x80808080u) |
+        ((xb - 0x01010101u) & ~xb & 0x80808080u))
+      break;
+    p += 4;
+  }
+
+  for (; p < e; p++)
+    if ((uint8_t)*p == a || (uint8_t)*p == b)
+      return p;
+  return nullptr;
+}
+
+static inline bool ssEqualCI(const char *s, const char *lowerPat, size_t m) {
+  for (size_t i = 0; i < m; i++)
+    if (ssFold((uint8_t)s[i]) != (uint8_t)lowerPat[i])
+      return false;
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Pattern compilato
+// ---------------------------------------------------------------------------
+struct StrSearch {
+  const char *pat;
+  size_t m; // nessun limite: oltre SS_MAX_PAT niente tabella né copia
+  bool ci;
+  bool table;
+  char lower[SS_MAX_PAT];
+  uint8_t shift[256];
+
+  StrSearch(const char *p, size_t len, bool caseInsensitive)
+      : pat(p), m(len), ci(caseInsensitive), table(false) {
+    if (ci) {
+      const uint8_t k = m < SS_MAX_PAT ? m : SS_MAX_PAT;
+      for (uint8_t i = 0; i < k; i++)
+        lower[i] = (char)ssFold((uint8_t)p[i]);
+    }
+  }
+  StrSearch(const char *p, bool caseInsensitive = false)
+      : StrSearch(p, strlen(p), caseInsensitive) {}
+
+  // Tabella Horspool costruita solo quando serve (buffer grandi)
+  void build() {
+    if (table || m < 2 || m > SS_MAX_PAT)
+      return;
+    memset(shift, m, sizeof(shift));
+    for (size_t i = 0; i + 1 < m; i++) {
+      uint8_t c = ci ? (uint8_t)lower[i] : (uint8_t)pat[i];
+      shift[c] = m - 1 - i;
+      if (ci && c >= 'a' && c <= 'z')
+        shift[c - 32] = m - 1 - i;
+    }
+    table = true;
+  }
+
+  int in(const char *hay, size_t n, size_t from = 0) {
+    if (!m)
+      return from <= n ? (int)from : -1;
+    if (from >= n || n - from < m)
+      return -1;
+
+    const char *e = hay + n;
+    const bool longPat = m > SS_MAX_PAT;
+
+    // --- Horspool ---
+    if (!longPat && m >= 4 && n - from >= SS_HORSPOOL_MIN) {
+      build();
+      const char *pp = ci ? lower : pat;
+      const uint8_t last = (uint8_t)pp[m - 1];
+      const char *s = hay + from;
+      const char *stop = e - m;
+
+      while (s <= stop) {
+        uint8_t c = (uint8_t)s[m - 1];
+        if ((ci ? ssFold(c) : c) == last &&
+            (ci ? ssEqualCI(s, lower, m - 1) : memcmp(s, pat, m - 1) == 0))
+          return (int)(s - hay);
+        s += shift[c];
+      }
+      return -1;
+    }
+
+    // --- skip sul primo byte + confronto ---
+    const char *s = hay + from;
+    const char *stop = e - m + 1;
+
+    if (!ci || longPat) {
+      const uint8_t f = (uint8_t)pat[0];
+      while (s < stop) {
+        if (ci) {
+          s = ssFindByte2(s, stop, ssFold(f), f >= 'a' && f <= 'z' ? f - 32 : f);
+        } else {
+          s = (const char *)memchr(s, f, stop - s);
+        }
+        if (!s)
+          return -1;
+        bool eq = true;
+        for (size_t i = 1; i < m && eq; i++)
+          eq = ci ? ssFold((uint8_t)s[i]) == ssFold((uint8_t)pat[i])
+                  : s[i] == pat[i];
+        if (eq)
+          return (int)(s - hay);
+        s++;
+      }
+      return -1;
+    }
+
+    const uint8_t f = (uint8_t)lower[0];
+    const uint8_t F = (f >= 'a' && f <= 'z') ? f - 32 : f;
+    while (s < stop) {
+      s = ssFindByte2(s, stop, f, F);
+      if (!s)
+        return -1;
+      if (ssEqualCI(s + 1, lower + 1, m - 1))
+        return (int)(s - hay);
+      s++;
+    }
+    return -1;
+  }
+};
+
+// ---------------------------------------------------------------------------
+// Ricerche one-shot
+// ---------------------------------------------------------------------------
+static inline int ssFind(const char *hay, size_t n, const char *pat, size_t m,
+                         size_t from = 0) {
+  if (m == 1) {
+    if (from >= n)
+      return -1;
+    const char *q = (const char *)memchr(hay + from, pat[0], n - from);
+    return q ? (int)(q - hay) : -1;
+  }
+  StrSearch s(pat, m, false);
+  return s.in(hay, n, from);
+}
+
+static inline int ssFindCI(const char *hay, size_t n, const char *pat,
+                           size_t m, size_t from = 0) {
+  StrSearch s(pat, m, true);
+  return s.in(hay, n, from);
+}
@@ -0,0 +1,371 @@
+/*
+===============================================================================
+   SQUARED — STRING VIEW & NUMBER PARSING (Header-only)
+   Descrizione: vista (const char*, len) su buffer esistenti e parser numerici
+                in stile std::from_chars (interi, float, date ISO-8601) che
+                lavorano in place, senza String temporanee né heap.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • StrView v(body)               vista su String / char* / (ptr,len)
+       v.find('x'), v.find("BEGIN:VEVENT"), v.findCI("dtstart"),
+       v.sub(a, n), v.trim(),
+       v.startsWith(), v.equalsCI(), v.copyTo(buf, cap)
+
+   • svFromChars(first, last, int32_t&|double&|float&)
+       Ritorna {ptr, ok}: ptr punta al primo carattere non consumato.
+       Gli interi fuori range saturano a INT32_MIN / INT32_MAX.
+
+   • svParseIso8601(first, last, IsoTime&)
+       YYYY-MM-DD[THH:MM[:SS[.fff]]][Z|±HH[:MM]]  (esteso)
+       YYYYMMDD[THHMMSS][Z]                       (base, ICS)
+
+   • isoEpoch(t) / isoToUtcEpoch(t) / isoToLocalEpoch(t)
+       Epoch da IsoTime: con 'Z' o offset l'istante esatto, altrimenti
+       campi interpretati come ora locale (mktime).
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <math.h>
+#include <string.h>
+#include <time.h>
+
+#include "strsearch.h"
+
+// ============================================================================
+// VISTA
+// ============================================================================
+struct StrView {
+  const char *p;
+  size_t n;
+
+  StrView() : p(""), n(0) {}
+  StrView(const char *s, size_t len) : p(s), n(len) {}
+  StrView(const char *s) : p(s), n(strlen(s)) {}
+  StrView(const String &s) : p(s.c_str()), n(s.length()) {}
+
+  size_t size() const { return n; }
+  bool empty() const { return n == 0; }
+  const char *begin() const { return p; }
+  const char *end() const { return p + n; }
+  char operator[](size_t i) const { return p[i]; }
+
+  StrView sub(size_t pos, size_t len = (size_t)-1) const {
+    if (pos > n)
+      pos = n;
+    if (len > n - pos)
+      len = n - pos;
+    return StrView(p + pos, len);
+  }
+
+  int find(char c, size_t from = 0) const {
+    if (from >= n)
+      return -1;
+    const char *q = (const char *)memchr(p + from, c, n - from);
+    return q ? (int)(q - p) : -1;
+  }
+
+  int find(StrView pat, size_t from = 0) const {
+    return ssFind(p, n, pat.p, pat.n, from);
+  }
+
+  int findCI(StrView pat, size_t from = 0) const {
+    return ssFindCI(p, n, pat.p, pat.n, from);
+  }
+
+  bool startsWith(StrView s) const {
+    return s.n <= n && memcmp(p, s.p, s.n) == 0;
+  }
+
+  bool equals(StrView s) const { return s.n == n && memcmp(p, s.p, n) == 0; }
+
+  bool equalsCI(StrView s) const {
+    if (s.n != n)
+      return false;
+    for (size_t i = 0; i < n; i++)
+      if (tolower((uint8_t)p[i]) != tolower((uint8_t)s.p[i]))
+        return false;
+    return true;
+  }
+
+  StrView trim() const {
+    size_t a = 0, b = n;
+    while (a < b && isspace((uint8_t)p[a]))
+      a++;
+    while (b > a && isspace((uint8_t)p[b - 1]))
+      b--;
+    return StrView(p + a, b - a);
+  }
+
+  // Copia con troncamento e terminatore; ritorna i byte copiati
+  size_t copyTo(char *buf, size_t cap) const {
+    if (!cap)
+      return 0;
+    size_t k = n < cap - 1 ? n : cap - 1;
+    memcpy(buf, p, k);
+    buf[k] = 0;
+    return k;
+  }
+
+  String toString() const {
+    String s;
+    s.concat(p, n);
+    return s;
+  }
+};
+
+// ============================================================================
+// NUMERI
+// ============================================================================
+struct SvParse {
+  const char *ptr;
+  bool ok;
+};
+
+static inline SvParse svFromChars(const char *first, const char *last,
+                                  int32_t &value) {
+  const char *p = first;
+  bool neg = false;
+  if (p < last && (*p == '-' || *p == '+'))
+    neg = (*p++ == '-');
+
+  const char *d = p;
+  int64_t v = 0;
+  for (; p < last && *p >= '0' && *p <= '9'; p++)
+    if (v < 0x80000000LL)
+      v = v * 10 + (*p - '0');
+
+  if (p == d)
+    return {first, false};
+
+  // fuori range: satura come strtol invece di troncare a 32 bit
+  if (neg)
+    value = v > 0x80000000LL ? INT32_MIN : (int32_t)-v;
+  else
+    value = v > 0x7FFFFFFFLL ? INT32_MAX : (int32_t)v;
+  return {p, true};
+}
+
+static inline SvParse svFromChars(const char *first, const char *last,
+                                  double &value) {
+  const char *p = first;
+
+  bool neg = false;
+  if (p < last && (*p == '-' || *p == '+'))
+    neg = (*p++ == '-');
+
+  uint64_t mant = 0;
+  int exp10 = 0;
+  uint8_t digits = 0;
+  bool any = false;
+
+  for (; p < last && *p >= '0' && *p <= '9'; p++, any = true) {
+    if (digits < 19) {
+      mant = mant * 10 + (*p - '0');
+      if (mant)
+        digits++;
+    } else {
+      exp10++;
+    }
+  }
+
+  if (p < last && *p == '.') {
+    for (p++; p < last && *p >= '0' && *p <= '9'; p++, any = true) {
+      if (digits < 19) {
+        mant = mant * 10 + (*p - '0');
+        if (mant)
+          digits++;
+        exp10--;
+      }
+    }
+  }
+
+  if (!any)
+    return {first, false};
+
+  if (p < last && (*p == 'e' || *p == 'E')) {
+    const char *q = p + 1;
+    bool eneg = false;
+    if (q < last && (*q == '-' || *q == '+'))
+      eneg = (*q++ == '-');
+    if (q < last && *q >= '0' && *q <= '9') {
+      int ev = 0;
+      for (; q < last && *q >= '0' && *q <= '9'; q++)
+        if (ev < 400)
+          ev = ev * 10 + (*q - '0');
+      exp10 += eneg ? -ev : ev;
+      p = q;
+    }
+  }
+
+  // divisione per 10^k: risultato esatto per i decimali tipici delle API
+  double v = (double)mant;
+  if (exp10 < 0)
+    v /= pow(10.0, -exp10);
+  else if (exp10 > 0)
+    v *= pow(10.0, exp10);
+
+  value = neg ? -v : v;
+  return {p, true};
+}
+
+static inline SvParse svFromChars(const char *first, const char *last,
+                                  float &value) {
+  double d;
+  SvParse r = svFromChars(first, last, d);
+  if (r.ok)
+    value = (float)d;
+  return r;
+}
+
+// Esattamente n cifre decimali (campi a larghezza fissa di date/ore)
+static inline bool svDigits(const char *p, const char *last, uint8_t n,
+                            int &out) {
+  if (last - p < n)
+    return false;
+  int v = 0;
+  for (uint8_t i = 0; i < n; i++) {
+    if (p[i] < '0' || p[i] > '9')
+      return false;
+    v = v * 10 + (p[i] - '0');
+  }
+  out = v;
+  return true;
+}
+
+// ============================================================================
+// DATE ISO-8601
+// ============================================================================
+struct IsoTime {
+  int16_t year;
+  uint8_t mon; // 1..12
+  uint8_t day;
+  uint8_t hour;
+  uint8_t min;
+  uint8_t sec;
+  bool hasTime;
+  bool hasOffset; // 'Z' o ±HH:MM presente
+  int16_t offMin; // offset rispetto a UTC in minuti
+};
+
+static inline SvParse svParseIso8601(const char *first, const char *last,
+                                     IsoTime &t) {
+  memset(&t, 0, sizeof(t));
+  const char *p = first;
+  int v;
+
+  // --- data ---
+  if (!svDigits(p, last, 4, v))
+    return {first, false};
+  t.year = v;
+  p += 4;
+
+  const bool ext = (p < last && *p == '-');
+  if (ext)
+    p++;
+  if (!svDigits(p, last, 2, v))
+    return {first, false};
+  t.mon = v;
+  p += 2;
+  if (ext) {
+    if (p >= last || *p != '-')
+      return {first, false};
+    p++;
+  }
+  if (!svDigits(p, last, 2, v))
+    return {first, false};
+  t.day = v;
+  p += 2;
+
+  if (t.mon < 1 || t.mon > 12 || t.day < 1 || t.day > 31)
+    return {first, false};
+
+  // --- ora ---
+  if (p < last && (*p == 'T' || *p == ' ') && svDigits(p + 1, last, 2, v)) {
+    p++;
+    t.hour = v;
+    p += 2;
+    if (p < last && *p == ':')
+      p++;
+    if (svDigits(p, last, 2, v)) {
+      t.min = v;
+      p += 2;
+      if (p < last && *p == ':')
+        p++;
+      if (svDigits(p, last, 2, v)) {
+        t.sec = v;
+        p += 2;
+      }
+      // frazioni di secondo ignorate
+      if (p < last && (*p == '.' || *p == ',')) {
+        p++;
+        while (p < last && *p >= '0' && *p <= '9')
+          p++;
+      }
+    }
+    t.hasTime = true;
+
+    // --- fuso ---
+    if (p < last && *p == 'Z') {
+      t.hasOffset = true;
+      p++;
+    } else if (p < last && (*p == '+' || *p == '-')) {
+      const int sign = (*p == '-') ? -1 : 1;
+      int hh, mm = 0;
+      if (svDigits(p + 1, last, 2, hh)) {
+        p += 3;
+        if (p < last && *p == ':')
+          p++;
+        if (svDigits(p, last, 2, mm))
+          p += 2;
+        t.hasOffset = true;
+        t.offMin = sign * (hh * 60 + mm);
+      }
+    }
+  }
+
+  return {p, true};
+}
+
+static inline SvParse svParseIso8601(StrView s, IsoTime &t) {
+  return svParseIso8601(s.begin(), s.end(), t);
+}
+
+// Giorni dal 1970-01-01 (algoritmo days_from_civil)
+static inline int32_t svDaysFromCivil(int y, unsigned m, unsigned d) {
+  y -= m <= 2;
+  const int era = (y >= 0 ? y : y - 399) / 400;
+  const unsigned yoe = (unsigned)(y - era * 400);
+  const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+  const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+  return era * 146097 + (int32_t)doe - 719468;
+}
+
+static inline time_t isoToUtcEpoch(const IsoTime &t) {
+  int64_t s = (int64_t)svDaysFromCivil(t.year, t.mon, t.day) * 86400 +
+              t.hour * 3600 + t.min * 60 + t.sec;
+  return (time_t)(s - (int32_t)t.offMin * 60);
+}
+
+static inline time_t isoToLocalEpoch(const IsoTime &t) {
+  struct tm tt = {};
+  tt.tm_year = t.year - 1900;
+  tt.tm_mon = t.mon - 1;
+  tt.tm_mday = t.day;
+  tt.tm_hour = t.hour;
+  tt.tm_min = t.min;
+  tt.tm_sec = t.sec;
+  tt.tm_isdst = -1;
+  return mktime(&tt);
+}
+
+// Epoch coerente: con offset/Z → istante esatto, altrimenti ora locale
+static inline time_t isoEpoch(const IsoTime &t) {
+  return t.hasOffset ? isoToUtcEpoch(t) : isoToLocalEpoch(t);
+}
@@ -11,17 +11,13 @@
 
 #pragma once
 #include <Arduino.h>
-#include <TAMC_GT911.h>
-
-#define TOUCH_SDA 19
-#define TOUCH_SCL 45
-#define TOUCH_INT -1
-#define TOUCH_RST -1
-
-#define TOUCH_WIDTH 480
-#define TOUCH_HEIGHT 480
+#include "layers.h"
+#include "nightmode.h"
+#include "touchinput.h"
+#include "widgets.h"
 
 extern uint32_t lastPageSwitch;
+void swipeToPage(int8_t dir);
 
 class Arduino_RGB_Display;
 extern Arduino_RGB_Display *gfx;
@@ -61,12 +57,6 @@ constexpr uint16_t MENU_ACCENT = 0x07FF;
 constexpr uint16_t MENU_ON_BG = 0x0320;
 constexpr uint16_t MENU_ARROW_DIS = 0x1082;
 
-// ---------------------------------------------------------------------------
-// OGGETTO TOUCH
-// ---------------------------------------------------------------------------
-static TAMC_GT911 ts(TOUCH_SDA, TOUCH_SCL, TOUCH_INT, TOUCH_RST, TOUCH_WIDTH,
-                     TOUCH_HEIGHT);
-
 // ---------------------------------------------------------------------------
 // STATO TOUCH
 // ---------------------------------------------------------------------------
@@ -81,9 +71,6 @@ static struct {
 #define touchPaused touchState.paused
 #define menuActive touchState.active
 
-static uint32_t lastTouchMs = 0;
-static uint8_t lastTouches = 0;
-
 // ---------------------------------------------------------------------------
 // PAGINAZIONE
 // ---------------------------------------------------------------------------
@@ -125,12 +112,35 @@ constexpr int16_t BTN_CANCEL_X = ACT_AREA_X;
 constexpr int16_t BTN_OK_X = ACT_AREA_X + ACT_BTN_W + ACT_GAP;
 
 // ---------------------------------------------------------------------------
-// CACHE posizioni
+// WIDGET MENU: i genitori prima dei figli
 // ---------------------------------------------------------------------------
-static int16_t slotX[ITEMS_PER_PAGE];  // era int (32 → 16 byte)
-static int16_t slotY[ITEMS_PER_PAGE];  // era int (32 → 16 byte)
-static int8_t slotIdx[ITEMS_PER_PAGE]; // era int (32 → 8 byte)
-static uint8_t visibleCount = 0;       // era int (4 → 1 byte)
+enum : uint8_t {
+  MW_ROOT, // schermo intero: il fondo del menu
+  MW_TITLE,
+  MW_COUNT,
+  MW_PAGE,
+  MW_BTN0,
+  MW_ARROW_L = MW_BTN0 + ITEMS_PER_PAGE,
+  MW_ARROW_R,
+  MW_CANCEL,
+  MW_OK,
+  MW_N
+};
+
+static constexpr WgStyle MS_ROOT = {MENU_BG, 0, 0, 0, 0, 0, 0, 0};
+static constexpr WgStyle MS_TITLE = {MENU_BG, MENU_TEXT, 0, 0, 0, 0, 0, 2};
+static constexpr WgStyle MS_DIM = {MENU_BG, MENU_TEXT_DIM, 0, 0, 0, 0, 0, 1};
+static constexpr WgStyle MS_PAGE = {MENU_CARD, MENU_TEXT_DIM, MENU_BORDER,
+                                    MENU_ON_BG, MENU_TEXT, MENU_ACCENT, 8, 2};
+static constexpr WgStyle MS_ARROW = {MENU_ARROW_DIS, MENU_TEXT_DIM, MENU_BORDER,
+                                     MENU_CARD, MENU_TEXT, MENU_ACCENT, 8, 2};
+static constexpr WgStyle MS_ACTION = {MENU_CARD, MENU_TEXT, MENU_BORDER,
+                                      MENU_ACCENT, MENU_BG, MENU_ACCENT, 8, 2};
+
+static Widget menuW[MW_N];
+static WgTree menuUi = {menuW, MW_N, 0, MENU_BG};
+
+static int8_t slotIdx[ITEMS_PER_PAGE]; // pagina dietro ogni bottone
 
 // ---------------------------------------------------------------------------
 // Calcola pagine totali
@@ -143,125 +153,54 @@ static void calcMenuPages() {
 }
 
 // ---------------------------------------------------------------------------
-// Disegna singolo bottone pagina
+// Albero del menu (una volta)
 // ---------------------------------------------------------------------------
-static void drawPageBtn(uint8_t slot, uint8_t pageIdx, int16_t x, int16_t y,
-                        bool isOn) {
-  constexpr uint8_t R = 8;
-
-  uint16_t bgCol = isOn ? MENU_ON_BG : MENU_CARD;
-  uint16_t borderCol = isOn ? MENU_ACCENT : MENU_BORDER;
-  uint16_t textCol = isOn ? MENU_TEXT : MENU_TEXT_DIM;
-
-  gfx->fillRoundRect(x, y, M_BTN_W, M_BTN_H, R, bgCol);
-  gfx->drawRoundRect(x, y, M_BTN_W, M_BTN_H, R, borderCol);
-
-  // Indicatore stato
-  int16_t indX = x + M_BTN_W - 22;
-  int16_t indY = y + M_BTN_H / 2;
-  if (isOn) {
-    gfx->fillCircle(indX, indY, 7, MENU_ACCENT);
-  } else {
-    gfx->drawCircle(indX, indY, 7, MENU_TEXT_DIM);
-  }
-
-  // Label
-  gfx->setTextSize(2);
-  gfx->setTextColor(textCol);
-  gfx->setCursor(x + 14, y + (M_BTN_H - 16) / 2);
-  gfx->print(pageLabel(pageIdx));
-}
+static void buildMenuUi() {
+  wgAdd(menuUi, WG_PANEL, 0, 0, 480, 480, &MS_ROOT);
+  wgAdd(menuUi, WG_LABEL, M_MARGIN, 16, 300, 16, &MS_TITLE, MW_ROOT);
+  wgAdd(menuUi, WG_LABEL, M_MARGIN, 40, 100, 8, &MS_DIM, MW_ROOT);
+  wgAdd(menuUi, WG_LABEL, 400, 40, 480 - M_MARGIN - 400, 8, &MS_DIM, MW_ROOT,
+        WG_RIGHT);
 
-// ---------------------------------------------------------------------------
-// Disegna freccia
-// ---------------------------------------------------------------------------
-static void drawArrowBtn(int16_t x, int16_t y, bool isLeft, bool enabled) {
-  uint16_t bgCol = enabled ? MENU_CARD : MENU_ARROW_DIS;
-  uint16_t borderCol = enabled ? MENU_ACCENT : MENU_BORDER;
-  uint16_t arrowCol = enabled ? MENU_TEXT : MENU_TEXT_DIM;
-
-  gfx->fillRoundRect(x, y, ARROW_SZ, ARROW_SZ, 8, bgCol);
-  gfx->drawRoundRect(x, y, ARROW_SZ, ARROW_SZ, 8, borderCol);
-
-  int16_t cx = x + ARROW_SZ / 2;
-  int16_t cy = y + ARROW_SZ / 2;
-  constexpr int8_t sz = 12;
-
-  if (isLeft) {
-    gfx->fillTriangle(cx - sz + 2, cy, cx + sz - 6, cy - sz, cx + sz - 6,
-                      cy + sz, arrowCol);
-  } else {
-    gfx->fillTriangle(cx + sz - 2, cy, cx - sz + 6, cy - sz, cx - sz + 6,
-                      cy + sz, arrowCol);
+  for (uint8_t slot = 0; slot < ITEMS_PER_PAGE; slot++) {
+    const int16_t x = M_MARGIN + (slot % M_COLS) * (M_BTN_W + M_GAP_X);
+    const int16_t y = M_GRID_Y + (slot / M_COLS) * (M_BTN_H + M_GAP_Y);
+    wgAdd(menuUi, WG_BUTTON, x, y, M_BTN_W, M_BTN_H, &MS_PAGE, MW_ROOT, WG_DOT);
   }
-}
 
-// ---------------------------------------------------------------------------
-// Disegna pulsante azione
-// ---------------------------------------------------------------------------
-static void drawActionBtn(int16_t x, int16_t y,
-                          const __FlashStringHelper *label, bool filled) {
-  uint16_t bgCol = filled ? MENU_ACCENT : MENU_CARD;
-  uint16_t textCol = filled ? MENU_BG : MENU_TEXT;
-  uint16_t borderCol = filled ? MENU_ACCENT : MENU_BORDER;
-
-  gfx->fillRoundRect(x, y, ACT_BTN_W, ACT_BTN_H, 8, bgCol);
-  gfx->drawRoundRect(x, y, ACT_BTN_W, ACT_BTN_H, 8, borderCol);
-
-  gfx->setTextSize(2);
-  gfx->setTextColor(textCol);
-
-  // Calcola larghezza stringa PROGMEM
-  PGM_P p = reinterpret_cast<PGM_P>(label);
-  uint8_t len = strlen_P(p);
-  int16_t textW = len * 12;
-  int16_t textX = x + (ACT_BTN_W - textW) / 2;
-  int16_t textY = y + (ACT_BTN_H - 14) / 2;
-
-  gfx->setCursor(textX, textY);
-  gfx->print(label);
+  wgAdd(menuUi, WG_BUTTON, ARROW_L_X, ARROW_Y, ARROW_SZ, ARROW_SZ, &MS_ARROW,
+        MW_ROOT, WG_ARROW_L);
+  wgAdd(menuUi, WG_BUTTON, ARROW_R_X, ARROW_Y, ARROW_SZ, ARROW_SZ, &MS_ARROW,
+        MW_ROOT, WG_ARROW_R);
+  wgAdd(menuUi, WG_BUTTON, BTN_CANCEL_X, ACT_BTN_Y, ACT_BTN_W, ACT_BTN_H,
+        &MS_ACTION, MW_ROOT, WG_CENTER);
+  wgAdd(menuUi, WG_BUTTON, BTN_OK_X, ACT_BTN_Y, ACT_BTN_W, ACT_BTN_H,
+        &MS_ACTION, MW_ROOT, WG_CENTER);
+
+  wgText(menuW[MW_TITLE], "Gestione Pagine");
+  wgText(menuW[MW_CANCEL], "ANNULLA");
+  wgText(menuW[MW_OK], "OK");
+  wgOn(menuW[MW_OK], true);
 }
 
 // ---------------------------------------------------------------------------
-// Header
+// Stato (menuPage, g_show) → widget: sporchi solo quelli cambiati
 // ---------------------------------------------------------------------------
-static void drawMenuHeader() {
-  gfx->fillRect(0, 0, 480, 3, MENU_ACCENT);
-
-  gfx->setTextSize(2);
-  gfx->setTextColor(MENU_TEXT);
-  gfx->setCursor(M_MARGIN, 16);
-  gfx->print(F("Gestione Pagine"));
-
-  uint8_t activeCount = 0;
-  for (uint8_t i = 0; i < (uint8_t)PAGES; i++) {
-    if (g_show[i])
-      activeCount++;
+static void syncMenuUi() {
+  const uint8_t start = menuPage * ITEMS_PER_PAGE;
+  for (uint8_t slot = 0; slot < ITEMS_PER_PAGE; slot++) {
+    Widget &b = menuW[MW_BTN0 + slot];
+    const uint8_t i = start + slot;
+    slotIdx[slot] = i < (uint8_t)PAGES ? i : -1;
+    wgShow(b, slotIdx[slot] >= 0);
+    if (slotIdx[slot] < 0)
+      continue;
+    wgText(b, pageLabel(i));
+    wgOn(b, g_show[i]);
   }
 
-  gfx->setTextSize(1);
-  gfx->setTextColor(MENU_TEXT_DIM);
-  gfx->setCursor(M_MARGIN, 40);
-  gfx->print(activeCount);
-  gfx->print(F("/"));
-  gfx->print((uint8_t)PAGES);
-  gfx->print(F(" attive"));
-
-  char buf[6];
-  snprintf_P(buf, sizeof(buf), PSTR("%d/%d"), menuPage + 1, totalMenuPages);
-  uint8_t w = strlen(buf) * 6;
-  gfx->setCursor(480 - M_MARGIN - w, 40);
-  gfx->print(buf);
-
-  gfx->drawFastHLine(M_MARGIN, M_HEADER_H - 4, 480 - M_MARGIN * 2, MENU_BORDER);
-}
-
-// ---------------------------------------------------------------------------
-// Aggiorna contatore
-// ---------------------------------------------------------------------------
-static void updateMenuCounter() {
-  gfx->fillRect(M_MARGIN, 38, 100, 14, MENU_BG);
-  gfx->fillRect(400, 38, 70, 14, MENU_BG);
+  wgOn(menuW[MW_ARROW_L], menuPage > 0);
+  wgOn(menuW[MW_ARROW_R], menuPage < totalMenuPages - 1);
 
   uint8_t activeCount = 0;
   for (uint8_t i = 0; i < (uint8_t)PAGES; i++) {
@@ -269,72 +208,37 @@ static void updateMenuCounter() {
       activeCount++;
   }
 
-  gfx->setTextSize(1);
-  gfx->setTextColor(MENU_TEXT_DIM);
-  gfx->setCursor(M_MARGIN, 40);
-  gfx->print(activeCount);
-  gfx->print(F("/"));
-  gfx->print((uint8_t)PAGES);
-  gfx->print(F(" attive"));
-
-  char buf[6];
+  char buf[20];
+  snprintf_P(buf, sizeof(buf), PSTR("%u/%u attive"), activeCount,
+             (unsigned)PAGES);
+  wgText(menuW[MW_COUNT], buf);
   snprintf_P(buf, sizeof(buf), PSTR("%d/%d"), menuPage + 1, totalMenuPages);
-  uint8_t w = strlen(buf) * 6;
-  gfx->setCursor(480 - M_MARGIN - w, 40);
-  gfx->print(buf);
-}
-
-// ---------------------------------------------------------------------------
-// Disegna griglia
-// ---------------------------------------------------------------------------
-static void drawMenuGrid() {
-  gfx->fillRect(0, M_HEADER_H, 480, M_GRID_H, MENU_BG);
-
-  uint8_t startIdx = menuPage * ITEMS_PER_PAGE;
-  uint8_t endIdx = startIdx + ITEMS_PER_PAGE;
-  if (endIdx > (uint8_t)PAGES)
-    endIdx = (uint8_t)PAGES;
-  visibleCount = endIdx - startIdx;
-
-  uint8_t slot = 0;
-  for (uint8_t i = startIdx; i < endIdx; i++) {
-    uint8_t col = slot % M_COLS;
-    uint8_t row = slot / M_COLS;
-
-    int16_t x = M_MARGIN + col * (M_BTN_W + M_GAP_X);
-    int16_t y = M_GRID_Y + row * (M_BTN_H + M_GAP_Y);
-
-    slotX[slot] = x;
-    slotY[slot] = y;
-    slotIdx[slot] = i;
-
-    drawPageBtn(slot, i, x, y, g_show[i]);
-    slot++;
-  }
-
-  drawArrowBtn(ARROW_L_X, ARROW_Y, true, menuPage > 0);
-  drawArrowBtn(ARROW_R_X, ARROW_Y, false, menuPage < totalMenuPages - 1);
-  updateMenuCounter();
+  wgText(menuW[MW_PAGE], buf);
 }
 
 // ---------------------------------------------------------------------------
-// MENU COMPLETO
+// MENU COMPLETO: la pagina sotto resta in PSRAM per la chiusura
 // ---------------------------------------------------------------------------
 static void drawPauseOverlay() {
   calcMenuPages();
   menuPage = 0;
+  if (!menuUi.n)
+    buildMenuUi();
 
-  gfx->fillScreen(MENU_BG);
-  drawMenuHeader();
-  drawActionBtn(BTN_CANCEL_X, ACT_BTN_Y, F("ANNULLA"), false);
-  drawActionBtn(BTN_OK_X, ACT_BTN_Y, F("OK"), true);
-  drawMenuGrid();
+  lySaveScreen();
+  syncMenuUi();
+  wgInvalidate(menuUi); // il pannello radice fa da fillScreen
+  wgRender(menuUi);
+  gfx->fillRect(0, 0, 480, 3, MENU_ACCENT);
+  gfx->drawFastHLine(M_MARGIN, M_HEADER_H - 4, 480 - M_MARGIN * 2, MENU_BORDER);
 }
 
 // ---------------------------------------------------------------------------
-// CLEAR overlay
+// CLEAR overlay: copia salvata se c'è, altrimenti ridisegno
 // ---------------------------------------------------------------------------
 static void clearPauseOverlay() {
+  if (lyRestoreScreen())
+    return;
   gfx->fillScreen(COL_BG);
   drawCurrentPage();
 }
@@ -346,40 +250,24 @@ static bool touchInit() {
   ts.begin();
   ts.setRotation(0);
   ts.read();
+  touchInputBegin();
   touchReady = true;
   return true;
 }
 
 // ---------------------------------------------------------------------------
-// MAP COORDINATE
+// GESTI
 // ---------------------------------------------------------------------------
-static inline void mapTouch(int16_t &x, int16_t &y) {
-  x = ts.points[0].y;
-  y = 480 - ts.points[0].x;
-}
+constexpr int16_t SWIPE_MIN_PX = 80;    // corsa orizzontale minima
+constexpr uint32_t SWIPE_MAX_MS = 700;  // oltre: trascinamento, non swipe
+constexpr int16_t TAP_MAX_PX = 20;      // corsa massima di un tap
+
+static TouchEv touchDown = {0, 0, 0, TE_UP};
 
 // ---------------------------------------------------------------------------
-// LOOP TOUCH
+// TAP (rilascio): menu o apertura menu
 // ---------------------------------------------------------------------------
-static void touchLoop() {
-  if (!touchReady)
-    return;
-  ts.read();
-
-  bool nowDown = (ts.touches > 0);
-  bool prevDown = (lastTouches > 0);
-  lastTouches = ts.touches;
-
-  if (!nowDown || prevDown)
-    return;
-
-  uint32_t now = millis();
-  if (now - lastTouchMs < 200)
-    return;
-  lastTouchMs = now;
-
-  int16_t x, y;
-  mapTouch(x, y);
+static void touchTap(int16_t x, int16_t y) {
 
   // =========================================================================
   // MENU APERTO
@@ -387,28 +275,27 @@ static void touchLoop() {
   if (menuActive) {
 
     // FRECCIA SINISTRA
-    if (x >= ARROW_L_X && x <= ARROW_L_X + ARROW_SZ && y >= ARROW_Y &&
-        y <= ARROW_Y + ARROW_SZ) {
+    if (wgHit(menuW[MW_ARROW_L], x, y)) {
       if (menuPage > 0) {
         menuPage--;
-        drawMenuGrid();
+        syncMenuUi();
+        wgRender(menuUi);
       }
       return;
     }
 
     // FRECCIA DESTRA
-    if (x >= ARROW_R_X && x <= ARROW_R_X + ARROW_SZ && y >= ARROW_Y &&
-        y <= ARROW_Y + ARROW_SZ) {
+    if (wgHit(menuW[MW_ARROW_R], x, y)) {
       if (menuPage < totalMenuPages - 1) {
         menuPage++;
-        drawMenuGrid();
+        syncMenuUi();
+        wgRender(menuUi);
       }
       return;
     }
 
     // ANNULLA
-    if (x >= BTN_CANCEL_X && x <= BTN_CANCEL_X + ACT_BTN_W && y >= ACT_BTN_Y &&
-        y <= ACT_BTN_Y + ACT_BTN_H) {
+    if (wgHit(menuW[MW_CANCEL], x, y)) {
       menuActive = false;
       touchPaused = false;
       clearPauseOverlay();
@@ -416,11 +303,8 @@ static void touchLoop() {
     }
 
     // CONFERMA
-    if (x >= BTN_OK_X && x <= BTN_OK_X + ACT_BTN_W && y >= ACT_BTN_Y &&
-        y <= ACT_BTN_Y + ACT_BTN_H) {
-      prefs.begin("app", false);
-      prefs.putUInt("pages_mask", pagesMaskFromArray());
-      prefs.end();
+    if (wgHit(menuW[MW_OK], x, y)) {
+      nvSave(NV_MASK, NV_MASK + 1);
 
       menuActive = false;
       touchPaused = false;
@@ -429,14 +313,12 @@ static void touchLoop() {
     }
 
     // TOGGLE PAGINE
-    for (uint8_t s = 0; s < visibleCount; s++) {
-      if (x >= slotX[s] && x <= slotX[s] + M_BTN_W && y >= slotY[s] &&
-          y <= slotY[s] + M_BTN_H) {
-
+    for (uint8_t s = 0; s < ITEMS_PER_PAGE; s++) {
+      if (wgHit(menuW[MW_BTN0 + s], x, y)) {
         int8_t idx = slotIdx[s];
         g_show[idx] = !g_show[idx];
-        drawPageBtn(s, idx, slotX[s], slotY[s], g_show[idx]);
-        updateMenuCounter();
+        syncMenuUi(); // bottone + contatore
+        wgRender(menuUi);
         return;
       }
     }
@@ -451,3 +333,32 @@ static void touchLoop() {
   menuActive = true;
   drawPauseOverlay();
 }
+
+// ---------------------------------------------------------------------------
+// LOOP TOUCH: consuma la coda eventi del task touch; il gesto si decide al
+// rilascio (swipe orizzontale → pagina adiacente, tocco fermo → tap)
+// ---------------------------------------------------------------------------
+static void touchLoop() {
+  if (!touchReady)
+    return;
+  static bool wakeOnly = false; // gesto che ha acceso lo schermo di notte
+  TouchEv e;
+  while (touchPop(e)) {
+    if (e.type == TE_DOWN) {
+      touchDown = e;
+      wakeOnly = nmTouch();
+      continue;
+    }
+    if (e.type != TE_UP || wakeOnly)
+      continue;
+
+    const int16_t dx = e.x - touchDown.x;
+    const int16_t dy = e.y - touchDown.y;
+    if (!menuActive && abs(dx) >= SWIPE_MIN_PX && abs(dx) > 2 * abs(dy) &&
+        e.ms - touchDown.ms <= SWIPE_MAX_MS) {
+      swipeToPage(dx < 0 ? 1 : -1); // verso sinistra → successiva
+    } else if (abs(dx) <= TAP_MAX_PX && abs(dy) <= TAP_MAX_PX) {
+      touchTap(touchDown.x, touchDown.y);
+    }
+  }
+}
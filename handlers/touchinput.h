@@ -0,0 +1,189 @@
+/*
+===============================================================================
+   SQUARED — TOUCH INPUT (GT911 a interrupt + coda eventi)
+   Descrizione: un task dedicato legge il GT911 solo quando serve (interrupt
+                su TOUCH_INT, oppure polling adattivo se il pin non è
+                collegato) e trasforma i campioni in eventi DOWN / MOVE / UP
+                con timestamp, messi in una coda senza lock letta dal loop.
+                Il debounce usa i timestamp dei campioni: un distacco più
+                breve di TOUCH_BOUNCE_MS non genera UP + DOWN.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • touchInputBegin()     dopo ts.begin(): ISR (se TOUCH_INT ≥ 0) e task
+   • touchPop(ev)          loop: prossimo evento, false se la coda è vuota
+
+   Letture I²C:
+     TOUCH_INT ≥ 0   una per report del GT911 (solo col dito sul vetro),
+                     più una ogni TOUCH_SAFETY_MS a vuoto
+     TOUCH_INT = -1  TOUCH_POLL_IDLE_MS a riposo, TOUCH_POLL_DOWN_MS col
+                     dito appoggiato
+
+   TouchTracker non tocca l'hardware: riceve (ms, tocchi, x, y) e produce
+   gli eventi, quindi si prova su host con tracce registrate.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <TAMC_GT911.h>
+#include <atomic>
+
+#define TOUCH_SDA 19
+#define TOUCH_SCL 45
+#define TOUCH_INT -1 // GPIO dell'INT del GT911 se collegato
+#define TOUCH_RST -1
+
+#define TOUCH_WIDTH 480
+#define TOUCH_HEIGHT 480
+
+static constexpr uint32_t TOUCH_BOUNCE_MS = 40;     // distacco minimo per un UP
+static constexpr int16_t TOUCH_MOVE_PX = 3;          // spostamento minimo per MOVE
+static constexpr uint32_t TOUCH_POLL_IDLE_MS = 40;
+static constexpr uint32_t TOUCH_POLL_DOWN_MS = 10;
+static constexpr uint32_t TOUCH_SAFETY_MS = 250;
+
+// ============================================================================
+// EVENTI + CODA SPSC
+// ============================================================================
+enum TouchType : uint8_t { TE_DOWN, TE_MOVE, TE_UP };
+
+struct TouchEv {
+  uint32_t ms; // millis() del campione
+  int16_t x, y;
+  TouchType type;
+};
+
+static constexpr uint8_t TOUCH_QUEUE = 32; // potenza di due
+
+// Un solo producer (task touch) e un solo consumer (loop)
+struct TouchQueue {
+  TouchEv ev[TOUCH_QUEUE];
+  std::atomic<uint8_t> head{0};
+  std::atomic<uint8_t> tail{0};
+  uint16_t dropped = 0;
+
+  bool push(const TouchEv &e) {
+    const uint8_t h = head.load(std::memory_order_relaxed);
+    if ((uint8_t)(h - tail.load(std::memory_order_acquire)) >= TOUCH_QUEUE) {
+      dropped++;
+      return false;
+    }
+    ev[h & (TOUCH_QUEUE - 1)] = e;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  bool pop(TouchEv &e) {
+    const uint8_t t = tail.load(std::memory_order_relaxed);
+    if (t == head.load(std::memory_order_acquire))
+      return false;
+    e = ev[t & (TOUCH_QUEUE - 1)];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+};
+
+// ============================================================================
+// CAMPIONI → EVENTI
+// ============================================================================
+struct TouchTracker {
+  TouchQueue *q;
+  bool down = false;
+  bool lifting = false; // dito sollevato, UP in attesa del debounce
+  uint32_t liftMs = 0;
+  int16_t x = 0, y = 0;
+
+  explicit TouchTracker(TouchQueue *queue) : q(queue) {}
+
+  // UP in sospeso: il task deve ricampionare entro TOUCH_BOUNCE_MS
+  bool pending() const { return lifting; }
+
+  void feed(uint32_t ms, uint8_t touches, int16_t nx, int16_t ny) {
+    if (!touches) {
+      if (!down)
+        return;
+      if (!lifting) {
+        lifting = true;
+        liftMs = ms;
+      } else if (ms - liftMs >= TOUCH_BOUNCE_MS) {
+        down = lifting = false;
+        q->push({liftMs, x, y, TE_UP});
+      }
+      return;
+    }
+
+    if (lifting && ms - liftMs >= TOUCH_BOUNCE_MS) { // tocco nuovo
+      down = lifting = false;
+      q->push({liftMs, x, y, TE_UP});
+    }
+
+    if (!down) {
+      down = true;
+      x = nx;
+      y = ny;
+      q->push({ms, x, y, TE_DOWN});
+      return;
+    }
+
+    lifting = false; // rimbalzo: stesso tocco
+    if (abs(nx - x) >= TOUCH_MOVE_PX || abs(ny - y) >= TOUCH_MOVE_PX) {
+      x = nx;
+      y = ny;
+      q->push({ms, x, y, TE_MOVE});
+    }
+  }
+};
+
+// ============================================================================
+// DRIVER
+// ============================================================================
+static TAMC_GT911 ts(TOUCH_SDA, TOUCH_SCL, TOUCH_INT, TOUCH_RST, TOUCH_WIDTH,
+                     TOUCH_HEIGHT);
+
+static TouchQueue touch_q;
+static TouchTracker touch_trk(&touch_q);
+static TaskHandle_t touch_task = nullptr;
+static std::atomic<uint32_t> touch_reads{0}; // letture I²C (diagnostica)
+
+static void IRAM_ATTR touchIsr() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(touch_task, &woken);
+  if (woken)
+    portYIELD_FROM_ISR();
+}
+
+static void touchTask(void *) {
+  for (;;) {
+    // UP in sospeso: con l'INT un ritocco sveglia prima il task; in polling
+    // si continua a campionare fitto, altrimenti il campione dopo il
+    // distacco arriva sempre a TOUCH_BOUNCE_MS e ogni rimbalzo è un tocco
+    uint32_t wait;
+    if (TOUCH_INT >= 0)
+      wait = touch_trk.pending() ? TOUCH_BOUNCE_MS : TOUCH_SAFETY_MS;
+    else
+      wait = touch_trk.down ? TOUCH_POLL_DOWN_MS : TOUCH_POLL_IDLE_MS;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(wait));
+
+    ts.read();
+    touch_reads.fetch_add(1, std::memory_order_relaxed);
+    // pannello ruotato: x ← y del GT911, y ← 480 − x
+    touch_trk.feed(millis(), ts.touches, ts.points[0].y,
+                   480 - ts.points[0].x);
+  }
+}
+
+static void touchInputBegin() {
+  xTaskCreatePinnedToCore(touchTask, "touch", 3072, nullptr, 2, &touch_task,
+                          0);
+  if (TOUCH_INT >= 0) {
+    pinMode(TOUCH_INT, INPUT);
+    attachInterrupt(TOUCH_INT, touchIsr, FALLING);
+  }
+}
+
+static inline bool touchPop(TouchEv &e) { return touch_q.pop(e); }
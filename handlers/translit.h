@@ -0,0 +1,207 @@
+/*
+===============================================================================
+   SQUARED — TRASLITTERAZIONE UTF-8 → ASCII (Header-only)
+   Descrizione: decoder UTF-8 a tabella (lunghezza dal byte iniziale,
+                controllo continuazioni, overlong e surrogati) e
+                traslitterazione in ASCII stampabile per il font del
+                pannello: Latin-1, Latin Extended-A, punteggiatura
+                tipografica. Spazi compattati nello stesso passaggio.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • tlToAscii(in, n, out, cap)   → lunghezza scritta (NUL incluso in cap)
+   • tlInPlace(buf)               stessa cosa sul buffer stesso
+
+   Regole:
+     - ogni code point diventa 0–3 caratteri ASCII ('?' se sconosciuto,
+       '?' anche per ogni byte di una sequenza non valida)
+     - spazi, tab, a capo, controlli e spazi Unicode → uno spazio solo,
+       niente spazi in testa o in coda
+     - l'uscita non è mai più lunga dell'ingresso (sequenze da 2 byte →
+       max 2 caratteri, da 3 byte → max 3): out == in è ammesso
+
+   Da usare una volta sola quando il dato entra (fetch, WebUI, NVS): i
+   render ricevono testo già pulito.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Lunghezza sequenza dal byte iniziale (indice c >> 3); 0 = non valido
+// ---------------------------------------------------------------------------
+static const uint8_t TL_SEQ_LEN[32] PROGMEM = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, // 00–7F
+    0, 0, 0, 0, 0, 0, 0, 0,                         // 80–BF continuazione
+    2, 2, 2, 2,                                     // C0–DF
+    3, 3,                                           // E0–EF
+    4,                                              // F0–F7
+    0};                                             // F8–FF
+
+// Primo code point ammesso per lunghezza (scarta le forme overlong)
+static const uint32_t TL_SEQ_MIN[5] = {0, 0, 0x80, 0x800, 0x10000};
+
+// ---------------------------------------------------------------------------
+// Tabelle di traslitterazione ("" = scarta, " " = spazio)
+// ---------------------------------------------------------------------------
+// U+00A0–U+00FF
+static const char TL_LATIN1[96][3] PROGMEM = {
+    " ", "!", "c", "L", "*", "Y", "|", "S",     // A0 nbsp ¡ ¢ £ ¤ ¥ ¦ §
+    "\"", "c", "a", "\"", "-", "", "R", "-",    // A8 ¨ © ª « ¬ shy ® ¯
+    "", "+-", "2", "3", "'", "u", "P", ".",     // B0 ° ± ² ³ ´ µ ¶ ·
+    ",", "1", "o", "\"", "?", "?", "?", "?",    // B8 ¸ ¹ º » ¼ ½ ¾ ¿
+    "A", "A", "A", "A", "A", "A", "AE", "C",    // C0 À Á Â Ã Ä Å Æ Ç
+    "E", "E", "E", "E", "I", "I", "I", "I",     // C8 È É Ê Ë Ì Í Î Ï
+    "D", "N", "O", "O", "O", "O", "O", "x",     // D0 Ð Ñ Ò Ó Ô Õ Ö ×
+    "O", "U", "U", "U", "U", "Y", "Th", "ss",   // D8 Ø Ù Ú Û Ü Ý Þ ß
+    "a", "a", "a", "a", "a", "a", "ae", "c",    // E0 à á â ã ä å æ ç
+    "e", "e", "e", "e", "i", "i", "i", "i",     // E8 è é ê ë ì í î ï
+    "d", "n", "o", "o", "o", "o", "o", "/",     // F0 ð ñ ò ó ô õ ö ÷
+    "o", "u", "u", "u", "u", "y", "th", "y"};   // F8 ø ù ú û ü ý þ ÿ
+
+// U+0100–U+017F
+static const char TL_LATIN_EXT_A[128][3] PROGMEM = {
+    "A", "a", "A", "a", "A", "a", "C", "c",     // 100 Ā ā Ă ă Ą ą Ć ć
+    "C", "c", "C", "c", "C", "c", "D", "d",     // 108 Ĉ ĉ Ċ ċ Č č Ď ď
+    "D", "d", "E", "e", "E", "e", "E", "e",     // 110 Đ đ Ē ē Ĕ ĕ Ė ė
+    "E", "e", "E", "e", "G", "g", "G", "g",     // 118 Ę ę Ě ě Ĝ ĝ Ğ ğ
+    "G", "g", "G", "g", "H", "h", "H", "h",     // 120 Ġ ġ Ģ ģ Ĥ ĥ Ħ ħ
+    "I", "i", "I", "i", "I", "i", "I", "i",     // 128 Ĩ ĩ Ī ī Ĭ ĭ Į į
+    "I", "i", "IJ", "ij", "J", "j", "K", "k",   // 130 İ ı Ĳ ĳ Ĵ ĵ Ķ ķ
+    "k", "L", "l", "L", "l", "L", "l", "L",     // 138 ĸ Ĺ ĺ Ļ ļ Ľ ľ Ŀ
+    "l", "L", "l", "N", "n", "N", "n", "N",     // 140 ŀ Ł ł Ń ń Ņ ņ Ň
+    "n", "'n", "N", "n", "O", "o", "O", "o",    // 148 ň ŉ Ŋ ŋ Ō ō Ŏ ŏ
+    "O", "o", "OE", "oe", "R", "r", "R", "r",   // 150 Ő ő Œ œ Ŕ ŕ Ŗ ŗ
+    "R", "r", "S", "s", "S", "s", "S", "s",     // 158 Ř ř Ś ś Ŝ ŝ Ş ş
+    "S", "s", "T", "t", "T", "t", "T", "t",     // 160 Š š Ţ ţ Ť ť Ŧ ŧ
+    "U", "u", "U", "u", "U", "u", "U", "u",     // 168 Ũ ũ Ū ū Ŭ ŭ Ů ů
+    "U", "u", "U", "u", "W", "w", "Y", "y",     // 170 Ű ű Ų ų Ŵ ŵ Ŷ ŷ
+    "Y", "Z", "z", "Z", "z", "Z", "z", "s"};    // 178 Ÿ Ź ź Ż ż Ž ž ſ
+
+// U+2000–U+203F
+static const char TL_PUNCT[64][4] PROGMEM = {
+    " ", " ", " ", " ", " ", " ", " ", " ",         // 2000 spazi tipografici
+    " ", " ", " ", "", "", "", "", "",             // 2008 … zero-width, LRM/RLM
+    "-", "-", "-", "-", "-", "-", "||", "_",       // 2010 trattini ‖ ‗
+    "'", "'", "'", "'", "\"", "\"", "\"", "\"",    // 2018 ‘ ’ ‚ ‛ “ ” „ ‟
+    "+", "++", "*", "*", ".", "..", "...", "-",    // 2020 † ‡ • ‣ ․ ‥ … ‧
+    " ", " ", "", "", "", "", "", " ",             // 2028 LS PS bidi, nnbsp
+    "%", "%", "'", "\"", "'''", "`", "``", "```",  // 2030 ‰ ‱ ′ ″ ‴ ‵ ‶ ‷
+    "^", "<", ">", "*", "!!", "?!", "-", "_"};     // 2038 ‸ ‹ › ※ ‼ ‽ ‾ ‿
+
+// ---------------------------------------------------------------------------
+// Code point → ASCII (NUL-terminato in dst[4]); "" = scarta
+// ---------------------------------------------------------------------------
+static inline void tlMap(uint32_t cp, char dst[4]) {
+  dst[0] = dst[1] = dst[2] = dst[3] = 0;
+
+  if (cp < 0x80) {
+    dst[0] = (cp < 0x20 || cp == 0x7F) ? ' ' : (char)cp;
+    return;
+  }
+  if (cp < 0xA0) { // controlli C1
+    dst[0] = ' ';
+    return;
+  }
+  if (cp < 0x100) {
+    memcpy_P(dst, TL_LATIN1[cp - 0xA0], 3);
+    return;
+  }
+  if (cp < 0x180) {
+    memcpy_P(dst, TL_LATIN_EXT_A[cp - 0x100], 3);
+    return;
+  }
+  if (cp >= 0x2000 && cp < 0x2040) {
+    memcpy_P(dst, TL_PUNCT[cp - 0x2000], 4);
+    return;
+  }
+
+  const char *r;
+  switch (cp) {
+  case 0x02C6: r = "^"; break;   // ˆ
+  case 0x02DC: r = "~"; break;   // ˜
+  case 0x205F: r = " "; break;   // spazio matematico
+  case 0x2060: r = ""; break;    // word joiner
+  case 0x20AC: r = "EUR"; break; // €
+  case 0x2122: r = "TM"; break;  // ™
+  case 0x2190: r = "<-"; break;  // ←
+  case 0x2192: r = "->"; break;  // →
+  case 0x2212: r = "-"; break;   // −
+  case 0x3000: r = " "; break;   // spazio ideografico
+  case 0xFEFF: r = ""; break;    // BOM
+  default: r = "?";
+  }
+  strcpy(dst, r);
+}
+
+// ---------------------------------------------------------------------------
+// Decoder + traslitterazione + compattazione spazi in un solo passaggio
+// ---------------------------------------------------------------------------
+static size_t tlToAscii(const char *in, size_t n, char *out, size_t cap) {
+  if (!cap)
+    return 0;
+
+  const uint8_t *p = (const uint8_t *)in;
+  const uint8_t *e = p + n;
+  size_t o = 0;
+  bool space = false; // spazio in sospeso (scritto solo prima di testo)
+  char m[4];
+
+  while (p < e && o + 1 < cap) {
+    const uint8_t c = *p;
+    uint32_t cp;
+
+    if (c < 0x80) {
+      cp = c;
+      p++;
+    } else {
+      const uint8_t len = pgm_read_byte(&TL_SEQ_LEN[c >> 3]);
+      bool ok = len > 1 && p + len <= e;
+
+      cp = c & (0x7F >> len);
+      for (uint8_t k = 1; ok && k < len; k++) {
+        ok = (p[k] & 0xC0) == 0x80;
+        cp = (cp << 6) | (p[k] & 0x3F);
+      }
+      ok = ok && cp >= TL_SEQ_MIN[len] && cp <= 0x10FFFF &&
+           (cp < 0xD800 || cp > 0xDFFF);
+
+      if (!ok) {
+        cp = '?';
+        p++;
+      } else {
+        p += len;
+      }
+    }
+
+    tlMap(cp, m);
+    for (uint8_t k = 0; m[k]; k++) {
+      if (m[k] == ' ') {
+        space = (o > 0);
+        continue;
+      }
+      if (space) {
+        if (o + 2 >= cap)
+          break;
+        out[o++] = ' ';
+        space = false;
+      }
+      if (o + 1 >= cap)
+        break;
+      out[o++] = m[k];
+    }
+  }
+
+  out[o] = 0;
+  return o;
+}
+
+static inline size_t tlInPlace(char *buf) {
+  return tlToAscii(buf, strlen(buf), buf, strlen(buf) + 1);
+}
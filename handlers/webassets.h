@@ -0,0 +1,375 @@
+/*
+===============================================================================
+   SQUARED — WEB ASSETS (generato da tools/gen_webassets.py, non modificare)
+   Descrizione: CSS/JS della WebUI compressi gzip in PROGMEM, con URL che
+                contengono l'hash del contenuto (cache immutable).
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+struct WebAsset {
+  const char *url;
+  const char *type;
+  const uint8_t *gz;
+  uint32_t len;
+};
+
+// /a/home.c17355ea.css → 941 byte, gzip 538 byte
+#define ASSET_HOME_CSS "/a/home.c17355ea.css"
+static const uint8_t ASSET_HOME_CSS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x65, 0x52, 0xc1, 0x8e, 0xdb, 0x20,
+    0x14, 0xfc, 0x15, 0x4b, 0xab, 0x4a, 0x59, 0x29, 0x58, 0xe0, 0x4d, 0x36, 0x09, 0xbe, 0xed, 0xa1,
+    0xb7, 0x9e, 0xfa, 0x05, 0xcf, 0xe6, 0xe1, 0xa0, 0x60, 0x40, 0x80, 0x37, 0x49, 0x2d, 0xff, 0x7b,
+    0x9f, 0x63, 0x25, 0xcd, 0x6e, 0x65, 0x09, 0xc9, 0x8f, 0x61, 0x66, 0x18, 0xa6, 0xf1, 0xea, 0x3a,
+    0xf6, 0x10, 0x3b, 0xe3, 0x24, 0xaf, 0xb5, 0x77, 0x99, 0x69, 0xe8, 0x8d, 0xbd, 0x4a, 0x06, 0x21,
+    0x58, 0x64, 0xe9, 0x9a, 0x32, 0xf6, 0xeb, 0x0f, 0x6b, 0xdc, 0xe9, 0x17, 0xb4, 0xbf, 0x6f, 0xbf,
+    0x3f, 0x09, 0xb7, 0x5e, 0x76, 0xd8, 0x60, 0xd6, 0x09, 0x5c, 0x62, 0x09, 0xa3, 0xd1, 0x75, 0x03,
+    0xed, 0xa9, 0x8b, 0x7e, 0x70, 0x4a, 0xbe, 0xf0, 0x2d, 0xdf, 0x8b, 0x4d, 0xdd, 0x7a, 0xeb, 0xa3,
+    0x7c, 0xd1, 0x5b, 0xfa, 0x76, 0x53, 0x0f, 0xc6, 0x91, 0xe0, 0x85, 0x9d, 0x8d, 0xca, 0x47, 0xb9,
+    0xab, 0x78, 0xb8, 0xd4, 0x77, 0x03, 0x05, 0x0c, 0xd9, 0xd7, 0x01, 0x94, 0x32, 0xae, 0x93, 0x62,
+    0x1f, 0x2e, 0x85, 0xd8, 0xd0, 0xf2, 0x56, 0x85, 0xcb, 0x74, 0x14, 0x0f, 0xa3, 0x05, 0x2f, 0x68,
+    0x6f, 0xb1, 0x9b, 0xcc, 0x1f, 0x94, 0xa2, 0xdc, 0x44, 0xec, 0x1f, 0x52, 0x5a, 0xe9, 0x0d, 0x9f,
+    0xc2, 0x1d, 0x3f, 0x53, 0xf0, 0x27, 0x74, 0x79, 0x78, 0x02, 0xab, 0xbd, 0x52, 0x5a, 0x4f, 0x65,
+    0x0b, 0x51, 0x8d, 0x5f, 0xec, 0x37, 0x82, 0x57, 0xbc, 0x6e, 0x7c, 0x54, 0x18, 0x59, 0x04, 0x65,
+    0x86, 0x24, 0xc5, 0x3b, 0xe9, 0x2e, 0x23, 0x29, 0x88, 0x36, 0x79, 0x6b, 0x54, 0xf1, 0x22, 0x0e,
+    0x42, 0xbf, 0x35, 0xff, 0x9c, 0xcf, 0x8a, 0x37, 0xe8, 0xe2, 0x80, 0x65, 0x1f, 0xa4, 0xa8, 0x6e,
+    0x47, 0x2f, 0x2c, 0x1d, 0x41, 0xf9, 0x33, 0xdd, 0x42, 0xd0, 0xdd, 0x8b, 0x8a, 0x60, 0x45, 0xec,
+    0x1a, 0x58, 0xf1, 0xf5, 0xfc, 0x95, 0x9b, 0xed, 0xeb, 0x54, 0x5a, 0x68, 0xd0, 0x8e, 0x4f, 0x96,
+    0x77, 0xfb, 0x27, 0xcf, 0x87, 0x16, 0x2a, 0xad, 0xeb, 0x8c, 0x97, 0xcc, 0x72, 0xa4, 0xf4, 0xb5,
+    0x8f, 0xbd, 0x1c, 0x42, 0xc0, 0xd8, 0x42, 0xc2, 0xda, 0x62, 0xce, 0xe4, 0x39, 0x05, 0x68, 0x67,
+    0x3b, 0x25, 0x7f, 0xc7, 0x7e, 0x2a, 0x3f, 0xc1, 0x0e, 0xf8, 0xcc, 0x79, 0xd8, 0x12, 0xe7, 0x04,
+    0xe3, 0x97, 0xd8, 0x16, 0x56, 0x85, 0xad, 0x8f, 0x90, 0x8d, 0x77, 0xd2, 0x79, 0x87, 0x4b, 0x78,
+    0x67, 0x34, 0xdd, 0x31, 0xcb, 0x2d, 0xe7, 0x13, 0xc8, 0xa3, 0xff, 0xc4, 0x38, 0x7e, 0x07, 0x53,
+    0x72, 0x18, 0xa9, 0x2b, 0x38, 0x95, 0xa7, 0xcf, 0x7b, 0xfe, 0xd5, 0x9c, 0xff, 0x3c, 0x28, 0x9a,
+    0x51, 0x99, 0x14, 0x2c, 0x5c, 0xa5, 0x71, 0x33, 0x8a, 0x35, 0xd6, 0xb7, 0xa7, 0xba, 0xa7, 0x88,
+    0x96, 0x3e, 0x88, 0x37, 0xca, 0x64, 0x2a, 0x7b, 0x1f, 0x71, 0x7c, 0xce, 0xee, 0x7d, 0x9e, 0x76,
+    0xd1, 0x28, 0x16, 0xa0, 0xc3, 0xf4, 0xa0, 0x99, 0x47, 0xf5, 0x6d, 0x4e, 0x5d, 0xa4, 0x49, 0x46,
+    0x46, 0xb7, 0x19, 0x7a, 0x97, 0x64, 0xc4, 0x80, 0x90, 0x57, 0x73, 0xa5, 0x98, 0x36, 0xd6, 0xae,
+    0x49, 0x85, 0x8a, 0xb7, 0x12, 0x5b, 0x92, 0x58, 0x0b, 0x1d, 0x5f, 0x5f, 0xeb, 0x0e, 0x82, 0xfc,
+    0xf6, 0x4c, 0xfb, 0x59, 0xa9, 0x3d, 0x9e, 0x1e, 0x12, 0xda, 0x22, 0x55, 0x8d, 0x16, 0x76, 0x8e,
+    0x04, 0x9f, 0x97, 0x1a, 0xac, 0xe9, 0x1c, 0x33, 0xa4, 0x99, 0x64, 0x8b, 0x8e, 0xc2, 0x7e, 0x50,
+    0x7d, 0xab, 0xd9, 0x8d, 0xab, 0x48, 0x3d, 0x58, 0x7a, 0xce, 0x99, 0xa4, 0x81, 0x64, 0xa8, 0x47,
+    0x9c, 0xff, 0xb8, 0xab, 0x5a, 0xd4, 0x59, 0x56, 0xd5, 0xd7, 0xb3, 0xbb, 0xea, 0xbf, 0xf7, 0x9e,
+    0xfe, 0x02, 0xb6, 0x67, 0x17, 0xed, 0xad, 0x03, 0x00, 0x00,
+};
+
+// /a/home.a7f3d331.js → 5144 byte, gzip 2167 byte
+#define ASSET_HOME_JS "/a/home.a7f3d331.js"
+static const uint8_t ASSET_HOME_JS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x58, 0x5d, 0x72, 0x1b, 0xb9,
+    0x11, 0x7e, 0xe7, 0x29, 0xe0, 0x97, 0x9d, 0x99, 0x88, 0x1a, 0xcb, 0x5e, 0xaf, 0xe3, 0x88, 0xab,
+    0xdd, 0xa2, 0x68, 0xa9, 0xa4, 0xac, 0x4c, 0x7a, 0x4d, 0x2a, 0x72, 0x4a, 0xa5, 0x72, 0x81, 0x18,
+    0x70, 0x88, 0x70, 0x88, 0x61, 0x66, 0x30, 0xd4, 0x72, 0xbd, 0xaa, 0xda, 0x43, 0xe4, 0x00, 0x39,
+    0x42, 0xce, 0x90, 0xdc, 0x24, 0x27, 0xc9, 0xd7, 0xc0, 0xfc, 0x4a, 0x74, 0x36, 0x79, 0x11, 0x81,
+    0x46, 0x77, 0xa3, 0xd1, 0xfd, 0xf5, 0xcf, 0x48, 0xa4, 0x3a, 0x37, 0x6c, 0xf6, 0x71, 0xc6, 0x4e,
+    0xd8, 0xe7, 0x9e, 0x32, 0xc7, 0xf8, 0x9b, 0x1b, 0x6e, 0x8a, 0xfc, 0x98, 0x79, 0x53, 0x2c, 0x52,
+    0xb6, 0xe1, 0x5a, 0xcb, 0x24, 0x49, 0xbd, 0x3e, 0x96, 0xb1, 0x04, 0xfd, 0x3d, 0x8f, 0x95, 0xe6,
+    0x4c, 0xa4, 0x59, 0x26, 0xb5, 0x91, 0x38, 0xd0, 0xf2, 0x27, 0x43, 0x07, 0x59, 0x9a, 0xe7, 0x6a,
+    0x9d, 0x32, 0xc1, 0xd7, 0x73, 0x05, 0x89, 0x5e, 0xb1, 0x31, 0x6a, 0x4d, 0x32, 0x43, 0x21, 0x64,
+    0x9e, 0xb2, 0x88, 0x83, 0x7b, 0x29, 0xf9, 0x06, 0xa4, 0x0b, 0xfc, 0xb0, 0x44, 0xcd, 0x65, 0x46,
+    0xba, 0x33, 0x48, 0xd2, 0x9d, 0x32, 0xd6, 0x3c, 0x91, 0xec, 0x46, 0x1d, 0x9e, 0x2b, 0x28, 0xa0,
+    0x2b, 0xf3, 0xea, 0x4e, 0xba, 0xca, 0x99, 0x10, 0x71, 0xa3, 0x58, 0xa4, 0xec, 0xd5, 0x5b, 0x99,
+    0x81, 0xb2, 0xe6, 0xc4, 0x9e, 0xa8, 0x2d, 0x1d, 0xbf, 0xa5, 0xe3, 0xd2, 0x3e, 0x62, 0xba, 0x97,
+    0xdc, 0x2c, 0x2d, 0xdb, 0x3b, 0x69, 0x24, 0x5d, 0x37, 0x37, 0x02, 0xbb, 0x53, 0x65, 0x44, 0xaa,
+    0x34, 0xf6, 0x7f, 0x4d, 0x23, 0xec, 0xcf, 0x33, 0x9e, 0x4b, 0x16, 0xc9, 0x84, 0xc5, 0x2a, 0xcd,
+    0x34, 0xbd, 0x40, 0xcb, 0x7b, 0xba, 0x7f, 0x8c, 0x1f, 0xb0, 0x09, 0x9e, 0x60, 0x33, 0x82, 0x85,
+    0x3a, 0xe2, 0x19, 0x3d, 0x91, 0x2d, 0x39, 0xbd, 0x25, 0x5d, 0x4b, 0x36, 0xc4, 0x13, 0xe0, 0x3c,
+    0x6d, 0xc8, 0xac, 0xd4, 0x58, 0x57, 0xa5, 0xb9, 0x39, 0x54, 0x86, 0x1e, 0x92, 0xa5, 0x0b, 0x95,
+    0x48, 0xe7, 0x25, 0xac, 0x3a, 0x8e, 0x15, 0xca, 0xec, 0x48, 0xaf, 0x32, 0xe6, 0x5f, 0x7f, 0xc7,
+    0x3e, 0xe1, 0x3a, 0xc6, 0xfe, 0x4a, 0xe9, 0xb8, 0xe0, 0x4c, 0xc1, 0xc9, 0xd9, 0x82, 0x0b, 0xa1,
+    0xe0, 0xbd, 0xde, 0x42, 0x71, 0xf2, 0xf5, 0x9f, 0x78, 0x52, 0x18, 0xce, 0xe6, 0x30, 0x18, 0x02,
+    0x4a, 0xe4, 0x1d, 0xbb, 0xd8, 0xe5, 0x68, 0x4a, 0x64, 0x92, 0xdc, 0x5a, 0x9b, 0x2f, 0xcb, 0x65,
+    0x52, 0x45, 0x87, 0xa2, 0x89, 0x30, 0x42, 0xa3, 0x88, 0xac, 0x70, 0x5a, 0x68, 0x13, 0xa5, 0xf7,
+    0x1a, 0x8e, 0xd3, 0x0b, 0x15, 0x17, 0x19, 0xb7, 0xbe, 0xd3, 0xa9, 0x96, 0xd6, 0x01, 0x79, 0x5e,
+    0xd0, 0x59, 0xc5, 0xc5, 0x8d, 0x51, 0x5b, 0xf2, 0x50, 0x2e, 0xb1, 0xd2, 0x31, 0xe9, 0x18, 0x6e,
+    0x32, 0xc5, 0xd4, 0x7a, 0x83, 0x57, 0xf3, 0x9f, 0x55, 0xaa, 0x49, 0x3e, 0x5d, 0x2c, 0x12, 0xa5,
+    0x1d, 0x6e, 0xdc, 0x83, 0x49, 0x25, 0xcb, 0x78, 0x1c, 0xab, 0x42, 0xc7, 0x6a, 0x0e, 0xaf, 0x78,
+    0xbd, 0x87, 0x7e, 0x4f, 0xea, 0x0e, 0xfa, 0xc0, 0x8d, 0x38, 0xb8, 0x6d, 0x83, 0xbd, 0x51, 0x61,
+    0x83, 0x6a, 0xb7, 0x0d, 0xf0, 0xc6, 0xf8, 0x61, 0xf9, 0x3d, 0xa2, 0xb9, 0x6c, 0x83, 0xee, 0xda,
+    0x2e, 0x1a, 0xc4, 0x9d, 0x67, 0x52, 0xda, 0x75, 0x83, 0x37, 0x8b, 0x33, 0x96, 0x2b, 0x42, 0x5d,
+    0x17, 0x6e, 0x32, 0x6f, 0xa3, 0x8d, 0xb3, 0x45, 0x96, 0xae, 0x5b, 0x78, 0xb3, 0xbf, 0x0d, 0xe2,
+    0xae, 0xf0, 0xc3, 0x88, 0xaf, 0x83, 0xb6, 0x1b, 0xb7, 0xfa, 0x22, 0xde, 0x7e, 0x2c, 0x00, 0x13,
+    0x78, 0x88, 0x81, 0x8b, 0xbd, 0xe5, 0xbb, 0xdf, 0xc0, 0xdb, 0x6f, 0xa1, 0x6d, 0x6a, 0x94, 0x58,
+    0xed, 0xd8, 0x38, 0xa5, 0xa4, 0x6c, 0x23, 0xce, 0xba, 0xb2, 0xdc, 0x77, 0xe0, 0xb6, 0x6b, 0xc0,
+    0x76, 0x7d, 0x69, 0x57, 0x85, 0x75, 0x6c, 0x85, 0xb2, 0x53, 0xca, 0x07, 0x61, 0x7d, 0x2e, 0x76,
+    0x35, 0xce, 0x00, 0x2e, 0xb2, 0xcc, 0xda, 0xc4, 0xae, 0x3f, 0x5c, 0x75, 0x91, 0x46, 0xbe, 0x2b,
+    0x83, 0x51, 0x93, 0x5b, 0x28, 0x73, 0xd8, 0x92, 0x51, 0x03, 0xa5, 0xbc, 0x85, 0xb2, 0x94, 0x71,
+    0x61, 0xc8, 0x97, 0xed, 0xd3, 0x36, 0xc4, 0x26, 0x1b, 0xa9, 0x59, 0xb5, 0x7f, 0x0c, 0x2f, 0xbc,
+    0xb2, 0xd0, 0x99, 0xe4, 0x62, 0xc9, 0xe7, 0x16, 0x55, 0xbd, 0x87, 0x41, 0x4f, 0xd8, 0x1a, 0x37,
+    0x1e, 0xbe, 0x3b, 0x9b, 0xb6, 0xaa, 0xdc, 0xcd, 0xd9, 0x70, 0x76, 0x71, 0xf6, 0xa1, 0x55, 0x12,
+    0x86, 0x97, 0xb4, 0x1b, 0x66, 0x94, 0x65, 0x6c, 0x74, 0x35, 0x19, 0xfd, 0x40, 0xd7, 0x65, 0x69,
+    0x92, 0xc6, 0x36, 0xd1, 0x4f, 0x2f, 0xc7, 0xc3, 0x0f, 0x7f, 0x6e, 0xd1, 0xd8, 0x29, 0xf2, 0xc7,
+    0x16, 0x81, 0xde, 0x68, 0x78, 0xb5, 0x2f, 0xff, 0x4e, 0x67, 0xa3, 0x4e, 0xd4, 0x7f, 0x9c, 0xbc,
+    0xdd, 0x5b, 0x65, 0xd8, 0xe5, 0xf8, 0x7c, 0x62, 0x93, 0x74, 0x61, 0xb5, 0x4d, 0xae, 0xc7, 0xb3,
+    0x76, 0x4a, 0x82, 0xe3, 0xfc, 0x63, 0x95, 0xf4, 0x14, 0xc1, 0xd9, 0xcb, 0x57, 0xd8, 0xe2, 0x2f,
+    0xd6, 0xd3, 0xeb, 0xb1, 0x35, 0x0a, 0x2a, 0x15, 0x4b, 0x0a, 0x41, 0xe7, 0xe3, 0xb3, 0x9b, 0x69,
+    0x8d, 0xa2, 0xde, 0xc5, 0x70, 0x1f, 0x68, 0xa6, 0xb3, 0xb3, 0xab, 0xab, 0x21, 0xbd, 0x79, 0x0a,
+    0x9a, 0x5c, 0x73, 0x36, 0x4d, 0x13, 0x9e, 0x59, 0xf1, 0xc9, 0xec, 0x6c, 0xda, 0x2e, 0x5f, 0x6c,
+    0x74, 0xf1, 0x61, 0x32, 0x9e, 0x10, 0x6d, 0xb4, 0xcc, 0x52, 0x9d, 0xe6, 0xad, 0x94, 0x6d, 0x5c,
+    0xd9, 0xe0, 0xbd, 0x74, 0xa6, 0xca, 0x5a, 0xbe, 0x1c, 0x25, 0xa9, 0x58, 0xb5, 0x1d, 0x69, 0xfd,
+    0xb7, 0x63, 0x25, 0xfd, 0x91, 0x13, 0xbf, 0xe8, 0xbe, 0xa7, 0x49, 0xf3, 0xbf, 0xba, 0xef, 0xfc,
+    0xe3, 0x5e, 0xd7, 0x4d, 0x0b, 0x9d, 0xa8, 0x78, 0x69, 0xfe, 0x7f, 0xbf, 0x91, 0xbf, 0xd8, 0x74,
+    0x47, 0xde, 0x6b, 0x79, 0xad, 0x93, 0x86, 0x7b, 0x3d, 0x47, 0xb0, 0x4c, 0xa4, 0x61, 0x62, 0x11,
+    0x03, 0x92, 0xba, 0x48, 0x12, 0xb7, 0x07, 0x4e, 0xab, 0xed, 0xa2, 0xd0, 0x48, 0x04, 0x14, 0x4a,
+    0x99, 0xf8, 0x86, 0xc7, 0x48, 0xda, 0x24, 0xef, 0x33, 0x83, 0x42, 0x17, 0xc0, 0xe5, 0x0e, 0xd3,
+    0x12, 0xdc, 0x51, 0x2a, 0x8a, 0x35, 0x2a, 0x62, 0x28, 0x80, 0x7b, 0x23, 0xcf, 0x12, 0x49, 0x3b,
+    0x12, 0x09, 0x06, 0x3d, 0xb5, 0x60, 0x3e, 0xe4, 0x02, 0x26, 0x43, 0x91, 0xf0, 0x3c, 0x1f, 0xf3,
+    0x35, 0xc9, 0x80, 0xe4, 0xce, 0x48, 0x1d, 0x7b, 0x76, 0x72, 0x82, 0xac, 0x89, 0xe4, 0x02, 0x69,
+    0x14, 0x11, 0x2b, 0x51, 0x91, 0xa7, 0x86, 0xea, 0xec, 0x89, 0xbd, 0x72, 0xd0, 0xcb, 0xa4, 0x29,
+    0x32, 0x18, 0x33, 0x80, 0xf1, 0xb5, 0x69, 0x82, 0x67, 0x91, 0x9f, 0xf0, 0xb9, 0x4c, 0x1a, 0x9b,
+    0x04, 0x44, 0x60, 0xb2, 0x17, 0xa9, 0x2d, 0x1e, 0xef, 0x11, 0x8b, 0x07, 0x4b, 0x44, 0xc8, 0x37,
+    0xc8, 0xdc, 0x68, 0xb4, 0x54, 0x49, 0xe4, 0xb7, 0x18, 0xac, 0xb8, 0xad, 0x42, 0xa4, 0x26, 0xa8,
+    0x6f, 0x12, 0x9d, 0x9b, 0x56, 0x5b, 0x7f, 0xc3, 0xa9, 0xf0, 0xf7, 0xd9, 0x4a, 0xee, 0xfa, 0x0c,
+    0x25, 0xa5, 0x90, 0xcd, 0xa5, 0x51, 0xf7, 0xd2, 0xd5, 0x96, 0xae, 0x8c, 0x9e, 0x5c, 0x39, 0xa7,
+    0x43, 0xcf, 0xaa, 0x60, 0x07, 0xcc, 0x3b, 0xf6, 0x82, 0x27, 0x6c, 0x8f, 0xdc, 0x39, 0xc3, 0xe3,
+    0xc7, 0x69, 0x24, 0x7d, 0x8f, 0x79, 0x10, 0xf1, 0xed, 0xbd, 0xec, 0x04, 0x1e, 0xf3, 0x3c, 0xf6,
+    0xcb, 0x2f, 0xac, 0xda, 0xdb, 0xa0, 0xb1, 0xef, 0x99, 0x77, 0xe8, 0xb1, 0xe3, 0xd2, 0x3a, 0x52,
+    0xee, 0x8c, 0xee, 0xde, 0x10, 0x74, 0x5e, 0x16, 0x15, 0x99, 0x9f, 0xd3, 0x4b, 0x28, 0x1e, 0x79,
+    0xa5, 0x2a, 0x60, 0xa5, 0x1b, 0x1c, 0x18, 0xdc, 0xd9, 0xb7, 0xec, 0x0f, 0x47, 0xf5, 0x41, 0x4e,
+    0x2f, 0x60, 0xb9, 0xd7, 0x1c, 0x7e, 0xf3, 0xea, 0xa8, 0x39, 0x7e, 0x87, 0x44, 0x0c, 0x33, 0x24,
+    0x40, 0x84, 0xb3, 0xe7, 0xec, 0x35, 0x4e, 0x88, 0x7f, 0x8d, 0x3c, 0x6a, 0x24, 0x5e, 0xfc, 0xfe,
+    0xe5, 0x9b, 0x2f, 0xcb, 0x7c, 0xfd, 0xfa, 0xa8, 0x94, 0x5a, 0x7a, 0x75, 0x58, 0x1e, 0xf1, 0xbc,
+    0x79, 0xfd, 0xaa, 0x62, 0x8a, 0xbc, 0xce, 0xbb, 0x50, 0xa2, 0xa9, 0x11, 0xf8, 0x36, 0x5c, 0xa9,
+    0x6e, 0x62, 0x35, 0x4f, 0xa3, 0x1d, 0xd5, 0x61, 0xa4, 0x00, 0x2d, 0x6f, 0xbd, 0xcd, 0x27, 0x72,
+    0x2d, 0xf8, 0xee, 0x40, 0x4e, 0x35, 0xa0, 0x2f, 0xd1, 0x3a, 0x7c, 0xef, 0x39, 0xdf, 0xa8, 0xe7,
+    0x6e, 0x16, 0x41, 0xcc, 0x3e, 0xf7, 0xd6, 0xd2, 0x2c, 0x6d, 0xd7, 0x7c, 0x3f, 0x9c, 0x8d, 0x2e,
+    0x90, 0x9e, 0xe8, 0xe4, 0x91, 0xcc, 0xd0, 0x14, 0x3e, 0xdb, 0xbe, 0x42, 0x78, 0x3d, 0x9c, 0xed,
+    0x36, 0xd2, 0x03, 0x0f, 0x3c, 0x9e, 0x28, 0xc1, 0xc9, 0x94, 0xe7, 0x7f, 0xc9, 0x53, 0xed, 0x31,
+    0x94, 0x2b, 0xba, 0xef, 0x98, 0xfd, 0x71, 0x3a, 0x19, 0x87, 0xb9, 0xc9, 0xd0, 0x40, 0xd4, 0x62,
+    0xe7, 0x13, 0x31, 0xe8, 0x3d, 0x04, 0x21, 0xca, 0x89, 0xf6, 0x33, 0x76, 0xf2, 0x1d, 0xcb, 0x42,
+    0x12, 0xf1, 0x83, 0x92, 0x26, 0x88, 0xf6, 0xb9, 0x4c, 0x56, 0x31, 0x60, 0x49, 0xca, 0x23, 0x3f,
+    0x18, 0xb0, 0x87, 0x6e, 0x24, 0x11, 0x69, 0x98, 0xe3, 0x37, 0x2f, 0xa5, 0xa1, 0x1a, 0xa3, 0xf5,
+    0x2d, 0x04, 0x43, 0x6a, 0xad, 0x77, 0x84, 0x18, 0x10, 0x42, 0x65, 0xea, 0xae, 0x04, 0x16, 0xdb,
+    0x99, 0xba, 0x4c, 0x96, 0xd4, 0x62, 0x23, 0x7c, 0xe7, 0x26, 0xa4, 0xf9, 0xa2, 0x22, 0xe1, 0x81,
+    0x2d, 0xd0, 0x07, 0x15, 0x39, 0x27, 0x13, 0x29, 0x2d, 0x67, 0xa1, 0x1b, 0x9d, 0x70, 0x82, 0xe4,
+    0x41, 0xe9, 0x98, 0x85, 0x34, 0xdc, 0xa0, 0x4a, 0xdd, 0x42, 0x13, 0x2d, 0xed, 0x4d, 0xe5, 0xba,
+    0xc5, 0x45, 0x23, 0x55, 0xdf, 0xc1, 0xd2, 0xd8, 0xcd, 0xa7, 0x3c, 0x68, 0x1d, 0xbb, 0xe1, 0xaa,
+    0x66, 0x70, 0xdb, 0x36, 0x03, 0xcd, 0x57, 0xfd, 0x0e, 0x4e, 0x4c, 0x88, 0xd0, 0x65, 0x18, 0x1d,
+    0xec, 0x19, 0x50, 0xf3, 0xe2, 0xe8, 0xe5, 0x2b, 0x07, 0x9a, 0x1f, 0x4e, 0xbd, 0x96, 0x28, 0xcd,
+    0x64, 0x7d, 0xd6, 0xe2, 0x27, 0x82, 0x03, 0xd7, 0xe9, 0x9a, 0x18, 0xf1, 0xe8, 0x4e, 0x2e, 0xe5,
+    0xf5, 0xbb, 0x37, 0xcd, 0xbb, 0xed, 0x0c, 0x57, 0x1f, 0xc4, 0xdd, 0xd2, 0x10, 0x67, 0x2a, 0x3a,
+    0xb4, 0x1c, 0xa4, 0xaf, 0x7c, 0x7d, 0x1e, 0x2e, 0xd2, 0xec, 0x0c, 0x53, 0x83, 0xbf, 0x89, 0x6d,
+    0xac, 0x4b, 0xd9, 0xa4, 0x94, 0xad, 0x6a, 0x94, 0x27, 0x96, 0xab, 0xc6, 0xd5, 0x55, 0xa5, 0x53,
+    0x7a, 0x53, 0x18, 0x57, 0xe3, 0x0c, 0xd0, 0x07, 0x2a, 0xf8, 0xa4, 0x58, 0xcd, 0xd3, 0x9f, 0x3c,
+    0x22, 0xda, 0x8d, 0xa4, 0x10, 0x6e, 0xe2, 0x90, 0xf0, 0x2d, 0xf0, 0x17, 0x13, 0x8a, 0x8e, 0x89,
+    0x17, 0x78, 0xc1, 0x8d, 0x55, 0xb6, 0x80, 0xc3, 0x26, 0x4c, 0x2d, 0x05, 0xb5, 0x49, 0xe7, 0xc9,
+    0xe2, 0x09, 0x85, 0x6c, 0xc8, 0xf1, 0x31, 0x51, 0x16, 0xb7, 0xf1, 0xad, 0x53, 0x62, 0xc3, 0xeb,
+    0x96, 0x41, 0xd9, 0x0a, 0xb0, 0xa3, 0xd9, 0xec, 0x59, 0x55, 0x63, 0xf6, 0xe8, 0x59, 0xe3, 0x0b,
+    0xa1, 0x54, 0x34, 0xb3, 0xcc, 0xe4, 0x7d, 0xca, 0x4f, 0x8a, 0xb7, 0x93, 0xb7, 0x85, 0x2d, 0xee,
+    0x88, 0x26, 0x94, 0x09, 0x54, 0xee, 0x3a, 0xd4, 0x78, 0x4f, 0xc4, 0x36, 0xb5, 0xfb, 0xb6, 0x4d,
+    0xc4, 0x68, 0x86, 0x2e, 0x4d, 0x8c, 0xc2, 0x72, 0x7a, 0x46, 0x17, 0x5a, 0x6f, 0x1a, 0x53, 0x01,
+    0x91, 0x2d, 0x99, 0x54, 0x9e, 0x02, 0x7f, 0x5d, 0x46, 0x32, 0xf3, 0x9f, 0xff, 0x18, 0x39, 0x53,
+    0xeb, 0xa3, 0x48, 0xe6, 0xa2, 0x56, 0x8c, 0x11, 0x3c, 0xc4, 0xf7, 0x89, 0x90, 0x4f, 0xb5, 0xe2,
+    0x88, 0x34, 0x36, 0x1c, 0xd5, 0xab, 0x29, 0x2b, 0x69, 0x14, 0xae, 0x95, 0x60, 0x6e, 0x0f, 0x5d,
+    0x13, 0xae, 0x64, 0x41, 0x21, 0xd9, 0xea, 0x80, 0xba, 0x84, 0xdb, 0xf1, 0x02, 0xf5, 0x2a, 0xa3,
+    0xa6, 0xc0, 0xfe, 0xfd, 0xeb, 0xdf, 0x4a, 0xcb, 0x5a, 0x07, 0xa8, 0x52, 0x5e, 0x50, 0x2b, 0xa6,
+    0xb9, 0x3f, 0xc4, 0xe4, 0x13, 0x9b, 0x65, 0xa3, 0x9b, 0x88, 0xa4, 0x9c, 0x7e, 0x6f, 0x8f, 0xee,
+    0x6c, 0xb7, 0xc2, 0xe0, 0x1d, 0xe6, 0xa8, 0x6d, 0xd2, 0x3f, 0xea, 0xb3, 0xaf, 0x83, 0x1a, 0xba,
+    0x00, 0xd3, 0x77, 0xbd, 0x4a, 0x10, 0x4c, 0xf4, 0xa9, 0x72, 0x8f, 0xf9, 0xc8, 0x48, 0x5f, 0x52,
+    0x2d, 0xc8, 0x0c, 0xfb, 0x1d, 0x32, 0x0f, 0xe5, 0x3a, 0x34, 0xe9, 0x55, 0x4a, 0xf3, 0xfb, 0xd4,
+    0x16, 0x41, 0xbf, 0x2a, 0x3d, 0x41, 0xfd, 0x6c, 0x08, 0x14, 0xeb, 0x35, 0x66, 0x33, 0xd7, 0x20,
+    0x97, 0xbc, 0xbe, 0x65, 0x49, 0x68, 0x75, 0xb7, 0x2c, 0x43, 0xcd, 0xa9, 0x12, 0x2c, 0x6d, 0xa5,
+    0x91, 0xad, 0xa7, 0x60, 0xf0, 0x69, 0xbd, 0x01, 0x3b, 0xfb, 0x06, 0xa2, 0x3e, 0x05, 0xc4, 0xb6,
+    0x06, 0xc4, 0xa2, 0x95, 0xc2, 0xee, 0x53, 0xc5, 0x95, 0x86, 0x85, 0x7d, 0x10, 0xbe, 0x55, 0xfa,
+    0x36, 0x1c, 0xb4, 0x6a, 0x1d, 0x90, 0xe1, 0xee, 0xc0, 0x3e, 0xa1, 0x39, 0xa0, 0xb0, 0xf5, 0xdb,
+    0x01, 0xac, 0x0e, 0x50, 0x58, 0x1c, 0x1d, 0x8b, 0x36, 0xb9, 0xfc, 0x54, 0x71, 0x67, 0x54, 0x16,
+    0x3e, 0x55, 0x3d, 0x76, 0x8f, 0xd9, 0x8b, 0xda, 0xec, 0x55, 0x63, 0x36, 0x3e, 0x71, 0x02, 0x37,
+    0xc8, 0x69, 0x10, 0x8f, 0xd0, 0xc9, 0x10, 0x66, 0x9f, 0xf6, 0x0a, 0xfb, 0x17, 0x03, 0xfc, 0x7c,
+    0x7b, 0xc2, 0xde, 0xe0, 0xf7, 0xe0, 0xa0, 0x6a, 0xf9, 0xcf, 0x70, 0xdb, 0xad, 0x27, 0x22, 0x72,
+    0xbb, 0xad, 0x75, 0xda, 0xbb, 0x63, 0x5f, 0x7d, 0xc5, 0x9e, 0xd0, 0x8d, 0x77, 0x17, 0xd0, 0xa7,
+    0x39, 0x3e, 0x7c, 0x0a, 0x69, 0xcd, 0x5e, 0x59, 0x53, 0x1f, 0x0b, 0x3f, 0x25, 0x42, 0x32, 0xcc,
+    0xe4, 0x26, 0xe1, 0xc0, 0x8c, 0x37, 0xa3, 0xec, 0x66, 0x16, 0x78, 0xfa, 0xe0, 0x80, 0x1a, 0x98,
+    0xb5, 0x02, 0x0d, 0x7a, 0xf5, 0xa4, 0x1a, 0xd0, 0x77, 0xb2, 0x67, 0x87, 0x19, 0xcf, 0x45, 0x52,
+    0xdb, 0x28, 0x3f, 0xf6, 0xc5, 0x8a, 0x40, 0x52, 0xcd, 0x4d, 0xb1, 0x34, 0xe5, 0x0c, 0x7a, 0xba,
+    0xbb, 0x8c, 0x7c, 0x6a, 0xc4, 0x5e, 0x50, 0x5d, 0x7f, 0xa3, 0xcc, 0xd2, 0x07, 0xa5, 0x54, 0xa2,
+    0xa8, 0x28, 0x5a, 0x8e, 0xff, 0xa2, 0x00, 0xa5, 0x11, 0x0a, 0xba, 0x33, 0x29, 0x9a, 0x5b, 0xf9,
+    0x05, 0xd8, 0xe9, 0xc0, 0xae, 0x31, 0xd7, 0xe5, 0x1b, 0x9a, 0xc0, 0x5b, 0x10, 0x62, 0xdd, 0x48,
+    0x51, 0xec, 0x6d, 0xf2, 0x83, 0xde, 0x7b, 0x7c, 0xda, 0xab, 0x5c, 0x86, 0xa8, 0x7d, 0x3e, 0xba,
+    0x23, 0xb9, 0x9f, 0x9a, 0xfd, 0xf7, 0xf6, 0xef, 0x31, 0xe9, 0xe9, 0x4e, 0x23, 0x41, 0xbf, 0x45,
+    0xb3, 0xe0, 0xf7, 0x82, 0xbb, 0xa0, 0xe7, 0x94, 0xfb, 0xb7, 0xa8, 0x25, 0xf9, 0x5d, 0xf0, 0x68,
+    0x68, 0xb0, 0xa3, 0x7d, 0x3e, 0xa8, 0xa7, 0x04, 0x1a, 0x1f, 0x7a, 0xc8, 0x53, 0xb2, 0xcb, 0xf5,
+    0x80, 0xca, 0x6c, 0xde, 0x9e, 0xea, 0xf7, 0xba, 0x13, 0xde, 0x7b, 0xe4, 0x10, 0xbf, 0x9c, 0x33,
+    0x4a, 0xd3, 0x1f, 0x8f, 0x1b, 0x41, 0x58, 0x7e, 0x26, 0xbb, 0x32, 0xfd, 0xd0, 0x2b, 0x47, 0x18,
+    0xfa, 0xb0, 0xae, 0xfe, 0x31, 0xe4, 0x13, 0xad, 0xcf, 0xbe, 0xa1, 0x0a, 0x31, 0xf8, 0x0f, 0xaa,
+    0x9e, 0x14, 0xb1, 0x18, 0x14, 0x00, 0x00,
+};
+
+// /a/portal.d5c5d847.css → 1189 byte, gzip 552 byte
+#define ASSET_PORTAL_CSS "/a/portal.d5c5d847.css"
+static const uint8_t ASSET_PORTAL_CSS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x8d, 0x53, 0xed, 0x8e, 0xab, 0x20,
+    0x14, 0x7c, 0x15, 0x93, 0xe6, 0x26, 0x6d, 0xb2, 0x1a, 0xd0, 0xda, 0x2a, 0x3e, 0x0d, 0xf2, 0xa1,
+    0xdc, 0x55, 0x30, 0x80, 0x5b, 0xbb, 0xc6, 0x77, 0x5f, 0x50, 0xbb, 0xd5, 0xf6, 0xfe, 0xb8, 0xe1,
+    0x47, 0xd3, 0xf1, 0x30, 0x9c, 0x99, 0x73, 0xa6, 0x54, 0xf4, 0x3e, 0xb6, 0x58, 0x57, 0x42, 0x22,
+    0x50, 0x70, 0x25, 0x6d, 0xc8, 0x71, 0x2b, 0x9a, 0x3b, 0x32, 0x58, 0x9a, 0xd0, 0x30, 0x2d, 0x78,
+    0x51, 0x62, 0xf2, 0x59, 0x69, 0xd5, 0x4b, 0x8a, 0x0e, 0x20, 0x05, 0x19, 0x3c, 0x17, 0x44, 0x35,
+    0x4a, 0xa3, 0x03, 0x4f, 0xdd, 0xb9, 0x16, 0x54, 0x98, 0xae, 0xc1, 0x77, 0xc4, 0x1b, 0x36, 0x14,
+    0xb8, 0x11, 0x95, 0x0c, 0x85, 0x65, 0xad, 0x41, 0x84, 0x49, 0xcb, 0x74, 0xf1, 0xb7, 0x37, 0x56,
+    0xf0, 0x7b, 0x48, 0x1c, 0xbf, 0x43, 0x1e, 0x70, 0x2b, 0x64, 0x58, 0x33, 0x51, 0xd5, 0x16, 0x41,
+    0x00, 0xbe, 0xea, 0x29, 0x22, 0x58, 0xd3, 0x71, 0xf7, 0x5c, 0x09, 0x41, 0x0c, 0x8a, 0x52, 0x69,
+    0xca, 0x74, 0xa8, 0x31, 0x15, 0xbd, 0x41, 0x30, 0xeb, 0x86, 0xa2, 0xc3, 0x94, 0x0a, 0x59, 0xa1,
+    0x38, 0xee, 0x86, 0x20, 0x06, 0x0e, 0x29, 0xd5, 0x10, 0x9a, 0x1a, 0x53, 0x75, 0x43, 0x20, 0x80,
+    0x1e, 0x4e, 0x1c, 0x1c, 0xe8, 0xaa, 0xc4, 0x47, 0xf0, 0xe1, 0x4f, 0x74, 0x39, 0x15, 0x37, 0x41,
+    0x6d, 0xed, 0xdf, 0xfb, 0x53, 0xb4, 0x78, 0x08, 0x97, 0xbf, 0x49, 0xe6, 0x2a, 0xa7, 0x1a, 0xfe,
+    0x5a, 0x11, 0x80, 0xe0, 0xec, 0x28, 0x67, 0x43, 0x8c, 0xf8, 0x66, 0x08, 0x46, 0x67, 0xcd, 0xda,
+    0x5f, 0xdd, 0x9c, 0xf2, 0x33, 0x98, 0xba, 0x47, 0xbd, 0xab, 0x75, 0x37, 0xe0, 0xfe, 0x4a, 0x94,
+    0x6f, 0x6e, 0x10, 0x4e, 0x63, 0xce, 0xa7, 0x06, 0x97, 0xac, 0x19, 0x1f, 0x7e, 0x95, 0x8d, 0x22,
+    0x9f, 0xc5, 0xca, 0x01, 0xc1, 0x4c, 0xf2, 0xc2, 0x91, 0xa5, 0x1b, 0x92, 0x12, 0x94, 0xa9, 0x23,
+    0x11, 0xb2, 0xeb, 0xed, 0xb8, 0x11, 0xf2, 0xf0, 0x22, 0x77, 0x0c, 0x70, 0xb1, 0x62, 0xe7, 0xd7,
+    0x13, 0x42, 0xd0, 0x95, 0x18, 0xd5, 0x08, 0x1a, 0x1c, 0x12, 0x98, 0x64, 0x69, 0xba, 0x9f, 0xee,
+    0xd5, 0x19, 0x9e, 0xbd, 0x4c, 0x77, 0xf6, 0x55, 0x7c, 0xfb, 0x07, 0x56, 0x5e, 0x87, 0xec, 0x74,
+    0xfa, 0x1e, 0x97, 0xae, 0x10, 0x57, 0xa4, 0x37, 0xa3, 0xea, 0x6d, 0x23, 0x24, 0x43, 0x52, 0x49,
+    0xf6, 0x68, 0x66, 0x25, 0x4d, 0xcb, 0x2b, 0xe1, 0x7c, 0x3f, 0x2c, 0x7f, 0x7c, 0x63, 0xeb, 0xc7,
+    0x34, 0x9d, 0xca, 0xde, 0x5a, 0x25, 0x57, 0x7b, 0x43, 0xab, 0x3a, 0x04, 0x2f, 0x4e, 0xc4, 0x3f,
+    0x34, 0xcf, 0xb6, 0xf9, 0x69, 0xbf, 0x88, 0xce, 0xf3, 0xfc, 0xa9, 0x7a, 0xe9, 0xe3, 0x29, 0xd4,
+    0x37, 0x87, 0x75, 0x58, 0xf9, 0x5a, 0xb7, 0x8b, 0x47, 0x98, 0xa4, 0x94, 0x55, 0x1f, 0xeb, 0x5c,
+    0xfd, 0xef, 0x15, 0x9f, 0xc1, 0xe9, 0x61, 0x04, 0x84, 0x70, 0xd1, 0x7b, 0x5b, 0xb6, 0xf5, 0x02,
+    0xc0, 0x9b, 0xfe, 0x82, 0xf4, 0xda, 0xb8, 0xe2, 0x4e, 0x09, 0xbf, 0xdc, 0xab, 0x02, 0x84, 0x89,
+    0x15, 0x5f, 0x6c, 0xb4, 0xda, 0xc5, 0x89, 0x2b, 0xdd, 0x22, 0x43, 0x70, 0xc3, 0x8e, 0x51, 0x9e,
+    0x9d, 0xa6, 0xc8, 0x8a, 0x6e, 0x27, 0xf1, 0x75, 0xf6, 0x9b, 0xd1, 0xe7, 0x18, 0x27, 0x6e, 0xf4,
+    0x91, 0xbb, 0xb1, 0x4d, 0x69, 0xab, 0xa4, 0x32, 0x1d, 0x26, 0xec, 0x65, 0x33, 0x23, 0xe7, 0xef,
+    0x7f, 0x04, 0xe9, 0xb2, 0x0d, 0x92, 0x37, 0x32, 0x8e, 0xdf, 0x82, 0x34, 0xc3, 0x97, 0xf7, 0x20,
+    0x6d, 0xd2, 0x33, 0xc7, 0xcf, 0xb2, 0xc1, 0x86, 0x73, 0xf8, 0xd7, 0x7c, 0x4f, 0x75, 0xbc, 0xcd,
+    0xd3, 0xbc, 0x85, 0xdb, 0x40, 0x25, 0xef, 0x81, 0xf2, 0x6d, 0x07, 0x2f, 0xa9, 0x02, 0xd3, 0x0f,
+    0xae, 0x90, 0x30, 0xec, 0xa5, 0x04, 0x00, 0x00,
+};
+
+// /a/settings.31024bfd.css → 2368 byte, gzip 963 byte
+#define ASSET_SETTINGS_CSS "/a/settings.31024bfd.css"
+static const uint8_t ASSET_SETTINGS_CSS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xa5, 0x56, 0x4d, 0xaf, 0xab, 0x36,
+    0x10, 0xfd, 0x2b, 0x91, 0xa2, 0xea, 0x25, 0x52, 0x40, 0x98, 0x10, 0xc2, 0x87, 0xba, 0x68, 0x17,
+    0xdd, 0x75, 0xd5, 0x65, 0xd5, 0x85, 0xc1, 0x36, 0xf1, 0x0b, 0xd8, 0x96, 0x6d, 0x94, 0xe4, 0x46,
+    0xf9, 0xef, 0x1d, 0x13, 0xe0, 0x02, 0xc9, 0x7d, 0xad, 0xf4, 0x14, 0x09, 0x64, 0x9b, 0x19, 0x9f,
+    0x39, 0x73, 0x66, 0x26, 0x85, 0x24, 0xb7, 0x7b, 0x83, 0x75, 0xc5, 0x45, 0x16, 0xe4, 0x4c, 0x0a,
+    0xeb, 0x31, 0xdc, 0xf0, 0xfa, 0x96, 0x79, 0x58, 0xa9, 0x9a, 0x7a, 0xe6, 0x66, 0x2c, 0x6d, 0x76,
+    0xbf, 0xd7, 0x5c, 0x9c, 0xff, 0xc4, 0xe5, 0x5f, 0xdd, 0xf2, 0x0f, 0xf8, 0x6e, 0xf7, 0x3c, 0xf1,
+    0x5a, 0xbe, 0x33, 0x58, 0x18, 0xcf, 0x50, 0xcd, 0x59, 0x5e, 0xe0, 0xf2, 0x5c, 0x69, 0xd9, 0x0a,
+    0x92, 0xad, 0x83, 0x43, 0x90, 0xa0, 0x28, 0x2f, 0x65, 0x2d, 0x75, 0xb6, 0x66, 0x07, 0xf8, 0x1d,
+    0x1f, 0x27, 0x8a, 0x09, 0xd5, 0x77, 0x25, 0x0d, 0xb7, 0x5c, 0x8a, 0xcc, 0x58, 0x5e, 0x9e, 0x6f,
+    0xb9, 0x95, 0x0a, 0xee, 0xff, 0xf0, 0xb8, 0x20, 0xf4, 0x9a, 0xa1, 0x60, 0xea, 0x08, 0xae, 0xa6,
+    0x58, 0x7b, 0x95, 0xc6, 0x84, 0x53, 0x61, 0x37, 0x68, 0x7f, 0x20, 0xb4, 0xda, 0xad, 0x83, 0x02,
+    0x05, 0x61, 0x00, 0xef, 0x23, 0x3a, 0xec, 0x8f, 0xdb, 0x5c, 0x61, 0x42, 0xb8, 0xa8, 0x32, 0x14,
+    0xa9, 0xeb, 0x0a, 0x25, 0xee, 0x11, 0xa8, 0x6b, 0x5e, 0x48, 0x0d, 0x37, 0x7a, 0x85, 0xb4, 0x56,
+    0x36, 0x19, 0x82, 0x6d, 0x23, 0x6b, 0x4e, 0x56, 0xeb, 0x30, 0x08, 0x8f, 0x11, 0xee, 0x11, 0xad,
+    0x4e, 0x68, 0xc1, 0x83, 0xe1, 0x1f, 0x34, 0x43, 0xfe, 0xfe, 0xa0, 0x69, 0x33, 0x06, 0xc1, 0x08,
+    0x8b, 0x82, 0xc1, 0x44, 0x0d, 0x16, 0x21, 0x38, 0x0d, 0x56, 0x53, 0x3b, 0x3f, 0x99, 0x58, 0x15,
+    0xfb, 0xe2, 0xc8, 0xd8, 0xa3, 0xc1, 0x5c, 0x80, 0xc5, 0xd5, 0xbb, 0x70, 0x62, 0x4f, 0x59, 0x1a,
+    0x3b, 0x74, 0xc3, 0x9d, 0x2b, 0xdc, 0x5a, 0xb9, 0x08, 0x01, 0xce, 0x57, 0x09, 0x3c, 0x1e, 0x3e,
+    0xae, 0xa9, 0xb6, 0xf7, 0x3e, 0x12, 0xc7, 0x43, 0x6b, 0xb2, 0x2e, 0xb8, 0xd1, 0xc0, 0x7d, 0x8b,
+    0x00, 0xc7, 0x0c, 0x43, 0x07, 0xbd, 0xbf, 0xa1, 0xfb, 0xa2, 0x73, 0x1b, 0x8d, 0x1e, 0x7d, 0x79,
+    0xbe, 0x4f, 0x33, 0x06, 0x7c, 0x62, 0x54, 0xf4, 0x8c, 0x4d, 0xa9, 0x42, 0x2c, 0x81, 0x20, 0xc6,
+    0x78, 0x22, 0xb6, 0x2f, 0xa3, 0xc1, 0xc7, 0x05, 0x6b, 0x31, 0xf3, 0x02, 0x3e, 0x8e, 0x2e, 0x83,
+    0x2f, 0x5e, 0x68, 0x18, 0xb3, 0x4f, 0x2f, 0xc0, 0x65, 0x58, 0xc4, 0x0f, 0xbf, 0xc4, 0x9a, 0xcc,
+    0xec, 0x9f, 0x79, 0x7d, 0x87, 0x22, 0x45, 0xce, 0x7e, 0x41, 0x43, 0x3c, 0xa5, 0x21, 0x76, 0x01,
+    0xc6, 0x7d, 0x94, 0xcb, 0xd0, 0xc1, 0xf2, 0xea, 0x99, 0x13, 0x26, 0xf2, 0x02, 0x84, 0x77, 0xbb,
+    0xa1, 0xfb, 0x56, 0x57, 0x05, 0xde, 0x04, 0x3b, 0xf7, 0xf3, 0xa3, 0xc3, 0xf6, 0x09, 0x69, 0x75,
+    0xda, 0x8f, 0x82, 0x80, 0xe4, 0x26, 0x33, 0x6a, 0xd1, 0xab, 0x26, 0x9e, 0x46, 0xca, 0x27, 0xd4,
+    0x94, 0x83, 0x61, 0xd4, 0xe9, 0xa2, 0x4b, 0xd4, 0x17, 0xd2, 0xc0, 0x29, 0x66, 0x20, 0x0d, 0xbf,
+    0xd2, 0x9c, 0x78, 0xe1, 0x9d, 0x70, 0xa3, 0x6a, 0x7c, 0xcb, 0xdc, 0x32, 0xef, 0xf6, 0xa0, 0xc4,
+    0x60, 0xc7, 0x52, 0x0f, 0x0c, 0xda, 0x46, 0x98, 0x4c, 0x53, 0x45, 0xb1, 0xdd, 0x38, 0xb9, 0x78,
+    0x8c, 0xdb, 0x5d, 0xc3, 0x05, 0x68, 0x6a, 0x13, 0x3a, 0x35, 0xed, 0x10, 0xd3, 0xdb, 0x6d, 0x5e,
+    0x61, 0xd5, 0xc5, 0xdc, 0xbb, 0x55, 0xb8, 0xa2, 0xe6, 0x27, 0x5c, 0xa3, 0x64, 0xee, 0x1a, 0xa8,
+    0x78, 0xd4, 0xb8, 0xa0, 0xb5, 0xcf, 0x38, 0xad, 0xc9, 0xe8, 0xb9, 0xa8, 0x65, 0x79, 0x1e, 0x38,
+    0x4f, 0xba, 0xd0, 0xa3, 0xaf, 0x23, 0x07, 0x3d, 0x25, 0x10, 0x39, 0x17, 0xaa, 0xb5, 0x7f, 0xdb,
+    0x9b, 0xa2, 0xbf, 0x7e, 0xb3, 0xf4, 0x6a, 0xbf, 0xfd, 0xb3, 0x9b, 0x6e, 0x29, 0x6c, 0xcc, 0x05,
+    0xf2, 0xbd, 0xd8, 0x16, 0x6d, 0x53, 0x50, 0xbd, 0xd8, 0x24, 0x10, 0x8b, 0xe5, 0x0d, 0xf5, 0x00,
+    0x07, 0xae, 0xe1, 0xd0, 0xd0, 0x9a, 0x96, 0x76, 0xe7, 0xdc, 0x62, 0x4d, 0xf1, 0xfd, 0x59, 0x77,
+    0x28, 0x08, 0x7e, 0x19, 0x05, 0x93, 0x2e, 0xba, 0xc4, 0xb4, 0xb6, 0x5e, 0x05, 0xb8, 0x47, 0xfb,
+    0xe4, 0x70, 0x98, 0x37, 0xb9, 0x23, 0xc8, 0x35, 0x99, 0x37, 0xb9, 0xa7, 0xce, 0xf8, 0x87, 0xbb,
+    0x60, 0xec, 0x3e, 0x33, 0x22, 0xd2, 0x10, 0x98, 0x00, 0xc9, 0x9c, 0xce, 0x23, 0x7b, 0xac, 0xa6,
+    0xd7, 0x1c, 0xd7, 0xbc, 0x12, 0x1e, 0x87, 0xcc, 0x98, 0xac, 0x84, 0x5e, 0x47, 0xf5, 0xc0, 0xf8,
+    0x88, 0x78, 0xd1, 0xd7, 0x66, 0x0d, 0x6d, 0x1f, 0xa6, 0x51, 0xfa, 0x2e, 0x94, 0xe9, 0xd5, 0x2e,
+    0x07, 0xaf, 0x11, 0x74, 0x60, 0x56, 0x1d, 0x9d, 0x3d, 0x4f, 0x5d, 0x43, 0x1a, 0x2a, 0xe0, 0xb1,
+    0xb6, 0xb2, 0xaa, 0x6a, 0xfa, 0x5b, 0x5d, 0x0f, 0xe2, 0x8e, 0x3f, 0xc5, 0x3d, 0x60, 0x8b, 0x87,
+    0x26, 0x34, 0x87, 0xe0, 0xe0, 0xcf, 0x1a, 0xc4, 0x14, 0xe7, 0x8c, 0xdf, 0x22, 0xda, 0xc7, 0x74,
+    0x20, 0x93, 0xc4, 0xa4, 0x64, 0x6c, 0xa6, 0x9f, 0xb0, 0x13, 0x50, 0xab, 0x0d, 0x9c, 0x2b, 0xc9,
+    0x1d, 0x41, 0x0f, 0x5f, 0x48, 0xd0, 0xf0, 0x09, 0x16, 0xf7, 0x1f, 0x16, 0x59, 0x1f, 0x8b, 0xe7,
+    0x46, 0x4d, 0xec, 0x8a, 0x83, 0x49, 0x30, 0x84, 0xd4, 0xe0, 0xc9, 0x38, 0x62, 0xfc, 0x4a, 0x49,
+    0x5e, 0x53, 0x66, 0x61, 0x0c, 0x68, 0x5e, 0x9d, 0xdc, 0xbb, 0x1f, 0x1d, 0xc1, 0x9b, 0xe9, 0xc6,
+    0xc2, 0x21, 0x56, 0xe7, 0x76, 0x9a, 0x8b, 0x30, 0x4c, 0x22, 0xfc, 0x26, 0x6b, 0xe0, 0x82, 0x68,
+    0xa9, 0xa0, 0xc0, 0x6a, 0xb8, 0x1d, 0x8a, 0xa6, 0xd5, 0x1b, 0x38, 0xdd, 0x8e, 0x78, 0xb8, 0x10,
+    0x30, 0x20, 0x7f, 0x3c, 0x27, 0xfe, 0x4b, 0x34, 0xdf, 0x5b, 0x98, 0xab, 0xec, 0x06, 0x95, 0x0d,
+    0x4b, 0x61, 0x33, 0xa3, 0x70, 0x49, 0xbd, 0x82, 0xda, 0x0b, 0xa5, 0x62, 0x2c, 0x62, 0xbf, 0xb0,
+    0xc2, 0x53, 0x9a, 0x83, 0xef, 0x5b, 0x3f, 0x5c, 0x32, 0x21, 0x05, 0x5d, 0xa4, 0x2f, 0x4d, 0xd3,
+    0x49, 0x8e, 0xd3, 0xbe, 0xc3, 0xbe, 0x68, 0xaa, 0x5b, 0x5f, 0x68, 0xc7, 0x59, 0x1c, 0xfc, 0xaf,
+    0x09, 0xfe, 0x6c, 0x9d, 0xee, 0x7d, 0xc4, 0x51, 0xb0, 0x1d, 0xf2, 0x85, 0x10, 0x7a, 0x49, 0xb2,
+    0x83, 0x6a, 0x28, 0xc4, 0x43, 0x3e, 0xc1, 0xbe, 0x07, 0x98, 0x0c, 0xdd, 0xff, 0x65, 0x12, 0x7e,
+    0x29, 0xb8, 0x09, 0x54, 0xab, 0xe1, 0xcf, 0x8c, 0x82, 0x76, 0x21, 0xec, 0x42, 0x87, 0xae, 0x8d,
+    0x78, 0x04, 0x20, 0x68, 0xdc, 0x49, 0xc5, 0x31, 0xf5, 0xf8, 0x17, 0x95, 0x8a, 0xb7, 0xf5, 0x40,
+    0x09, 0x00, 0x00,
+};
+
+// /a/settings.20d27a7f.js → 1335 byte, gzip 693 byte
+#define ASSET_SETTINGS_JS "/a/settings.20d27a7f.js"
+static const uint8_t ASSET_SETTINGS_JS_GZ[] PROGMEM = {
+    0x1f, 0x8b, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x85, 0x53, 0x4d, 0x6f, 0xdb, 0x30,
+    0x0c, 0xbd, 0xfb, 0x57, 0xb0, 0x3d, 0x54, 0x36, 0xd0, 0x2a, 0xf7, 0x18, 0xee, 0xd0, 0x75, 0x05,
+    0xb6, 0x61, 0x68, 0x0b, 0xb4, 0xb7, 0xa0, 0x07, 0xc5, 0xa6, 0x6d, 0x35, 0xb2, 0xe4, 0x49, 0x72,
+    0xd6, 0x20, 0xc8, 0x7f, 0x1f, 0x25, 0x25, 0xfd, 0xd8, 0xd6, 0xee, 0x60, 0x40, 0xa6, 0xf8, 0x1e,
+    0xf9, 0x1e, 0xa9, 0xc6, 0xd4, 0xd3, 0x80, 0xda, 0xf3, 0x0e, 0xfd, 0x95, 0xc2, 0x70, 0xfc, 0xbc,
+    0xf9, 0xd6, 0xe4, 0xcc, 0x9b, 0xae, 0x53, 0x78, 0xa1, 0x14, 0x2b, 0xb8, 0xd1, 0xb5, 0x92, 0xf5,
+    0x0a, 0x2a, 0x68, 0x27, 0x5d, 0x7b, 0x69, 0x34, 0xe4, 0x05, 0x6c, 0xb3, 0xda, 0x68, 0xe7, 0x61,
+    0x69, 0x9e, 0xd0, 0xd1, 0x5d, 0x73, 0xa0, 0xfa, 0x39, 0xa1, 0xdd, 0xdc, 0xa1, 0xc2, 0xda, 0x1b,
+    0x4b, 0x0c, 0x39, 0xe3, 0x9d, 0x95, 0xcd, 0xd9, 0x28, 0x3a, 0x4a, 0x94, 0x7a, 0x9c, 0xfc, 0xc2,
+    0x6f, 0x46, 0xac, 0xea, 0x1e, 0xeb, 0x15, 0xc1, 0x1f, 0x58, 0x51, 0x66, 0x0a, 0x3d, 0x08, 0xa5,
+    0x2e, 0x43, 0x0c, 0x1b, 0xe2, 0xf3, 0x76, 0xc2, 0x32, 0x8b, 0xec, 0xbc, 0x35, 0xf6, 0x4a, 0xd4,
+    0x7d, 0xbe, 0x84, 0xea, 0x1c, 0xb6, 0x20, 0x5b, 0xc8, 0x8f, 0x96, 0xbc, 0x4e, 0xb9, 0xc5, 0x5b,
+    0x5c, 0x2b, 0x94, 0xc3, 0x12, 0x76, 0xc5, 0x3b, 0xe0, 0x67, 0x1c, 0xe5, 0x1e, 0xbd, 0x20, 0x13,
+    0x62, 0x57, 0x66, 0xf9, 0xbf, 0x44, 0x12, 0xc7, 0xf0, 0xae, 0xc6, 0x9c, 0x85, 0xeb, 0x85, 0x88,
+    0xa8, 0xea, 0x78, 0xe6, 0xd0, 0x7b, 0xa9, 0x3b, 0x77, 0x1c, 0x85, 0x3d, 0xd3, 0x39, 0x2d, 0x46,
+    0xd7, 0x1b, 0xff, 0x8a, 0xd6, 0x10, 0xe7, 0x96, 0x6a, 0x12, 0x1e, 0xf2, 0x14, 0x42, 0x30, 0x6d,
+    0x2c, 0xc7, 0x31, 0xcd, 0xc3, 0x85, 0xf4, 0xa8, 0x18, 0xb9, 0x16, 0x03, 0x16, 0x40, 0x89, 0xc4,
+    0x1f, 0xdc, 0x31, 0x8b, 0x14, 0x7b, 0x20, 0x1e, 0xe4, 0xc1, 0x54, 0xa8, 0xaa, 0x0a, 0xd8, 0xc1,
+    0x59, 0x06, 0x9f, 0x28, 0x7e, 0xd0, 0x3b, 0xa7, 0xf3, 0x5a, 0xa8, 0x00, 0xdc, 0x65, 0x16, 0xfd,
+    0x64, 0x35, 0x98, 0x70, 0x7e, 0x6e, 0x51, 0x1b, 0x2f, 0x6b, 0xcc, 0x3d, 0x3e, 0xf9, 0x50, 0x35,
+    0xce, 0xe4, 0x03, 0xd9, 0x83, 0x90, 0x1a, 0xce, 0x81, 0x0b, 0x85, 0xd6, 0x07, 0xad, 0xb1, 0x4d,
+    0x11, 0xa0, 0x6f, 0x60, 0xb5, 0x45, 0xe1, 0x71, 0xbf, 0x5f, 0x39, 0x6b, 0xe4, 0x3a, 0x24, 0x7f,
+    0xc4, 0x4a, 0x5b, 0x37, 0x5a, 0x1c, 0x51, 0x37, 0xb9, 0x08, 0x63, 0xc9, 0x04, 0xaf, 0x95, 0x70,
+    0xee, 0x9a, 0xc4, 0x12, 0x33, 0x8b, 0x15, 0xc1, 0xac, 0x58, 0x49, 0x37, 0xa1, 0xdd, 0x4b, 0xf2,
+    0x84, 0xb8, 0xc2, 0xde, 0xd0, 0x5f, 0x40, 0x84, 0xe6, 0x9d, 0x58, 0xc7, 0x39, 0xbf, 0x58, 0x1f,
+    0xbd, 0x1e, 0xb8, 0x68, 0x9a, 0xab, 0x35, 0xe5, 0xff, 0x90, 0x8e, 0x60, 0x48, 0x55, 0xdd, 0xb4,
+    0x1c, 0xa4, 0x67, 0xa7, 0x80, 0xeb, 0xb8, 0x27, 0x51, 0x0b, 0xae, 0x79, 0x8a, 0x7b, 0xb4, 0x70,
+    0x72, 0x02, 0xaf, 0xff, 0x79, 0x2f, 0xdc, 0x85, 0xf7, 0x56, 0x2e, 0x27, 0x8f, 0x69, 0x05, 0xd2,
+    0x06, 0xb0, 0xa2, 0x80, 0xe4, 0x6e, 0x99, 0x11, 0x80, 0x74, 0x84, 0x4a, 0x5f, 0xb0, 0x15, 0x93,
+    0x8a, 0x1d, 0xa4, 0x41, 0x6b, 0xf3, 0xeb, 0x8f, 0xce, 0x52, 0xbc, 0x91, 0x6d, 0xfb, 0xf7, 0x5a,
+    0xac, 0xe8, 0xe1, 0x04, 0x48, 0x11, 0x97, 0x9f, 0x0e, 0x8b, 0xd5, 0x03, 0x1c, 0xd1, 0xac, 0xa3,
+    0x44, 0xfa, 0x29, 0x22, 0x30, 0x44, 0x2b, 0x48, 0xd7, 0xfb, 0x71, 0xdc, 0x2c, 0x1f, 0xc9, 0x58,
+    0xbe, 0xc2, 0x8d, 0xcb, 0x43, 0x4a, 0xc1, 0x15, 0xea, 0xce, 0xf7, 0x61, 0x4a, 0xfb, 0x79, 0x47,
+    0x4b, 0x1a, 0xe1, 0x05, 0x6d, 0x2e, 0x17, 0xe3, 0xa8, 0x24, 0xbd, 0xaa, 0x32, 0x3b, 0x88, 0xa0,
+    0x05, 0x41, 0x4f, 0x0f, 0x88, 0xcd, 0xc4, 0x28, 0x67, 0xd4, 0x4f, 0x2b, 0x3b, 0x32, 0x6a, 0x9b,
+    0x0d, 0xe8, 0x7b, 0xd3, 0xcc, 0x81, 0xdd, 0x5e, 0xdc, 0x5f, 0x7e, 0x65, 0xa7, 0x59, 0x8f, 0xa2,
+    0x41, 0xeb, 0xe6, 0xf4, 0xcc, 0xd8, 0x7e, 0x22, 0x67, 0xf7, 0xb4, 0x95, 0x8c, 0x72, 0x22, 0x6f,
+    0x2d, 0x82, 0x43, 0xb3, 0x47, 0x47, 0x36, 0xc1, 0xee, 0x94, 0x5e, 0x68, 0xb3, 0x99, 0xc3, 0xf7,
+    0xbb, 0x9b, 0x6b, 0xee, 0xc8, 0x4a, 0xdd, 0xc9, 0x76, 0x93, 0xba, 0xcc, 0x76, 0x45, 0xc6, 0x7d,
+    0x8f, 0x3a, 0xb7, 0x61, 0x1e, 0x96, 0x9b, 0x15, 0x2d, 0xb3, 0xe5, 0x01, 0x4a, 0x2f, 0x68, 0x0e,
+    0xb7, 0xd6, 0x0c, 0xd2, 0x21, 0xb7, 0x18, 0xf4, 0xe5, 0x96, 0x08, 0x84, 0x9f, 0x5c, 0x71, 0x80,
+    0x51, 0x52, 0x9c, 0xe3, 0x61, 0x07, 0xc8, 0x94, 0xf2, 0x3f, 0x82, 0x43, 0x49, 0xea, 0x90, 0xa4,
+    0x26, 0x70, 0x4c, 0x4b, 0x03, 0xcf, 0x8b, 0x78, 0x1f, 0x3e, 0x1a, 0xd5, 0x6f, 0xe1, 0x30, 0x26,
+    0x1e, 0x37, 0x05, 0x00, 0x00,
+};
+
+static const WebAsset WEB_ASSETS[] = {
+    {ASSET_HOME_CSS, "text/css", ASSET_HOME_CSS_GZ, sizeof(ASSET_HOME_CSS_GZ)},
+    {ASSET_HOME_JS, "application/javascript", ASSET_HOME_JS_GZ, sizeof(ASSET_HOME_JS_GZ)},
+    {ASSET_PORTAL_CSS, "text/css", ASSET_PORTAL_CSS_GZ, sizeof(ASSET_PORTAL_CSS_GZ)},
+    {ASSET_SETTINGS_CSS, "text/css", ASSET_SETTINGS_CSS_GZ, sizeof(ASSET_SETTINGS_CSS_GZ)},
+    {ASSET_SETTINGS_JS, "application/javascript", ASSET_SETTINGS_JS_GZ, sizeof(ASSET_SETTINGS_JS_GZ)},
+};
+static constexpr uint8_t WEB_ASSET_COUNT =
+    sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);
+
+// Risposta di un asset: byte gzip così come sono, cache permanente (l'URL
+// cambia con il contenuto). Template: basta un server con l'API WebServer.
+template <class Server>
+static void webSendAsset(Server &web, const WebAsset &a) {
+  web.sendHeader(F("Content-Encoding"), F("gzip"));
+  web.sendHeader(F("Cache-Control"), F("public, max-age=31536000, immutable"));
+  web.send_P(200, a.type, (PGM_P)a.gz, a.len);
+}
@@ -0,0 +1,483 @@
+/*
+===============================================================================
+   SQUARED — WEBSOCKET CLIENT (RFC 6455, ws://)
+   Descrizione: client WebSocket minimale su WiFiClient: handshake con
+                verifica Sec-WebSocket-Accept (connect e handshake non
+                bloccanti, un passo per giro di loop), invio di frame testo
+                mascherati, ricezione non bloccante con riassemblaggio dei
+                frammenti, ping/pong e close gestiti internamente.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • ws.begin(ip, port, path [,timeoutMs])       avvia connect e handshake
+   • ws.step()                                   un passo per giro di loop:
+                                                 WS_PENDING / WS_READY /
+                                                 WS_FAILED
+   • ws.sendText(str)                            frame testo (FIN, mask)
+   • ws.poll(handler)                            legge solo ciò che è già
+                                                 arrivato, handler(data, len)
+                                                 per ogni messaggio completo
+   • ws.close()
+
+   • I messaggi vengono riassemblati in un buffer che cresce in PSRAM fino a
+     WS_MAX_MSG; quelli più grandi vengono scartati senza chiudere la
+     connessione. Dopo un messaggio grande il buffer torna piccolo.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_heap_caps.h>
+#include <errno.h>
+#include <functional>
+#include <lwip/sockets.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+
+typedef std::function<void(const char *data, size_t len)> WsHandler;
+
+enum WsStep : uint8_t { WS_PENDING = 0, WS_READY, WS_FAILED };
+
+static constexpr size_t WS_MAX_MSG = 512 * 1024; // get_states di HA grandi
+static constexpr size_t WS_KEEP_BUF = 8 * 1024;  // buffer tenuto fra messaggi
+static constexpr size_t WS_RX_CHUNK = 512;
+
+enum WsOp : uint8_t {
+  WS_CONT = 0x0,
+  WS_TEXT = 0x1,
+  WS_BIN = 0x2,
+  WS_CLOSE = 0x8,
+  WS_PING = 0x9,
+  WS_PONG = 0xA
+};
+
+class WsClient {
+public:
+  WsClient() { resetFrame(); }
+
+  ~WsClient() {
+    close();
+    free(msg_);
+  }
+
+  // -------------------------------------------------------------------------
+  // Connessione non bloccante: begin() avvia il connect TCP, step() a ogni
+  // giro del loop lo completa, invia l'Upgrade e legge la risposta con i
+  // soli byte già arrivati. Scaduto timeoutMs → WS_FAILED.
+  // -------------------------------------------------------------------------
+  bool begin(const char *host, uint16_t port, const char *path,
+             uint32_t timeoutMs = 3000) {
+    close();
+
+    sockaddr_in sa = {};
+    sa.sin_family = AF_INET;
+    sa.sin_port = htons(port);
+    if (inet_pton(AF_INET, host, &sa.sin_addr) != 1)
+      return false; // solo IP: nessuna risoluzione bloccante
+
+    const int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+    if (fd < 0)
+      return false;
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+    if (::connect(fd, (sockaddr *)&sa, sizeof(sa)) < 0 &&
+        errno != EINPROGRESS) {
+      ::close(fd);
+      return false;
+    }
+    fd_ = fd;
+
+    uint8_t raw[16];
+    for (uint8_t i = 0; i < 16; i += 4) {
+      uint32_t r = esp_random();
+      memcpy(raw + i, &r, 4);
+    }
+    char key[32];
+    size_t kl = 0;
+    mbedtls_base64_encode((uint8_t *)key, sizeof(key), &kl, raw, 16);
+    key[kl] = 0;
+    acceptFor(key, expect_, sizeof(expect_));
+
+    const int n = snprintf(req_, sizeof(req_),
+                           "GET %s HTTP/1.1\r\n"
+                           "Host: %s:%u\r\n"
+                           "Upgrade: websocket\r\n"
+                           "Connection: Upgrade\r\n"
+                           "Sec-WebSocket-Key: %s\r\n"
+                           "Sec-WebSocket-Version: 13\r\n\r\n",
+                           path, host, port, key);
+    if (n <= 0 || n >= (int)sizeof(req_)) {
+      close();
+      return false;
+    }
+
+    hs_ = HS_TCP;
+    hsT0_ = millis();
+    hsMs_ = timeoutMs;
+    lineLen_ = 0;
+    upgraded_ = accepted_ = false;
+    return true;
+  }
+
+  WsStep step() {
+    if (open_)
+      return WS_READY;
+    if (hs_ == HS_IDLE)
+      return WS_FAILED;
+    if (millis() - hsT0_ >= hsMs_)
+      return fail();
+
+    if (hs_ == HS_TCP) {
+      // connect completato quando il socket diventa scrivibile
+      fd_set wr;
+      FD_ZERO(&wr);
+      FD_SET(fd_, &wr);
+      timeval tv = {0, 0};
+      const int r = select(fd_ + 1, nullptr, &wr, nullptr, &tv);
+      if (r == 0)
+        return WS_PENDING;
+      int err = 0;
+      socklen_t el = sizeof(err);
+      if (r < 0 || getsockopt(fd_, SOL_SOCKET, SO_ERROR, &err, &el) < 0 || err)
+        return fail();
+
+      // da qui in poi bloccante, come dopo WiFiClient::connect()
+      fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL, 0) & ~O_NONBLOCK);
+      cli_ = WiFiClient(fd_);
+      fd_ = -1;
+      cli_.setNoDelay(true);
+      const size_t n = strlen(req_);
+      if (cli_.write((const uint8_t *)req_, n) != n)
+        return fail();
+      hs_ = HS_REPLY;
+    }
+
+    // Risposta: "HTTP/1.1 101" + Sec-WebSocket-Accept corretto
+    while (cli_.available() > 0) {
+      const char c = cli_.read();
+      if (c == '\r')
+        continue;
+      if (c != '\n') {
+        if (lineLen_ < sizeof(line_) - 1)
+          line_[lineLen_++] = c;
+        continue;
+      }
+
+      line_[lineLen_] = 0;
+      if (!lineLen_) { // fine header
+        if (!upgraded_ || !accepted_)
+          return fail();
+        hs_ = HS_IDLE;
+        open_ = true;
+        lastRxMs = millis();
+        resetFrame();
+        msgLen_ = 0;
+        return WS_READY;
+      }
+
+      if (!strncmp(line_, "HTTP/1.1 101", 12))
+        upgraded_ = true;
+      else if (!strncasecmp(line_, "Sec-WebSocket-Accept:", 21)) {
+        const char *v = line_ + 21;
+        while (*v == ' ')
+          v++;
+        accepted_ = !strcmp(v, expect_);
+      }
+      lineLen_ = 0;
+    }
+    if (!cli_.connected())
+      return fail();
+    return WS_PENDING;
+  }
+
+  // begin() riuscito e handshake non ancora concluso
+  bool connecting() const { return hs_ != HS_IDLE; }
+
+  bool connected() {
+    if (open_ && !cli_.connected())
+      open_ = false;
+    return open_;
+  }
+
+  void close() {
+    if (open_)
+      sendFrame(WS_CLOSE, nullptr, 0);
+    open_ = false;
+    hs_ = HS_IDLE;
+    if (fd_ >= 0) {
+      ::close(fd_);
+      fd_ = -1;
+    }
+    cli_.stop();
+    resetFrame();
+    msgLen_ = 0;
+  }
+
+  bool sendText(const char *s, size_t n) { return sendFrame(WS_TEXT, s, n); }
+  bool sendText(const String &s) { return sendText(s.c_str(), s.length()); }
+
+  // -------------------------------------------------------------------------
+  // Ricezione non bloccante
+  // -------------------------------------------------------------------------
+  void poll(const WsHandler &onMsg) {
+    if (!connected())
+      return;
+
+    uint8_t buf[WS_RX_CHUNK];
+    int avail;
+    while (open_ && (avail = cli_.available()) > 0) {
+      int got = cli_.read(buf, avail < (int)sizeof(buf) ? avail : sizeof(buf));
+      if (got <= 0)
+        break;
+      lastRxMs = millis();
+      for (int i = 0; i < got && open_;) {
+        i += feed(buf + i, got - i, onMsg);
+      }
+    }
+  }
+
+  uint32_t lastRxMs = 0;
+
+private:
+  WiFiClient cli_;
+  bool open_ = false;
+
+  // handshake in corso
+  enum : uint8_t { HS_IDLE = 0, HS_TCP, HS_REPLY } hs_ = HS_IDLE;
+  int fd_ = -1; // socket in connect, poi passato a cli_
+  uint32_t hsT0_ = 0, hsMs_ = 0;
+  char req_[256];
+  char expect_[32];
+  char line_[128];
+  uint8_t lineLen_ = 0;
+  bool upgraded_ = false, accepted_ = false;
+
+  // frame corrente
+  uint8_t hdr_[14];
+  uint8_t hdrLen_, hdrNeed_;
+  uint64_t left_, pos_;
+  uint8_t op_ = 0;
+  bool fin_ = false;
+  bool masked_ = false;
+  uint8_t mask_[4];
+
+  // messaggio in riassemblaggio
+  uint8_t msgOp_ = 0;
+  bool drop_ = false;
+  char *msg_ = nullptr;
+  size_t msgLen_ = 0, msgCap_ = 0;
+
+  // payload di controllo (max 125 byte per RFC)
+  uint8_t ctl_[125];
+  uint8_t ctlLen_ = 0;
+
+  WsStep fail() {
+    close();
+    return WS_FAILED;
+  }
+
+  static void acceptFor(const char *key, char *out, size_t cap) {
+    static const char GUID[] = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+    char cat[64];
+    const size_t n = snprintf(cat, sizeof(cat), "%s%s", key, GUID);
+    uint8_t sha[20];
+#if defined(MBEDTLS_VERSION_NUMBER) && MBEDTLS_VERSION_NUMBER >= 0x03000000
+    mbedtls_sha1((const uint8_t *)cat, n, sha);
+#else
+    mbedtls_sha1_ret((const uint8_t *)cat, n, sha);
+#endif
+    size_t ol = 0;
+    mbedtls_base64_encode((uint8_t *)out, cap - 1, &ol, sha, sizeof(sha));
+    out[ol] = 0;
+  }
+
+  void resetFrame() {
+    hdrLen_ = 0;
+    hdrNeed_ = 2;
+    left_ = 0;
+    pos_ = 0;
+  }
+
+  bool grow(size_t need) {
+    if (need <= msgCap_)
+      return true;
+    size_t cap = msgCap_ ? msgCap_ : 1024;
+    while (cap < need)
+      cap *= 2;
+    void *p = heap_caps_realloc(msg_, cap, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!p)
+      p = realloc(msg_, cap);
+    if (!p)
+      return false;
+    msg_ = (char *)p;
+    msgCap_ = cap;
+    return true;
+  }
+
+  // -------------------------------------------------------------------------
+  // Invio frame (client → server sempre mascherato)
+  // -------------------------------------------------------------------------
+  bool sendFrame(uint8_t op, const char *data, size_t n) {
+    uint8_t h[14];
+    uint8_t hl = 0;
+    h[hl++] = 0x80 | op;
+    if (n < 126) {
+      h[hl++] = 0x80 | n;
+    } else if (n < 65536) {
+      h[hl++] = 0x80 | 126;
+      h[hl++] = n >> 8;
+      h[hl++] = n & 0xFF;
+    } else {
+      h[hl++] = 0x80 | 127;
+      for (int8_t i = 7; i >= 0; i--)
+        h[hl++] = (uint64_t)n >> (i * 8);
+    }
+    const uint32_t r = esp_random();
+    uint8_t m[4];
+    memcpy(m, &r, 4);
+    memcpy(h + hl, m, 4);
+    hl += 4;
+
+    if (cli_.write(h, hl) != hl)
+      return false;
+
+    uint8_t chunk[128];
+    for (size_t off = 0; off < n;) {
+      size_t k = n - off < sizeof(chunk) ? n - off : sizeof(chunk);
+      for (size_t i = 0; i < k; i++)
+        chunk[i] = data[off + i] ^ m[(off + i) & 3];
+      if (cli_.write(chunk, k) != k)
+        return false;
+      off += k;
+    }
+    return true;
+  }
+
+  // -------------------------------------------------------------------------
+  // Macchina a stati frame: ritorna i byte consumati
+  // -------------------------------------------------------------------------
+  size_t feed(const uint8_t *p, size_t n, const WsHandler &onMsg) {
+    size_t used = 0;
+
+    // --- header ---
+    while (hdrLen_ < hdrNeed_ && used < n) {
+      hdr_[hdrLen_++] = p[used++];
+      if (hdrLen_ == 2) {
+        const uint8_t l7 = hdr_[1] & 0x7F;
+        hdrNeed_ = 2 + (l7 == 126 ? 2 : l7 == 127 ? 8 : 0) +
+                   ((hdr_[1] & 0x80) ? 4 : 0);
+      }
+    }
+    if (hdrLen_ < hdrNeed_)
+      return used;
+
+    if (!pos_ && !left_) {
+      if (!beginPayload())
+        return used;
+      if (!left_) {
+        endPayload(onMsg);
+        return used;
+      }
+    }
+
+    // --- payload ---
+    size_t k = n - used;
+    if (k > left_)
+      k = (size_t)left_;
+
+    if (op_ >= WS_CLOSE) {
+      for (size_t i = 0; i < k; i++, pos_++)
+        if (ctlLen_ < sizeof(ctl_))
+          ctl_[ctlLen_++] = p[used + i] ^ (masked_ ? mask_[pos_ & 3] : 0);
+    } else if (!drop_) {
+      if (msgLen_ + k > WS_MAX_MSG || !grow(msgLen_ + k + 1)) {
+        drop_ = true;
+        msgLen_ = 0;
+      } else {
+        for (size_t i = 0; i < k; i++, pos_++)
+          msg_[msgLen_++] = p[used + i] ^ (masked_ ? mask_[pos_ & 3] : 0);
+      }
+    }
+
+    used += k;
+    left_ -= k;
+    if (!left_)
+      endPayload(onMsg);
+    return used;
+  }
+
+  // Header completo: lunghezza, maschera, inizio messaggio
+  bool beginPayload() {
+    fin_ = hdr_[0] & 0x80;
+    op_ = hdr_[0] & 0x0F;
+    masked_ = hdr_[1] & 0x80;
+
+    const uint8_t l7 = hdr_[1] & 0x7F;
+    uint8_t i = 2;
+    if (l7 == 126) {
+      left_ = ((uint16_t)hdr_[2] << 8) | hdr_[3];
+      i = 4;
+    } else if (l7 == 127) {
+      left_ = 0;
+      for (; i < 10; i++)
+        left_ = (left_ << 8) | hdr_[i];
+    } else {
+      left_ = l7;
+    }
+    if (masked_)
+      memcpy(mask_, hdr_ + i, 4);
+    pos_ = 0;
+
+    if (op_ >= WS_CLOSE) {
+      ctlLen_ = 0;
+    } else if (op_ != WS_CONT) {
+      msgOp_ = op_;
+      msgLen_ = 0;
+      drop_ = false;
+    }
+
+    // header consumato: il frame vuoto viene chiuso dal chiamante
+    hdrLen_ = 0;
+    hdrNeed_ = 0;
+    return true;
+  }
+
+  void endPayload(const WsHandler &onMsg) {
+    const uint8_t op = op_;
+    const bool fin = fin_;
+    resetFrame();
+
+    switch (op) {
+    case WS_PING:
+      sendFrame(WS_PONG, (const char *)ctl_, ctlLen_);
+      return;
+    case WS_PONG:
+      return;
+    case WS_CLOSE:
+      sendFrame(WS_CLOSE, (const char *)ctl_, ctlLen_ >= 2 ? 2 : 0);
+      open_ = false;
+      cli_.stop();
+      return;
+    }
+
+    if (!fin)
+      return;
+
+    if (!drop_ && msgOp_ == WS_TEXT && msg_) {
+      msg_[msgLen_] = 0;
+      onMsg(msg_, msgLen_);
+    }
+    msgLen_ = 0;
+    drop_ = false;
+
+    if (msgCap_ > WS_KEEP_BUF) {
+      free(msg_);
+      msg_ = nullptr;
+      msgCap_ = 0;
+    }
+  }
+};
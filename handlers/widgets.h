@@ -0,0 +1,384 @@
+/*
+===============================================================================
+   SQUARED — WIDGETS (albero UI a modalità ritenuta)
+   Descrizione: widget con stato (etichetta, riga, bottone, barra, badge,
+                pannello) in un array statico per schermata. I setter
+                segnano “sporco” un widget solo se cambia quello che si
+                vede; wgRender() ridisegna solo i widget sporchi, tagliati
+                sul rettangolo proprio e dei genitori. Così un tocco nel
+                menu o l'aggiornamento di un valore riscrive pochi pixel
+                invece dell'intera schermata.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • wgAdd(t, kind, x, y, w, h, stile, genitore, flag)   costruzione (una volta)
+   • wgText / wgVal / wgOn / wgShow / wgColor / wgBar     stato → sporco
+   • wgInvalidate(t)   tutto da ridisegnare (schermata appena pulita)
+   • wgRender(t)       disegna i widget sporchi; ritorna quanti
+   • wgHit(w, x, y)    tocco dentro il widget (visibile)
+
+   Albero: ogni widget ha l'indice del genitore (-1 = radice) e i genitori
+   precedono i figli nell'array. Un genitore ridisegnato ridisegna i figli;
+   un widget nascosto (o con un antenato nascosto) lascia il colore del
+   genitore. Le etichette scrivono il testo opaco e riempiono solo il
+   resto del rettangolo: nessun pixel scritto due volte, niente flicker.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+#include <Arduino_GFX_Library.h>
+
+extern Arduino_RGB_Display *gfx;
+
+static constexpr uint8_t WG_MAX = 32; // widget per albero (maschera a 32 bit)
+
+enum WgKind : uint8_t { WG_PANEL, WG_LABEL, WG_ROW, WG_BUTTON, WG_BAR, WG_BADGE };
+
+enum : uint8_t {
+  WG_CENTER = 1,  // testo centrato
+  WG_RIGHT = 2,   // testo a destra
+  WG_DOT = 4,     // bottone: indicatore acceso/spento
+  WG_ARROW_L = 8, // bottone: freccia al posto del testo
+  WG_ARROW_R = 16
+};
+
+enum : uint8_t {
+  WG_DIRTY_TEXT = 1, // solo il testo (bottone: area dell'etichetta)
+  WG_DIRTY_ALL = 2
+};
+
+struct WgStyle {
+  uint16_t bg, fg, border;       // spento (o unico stato)
+  uint16_t bgOn, fgOn, borderOn; // acceso (bottoni)
+  uint8_t r;                     // raggio angoli
+  uint8_t size;                  // scala testo
+};
+
+struct Widget {
+  int16_t x, y, w, h;
+  const WgStyle *st;
+  int8_t parent; // -1 = radice
+  WgKind kind;
+  uint8_t flags;
+  bool on, hidden;
+  uint8_t dirty;  // WG_DIRTY_*
+  uint16_t color; // riga: valore; barra: riempimento; badge: fondo
+  uint16_t value; // barra: per mille
+  char text[40];
+  char val[8];    // riga: valore allineato a destra
+};
+
+struct WgTree {
+  Widget *w;
+  uint8_t cap, n;
+  uint16_t bg; // sotto i widget radice
+};
+
+struct WgRect {
+  int16_t x, y, w, h;
+};
+
+// ============================================================================
+// COSTRUZIONE
+// ============================================================================
+static Widget &wgAdd(WgTree &t, WgKind kind, int16_t x, int16_t y, int16_t w,
+                     int16_t h, const WgStyle *st, int8_t parent = -1,
+                     uint8_t flags = 0) {
+  Widget &g = t.w[t.n < t.cap && t.n < WG_MAX ? t.n++ : t.n - 1];
+  memset(&g, 0, sizeof(g));
+  g.x = x;
+  g.y = y;
+  g.w = w;
+  g.h = h;
+  g.st = st;
+  g.parent = parent;
+  g.kind = kind;
+  g.flags = flags;
+  g.dirty = WG_DIRTY_ALL;
+  return g;
+}
+
+// ============================================================================
+// STATO (sporco solo se cambia l'aspetto)
+// ============================================================================
+static void wgText(Widget &w, const char *s) {
+  if (!strncmp(w.text, s, sizeof(w.text) - 1))
+    return;
+  strlcpy(w.text, s, sizeof(w.text));
+  w.dirty |= WG_DIRTY_TEXT;
+}
+
+static void wgVal(Widget &w, const char *s) {
+  if (!strncmp(w.val, s, sizeof(w.val) - 1))
+    return;
+  strlcpy(w.val, s, sizeof(w.val));
+  w.dirty |= WG_DIRTY_TEXT;
+}
+
+static void wgOn(Widget &w, bool on) {
+  if (w.on == on)
+    return;
+  w.on = on;
+  w.dirty |= WG_DIRTY_ALL;
+}
+
+static void wgShow(Widget &w, bool show) {
+  if (w.hidden == !show)
+    return;
+  w.hidden = !show;
+  w.dirty |= WG_DIRTY_ALL;
+}
+
+static void wgColor(Widget &w, uint16_t c) {
+  if (w.color == c)
+    return;
+  w.color = c;
+  w.dirty |= WG_DIRTY_ALL;
+}
+
+static inline int16_t wgFill(const Widget &w, uint16_t permille) {
+  return (int32_t)permille * (w.w - 4) / 1000;
+}
+
+// Barra: si ridisegna solo quando il riempimento cambia di almeno un pixel
+static void wgBar(Widget &w, uint16_t permille) {
+  if (permille > 1000)
+    permille = 1000;
+  if (wgFill(w, permille) != wgFill(w, w.value))
+    w.dirty |= WG_DIRTY_ALL;
+  w.value = permille;
+}
+
+static void wgInvalidate(WgTree &t) {
+  for (uint8_t i = 0; i < t.n; i++)
+    t.w[i].dirty = WG_DIRTY_ALL;
+}
+
+static inline bool wgHit(const Widget &w, int16_t x, int16_t y) {
+  return !w.hidden && x >= w.x && x <= w.x + w.w && y >= w.y &&
+         y <= w.y + w.h;
+}
+
+// ============================================================================
+// GEOMETRIA
+// ============================================================================
+static void wgIntersect(WgRect &c, int16_t x, int16_t y, int16_t w, int16_t h) {
+  const int16_t x1 = max(c.x, x), y1 = max(c.y, y);
+  const int16_t x2 = min<int16_t>(c.x + c.w, x + w);
+  const int16_t y2 = min<int16_t>(c.y + c.h, y + h);
+  c = {x1, y1, (int16_t)(x2 - x1), (int16_t)(y2 - y1)};
+}
+
+// Rettangolo visibile (genitori e schermo); false se vuoto o antenato nascosto
+static bool wgClip(const WgTree &t, uint8_t i, WgRect &c) {
+  const Widget &w = t.w[i];
+  c = {w.x, w.y, w.w, w.h};
+  for (int8_t p = w.parent; p >= 0; p = t.w[p].parent) {
+    if (t.w[p].hidden)
+      return false;
+    const Widget &a = t.w[p];
+    wgIntersect(c, a.x, a.y, a.w, a.h);
+  }
+  wgIntersect(c, 0, 0, 480, 480);
+  return c.w > 0 && c.h > 0;
+}
+
+static inline uint16_t wgUnder(const WgTree &t, const Widget &w) {
+  return w.parent >= 0 ? t.w[w.parent].st->bg : t.bg;
+}
+
+static inline bool wgWhole(const Widget &w, const WgRect &c) {
+  return c.x == w.x && c.y == w.y && c.w == w.w && c.h == w.h;
+}
+
+// ============================================================================
+// DISEGNO
+// ============================================================================
+struct WgSpan {
+  int16_t x;
+  const char *s;
+  uint8_t len;
+  uint16_t fg;
+};
+
+static void wgFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) {
+  if (w > 0 && h > 0)
+    gfx->fillRect(x, y, w, h, c);
+}
+
+// Una riga di testo opaco (span ordinati per x) dentro c: si riempiono
+// solo le strisce sopra, sotto e tra gli span
+static void wgLine(const WgRect &c, uint8_t size, uint16_t bg,
+                   const WgSpan *sp, uint8_t n) {
+  const int16_t th = 8 * size;
+  const int16_t ty = c.y + (c.h - th) / 2;
+  wgFillRect(c.x, c.y, c.w, ty - c.y, bg);
+  wgFillRect(c.x, ty + th, c.w, c.y + c.h - ty - th, bg);
+
+  gfx->setTextSize(size);
+  int16_t cur = c.x;
+  for (uint8_t k = 0; k < n; k++) {
+    wgFillRect(cur, ty, sp[k].x - cur, th, bg);
+    gfx->setTextColor(sp[k].fg, bg);
+    gfx->setCursor(sp[k].x, ty);
+    for (uint8_t j = 0; j < sp[k].len; j++)
+      gfx->write(sp[k].s[j]);
+    cur = sp[k].x + sp[k].len * 6 * size;
+  }
+  wgFillRect(cur, ty, c.x + c.w - cur, th, bg);
+}
+
+static inline uint8_t wgFit(const char *s, int16_t w, uint8_t size) {
+  const size_t n = strlen(s);
+  const int16_t m = w > 0 ? w / (6 * size) : 0;
+  return n < (size_t)m ? n : m;
+}
+
+static void wgDrawLabel(const Widget &w, const WgRect &c) {
+  const WgStyle &s = *w.st;
+  const uint8_t len = wgFit(w.text, c.w, s.size);
+  const int16_t tw = len * 6 * s.size;
+  int16_t x = w.x;
+  if (w.flags & WG_RIGHT)
+    x = w.x + w.w - tw;
+  else if (w.flags & WG_CENTER)
+    x = w.x + (w.w - tw) / 2;
+  x = constrain(x, c.x, c.x + c.w - tw);
+  const WgSpan sp = {x, w.text, len, s.fg};
+  wgLine(c, s.size, s.bg, &sp, 1);
+}
+
+// Riga: etichetta a sinistra, valore a destra nel colore del widget
+static void wgDrawRow(const Widget &w, const WgRect &c) {
+  const WgStyle &s = *w.st;
+  const uint8_t vl = wgFit(w.val, c.w, s.size);
+  const int16_t vx = c.x + c.w - vl * 6 * s.size;
+  const uint8_t ll = wgFit(w.text, vx - c.x - 6 * s.size, s.size);
+  const WgSpan sp[2] = {{c.x, w.text, ll, s.fg}, {vx, w.val, vl, w.color}};
+  wgLine(c, s.size, s.bg, sp, 2);
+}
+
+// Bottone: solo testo cambiato → si riscrive l'area dell'etichetta
+static void wgDrawButton(const Widget &w, const WgRect &c, uint8_t dirty) {
+  const WgStyle &s = *w.st;
+  const uint16_t bg = w.on ? s.bgOn : s.bg;
+  const uint16_t fg = w.on ? s.fgOn : s.fg;
+  const uint16_t bd = w.on ? s.borderOn : s.border;
+
+  if (!wgWhole(w, c)) { // tagliato da un genitore: solo il fondo
+    gfx->fillRect(c.x, c.y, c.w, c.h, bg);
+    return;
+  }
+
+  const int16_t cx = w.x + w.w / 2, cy = w.y + w.h / 2;
+  const bool arrow = w.flags & (WG_ARROW_L | WG_ARROW_R);
+  const WgRect box = {(int16_t)(w.x + 14), (int16_t)(cy - 4 * s.size),
+                      (int16_t)(w.w - 28 - ((w.flags & WG_DOT) ? 30 : 0)),
+                      (int16_t)(8 * s.size)};
+  const uint8_t len = wgFit(w.text, box.w, s.size);
+  const int16_t tw = len * 6 * s.size;
+  const int16_t tx = (w.flags & WG_CENTER) ? cx - tw / 2 : box.x;
+
+  if (dirty == WG_DIRTY_TEXT && !arrow) {
+    const WgSpan sp = {tx, w.text, len, fg};
+    wgLine(box, s.size, bg, &sp, 1);
+    return;
+  }
+
+  gfx->fillRoundRect(w.x, w.y, w.w, w.h, s.r, bg);
+  gfx->drawRoundRect(w.x, w.y, w.w, w.h, s.r, bd);
+
+  if (arrow) {
+    constexpr int8_t sz = 12;
+    const int8_t d = (w.flags & WG_ARROW_L) ? 1 : -1;
+    gfx->fillTriangle(cx - d * (sz - 2), cy, cx + d * (sz - 6), cy - sz,
+                      cx + d * (sz - 6), cy + sz, fg);
+    return;
+  }
+
+  if (w.flags & WG_DOT) {
+    const int16_t ix = w.x + w.w - 22;
+    if (w.on)
+      gfx->fillCircle(ix, cy, 7, bd);
+    else
+      gfx->drawCircle(ix, cy, 7, fg);
+  }
+
+  gfx->setTextSize(s.size);
+  gfx->setTextColor(fg);
+  gfx->setCursor(tx, box.y);
+  for (uint8_t j = 0; j < len; j++)
+    gfx->write(w.text[j]);
+}
+
+static void wgDrawBar(const Widget &w, const WgRect &c) {
+  const WgStyle &s = *w.st;
+  if (!wgWhole(w, c)) {
+    gfx->fillRect(c.x, c.y, c.w, c.h, s.bg);
+    return;
+  }
+  gfx->fillRoundRect(w.x, w.y, w.w, w.h, s.r, s.bg);
+  const int16_t f = wgFill(w, w.value);
+  if (f > 0)
+    gfx->fillRoundRect(w.x + 2, w.y + 2, f, w.h - 4, s.r - 1, w.color);
+  gfx->drawRoundRect(w.x, w.y, w.w, w.h, s.r, s.border);
+}
+
+static void wgDraw(const Widget &w, const WgRect &c, uint8_t dirty) {
+  switch (w.kind) {
+  case WG_PANEL:
+    gfx->fillRect(c.x, c.y, c.w, c.h, w.st->bg);
+    break;
+  case WG_LABEL:
+    wgDrawLabel(w, c);
+    break;
+  case WG_ROW:
+    wgDrawRow(w, c);
+    break;
+  case WG_BUTTON:
+    wgDrawButton(w, c, dirty);
+    break;
+  case WG_BAR:
+    wgDrawBar(w, c);
+    break;
+  case WG_BADGE:
+    if (wgWhole(w, c))
+      gfx->fillRoundRect(w.x, w.y, w.w, w.h, w.st->r, w.color);
+    else
+      gfx->fillRect(c.x, c.y, c.w, c.h, w.color);
+    break;
+  }
+}
+
+// ============================================================================
+// RENDER
+// ============================================================================
+static uint8_t wgRender(WgTree &t) {
+  uint32_t painted = 0; // widget ridisegnati in questo giro
+  uint8_t n = 0;
+  for (uint8_t i = 0; i < t.n; i++) {
+    Widget &w = t.w[i];
+    if (w.parent >= 0 && (painted >> w.parent & 1))
+      w.dirty = WG_DIRTY_ALL;
+    const uint8_t dirty = w.dirty;
+    if (!dirty)
+      continue;
+    w.dirty = 0;
+
+    WgRect c;
+    if (!wgClip(t, i, c))
+      continue;
+    if (w.hidden)
+      gfx->fillRect(c.x, c.y, c.w, c.h, wgUnder(t, w));
+    else
+      wgDraw(w, c, dirty);
+    painted |= 1UL << i;
+    n++;
+  }
+  return n;
+}
@@ -0,0 +1,235 @@
+/*
+===============================================================================
+   SQUARED — WIFI LINK (riconnessione STA senza blocchi)
+   Descrizione: macchina a stati della connessione Wi-Fi guidata dagli
+                eventi del driver. Il loop chiama wlTick() a ogni giro e non
+                attende mai: durante un'interruzione le pagine continuano a
+                ruotare e animarsi con i dati in memoria. BSSID e canale
+                dell'ultimo AP vengono ricordati in NVS per riconnettersi
+                senza scansione; i tentativi falliti attendono un backoff
+                esponenziale con jitter.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • wlBegin()     credenziali e cache da NVS (una volta), primo tentativo;
+                   false se non ci sono credenziali
+   • wlTick()      nel loop; true al giro in cui il link torna su
+   • wlUp()        link con IP
+
+   Stati:   CONNECTING ──GOT_IP──▶ UP ──DISCONNECTED/LOST_IP──▶ CONNECTING
+                │ timeout                                      (subito)
+                ▼
+   tentativo con BSSID/canale (WL_FAST_MS) → fallito → scansione completa
+   (WL_SCAN_MS) → fallita → WAIT backoff 2 s · 2^n, max 60 s, ±25 %
+
+   • SQUARED_STATIC_IP "ip,gateway,mask,dns" (facoltativo, nel .ino):
+     niente DHCP, l'IP è pronto appena l'AP accetta l'associazione.
+
+===============================================================================
+*/
+
+#pragma once
+
+#include "strview.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <WiFi.h>
+#include <atomic>
+
+extern Preferences prefs;
+extern String sta_ssid, sta_pass;
+
+// ============================================================================
+// MACCHINA A STATI (nessuna chiamata al driver: provabile su host)
+// ============================================================================
+enum WlState : uint8_t { WLS_OFF, WLS_CONNECTING, WLS_UP, WLS_WAIT };
+enum WlEvent : uint8_t { WLE_NONE, WLE_GOT_IP, WLE_LOST };
+enum WlAction : uint8_t { WLA_NONE, WLA_BEGIN_FAST, WLA_BEGIN_SCAN };
+
+static constexpr uint32_t WL_FAST_MS = 3000;   // tentativo con BSSID noto
+static constexpr uint32_t WL_SCAN_MS = 12000;  // tentativo con scansione
+static constexpr uint32_t WL_BACKOFF_MS = 2000;
+static constexpr uint32_t WL_BACKOFF_MAX_MS = 60000;
+
+struct WlLink {
+  WlState st = WLS_OFF;
+  bool cached = false; // BSSID/canale disponibili
+  bool fast = false;   // tentativo in corso con la cache
+  uint8_t fails = 0;   // scansioni fallite di fila
+  uint32_t t0 = 0;     // inizio tentativo o attesa
+  uint32_t wait = 0;
+  uint32_t rnd = 0x9E3779B9;
+  uint16_t drops = 0;  // cadute del link da UP
+
+  WlAction attempt(uint32_t now, bool useCache) {
+    st = WLS_CONNECTING;
+    t0 = now;
+    fast = useCache && cached;
+    return fast ? WLA_BEGIN_FAST : WLA_BEGIN_SCAN;
+  }
+
+  // Jitter ±25 %: dispositivi che ripartono insieme non si sincronizzano
+  uint32_t backoff() {
+    uint32_t ms = WL_BACKOFF_MS << min<uint8_t>(fails - 1, 5);
+    if (ms > WL_BACKOFF_MAX_MS)
+      ms = WL_BACKOFF_MAX_MS;
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 17;
+    rnd ^= rnd << 5;
+    return ms - ms / 4 + rnd % (ms / 2 + 1);
+  }
+
+  WlAction step(WlEvent ev, uint32_t now) {
+    switch (st) {
+    case WLS_OFF:
+      return WLA_NONE;
+
+    case WLS_UP:
+      if (ev != WLE_LOST)
+        return WLA_NONE;
+      drops++;
+      fails = 0;
+      return attempt(now, true);
+
+    case WLS_CONNECTING:
+      if (ev == WLE_GOT_IP) {
+        st = WLS_UP;
+        fails = 0;
+        return WLA_NONE;
+      }
+      // DISCONNECTED durante l'associazione arriva anche per motivi
+      // transitori: conta solo il timeout del tentativo
+      if (now - t0 < (fast ? WL_FAST_MS : WL_SCAN_MS))
+        return WLA_NONE;
+      if (fast) // AP spostato o canale cambiato: scansione subito
+        return attempt(now, false);
+      fails++;
+      st = WLS_WAIT;
+      t0 = now;
+      wait = backoff();
+      return WLA_NONE;
+
+    case WLS_WAIT:
+      if (ev == WLE_GOT_IP) { // il driver si è riagganciato da solo
+        st = WLS_UP;
+        fails = 0;
+        return WLA_NONE;
+      }
+      if (now - t0 < wait)
+        return WLA_NONE;
+      return attempt(now, true);
+    }
+    return WLA_NONE;
+  }
+};
+
+// ============================================================================
+// DRIVER
+// ============================================================================
+static WlLink wl;
+static std::atomic<uint8_t> wl_event{WLE_NONE}; // ultimo evento (task eventi)
+static uint8_t wl_reason = 0;                   // ultimo motivo di disconnessione
+static uint8_t wl_bssid[6];
+static uint8_t wl_channel = 0;
+
+static void wlOnEvent(arduino_event_id_t e, arduino_event_info_t info) {
+  if (e == ARDUINO_EVENT_WIFI_STA_GOT_IP) {
+    wl_event.store(WLE_GOT_IP);
+  } else {
+    if (e == ARDUINO_EVENT_WIFI_STA_DISCONNECTED)
+      wl_reason = info.wifi_sta_disconnected.reason;
+    wl_event.store(WLE_LOST);
+  }
+}
+
+static void wlStart(WlAction a) {
+  if (a == WLA_NONE)
+    return;
+  WiFi.disconnect(false, false);
+  if (a == WLA_BEGIN_FAST)
+    WiFi.begin(sta_ssid.c_str(), sta_pass.c_str(), wl_channel, wl_bssid);
+  else
+    WiFi.begin(sta_ssid.c_str(), sta_pass.c_str());
+}
+
+// AP associato: BSSID e canale in NVS solo se diversi da quelli salvati
+static void wlRemember() {
+  const uint8_t *b = WiFi.BSSID();
+  const uint8_t ch = WiFi.channel();
+  if (!b || (wl.cached && ch == wl_channel && !memcmp(b, wl_bssid, 6)))
+    return;
+  memcpy(wl_bssid, b, 6);
+  wl_channel = ch;
+  wl.cached = true;
+  prefs.begin("wifi", false);
+  prefs.putBytes("bssid", wl_bssid, 6);
+  prefs.putUChar("ch", wl_channel);
+  prefs.end();
+}
+
+#ifdef SQUARED_STATIC_IP
+static void wlStaticIP() {
+  // "ip,gw,mask,dns" diviso in buffer fissi, senza String temporanee
+  char f[4][20] = {}; // oltre 15 caratteri fromString() rifiuta
+  const StrView s(SQUARED_STATIC_IP);
+  for (size_t i = 0, from = 0; i < 4 && from <= s.size(); i++) {
+    int c = s.find(',', from);
+    size_t to = c < 0 ? s.size() : (size_t)c;
+    s.sub(from, to - from).trim().copyTo(f[i], sizeof(f[i]));
+    from = to + 1;
+  }
+  IPAddress ip, gw, mask, dns;
+  if (ip.fromString(f[0]) && gw.fromString(f[1]) && mask.fromString(f[2])) {
+    if (!dns.fromString(f[3]))
+      dns = gw;
+    WiFi.config(ip, gw, mask, dns);
+  }
+}
+#endif
+
+static bool wlBegin() {
+  prefs.begin("wifi", true);
+  sta_ssid = prefs.getString("ssid", "");
+  sta_pass = prefs.getString("pass", "");
+  wl.cached = prefs.getBytes("bssid", wl_bssid, 6) == 6;
+  wl_channel = prefs.getUChar("ch", 0);
+  prefs.end();
+  wl.cached &= wl_channel >= 1 && wl_channel <= 14;
+
+  if (sta_ssid.isEmpty())
+    return false;
+
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);
+  WiFi.setAutoReconnect(false); // i tentativi li decide wlTick()
+  WiFi.onEvent(wlOnEvent, ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  WiFi.onEvent(wlOnEvent, ARDUINO_EVENT_WIFI_STA_DISCONNECTED);
+  WiFi.onEvent(wlOnEvent, ARDUINO_EVENT_WIFI_STA_LOST_IP);
+#ifdef SQUARED_STATIC_IP
+  wlStaticIP();
+#endif
+
+  wl.rnd ^= esp_random();
+  wlStart(wl.attempt(millis(), true));
+  return true;
+}
+
+static bool wlTick() {
+  const WlState was = wl.st;
+  const WlEvent ev = (WlEvent)wl_event.exchange(WLE_NONE);
+  wlStart(wl.step(ev, millis()));
+  if (wl.st != WLS_UP || was == WLS_UP)
+    return false;
+  wlRemember();
+  return true;
+}
+
+static inline bool wlUp() { return wl.st == WLS_UP; }
+
+static const char *wlStateName() {
+  static const char *const N[4] = {"off", "connecting", "up", "wait"};
+  return N[wl.st];
+}
@@ -11,6 +11,7 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/displayhelpers.h"
 #include "../handlers/globals.h"
 #include "../handlers/jsonhelpers.h"
@@ -22,8 +23,6 @@ extern const int PAGE_X, PAGE_Y, BASE_CHAR_W, BASE_CHAR_H, TEXT_SCALE, CHAR_H;
 extern void drawHeader(const String &title);
 extern void drawBoldMain(int16_t x, int16_t y, const String &, uint8_t scale);
 extern void drawHLine(int y);
-extern String sanitizeText(const String &);
-extern int indexOfCI(const String &, const String &, int from);
 extern bool httpGET(const String &url, String &out, uint32_t timeout);
 extern bool geocodeIfNeeded();
 extern String g_city, g_lang;
@@ -99,47 +98,6 @@ static const char *const tip_it[] PROGMEM = {tip_it_0, tip_it_1, tip_it_2,
 static const char *const tip_en[] PROGMEM = {tip_en_0, tip_en_1, tip_en_2,
                                              tip_en_3, tip_en_4};
 
-// ---------------------------------------------------------------------------
-// PARSING
-// ---------------------------------------------------------------------------
-static float parseFirstNumber(const String &obj, const char *key) {
-  // Costruisci pattern "key" minimale
-  int keyLen = strlen(key);
-  int p = obj.indexOf(key);
-  if (p < 0)
-    return NAN;
-
-  // Trova '['
-  int a = obj.indexOf('[', p + keyLen);
-  if (a < 0)
-    return NAN;
-
-  // Skip whitespace
-  int s = a + 1;
-  const int len = obj.length();
-  while (s < len && (obj[s] == ' ' || obj[s] == '\n' || obj[s] == '\r'))
-    s++;
-
-  if (s >= len || obj[s] == '"')
-    return NAN;
-
-  // Trova fine numero
-  int e = s;
-  while (e < len && obj[e] != ',' && obj[e] != ']' && obj[e] != ' ')
-    e++;
-
-  // Converti senza substring
-  char buf[16];
-  int numLen = e - s;
-  if (numLen >= (int)sizeof(buf))
-    numLen = sizeof(buf) - 1;
-  for (int i = 0; i < numLen; i++)
-    buf[i] = obj[s + i];
-  buf[numLen] = '\0';
-
-  return atof(buf);
-}
-
 // ---------------------------------------------------------------------------
 // CLASSIFICAZIONE (inline, legge da PROGMEM)
 // ---------------------------------------------------------------------------
@@ -177,25 +135,31 @@ static bool fetchAir() {
   // Costruisci URL
   String url =
       F("https://air-quality-api.open-meteo.com/v1/air-quality?latitude=");
-  url += g_lat;
-  url += F("&longitude=");
-  url += g_lon;
+  {
+    StateLock lock;
+    url += g_lat;
+    url += F("&longitude=");
+    url += g_lon;
+  }
   url += F("&hourly=pm2_5,pm10,ozone,nitrogen_dioxide&timezone=auto");
 
   String body;
   if (!httpGET(url, body, 10000))
     return false;
 
-  String hourlyBlk;
-  if (!extractObjectBlock(body, "hourly", hourlyBlk))
-    return false;
-
-  aq_val[AQ_PM25] = parseFirstNumber(hourlyBlk, "pm2_5");
-  aq_val[AQ_PM10] = parseFirstNumber(hourlyBlk, "pm10");
-  aq_val[AQ_O3] = parseFirstNumber(hourlyBlk, "ozone");
-  aq_val[AQ_NO2] = parseFirstNumber(hourlyBlk, "nitrogen_dioxide");
-
-  return true;
+  // primo valore orario di ogni inquinante, senza copiare il blocco "hourly"
+  float v[4] = {NAN, NAN, NAN, NAN};
+  JsonQuery q[] = {jqFloat("hourly.pm2_5[0]", v[AQ_PM25]),
+                   jqFloat("hourly.pm10[0]", v[AQ_PM10]),
+                   jqFloat("hourly.ozone[0]", v[AQ_O3]),
+                   jqFloat("hourly.nitrogen_dioxide[0]", v[AQ_NO2])};
+  const int n = jsonExtract(body, q, 4);
+
+  // pubblica quanto trovato (mancanti → NAN, "--" a schermo); riuscito
+  // solo con tutti e quattro gli inquinanti
+  StateLock lock;
+  memcpy(aq_val, v, sizeof(v));
+  return n == 4;
 }
 
 // ---------------------------------------------------------------------------
@@ -382,11 +346,11 @@ static void pageAir() {
   // Header
   if (isIt) {
     String h = F("Aria a ");
-    h += sanitizeText(g_city);
+    h += g_city;
     drawHeader(h);
   } else {
     String h = F("Air quality - ");
-    h += sanitizeText(g_city);
+    h += g_city;
     drawHeader(h);
   }
 
@@ -11,7 +11,9 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
+#include "../handlers/jsonhelpers.h"
 #include <Arduino.h>
 
 extern Arduino_RGB_Display *gfx;
@@ -30,7 +32,6 @@ extern void drawHeader(const String &title);
 extern String sanitizeText(const String &);
 extern bool httpGET(const String &, String &, uint32_t);
 
-extern bool jsonNum(const String &src, const char *key, float &out, int from);
 
 // ---------------------------------------------------------------------------
 // Stato FX globale
@@ -51,37 +52,42 @@ static inline const char *fmtDoubleBuf(double v, uint8_t dec, char *out) {
 }
 
 // ---------------------------------------------------------------------------
-// Fetch tassi FX dalla REST API (usa jsonNum degli helpers)
+// Fetch tassi FX dalla REST API (jsonExtract degli helpers)
 // ---------------------------------------------------------------------------
 bool fetchFX() {
-  if (!g_fiat.length())
-    g_fiat = "CHF";
+  String url = F("https://api.frankfurter.app/latest?from=");
+  {
+    StateLock lock;
+    if (!g_fiat.length())
+      g_fiat = "CHF";
+    url += g_fiat;
+  }
+  url += F("&to=CHF,EUR,USD,GBP,JPY,CAD,CNY,INR");
 
   String body;
-  if (!httpGET("https://api.frankfurter.app/latest?from=" + g_fiat +
-                   "&to=CHF,EUR,USD,GBP,JPY,CAD,CNY,INR",
-               body, 10000))
+  if (!httpGET(url, body, 10000))
     return false;
 
-  int base = 0; // non serve cercare un blocco specifico
-
-  auto get = [&](const char *code, double &out) {
-    float f = NAN;
-    if (jsonNum(body, code, f, base))
-      out = (double)f;
-    else
-      out = NAN;
+  // una sola passata sul body; la valuta base non compare in "rates" → NAN
+  double eur = NAN, usd = NAN, gbp = NAN, jpy = NAN, cad = NAN, cny = NAN,
+         inr = NAN, chf = NAN;
+  JsonQuery q[] = {
+      jqDouble("rates.EUR", eur), jqDouble("rates.USD", usd),
+      jqDouble("rates.GBP", gbp), jqDouble("rates.JPY", jpy),
+      jqDouble("rates.CAD", cad), jqDouble("rates.CNY", cny),
+      jqDouble("rates.INR", inr), jqDouble("rates.CHF", chf),
   };
-
-  get("EUR", fx_eur);
-  get("USD", fx_usd);
-  get("GBP", fx_gbp);
-  get("JPY", fx_jpy);
-  get("CAD", fx_cad);
-  get("CNY", fx_cny);
-  get("INR", fx_inr);
-  get("CHF", fx_chf);
-
+  jsonExtract(body, q, 8);
+
+  StateLock lock;
+  fx_eur = eur;
+  fx_usd = usd;
+  fx_gbp = gbp;
+  fx_jpy = jpy;
+  fx_cad = cad;
+  fx_cny = cny;
+  fx_inr = inr;
+  fx_chf = chf;
   return true;
 }
 
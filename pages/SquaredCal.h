@@ -1,9 +1,9 @@
 /*
 ===============================================================================
    SQUARED — PAGINA "CALENDAR ICS"
-   Descrizione: Parser ICS leggero (solo eventi di oggi), slot compatti
-                senza allocazioni persistenti, rendering max 3 eventi
-                ordinati per prossimità temporale.
+   Descrizione: Calendario ICS in streaming (IcsParser): fusi orari,
+                ricorrenze espanse sui prossimi 7 giorni, indice compatto
+                ordinato che i render leggono senza ri-parsare.
 
                 La pagina è in stato sperimentale e potrebbe non funzionare
                 con tutti i formati di calendario.
@@ -16,22 +16,24 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
+#include "../handlers/httpstream.h"
+#include "../handlers/icsparser.h"
+#include "../handlers/strview.h"
+#include "../handlers/translit.h"
 #include "../images/cal_icon.h"
 #include <Arduino.h>
+#include <esp_heap_caps.h>
 #include <time.h>
 
 // configurazione globale e helper
 extern String g_lang;
 extern String g_ics;
 
-extern void todayYMD(String &ymd);
-extern bool httpGET(const String &url, String &body, uint32_t timeoutMs);
-extern int indexOfCI(const String &src, const String &key, int from);
 
 extern void drawHeader(const String &title);
 extern void drawBoldMain(int16_t x, int16_t y, const String &raw,
                          uint8_t scale);
-extern String sanitizeText(const String &in);
 
 extern Arduino_RGB_Display *gfx;
 
@@ -46,172 +48,102 @@ extern const uint16_t COL_BG;
 extern void drawHLine(int y);
 
 // ---------------------------------------------------------------------------
-// Struttura evento ICS
+// Indice eventi (ordinato per inizio, riempito da IcsParser)
 // ---------------------------------------------------------------------------
-struct CalItem {
-  char when[16];
-  char summary[64];
-  time_t ts;
-  bool allDay;
-  bool used;
-};
+static const uint8_t CAL_MAX = 16;
+static const uint8_t CAL_WINDOW_DAYS = 7;
 
-static CalItem cal[3];
+static IcsEntry cal[CAL_MAX];
+static uint8_t cal_count = 0;
 
 // ---------------------------------------------------------------------------
-// Reset degli slot eventi
+// Orario human-readable: "HH:MM" / "all day", con giorno se non è oggi
 // ---------------------------------------------------------------------------
-static inline void resetCal() {
-  for (uint8_t i = 0; i < 3; i++) {
-    cal[i].when[0] = '\0';
-    cal[i].summary[0] = '\0';
-    cal[i].ts = 0;
-    cal[i].allDay = false;
-    cal[i].used = false;
-  }
-}
+static inline void humanTime(const IcsEntry &ev, bool today, char *out,
+                             size_t outLen) {
+  static const char it_wd[7][4] = {"Dom", "Lun", "Mar", "Mer",
+                                   "Gio", "Ven", "Sab"};
+  static const char en_wd[7][4] = {"Sun", "Mon", "Tue", "Wed",
+                                   "Thu", "Fri", "Sat"};
+  const bool it = (g_lang == "it");
 
-// ---------------------------------------------------------------------------
-// Estrae il testo dopo ':' fino a fine riga, con trim
-// ---------------------------------------------------------------------------
-static inline String extractAfterColon(const String &src, int pos) {
-  int c = src.indexOf(':', pos);
-  if (c < 0)
-    return "";
-  int e = src.indexOf('\n', c + 1);
-  if (e < 0)
-    e = src.length();
-
-  String t = src.substring(c + 1, e);
-  t.trim();
-  return t;
-}
+  struct tm lo;
+  localtime_r(&ev.start, &lo);
 
-// ---------------------------------------------------------------------------
-// Verifica se un timestamp ICS (YYYYMMDD...) è di oggi
-// ---------------------------------------------------------------------------
-static inline bool isTodayStamp(const String &dtstamp, const String &todayYmd) {
-  return (dtstamp.length() >= 8) && dtstamp.startsWith(todayYmd);
-}
+  char day[12] = "";
+  if (!today)
+    snprintf(day, sizeof(day), "%s %d ", (it ? it_wd : en_wd)[lo.tm_wday],
+             lo.tm_mday);
 
-// ---------------------------------------------------------------------------
-// Converte stampo ICS in stringa orario human-readable o "all day"
-// ---------------------------------------------------------------------------
-static inline void humanTimeFromStamp(const String &stamp, String &out) {
-  if (stamp.length() >= 15 && stamp[8] == 'T') {
-    out = stamp.substring(9, 11) + ":" + stamp.substring(11, 13);
-  } else {
-    out = (g_lang == "it" ? "tutto il giorno" : "all day");
-  }
-}
-
-// ---------------------------------------------------------------------------
-// Copia String in buffer char[] con troncamento sicuro
-// ---------------------------------------------------------------------------
-static inline void copyToBuf(const String &s, char *buf, size_t bufLen) {
-  if (!bufLen)
-    return;
-  size_t n = s.length();
-  if (n >= bufLen)
-    n = bufLen - 1;
-  for (size_t i = 0; i < n; i++)
-    buf[i] = (char)s[i];
-  buf[n] = '\0';
+  if (ev.allDay)
+    snprintf(out, outLen, "%s%s", day, it ? "tutto il giorno" : "all day");
+  else
+    snprintf(out, outLen, "%s%02d:%02d", day, lo.tm_hour, lo.tm_min);
 }
 
 // ---------------------------------------------------------------------------
 // fetchICS
-// - scarica il file ICS da g_ics
-// - raccoglie solo gli eventi di oggi in cal[0..2]
+// - scarica g_ics in streaming (nessun body in RAM)
+// - espande le ricorrenze nei prossimi CAL_WINDOW_DAYS giorni
+// - tiene in cal[] i CAL_MAX eventi più vicini, già ordinati
+// - indice nuovo costruito a parte senza lock, copiato in cal[] sotto lock
 // ---------------------------------------------------------------------------
 bool fetchICS() {
-  resetCal();
-
-  if (!g_ics.length())
-    return true;
-
-  String body;
-  if (!httpGET(g_ics, body, 15000))
-    return false;
-
-  String today;
-  todayYMD(today);
-
-  uint8_t idx = 0;
-  int p = 0;
-
-  while (idx < 3) {
-    int b = body.indexOf("BEGIN:VEVENT", p);
-    if (b < 0)
-      break;
-
-    int e = body.indexOf("END:VEVENT", b);
-    if (e < 0)
-      break;
-
-    String blk = body.substring(b, e);
-
-    int ds = indexOfCI(blk, "DTSTART", 0);
-    if (ds < 0) {
-      p = e + 10;
-      continue;
+  String url;
+  {
+    StateLock lock;
+    url = g_ics;
+    if (!url.length()) {
+      cal_count = 0;
+      return true;
     }
+  }
 
-    String rawStart = extractAfterColon(blk, ds);
-    if (!isTodayStamp(rawStart, today)) {
-      p = e + 10;
-      continue;
-    }
-
-    int ss = indexOfCI(blk, "SUMMARY", 0);
-    String summary = (ss >= 0) ? extractAfterColon(blk, ss) : "";
-    if (!summary.length()) {
-      p = e + 10;
-      continue;
-    }
-
-    String whenStr;
-    humanTimeFromStamp(rawStart, whenStr);
-
-    summary = sanitizeText(summary);
-    whenStr = sanitizeText(whenStr);
-
-    struct tm tt = {};
-    if (rawStart.length() >= 8) {
-      tt.tm_year = rawStart.substring(0, 4).toInt() - 1900;
-      tt.tm_mon = rawStart.substring(4, 6).toInt() - 1;
-      tt.tm_mday = rawStart.substring(6, 8).toInt();
-    }
+  // Finestra: da mezzanotte locale di oggi
+  time_t now = time(nullptr);
+  struct tm lo;
+  localtime_r(&now, &lo);
+  lo.tm_hour = lo.tm_min = lo.tm_sec = 0;
+  lo.tm_isdst = -1;
+  const time_t from = mktime(&lo);
+  lo.tm_mday += CAL_WINDOW_DAYS;
+  lo.tm_isdst = -1;
+  const time_t to = mktime(&lo);
+
+  const size_t bytes = sizeof(IcsEntry) * CAL_MAX;
+  IcsEntry *next = (IcsEntry *)heap_caps_malloc(
+      bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (!next)
+    next = (IcsEntry *)malloc(bytes);
+  if (!next)
+    return false;
 
-    bool hasTime = (rawStart.length() >= 15 && rawStart[8] == 'T');
-    if (hasTime) {
-      tt.tm_hour = rawStart.substring(9, 11).toInt();
-      tt.tm_min = rawStart.substring(11, 13).toInt();
-    } else {
-      tt.tm_hour = 0;
-      tt.tm_min = 0;
-    }
+  IcsParser ics(next, CAL_MAX, from, to);
+  const bool ok = httpStream(url, 15000, [&](const char *d, size_t n) {
+    return ics.feed(d, n);
+  });
+  const uint8_t n = ics.finish();
 
-    copyToBuf(whenStr, cal[idx].when, sizeof(cal[idx].when));
-    copyToBuf(summary, cal[idx].summary, sizeof(cal[idx].summary));
-    cal[idx].ts = mktime(&tt);
-    cal[idx].allDay = !hasTime;
-    cal[idx].used = true;
+  // Traslitterazione una volta sola: i render usano l'indice così com'è
+  for (uint8_t i = 0; i < n; i++)
+    tlInPlace(next[i].summary);
 
-    idx++;
-    p = e + 10;
+  {
+    StateLock lock;
+    memcpy(cal, next, sizeof(IcsEntry) * n);
+    cal_count = n;
   }
-
-  return true;
+  free(next);
+  return ok;
 }
 
 // ---------------------------------------------------------------------------
 // pageCalendar
-// - mostra max 3 eventi di oggi in ordine di “prossimità” temporale
-// - usa solo indici su cal[] per ridurre RAM
+// - eventi non ancora terminati, già in ordine di inizio (nessun re-parse)
+// - giorno della settimana davanti all'orario se l'evento non è di oggi
 // ---------------------------------------------------------------------------
 void pageCalendar() {
-  drawHeader(g_lang == "it" ? "Oggi" : "Today");
+  drawHeader(g_lang == "it" ? "Prossimi giorni" : "Upcoming");
 
   // ---------------------------------------------------
   // Icona calendario (RLE)
@@ -256,29 +188,19 @@ void pageCalendar() {
 
   int y = PAGE_Y;
 
-  struct Row {
-    uint8_t idx;
-    time_t ts;
-    long delta;
-    bool allDay;
-  };
-
-  Row rows[3];
+  // Indice già ordinato: solo filtro sugli eventi terminati
+  const int32_t todayDays = svDaysFromCivil(t.tm_year + 1900, t.tm_mon + 1,
+                                            t.tm_mday);
+  uint8_t rows[CAL_MAX];
   uint8_t n = 0;
 
-  for (uint8_t i = 0; i < 3; i++) {
-    if (!cal[i].used || cal[i].summary[0] == '\0')
+  for (uint8_t i = 0; i < cal_count; i++) {
+    // eventi senza durata restano visibili per un'ora dall'inizio
+    if (cal[i].end <= now && cal[i].start + 3600 <= now)
       continue;
-
-    long d = cal[i].allDay ? 0 : (long)difftime(cal[i].ts, now);
-    if (d < 0)
-      d = 86400;
-
-    rows[n].idx = i;
-    rows[n].ts = cal[i].ts;
-    rows[n].delta = d;
-    rows[n].allDay = cal[i].allDay;
-    n++;
+    if (cal[i].summary[0] == '\0')
+      continue;
+    rows[n++] = i;
   }
 
   if (!n) {
@@ -288,18 +210,18 @@ void pageCalendar() {
     return;
   }
 
-  for (uint8_t i = 1; i < n; i++) {
-    Row key = rows[i];
-    int8_t j = i - 1;
-    while (j >= 0 && rows[j].delta > key.delta) {
-      rows[j + 1] = rows[j];
-      j--;
-    }
-    rows[j + 1] = key;
-  }
-
   for (uint8_t i = 0; i < n; i++) {
-    CalItem &ev = cal[rows[i].idx];
+    const IcsEntry &ev = cal[rows[i]];
+
+    struct tm st;
+    localtime_r(&ev.start, &st);
+    const bool today =
+        ev.start <= now ||
+        svDaysFromCivil(st.tm_year + 1900, st.tm_mon + 1, st.tm_mday) ==
+            todayDays;
+
+    char when[24];
+    humanTime(ev, today, when, sizeof(when));
 
     drawBoldMain(PAGE_X, y, String(ev.summary), TEXT_SCALE + 1);
 
@@ -308,7 +230,7 @@ void pageCalendar() {
     gfx->setTextSize(2);
     gfx->setTextColor(COL_TEXT, COL_BG);
     gfx->setCursor(PAGE_X, y);
-    gfx->print(ev.when);
+    gfx->print(when);
 
     y += CHAR_H * 2 + 4;
     gfx->setTextSize(TEXT_SCALE);
@@ -3,7 +3,9 @@
    SQUARED — PAGINA "CHRONOS"
    Descrizione: Calcolo progressi umani (giorno, settimana, mese, anno, secolo)
                 e cosmici (Terra, Sole, Universo) con barre ottimizzate,
-                layout proporzionale 480×480 e timeline cosmica.
+                layout proporzionale 480×480 e timeline cosmica. Righe e
+                barre sono widget: tickChronos() ricalcola ogni secondo e
+                ridisegna solo percentuali e barre che cambiano davvero.
    Autore: Davide “gat” Nasato
    Repository: https://github.com/davidegat/SquaredCoso
    Licenza: CC BY-NC 4.0
@@ -13,6 +15,7 @@
 #pragma once
 
 #include "../handlers/globals.h"
+#include "../handlers/widgets.h"
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 #include <time.h>
@@ -119,83 +122,67 @@ static inline void pctStr(char *buf, float pct, bool dec) {
   }
 }
 
-static void drawBar(int16_t x, int16_t y, int16_t w, int16_t h, float pct,
-                    uint16_t col) {
-  gfx->fillRoundRect(x, y, w, h, 4, CH_BAR_BG);
-
-  int16_t fill = (int16_t)(pct * (w - 4));
-  if (fill > 0) {
-    gfx->fillRoundRect(x + 2, y + 2, fill, h - 4, 3, col);
-  }
-
-  gfx->drawRoundRect(x, y, w, h, 4, CH_SUBTLE);
-}
-
 // ============================================================================
-// Riga human
+// Widget: riga (etichetta + %) e barra per ogni progresso
 // ============================================================================
-static void drawRowH(int16_t y, const __FlashStringHelper *label, float pct,
-                     uint16_t col) {
-  char buf[8];
-  pctStr(buf, pct, false);
-
-  gfx->setTextColor(COL_TEXT);
-  gfx->setCursor(CH_LEFT, y);
-  gfx->print(label);
-
-  gfx->setTextColor(col);
-  gfx->setCursor(CH_RIGHT - txtW(strlen(buf), TEXT_SCALE), y);
-  gfx->print(buf);
-
-  drawBar(CH_LEFT, y + 16, CH_BAR_W, CH_BAR_H, pct, col);
-}
-
-// ============================================================================
-// Riga cosmic
-// ============================================================================
-static void drawRowC(int16_t y, const __FlashStringHelper *label,
-                     const __FlashStringHelper *sub, float pct, uint16_t col) {
-  char buf[8];
-  pctStr(buf, pct, true);
-
-  gfx->setTextColor(COL_TEXT);
-  gfx->setCursor(CH_LEFT, y);
-  gfx->print(label);
-
-  gfx->setTextColor(col);
-  gfx->setCursor(CH_RIGHT - txtW(strlen(buf), TEXT_SCALE), y);
-  gfx->print(buf);
-
-  drawBar(CH_LEFT, y + 16, CH_BAR_W, CH_BAR_H + 2, pct, col);
-
-  gfx->setTextColor(CH_SUBTLE);
-  gfx->setCursor(CH_LEFT, y + 38);
-  gfx->print(sub);
-}
+enum : uint8_t { CH_N_HUMAN = 5, CH_N_COSMIC = 2 };
+enum : uint8_t {
+  CW_HUMAN = 0,                      // riga, barra × 5
+  CW_COSMIC = CW_HUMAN + 2 * CH_N_HUMAN, // riga, barra, sottotitolo × 2
+  CW_N = CW_COSMIC + 3 * CH_N_COSMIC
+};
 
-// ============================================================================
-// Sezione Human
-// ============================================================================
-static void drawHuman(const ChProg &p) {
-  gfx->setTextSize(TEXT_SCALE);
+static constexpr uint32_t CH_TICK_MS = 1000;
+
+static Widget chW[CW_N];
+static WgTree chUi = {chW, CW_N, 0, CH_BG};
+static WgStyle chRow, chSub;
+static constexpr WgStyle CH_BAR = {CH_BAR_BG, 0, CH_SUBTLE, 0, 0, 0, 4, 0};
+
+static void buildChronosUi() {
+  static const char *const HUMAN[CH_N_HUMAN] = {"Today", "Week", "Month",
+                                                "Year", "Century"};
+  chRow = {CH_BG, COL_TEXT, 0, 0, 0, 0, 0, (uint8_t)TEXT_SCALE};
+  chSub = {CH_BG, CH_SUBTLE, 0, 0, 0, 0, 0, (uint8_t)TEXT_SCALE};
+
+  for (uint8_t i = 0; i < CH_N_HUMAN; i++) {
+    const int16_t y = SEC_HUMAN_Y + CH_ROW_H * i;
+    const uint16_t col = i < 3 ? COL_ACCENT1 : COL_ACCENT2;
+    wgText(wgAdd(chUi, WG_ROW, CH_LEFT, y, CH_BAR_W, 16, &chRow), HUMAN[i]);
+    wgAdd(chUi, WG_BAR, CH_LEFT, y + 16, CH_BAR_W, CH_BAR_H, &CH_BAR);
+    chW[CW_HUMAN + 2 * i].color = chW[CW_HUMAN + 2 * i + 1].color = col;
+  }
 
-  int16_t y = SEC_HUMAN_Y;
-  drawRowH(y, F("Today"), p.day, COL_ACCENT1);
-  drawRowH(y + CH_ROW_H, F("Week"), p.week, COL_ACCENT1);
-  drawRowH(y + CH_ROW_H * 2, F("Month"), p.month, COL_ACCENT1);
-  drawRowH(y + CH_ROW_H * 3, F("Year"), p.year, COL_ACCENT2);
-  drawRowH(y + CH_ROW_H * 4, F("Century"), p.century, COL_ACCENT2);
+  static const char *const COSMIC[CH_N_COSMIC][2] = {
+      {"Earth", "4.54 / 10 Ga"}, {"Sun", "4.6 / 10 Ga"}};
+  static const float PCT[CH_N_COSMIC] = {PCT_EARTH, PCT_SUN};
+  for (uint8_t i = 0; i < CH_N_COSMIC; i++) {
+    const int16_t y = SEC_COSMIC_Y + CH_ROW_H_C * i;
+    const uint16_t col = i ? COL_ACCENT1 : COL_ACCENT2;
+    Widget &row = wgAdd(chUi, WG_ROW, CH_LEFT, y, CH_BAR_W, 16, &chRow);
+    Widget &bar =
+        wgAdd(chUi, WG_BAR, CH_LEFT, y + 16, CH_BAR_W, CH_BAR_H + 2, &CH_BAR);
+    wgText(wgAdd(chUi, WG_LABEL, CH_LEFT, y + 38, CH_BAR_W, 16, &chSub),
+           COSMIC[i][1]);
+
+    char buf[8];
+    pctStr(buf, PCT[i], true);
+    wgText(row, COSMIC[i][0]);
+    wgVal(row, buf);
+    wgBar(bar, (uint16_t)(PCT[i] * 1000.0f));
+    row.color = bar.color = col;
+  }
 }
 
-// ============================================================================
-// Sezione Cosmic
-// ============================================================================
-static void drawCosmic() {
-  gfx->setTextSize(TEXT_SCALE);
-
-  drawRowC(SEC_COSMIC_Y, F("Earth"), F("4.54 / 10 Ga"), PCT_EARTH, COL_ACCENT2);
-  drawRowC(SEC_COSMIC_Y + CH_ROW_H_C, F("Sun"), F("4.6 / 10 Ga"), PCT_SUN,
-           COL_ACCENT1);
+// Progressi → widget: sporchi solo testo o riempimento cambiati
+static void syncChronosUi(const ChProg &p) {
+  const float v[CH_N_HUMAN] = {p.day, p.week, p.month, p.year, p.century};
+  for (uint8_t i = 0; i < CH_N_HUMAN; i++) {
+    char buf[8];
+    pctStr(buf, v[i], false);
+    wgVal(chW[CW_HUMAN + 2 * i], buf);
+    wgBar(chW[CW_HUMAN + 2 * i + 1], (uint16_t)(v[i] * 1000.0f));
+  }
 }
 
 // ============================================================================
@@ -253,16 +240,33 @@ static void drawUniverse() {
 // ============================================================================
 // Pagina principale
 // ============================================================================
+static uint32_t chTickMs = 0;
+
 inline void pageChronos() {
+  if (!chUi.n)
+    buildChronosUi();
+
   gfx->fillScreen(CH_BG);
   drawHeader(F("CHRONOS"));
 
-  gfx->setTextSize(TEXT_SCALE);
-
   ChProg p;
   calcProgress(p);
+  syncChronosUi(p);
+  wgInvalidate(chUi);
+  wgRender(chUi);
 
-  drawHuman(p);
-  drawCosmic();
   drawUniverse();
+  chTickMs = millis();
+}
+
+// Pagina a schermo: una barra cresce di un pixel ogni ~200 s (giorno)
+static void tickChronos() {
+  if (!chUi.n || millis() - chTickMs < CH_TICK_MS)
+    return;
+  chTickMs = millis();
+
+  ChProg p;
+  calcProgress(p);
+  syncChronosUi(p);
+  wgRender(chUi);
 }
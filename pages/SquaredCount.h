@@ -13,6 +13,7 @@
 #pragma once
 
 #include "../handlers/globals.h"
+#include "../handlers/strview.h"
 #include <Arduino.h>
 #include <time.h>
 
@@ -31,7 +32,6 @@ extern const int CHAR_H;
 extern void drawHeader(const String &title);
 extern void drawBoldMain(int16_t x, int16_t y, const String &raw,
                          uint8_t scale);
-extern String sanitizeText(const String &in);
 
 extern CDEvent cd[8];
 extern String g_lang;
@@ -54,21 +54,12 @@ static constexpr uint8_t SNK_FADE = 4;
 // ---------------------------------------------------------------------------
 // Parsing ISO "YYYY-MM-DD HH:MM" → time_t (ottimizzato)
 // ---------------------------------------------------------------------------
-static bool parseISO(const String &iso, time_t &out) {
-  if (iso.length() < 16)
+static bool parseISO(StrView iso, time_t &out) {
+  IsoTime t;
+  if (!svParseIso8601(iso, t).ok || !t.hasTime)
     return false;
 
-  const char *s = iso.c_str();
-
-  struct tm t = {};
-  t.tm_year = (s[0] - '0') * 1000 + (s[1] - '0') * 100 + (s[2] - '0') * 10 +
-              (s[3] - '0') - 1900;
-  t.tm_mon = (s[5] - '0') * 10 + (s[6] - '0') - 1;
-  t.tm_mday = (s[8] - '0') * 10 + (s[9] - '0');
-  t.tm_hour = (s[11] - '0') * 10 + (s[12] - '0');
-  t.tm_min = (s[14] - '0') * 10 + (s[15] - '0');
-
-  out = mktime(&t);
+  out = isoEpoch(t);
   return out > 0;
 }
 
@@ -173,7 +164,7 @@ void pageCountdowns() {
     // 1) Nome
     gfx->setTextColor(COL_ACCENT1, COL_BG);
     gfx->setCursor(x, y + CHAR_H);
-    gfx->print(sanitizeText(nm));
+    gfx->print(nm);
 
     // 2) Data
     int16_t y_date = y + CHAR_H * 2 + 2;
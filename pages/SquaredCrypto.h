@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
+#include "../handlers/jsonhelpers.h"
 #include <Arduino.h>
 
 extern Arduino_RGB_Display *gfx;
@@ -34,9 +36,7 @@ extern String g_fiat;
 extern double g_btc_owned;
 
 extern bool httpGET(const String &url, String &out, uint32_t timeout);
-extern int indexOfCI(const String &src, const String &key, int from);
 extern void drawHeader(const String &title);
-extern bool jsonNum(const String &src, const char *key, float &out, int from);
 
 // ---------------------------------------------------------------------------
 // Colori tema crypto
@@ -189,10 +189,13 @@ static void drawTrendArrow(int16_t x, int16_t y, bool up, uint16_t col) {
 // Fetch da CoinGecko (ottimizzato)
 // ---------------------------------------------------------------------------
 static bool fetchCrypto() {
-  if (!g_fiat.length())
-    g_fiat = F("CHF");
-
-  String fiat = g_fiat;
+  String fiat;
+  {
+    StateLock lock;
+    if (!g_fiat.length())
+      g_fiat = F("CHF");
+    fiat = g_fiat;
+  }
   fiat.toLowerCase();
 
   String url = F("https://api.coingecko.com/api/v3/simple/"
@@ -204,22 +207,22 @@ static bool fetchCrypto() {
   if (!httpGET(url, body, 10000))
     return false;
 
-  int16_t b = indexOfCI(body, F("\"bitcoin\""), 0);
-  if (b < 0)
-    return false;
+  // bitcoin.<fiat> e bitcoin.<fiat>_24h_change in una passata
+  char pathPrice[24];
+  char pathChg[40];
+  snprintf_P(pathPrice, sizeof(pathPrice), PSTR("bitcoin.%s"), fiat.c_str());
+  snprintf_P(pathChg, sizeof(pathChg), PSTR("bitcoin.%s_24h_change"),
+             fiat.c_str());
 
-  float priceF = NAN;
-  if (!jsonNum(body, fiat.c_str(), priceF, b))
+  float priceF, pctF;
+  JsonQuery q[] = {jqFloat(pathPrice, priceF), jqFloat(pathChg, pctF)};
+  jsonExtract(body, q, 2);
+
+  if (!q[0].count)
     return false;
 
+  StateLock lock;
   cr_price = priceF;
-
-  // 24h change
-  char keyBuf[20];
-  snprintf_P(keyBuf, sizeof(keyBuf), PSTR("%s_24h_change"), fiat.c_str());
-
-  float pctF = NAN;
-  jsonNum(body, keyBuf, pctF, b);
   cr_chg24 = pctF;
 
   cr_last_update_ms = millis();
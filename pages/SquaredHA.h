@@ -1,9 +1,14 @@
 /*
 ===============================================================================
    SQUARED — PAGINA "HOME ASSISTANT"
-   Descrizione: Scansione entità HA via API, filtro intelligente (no sun,
-                battery/temp/humidity, on/off), parsing compatto JSON senza
-                allocazioni inutili, rendering ottimizzato fino a 17 entità.
+   Descrizione: Entità HA via WebSocket (get_states iniziale + eventi
+                state_changed), REST /api/states come ripiego. Con una
+                lista entità configurata (g_ha_ents, set di hash) get_states
+                filtrato dal set, nell'ordine della lista; il ripiego REST
+                legge /api/states/<entity_id> una entità per giro di loop.
+                Altrimenti filtro intelligente (no sun, battery/temp/
+                humidity, on/off). Firma per riga: si ridisegnano solo le
+                righe cambiate, fino a 17 entità. IP da mDNS in cache.
    Autore: Davide “gat” Nasato
    Repository: https://github.com/davidegat/SquaredCoso
    Licenza: CC BY-NC 4.0
@@ -15,10 +20,14 @@
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 #include <ESPmDNS.h>
-#include <HTTPClient.h>
 #include <WiFi.h>
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
+#include "../handlers/httpstream.h"
+#include "../handlers/jsonhelpers.h"
+#include "../handlers/translit.h"
+#include "../handlers/websocket.h"
 
 // ============================================================================
 // EXTERN
@@ -39,6 +48,8 @@ static constexpr uint16_t HA_OFF_COL = 0x03E0;
 static constexpr uint16_t HA_ON_COL = 0x07E0;
 
 struct HAEntry {
+  uint32_t id;  // hash entity_id (match eventi state_changed)
+  uint32_t sig; // hash di id/nome/stato/flag: cambia → riga da ridisegnare
   char name[HA_NAME_LEN];
   char state[HA_STATE_LEN];
   uint8_t flags;
@@ -54,9 +65,43 @@ static constexpr uint8_t HA_F_TEMPH = 0x04;
 // ============================================================================
 static HAEntry ha_entries[HA_MAX_ENTRIES];
 static uint8_t ha_count = 0;
-static uint32_t ha_nextPollMs = 0;
+static uint8_t ha_loadN = 0; // righe scritte dal caricamento in corso
 static char ha_ip[16];
 
+// Lista entità configurata: set di hash a indirizzamento aperto
+static constexpr uint8_t HA_ALLOW_SLOTS = 32; // potenza di 2, > HA_MAX_ENTRIES
+static uint32_t ha_allowKey[HA_ALLOW_SLOTS];  // 0 = slot libero
+static uint8_t ha_allowRank[HA_ALLOW_SLOTS];  // posizione nella lista
+static uint8_t ha_allowCount = 0;
+static uint32_t ha_allowSrc = 0; // hash di g_ha_ents già compilato
+
+// Cache mDNS (solo con g_ha_ip vuoto)
+static constexpr uint32_t HA_MDNS_TTL_MS = 1800000; // risultato valido 30 min
+static constexpr uint32_t HA_MDNS_RETRY_MS = 60000; // dopo una query a vuoto
+static uint32_t ha_mdnsMs = 0;
+static uint8_t ha_mdnsState = 0; // 0 = mai, 1 = trovato, 2 = non trovato
+
+// Righe da ridisegnare (bit i = ha_entries[i])
+static uint32_t ha_rowDirty = 0;
+
+// WebSocket
+static constexpr uint32_t HA_WS_RETRY_MIN = 15000;
+static constexpr uint32_t HA_WS_RETRY_MAX = 300000;
+static constexpr uint32_t HA_WS_IDLE_MS = 90000; // nessun byte: riconnessione
+
+enum HaWsStage : uint8_t { HWS_OFF = 0, HWS_CONNECT, HWS_AUTH, HWS_LIVE };
+
+static WsClient ha_ws;
+static uint8_t ha_wsStage = HWS_OFF;
+static uint32_t ha_wsRetryMs = 0;
+static uint32_t ha_wsBackoff = HA_WS_RETRY_MIN;
+static uint32_t ha_wsPingMs = 0;
+static uint32_t ha_wsId = 0; // id messaggi client (crescente per sessione)
+
+// Lettura REST della lista configurata in corso: una entità per chiamata
+static bool ha_listBusy = false;
+static uint16_t ha_listPos = 0; // offset in g_ha_ents della prossima entità
+
 // Bitfield per flag globali
 static struct {
   uint8_t ready : 1;
@@ -72,26 +117,26 @@ static struct {
 static bool hasCI(const char *hay, const char *needle) {
   if (!hay || !needle)
     return false;
-
-  const uint8_t nlen = strlen(needle);
-  const uint8_t hlen = strlen(hay);
-  if (nlen > hlen)
-    return false;
-
-  for (uint8_t i = 0; i <= hlen - nlen; i++) {
-    uint8_t j = 0;
-    while (j < nlen && tolower(hay[i + j]) == tolower(needle[j]))
-      j++;
-    if (j == nlen)
-      return true;
-  }
-  return false;
+  return ssFindCI(hay, strlen(hay), needle, strlen(needle)) >= 0;
 }
 
 static inline bool hasCI(const String &s, const char *needle) {
   return hasCI(s.c_str(), needle);
 }
 
+// FNV-1a; mai 0 (0 = slot libero nel set)
+static inline uint32_t haHash(const char *s, uint32_t h = 2166136261u) {
+  while (*s)
+    h = (h ^ (uint8_t)*s++) * 16777619u;
+  return h ? h : 1;
+}
+
+static inline uint32_t haSig(const HAEntry &e) {
+  uint32_t h = haHash(e.name, e.id ^ e.flags);
+  h = (h ^ 0x1F) * 16777619u; // separatore nome/stato
+  return haHash(e.state, h);
+}
+
 static bool isBattId(const char *id) {
   return hasCI(id, "battery") || hasCI(id, "batteria") ||
          strstr(id, "_bat") != nullptr;
@@ -168,10 +213,67 @@ static void normState(char *dest, uint8_t destSize, const char *raw) {
   dest[len] = 0;
 }
 
+// ============================================================================
+// LISTA ENTITÀ (g_ha_ents: entity_id separati da virgola, spazio o a capo)
+// ============================================================================
+static bool haNextEnt(const char *&p, char *out, uint8_t cap) {
+  while (*p == ',' || *p == ';' || isspace((uint8_t)*p))
+    p++;
+  if (!*p)
+    return false;
+
+  uint8_t n = 0;
+  while (*p && *p != ',' && *p != ';' && !isspace((uint8_t)*p)) {
+    if (n < cap - 1)
+      out[n++] = *p;
+    p++;
+  }
+  out[n] = 0;
+  return true;
+}
+
+static int8_t haAllowSlot(uint32_t h) {
+  uint8_t s = h & (HA_ALLOW_SLOTS - 1);
+  while (ha_allowKey[s]) {
+    if (ha_allowKey[s] == h)
+      return s;
+    s = (s + 1) & (HA_ALLOW_SLOTS - 1);
+  }
+  return -(int8_t)s - 1; // slot libero per l'inserimento
+}
+
+// Ricompila il set se g_ha_ents è cambiata; true se è stato ricompilato
+static bool haAllowSync() {
+  StateLock lock; // g_ha_ents cambia dalla WebUI
+  const uint32_t src = haHash(g_ha_ents.c_str());
+  if (src == ha_allowSrc)
+    return false;
+  ha_allowSrc = src;
+  ha_listBusy = false; // lettura a metà di una lista che non c'è più
+
+  memset(ha_allowKey, 0, sizeof(ha_allowKey));
+  ha_allowCount = 0;
+
+  const char *p = g_ha_ents.c_str();
+  char id[48];
+  while (ha_allowCount < HA_MAX_ENTRIES && haNextEnt(p, id, sizeof(id))) {
+    const int8_t s = haAllowSlot(haHash(id));
+    if (s >= 0)
+      continue; // duplicato
+    ha_allowKey[-s - 1] = haHash(id);
+    ha_allowRank[-s - 1] = ha_allowCount++;
+  }
+  return true;
+}
+
 // ============================================================================
 // FILTRO ENTITÀ
 // ============================================================================
 static bool allowEnt(const char *id, const char *fname) {
+  // Lista configurata: solo le entità elencate
+  if (ha_allowCount)
+    return haAllowSlot(haHash(id)) >= 0;
+
   // Escludi sun
   if (hasCI(id, "sun") || hasCI(fname, "sun"))
     return false;
@@ -202,182 +304,564 @@ static bool allowEnt(const char *id, const char *fname) {
 // ============================================================================
 // DISCOVERY
 // ============================================================================
+// Query mDNS solo a cache scaduta: la risposta può richiedere secondi
 static bool discoverHA() {
+  const uint32_t now = millis();
+  if (ha_mdnsState == 1 && now - ha_mdnsMs < HA_MDNS_TTL_MS)
+    return true;
+  if (ha_mdnsState == 2 && now - ha_mdnsMs < HA_MDNS_RETRY_MS)
+    return false;
+
+  ha_mdnsMs = now;
   int8_t n = MDNS.queryService("_home-assistant", "_tcp");
   if (n > 0) {
     IPAddress ip = MDNS.IP(0);
     snprintf_P(ha_ip, sizeof(ha_ip), PSTR("%d.%d.%d.%d"), ip[0], ip[1], ip[2],
                ip[3]);
+    ha_mdnsState = 1;
     return true;
   }
   ha_ip[0] = 0;
+  ha_mdnsState = 2;
   return false;
 }
 
+// IP da configurazione o mDNS
+static bool haResolveIp() {
+  {
+    StateLock lock;
+    if (g_ha_ip.length() > 0) {
+      strncpy(ha_ip, g_ha_ip.c_str(), sizeof(ha_ip) - 1);
+      ha_ip[sizeof(ha_ip) - 1] = 0;
+      return ha_ip[0] != 0;
+    }
+  }
+  return discoverHA() && ha_ip[0] != 0; // mDNS senza lock
+}
+
+// HA non raggiungibile all'indirizzo in cache: nuova query al prossimo giro
+static inline void haForgetIp() {
+  if (ha_mdnsState == 1)
+    ha_mdnsState = 0;
+}
+
 // ============================================================================
 // JSON PARSING
 // ============================================================================
-static int16_t extractJson(const String &body, int16_t start, const char *key,
-                           char *dest, uint8_t destSize) {
-  int16_t p = body.indexOf(key, start);
-  if (p < 0)
-    return -1;
+// Campi stringa di un oggetto entità; attributes.friendly_name incluso.
+static void haReadEntity(JsonPull &jp, char *id, uint8_t idSize, char *state,
+                         uint8_t stateSize, char *fname, uint8_t fnameSize) {
+  id[0] = state[0] = fname[0] = 0;
+
+  while (jp.next() == JT_KEY) {
+    if (jp.keyIs("entity_id")) {
+      jp.str(id, idSize);
+    } else if (jp.keyIs("state")) {
+      jp.str(state, stateSize);
+    } else if (jp.keyIs("attributes")) {
+      if (jp.next() != JT_OBJ)
+        continue;
+      while (jp.next() == JT_KEY) {
+        if (jp.keyIs("friendly_name"))
+          jp.str(fname, fnameSize);
+        else
+          jp.skip();
+      }
+    } else {
+      jp.skip();
+    }
+  }
+}
 
-  int16_t q1 = body.indexOf('"', p + strlen(key));
-  if (q1 < 0)
-    return -1;
+// ============================================================================
+// ENTRY
+// ============================================================================
+static bool haInvalidState(const char *st) {
+  return strcmp(st, "unknown") == 0 || strcmp(st, "unavailable") == 0;
+}
 
-  int16_t q2 = body.indexOf('"', q1 + 1);
-  if (q2 < 0)
-    return -1;
+// Riempie e da id/stato/nome grezzi (fname può essere modificato)
+static void haFill(HAEntry &e, const char *id, const char *st, char *fname,
+                   uint8_t fnameSize) {
+  e.id = haHash(id);
+  e.flags = 0;
 
-  uint8_t len = q2 - q1 - 1;
-  if (len >= destSize)
-    len = destSize - 1;
+  // Friendly name (traslitterato qui: il render stampa così com'è)
+  if (!fname[0]) {
+    strncpy(fname, id, fnameSize - 1);
+    fname[fnameSize - 1] = 0;
+  }
+  tlInPlace(fname);
+
+  // Battery
+  if (isBattId(id) || isBattState(st)) {
+    e.flags |= HA_F_BATT;
+    // Aggiungi suffisso
+    uint8_t flen = strlen(fname);
+    if (flen < fnameSize - 8) {
+      strcpy_P(fname + flen, PSTR(" (Batt)"));
+    }
+  }
 
-  const char *src = body.c_str() + q1 + 1;
-  memcpy(dest, src, len);
-  dest[len] = 0;
+  // Temp/Hum
+  if (isTempHum(id))
+    e.flags |= HA_F_TEMPH;
 
-  return q2 + 1;
+  // On/Off
+  if (strcasecmp(st, "on") == 0 || strcasecmp(st, "off") == 0) {
+    e.flags |= HA_F_ONOFF;
+  }
+
+  copyTrim3(e.name, HA_NAME_LEN, fname);
+  normState(e.state, HA_STATE_LEN, st);
+  e.sig = haSig(e);
 }
 
-// ============================================================================
-// FETCH STATI
-// ============================================================================
-static bool fetchHAStates() {
-  ha_count = 0;
-  ha_flags.ready = 0;
+// ----------------------------------------------------------------------------
+// Caricamento completo: righe riscritte in ordine, segnate sporche solo se
+// la firma cambia; numero di righe diverso → ridisegno completo
+// ----------------------------------------------------------------------------
+static inline void haLoadBegin() { ha_loadN = 0; }
 
-  if (g_ha_token.length() == 0)
-    return false;
+static void haLoadPut(const HAEntry &next) {
+  const uint8_t i = ha_loadN++;
+  if (i < ha_count && ha_entries[i].sig == next.sig)
+    return;
+  ha_entries[i] = next;
+  ha_rowDirty |= 1UL << i;
+}
 
-  // IP
-  if (g_ha_ip.length() > 0) {
-    strncpy(ha_ip, g_ha_ip.c_str(), sizeof(ha_ip) - 1);
-    ha_ip[sizeof(ha_ip) - 1] = 0;
-  } else if (!discoverHA()) {
-    return false;
+static void haLoadEnd() {
+  if (!ha_flags.ready || ha_loadN != ha_count) {
+    ha_flags.dirty = 1;
+    ha_rowDirty = 0;
   }
+  ha_count = ha_loadN;
+  ha_flags.ready = 1;
+}
 
-  if (ha_ip[0] == 0)
-    return false;
+// Lista completa [ {entity_id, state, attributes}, … ] (REST o get_states).
+// Con una lista configurata: solo le entità elencate, nell'ordine della
+// lista, anche se non disponibili ("--"). Parsing senza lock, StateLock
+// solo per pubblicare le righe.
+static void haLoadList(JsonPull &jp) {
+  char idBuf[48];
+  char stateBuf[24];
+  char fnameBuf[48];
 
-  // HTTP
-  HTTPClient http;
-  http.setTimeout(3000);
-  http.setReuse(false);
+  HAEntry got[HA_MAX_ENTRIES];
+  uint8_t rank[HA_MAX_ENTRIES]; // posizione nella lista configurata
+  uint8_t nGot = 0;
 
-  char url[48];
-  snprintf_P(url, sizeof(url), PSTR("http://%s:8123/api/states"), ha_ip);
+  while (nGot < HA_MAX_ENTRIES && jp.next() == JT_OBJ) {
+    haReadEntity(jp, idBuf, sizeof(idBuf), stateBuf, sizeof(stateBuf),
+                 fnameBuf, sizeof(fnameBuf));
 
-  http.begin(url);
+    if (!idBuf[0] || !stateBuf[0])
+      continue;
 
-  String authHeader = F("Bearer ");
-  authHeader += g_ha_token;
-  http.addHeader(F("Authorization"), authHeader);
+    uint8_t r = nGot;
+    if (ha_allowCount) {
+      const int8_t slot = haAllowSlot(haHash(idBuf));
+      if (slot < 0)
+        continue;
+      // entità scelta esplicitamente: visibile anche se non disponibile
+      if (haInvalidState(stateBuf))
+        strcpy_P(stateBuf, PSTR("--"));
+      r = ha_allowRank[slot];
+    } else {
+      // Skip invalidi
+      if (haInvalidState(stateBuf))
+        continue;
 
-  int16_t code = http.GET();
-  if (code != 200) {
-    http.end();
-    return false;
-  }
+      // Filtro
+      if (!allowEnt(idBuf, fnameBuf[0] ? fnameBuf : idBuf))
+        continue;
+    }
 
-  String body = http.getString();
-  http.end();
+    uint8_t i = nGot++;
+    for (; i > 0 && rank[i - 1] > r; i--) {
+      got[i] = got[i - 1];
+      rank[i] = rank[i - 1];
+    }
+    haFill(got[i], idBuf, stateBuf, fnameBuf, sizeof(fnameBuf));
+    rank[i] = r;
+  }
 
-  if (body.length() < 30)
-    return false;
+  StateLock lock;
+  ha_listBusy = false; // dati completi: lettura mirata superflua
+  haLoadBegin();
+  for (uint8_t i = 0; i < nGot; i++)
+    haLoadPut(got[i]);
+  haLoadEnd();
+}
 
-  // Buffer parsing
+// new_state di un evento: aggiorna solo la riga interessata
+static void haApplyState(JsonPull &jp) {
   char idBuf[48];
   char stateBuf[24];
   char fnameBuf[48];
 
-  int16_t pos = 0;
+  haReadEntity(jp, idBuf, sizeof(idBuf), stateBuf, sizeof(stateBuf), fnameBuf,
+               sizeof(fnameBuf));
+  if (!idBuf[0] || !stateBuf[0])
+    return;
 
-  while (ha_count < HA_MAX_ENTRIES) {
-    pos = extractJson(body, pos, "\"entity_id\"", idBuf, sizeof(idBuf));
-    if (pos < 0)
-      break;
+  StateLock lock;
+  const uint32_t h = haHash(idBuf);
+  uint8_t i = 0;
+  while (i < ha_count && ha_entries[i].id != h)
+    i++;
+
+  const bool added = (i == ha_count);
+  if (added) {
+    // entità nuova: in coda se c'è posto e passa il filtro
+    if (ha_count >= HA_MAX_ENTRIES || haInvalidState(stateBuf) ||
+        !allowEnt(idBuf, fnameBuf[0] ? fnameBuf : idBuf))
+      return;
+    ha_count++;
+  } else if (haInvalidState(stateBuf)) {
+    strcpy_P(stateBuf, PSTR("--"));
+  }
 
-    int16_t statePos =
-        extractJson(body, pos, "\"state\"", stateBuf, sizeof(stateBuf));
-    if (statePos < 0)
-      continue;
+  HAEntry next;
+  haFill(next, idBuf, stateBuf, fnameBuf, sizeof(fnameBuf));
 
-    // Skip invalidi
-    if (strcmp(stateBuf, "unknown") == 0 ||
-        strcmp(stateBuf, "unavailable") == 0) {
-      pos = statePos;
-      continue;
-    }
+  HAEntry &e = ha_entries[i];
+  if (!added && e.sig == next.sig)
+    return; // solo attributi cambiati
 
-    // Friendly name
-    strcpy(fnameBuf, idBuf);
+  e = next;
+  ha_rowDirty |= 1UL << i;
+}
 
-    int16_t attrPos = body.indexOf(F("\"attributes\""), statePos);
-    if (attrPos > 0 && attrPos < statePos + 500) {
-      extractJson(body, attrPos, "\"friendly_name\"", fnameBuf,
-                  sizeof(fnameBuf));
+// ============================================================================
+// FETCH STATI (REST, ripiego quando il WebSocket non è disponibile)
+// ============================================================================
+// Lista configurata: una GET /api/states/<entity_id> per chiamata,
+// nell'ordine della lista, così il loop non resta fermo su 17 richieste di
+// fila. Il primo passo apre il caricamento, l'ultimo lo chiude; le righe
+// lette compaiono subito. Entità inesistenti (404) saltate; errore di rete
+// → stop, le righe già lette restano valide.
+static bool fetchHAListed(const String &token) {
+  char url[96];
+  char ent[48];
+  char idBuf[48];
+  char stateBuf[24];
+  char fnameBuf[48];
+  HAEntry next;
+  String body;
+
+  {
+    StateLock lock; // g_ha_ents e righe condivise con la WebUI
+    if (!ha_listBusy) {
+      haLoadBegin();
+      ha_listPos = 0;
+      ha_listBusy = true;
     }
 
-    // Filtro
-    if (!allowEnt(idBuf, fnameBuf)) {
-      pos = statePos;
-      continue;
+    const char *base = g_ha_ents.c_str();
+    const char *p = base + ha_listPos;
+    bool dup = true;
+    while (dup) {
+      if (ha_loadN >= HA_MAX_ENTRIES || !haNextEnt(p, ent, sizeof(ent))) {
+        ha_listBusy = false;
+        haLoadEnd();
+        return true;
+      }
+      const uint32_t h = haHash(ent);
+      dup = false;
+      for (uint8_t i = 0; i < ha_loadN && !dup; i++)
+        dup = (ha_entries[i].id == h);
     }
+    ha_listPos = p - base;
+  }
 
-    // Entry
-    HAEntry &e = ha_entries[ha_count];
-    e.flags = 0;
-
-    // Battery
-    if (isBattId(idBuf) || isBattState(stateBuf)) {
-      e.flags |= HA_F_BATT;
-      // Aggiungi suffisso
-      uint8_t flen = strlen(fnameBuf);
-      if (flen < sizeof(fnameBuf) - 8) {
-        strcpy_P(fnameBuf + flen, PSTR(" (Batt)"));
-      }
+  snprintf_P(url, sizeof(url), PSTR("http://%s:8123/api/states/%s"), ha_ip,
+             ent);
+
+  int code = 0;
+  bool full = true; // concat fallito: body troncato
+  if (!httpStream(url, 3000,
+                  [&](const char *d, size_t n) {
+                    return full = body.concat(d, n);
+                  },
+                  token.c_str(), &code) ||
+      !full) {
+    if (code <= 0 || code == 401) {
+      ha_listBusy = false;
+      return false;
     }
+    return true;
+  }
 
-    // Temp/Hum
-    if (isTempHum(idBuf))
-      e.flags |= HA_F_TEMPH;
+  JsonPull jp(body);
+  if (jp.next() != JT_OBJ)
+    return true;
+  haReadEntity(jp, idBuf, sizeof(idBuf), stateBuf, sizeof(stateBuf), fnameBuf,
+               sizeof(fnameBuf));
+  if (!idBuf[0] || !stateBuf[0])
+    return true;
 
-    // On/Off
-    if (strcasecmp(stateBuf, "on") == 0 || strcasecmp(stateBuf, "off") == 0) {
-      e.flags |= HA_F_ONOFF;
-    }
+  // entità scelta esplicitamente: visibile anche se non disponibile
+  if (haInvalidState(stateBuf))
+    strcpy_P(stateBuf, PSTR("--"));
 
-    copyTrim3(e.name, HA_NAME_LEN, fnameBuf);
-    normState(e.state, HA_STATE_LEN, stateBuf);
+  haFill(next, idBuf, stateBuf, fnameBuf, sizeof(fnameBuf));
+  StateLock lock;
+  haLoadPut(next);
+  return true;
+}
 
-    ha_count++;
-    pos = statePos;
-  }
+// Senza lista: dump completo /api/states filtrato da allowEnt()
+static bool fetchHAAll(const String &token) {
+  // HTTP (streaming, gzip se il proxy davanti a HA lo offre)
+  char url[48];
+  snprintf_P(url, sizeof(url), PSTR("http://%s:8123/api/states"), ha_ip);
 
-  ha_flags.ready = 1;
-  ha_flags.dirty = 1;
+  String body;
+  bool full = true; // concat fallito: body troncato
+  if (!httpStream(url, 3000,
+                  [&](const char *d, size_t n) {
+                    return full = body.concat(d, n);
+                  },
+                  token.c_str()) ||
+      !full)
+    return false;
+
+  if (body.length() < 30)
+    return false;
+
+  JsonPull jp(body);
+  if (jp.next() != JT_ARR)
+    return false;
+
+  haLoadList(jp);
   return true;
 }
 
+// Senza StateLock attorno: token copiato sotto lock, rete fuori, righe
+// pubblicate sotto lock
+static bool fetchHAStates() {
+  String token;
+  {
+    StateLock lock;
+    token = g_ha_token;
+  }
+  if (token.length() == 0)
+    return false;
+
+  if (!haResolveIp())
+    return false;
+
+  haAllowSync();
+  const bool ok = ha_allowCount ? fetchHAListed(token) : fetchHAAll(token);
+  if (!ok)
+    haForgetIp();
+  return ok;
+}
+
 // ============================================================================
-// TICK
+// WEBSOCKET
 // ============================================================================
-void tickHA() {
-  uint32_t now = millis();
-  if (now >= ha_nextPollMs) {
-    ha_nextPollMs = now + 1000;
-    if (fetchHAStates())
-      ha_flags.dirty = 1;
+// Dump di tutti gli stati; il risultato passa da haLoadList()
+static void haWsGetStates() {
+  char req[48];
+  snprintf_P(req, sizeof(req), PSTR("{\"id\":%lu,\"type\":\"get_states\"}"),
+             (unsigned long)++ha_wsId);
+  ha_ws.sendText(req, strlen(req));
+}
+
+// Messaggi HA: auth_required / auth_ok / auth_invalid / result / event
+static void haOnMessage(const char *d, size_t n) {
+  JsonPull jp(d, n);
+  if (jp.next() != JT_OBJ)
+    return;
+
+  char type[16] = "";
+
+  while (jp.next() == JT_KEY) {
+    if (jp.keyIs("type")) {
+      jp.str(type, sizeof(type));
+    } else if (jp.keyIs("result")) {
+      // solo get_states ha un array come risultato
+      const char *save = jp.p;
+      const uint8_t dep = jp.depth;
+      if (jp.next() == JT_ARR) {
+        haLoadList(jp);
+        return;
+      }
+      jp.p = save;
+      jp.depth = dep;
+      jp.skip();
+    } else if (jp.keyIs("event")) {
+      // event.data.new_state
+      if (jp.next() != JT_OBJ)
+        continue;
+      while (jp.next() == JT_KEY) {
+        if (!jp.keyIs("data")) {
+          jp.skip();
+          continue;
+        }
+        if (jp.next() != JT_OBJ)
+          continue;
+        while (jp.next() == JT_KEY) {
+          if (jp.keyIs("new_state")) {
+            if (jp.next() == JT_OBJ)
+              haApplyState(jp);
+          } else {
+            jp.skip();
+          }
+        }
+      }
+    } else {
+      jp.skip();
+    }
+  }
+
+  if (!strcmp(type, "auth_required")) {
+    String m = F("{\"type\":\"auth\",\"access_token\":\"");
+    {
+      StateLock lock;
+      m += g_ha_token;
+    }
+    m += F("\"}");
+    ha_ws.sendText(m);
+  } else if (!strcmp(type, "auth_ok")) {
+    // valori iniziali (anche della lista configurata, filtrata dal set)
+    ha_wsId = 0;
+    haWsGetStates();
+    char sub[80];
+    snprintf_P(sub, sizeof(sub),
+               PSTR("{\"id\":%lu,\"type\":\"subscribe_events\","
+                    "\"event_type\":\"state_changed\"}"),
+               (unsigned long)++ha_wsId);
+    ha_ws.sendText(sub, strlen(sub));
+    ha_wsStage = HWS_LIVE;
+    ha_wsBackoff = HA_WS_RETRY_MIN;
+  } else if (!strcmp(type, "auth_invalid")) {
+    ha_ws.close();
+    ha_wsStage = HWS_OFF;
+    ha_wsBackoff = HA_WS_RETRY_MAX; // token errato: inutile insistere
+    ha_wsRetryMs = millis() + ha_wsBackoff;
+  }
+}
+
+static bool haWsConnect() {
+  {
+    StateLock lock;
+    if (g_ha_token.length() == 0)
+      return false;
+  }
+  if (!haResolveIp())
+    return false;
+  haAllowSync();
+  if (!ha_ws.begin(ha_ip, 8123, "/api/websocket", 3000)) {
+    haForgetIp();
+    return false;
+  }
+  ha_wsStage = HWS_CONNECT;
+  return true;
+}
+
+// Tentativo fallito: backoff e, solo a pagina visibile, una lettura REST
+// di ripiego (bloccante: mai a pagina nascosta)
+static void haWsFailed(uint32_t now) {
+  ha_wsStage = HWS_OFF;
+  ha_wsRetryMs = now + ha_wsBackoff;
+  if (ha_wsBackoff < HA_WS_RETRY_MAX)
+    ha_wsBackoff *= 2;
+  if (g_page == P_HA && fetchHAStates()) {
+    StateLock lock;
+    ha_flags.dirty = 1;
+  }
+}
+
+// Connessione, riconnessione con backoff e lettura eventi, tutto non
+// bloccante: un passo di connect/handshake per giro di loop. Da chiamare a
+// ogni loop finché la pagina è attiva, senza StateLock: lo prendono le
+// funzioni che leggono la configurazione o pubblicano gli stati.
+void serviceHA() {
+  const uint32_t now = millis();
+
+  if (ha_wsStage > HWS_CONNECT && !ha_ws.connected()) {
+    ha_wsStage = HWS_OFF;
+    ha_wsRetryMs = now + ha_wsBackoff;
+  }
+
+  // lettura REST a passi della lista: una entità per giro, a pagina visibile
+  if (ha_listBusy && g_page == P_HA && ha_wsStage != HWS_LIVE) {
+    fetchHAStates();
+    return;
+  }
+
+  if (ha_wsStage == HWS_OFF) {
+    if ((int32_t)(now - ha_wsRetryMs) < 0)
+      return;
+    if (!haWsConnect()) {
+      haWsFailed(now);
+      return;
+    }
+  }
+
+  if (ha_wsStage == HWS_CONNECT) {
+    const WsStep st = ha_ws.step();
+    if (st == WS_PENDING)
+      return;
+    if (st == WS_FAILED) {
+      haForgetIp();
+      haWsFailed(now);
+      return;
+    }
+    ha_wsStage = HWS_AUTH;
+    ha_wsPingMs = now;
+  }
+
+  ha_ws.poll(haOnMessage);
+
+  // keep-alive applicativo: HA risponde "pong" → lastRxMs aggiornato
+  if (ha_wsStage == HWS_LIVE && now - ha_wsPingMs > HA_WS_IDLE_MS / 3) {
+    ha_wsPingMs = now;
+    char ping[32];
+    snprintf_P(ping, sizeof(ping), PSTR("{\"id\":%lu,\"type\":\"ping\"}"),
+               (unsigned long)++ha_wsId);
+    ha_ws.sendText(ping, strlen(ping));
+  }
+  if (now - ha_ws.lastRxMs > HA_WS_IDLE_MS) {
+    ha_ws.close();
+    ha_wsStage = HWS_OFF;
+    ha_wsRetryMs = now;
   }
 }
 
 // ============================================================================
 // RENDER
 // ============================================================================
+static inline int16_t haRowY(uint8_t i) {
+  return PAGE_Y - 40 + i * (BASE_CHAR_H * TEXT_SCALE + 7);
+}
+
+static void haDrawRow(uint8_t i) {
+  const HAEntry &e = ha_entries[i];
+  const int16_t lineH = BASE_CHAR_H * TEXT_SCALE;
+  const int16_t y = haRowY(i);
+
+  gfx->setCursor(PAGE_X, y);
+  gfx->print(e.name);
+
+  if (e.flags & HA_F_ONOFF) {
+    // Check secondo carattere: 'n' = On, 'f' = Off
+    uint16_t col = (e.state[1] == 'n') ? HA_ON_COL : HA_OFF_COL;
+    gfx->fillRoundRect(PAGE_X + PAGE_W - 40, y - 2, 32, lineH, 4, col);
+  } else {
+    int16_t tw = strlen(e.state) * BASE_CHAR_W * TEXT_SCALE;
+    gfx->setCursor(PAGE_X + PAGE_W - tw, y);
+    gfx->print(e.state);
+  }
+
+  drawHLine(y + lineH + 6);
+}
+
 void pageHA() {
   if (!ha_flags.ready) {
     gfx->setCursor(PAGE_X, PAGE_Y + 20);
@@ -385,52 +869,79 @@ void pageHA() {
     return;
   }
 
-  if (!ha_flags.dirty)
-    return;
   ha_flags.dirty = 0;
+  ha_rowDirty = 0;
 
   gfx->setTextSize(TEXT_SCALE);
   gfx->setTextColor(COL_TEXT, COL_BG);
 
-  const int16_t lineH = BASE_CHAR_H * TEXT_SCALE;
-  const int16_t rowStep = lineH + 7;
   const int16_t yMax = PAGE_Y + PAGE_H - 20;
-  int16_t y = PAGE_Y - 40;
 
   if (ha_count == 0) {
-    gfx->setCursor(PAGE_X, y);
+    gfx->setCursor(PAGE_X, PAGE_Y - 40);
     gfx->print(F("Nessuna entita'"));
     return;
   }
 
-  for (uint8_t i = 0; i < ha_count && y <= yMax; i++) {
-    const HAEntry &e = ha_entries[i];
+  for (uint8_t i = 0; i < ha_count && haRowY(i) <= yMax; i++)
+    haDrawRow(i);
+}
 
-    gfx->setCursor(PAGE_X, y);
-    gfx->print(e.name);
+// ============================================================================
+// TICK
+// ============================================================================
+// Pagina visibile: eventi WebSocket (letti da serviceHA) → ridisegno delle
+// sole righe cambiate
+void tickHA() {
+  if (ha_flags.dirty) {
+    gfx->fillScreen(COL_BG);
+    pageHA();
+    return;
+  }
 
-    if (e.flags & HA_F_ONOFF) {
-      // Check secondo carattere: 'n' = On, 'f' = Off
-      uint16_t col = (e.state[1] == 'n') ? HA_ON_COL : HA_OFF_COL;
-      gfx->fillRoundRect(PAGE_X + PAGE_W - 40, y - 2, 32, lineH, 4, col);
-    } else {
-      int16_t tw = strlen(e.state) * BASE_CHAR_W * TEXT_SCALE;
-      gfx->setCursor(PAGE_X + PAGE_W - tw, y);
-      gfx->print(e.state);
-    }
+  if (!ha_rowDirty)
+    return;
+
+  const int16_t lineH = BASE_CHAR_H * TEXT_SCALE;
+  const int16_t yMax = PAGE_Y + PAGE_H - 20;
+
+  gfx->setTextSize(TEXT_SCALE);
+  gfx->setTextColor(COL_TEXT, COL_BG);
 
-    y += lineH + 10;
-    drawHLine(y - 4);
-    y -= 3;
+  for (uint8_t i = 0; i < ha_count; i++) {
+    if (!(ha_rowDirty & (1UL << i)))
+      continue;
+    const int16_t y = haRowY(i);
+    if (y > yMax)
+      break;
+    // fascia della riga, separatori esclusi
+    gfx->fillRect(PAGE_X, y - 2, PAGE_W, lineH + 6, COL_BG);
+    if (i > 0)
+      drawHLine(y - 1);
+    haDrawRow(i);
   }
+  ha_rowDirty = 0;
 }
 
 // ============================================================================
 // WRAPPER
 // ============================================================================
+// Refresh periodico: con il WebSocket attivo i dati sono già aggiornati
+// (lista entità cambiata dalla WebUI → nuovo get_states). Senza WebSocket e
+// con una lista configurata una entità per chiamata: il loop richiama
+// finché haListPending().
 bool fetchHA() {
-  ha_flags.ready = 0;
-  ha_flags.dirty = 1;
-  ha_nextPollMs = 0;
+  const bool listChanged = haAllowSync();
+  if (ha_wsStage == HWS_LIVE && ha_ws.connected()) {
+    if (listChanged)
+      haWsGetStates();
+    return ha_flags.ready;
+  }
+
+  if (ha_wsStage == HWS_OFF)
+    ha_wsRetryMs = millis(); // nuovo tentativo WebSocket al prossimo service
   return fetchHAStates();
 }
+
+// Lettura REST della lista configurata non ancora conclusa
+bool haListPending() { return ha_listBusy; }
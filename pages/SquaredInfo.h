@@ -3,7 +3,9 @@
    SQUARED — PAGINA "INFO DEVICE"
    Descrizione: Mostra URL di configurazione, uso CPU stimato, memoria libera,
                 pagine abilitate, firmware e modello hardware. Ottimizzato
-                per ESP32-S3 Panel-4848S040.
+                per ESP32-S3 Panel-4848S040. Righe e badge sono widget:
+                tickInfo() aggiorna URL, RAM e pagine ridisegnando solo le
+                righe cambiate.
    Autore: Davide “gat” Nasato
    Repository: https://github.com/davidegat/SquaredCoso
    Licenza: CC BY-NC 4.0
@@ -13,6 +15,7 @@
 #pragma once
 
 #include "../handlers/globals.h"
+#include "../handlers/widgets.h"
 #include <Arduino.h>
 #include <WiFi.h>
 #include <esp_chip_info.h>
@@ -48,12 +51,11 @@ extern bool g_show[];
 // ============================================================================
 // BADGE
 // ============================================================================
-static inline void drawBadge(int16_t x, int16_t y, uint8_t v) {
-  uint16_t col = (v < 40) ? 0x07E0 : // verde
-                     (v < 70) ? 0xFFE0
-                              : // giallo
-                     0xF800;    // rosso
-  gfx->fillRoundRect(x, y, INFO_BADGE_W, INFO_BADGE_H, 4, col);
+static inline uint16_t badgeColor(uint8_t v) {
+  return (v < 40) ? 0x07E0 : // verde
+             (v < 70) ? 0xFFE0
+                      : // giallo
+             0xF800;    // rosso
 }
 
 // ============================================================================
@@ -114,109 +116,127 @@ static uint8_t estimateCPU() {
 }
 
 // ============================================================================
-// PAGINA INFO
+// WIDGET
 // ============================================================================
-static void pageInfo() {
+enum : uint8_t {
+  IW_URL,
+  IW_CPU,
+  IW_CPU_B,
+  IW_RAM,
+  IW_RAM_B,
+  IW_PAGES,
+  IW_PAGES_B,
+  IW_FW,
+  IW_GIT,
+  IW_MODEL,
+  IW_N
+};
+
+static constexpr uint32_t INFO_TICK_MS = 2000;
+
+static Widget infoW[IW_N];
+static WgTree infoUi = {infoW, IW_N, 0, 0};
+static WgStyle infoText, infoBadge;
+
+// Righe del layout originale: testo a y + CHAR_H, badge a y + CHAR_H / 2
+static void buildInfoUi() {
+  infoText = {COL_BG, COL_TEXT, 0, 0, 0, 0, 0, (uint8_t)TEXT_SCALE};
+  infoBadge = {COL_BG, 0, 0, 0, 0, 0, 4, 0};
+  infoUi.bg = COL_BG;
+
+  const int16_t w = 420 - PAGE_X - 4;
+  int16_t y = PAGE_Y;
+  wgAdd(infoUi, WG_LABEL, PAGE_X, y + CHAR_H, 480 - 2 * PAGE_X, CHAR_H,
+        &infoText);
+  y += CHAR_H * 2 + 20;
+
+  for (uint8_t r = 0; r < 3; r++) {
+    wgAdd(infoUi, WG_LABEL, PAGE_X, y + CHAR_H, w, CHAR_H, &infoText);
+    wgAdd(infoUi, WG_BADGE, 420, y + CHAR_H / 2, INFO_BADGE_W, INFO_BADGE_H,
+          &infoBadge);
+    y += CHAR_H * 2 + 10;
+  }
+  y += 14;
 
-  drawHeader("Device info");
-  int y = PAGE_Y;
+  for (uint8_t r = 0; r < 3; r++) {
+    wgAdd(infoUi, WG_LABEL, PAGE_X, y + CHAR_H, 480 - 2 * PAGE_X, CHAR_H,
+          &infoText);
+    y += CHAR_H * 2 + 10;
+  }
+
+  char buf[40];
+  snprintf(buf, sizeof(buf), "Firmware: %s %s", FW_NAME, FW_VERSION);
+  wgText(infoW[IW_FW], buf);
+  wgText(infoW[IW_GIT], "          github.com/davidegat");
+  wgText(infoW[IW_MODEL], "Model:    ESP32-S3 Panel 4848S040");
+}
 
-  gfx->setTextSize(TEXT_SCALE);
-  gfx->setTextColor(COL_TEXT, COL_BG);
+static void setInfoBadge(uint8_t label, const char *text, uint8_t pct) {
+  wgText(infoW[label], text);
+  wgColor(infoW[label + 1], badgeColor(pct));
+}
 
-  // -------------------------------------------------------------------------
-  // URL SETTINGS
-  // -------------------------------------------------------------------------
+// URL, RAM e pagine (la stima CPU blocca 200 ms: solo al disegno completo)
+static void syncInfoUi() {
   const bool sta =
       (WiFi.getMode() == WIFI_STA && WiFi.status() == WL_CONNECTED);
 
-  char urlbuf[64];
+  char buf[64];
   if (sta) {
-    snprintf(urlbuf, sizeof(urlbuf), "http://%s/settings",
+    snprintf(buf, sizeof(buf), "http://%s/settings",
              WiFi.localIP().toString().c_str());
   } else if (WiFi.getMode() == WIFI_AP) {
-    snprintf(urlbuf, sizeof(urlbuf), "http://%s/settings",
+    snprintf(buf, sizeof(buf), "http://%s/settings",
              WiFi.softAPIP().toString().c_str());
   } else {
-    snprintf(urlbuf, sizeof(urlbuf), "n/a");
+    snprintf(buf, sizeof(buf), "n/a");
   }
+  wgText(infoW[IW_URL], buf);
 
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print(urlbuf);
-
-  y += CHAR_H * 2 + 10;
-  drawHLine(y);
-  y += 10;
-
-  // -------------------------------------------------------------------------
-  // CPU
-  // -------------------------------------------------------------------------
-  uint8_t cpu = estimateCPU();
-
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print("CPU: ");
-  gfx->print((int)cpu);
-  gfx->print("%");
-
-  drawBadge(420, y + (CHAR_H / 2), cpu);
-
-  y += CHAR_H * 2 + 10;
-
-  // -------------------------------------------------------------------------
-  // RAM
-  // -------------------------------------------------------------------------
   size_t freeHeap = ESP.getFreeHeap();
   size_t totalHeap = ESP.getHeapSize();
+  snprintf(buf, sizeof(buf), "RAM: %s / %s", formatBytes(freeHeap).c_str(),
+           formatBytes(totalHeap).c_str());
+  setInfoBadge(IW_RAM, buf,
+               (uint8_t)((100 * (totalHeap - freeHeap)) /
+                         (totalHeap ? totalHeap : 1)));
 
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print("RAM: ");
-  gfx->print(formatBytes(freeHeap));
-  gfx->print(" / ");
-  gfx->print(formatBytes(totalHeap));
-
-  uint8_t ramPct =
-      (uint8_t)((100 * (totalHeap - freeHeap)) / (totalHeap ? totalHeap : 1));
-
-  drawBadge(420, y + (CHAR_H / 2), ramPct);
-
-  y += CHAR_H * 2 + 10;
-
-  // -------------------------------------------------------------------------
-  // PAGINE ATTIVE
-  // -------------------------------------------------------------------------
   int enabled = 0;
   for (int i = 0; i < PAGES; i++)
     enabled += g_show[i] ? 1 : 0;
+  snprintf(buf, sizeof(buf), "Pages: %d / %d", enabled, (int)PAGES);
+  setInfoBadge(IW_PAGES, buf, (uint8_t)((100 * enabled) / (PAGES ? PAGES : 1)));
+}
 
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print("Pages: ");
-  gfx->print(enabled);
-  gfx->print(" / ");
-  gfx->print((int)PAGES);
-
-  uint8_t pgPct = (uint8_t)((100 * enabled) / (PAGES ? PAGES : 1));
-  drawBadge(420, y + (CHAR_H / 2), pgPct);
-
-  y += CHAR_H * 2 + 14;
-  drawHLine(y);
-  y += 10;
-
-  // -------------------------------------------------------------------------
-  // INFO FIRMWARE
-  // -------------------------------------------------------------------------
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print("Firmware: ");
-  gfx->print(FW_NAME);
-  gfx->print(" ");
-  gfx->print(FW_VERSION);
-
-  y += CHAR_H * 2 + 10;
+// ============================================================================
+// PAGINA INFO
+// ============================================================================
+static uint32_t infoTickMs = 0;
 
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print("          github.com/davidegat");
+static void pageInfo() {
+  if (!infoUi.n)
+    buildInfoUi();
 
-  y += CHAR_H * 2 + 10;
+  drawHeader("Device info");
+  drawHLine(PAGE_Y + CHAR_H * 2 + 10);
+  drawHLine(PAGE_Y + CHAR_H * 8 + 54);
+
+  const uint8_t cpu = estimateCPU();
+  char buf[12];
+  snprintf(buf, sizeof(buf), "CPU: %u%%", cpu);
+  setInfoBadge(IW_CPU, buf, cpu);
+
+  syncInfoUi();
+  wgInvalidate(infoUi);
+  wgRender(infoUi);
+  infoTickMs = millis();
+}
 
-  gfx->setCursor(PAGE_X, y + CHAR_H);
-  gfx->print("Model:    ESP32-S3 Panel 4848S040");
+// Pagina a schermo: solo le righe cambiate
+static void tickInfo() {
+  if (!infoUi.n || millis() - infoTickMs < INFO_TICK_MS)
+    return;
+  infoTickMs = millis();
+  syncInfoUi();
+  wgRender(infoUi);
 }
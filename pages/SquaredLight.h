@@ -12,23 +12,13 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
 #include "../handlers/jsonhelpers.h"
+#include "../handlers/strview.h"
 #include <Arduino.h>
 #include <math.h>
 #include <time.h>
-// ============================================================================
-// Timezone helper
-// ============================================================================
-static inline long calcTZ();
-
-// ============================================================================
-// timegm per ESP32
-// ============================================================================
-static time_t timegm_esp32(struct tm *tm) {
-  time_t local = mktime(tm);      // interpreta tm come ora locale
-  return local - calcTZ() * 3600; // converti in UTC
-}
 
 // ============================================================================
 // IMMAGINE LUNA (RLE)
@@ -90,55 +80,29 @@ static uint16_t g_shadowTex[LUNA_WIDTH * LUNA_HEIGHT];
 static bool g_shadowReady = false;
 static int g_shadowPhaseBucket = -1;
 
-// ============================================================================
-// TIMEZONE
-// ============================================================================
-static inline long calcTZ() {
-  time_t now = time(nullptr);
-  struct tm lo {
-  }, gm{};
-  localtime_r(&now, &lo);
-  gmtime_r(&now, &gm);
-
-  long d = lo.tm_hour - gm.tm_hour;
-  if (d > 12)
-    d -= 24;
-  if (d < -12)
-    d += 24;
-  return d;
-}
-
 // ============================================================================
 // ISO HELPERS
 // ============================================================================
-static inline void isoToHM(const String &iso, char out[6]) {
-  int t = iso.indexOf('T');
-  if (t < 0 || t + 5 >= iso.length()) {
+// Orario locale HH:MM da timestamp ISO (gli orari API sono in UTC)
+static inline void isoToHM(StrView iso, char out[6]) {
+  IsoTime t;
+  if (!svParseIso8601(iso, t).ok || !t.hasTime) {
     strcpy(out, "--:--");
     return;
   }
-  out[0] = iso[t + 1];
-  out[1] = iso[t + 2];
-  out[2] = ':';
-  out[3] = iso[t + 4];
-  out[4] = iso[t + 5];
-  out[5] = 0;
+
+  time_t ts = isoEpoch(t);
+  struct tm lo;
+  localtime_r(&ts, &lo);
+  snprintf(out, 6, "%02d:%02d", lo.tm_hour, lo.tm_min);
 }
 
-static inline bool isoToEpoch(const String &s, time_t &out) {
-  if (s.length() < 19)
+static inline bool isoToEpoch(StrView s, time_t &out) {
+  IsoTime t;
+  if (!svParseIso8601(s, t).ok || !t.hasTime)
     return false;
 
-  struct tm tt {};
-  tt.tm_year = s.substring(0, 4).toInt() - 1900;
-  tt.tm_mon = s.substring(5, 7).toInt() - 1;
-  tt.tm_mday = s.substring(8, 10).toInt();
-  tt.tm_hour = s.substring(11, 13).toInt();
-  tt.tm_min = s.substring(14, 16).toInt();
-  tt.tm_sec = s.substring(17, 19).toInt();
-
-  time_t local = mktime(&tt);
-  out = local - calcTZ() * 3600;
+  out = isoEpoch(t);
   return true;
 }
 
@@ -253,37 +217,32 @@ struct MoonEvent {
   bool valid;
 };
 
-static uint8_t uidToPhase4(const String &uid) {
-  if (uid.indexOf("newmoon") >= 0)
+static uint8_t uidToPhase4(StrView uid) {
+  if (uid.find("newmoon") >= 0)
     return 0;
-  if (uid.indexOf("first-quarter") >= 0)
+  if (uid.find("first-quarter") >= 0)
     return 1;
-  if (uid.indexOf("fullmoon") >= 0)
+  if (uid.find("fullmoon") >= 0)
     return 2;
-  if (uid.indexOf("last-quarter") >= 0)
+  if (uid.find("last-quarter") >= 0)
     return 3;
   return 255;
 }
 
-static time_t parseDate(const String &line) {
-  int p = line.indexOf(':');
+// DTSTART;VALUE=DATE:YYYYMMDD → mezzogiorno UTC di quel giorno
+static time_t parseDate(StrView line) {
+  int p = line.find(':');
   if (p < 0)
     return 0;
 
-  String d = line.substring(p + 1);
-  String y = d.substring(0, 4);
-  String m = d.substring(4, 6);
-  String dd = d.substring(6, 8);
-
-  struct tm tt {};
-  tt.tm_year = y.toInt() - 1900;
-  tt.tm_mon = m.toInt() - 1;
-  tt.tm_mday = dd.toInt();
-  tt.tm_hour = 12;
-  tt.tm_min = 0;
-  tt.tm_sec = 0;
+  IsoTime t;
+  if (!svParseIso8601(line.sub(p + 1), t).ok)
+    return 0;
 
-  return timegm_esp32(&tt);
+  t.hour = 12;
+  t.min = t.sec = 0;
+  t.offMin = 0;
+  return isoToUtcEpoch(t);
 }
 
 // ============================================================================
@@ -371,8 +330,8 @@ static void interpolatePhase(const MoonEvent &prev, const MoonEvent &next,
 // ============================================================================
 // FETCH SUN + MOON
 // ============================================================================
-bool fetchSun() {
-
+// Valori a vuoto: fetch fallito → niente residui vecchi
+static void sunClear() {
   strcpy(sun_rise, "--:--");
   strcpy(sun_set, "--:--");
   strcpy(sun_noon, "--:--");
@@ -384,34 +343,49 @@ bool fetchSun() {
   g_moon_illum01 = -1;
   g_moon_phase_idx = 0;
   g_moon_waxing = true;
+}
+
+// Tre richieste: ognuna senza lock, StateLock solo per pubblicarne il
+// risultato
+bool fetchSun() {
 
   // 1) Geocoding
   float lat, lon;
-  if (!fetchLatLon(lat, lon))
+  if (!fetchLatLon(lat, lon)) {
+    StateLock lock;
+    sunClear();
     return false;
+  }
 
-  g_lat = String(lat, 6);
-  g_lon = String(lon, 6);
+  const String sLat = String(lat, 6);
+  const String sLon = String(lon, 6);
+  {
+    StateLock lock;
+    g_lat = sLat;
+    g_lon = sLon;
+  }
 
   // 2) SUN
   {
     String body;
-    String url = "https://api.sunrise-sunset.org/json?lat=" + g_lat +
-                 "&lng=" + g_lon + "&formatted=0";
-
-    if (!httpGET(url, body, 10000))
-      return false;
-
-    String sr, ss, sn, cb, ce;
-    if (!jsonKV(body, "sunrise", sr))
-      return false;
-    if (!jsonKV(body, "sunset", ss))
+    String url = "https://api.sunrise-sunset.org/json?lat=" + sLat +
+                 "&lng=" + sLon + "&formatted=0";
+
+    char sr[32], ss[32], sn[32], cb[32], ce[32];
+    JsonQuery q[] = {jqStr("results.sunrise", sr, sizeof(sr)),
+                     jqStr("results.sunset", ss, sizeof(ss)),
+                     jqStr("results.solar_noon", sn, sizeof(sn)),
+                     jqStr("results.civil_twilight_begin", cb, sizeof(cb)),
+                     jqStr("results.civil_twilight_end", ce, sizeof(ce))};
+    const bool got = httpGET(url, body, 10000);
+    if (got)
+      jsonExtract(body, q, 5);
+
+    StateLock lock;
+    sunClear();
+    if (!got || !q[0].count || !q[1].count)
       return false;
 
-    jsonKV(body, "solar_noon", sn);
-    jsonKV(body, "civil_twilight_begin", cb);
-    jsonKV(body, "civil_twilight_end", ce);
-
     isoToHM(sr, sun_rise);
     isoToHM(ss, sun_set);
     isoToHM(sn, sun_noon);
@@ -430,13 +404,16 @@ bool fetchSun() {
   {
     String bodyUV;
     String urlUV = String("https://api.open-meteo.com/v1/forecast") +
-                   "?latitude=" + g_lat + "&longitude=" + g_lon +
+                   "?latitude=" + sLat + "&longitude=" + sLon +
                    "&timezone=auto&daily=uv_index_max&forecast_days=1";
 
     if (httpGET(urlUV, bodyUV, 8000)) {
-      float uvi = -1;
-      if (jsonDailyFirstNumber(bodyUV, "uv_index_max", uvi) && uvi >= 0)
+      float uvi;
+      JsonQuery q = jqFloat("daily.uv_index_max[0]", uvi);
+      if (jsonExtract(bodyUV, &q, 1) && uvi >= 0) {
+        StateLock lock;
         snprintf(sun_uvi, sizeof(sun_uvi), "%.1f", uvi);
+      }
     }
   }
 
@@ -456,47 +433,41 @@ bool fetchSun() {
       MoonEvent prev{0, 0, false};
       MoonEvent next{0, 0, false};
 
-      time_t nowUTC = time(nullptr) - calcTZ() * 3600;
+      time_t nowUTC = time(nullptr);
 
+      const StrView ics(bodyICS);
       int pos = 0;
       while (true) {
-        int evStart = bodyICS.indexOf("BEGIN:VEVENT", pos);
+        int evStart = ics.find("BEGIN:VEVENT", pos);
         if (evStart < 0)
           break;
 
-        int evEnd = bodyICS.indexOf("END:VEVENT", evStart);
+        int evEnd = ics.find("END:VEVENT", evStart);
         if (evEnd < 0)
           break;
 
-        String ev = bodyICS.substring(evStart, evEnd);
+        const StrView ev = ics.sub(evStart, evEnd - evStart);
+        pos = evEnd;
 
-        int pdt = ev.indexOf("DTSTART");
-        if (pdt < 0) {
-          pos = evEnd;
+        int pdt = ev.find("DTSTART");
+        if (pdt < 0)
           continue;
-        }
-        int ln = ev.indexOf('\n', pdt);
+        int ln = ev.find('\n', pdt);
         if (ln < 0)
-          ln = ev.length();
-        String dtline = ev.substring(pdt, ln);
+          ln = ev.size();
 
-        time_t ts = parseDate(dtline);
+        time_t ts = parseDate(ev.sub(pdt, ln - pdt));
 
-        int pu = ev.indexOf("UID:");
-        if (pu < 0) {
-          pos = evEnd;
+        int pu = ev.find("UID:");
+        if (pu < 0)
           continue;
-        }
-        int eu = ev.indexOf('\n', pu);
+        int eu = ev.find('\n', pu);
         if (eu < 0)
-          eu = ev.length();
-        String uid = ev.substring(pu, eu);
+          eu = ev.size();
 
-        uint8_t ph4 = uidToPhase4(uid);
-        if (ph4 == 255) {
-          pos = evEnd;
+        uint8_t ph4 = uidToPhase4(ev.sub(pu, eu - pu));
+        if (ph4 == 255)
           continue;
-        }
 
         if (ts <= nowUTC) {
           prev.ts = ts;
@@ -508,14 +479,14 @@ bool fetchSun() {
           next.valid = true;
           break;
         }
-
-        pos = evEnd;
       }
 
+      StateLock lock;
       interpolatePhase(prev, next, nowUTC);
     }
   }
 
+  StateLock lock;
   g_shadowReady = false;
   return true;
 }
@@ -12,7 +12,9 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
+#include "../handlers/jsonhelpers.h"
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 #include <HTTPClient.h>
@@ -53,7 +55,11 @@ static String w_desc[3];
 // Geocoding → lat/lon (Open-Meteo geocoding API)
 // ----------------------------------------------------
 static bool fetchLatLon(float &lat, float &lon) {
-  String city = g_city;
+  String city;
+  {
+    StateLock lock;
+    city = g_city;
+  }
   city.trim();
   city.replace(" ", "%20");
 
@@ -64,13 +70,9 @@ static bool fetchLatLon(float &lat, float &lon) {
   if (!httpGET(url, body, 8000))
     return false;
 
-  if (!extractJsonNumber(body, "\"latitude\"", lat))
-    return false;
-
-  if (!extractJsonNumber(body, "\"longitude\"", lon))
-    return false;
-
-  return true;
+  JsonQuery q[] = {jqFloat("results[0].latitude", lat),
+                   jqFloat("results[0].longitude", lon)};
+  return jsonExtract(body, q, 2) == 2;
 }
 
 // ----------------------------------------------------
@@ -123,112 +125,81 @@ static String mapWeatherCodeToDesc(int code, const String &lang) {
 }
 
 // ----------------------------------------------------
-// Estrai l'ennesimo weathercode dall'array daily.weathercode
+// Stato a vuoto, per evitare residui vecchi se il fetch fallisce
 // ----------------------------------------------------
-static bool extractDailyWeathercode(const String &body, int index,
-                                    int &codeOut) {
-  int dailyPos = body.indexOf("\"daily\"");
-  if (dailyPos < 0)
-    return false;
-
-  int wcPos = body.indexOf("\"weathercode\"", dailyPos);
-  if (wcPos < 0)
-    return false;
-
-  int bracket = body.indexOf('[', wcPos);
-  if (bracket < 0)
-    return false;
-
-  int len = body.length();
-  int p = bracket + 1;
-  int currentIndex = 0;
-
-  while (p < len) {
-    // salta spazi, virgole, newline
-    while (p < len && (body[p] == ' ' || body[p] == ',' || body[p] == '\n' ||
-                       body[p] == '\r' || body[p] == '\t'))
-      p++;
-
-    if (p >= len || body[p] == ']')
-      break;
-
-    int start = p;
-    while (p < len && (body[p] == '-' || body[p] == '+' || isdigit(body[p])))
-      p++;
-
-    if (currentIndex == index) {
-      codeOut = body.substring(start, p).toInt();
-      return true;
-    }
-
-    currentIndex++;
+static void weatherClear() {
+  w_now_tempC = NAN;
+  w_now_desc = "";
+  for (int i = 0; i < 3; i++) {
+    w_desc[i] = "";
   }
-
-  return false;
 }
 
 // ----------------------------------------------------
-// Fetch meteo da Open-Meteo
+// Fetch meteo da Open-Meteo (rete senza lock, dati pubblicati sotto lock)
 // ----------------------------------------------------
 bool fetchWeather() {
-  // reset stato, per evitare residui vecchi se il fetch fallisce
-  w_now_tempC = NAN;
-  w_now_desc = "";
-  for (int i = 0; i < 3; i++) {
-    w_desc[i] = "";
+  String lang;
+  {
+    StateLock lock;
+    lang = g_lang;
   }
 
   float lat = NAN, lon = NAN;
-  if (!fetchLatLon(lat, lon))
-    return false;
-
-  String url = "https://api.open-meteo.com/v1/forecast"
-               "?latitude=" +
-               String(lat, 6) + "&longitude=" + String(lon, 6) +
-               "&current_weather=true"
-               "&daily=weathercode"
-               "&timezone=auto";
-
   String body;
-  if (!httpGET(url, body, 10000))
+  bool got = fetchLatLon(lat, lon);
+  if (got) {
+    String url = "https://api.open-meteo.com/v1/forecast"
+                 "?latitude=" +
+                 String(lat, 6) + "&longitude=" + String(lon, 6) +
+                 "&current_weather=true"
+                 "&daily=weathercode"
+                 "&timezone=auto";
+    got = httpGET(url, body, 10000);
+  }
+  if (!got) {
+    StateLock lock;
+    weatherClear();
     return false;
+  }
 
-  bool ok = false;
-
-  // ------------------------------------------------
-  // current_weather block
-  // ------------------------------------------------
-  int cwPos = body.indexOf("\"current_weather\"");
-  if (cwPos >= 0) {
-
-    // Temperatura attuale (°C)
-    float t;
-    if (extractJsonNumber(body, "\"temperature\"", t, cwPos)) {
-      w_now_tempC = t;
-      ok = true;
-    }
+  // current_weather + primi 3 valori di daily.weathercode[] in una passata
+  float t, codef, daily[3];
+  JsonQuery q[] = {jqFloat("current_weather.temperature", t),
+                   jqFloat("current_weather.weathercode", codef),
+                   jqFloats("daily.weathercode", daily, 3)};
+  jsonExtract(body, q, 3);
 
-    // weathercode → descrizione
-    float codef;
-    if (extractJsonNumber(body, "\"weathercode\"", codef, cwPos)) {
-      int code = (int)codef;
-      String d = mapWeatherCodeToDesc(code, g_lang);
-      w_now_desc = sanitizeText(d);
-      if (w_now_desc.length())
-        ok = true;
-    }
-  }
+  // weathercode → descrizione
+  String nowDesc, desc[3];
+  if (q[1].count)
+    nowDesc = sanitizeText(mapWeatherCodeToDesc((int)codef, lang));
 
   // ------------------------------------------------
   // Forecast 3 giorni da daily.weathercode[]
   // ------------------------------------------------
   for (int i = 0; i < 3; i++) {
-    int code;
-    if (!extractDailyWeathercode(body, i, code))
+    if (isnan(daily[i]))
       break;
+    desc[i] = sanitizeText(mapWeatherCodeToDesc((int)daily[i], lang));
+  }
 
-    String d = mapWeatherCodeToDesc(code, g_lang);
-    w_desc[i] = sanitizeText(d);
+  StateLock lock;
+  weatherClear();
+  bool ok = false;
+
+  // Temperatura attuale (°C)
+  if (q[0].count) {
+    w_now_tempC = t;
+    ok = true;
+  }
+
+  w_now_desc = nowDesc;
+  if (w_now_desc.length())
+    ok = true;
+
+  for (int i = 0; i < 3; i++) {
+    w_desc[i] = desc[i];
     if (w_desc[i].length())
       ok = true;
   }
@@ -403,15 +374,14 @@ void pageWeatherParticlesTick() {
 void pageWeather() {
   pageWeatherParticlesTick();
 
-  drawHeader(g_lang == "it" ? "Meteo per " + sanitizeText(g_city)
-                            : "Weather in " + sanitizeText(g_city));
+  drawHeader((g_lang == "it" ? "Meteo per " : "Weather in ") + g_city);
 
   int y = PAGE_Y;
 
   // linea principale: preferisci sempre mostrare qualcosa
   String line;
   if (!isnan(w_now_tempC) && w_now_desc.length()) {
-    line = String((int)round(w_now_tempC)) + "c  " + w_now_desc;
+    line = String((int)round(w_now_tempC)) + "c " + w_now_desc;
   } else if (w_now_desc.length()) {
     line = w_now_desc;
   } else {
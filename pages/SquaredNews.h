@@ -1,8 +1,8 @@
 /*
 ===============================================================================
-   SQUARED — PAGINA "NEWS" (RSS)
-   Descrizione: Download RSS, parsing leggero, pulizia HTML/XML, normalizzazione
-                titoli, selezione randomizzata dei primi 5 item, word-wrap
+   SQUARED — PAGINA "NEWS" (RSS / Atom)
+   Descrizione: Download del feed in streaming (FeedScanner), titoli da <item>
+                o <entry>, selezione randomizzata dei primi 5, word-wrap
                 compatto con layout IT/EN. Ottimizzata per ESP32-S3.
    Autore: Davide “gat” Nasato
    Repository: https://github.com/davidegat/SquaredCoso
@@ -12,7 +12,11 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
+#include "../handlers/feedparser.h"
 #include "../handlers/globals.h"
+#include "../handlers/httpstream.h"
+#include "../handlers/strview.h"
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 
@@ -23,7 +27,6 @@ extern const int PAGE_X, PAGE_Y, CHAR_H, BASE_CHAR_W, BASE_CHAR_H, TEXT_SCALE;
 extern String g_lang;
 extern String g_rss_url;
 
-extern bool httpGET(const String &, String &, uint32_t);
 extern String sanitizeText(const String &);
 extern void drawHeader(const String &);
 extern void drawHLine(int y);
@@ -35,150 +38,33 @@ static const uint8_t NEWS_MAX = 5;
 static String news_title[NEWS_MAX];
 
 // ---------------------------------------------------------------------------
-// Rimozione tag HTML/XML
-// ---------------------------------------------------------------------------
-static inline String stripTags(const String &s) {
-  const uint16_t L = s.length();
-  String out;
-  out.reserve(L);
-
-  bool inTag = false;
-
-  for (uint16_t i = 0; i < L; i++) {
-    char c = s[i];
-
-    if (c == '<') {
-      inTag = true;
-      continue;
-    }
-    if (c == '>') {
-      inTag = false;
-      continue;
-    }
-
-    if (!inTag)
-      out.concat(c);
-  }
-  return out;
-}
-
-// ---------------------------------------------------------------------------
-// Decodifica entità HTML più comuni
-// ---------------------------------------------------------------------------
-static inline void decodeEntities(String &s) {
-  s.replace("&amp;", "&");
-  s.replace("&lt;", "<");
-  s.replace("&gt;", ">");
-  s.replace("&quot;", "\"");
-  s.replace("&apos;", "'");
-  s.replace("&#39;", "'");
-}
-
-// ---------------------------------------------------------------------------
-// Normalizza il titolo
-// ---------------------------------------------------------------------------
-static String cleanTitle(const String &raw) {
-  String s = raw;
-
-  if (s.startsWith("<![CDATA[")) {
-    s.remove(0, 9);
-    int p = s.indexOf("]]>");
-    if (p > 0)
-      s = s.substring(0, p);
-  }
-
-  s = stripTags(s);
-  decodeEntities(s);
-  s = sanitizeText(s);
-  s.trim();
-
-  return s;
-}
-
-// ---------------------------------------------------------------------------
-// Estrae contenuto <tag>...</tag> se presente
-// ---------------------------------------------------------------------------
-static inline bool getTag(const String &src, const char *tag, String &out) {
-  String open = "<";
-  open += tag;
-  open += ">";
-  String close = "</";
-  close += tag;
-  close += ">";
-
-  int p = src.indexOf(open);
-  if (p < 0)
-    return false;
-
-  int s = p + open.length();
-  int e = src.indexOf(close, s);
-  if (e < 0)
-    return false;
-
-  out = src.substring(s, e);
-  out.trim();
-  return true;
-}
-
-// ---------------------------------------------------------------------------
-// fetchNews: scarica RSS, popola news_title[] con i primi titoli
+// fetchNews: scarica RSS/Atom, popola news_title[] con i primi titoli
 // ---------------------------------------------------------------------------
 bool fetchNews() {
 
-  // Reset buffer finale (5 titoli da mostrare)
-  for (uint8_t i = 0; i < NEWS_MAX; i++)
-    news_title[i] = "";
-
   // Buffer temporaneo (10 titoli non ancora randomizzati)
   String raw_title[10];
   uint8_t found = 0;
 
-  // URL effettivo
-  const String url =
-      g_rss_url.length() ? g_rss_url : "https://feeds.bbci.co.uk/news/rss.xml";
-
-  // Scarichiamo il feed (ma lavoriamo solo sulle prime parti)
-  String body;
-  if (!httpGET(url, body, 8000))
-    return false;
-  if (!body.length())
-    return false;
-
-  // Parsing leggero: cerchiamo solo <item> ... </item> e dentro <title>
-  uint16_t pos = 0;
-
-  while (found < 10) {
-
-    int a = body.indexOf("<item", pos);
-    if (a < 0)
-      break;
-
-    int openEnd = body.indexOf('>', a);
-    if (openEnd < 0)
-      break;
-
-    int b = body.indexOf("</item>", openEnd);
-    if (b < 0)
-      break;
-
-    // Contenuto interno del blocco <item>
-    String blk = body.substring(openEnd + 1, b);
-    pos = b + 7;
-
-    // Cerchiamo solo <title>...</title>
-    String title;
-    if (!getTag(blk, "title", title))
-      continue;
-
-    title = cleanTitle(title);
-    if (!title.length())
-      continue;
-
-    raw_title[found++] = title;
+  // URL effettivo (copia: la WebUI può cambiarlo durante il download)
+  String url;
+  {
+    StateLock lock;
+    url = g_rss_url.length() ? g_rss_url
+                             : String(F("https://feeds.bbci.co.uk/news/rss.xml"));
   }
 
-  if (found == 0)
-    return false;
+  // Parsing in streaming: <item> (RSS) / <entry> (Atom) → <title>.
+  // Raggiunti 10 titoli la connessione viene chiusa senza leggere il resto.
+  FeedScanner scan(raw_title, 10);
+  httpStream(url, 8000, [&](const char *d, size_t n) {
+    return scan.feed(d, n);
+  });
+
+  // anche da un download interrotto: i titoli completi restano validi
+  found = scan.count;
+  for (uint8_t i = 0; i < found; i++)
+    raw_title[i] = sanitizeText(raw_title[i]);
 
   // ---------------------------------------------------
   // RANDOM PICK: 5 titoli scelti dai 10 disponibili
@@ -187,18 +73,19 @@ bool fetchNews() {
   uint8_t pickCount = min((uint8_t)NEWS_MAX, found);
 
   // Fisher–Yates shuffle sui primi `found` titoli
-  for (uint8_t i = found - 1; i > 0; i--) {
+  for (uint8_t i = found ? found - 1 : 0; i > 0; i--) {
     uint8_t j = random(0, i + 1);
     String tmp = raw_title[i];
     raw_title[i] = raw_title[j];
     raw_title[j] = tmp;
   }
 
-  // Copiamo i primi 5 risultato randomizzato
-  for (uint8_t i = 0; i < pickCount; i++)
-    news_title[i] = raw_title[i];
+  // Copiamo i primi 5 risultato randomizzato (nessun titolo: lista vuota)
+  StateLock lock;
+  for (uint8_t i = 0; i < NEWS_MAX; i++)
+    news_title[i] = i < pickCount ? raw_title[i] : String();
 
-  return true;
+  return found > 0;
 }
 
 // ---------------------------------------------------------------------------
@@ -258,12 +145,11 @@ void pageNews() {
           cut = lastSpace;
       }
 
-      String line = text.substring(start, cut);
-      line.trim();
+      const StrView line = StrView(text).sub(start, cut - start).trim();
 
       gfx->setCursor(leftPad, y);
       gfx->setTextColor(COL_TEXT, COL_BG);
-      gfx->print(line);
+      gfx->write((const uint8_t *)line.begin(), line.size());
 
       y += lineH;
       if (y > 440)
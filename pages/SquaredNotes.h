@@ -14,6 +14,7 @@
 
 #include "../fonts/IndieFlower_Regular20pt7b.h"
 #include "../handlers/globals.h"
+#include "../handlers/strview.h"
 #include <Arduino.h>
 #include <Arduino_GFX_Library.h>
 
@@ -24,7 +25,6 @@ extern const int PAGE_H;
 extern const int TEXT_SCALE;
 
 extern String g_note;
-extern String sanitizeText(const String &in);
 
 // ---------------------------------------------------------------------------
 // Colori post-it
@@ -40,7 +40,7 @@ static const int NOTE_HEADER_H = 40;
 // ---------------------------------------------------------------------------
 // Calcolo bounding box (con GFXfont serve SEMPRE)
 // ---------------------------------------------------------------------------
-static void measureText(const String &s, int &w, int &h) {
+static void measureText(const char *s, int &w, int &h) {
   int16_t x1, y1;
   uint16_t ww, hh;
   gfx->getTextBounds(s, 0, 0, &x1, &y1, &ww, &hh);
@@ -70,7 +70,7 @@ void pageNotes() {
   }
 
   // testo
-  String txt = sanitizeText(g_note);
+  String txt = g_note; // sanitizzata all'ingresso (WebUI)
   if (!txt.length())
     txt = (g_lang == "it" ? "(vuoto)" : "(empty)");
 
@@ -83,43 +83,42 @@ void pageNotes() {
   const int MAX_W = PAGE_W - 40;
   const int MAX_H = PAGE_H - NOTE_HEADER_H - 40;
 
-  // word-wrap
-  std::vector<String> lines;
+  // word-wrap: righe come viste nel testo sanitizzato (spazi già singoli),
+  // un solo buffer di misura invece di una String per parola
+  static constexpr uint8_t NOTE_MAX_LINES = 16;
+  StrView lines[NOTE_MAX_LINES];
+  uint8_t nLines = 0;
+  char probe[192];
   {
-    std::vector<String> words;
-    int start = 0;
-    while (true) {
-      int sp = txt.indexOf(' ', start);
-      if (sp < 0) {
-        words.push_back(txt.substring(start));
-        break;
-      }
-      words.push_back(txt.substring(start, sp));
-      start = sp + 1;
-    }
+    const StrView all(txt);
+    size_t lineStart = 0, lineEnd = 0, pos = 0;
 
-    String current;
-    for (size_t i = 0; i < words.size(); i++) {
-      String test = current.length() ? current + " " + words[i] : words[i];
+    while (nLines < NOTE_MAX_LINES) {
+      int sp = all.find(' ', pos);
+      size_t wEnd = sp < 0 ? all.size() : (size_t)sp;
 
       int w, h;
-      measureText(test, w, h);
+      all.sub(lineStart, wEnd - lineStart).copyTo(probe, sizeof(probe));
+      measureText(probe, w, h);
 
-      if (w > MAX_W && current.length()) {
-        lines.push_back(current);
-        current = words[i];
-      } else {
-        current = test;
+      if (w > MAX_W && lineEnd > lineStart) {
+        lines[nLines++] = all.sub(lineStart, lineEnd - lineStart);
+        lineStart = pos;
       }
+      lineEnd = wEnd;
+
+      if (sp < 0)
+        break;
+      pos = sp + 1;
     }
-    if (current.length())
-      lines.push_back(current);
+    if (lineEnd > lineStart && nLines < NOTE_MAX_LINES)
+      lines[nLines++] = all.sub(lineStart, lineEnd - lineStart);
   }
 
   // misura altezza totale
   int line_w, line_h;
   measureText("Ag", line_w, line_h);
-  int total_h = line_h * lines.size();
+  int total_h = line_h * nLines;
 
   // centratura verticale
   int start_y = NOTE_HEADER_H + (MAX_H - total_h) / 2;
@@ -128,13 +127,15 @@ void pageNotes() {
 
   // stampa
   int y = start_y;
-  for (auto &L : lines) {
+  for (uint8_t i = 0; i < nLines; i++) {
+    const StrView &L = lines[i];
     int w, h;
-    measureText(L, w, h);
+    L.copyTo(probe, sizeof(probe));
+    measureText(probe, w, h);
     int x = (480 - w) / 2;
 
     gfx->setCursor(x, y + h);
-    gfx->print(L);
+    gfx->write((const uint8_t *)L.begin(), L.size());
 
     y += h;
     if (y > 470)
@@ -13,7 +13,10 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
+#include "../handlers/jsonhelpers.h"
+#include "../handlers/httpstream.h"
 #include "../images/qod.h"
 #include <Arduino.h>
 #include <HTTPClient.h>
@@ -32,20 +35,15 @@ extern String g_oa_key;
 extern String g_oa_topic;
 
 extern bool httpGET(const String &, String &, uint32_t);
-extern int indexOfCI(const String &, const String &, int);
-
-extern bool jsonKV(const String &, const char *, String &);
 
 extern String jsonEscape(const String &);
-extern String decodeJsonUnicode(const String &);
 extern String sanitizeText(const String &);
 extern void todayYMD(String &);
 extern void drawHeader(const String &);
 extern void drawBoldMain(int16_t, int16_t, const String &, uint8_t);
 extern void drawParagraph(int16_t, int16_t, int16_t, const String &, uint8_t);
-extern void drawCurrentPage();
 
-extern WebServer web;
+extern AsyncWeb web;
 
 // -----------------------------------------------------------------------------
 // Cache QOD
@@ -55,36 +53,6 @@ static String qod_author;
 static String qod_date_ymd;
 static bool qod_from_ai = false;
 
-// -----------------------------------------------------------------------------
-// Sanitize virgolette + normalizzazione Unicode
-// -----------------------------------------------------------------------------
-static String qodSanitizeQuotes(const String &in) {
-  String s = in;
-
-  s.replace("“", "\"");
-  s.replace("”", "\"");
-  s.replace("„", "\"");
-  s.replace("«", "\"");
-  s.replace("»", "\"");
-  s.replace("‘", "'");
-  s.replace("’", "'");
-  s.replace("—", "-");
-  s.replace("–", "-");
-
-  s.replace("à", "a");
-  s.replace("á", "a");
-  s.replace("è", "e");
-  s.replace("é", "e");
-  s.replace("ê", "e");
-  s.replace("ì", "i");
-  s.replace("ò", "o");
-  s.replace("ó", "o");
-  s.replace("ù", "u");
-  s.replace("ú", "u");
-
-  return s;
-}
-
 // -----------------------------------------------------------------------------
 // Fallback ZenQuotes
 // -----------------------------------------------------------------------------
@@ -93,28 +61,32 @@ static bool fetchQOD_ZenQuotes() {
   if (!httpGET("https://zenquotes.io/api/today", body, 10000))
     return false;
 
-  String q, a;
+  char qb[320], ab[64];
+  JsonQuery jq[] = {jqStr("[0].q", qb, sizeof(qb)),
+                    jqStr("[0].a", ab, sizeof(ab))};
+  jsonExtract(body, jq, 2);
 
-  if (!jsonKV(body, "q", q))
+  if (!jq[0].count)
     return false;
 
-  jsonKV(body, "a", a);
-
-  qod_text = qodSanitizeQuotes(sanitizeText(q));
-  qod_author = qodSanitizeQuotes(sanitizeText(a));
-
-  if (qod_text.length() > 280)
-    qod_text.remove(277);
+  // virgolette e trattini tipografici traslitterati da sanitizeText
+  String text = sanitizeText(qb);
+  if (text.length() > 280)
+    text.remove(277);
 
+  StateLock lock;
+  qod_text = text;
+  qod_author = sanitizeText(ab);
   return true;
 }
 
 // -----------------------------------------------------------------------------
 // OpenAI
 // -----------------------------------------------------------------------------
-static bool fetchQOD_OpenAI() {
+static bool fetchQOD_OpenAI(const String &key, const String &topic,
+                            bool it) {
 
-  if (!g_oa_key.length() || !g_oa_topic.length())
+  if (!key.length() || !topic.length())
     return false;
 
   WiFiClientSecure client;
@@ -122,21 +94,26 @@ static bool fetchQOD_OpenAI() {
 
   HTTPClient http;
   http.setTimeout(10000);
+#ifdef SQUARED_MOCK_API
+  if (!http.begin(httpMockUrl(F("https://api.openai.com/v1/responses"))))
+    return false;
+#else
   if (!http.begin(client, "https://api.openai.com/v1/responses"))
     return false;
+#endif
 
   http.addHeader("Content-Type", "application/json");
-  http.addHeader("Authorization", "Bearer " + g_oa_key);
+  http.addHeader("Authorization", "Bearer " + key);
 
-  String prompt = (g_lang == "it")
+  String prompt = it
                       ? ("Scrivi una frase breve, originale e logicamente "
                          "coerente nello stile di \"" +
-                         g_oa_topic +
+                         topic +
                          "\". Mantieni il tono caratteristico ma evita "
                          "assurdità o parole fuori contesto. Solo la frase.")
                       : ("Write a short, original and coherent sentence in the "
                          "style of \"" +
-                         g_oa_topic +
+                         topic +
                          "\". Keep the tone but avoid absurdity or noise. Only "
                          "the sentence.");
 
@@ -154,30 +131,21 @@ static bool fetchQOD_OpenAI() {
   String resp = http.getString();
   http.end();
 
-  int p = indexOfCI(resp, "\"text\"", 0);
-  if (p < 0)
-    return false;
-
-  p = resp.indexOf('"', p + 6);
-  if (p < 0)
+  // escape e \uXXXX già decodificati da jsonUnescape
+  char text[400];
+  JsonQuery jq = jqStr("output[0].content[0].text", text, sizeof(text));
+  if (!jsonExtract(resp, &jq, 1))
     return false;
 
-  int q = resp.indexOf('"', p + 1);
-  if (q < 0)
-    return false;
-
-  String raw = resp.substring(p + 1, q);
-
-  raw = decodeJsonUnicode(raw);
-  raw.replace("\\n", " ");
-  raw.replace("\\", "");
+  String raw = text;
   raw.trim();
 
-  qod_text = qodSanitizeQuotes(sanitizeText(raw));
-
-  if (qod_text.length() > 280)
-    qod_text.remove(277);
+  raw = sanitizeText(raw);
+  if (raw.length() > 280)
+    raw.remove(277);
 
+  StateLock lock;
+  qod_text = raw;
   qod_author = "AI Generated";
   return qod_text.length() > 0;
 }
@@ -185,23 +153,33 @@ static bool fetchQOD_OpenAI() {
 // -----------------------------------------------------------------------------
 // Master fetch
 // -----------------------------------------------------------------------------
+// Configurazione letta sotto lock, richieste senza lock
 static bool fetchQOD() {
 
   String today;
   todayYMD(today);
 
-  const bool wantAI = (g_oa_key.length() && g_oa_topic.length());
+  String key, topic;
+  bool it;
+  {
+    StateLock lock;
+    key = g_oa_key;
+    topic = g_oa_topic;
+    it = (g_lang == "it");
+
+    const bool wantAI = (key.length() && topic.length());
+    if (qod_text.length() && qod_date_ymd == today) {
+      if ((wantAI && qod_from_ai) || (!wantAI && !qod_from_ai))
+        return true;
+    }
 
-  if (qod_text.length() && qod_date_ymd == today) {
-    if ((wantAI && qod_from_ai) || (!wantAI && !qod_from_ai))
-      return true;
+    qod_text.clear();
+    qod_author.clear();
   }
 
-  qod_text.clear();
-  qod_author.clear();
-
-  if (wantAI) {
-    if (fetchQOD_OpenAI()) {
+  if (key.length() && topic.length()) {
+    if (fetchQOD_OpenAI(key, topic, it)) {
+      StateLock lock;
       qod_date_ymd = today;
       qod_from_ai = true;
       return true;
@@ -209,6 +187,7 @@ static bool fetchQOD() {
   }
 
   if (fetchQOD_ZenQuotes()) {
+    StateLock lock;
     qod_date_ymd = today;
     qod_from_ai = false;
     return true;
@@ -218,21 +197,30 @@ static bool fetchQOD() {
 }
 
 // -----------------------------------------------------------------------------
-// WebUI: forza rigenerazione
+// Rigenerazione forzata: eseguita dal loop (g_forceQodPending)
 // -----------------------------------------------------------------------------
-static void handleForceQOD() {
+static bool forceQOD() {
+  {
+    StateLock lock;
+    qod_text.clear();
+    qod_author.clear();
+    qod_date_ymd.clear();
+    qod_from_ai = false;
+  }
+
+  return fetchQOD();
+}
 
-  qod_text.clear();
-  qod_author.clear();
-  qod_date_ymd.clear();
-  qod_from_ai = false;
+// -----------------------------------------------------------------------------
+// WebUI: richiesta di rigenerazione (il task web non disegna)
+// -----------------------------------------------------------------------------
+static void handleForceQOD() {
 
-  fetchQOD();
-  drawCurrentPage();
+  g_forceQodPending = true;
 
   web.send(200, "text/html; charset=utf-8",
            "<!doctype html><meta charset='utf-8'><body>"
-           "<h3>Frase rigenerata</h3>"
+           "<h3>Nuova frase richiesta</h3>"
            "<p><a href='/settings'>Back</a></p>"
            "</body>");
 }
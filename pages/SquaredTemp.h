@@ -13,6 +13,7 @@
 
 #pragma once
 
+#include "../handlers/asyncweb.h"
 #include "../handlers/globals.h"
 #include "../handlers/jsonhelpers.h"
 #include <Arduino.h>
@@ -40,7 +41,6 @@ extern void drawHeader(const String &title);
 extern void drawBoldMain(int16_t x, int16_t y, const String &raw,
                          uint8_t scale);
 
-extern int indexOfCI(const String &, const String &, int from);
 extern bool httpGET(const String &url, String &out, uint32_t timeout);
 extern bool geocodeIfNeeded();
 
@@ -77,73 +77,34 @@ void tickTemp24Anim() {}
 // ---------------------------------------------------------------------------
 // Fetch da Open-Meteo
 // ---------------------------------------------------------------------------
-static bool fetchTemp24() {
-  for (uint8_t i = 0; i < 24; i++)
-    t24[i] = NAN;
-
+// Rete e interpolazione senza lock, in un buffer del chiamante
+static bool fetchTemp24Into(float *out) {
   if (!geocodeIfNeeded())
     return false;
 
   String url = F("https://api.open-meteo.com/v1/forecast?latitude=");
-  url += g_lat;
-  url += F("&longitude=");
-  url += g_lon;
+  {
+    StateLock lock;
+    url += g_lat;
+    url += F("&longitude=");
+    url += g_lon;
+  }
   url += F("&daily=temperature_2m_mean&forecast_days=7&timezone=auto");
 
   String body;
   if (!httpGET(url, body, 12000))
     return false;
 
-  int16_t posDaily = indexOfCI(body, F("\"daily\""), 0);
-  if (posDaily < 0)
-    return false;
-
-  int16_t posMean = indexOfCI(body, F("\"temperature_2m_mean\""), posDaily);
-  if (posMean < 0)
-    return false;
-
-  int16_t lb = body.indexOf('[', posMean);
-  if (lb < 0)
-    return false;
-
-  int16_t rb = findMatchingBracket(body, lb);
-  if (rb < 0)
-    return false;
-
-  String arr = body.substring(lb + 1, rb);
-
   float seven[7];
-  for (uint8_t i = 0; i < 7; i++)
-    seven[i] = NAN;
-
-  uint8_t idx = 0;
-  int16_t start = 0;
-  const int16_t L = arr.length();
-
-  while (idx < 7 && start < L) {
-    int16_t s = start;
-    while (s < L && !((arr[s] >= '0' && arr[s] <= '9') || arr[s] == '-'))
-      s++;
-    if (s >= L)
-      break;
-
-    int16_t e = s;
-    while (e < L &&
-           ((arr[e] >= '0' && arr[e] <= '9') || arr[e] == '.' || arr[e] == '-'))
-      e++;
-
-    seven[idx++] = arr.substring(s, e).toFloat();
-    start = e + 1;
-  }
-
-  if (!idx)
+  JsonQuery q = jqFloats("daily.temperature_2m_mean", seven, 7);
+  if (!jsonExtract(body, &q, 1))
     return false;
 
   // Anchor positions per 7 valori su 24 slot
   static const uint8_t anchors[7] PROGMEM = {0, 4, 8, 12, 16, 20, 23};
 
   for (uint8_t i = 0; i < 7; i++) {
-    t24[pgm_read_byte(&anchors[i])] = seven[i];
+    out[pgm_read_byte(&anchors[i])] = seven[i];
   }
 
   // Interpolazione lineare
@@ -159,13 +120,26 @@ static bool fetchTemp24() {
 
     float dy = (y2 - y1) / dx;
     for (uint8_t k = 1; k < dx; k++) {
-      t24[x1 + k] = y1 + dy * k;
+      out[x1 + k] = y1 + dy * k;
     }
   }
 
   return true;
 }
 
+static bool fetchTemp24() {
+  float next[24];
+  for (uint8_t i = 0; i < 24; i++)
+    next[i] = NAN;
+
+  const bool ok = fetchTemp24Into(next);
+
+  // fetch fallito: grafico vuoto, niente residui vecchi
+  StateLock lock;
+  memcpy(t24, next, sizeof(t24));
+  return ok;
+}
+
 // ---------------------------------------------------------------------------
 // Helper: formatta temperatura con simbolo gradi
 // ---------------------------------------------------------------------------
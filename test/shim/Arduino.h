@@ -0,0 +1,286 @@
+/*
+===============================================================================
+   SQUARED — SHIM ARDUINO PER I TEST SU HOST
+   Descrizione: il minimo di Arduino core che serve agli header di
+                handlers/ per compilare con g++ su PC: String sopra
+                std::string, PROGMEM come memoria normale, orologio finto
+                (millis/micros/delay) che il test fa avanzare a mano.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • shim_ms                  tempo simulato in ms (millis = shim_ms)
+   • delay(ms), vTaskDelay    fanno avanzare shim_ms, non dormono
+   • esp_random()             restituisce shim_random (fissato dal test)
+   • shim_strings             String costruite (copie comprese): sul
+                              dispositivo ognuna è un'allocazione potenziale
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <freertos/FreeRTOS.h>
+
+using std::max;
+using std::min;
+
+// ============================================================================
+// FLASH / ATTRIBUTI
+// ============================================================================
+#define PROGMEM
+#define IRAM_ATTR
+#define PSTR(s) (s)
+#define PGM_P const char *
+class __FlashStringHelper;
+#define F(s) ((const __FlashStringHelper *)(s))
+#define FPSTR(s) ((const __FlashStringHelper *)(s))
+#define pgm_read_byte(p) (*(const uint8_t *)(p))
+#define pgm_read_word(p) (*(const uint16_t *)(p))
+#define pgm_read_dword(p) (*(const uint32_t *)(p))
+#define pgm_read_float(p) (*(const float *)(p))
+#define pgm_read_ptr(p) (*(const void *const *)(p))
+#define memcpy_P memcpy
+#define strcpy_P strcpy
+#define strlen_P strlen
+#define strcmp_P strcmp
+#define strncmp_P strncmp
+#define snprintf_P snprintf
+
+#define constrain(a, l, h) ((a) < (l) ? (l) : ((a) > (h) ? (h) : (a)))
+
+// ============================================================================
+// TEMPO SIMULATO
+// ============================================================================
+inline uint32_t shim_ms = 0;
+inline uint32_t millis() { return shim_ms; }
+inline uint32_t micros() { return shim_ms * 1000; }
+inline void delay(uint32_t ms) { shim_ms += ms; }
+inline void vTaskDelay(TickType_t t) { shim_ms += t; }
+
+// Task: nessuno scheduler, il test chiama direttamente la funzione del
+// task; l'attesa di una notifica fa avanzare il tempo di quanto richiesto
+inline uint32_t shim_notify_wait = 0; // ultimo timeout di ulTaskNotifyTake
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char *, uint32_t, void *,
+                                          unsigned, TaskHandle_t *h, int) {
+  if (h)
+    *h = (TaskHandle_t)1;
+  return pdPASS;
+}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t t) {
+  shim_notify_wait = t;
+  shim_ms += t;
+  return 0;
+}
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *) {}
+
+inline uint32_t shim_random = 0x12345678;
+inline uint32_t esp_random() { return shim_random; }
+inline void yield() {}
+
+// GPIO: nessun pin reale
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define FALLING 0x02
+inline void pinMode(int, int) {}
+inline void attachInterrupt(int, void (*)(), int) {}
+
+inline long random(long lo, long hi) { return hi > lo ? lo + rand() % (hi - lo) : lo; }
+inline long random(long hi) { return random(0, hi); }
+
+// ============================================================================
+// STRING
+// ============================================================================
+inline size_t shim_strings = 0;
+
+class String {
+public:
+  std::string s;
+
+  String() { shim_strings++; }
+  String(const char *c) : s(c ? c : "") { shim_strings++; }
+  String(const __FlashStringHelper *c) : String((const char *)c) {}
+  String(const std::string &x) : s(x) { shim_strings++; }
+  String(const String &o) : s(o.s) { shim_strings++; }
+  String(String &&o) : s(std::move(o.s)) { shim_strings++; }
+  explicit String(char c) : s(1, c) { shim_strings++; }
+  explicit String(int v) : s(std::to_string(v)) { shim_strings++; }
+  explicit String(unsigned v) : s(std::to_string(v)) { shim_strings++; }
+  explicit String(long v) : s(std::to_string(v)) { shim_strings++; }
+  explicit String(unsigned long v) : s(std::to_string(v)) { shim_strings++; }
+  String(double v, int d) {
+    shim_strings++;
+    char b[64];
+    snprintf(b, sizeof(b), "%.*f", d, v);
+    s = b;
+  }
+
+  String &operator=(const String &o) {
+    s = o.s;
+    return *this;
+  }
+  String &operator=(String &&o) {
+    s = std::move(o.s);
+    return *this;
+  }
+  String &operator=(const char *c) {
+    s = c ? c : "";
+    return *this;
+  }
+  String &operator=(char c) {
+    s.assign(1, c);
+    return *this;
+  }
+
+  const char *c_str() const { return s.c_str(); }
+  unsigned length() const { return s.size(); }
+  bool isEmpty() const { return s.empty(); }
+  void clear() { s.clear(); }
+  bool reserve(unsigned n) {
+    s.reserve(n);
+    return true;
+  }
+
+  bool concat(const char *d, unsigned n) {
+    s.append(d, n);
+    return true;
+  }
+  bool concat(const char *d) {
+    s += d;
+    return true;
+  }
+  bool concat(char c) {
+    s += c;
+    return true;
+  }
+  String &operator+=(const String &o) {
+    s += o.s;
+    return *this;
+  }
+  String &operator+=(const char *o) {
+    s += o;
+    return *this;
+  }
+  String &operator+=(const __FlashStringHelper *o) {
+    s += (const char *)o;
+    return *this;
+  }
+  String &operator+=(char c) {
+    s += c;
+    return *this;
+  }
+  String &operator+=(int v) {
+    s += std::to_string(v);
+    return *this;
+  }
+
+  char operator[](unsigned i) const { return i < s.size() ? s[i] : 0; }
+  char &operator[](unsigned i) { return s[i]; }
+  char charAt(unsigned i) const { return (*this)[i]; }
+  void setCharAt(unsigned i, char c) {
+    if (i < s.size())
+      s[i] = c;
+  }
+
+  bool operator==(const String &o) const { return s == o.s; }
+  bool operator==(const char *o) const { return s == o; }
+  bool operator!=(const String &o) const { return s != o.s; }
+  bool operator!=(const char *o) const { return s != o; }
+  bool equals(const String &o) const { return s == o.s; }
+  bool equalsIgnoreCase(const String &o) const {
+    return s.size() == o.s.size() && !strncasecmp(s.c_str(), o.s.c_str(), s.size());
+  }
+
+  int indexOf(char c, unsigned from = 0) const { return pos(s.find(c, from)); }
+  int indexOf(const char *c, unsigned from = 0) const { return pos(s.find(c, from)); }
+  int indexOf(const String &c, unsigned from = 0) const { return pos(s.find(c.s, from)); }
+  int indexOf(const __FlashStringHelper *c, unsigned from = 0) const {
+    return indexOf((const char *)c, from);
+  }
+  int lastIndexOf(char c) const { return pos(s.rfind(c)); }
+  int lastIndexOf(char c, unsigned from) const { return pos(s.rfind(c, from)); }
+
+  const char *begin() const { return s.data(); }
+  const char *end() const { return s.data() + s.size(); }
+
+  String substring(unsigned a) const { return a >= s.size() ? String() : String(s.substr(a)); }
+  String substring(unsigned a, unsigned b) const {
+    if (b > s.size())
+      b = s.size();
+    return a >= b ? String() : String(s.substr(a, b - a));
+  }
+  bool startsWith(const String &p) const { return s.rfind(p.s, 0) == 0; }
+  bool endsWith(const String &p) const {
+    return s.size() >= p.s.size() && !s.compare(s.size() - p.s.size(), p.s.size(), p.s);
+  }
+
+  void trim() {
+    size_t a = 0, b = s.size();
+    while (a < b && isspace((unsigned char)s[a]))
+      a++;
+    while (b > a && isspace((unsigned char)s[b - 1]))
+      b--;
+    s = s.substr(a, b - a);
+  }
+  void toLowerCase() {
+    for (auto &c : s)
+      c = tolower((unsigned char)c);
+  }
+  void toUpperCase() {
+    for (auto &c : s)
+      c = toupper((unsigned char)c);
+  }
+  void remove(unsigned i) {
+    if (i < s.size())
+      s.resize(i);
+  }
+  void remove(unsigned i, unsigned n) {
+    if (i < s.size())
+      s.erase(i, n);
+  }
+  void replace(const String &a, const String &b) {
+    size_t p = 0;
+    while (!a.s.empty() && (p = s.find(a.s, p)) != std::string::npos) {
+      s.replace(p, a.s.size(), b.s);
+      p += b.s.size();
+    }
+  }
+
+  long toInt() const { return atol(s.c_str()); }
+  float toFloat() const { return atof(s.c_str()); }
+  double toDouble() const { return atof(s.c_str()); }
+
+private:
+  static int pos(size_t p) { return p == std::string::npos ? -1 : (int)p; }
+};
+
+inline String operator+(const String &a, const String &b) { return String(a.s + b.s); }
+inline String operator+(const String &a, const char *b) { return String(a.s + b); }
+inline String operator+(const char *a, const String &b) { return String(a + b.s); }
+inline String operator+(const String &a, char b) { return String(a.s + b); }
+
+inline size_t strlcpy(char *d, const char *s, size_t n) {
+  const size_t l = strlen(s);
+  if (n) {
+    const size_t k = l < n - 1 ? l : n - 1;
+    memcpy(d, s, k);
+    d[k] = 0;
+  }
+  return l;
+}
+
+// avr-libc: v con prec decimali, larghezza minima w
+inline char *dtostrf(double v, signed char w, unsigned char prec, char *out) {
+  sprintf(out, "%*.*f", w, prec, v);
+  return out;
+}
@@ -0,0 +1,192 @@
+#pragma once
+// Arduino_GFX su host: display RGB 480×480 col suo framebuffer (allocato
+// dal test) e un raster minimo con le primitive usate dagli handler. Ogni
+// pixel scritto conta in writes e, se il test li alloca, in perPx[] (per
+// trovare i pixel scritti due volte nello stesso disegno)
+#include <Arduino.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#define RGB565_BLACK 0x0000
+
+class Arduino_RGB_Display {
+public:
+  explicit Arduino_RGB_Display(uint16_t *fb = nullptr) : _framebuffer(fb) {}
+  virtual ~Arduino_RGB_Display() {}
+  uint16_t *getFramebuffer() { return _framebuffer; }
+
+  uint64_t writes = 0;
+  uint8_t *perPx = nullptr; // 480×480 contatori, opzionale
+
+  // Avvio del pannello: niente da fare su host
+  bool begin() { return true; }
+  void setRotation(uint8_t) {}
+  void displayOn() {}
+  void startWrite() {}
+  void endWrite() {}
+  int16_t width() const { return 480; }
+  int16_t height() const { return 480; }
+
+  void fillScreen(uint16_t c) { fillRect(0, 0, 480, 480, c); }
+
+  void drawPixel(int x, int y, uint16_t c) { px(x, y, c); }
+
+  void drawLine(int x0, int y0, int x1, int y1, uint16_t c) {
+    const int dx = abs(x1 - x0), dy = -abs(y1 - y0);
+    const int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    for (int e = dx + dy;;) {
+      px(x0, y0, c);
+      if (x0 == x1 && y0 == y1)
+        break;
+      const int e2 = 2 * e;
+      if (e2 >= dy) {
+        e += dy;
+        x0 += sx;
+      }
+      if (e2 <= dx) {
+        e += dx;
+        y0 += sy;
+      }
+    }
+  }
+
+  void drawRect(int x, int y, int w, int h, uint16_t c) {
+    fillRect(x, y, w, 1, c);
+    fillRect(x, y + h - 1, w, 1, c);
+    fillRect(x, y + 1, 1, h - 2, c);
+    fillRect(x + w - 1, y + 1, 1, h - 2, c);
+  }
+
+  void draw16bitRGBBitmap(int x, int y, const uint16_t *b, int w, int h) {
+    for (int j = 0; j < h; j++)
+      for (int i = 0; i < w; i++)
+        px(x + i, y + j, b[j * w + i]);
+  }
+
+  void fillRect(int x, int y, int w, int h, uint16_t c) {
+    for (int j = y; j < y + h; j++)
+      for (int i = x; i < x + w; i++)
+        px(i, j, c);
+  }
+
+  void drawFastHLine(int x, int y, int w, uint16_t c) { fillRect(x, y, w, 1, c); }
+  void drawFastVLine(int x, int y, int h, uint16_t c) { fillRect(x, y, 1, h, c); }
+
+  void fillRoundRect(int x, int y, int w, int h, int r, uint16_t c) {
+    for (int j = 0; j < h; j++)
+      for (int i = 0; i < w; i++)
+        if (inRound(i, j, w, h, r))
+          px(x + i, y + j, c);
+  }
+
+  void drawRoundRect(int x, int y, int w, int h, int r, uint16_t c) {
+    for (int j = 0; j < h; j++)
+      for (int i = 0; i < w; i++) {
+        if (!inRound(i, j, w, h, r))
+          continue;
+        const bool inner = i > 0 && j > 0 && i < w - 1 && j < h - 1 &&
+                           inRound(i - 1, j, w, h, r) && inRound(i + 1, j, w, h, r) &&
+                           inRound(i, j - 1, w, h, r) && inRound(i, j + 1, w, h, r);
+        if (!inner)
+          px(x + i, y + j, c);
+      }
+  }
+
+  void fillCircle(int x, int y, int r, uint16_t c) {
+    for (int j = -r; j <= r; j++)
+      for (int i = -r; i <= r; i++)
+        if (i * i + j * j <= r * r)
+          px(x + i, y + j, c);
+  }
+
+  void drawCircle(int x, int y, int r, uint16_t c) {
+    for (int j = -r; j <= r; j++)
+      for (int i = -r; i <= r; i++) {
+        const int d = i * i + j * j;
+        if (d <= r * r && d > (r - 1) * (r - 1))
+          px(x + i, y + j, c);
+      }
+  }
+
+  void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t c) {
+    const int xa = std::min({x0, x1, x2}), xb = std::max({x0, x1, x2});
+    const int ya = std::min({y0, y1, y2}), yb = std::max({y0, y1, y2});
+    for (int j = ya; j <= yb; j++)
+      for (int i = xa; i <= xb; i++) {
+        const long e0 = (long)(x1 - x0) * (j - y0) - (long)(y1 - y0) * (i - x0);
+        const long e1 = (long)(x2 - x1) * (j - y1) - (long)(y2 - y1) * (i - x1);
+        const long e2 = (long)(x0 - x2) * (j - y2) - (long)(y0 - y2) * (i - x2);
+        if ((e0 >= 0 && e1 >= 0 && e2 >= 0) || (e0 <= 0 && e1 <= 0 && e2 <= 0))
+          px(i, j, c);
+      }
+  }
+
+  // Testo: celle 6×8 come il font di default; glifo finto ma deterministico.
+  // Con un solo colore solo i pixel accesi, con lo sfondo la cella intera
+  void setTextSize(uint8_t s) { _ts = s; }
+  void setTextColor(uint16_t c) { _fg = _bg = c; }
+  void setTextColor(uint16_t c, uint16_t b) {
+    _fg = c;
+    _bg = b;
+  }
+  void setCursor(int x, int y) {
+    _cx = x;
+    _cy = y;
+  }
+
+  size_t write(uint8_t ch) {
+    for (int j = 0; j < 8; j++)
+      for (int i = 0; i < 6; i++) {
+        const bool on = i < 5 && (ch * 131 + i * 7 + j * 13) % 3 == 0;
+        if (on || _bg != _fg)
+          fillRect(_cx + i * _ts, _cy + j * _ts, _ts, _ts, on ? _fg : _bg);
+      }
+    _cx += 6 * _ts;
+    return 1;
+  }
+
+  size_t write(const uint8_t *b, size_t n) {
+    for (size_t i = 0; i < n; i++)
+      write(b[i]);
+    return n;
+  }
+
+  void print(const char *s) {
+    while (*s)
+      write(*s++);
+  }
+  void print(const __FlashStringHelper *s) { print((const char *)s); }
+  void print(const String &s) { print(s.c_str()); }
+  void print(char c) { write(c); }
+  void print(long v) { print(String(v)); }
+  void print(int v) { print((long)v); }
+  void print(unsigned long v) { print(String(v)); }
+  void print(unsigned v) { print((unsigned long)v); }
+  void print(double v, int d = 2) { print(String(v, d)); }
+
+protected:
+  uint16_t *_framebuffer;
+
+private:
+  uint8_t _ts = 1;
+  uint16_t _fg = 0xFFFF, _bg = 0xFFFF;
+  int _cx = 0, _cy = 0;
+
+  void px(int x, int y, uint16_t c) {
+    if (x < 0 || y < 0 || x >= 480 || y >= 480)
+      return;
+    if (_framebuffer)
+      _framebuffer[y * 480 + x] = c;
+    if (perPx && perPx[y * 480 + x] < 255)
+      perPx[y * 480 + x]++;
+    writes++;
+  }
+
+  static bool inRound(int i, int j, int w, int h, int r) {
+    const int cx = i < r ? r : (i >= w - r ? w - r - 1 : i);
+    const int cy = j < r ? r : (j >= h - r ? h - r - 1 : j);
+    return (i - cx) * (i - cx) + (j - cy) * (j - cy) <= r * r;
+  }
+};
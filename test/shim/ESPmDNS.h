@@ -0,0 +1,13 @@
+#pragma once
+// mDNS su host: nessun servizio in rete (il test configura l'IP a mano)
+#include <WiFi.h>
+
+struct ShimMDNS {
+  int queries = 0;
+  int queryService(const char *, const char *) {
+    queries++;
+    return 0;
+  }
+  IPAddress IP(int) { return IPAddress(); }
+};
+inline ShimMDNS MDNS;
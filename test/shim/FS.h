@@ -0,0 +1,42 @@
+#pragma once
+// FS di Arduino su host: File sopra un file in memoria di ShimFS
+// (LittleFS.h). Le scritture vanno direttamente nel file aperto.
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+struct ShimFile {
+  std::string *data = nullptr;
+  size_t pos = 0;
+  size_t writeCap = (size_t)-1; // byte ancora scrivibili (flash piena)
+};
+
+class File {
+public:
+  File() {}
+  explicit File(const ShimFile &f) : f(f), open(true) {}
+  explicit operator bool() const { return open; }
+
+  size_t write(const uint8_t *b, size_t n) {
+    if (!open)
+      return 0;
+    const size_t k = n < f.writeCap ? n : f.writeCap;
+    f.writeCap -= k;
+    f.data->append((const char *)b, k);
+    return k;
+  }
+  size_t read(uint8_t *b, size_t n) {
+    if (!open)
+      return 0;
+    const size_t k = std::min(n, f.data->size() - f.pos);
+    memcpy(b, f.data->data() + f.pos, k);
+    f.pos += k;
+    return k;
+  }
+  size_t size() const { return open ? f.data->size() : 0; }
+  void close() { open = false; }
+
+private:
+  ShimFile f;
+  bool open = false;
+};
@@ -0,0 +1,45 @@
+#pragma once
+// HTTPClient finto: ogni GET risponde con shim_http (status, codifica,
+// body) e il body arriva dallo "socket" in pezzi di shim_http.chunk byte.
+// POST registra il body inviato e risponde allo stesso modo.
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+
+class HTTPClient {
+public:
+  void setTimeout(uint32_t) {}
+  void useHTTP10(bool) {}
+  bool begin(const String &url) {
+    shimHttpRoute(url.s);
+    shim_http.headers.clear();
+    shim_http.sent = 0;
+    return true;
+  }
+  bool begin(WiFiClientSecure &, const String &url) { return begin(url); }
+  void addHeader(const String &k, const String &v) {
+    shim_http.headers.push_back(k.s + ": " + v.s);
+  }
+  void collectHeaders(const char **, size_t) {}
+  int GET() { return shim_http.miss ? 404 : shim_http.status; }
+  int POST(const String &b) {
+    shim_http.posted = b.s;
+    return GET();
+  }
+  String getString() {
+    const std::vector<uint8_t> &w = shim_http.wire();
+    shim_http.sent = w.size();
+    return String(std::string(w.begin(), w.end()));
+  }
+  String header(const char *k) {
+    return strcasecmp(k, "Content-Encoding") ? String() : String(shim_http.encoding);
+  }
+  int getSize() { return shim_http.sendLength ? (int)shim_http.wire().size() : -1; }
+  bool connected() {
+    return shim_http.sent < std::min(shim_http.wire().size(), shim_http.closeAt);
+  }
+  WiFiClient *getStreamPtr() { return &client; }
+  void end() {}
+
+private:
+  WiFiClient client;
+};
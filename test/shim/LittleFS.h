@@ -0,0 +1,42 @@
+#pragma once
+// LittleFS su host: file in una mappa percorso → byte. Contatori di
+// scritture e rename; fullAfter limita i byte scrivibili del prossimo
+// open("w") (scrittura corta), failRename fa fallire il prossimo rename.
+#include <FS.h>
+
+class ShimFS {
+public:
+  std::map<std::string, std::string> files;
+  int opensW = 0, renames = 0;
+  bool mountOk = true, failRename = false;
+  size_t fullAfter = (size_t)-1;
+
+  bool begin(bool = false) { return mountOk; }
+  bool exists(const char *p) const { return files.count(p) > 0; }
+
+  File open(const char *p, const char *mode) {
+    ShimFile f;
+    if (mode[0] == 'w') {
+      opensW++;
+      files[p].clear();
+      f.writeCap = fullAfter;
+      fullAfter = (size_t)-1;
+    } else if (!files.count(p)) {
+      return File();
+    }
+    f.data = &files[p];
+    return File(f);
+  }
+  bool rename(const char *from, const char *to) {
+    if (failRename || !files.count(from)) {
+      failRename = false;
+      return false;
+    }
+    renames++;
+    files[to] = files[from];
+    files.erase(from);
+    return true;
+  }
+  bool remove(const char *p) { return files.erase(p) > 0; }
+};
+inline ShimFS LittleFS;
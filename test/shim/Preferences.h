@@ -0,0 +1,87 @@
+#pragma once
+// Preferences (NVS) su host: chiavi in memoria che sopravvivono a
+// end()/begin() come in flash. Ogni put* conta come una scrittura NVS;
+// le scritture con il namespace aperto in sola lettura sono contate a
+// parte (errori) e non cambiano niente.
+#include <Arduino.h>
+#include <map>
+#include <string>
+
+class Preferences {
+public:
+  std::map<std::string, std::string> kv; // valori come byte grezzi
+  int puts = 0, roPuts = 0, begins = 0, opened = 0;
+  std::map<std::string, int> putsPerKey;
+
+  bool begin(const char *, bool readOnly = false) {
+    begins++;
+    opened++;
+    ro = readOnly;
+    return true;
+  }
+  void end() { opened--; }
+
+  size_t putString(const char *k, const String &v) { return put(k, v.c_str(), v.length()); }
+  size_t putBool(const char *k, bool v) {
+    const uint8_t b = v;
+    return put(k, &b, 1);
+  }
+  size_t putUChar(const char *k, uint8_t v) { return put(k, &v, 1); }
+  size_t putUInt(const char *k, uint32_t v) { return put(k, &v, 4); }
+  size_t putBytes(const char *k, const void *v, size_t n) { return put(k, v, n); }
+
+  String getString(const char *k, const String &def = String()) {
+    auto it = kv.find(k);
+    if (it == kv.end())
+      return def;
+    String s;
+    s.concat(it->second.data(), it->second.size());
+    return s;
+  }
+  bool getBool(const char *k, bool def = false) {
+    auto it = kv.find(k);
+    return it == kv.end() || it->second.size() != 1 ? def : it->second[0] != 0;
+  }
+  uint8_t getUChar(const char *k, uint8_t def = 0) {
+    auto it = kv.find(k);
+    return it == kv.end() || it->second.size() != 1 ? def : (uint8_t)it->second[0];
+  }
+  uint32_t getUInt(const char *k, uint32_t def = 0) {
+    auto it = kv.find(k);
+    if (it == kv.end() || it->second.size() != 4)
+      return def;
+    uint32_t v;
+    memcpy(&v, it->second.data(), 4);
+    return v;
+  }
+  size_t getBytesLength(const char *k) {
+    auto it = kv.find(k);
+    return it == kv.end() ? 0 : it->second.size();
+  }
+  size_t getBytes(const char *k, void *buf, size_t n) {
+    auto it = kv.find(k);
+    if (it == kv.end() || n < it->second.size())
+      return 0;
+    memcpy(buf, it->second.data(), it->second.size());
+    return it->second.size();
+  }
+
+  void resetCounters() {
+    puts = roPuts = begins = 0;
+    putsPerKey.clear();
+  }
+
+private:
+  bool ro = false;
+
+  size_t put(const char *k, const void *v, size_t n) {
+    if (ro || opened <= 0) {
+      roPuts++;
+      return 0;
+    }
+    puts++;
+    putsPerKey[k]++;
+    kv[k].assign((const char *)v, n);
+    return n;
+  }
+};
@@ -0,0 +1,27 @@
+#pragma once
+// TAMC_GT911 su host: read() chiama shim_gt911_read, che il test usa per
+// riempire touches/points con il campione successivo di una traccia
+#include <cstdint>
+#include <functional>
+
+struct TP {
+  uint8_t id;
+  uint16_t x, y, size;
+};
+
+class TAMC_GT911 {
+public:
+  uint8_t touches = 0;
+  TP points[5] = {};
+
+  TAMC_GT911(uint8_t, uint8_t, int, int, uint16_t, uint16_t) {}
+  void begin() {}
+  void setRotation(uint8_t) {}
+  void read();
+};
+
+inline std::function<void(TAMC_GT911 &)> shim_gt911_read;
+inline void TAMC_GT911::read() {
+  if (shim_gt911_read)
+    shim_gt911_read(*this);
+}
@@ -0,0 +1,108 @@
+#pragma once
+// WiFi di Arduino-ESP32 su host: registra le chiamate del codice
+// (begin con/senza BSSID, disconnect, setSleep) e conserva le callback
+// di onEvent; il test simula il driver con shimWifiEvent().
+#include <Arduino.h>
+#include <WiFiClient.h>
+#include <vector>
+
+typedef enum {
+  ARDUINO_EVENT_WIFI_STA_CONNECTED = 4,
+  ARDUINO_EVENT_WIFI_STA_DISCONNECTED = 5,
+  ARDUINO_EVENT_WIFI_STA_GOT_IP = 7,
+  ARDUINO_EVENT_WIFI_STA_LOST_IP = 8,
+} arduino_event_id_t;
+
+typedef struct {
+  struct {
+    uint8_t reason;
+  } wifi_sta_disconnected;
+} arduino_event_info_t;
+
+typedef void (*WiFiEventFuncCb)(arduino_event_id_t, arduino_event_info_t);
+typedef enum { WIFI_OFF = 0, WIFI_STA = 1, WIFI_AP = 2, WIFI_AP_STA = 3 } wifi_mode_t;
+
+class IPAddress {
+public:
+  uint8_t b[4] = {0, 0, 0, 0};
+  uint8_t operator[](int i) const { return b[i]; }
+  bool fromString(const String &s) { return fromString(s.c_str()); }
+  bool fromString(const char *s) {
+    unsigned v[4];
+    char tail;
+    if (sscanf(s, "%u.%u.%u.%u%c", &v[0], &v[1], &v[2], &v[3], &tail) != 4)
+      return false;
+    for (int i = 0; i < 4; i++) {
+      if (v[i] > 255)
+        return false;
+      b[i] = v[i];
+    }
+    return true;
+  }
+};
+
+struct ShimWiFi {
+  // chiamate registrate
+  int beginsFast = 0, beginsScan = 0, disconnects = 0, sleepChanges = 0, configs = 0;
+  uint8_t lastChannel = 0;
+  uint8_t lastBssid[6] = {0};
+  bool sleep = true, autoReconnect = true, persist = true;
+  wifi_mode_t m = WIFI_OFF;
+  std::vector<std::pair<WiFiEventFuncCb, arduino_event_id_t>> cbs;
+  // AP a cui il driver è associato
+  uint8_t apBssid[6] = {0x24, 0x5A, 0x4C, 0x01, 0x02, 0x03};
+  uint8_t apChannel = 6;
+  bool associated = false;
+
+  void persistent(bool p) { persist = p; }
+  bool mode(wifi_mode_t v) {
+    m = v;
+    return true;
+  }
+  wifi_mode_t getMode() { return m; }
+  bool setSleep(bool s) {
+    sleep = s;
+    sleepChanges++;
+    return true;
+  }
+  bool setAutoReconnect(bool a) {
+    autoReconnect = a;
+    return true;
+  }
+  void onEvent(WiFiEventFuncCb cb, arduino_event_id_t e) { cbs.push_back({cb, e}); }
+  IPAddress cfg[4]; // ip, gateway, mask, dns dell'ultimo config()
+  bool config(IPAddress ip, IPAddress gw, IPAddress mask, IPAddress dns) {
+    cfg[0] = ip, cfg[1] = gw, cfg[2] = mask, cfg[3] = dns;
+    configs++;
+    return true;
+  }
+  bool disconnect(bool = false, bool = false) {
+    disconnects++;
+    associated = false;
+    return true;
+  }
+  int begin(const char *, const char *, int32_t ch = 0, const uint8_t *bssid = nullptr) {
+    if (bssid) {
+      beginsFast++;
+      lastChannel = ch;
+      memcpy(lastBssid, bssid, 6);
+    } else {
+      beginsScan++;
+    }
+    return 0;
+  }
+  uint8_t *BSSID() { return associated ? apBssid : nullptr; }
+  int32_t channel() { return associated ? apChannel : 0; }
+};
+inline ShimWiFi WiFi;
+
+// Evento dal task del driver verso le callback registrate
+inline void shimWifiEvent(arduino_event_id_t e, uint8_t reason = 0) {
+  if (e == ARDUINO_EVENT_WIFI_STA_GOT_IP)
+    WiFi.associated = true;
+  arduino_event_info_t info{};
+  info.wifi_sta_disconnected.reason = reason;
+  for (auto &c : WiFi.cbs)
+    if (c.second == e)
+      c.first(e, info);
+}
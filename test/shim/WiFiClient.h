@@ -0,0 +1,92 @@
+#pragma once
+// WiFiClient su host. Costruito vuoto è lo stream di HTTPClient: legge il
+// body di shim_http o, se il test registra shim_http.routes, quello della
+// rotta che compare nell'URL (nessuna: 404). Costruito da un fd
+// (websocket.h) è un socket POSIX.
+#include <Arduino.h>
+#include <cstdint>
+#include <string>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+struct ShimHttp {
+  int status = 200;
+  std::string encoding;      // Content-Encoding
+  std::vector<uint8_t> body; // byte sul filo (già compressi)
+  bool sendLength = true;    // false = Content-Length assente (-1)
+  size_t chunk = 1460;       // byte disponibili per available()
+  size_t closeAt = SIZE_MAX; // il server chiude dopo closeAt byte
+  std::string url;           // ultimo URL richiesto
+  std::vector<std::string> headers;
+  std::string posted;        // body dell'ultimo POST
+  size_t sent = 0;
+  int requests = 0;
+  // (pezzo di URL, byte sul filo): risposta per URL, letta senza copiarla
+  std::vector<std::pair<std::string, std::vector<uint8_t>>> routes;
+  const std::vector<uint8_t> *route = nullptr;
+  bool miss = false; // rotte registrate ma nessuna per l'URL: 404
+
+  const std::vector<uint8_t> &wire() const { return route ? *route : body; }
+};
+inline ShimHttp shim_http;
+
+inline void shimHttpRoute(const std::string &url) {
+  shim_http.url = url;
+  shim_http.requests++;
+  shim_http.route = nullptr;
+  shim_http.miss = !shim_http.routes.empty();
+  for (const auto &r : shim_http.routes)
+    if (url.find(r.first) != std::string::npos) {
+      shim_http.route = &r.second;
+      shim_http.miss = false;
+      return;
+    }
+}
+
+class WiFiClient {
+public:
+  WiFiClient() {}
+  explicit WiFiClient(int fd) : fd_(fd) {}
+
+  size_t available() {
+    if (fd_ >= 0) {
+      uint8_t b[1460];
+      const ssize_t n = recv(fd_, b, sizeof(b), MSG_PEEK | MSG_DONTWAIT);
+      return n > 0 ? n : 0;
+    }
+    const size_t left = std::min(shim_http.wire().size(), shim_http.closeAt) - shim_http.sent;
+    return left < shim_http.chunk ? left : shim_http.chunk;
+  }
+  int read() {
+    uint8_t c;
+    return read(&c, 1) == 1 ? c : -1;
+  }
+  int read(uint8_t *b, size_t n) {
+    if (fd_ >= 0)
+      return recv(fd_, b, n, 0);
+    const std::vector<uint8_t> &w = shim_http.wire();
+    n = std::min(n, w.size() - shim_http.sent);
+    memcpy(b, w.data() + shim_http.sent, n);
+    shim_http.sent += n;
+    return n;
+  }
+  size_t write(const uint8_t *b, size_t n) {
+    const ssize_t w = fd_ >= 0 ? send(fd_, b, n, MSG_NOSIGNAL) : -1;
+    return w > 0 ? w : 0;
+  }
+  bool connected() {
+    uint8_t c;
+    return fd_ >= 0 && recv(fd_, &c, 1, MSG_PEEK | MSG_DONTWAIT) != 0;
+  }
+  void setNoDelay(bool) {}
+  void stop() {
+    if (fd_ >= 0)
+      close(fd_);
+    fd_ = -1;
+  }
+
+private:
+  int fd_ = -1;
+};
@@ -0,0 +1,8 @@
+#pragma once
+// WiFiClientSecure su host: solo il tipo da passare a HTTPClient::begin
+#include <WiFiClient.h>
+
+class WiFiClientSecure : public WiFiClient {
+public:
+  void setInsecure() {}
+};
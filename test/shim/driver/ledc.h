@@ -0,0 +1,105 @@
+#pragma once
+// LEDC su host: la rampa "gira in hardware" sul tempo di shim_ms e
+// shimLedcRun() consegna l'interrupt di fine rampa (subito, in ritardo o
+// mai, a scelta del test). ledcSetup/ledcAttachPin/ledcWrite (esp32-hal
+// nell'Arduino core) sono qui perché li usa solo backlight.h
+#include <Arduino.h>
+
+typedef int ledc_mode_t;
+typedef int ledc_channel_t;
+typedef int ledc_fade_mode_t;
+typedef int esp_err_t;
+
+#define LEDC_LOW_SPEED_MODE 0
+#define LEDC_FADE_NO_WAIT 0
+
+enum ledc_cb_event_t { LEDC_FADE_END_EVT = 0 };
+
+struct ledc_cb_param_t {
+  ledc_cb_event_t event;
+  uint32_t speed_mode;
+  uint32_t channel;
+  uint32_t duty;
+};
+
+typedef bool (*ledc_cb_t)(const ledc_cb_param_t *, void *);
+
+struct ledc_cbs_t {
+  ledc_cb_t fade_cb;
+};
+
+struct ShimLedc {
+  ledc_cb_t cb = nullptr;
+  int installs = 0, setups = 0;
+  uint32_t duty = 0;          // duty sul pin
+  uint32_t from = 0, to = 0;  // rampa hardware in corso
+  uint32_t t0 = 0, ms = 0;
+  bool running = false;
+  bool irq = true;            // false: fine rampa senza interrupt
+  int fades = 0, writes = 0;
+  int overlaps = 0;           // fade_start con rampa in corso (IDF 4.4 blocca)
+  uint32_t lastEnd = 0;       // duty dell'ultimo interrupt consegnato
+};
+inline ShimLedc shim_ledc;
+
+// Avanza la rampa fino a shim_ms; a fine rampa l'interrupt (se irq)
+inline void shimLedcRun() {
+  ShimLedc &h = shim_ledc;
+  if (!h.running)
+    return;
+  const uint32_t e = shim_ms - h.t0;
+  if (e < h.ms) {
+    h.duty = h.from + ((int32_t)h.to - (int32_t)h.from) * (int32_t)e / (int32_t)h.ms;
+    return;
+  }
+  h.duty = h.to;
+  h.running = false;
+  if (h.irq && h.cb) {
+    const ledc_cb_param_t p = {LEDC_FADE_END_EVT, 0, 0, h.to};
+    h.lastEnd = h.to;
+    h.cb(&p, nullptr);
+  }
+}
+
+// Interrupt consegnato a mano (es. in ritardo, dopo una nuova rampa)
+inline void shimLedcIrq(uint32_t duty) {
+  const ledc_cb_param_t p = {LEDC_FADE_END_EVT, 0, 0, duty};
+  shim_ledc.lastEnd = duty;
+  if (shim_ledc.cb)
+    shim_ledc.cb(&p, nullptr);
+}
+
+inline esp_err_t ledc_fade_func_install(int) {
+  shim_ledc.installs++;
+  return 0;
+}
+
+inline esp_err_t ledc_cb_register(ledc_mode_t, ledc_channel_t, ledc_cbs_t *c, void *) {
+  shim_ledc.cb = c->fade_cb;
+  return 0;
+}
+
+inline esp_err_t ledc_set_fade_with_time(ledc_mode_t, ledc_channel_t, uint32_t duty, int ms) {
+  shim_ledc.from = shim_ledc.duty;
+  shim_ledc.to = duty;
+  shim_ledc.ms = ms;
+  return 0;
+}
+
+inline esp_err_t ledc_fade_start(ledc_mode_t, ledc_channel_t, ledc_fade_mode_t) {
+  if (shim_ledc.running)
+    shim_ledc.overlaps++;
+  shim_ledc.t0 = shim_ms;
+  shim_ledc.running = true;
+  shim_ledc.fades++;
+  return 0;
+}
+
+inline void ledcSetup(uint8_t, uint32_t, uint8_t) { shim_ledc.setups++; }
+inline void ledcAttachPin(uint8_t, uint8_t) {}
+
+inline void ledcWrite(uint8_t, uint32_t duty) {
+  shim_ledc.running = false; // duty fisso: la rampa hardware si ferma
+  shim_ledc.duty = duty;
+  shim_ledc.writes++;
+}
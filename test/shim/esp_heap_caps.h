@@ -0,0 +1,29 @@
+#pragma once
+// Heap ESP-IDF su host: PSRAM e RAM interna sono lo stesso malloc.
+// shim_caps_now / shim_caps_peak contano i byte presi con heap_caps_*
+// (liberati con heap_caps_free; un free() diretto non li scala)
+#include <cstdlib>
+#include <cstring>
+#include <malloc.h>
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+inline size_t shim_caps_now = 0, shim_caps_peak = 0;
+inline void *shimCapsNote(void *p, size_t was) {
+  shim_caps_now += (p ? malloc_usable_size(p) : 0) - was;
+  if (shim_caps_now > shim_caps_peak)
+    shim_caps_peak = shim_caps_now;
+  return p;
+}
+inline void *heap_caps_malloc(size_t n, uint32_t) { return shimCapsNote(malloc(n), 0); }
+inline void *heap_caps_calloc(size_t n, size_t k, uint32_t) { return shimCapsNote(calloc(n, k), 0); }
+inline void *heap_caps_realloc(void *p, size_t n, uint32_t) {
+  const size_t was = p ? malloc_usable_size(p) : 0;
+  void *q = realloc(p, n);
+  return q ? shimCapsNote(q, was) : q;
+}
+inline void heap_caps_free(void *p) {
+  if (p)
+    shim_caps_now -= malloc_usable_size(p);
+  free(p);
+}
@@ -0,0 +1,218 @@
+#pragma once
+// esp_http_server finto: gli handler registrati restano in shim_httpd e il
+// test li chiama con una richiesta costruita a mano. La risposta (status,
+// tipo, header, body) viene registrata; ogni scrittura sul socket fatta
+// con StateLock preso viene contata in lockedSends; firstUs e firstBytes
+// dicono quando e con quanti byte parte la prima (keepBody = false: solo
+// conteggi, nessuna allocazione per registrare il body). Con failAt > 0 la
+// scrittura numero failAt e le successive falliscono (client chiuso);
+// con sendDelayUs ogni scrittura aspetta (client lento). Più thread
+// possono chiamare shimHttpdRequest(): come nel task di httpd gira una
+// richiesta alla volta.
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sys/types.h>
+#include <utility>
+#include <vector>
+
+#include <freertos/semphr.h>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+enum http_method { HTTP_DELETE = 0, HTTP_GET, HTTP_HEAD, HTTP_POST, HTTP_PUT, HTTP_PATCH = 28 };
+typedef enum http_method httpd_method_t;
+
+#define HTTPD_SOCK_ERR_TIMEOUT -3
+#define HTTPD_RESP_USE_STRLEN -1
+
+typedef void *httpd_handle_t;
+typedef void (*httpd_work_fn_t)(void *arg);
+typedef void (*httpd_close_func_t)(httpd_handle_t hd, int sockfd);
+typedef void (*httpd_free_ctx_fn_t)(void *ctx);
+typedef bool (*httpd_uri_match_func_t)(const char *tpl, const char *uri, size_t len);
+
+struct httpd_req_t {
+  int method;
+  const char *uri;
+  size_t content_len;
+  void *user_ctx;
+};
+
+struct httpd_uri_t {
+  const char *uri;
+  httpd_method_t method;
+  esp_err_t (*handler)(httpd_req_t *r);
+  void *user_ctx;
+};
+
+struct httpd_config_t {
+  uint16_t server_port;
+  size_t stack_size;
+  int core_id;
+  uint16_t max_open_sockets;
+  uint16_t max_uri_handlers;
+  bool lru_purge_enable;
+  uint16_t recv_wait_timeout;
+  uint16_t send_wait_timeout;
+  void *global_user_ctx;
+  httpd_free_ctx_fn_t global_user_ctx_free_fn;
+  httpd_close_func_t close_fn;
+  httpd_uri_match_func_t uri_match_fn;
+};
+#define HTTPD_DEFAULT_CONFIG() httpd_config_t{}
+
+inline bool httpd_uri_match_wildcard(const char *, const char *, size_t) { return true; }
+
+struct ShimHttpd {
+  // server
+  std::vector<httpd_uri_t> uris;
+  void *ctx = nullptr;
+  // richiesta in corso
+  std::string reqBody, reqType = "application/x-www-form-urlencoded";
+  size_t recvOff = 0;
+  // risposta registrata
+  std::string status, type, body;
+  std::vector<std::pair<std::string, std::string>> headers;
+  int sends = 0, lockedSends = 0;
+  uint64_t t0Us = 0, firstUs = 0; // inizio richiesta e prima scrittura (µs)
+  size_t firstBytes = 0;          // byte della prima scrittura
+  size_t bytes = 0;               // byte scritti in tutto
+  bool keepBody = true;           // false: body non registrato (misure di heap)
+  int failAt = 0;          // restano tra le richieste: il test li azzera
+  uint32_t sendDelayUs = 0;
+  bool chunkEnd = false;
+
+  void reset() {
+    reqBody.clear();
+    recvOff = 0;
+    status.clear();
+    type.clear();
+    body.clear();
+    headers.clear();
+    sends = lockedSends = 0;
+    t0Us = nowUs();
+    firstUs = 0;
+    firstBytes = 0;
+    bytes = 0;
+    chunkEnd = false;
+  }
+  static uint64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+  }
+  std::string header(const char *k) const {
+    for (const auto &h : headers)
+      if (h.first == k)
+        return h.second;
+    return "";
+  }
+  bool wrote(size_t n) {
+    if (!sends++) {
+      firstUs = nowUs();
+      firstBytes = n;
+    }
+    bytes += n;
+    if (shim_lock_depth)
+      lockedSends++;
+    if (sendDelayUs)
+      std::this_thread::sleep_for(std::chrono::microseconds(sendDelayUs));
+    return !failAt || sends < failAt;
+  }
+};
+inline ShimHttpd shim_httpd;
+
+inline std::mutex shim_httpd_task; // il task di httpd: un handler alla volta
+
+// Esegue una richiesta come farebbe il task di httpd; con out la risposta
+// registrata viene copiata prima che passi la richiesta successiva
+inline esp_err_t shimHttpdRequest(int method, const char *uri, const std::string &body = "",
+                                  ShimHttpd *out = nullptr) {
+  std::lock_guard<std::mutex> task(shim_httpd_task);
+  shim_httpd.reset();
+  shim_httpd.reqBody = body;
+  httpd_req_t r{method, uri, body.size(), nullptr};
+  esp_err_t err = ESP_FAIL;
+  for (const auto &u : shim_httpd.uris)
+    if (u.method == method) {
+      r.user_ctx = u.user_ctx;
+      err = u.handler(&r);
+      break;
+    }
+  if (out)
+    *out = shim_httpd;
+  return err;
+}
+
+inline esp_err_t httpd_start(httpd_handle_t *h, const httpd_config_t *c) {
+  shim_httpd.ctx = c->global_user_ctx;
+  *h = &shim_httpd;
+  return ESP_OK;
+}
+inline esp_err_t httpd_register_uri_handler(httpd_handle_t, const httpd_uri_t *u) {
+  shim_httpd.uris.push_back(*u);
+  return ESP_OK;
+}
+inline void *httpd_get_global_user_ctx(httpd_handle_t) { return shim_httpd.ctx; }
+
+inline esp_err_t httpd_resp_set_status(httpd_req_t *, const char *s) {
+  shim_httpd.status = s;
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_set_type(httpd_req_t *, const char *t) {
+  shim_httpd.type = t;
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_set_hdr(httpd_req_t *, const char *k, const char *v) {
+  shim_httpd.headers.push_back({k, v});
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_send(httpd_req_t *, const char *b, ssize_t n) {
+  if (n == HTTPD_RESP_USE_STRLEN)
+    n = b ? strlen(b) : 0;
+  shim_httpd.wrote(n);
+  if (b && shim_httpd.keepBody)
+    shim_httpd.body.append(b, n);
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_send_chunk(httpd_req_t *, const char *b, ssize_t n) {
+  if (!shim_httpd.wrote(b ? n : 0))
+    return ESP_FAIL;
+  if (!b)
+    shim_httpd.chunkEnd = true;
+  else if (shim_httpd.keepBody)
+    shim_httpd.body.append(b, n);
+  return ESP_OK;
+}
+inline esp_err_t httpd_resp_send_404(httpd_req_t *r) {
+  httpd_resp_set_status(r, "404 Not Found");
+  return httpd_resp_send(r, nullptr, 0);
+}
+inline int httpd_req_recv(httpd_req_t *, char *buf, size_t n) {
+  const size_t k = std::min(n, shim_httpd.reqBody.size() - shim_httpd.recvOff);
+  memcpy(buf, shim_httpd.reqBody.data() + shim_httpd.recvOff, k);
+  shim_httpd.recvOff += k;
+  return (int)k;
+}
+inline esp_err_t httpd_req_get_hdr_value_str(httpd_req_t *, const char *, char *b, size_t n) {
+  strncpy(b, shim_httpd.reqType.c_str(), n);
+  b[n - 1] = 0;
+  return ESP_OK;
+}
+inline int httpd_req_to_sockfd(httpd_req_t *) { return 42; }
+inline int httpd_send(httpd_req_t *, const char *b, size_t n) {
+  shim_httpd.wrote(n);
+  shim_httpd.body.append(b, n);
+  return (int)n;
+}
+inline esp_err_t httpd_queue_work(httpd_handle_t, httpd_work_fn_t fn, void *arg) {
+  fn(arg);
+  return ESP_OK;
+}
+inline esp_err_t httpd_sess_trigger_close(httpd_handle_t, int) { return ESP_OK; }
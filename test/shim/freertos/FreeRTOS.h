@@ -0,0 +1,13 @@
+#pragma once
+// FreeRTOS su host: solo i tipi usati dagli header (mutex in semphr.h)
+#include <cstdint>
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+#define portMAX_DELAY ((TickType_t)0xffffffffUL)
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portYIELD_FROM_ISR()
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
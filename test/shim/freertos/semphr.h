@@ -0,0 +1,29 @@
+#pragma once
+// Mutex ricorsivo vero (std::recursive_timed_mutex): nei test a più
+// thread StateLock si contende come tra loop e task httpd.
+// shim_lock_depth è del thread che chiama (> 0 = StateLock tenuto da lui),
+// shim_lock_takes conta le prese di tutti i thread
+#include <freertos/FreeRTOS.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+typedef void *SemaphoreHandle_t;
+inline std::recursive_timed_mutex shim_mux;
+inline thread_local int shim_lock_depth = 0;
+inline std::atomic<int> shim_lock_takes{0};
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return &shim_mux; }
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t m, TickType_t ticks) {
+  auto *mx = static_cast<std::recursive_timed_mutex *>(m);
+  if (ticks == portMAX_DELAY)
+    mx->lock();
+  else if (!mx->try_lock_for(std::chrono::milliseconds(ticks)))
+    return pdFALSE;
+  shim_lock_depth++;
+  shim_lock_takes++;
+  return pdTRUE;
+}
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t m) {
+  shim_lock_depth--;
+  static_cast<std::recursive_timed_mutex *>(m)->unlock();
+  return pdTRUE;
+}
@@ -0,0 +1,8 @@
+#pragma once
+// Socket lwIP su host: quelli POSIX (con fcntl e inet_* come in lwIP)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
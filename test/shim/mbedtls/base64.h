@@ -0,0 +1,25 @@
+#pragma once
+// mbedtls base64 su host (solo encode, come lo usa websocket.h)
+#include <cstddef>
+#include <cstdint>
+
+#define MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL -0x002A
+
+inline int mbedtls_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
+                                 const unsigned char *src, size_t slen) {
+  static const char T[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  *olen = (slen + 2) / 3 * 4;
+  if (dlen < *olen + 1)
+    return MBEDTLS_ERR_BASE64_BUFFER_TOO_SMALL;
+  unsigned char *o = dst;
+  for (size_t i = 0; i < slen; i += 3) {
+    const uint32_t v = src[i] << 16 | (i + 1 < slen ? src[i + 1] << 8 : 0) |
+                       (i + 2 < slen ? src[i + 2] : 0);
+    *o++ = T[v >> 18 & 63];
+    *o++ = T[v >> 12 & 63];
+    *o++ = i + 1 < slen ? T[v >> 6 & 63] : '=';
+    *o++ = i + 2 < slen ? T[v & 63] : '=';
+  }
+  *o = 0;
+  return 0;
+}
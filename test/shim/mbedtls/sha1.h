@@ -0,0 +1,42 @@
+#pragma once
+// mbedtls SHA-1 su host (API 2.x dell'IDF 4.4: mbedtls_sha1_ret)
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+inline int mbedtls_sha1_ret(const unsigned char *in, size_t n, unsigned char out[20]) {
+  uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+  const uint64_t bits = (uint64_t)n * 8;
+  const size_t total = (n + 9 + 63) / 64 * 64;
+  for (size_t blk = 0; blk < total; blk += 64) {
+    uint8_t b[64];
+    for (size_t i = 0; i < 64; i++) {
+      const size_t k = blk + i;
+      b[i] = k < n ? in[k] : k == n ? 0x80 : k >= total - 8 ? bits >> (8 * (total - 1 - k)) : 0;
+    }
+    uint32_t w[80];
+    for (int i = 0; i < 16; i++)
+      w[i] = b[4 * i] << 24 | b[4 * i + 1] << 16 | b[4 * i + 2] << 8 | b[4 * i + 3];
+    for (int i = 16; i < 80; i++) {
+      const uint32_t x = w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16];
+      w[i] = x << 1 | x >> 31;
+    }
+    uint32_t a = h[0], bb = h[1], c = h[2], d = h[3], e = h[4];
+    for (int i = 0; i < 80; i++) {
+      const uint32_t f = i < 20   ? ((bb & c) | (~bb & d)) + 0x5A827999
+                         : i < 40 ? (bb ^ c ^ d) + 0x6ED9EBA1
+                         : i < 60 ? ((bb & c) | (bb & d) | (c & d)) + 0x8F1BBCDC
+                                  : (bb ^ c ^ d) + 0xCA62C1D6;
+      const uint32_t t = (a << 5 | a >> 27) + f + e + w[i];
+      e = d;
+      d = c;
+      c = bb << 30 | bb >> 2;
+      bb = a;
+      a = t;
+    }
+    h[0] += a, h[1] += bb, h[2] += c, h[3] += d, h[4] += e;
+  }
+  for (int i = 0; i < 20; i++)
+    out[i] = h[i / 4] >> (24 - 8 * (i % 4));
+  return 0;
+}
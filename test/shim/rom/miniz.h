@@ -0,0 +1,53 @@
+#pragma once
+// tinfl (miniz in ROM) sopra zlib: stessa interfaccia streaming con
+// dizionario circolare esterno. La finestra vera la tiene zlib; il
+// chiamante vede solo l'output scritto in pOut_buf_next.
+#include <cstddef>
+#include <cstdint>
+#include <zlib.h>
+
+#define TINFL_LZ_DICT_SIZE 32768
+enum {
+  TINFL_FLAG_PARSE_ZLIB_HEADER = 1,
+  TINFL_FLAG_HAS_MORE_INPUT = 2,
+  TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF = 4,
+};
+typedef enum {
+  TINFL_STATUS_FAILED = -1,
+  TINFL_STATUS_DONE = 0,
+  TINFL_STATUS_NEEDS_MORE_INPUT = 1,
+  TINFL_STATUS_HAS_MORE_OUTPUT = 2,
+} tinfl_status;
+
+struct tinfl_decompressor {
+  z_stream z;
+  bool open;
+};
+
+inline void tinfl_init(tinfl_decompressor *d) { d->open = false; }
+
+inline tinfl_status tinfl_decompress(tinfl_decompressor *d, const uint8_t *in,
+                                     size_t *inSize, uint8_t *, uint8_t *out,
+                                     size_t *outSize, uint32_t flags) {
+  if (!d->open) {
+    d->z = z_stream{};
+    if (inflateInit2(&d->z, flags & TINFL_FLAG_PARSE_ZLIB_HEADER ? 15 : -15) != Z_OK)
+      return TINFL_STATUS_FAILED;
+    d->open = true;
+  }
+  d->z.next_in = (Bytef *)in;
+  d->z.avail_in = *inSize;
+  d->z.next_out = out;
+  d->z.avail_out = *outSize;
+  const int r = inflate(&d->z, Z_NO_FLUSH);
+  *inSize -= d->z.avail_in;
+  *outSize -= d->z.avail_out;
+  if (r == Z_STREAM_END) {
+    inflateEnd(&d->z);
+    d->open = false;
+    return TINFL_STATUS_DONE;
+  }
+  if (r != Z_OK && r != Z_BUF_ERROR)
+    return TINFL_STATUS_FAILED;
+  return d->z.avail_out ? TINFL_STATUS_NEEDS_MORE_INPUT : TINFL_STATUS_HAS_MORE_OUTPUT;
+}
@@ -0,0 +1,125 @@
+/*
+===============================================================================
+   SQUARED — MINI FRAMEWORK DEI TEST SU HOST
+   Descrizione: controlli che non si fermano al primo errore, contatore di
+                allocazioni (operator new sostituito: ogni test è una sola
+                unità di compilazione), cronometro e lettura fixture.
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+
+   • CHECK(cond) / CHECK_EQ(a, b)   errore annotato con file:riga
+   • TEST_END()                     riepilogo, codice d'uscita del main
+   • tAllocs / tHeapNow / tHeapPeak contatori di operator new
+   • tHeapReset()                   azzera allocazioni e picco
+   • tBench()                       true con SQ_BENCH=1 (make bench)
+   • tNowUs()                       cronometro monotono in µs
+   • tReadFile(path)                fixture come std::string
+
+===============================================================================
+*/
+
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+
+static int t_checks = 0, t_fails = 0;
+
+#define CHECK(c)                                                               \
+  do {                                                                         \
+    t_checks++;                                                                \
+    if (!(c)) {                                                                \
+      t_fails++;                                                               \
+      fprintf(stderr, "%s:%d: CHECK(%s)\n", __FILE__, __LINE__, #c);           \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_EQ(a, b)                                                         \
+  do {                                                                         \
+    t_checks++;                                                                \
+    const long long va_ = (long long)(a), vb_ = (long long)(b);                \
+    if (va_ != vb_) {                                                          \
+      t_fails++;                                                               \
+      fprintf(stderr, "%s:%d: %s = %lld, atteso %s = %lld\n", __FILE__,        \
+              __LINE__, #a, va_, #b, vb_);                                     \
+    }                                                                          \
+  } while (0)
+
+#define CHECK_STR(a, b)                                                        \
+  do {                                                                         \
+    t_checks++;                                                                \
+    const std::string sa_(a), sb_(b);                                          \
+    if (sa_ != sb_) {                                                          \
+      t_fails++;                                                               \
+      fprintf(stderr, "%s:%d: %s = \"%s\", atteso \"%s\"\n", __FILE__,         \
+              __LINE__, #a, sa_.c_str(), sb_.c_str());                         \
+    }                                                                          \
+  } while (0)
+
+#define TEST_END()                                                             \
+  do {                                                                         \
+    printf("%s: %d controlli, %d falliti\n", __FILE__, t_checks, t_fails);     \
+    return t_fails ? 1 : 0;                                                    \
+  } while (0)
+
+// ============================================================================
+// ALLOCAZIONI (operator new globale: String, std::function, vector…)
+// ============================================================================
+static size_t tAllocs = 0, tHeapNow = 0, tHeapPeak = 0;
+
+void *operator new(size_t n) {
+  size_t *p = (size_t *)malloc(n + sizeof(size_t) * 2);
+  if (!p)
+    throw std::bad_alloc();
+  p[0] = n;
+  tAllocs++;
+  tHeapNow += n;
+  if (tHeapNow > tHeapPeak)
+    tHeapPeak = tHeapNow;
+  return p + 2;
+}
+__attribute__((noinline)) void operator delete(void *q) noexcept {
+  if (!q)
+    return;
+  size_t *p = (size_t *)q - 2;
+  tHeapNow -= p[0];
+  free(p);
+}
+void operator delete(void *q, size_t) noexcept { operator delete(q); }
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete[](void *q) noexcept { operator delete(q); }
+void operator delete[](void *q, size_t) noexcept { operator delete(q); }
+
+// Azzera i contatori (il picco riparte dall'heap attuale)
+static inline void tHeapReset() {
+  tAllocs = 0;
+  tHeapPeak = tHeapNow;
+}
+
+// ============================================================================
+// TEMPO / FILE
+// ============================================================================
+static inline double tNowUs() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+static inline bool tBench() { return getenv("SQ_BENCH") != nullptr; }
+
+static inline std::string tReadFile(const char *path) {
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    fprintf(stderr, "fixture mancante: %s\n", path);
+    exit(2);
+  }
+  std::ostringstream s;
+  s << f.rdbuf();
+  return s.str();
+}
@@ -0,0 +1,198 @@
+// asyncweb.h con StateLock conteso: unlock() manda subito quanto raccolto
+// sotto lock e il resto va a chunk sul socket a lock rilasciato; poi
+// quattro thread client chiamano dispatch (uno alla volta, come il task
+// httpd) su un socket lento mentre un thread "loop" prende StateLock a
+// raffiche come disegno e touch: nessuna scrittura col lock in mano, il
+// loop non aspetta mai la rete, le richieste aspettano il lock al più
+// una raffica del loop e ogni pagina è coerente con una sola copia
+#include "test.h"
+
+#include "handlers/asyncweb.h"
+#include "handlers/htmlwriter.h"
+
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <thread>
+#include <vector>
+
+AsyncWeb web(80);
+
+// Globali che il loop riscrive sotto StateLock (come g_city, dati pagina)
+static String cfg_city = "Lugano";
+static uint32_t cfg_gen = 0;
+
+static constexpr int PAGE_ROWS = 1000; // ~17 KB: una ventina di chunk
+static constexpr uint32_t LOOP_HOLD_MS = 5;
+static constexpr uint32_t SLOW_SEND_US = 2000;
+
+static std::atomic<uint64_t> lock_wait_max{0}; // handler: attesa del lock
+
+static void noteLockWait() {
+  const uint64_t w = (uint64_t)tNowUs() - shim_httpd.t0Us;
+  uint64_t m = lock_wait_max.load();
+  while (w > m && !lock_wait_max.compare_exchange_weak(m, w)) {
+  }
+}
+
+// Come sendSettings(): copia sotto lock, unlock(), pagina dalla copia
+static void handlePage() {
+  noteLockWait();
+  const String city = cfg_city;
+  const uint32_t gen = cfg_gen;
+  web.unlock();
+
+  HtmlWriter w(web);
+  w.begin(200);
+  w.s("<html><body>");
+  for (int k = 0; k < PAGE_ROWS && !web.clientGone(); k++) {
+    w.s("<p>");
+    w.esc(city);
+    w.s(" #");
+    w.num((long)gen);
+    w.s("</p>");
+  }
+  w.s("</body></html>");
+  w.end();
+}
+
+// Risposta breve: resta raccolta sotto lock e parte al rilascio
+static void handleShort() {
+  noteLockWait();
+  web.send(200, "text/plain", String(cfg_gen));
+}
+
+// Tutto il contenuto "<p>città #gen</p>" con lo stesso gen
+static bool pageConsistent(const std::string &b) {
+  if (b.compare(0, 12, "<html><body>") || b.size() < 26 ||
+      b.compare(b.size() - 14, 14, "</body></html>"))
+    return false;
+  const std::string row = b.substr(12, b.find("</p>") + 4 - 12);
+  if (row.compare(0, 3, "<p>"))
+    return false;
+  for (size_t o = 12, k = 0; k < PAGE_ROWS; k++, o += row.size())
+    if (b.compare(o, row.size(), row))
+      return false;
+  return b.size() == 12 + PAGE_ROWS * row.size() + 14;
+}
+
+int main() {
+  web.on("/page", HTTP_GET, handlePage);
+  web.on("/short", HTTP_GET, handleShort);
+  web.on("/asset", HTTP_GET, [] { web.send(200, "text/css", "body{}"); }, false);
+  web.on("/unlocked", HTTP_GET, [] {
+    web.unlock(); // rotta senza lock: nessun effetto
+    web.send(200, "text/plain", "ok");
+  }, false);
+  web.on("/early", HTTP_GET, [] {
+    web.send(200, "text/plain", "ok");
+    web.unlock(); // risposta già completa: parte ora, una volta sola
+    web.unlock();
+  });
+  web.on("/big", HTTP_GET, [] {
+    HtmlWriter w(web);
+    w.begin(200);
+    for (size_t k = 0; k < (WEB_MAX_RESP + HTML_CHUNK) / 16; k++)
+      w.s("0123456789abcdef", 16);
+    web.unlock(); // oltre WEB_MAX_RESP già sotto lock: 500
+    CHECK(web.clientGone());
+    w.end();
+  });
+  CHECK(web.begin());
+
+  // --- unlock(): raccolto sotto lock al socket, poi chunk diretti ---
+  shim_lock_takes = 0;
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, "/page"), ESP_OK);
+  CHECK_EQ(shim_lock_takes, 1);
+  CHECK_EQ(shim_lock_depth, 0);
+  CHECK_EQ(shim_httpd.lockedSends, 0);
+  CHECK(shim_httpd.sends > 10); // a chunk, non in un colpo
+  CHECK(shim_httpd.chunkEnd);
+  CHECK_STR(shim_httpd.status, "200 OK");
+  CHECK_STR(shim_httpd.header("Cache-Control"), "no-store");
+  CHECK(pageConsistent(shim_httpd.body));
+
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, "/early"), ESP_OK);
+  CHECK_EQ(shim_httpd.sends, 1);
+  CHECK_STR(shim_httpd.body, "ok");
+  CHECK_EQ(shim_lock_depth, 0);
+
+  shim_lock_takes = 0;
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, "/unlocked"), ESP_OK);
+  CHECK_EQ(shim_lock_takes, 0);
+  CHECK_STR(shim_httpd.body, "ok");
+
+  shimHttpdRequest(HTTP_GET, "/big");
+  CHECK_STR(shim_httpd.status, "500 Internal Server Error");
+  CHECK_EQ(shim_httpd.lockedSends, 0);
+  CHECK_EQ(shim_httpd.sends, 1);
+  CHECK_EQ(shim_lock_depth, 0);
+
+  // --- Carico: 4 client su socket lento, loop che tiene il lock ---
+  shim_httpd.sendDelayUs = SLOW_SEND_US;
+  lock_wait_max = 0;
+  std::atomic<bool> stop{false};
+  uint64_t loopWaitMax = 0, loopBursts = 0;
+  std::thread loop([&] {
+    while (!stop) {
+      const double t0 = tNowUs();
+      {
+        StateLock lock;
+        loopWaitMax = std::max<uint64_t>(loopWaitMax, tNowUs() - t0);
+        cfg_gen++;
+        cfg_city = cfg_gen & 1 ? "Lugano" : "Bellinzona";
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOOP_HOLD_MS));
+      }
+      loopBursts++;
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+  });
+
+  static const char *const URIS[] = {"/page", "/short", "/asset"};
+  const int CLIENTS = 4, REQS = 12;
+  std::atomic<int> ok{0}, locked{0}, bad{0};
+  std::atomic<uint64_t> ttfbMax{0};
+  std::vector<std::thread> clients;
+  for (int c = 0; c < CLIENTS; c++)
+    clients.emplace_back([&, c] {
+      std::mt19937 rng(c);
+      for (int i = 0; i < REQS; i++) {
+        ShimHttpd r;
+        const char *uri = URIS[rng() % 3];
+        if (shimHttpdRequest(HTTP_GET, uri, "", &r) != ESP_OK || r.status != "200 OK")
+          bad++;
+        else if (uri[1] == 'p' && !pageConsistent(r.body))
+          bad++;
+        else
+          ok++;
+        locked += r.lockedSends;
+        const uint64_t t = r.firstUs - r.t0Us;
+        uint64_t m = ttfbMax.load();
+        while (t > m && !ttfbMax.compare_exchange_weak(m, t)) {
+        }
+      }
+    });
+  for (std::thread &t : clients)
+    t.join();
+  stop = true;
+  loop.join();
+  shim_httpd.sendDelayUs = 0;
+
+  CHECK_EQ(ok, CLIENTS * REQS);
+  CHECK_EQ(bad, 0);
+  CHECK_EQ(locked, 0);
+  CHECK_EQ(shim_lock_depth, 0);
+  CHECK(loopBursts > 10);
+  // una pagina sul socket lento dura ~20 scritture × SLOW_SEND_US: scritta
+  // sotto lock, il loop aspetterebbe almeno 40 ms
+  CHECK(loopWaitMax < 15000);
+  // richieste: al più una raffica del loop (+ margine per lo scheduler)
+  CHECK(lock_wait_max < LOOP_HOLD_MS * 1000 + 10000);
+  CHECK(ttfbMax < LOOP_HOLD_MS * 1000 + 10000 + SLOW_SEND_US);
+  printf("  %d richieste da %d thread, %llu raffiche del loop: attesa lock loop max %.1f ms, "
+         "handler max %.1f ms, primo byte max %.1f ms\n",
+         CLIENTS * REQS, CLIENTS, (unsigned long long)loopBursts, loopWaitMax / 1000.0,
+         lock_wait_max / 1000.0, ttfbMax / 1000.0);
+
+  TEST_END();
+}
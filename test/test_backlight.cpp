@@ -0,0 +1,220 @@
+// backlight.h su un LEDC finto: rampa chiusa dall'interrupt o dal tempo
+// previsto + BL_MARGIN_MS, attese senza rampa hardware, richieste in coda
+// durante una rampa (ultima vince, mai un fade_start sopra una rampa in
+// corso: IDF 4.4 bloccherebbe il loop), interrupt tardivo della rampa
+// precedente, coda e callback che avvia una rampa sua; infine mezz'ora di
+// loop a 5 ms con transizioni a catena, tocchi e interrupt persi
+#include "test.h"
+
+#include "handlers/backlight.h"
+
+#include <random>
+#include <string>
+
+static std::string trail; // callback chiamate, in ordine
+
+static void reset() {
+  bl_ramp = BlRamp();
+  bl_next = {0, 0, nullptr, false};
+  bl_hw_end.store(-1);
+  bl_ready = false;
+  shim_ledc = ShimLedc();
+  trail.clear();
+  shim_ms = 1000;
+}
+
+// Loop: hardware fino a t, blTick() ogni 5 ms
+static void runUntil(uint32_t t) {
+  while ((int32_t)(t - shim_ms) > 0) {
+    shim_ms += std::min<uint32_t>(5, t - shim_ms);
+    shimLedcRun();
+    blTick();
+  }
+}
+
+static void cbA() { trail += 'A'; }
+static void cbB() { trail += 'B'; }
+static void cbQ() { trail += 'Q'; }
+
+// Callback che avvia la rampa successiva (come rotateDark → transEnd)
+static void cbChain() {
+  trail += 'C';
+  blFadeTo(40, 200, cbB);
+}
+
+int main() {
+  // --- Rampa chiusa dall'interrupt ---
+  reset();
+  blFadeTo(BL_MAX, 400, cbA);
+  CHECK_EQ(shim_ledc.installs, 1);
+  CHECK_EQ(shim_ledc.fades, 1);
+  CHECK(blBusy());
+  CHECK_EQ(blTarget(), BL_MAX);
+  runUntil(1200);
+  CHECK(blLevel() > 120 && blLevel() < 135); // metà rampa
+  CHECK(shim_ledc.duty > 120 && shim_ledc.duty < 135);
+  runUntil(1395);
+  CHECK(blBusy());
+  runUntil(1400);
+  CHECK(!blBusy());
+  CHECK_STR(trail, "A");
+  CHECK_EQ(blLevel(), BL_MAX);
+  blBegin(); // idempotente
+  CHECK_EQ(shim_ledc.installs, 1);
+
+  // --- Interrupt perso: chiude il tempo previsto + margine ---
+  reset();
+  shim_ledc.irq = false;
+  blFadeTo(BL_MAX, 300, cbA);
+  runUntil(1000 + 300 + BL_MARGIN_MS - 5);
+  CHECK(blBusy());
+  runUntil(1000 + 300 + BL_MARGIN_MS);
+  CHECK(!blBusy());
+  CHECK_STR(trail, "A");
+
+  // --- Attesa e salto: nessuna rampa hardware, interrupt ignorati ---
+  reset();
+  blFadeTo(BL_MAX, 0); // salto
+  CHECK_EQ(shim_ledc.fades, 0);
+  CHECK_EQ(shim_ledc.duty, BL_MAX);
+  runUntil(1005);
+  CHECK(!blBusy());
+  blHold(600, cbA);
+  CHECK_EQ(shim_ledc.fades, 0);
+  shimLedcIrq(BL_MAX); // interrupt spurio col duty giusto: l'attesa resta
+  runUntil(1595);
+  CHECK(blBusy());
+  CHECK_STR(trail, "");
+  runUntil(1605);
+  CHECK_STR(trail, "A");
+  CHECK_EQ(shim_ledc.duty, BL_MAX);
+
+  // --- In coda: durante la rampa l'ultima richiesta vince ---
+  reset();
+  blFadeTo(BL_MAX, 400, cbA);
+  runUntil(1100);
+  blFadeTo(0, 100, cbQ);   // sostituita
+  blFadeTo(80, 100, cbB);  // eseguita
+  CHECK_EQ(shim_ledc.fades, 1);
+  CHECK(bl_next.valid);
+  CHECK_EQ(blTarget(), BL_MAX); // la rampa in corso non cambia
+  runUntil(1400);
+  CHECK_STR(trail, "A");
+  CHECK(blBusy() && !bl_next.valid);
+  CHECK_EQ(blTarget(), 80);
+  CHECK_EQ(shim_ledc.fades, 2);
+  CHECK_EQ(bl_ramp.from, BL_MAX); // riparte da dove è arrivata
+  runUntil(1500);
+  CHECK_STR(trail, "AB");
+  CHECK_EQ(shim_ledc.duty, 80);
+  CHECK_EQ(shim_ledc.overlaps, 0);
+
+  // --- Interrupt tardivo della rampa precedente ---
+  // A chiusa dal margine (interrupt in ritardo), C avvia B verso 40: il
+  // vecchio interrupt (duty 255) arriva durante B e non la chiude
+  reset();
+  shim_ledc.irq = false;
+  blFadeTo(BL_MAX, 300, cbChain);
+  runUntil(1000 + 300 + BL_MARGIN_MS);
+  CHECK_STR(trail, "C");
+  CHECK(blBusy());
+  CHECK_EQ(blTarget(), 40);
+  shim_ledc.irq = true;
+  shimLedcIrq(BL_MAX);
+  CHECK_EQ(bl_hw_end.load(), BL_MAX);
+  runUntil(shim_ms + 5);
+  CHECK(blBusy()); // ignorato
+  CHECK_EQ(bl_hw_end.load(), -1); // e consumato
+  runUntil(1000 + 300 + BL_MARGIN_MS + 195);
+  CHECK(blBusy());
+  runUntil(1000 + 300 + BL_MARGIN_MS + 200); // interrupt di B
+  CHECK(!blBusy());
+  CHECK_STR(trail, "CB");
+  CHECK_EQ(shim_ledc.overlaps, 0);
+
+  // interrupt con un duty estraneo durante l'attesa del margine: A resta
+  // aperta; quello giusto, anche in ritardo, la chiude subito
+  reset();
+  shim_ledc.irq = false;
+  blFadeTo(BL_MAX, 300, cbA);
+  runUntil(1305);
+  shimLedcIrq(0);
+  runUntil(1310);
+  CHECK(blBusy());
+  shimLedcIrq(BL_MAX);
+  runUntil(1315);
+  CHECK(!blBusy());
+  CHECK_STR(trail, "A");
+
+  // --- Coda + callback che avvia una rampa sua ---
+  // la richiesta in coda non parte sopra la rampa della callback: aspetta
+  // anche quella e parte alla sua fine
+  reset();
+  blFadeTo(BL_MAX, 300, cbChain);
+  runUntil(1100);
+  blFadeTo(200, 100, cbQ);
+  runUntil(1300);
+  CHECK_STR(trail, "C");
+  CHECK_EQ(blTarget(), 40); // rampa della callback
+  CHECK(bl_next.valid);
+  CHECK_EQ(shim_ledc.fades, 2);
+  runUntil(1500);
+  CHECK_STR(trail, "CB");
+  CHECK_EQ(blTarget(), 200);
+  runUntil(1600);
+  CHECK_STR(trail, "CBQ");
+  CHECK_EQ(shim_ledc.duty, 200);
+  CHECK(!blBusy() && !bl_next.valid);
+  CHECK_EQ(shim_ledc.overlaps, 0);
+
+  // --- Mezz'ora di loop: transizioni a catena, tocchi, interrupt persi ---
+  {
+    reset();
+    std::mt19937 rng(7);
+    static int ends;
+    ends = 0;
+    static void (*const fadeIn)() = [] {
+      ends++;
+      blFadeTo(BL_MAX, BL_QUICK_MS, [] { ends++; });
+    };
+    uint32_t lastSwitch = shim_ms, started = 0, rampT0 = 0;
+    int32_t longest = 0;
+    bool was = false, waited = false;
+    const uint32_t end = shim_ms + 30 * 60 * 1000;
+    while ((int32_t)(end - shim_ms) > 0) {
+      shim_ledc.irq = rng() % 10 != 0; // un interrupt su dieci perso
+      shim_ms += 5;
+      shimLedcRun();
+      const uint32_t before = shim_ms;
+      blTick();
+      waited |= shim_ms != before; // nessuna attesa nel loop
+
+      if (!blBusy() && shim_ms - lastSwitch >= 15000) { // cambio pagina
+        lastSwitch = shim_ms;
+        blFadeTo(0, BL_QUICK_MS, fadeIn);
+      }
+      if (rng() % 2000 == 0) // tocco: sveglia a piena luce
+        blFadeTo(BL_MAX, BL_QUICK_MS);
+      if (rng() % 5000 == 0) // notte: passo lungo la curva
+        blFadeTo(rng() % 256, 2000);
+
+      // ogni rampa finisce entro ms + margine + un giro di loop
+      if (blBusy() && (!was || bl_ramp.t0 != rampT0)) {
+        rampT0 = bl_ramp.t0;
+        started++;
+      }
+      if (blBusy())
+        longest = std::max<int32_t>(longest, shim_ms - bl_ramp.t0 - bl_ramp.ms);
+      was = blBusy();
+    }
+    CHECK(!waited);
+    CHECK_EQ(shim_ledc.overlaps, 0);
+    CHECK(longest <= BL_MARGIN_MS + 5);
+    CHECK(ends >= 2 * 115);
+    printf("  30 min: %u rampe, %d fade hardware, %d ledcWrite, fine rampa al più "
+           "%d ms oltre il previsto, %d fade sovrapposti\n",
+           started, shim_ledc.fades, shim_ledc.writes, longest, shim_ledc.overlaps);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,155 @@
+// feedparser.h: RSS e Atom con ogni taglio dei blocchi, prefissi atom:/rss:
+// contro media:/itunes:/dc:, CDATA, commenti, entità, titoli troppo lunghi,
+// stop anticipato, memoria fissa e throughput
+#include "test.h"
+
+#include "handlers/feedparser.h"
+
+#include <random>
+#include <vector>
+
+static std::vector<std::string> scan(const std::string &xml, size_t chunk,
+                                     uint8_t max = 10) {
+  String out[16];
+  FeedScanner fs(out, max);
+  for (size_t i = 0; i < xml.size(); i += chunk)
+    if (!fs.feed(xml.data() + i, std::min(chunk, xml.size() - i)))
+      break;
+  std::vector<std::string> r;
+  for (uint8_t i = 0; i < fs.count; i++)
+    r.push_back(out[i].c_str());
+  return r;
+}
+
+// Stesso risultato per qualunque dimensione dei blocchi dal socket
+static std::vector<std::string> scanAll(const std::string &xml, uint8_t max = 10) {
+  const auto ref = scan(xml, xml.size() + 1, max);
+  for (size_t chunk : {1, 2, 3, 5, 7, 64, 1460}) {
+    const auto got = scan(xml, chunk, max);
+    CHECK(got == ref);
+  }
+  return ref;
+}
+
+int main() {
+  // --- RSS: CDATA, entità, commenti, tag annidati nel titolo ---
+  {
+    const std::string rss =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<!DOCTYPE rss [<!ENTITY x \"y\">]>\n"
+        "<rss version=\"2.0\" xmlns:media=\"http://search.yahoo.com/mrss/\">"
+        "<channel><title>Canale (non un item)</title>"
+        "<item><title><![CDATA[Borsa: +2% ]] e <b>record</b> ]]]></title></item>"
+        "<item><title>Caff&#232; &amp; cornetto &#x1F600; &nbsp;3 &lt; 5 &gt; 1</title></item>"
+        "<item><!-- <title>commento</title> --><title>Dopo --> il commento</title></item>"
+        "<item><title>  Spazi\r\n\t multipli   </title><title>secondo titolo</title></item>"
+        "<item><title>&unknown; &amp &#xZZ; fine</title></item>"
+        "<item><title/></item>"
+        "<item><description>senza titolo</description></item>"
+        "<ITEM><TITLE>Maiuscole</TITLE></ITEM>"
+        "<item><title lang='it' x=\"a>b\">Attributi</title></item>"
+        "</channel></rss>";
+    const auto t = scanAll(rss);
+    CHECK_EQ(t.size(), 7); // <title/> e item senza titolo: niente
+    if (t.size() == 7) {
+      CHECK_STR(t[0], "Borsa: +2% ]] e record ]");
+      CHECK_STR(t[1], "Caff\xC3\xA8 & cornetto \xF0\x9F\x98\x80 3 < 5 > 1");
+      CHECK_STR(t[2], "Dopo --> il commento");
+      CHECK_STR(t[3], "Spazi multipli");
+      CHECK_STR(t[4], "&unknown; &amp &#xZZ; fine");
+      CHECK_STR(t[5], "Maiuscole");
+      CHECK_STR(t[6], "Attributi");
+    }
+  }
+
+  // --- Prefissi: atom:/rss: tenuti, gli altri ignorati ---
+  {
+    const std::string x =
+        "<feed xmlns=\"http://www.w3.org/2005/Atom\">"
+        "<atom:entry><media:title>foto</media:title>"
+        "<atom:title type=\"html\">&lt;b&gt;Atom&lt;/b&gt; con prefisso</atom:title></atom:entry>"
+        "<entry><itunes:title>episodio</itunes:title><dc:title>dc</dc:title>"
+        "<title>Solo il titolo</title><media:title>dopo</media:title></entry>"
+        "<rss:item><rss:title>RSS 1.0</rss:title></rss:item>"
+        "<entry><media:group><media:title>in gruppo</media:title></media:group>"
+        "<foo:bar:title>doppio</foo:bar:title><title>Ultimo</title></entry>"
+        "<entry><verylongprefix:title>x</verylongprefix:title></entry>"
+        "</feed>";
+    const auto t = scanAll(x);
+    CHECK_EQ(t.size(), 4);
+    if (t.size() == 4) {
+      CHECK_STR(t[0], "Atom con prefisso");
+      CHECK_STR(t[1], "Solo il titolo");
+      CHECK_STR(t[2], "RSS 1.0");
+      CHECK_STR(t[3], "Ultimo");
+    }
+  }
+
+  // --- Titolo oltre FEED_TITLE_MAX: troncato, niente overflow ---
+  {
+    std::string big(1000, 'x');
+    const auto t = scanAll("<item><title>" + big + "</title></item><item><title>b</title></item>");
+    CHECK_EQ(t.size(), 2);
+    CHECK_EQ(t[0].size(), FEED_TITLE_MAX);
+    CHECK_STR(t[1], "b");
+  }
+
+  // --- Stop anticipato: feed() false appena raccolti max titoli ---
+  std::string big = "<rss><channel>";
+  for (int i = 0; i < 2000; i++)
+    big += "<item><title>Notizia " + std::to_string(i) +
+           " &amp; <![CDATA[dettagli]]></title><link>https://example.org/" +
+           std::to_string(i) + "</link><description>&lt;p&gt;Testo lungo di "
+           "prova per il feed&lt;/p&gt;</description><media:title>m</media:title></item>\n";
+  big += "</channel></rss>";
+  {
+    String out[3];
+    FeedScanner fs(out, 3);
+    size_t used = 0;
+    for (; used < big.size(); used += 512)
+      if (!fs.feed(big.data() + used, std::min<size_t>(512, big.size() - used)))
+        break;
+    CHECK_EQ(fs.count, 3);
+    CHECK(used < 1024); // il resto del feed non viene letto
+    CHECK_STR(out[2].c_str(), "Notizia 2 & dettagli");
+  }
+
+  // --- Input casuale: nessun crash, mai più di max titoli ---
+  {
+    std::mt19937 rng(31);
+    const char *bits[] = {"<", ">", "/", "!", "[CDATA[", "]]>", "--", "&", ";", "#x",
+                          "item", "entry", "title", ":", "atom", "media", "\"", " ", "a"};
+    for (int i = 0; i < 3000; i++) {
+      std::string s;
+      for (int k = rng() % 200; k; k--)
+        s += bits[rng() % (sizeof(bits) / sizeof(*bits))];
+      CHECK(scan(s, 1 + rng() % 9, 5).size() <= 5);
+    }
+  }
+
+  // --- Memoria fissa, nessuna String temporanea, throughput ---
+  {
+    CHECK(sizeof(FeedScanner) <= 240);
+    static String out[255];
+    const int reps = tBench() ? 200 : 20;
+    tHeapReset();
+    const size_t s0 = shim_strings;
+    const double t0 = tNowUs();
+    size_t n = 0;
+    for (int r = 0; r < reps; r++) {
+      FeedScanner fs(out, 255);
+      for (size_t i = 0; i < big.size(); i += 1460) { // scansione completa
+        fs.feed(big.data() + i, std::min<size_t>(1460, big.size() - i));
+        n += fs.count;
+        fs.count = 0;
+      }
+    }
+    const double us = (tNowUs() - t0) / reps;
+    CHECK_EQ(n, 2000 * reps);
+    CHECK_EQ(shim_strings - s0, 0); // solo assegnazioni ai titoli in uscita
+    printf("  %zu B, 2000 item: %.0f µs (%.1f MB/s), %zu alloc, stato %zu B\n",
+           big.size(), us, big.size() / us, tAllocs, sizeof(FeedScanner));
+  }
+
+  TEST_END();
+}
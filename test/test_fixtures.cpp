@@ -0,0 +1,342 @@
+// Replay delle fixture in test/fixtures/ attraverso i fetch*() veri delle
+// pagine: httpGET/httpStream (gzip a blocchi come dal socket, risposta
+// scelta per URL), parser e pubblicazione sotto StateLock. Per ogni
+// sorgente: valori pubblicati, tempo, allocazioni e picco di heap contro
+// un budget esplicito. Come tools/mock_api.py in replay: body gonfiato
+// (--inflate) e troncato (--loss) non devono rompere i parser.
+#define SQUARED_MOCK_API "192.168.1.10:8080"
+
+#include "test.h"
+
+#include "handlers/asyncweb.h"
+#include "handlers/displayhelpers.h"
+#include "handlers/httpstream.h"
+#include "handlers/jsonhelpers.h"
+
+// nell'ordine dello sketch (SquaredLight usa fetchLatLon di SquaredMeteo)
+#include "pages/SquaredCal.h"
+#include "pages/SquaredMeteo.h"
+#include "pages/SquaredTemp.h"
+#include "pages/SquaredSay.h"
+#include "pages/SquaredLight.h"
+#include "pages/SquaredCHF.h"
+#include "pages/SquaredAir.h"
+#include "pages/SquaredCrypto.h"
+#include "pages/SquaredNews.h"
+#include "pages/SquaredHA.h"
+
+#include <initializer_list>
+#include <utility>
+#include <vector>
+#include <zlib.h>
+
+// ============================================================================
+// SKETCH (globali e funzioni che le pagine prendono da SquaredCoso.ino)
+// ============================================================================
+AsyncWeb web(80);
+static Arduino_RGB_Display display;
+Arduino_RGB_Display *gfx = &display;
+
+String g_city = "Bellinzona", g_lang = "it", g_ics, g_lat, g_lon, g_rss_url, g_oa_key,
+    g_oa_topic, g_fiat = "CHF", g_ha_ip, g_ha_token, g_ha_ents;
+double g_btc_owned = NAN;
+uint16_t g_air_bg;
+bool g_timeSynced = true;
+int g_page = 0;
+volatile bool g_forceQodPending = false;
+
+const uint16_t COL_BG = 0x1B70, COL_HEADER = 0x2967, COL_TEXT = 0xFFFF, COL_DIVIDER = 0xFFE0,
+               COL_ACCENT1 = 0xFFFF, COL_ACCENT2 = 0x07FF;
+const int PAGE_X = 16, PAGE_Y = 62, PAGE_W = 448, PAGE_H = 402;
+const int BASE_CHAR_W = 6, BASE_CHAR_H = 8, TEXT_SCALE = 2, CHAR_H = 16;
+
+// Coordinate già in NVS: nessuna richiesta di geocoding
+bool geocodeIfNeeded() { return g_lat.length() && g_lon.length(); }
+
+// Orologio del dispositivo: fetchICS() prende la finestra da time()
+static time_t fake_now = 0;
+extern "C" time_t time(time_t *t) noexcept {
+  if (t)
+    *t = fake_now;
+  return fake_now;
+}
+
+// ============================================================================
+// SERVER FINTO
+// ============================================================================
+static std::vector<uint8_t> gzip(const std::string &in) {
+  z_stream z{};
+  deflateInit2(&z, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+  std::vector<uint8_t> out(deflateBound(&z, in.size()));
+  z.next_in = (Bytef *)in.data();
+  z.avail_in = in.size();
+  z.next_out = out.data();
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+// Come mock_api.py --inflate: spazi dopo ogni ',' e ':' fuori dalle stringhe
+static std::string inflateJson(const std::string &s) {
+  std::string o;
+  bool q = false;
+  for (size_t i = 0; i < s.size(); i++) {
+    o += s[i];
+    if (s[i] == '"' && (i == 0 || s[i - 1] != '\\'))
+      q = !q;
+    if (!q && (s[i] == ',' || s[i] == ':' || s[i] == '{' || s[i] == '['))
+      o += "  \n ";
+  }
+  return o;
+}
+
+// Rotte (pezzo di URL → body), gzip a blocchi di chunk byte; il resto 404.
+// Compresse qui, prima di misurare: il fetch legge i byte senza copiarli
+static void serve(std::initializer_list<std::pair<const char *, std::string>> routes,
+                  size_t chunk = 1460) {
+  shim_http = ShimHttp();
+  shim_http.encoding = "gzip";
+  shim_http.chunk = chunk;
+  for (const auto &r : routes)
+    shim_http.routes.push_back({r.first, gzip(r.second)});
+}
+
+// Costo di un fetch: allocazioni (operator new) e picco di heap sopra
+// quello di partenza, heap_caps_* (PSRAM) compreso
+struct Cost {
+  size_t allocs, peak;
+};
+
+template <class F> static Cost meter(const char *name, F fetch) {
+  tHeapReset();
+  shim_caps_peak = shim_caps_now;
+  const size_t heap0 = tHeapNow, caps0 = shim_caps_now;
+  const double t0 = tNowUs();
+  fetch();
+  const double us = tNowUs() - t0;
+  const Cost c = {tAllocs, tHeapPeak - heap0 + shim_caps_peak - caps0};
+  printf("  %-10s %7u B  %7.1f µs  %4zu alloc  picco %6zu B\n", name, http_wireBytes, us,
+         c.allocs, c.peak);
+  http_wireBytes = 0;
+  return c;
+}
+
+static const char GEO[] =
+    R"({"results":[{"name":"Bellinzona","latitude":46.19278,"longitude":9.01703}]})";
+static const char UV[] = R"({"daily":{"time":["2026-01-10"],"uv_index_max":[1.35]}})";
+
+int main() {
+  // Fuso del dispositivo (Europa centrale), sabato 10/01/2026 12:00
+  setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+  tzset();
+  struct tm lo = {};
+  lo.tm_year = 126;
+  lo.tm_mday = 10;
+  lo.tm_hour = 12;
+  lo.tm_isdst = -1;
+  fake_now = mktime(&lo);
+  stateLockInit(); // come setup()
+
+  // --- URL dirottati sul mock server (e decompressore già allocato) ---
+  CHECK_STR(httpMockUrl("https://api.open-meteo.com/v1/forecast?x=1").c_str(),
+            "http://192.168.1.10:8080/https/api.open-meteo.com/v1/forecast?x=1");
+  serve({{"frankfurter", "{}"}});
+  String dummy;
+  CHECK(httpGET("https://api.frankfurter.app/latest", dummy));
+  CHECK_STR(shim_http.url, "http://192.168.1.10:8080/https/api.frankfurter.app/latest");
+  CHECK(!httpGET("https://example.org/", dummy)); // nessuna rotta: 404
+  http_wireBytes = 0;
+
+  printf("  sorgente    sul filo      tempo   alloc  picco heap\n");
+
+  // --- Meteo: geocoding + forecast, anche con body gonfiato ---
+  {
+    const std::string fx = tReadFile("fixtures/weather.json");
+    for (const std::string &b : {fx, inflateJson(fx)}) {
+      serve({{"geocoding-api", GEO}, {"current_weather=true", b}});
+      const Cost c = meter("weather", [] { CHECK(fetchWeather()); });
+      CHECK_EQ(shim_http.requests, 2);
+      CHECK(w_now_tempC == 6.4f);
+      CHECK_STR(w_now_desc.c_str(), "Nuvoloso");       // codice 3
+      CHECK_STR(w_desc[1].c_str(), "Pioggia");         // 61
+      CHECK_STR(w_desc[2].c_str(), "Rovesci");         // 80
+      CHECK(c.allocs <= 40);
+      CHECK(c.peak <= 2 * b.size() + 1024); // body + stringhe di URL
+    }
+    // forecast irraggiungibile: niente residui del fetch precedente
+    serve({{"geocoding-api", GEO}});
+    CHECK(!fetchWeather());
+    CHECK(isnan(w_now_tempC) && !w_now_desc.length());
+  }
+
+  // --- Aria ---
+  g_lat = "46.19278";
+  g_lon = "9.01703";
+  {
+    const std::string fx = tReadFile("fixtures/air.json");
+    serve({{"air-quality-api", fx}});
+    const Cost c = meter("air", [] { CHECK(fetchAir()); });
+    CHECK(aq_val[AQ_PM25] == 18.4f && aq_val[AQ_PM10] == 25.1f);
+    CHECK(aq_val[AQ_O3] == 41.0f && aq_val[AQ_NO2] == 33.7f);
+    CHECK(c.allocs <= 20);
+    CHECK(c.peak <= 2 * fx.size() + 512);
+
+    // NO2 assente: i tre trovati pubblicati, fetch non riuscito
+    serve({{"air-quality-api",
+            R"({"hourly":{"pm2_5":[9.5],"pm10":[12],"ozone":[60]}})"}});
+    CHECK(!fetchAir());
+    CHECK(aq_val[AQ_PM25] == 9.5f && aq_val[AQ_O3] == 60.0f);
+    CHECK(isnan(aq_val[AQ_NO2]));
+  }
+
+  // --- Temperatura 7 giorni interpolata su 24 punti ---
+  {
+    const std::string fx = tReadFile("fixtures/temp24.json");
+    serve({{"temperature_2m_mean", fx}});
+    const Cost c = meter("temp24", [] { CHECK(fetchTemp24()); });
+    CHECK(t24[0] == 3.1f && t24[23] == 6.2f);
+    for (float v : t24)
+      CHECK(!isnan(v));
+    CHECK(c.allocs <= 20);
+    CHECK(c.peak <= 2 * fx.size() + 512);
+  }
+
+  // --- BTC ---
+  {
+    const std::string fx = tReadFile("fixtures/crypto.json");
+    serve({{"coingecko", fx}});
+    const Cost c = meter("crypto", [] { CHECK(fetchCrypto()); });
+    CHECK(shim_http.url.find("vs_currencies=chf") != std::string::npos);
+    CHECK(cr_price == 81234.5f && fabsf(cr_chg24 + 1.8734f) < 1e-4f);
+    CHECK(c.allocs <= 20);
+    CHECK(c.peak <= 2 * fx.size() + 512);
+  }
+
+  // --- Cambi: la valuta base non c'è, JSON troncato = meno campi ---
+  {
+    const std::string fx = tReadFile("fixtures/fx.json");
+    serve({{"frankfurter", fx}});
+    const Cost c = meter("fx", [] { CHECK(fetchFX()); });
+    CHECK(fx_eur == 1.0701 && fx_jpy == 188.12 && std::isnan(fx_chf));
+    CHECK(c.allocs <= 20);
+    CHECK(c.peak <= 2 * fx.size() + 512);
+
+    for (size_t cut : {20, 60, 110}) {
+      serve({{"frankfurter", fx.substr(0, cut)}});
+      CHECK(fetchFX());
+      const int got = !isnan(fx_eur) + !isnan(fx_usd) + !isnan(fx_gbp) + !isnan(fx_jpy) +
+                      !isnan(fx_cad) + !isnan(fx_cny) + !isnan(fx_inr);
+      CHECK(got < 7);
+    }
+
+    // connessione chiusa a metà: fetch fallito, tassi precedenti intatti
+    serve({{"frankfurter", fx}});
+    CHECK(fetchFX());
+    shim_http.closeAt = shim_http.routes[0].second.size() / 2;
+    CHECK(!fetchFX());
+    CHECK(fx_eur == 1.0701);
+  }
+
+  // --- Sole: geocoding, alba/tramonto, UV (luna non raggiungibile) ---
+  {
+    const std::string fx = tReadFile("fixtures/sun.json");
+    serve({{"geocoding-api", GEO}, {"sunrise-sunset", fx}, {"uv_index_max", UV}});
+    const Cost c = meter("sun", [] { CHECK(fetchSun()); });
+    CHECK_EQ(shim_http.requests, 4);
+    CHECK_STR(sun_rise, "08:02"); // 07:02Z → CET
+    CHECK_STR(sun_ce, "17:35");
+    CHECK_STR(sun_uvi, "1.4");
+    CHECK_STR(g_lat.c_str(), "46.192780");
+    CHECK(c.allocs <= 80); // quattro URL costruiti a pezzi
+    CHECK(c.peak <= 2 * fx.size() + 1024);
+  }
+
+  // --- Frase del giorno (ZenQuotes: nessuna chiave OpenAI) ---
+  {
+    const std::string fx = tReadFile("fixtures/qod.json");
+    serve({{"zenquotes", fx}});
+    const Cost c = meter("qod", [] { CHECK(fetchQOD()); });
+    CHECK_STR(qod_text.c_str(), "Il segreto per andare avanti e iniziare.");
+    CHECK_STR(qod_author.c_str(), "Mark Twain");
+    CHECK(!qod_from_ai);
+    CHECK(c.allocs <= 30);
+    CHECK(c.peak <= 2 * fx.size() + 1024);
+    CHECK(fetchQOD()); // stessa giornata: dalla cache, nessuna richiesta
+    CHECK_EQ(shim_http.requests, 1);
+  }
+
+  // --- News RSS (media:title / itunes:title ignorati) e Atom ---
+  g_rss_url = "https://feeds.example.org/rss.xml";
+  {
+    const std::string rss = tReadFile("fixtures/news_rss.xml");
+    serve({{"feeds.example.org", rss}}, 700);
+    const Cost c = meter("news_rss", [] { CHECK(fetchNews()); });
+    // fermo a 10 titoli: il resto del feed non viene letto
+    CHECK(shim_http.sent < shim_http.routes[0].second.size());
+    std::string seen;
+    for (const String &t : news_title) {
+      CHECK(!strncmp(t.c_str(), "Titolo ", 7));
+      CHECK(seen.find(t.c_str()) == std::string::npos); // 5 titoli diversi
+      seen += t.c_str();
+      seen += '\n';
+    }
+    CHECK(c.allocs <= 60);
+    CHECK(c.peak <= 2048); // titoli in streaming, nessun body
+
+    const std::string atom = tReadFile("fixtures/news_atom.xml");
+    serve({{"feeds.example.org", atom}}, 700);
+    CHECK(fetchNews());
+    CHECK(!strncmp(news_title[4].c_str(), "Voce Atom ", 10));
+
+    serve({{"feeds.example.org", rss.substr(0, rss.size() / 3)}}, 700);
+    fetchNews(); // titoli completi prima del taglio restano validi
+    for (const String &t : news_title)
+      CHECK(!t.length() || !strncmp(t.c_str(), "Titolo ", 7));
+  }
+
+  // --- Calendario: settimana dal 10/01/2026 ---
+  g_ics = "https://calendar.example.org/basic.ics";
+  {
+    const std::string fx = tReadFile("fixtures/calendar.ics");
+    serve({{"calendar.example.org", fx}}, 1000);
+    const Cost c = meter("calendar", [] { CHECK(fetchICS()); });
+    CHECK_EQ(cal_count, 3); // chiamata UTC, compleanno, stand-up di mercoledì (lunedì escluso)
+    if (cal_count == 3) {
+      struct tm t;
+      localtime_r(&cal[0].start, &t);
+      CHECK(t.tm_mday == 10 && t.tm_hour == 18); // 17:00Z → 18:00 CET
+      CHECK(cal[1].allDay);
+      CHECK_STR(cal[1].summary, "Compleanno, festa");
+      localtime_r(&cal[2].start, &t);
+      CHECK(t.tm_mday == 14 && t.tm_hour == 9 && t.tm_min == 30);
+      CHECK_STR(cal[2].summary,
+                "Stand-up settimanale del gruppo con un titolo l"); // 47 byte
+    }
+    // in streaming: nessun body in RAM, solo l'indice nuovo
+    CHECK(c.allocs <= 20);
+    CHECK(c.peak <= sizeof(IcsEntry) * CAL_MAX + 2048);
+  }
+
+  // --- Home Assistant /api/states (nessuna lista: filtro automatico) ---
+  g_ha_ip = "192.168.1.5";
+  g_ha_token = "tok";
+  {
+    const std::string fx = tReadFile("fixtures/ha_states.json");
+    for (const std::string &b : {fx, inflateJson(fx)}) {
+      serve({{":8123/api/states", b}});
+      const Cost c = meter("ha_states", [] { CHECK(fetchHA()); });
+      CHECK_STR(shim_http.url, "http://192.168.1.10:8080/http/192.168.1.5:8123/api/states");
+      CHECK_EQ(ha_count, HA_MAX_ENTRIES);
+      CHECK_STR(ha_entries[0].name, "Dispositivo 0 a"); // traslitterato, 3 parole
+      CHECK_STR(ha_entries[0].state, "On");
+      CHECK(c.allocs <= 30);
+      // body intero in String: la crescita per concat tiene vivi vecchio e
+      // nuovo buffer, fino a ~3 volte il body
+      CHECK(c.peak <= 3 * b.size() + 4096);
+    }
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,205 @@
+// httpstream.h: gzip / zlib / deflate grezzo in streaming, header gzip a
+// cavallo dei blocchi, stop anticipato del parser, throughput di decodifica
+#include "test.h"
+
+#include "handlers/httpstream.h"
+
+#include <vector>
+#include <zlib.h>
+
+enum Wrap { W_GZIP, W_ZLIB, W_RAW };
+
+// Comprime come un server: gzip con header opzionali (nome, commento,
+// extra, CRC dell'header) per provare tutti gli stage di gzSkipHeader
+static std::vector<uint8_t> deflateBody(const std::string &in, Wrap w,
+                                        bool gzFields = false) {
+  z_stream z{};
+  const int bits = w == W_GZIP ? 15 + 16 : w == W_ZLIB ? 15 : -15;
+  deflateInit2(&z, 6, Z_DEFLATED, bits, 8, Z_DEFAULT_STRATEGY);
+  gz_header h{};
+  static Bytef extra[] = {'S', 'Q', 3, 0, 1, 2, 3};
+  static Bytef name[] = "feed.xml";
+  static Bytef comment[] = "squared";
+  if (w == W_GZIP && gzFields) {
+    h.extra = extra;
+    h.extra_len = sizeof(extra);
+    h.name = name;
+    h.comment = comment;
+    h.hcrc = 1;
+    deflateSetHeader(&z, &h);
+  }
+  std::vector<uint8_t> out(deflateBound(&z, in.size()) + 64);
+  z.next_in = (Bytef *)in.data();
+  z.avail_in = in.size();
+  z.next_out = out.data();
+  z.avail_out = out.size();
+  deflate(&z, Z_FINISH);
+  out.resize(z.total_out);
+  deflateEnd(&z);
+  return out;
+}
+
+// Testo simile alle risposte vere: JSON Open-Meteo, RSS, ICS
+static std::string sampleJson(size_t n) {
+  std::string s = "{\"latitude\":45.46,\"hourly\":{\"temperature_2m\":[";
+  for (size_t i = 0; s.size() < n; i++)
+    s += std::to_string(10 + (i * 7) % 13) + "." + std::to_string(i % 10) + ",";
+  s.back() = ']';
+  return s + "}}";
+}
+static std::string sampleRss(size_t n) {
+  std::string s = "<?xml version=\"1.0\"?><rss><channel>";
+  for (int i = 0; s.size() < n; i++)
+    s += "<item><title>Notizia numero " + std::to_string(i) +
+         " &amp; aggiornamenti</title><link>https://example.org/n/" +
+         std::to_string(i) + "</link><description>Testo di prova per il "
+         "feed, ripetuto abbastanza da comprimere.</description></item>\n";
+  return s + "</channel></rss>";
+}
+static std::string sampleIcs(size_t n) {
+  std::string s = "BEGIN:VCALENDAR\r\nVERSION:2.0\r\n";
+  for (int i = 0; s.size() < n; i++)
+    s += "BEGIN:VEVENT\r\nUID:" + std::to_string(i) +
+         "@example.org\r\nDTSTART:20260110T090000Z\r\nSUMMARY:Riunione " +
+         std::to_string(i % 40) + "\r\nEND:VEVENT\r\n";
+  return s + "END:VCALENDAR\r\n";
+}
+
+static void serve(const std::vector<uint8_t> &wire, const char *enc, size_t chunk,
+                  bool length = true) {
+  shim_http = ShimHttp();
+  shim_http.body = wire;
+  shim_http.encoding = enc;
+  shim_http.chunk = chunk;
+  shim_http.sendLength = length;
+}
+
+static std::string fetch(bool *ok = nullptr) {
+  std::string got;
+  const bool r = httpStream("https://example.org/x", 5000, [&](const char *d, size_t n) {
+    got.append(d, n);
+    return true;
+  });
+  if (ok)
+    *ok = r;
+  return got;
+}
+
+int main() {
+  const std::string rss = sampleRss(120000); // > finestra da 32 KB
+  const struct {
+    Wrap w;
+    const char *enc;
+    bool fields;
+  } cases[] = {{W_GZIP, "gzip", false}, {W_GZIP, "gzip", true},
+               {W_ZLIB, "deflate", false}, {W_RAW, "deflate", false}};
+
+  // --- Decodifica corretta con qualunque taglio dei blocchi ---
+  for (const auto &c : cases) {
+    const auto wire = deflateBody(rss, c.w, c.fields);
+    for (size_t chunk : {1, 3, 17, 1024, 1460, 65536}) {
+      serve(wire, c.enc, chunk, chunk != 17);
+      bool ok = false;
+      const std::string got = fetch(&ok);
+      CHECK(ok);
+      CHECK(got == rss);
+    }
+  }
+
+  // --- Identità: body passato così com'è, Accept-Encoding negoziato ---
+  serve(std::vector<uint8_t>(rss.begin(), rss.end()), "", 1460);
+  CHECK(fetch() == rss);
+  bool acc = false;
+  for (const auto &h : shim_http.headers)
+    acc |= h == "Accept-Encoding: gzip, deflate";
+  CHECK(acc);
+
+  // --- Il parser ha finito: connessione chiusa senza leggere il resto ---
+  {
+    serve(deflateBody(rss, W_GZIP), "gzip", 512);
+    size_t seen = 0;
+    const bool ok = httpStream("https://example.org/x", 5000, [&](const char *, size_t n) {
+      seen += n;
+      return seen < 4096;
+    });
+    CHECK(ok);
+    CHECK(shim_http.sent < shim_http.body.size());
+  }
+
+  // --- Stream corrotto: errore, nessun crash ---
+  {
+    auto wire = deflateBody(rss, W_ZLIB);
+    for (size_t i = 40; i < 60; i++)
+      wire[i] ^= 0x5A;
+    serve(wire, "deflate", 1460);
+    bool ok = true;
+    fetch(&ok);
+    CHECK(!ok);
+  }
+
+  // --- Connessione chiusa a metà: errore, anche se il sink ha visto dati ---
+  {
+    const std::vector<uint8_t> plain(rss.begin(), rss.end());
+    for (const auto &c : cases) {
+      const auto wire = deflateBody(rss, c.w, c.fields);
+      for (bool length : {true, false}) {
+        serve(wire, c.enc, 1460, length);
+        shim_http.closeAt = wire.size() / 2;
+        bool ok = true;
+        CHECK(!fetch(&ok).empty());
+        CHECK(!ok);
+      }
+    }
+    serve(plain, "", 1460);
+    shim_http.closeAt = plain.size() - 1; // un byte meno di Content-Length
+    bool ok = true;
+    fetch(&ok);
+    CHECK(!ok);
+    // senza Content-Length né compressione la chiusura è la fine del body
+    serve(plain, "", 1460, false);
+    shim_http.closeAt = 1000;
+    CHECK_EQ(fetch(&ok).size(), 1000);
+    CHECK(ok);
+  }
+
+  // --- Errore HTTP: status al chiamante, sink mai chiamato ---
+  {
+    serve({}, "", 1460);
+    shim_http.status = 404;
+    int st = 0;
+    bool called = false;
+    CHECK(!httpStream("https://example.org/x", 5000,
+                      [&](const char *, size_t) { return called = true; }, nullptr, &st));
+    CHECK_EQ(st, 404);
+    CHECK(!called);
+  }
+
+  // --- Throughput di decodifica e byte risparmiati per tipo di sorgente ---
+  const int reps = tBench() ? 50 : 5;
+  const struct {
+    const char *name;
+    std::string body;
+  } src[] = {{"json", sampleJson(60000)}, {"rss", rss}, {"ics", sampleIcs(200000)}};
+  for (const auto &s : src) {
+    const auto wire = deflateBody(s.body, W_GZIP);
+    http_wireBytes = http_bodyBytes = 0;
+    const double t0 = tNowUs();
+    for (int i = 0; i < reps; i++) {
+      serve(wire, "gzip", 1460);
+      size_t n = 0;
+      httpStream("https://example.org/x", 5000, [&](const char *, size_t k) {
+        n += k;
+        return true;
+      });
+      CHECK_EQ(n, s.body.size());
+    }
+    const double us = tNowUs() - t0;
+    CHECK_EQ(http_bodyBytes, s.body.size() * reps);
+    printf("  %-4s %7zu B → %6zu B sul filo (%4.1f×, -%2.0f %%)  %6.1f MB/s\n", s.name,
+           s.body.size(), wire.size(), (double)s.body.size() / wire.size(),
+           100.0 * (1 - (double)http_wireBytes / http_bodyBytes),
+           s.body.size() * reps / us);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,219 @@
+// icsparser.h: ricorrenze (BYDAY, BYMONTHDAY=-1, n-esimo giorno, COUNT,
+// UNTIL, EXDATE, RECURRENCE-ID), VTIMEZONE con ora legale, righe piegate a
+// cavallo dei blocchi, e memoria costante su un calendario da diversi MB
+#include "test.h"
+
+#include "handlers/icsparser.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+static const char *TZ_ROME = "BEGIN:VTIMEZONE\r\n"
+                             "TZID:Europe/Rome\r\n"
+                             "BEGIN:DAYLIGHT\r\n"
+                             "TZOFFSETFROM:+0100\r\n"
+                             "TZOFFSETTO:+0200\r\n"
+                             "DTSTART:19700329T020000\r\n"
+                             "RRULE:FREQ=YEARLY;BYMONTH=3;BYDAY=-1SU\r\n"
+                             "END:DAYLIGHT\r\n"
+                             "BEGIN:STANDARD\r\n"
+                             "TZOFFSETFROM:+0200\r\n"
+                             "TZOFFSETTO:+0100\r\n"
+                             "DTSTART:19701025T030000\r\n"
+                             "RRULE:FREQ=YEARLY;BYMONTH=10;BYDAY=-1SU\r\n"
+                             "END:STANDARD\r\n"
+                             "END:VTIMEZONE\r\n";
+
+static const char *TZ_NY = "BEGIN:VTIMEZONE\r\n"
+                           "TZID:America/New_York\r\n"
+                           "BEGIN:DAYLIGHT\r\n"
+                           "TZOFFSETFROM:-0500\r\n"
+                           "TZOFFSETTO:-0400\r\n"
+                           "DTSTART:20070311T020000\r\n"
+                           "RRULE:FREQ=YEARLY;BYMONTH=3;BYDAY=2SU\r\n"
+                           "END:DAYLIGHT\r\n"
+                           "BEGIN:DAYLIGHT\r\n" // storica: ignorata
+                           "TZOFFSETTO:-0400\r\n"
+                           "DTSTART:19870405T020000\r\n"
+                           "END:DAYLIGHT\r\n"
+                           "BEGIN:STANDARD\r\n"
+                           "TZOFFSETFROM:-0400\r\n"
+                           "TZOFFSETTO:-0500\r\n"
+                           "DTSTART:20071104T020000\r\n"
+                           "RRULE:FREQ=YEARLY;BYMONTH=11;BYDAY=1SU\r\n"
+                           "END:STANDARD\r\n"
+                           "END:VTIMEZONE\r\n";
+
+static std::string event(const std::string &uid, const std::string &summary,
+                         const std::string &props) {
+  return "BEGIN:VEVENT\r\nUID:" + uid + "\r\nSUMMARY:" + summary + "\r\n" + props +
+         "END:VEVENT\r\n";
+}
+
+static time_t utc(int y, int mo, int d, int h = 0, int mi = 0) {
+  return isoToUtcEpoch({(int16_t)y, (uint8_t)mo, (uint8_t)d, (uint8_t)h, (uint8_t)mi,
+                        0, true, true, 0});
+}
+
+static uint8_t parse(const std::string &ics, size_t chunk, IcsEntry *out, uint8_t cap,
+                     time_t a, time_t b) {
+  IcsParser p(out, cap, a, b);
+  for (size_t i = 0; i < ics.size(); i += chunk)
+    p.feed(ics.data() + i, std::min(chunk, ics.size() - i));
+  return p.finish();
+}
+
+int main() {
+  setenv("TZ", "UTC0", 1);
+  tzset();
+
+  std::string cal = "BEGIN:VCALENDAR\r\nVERSION:2.0\r\n";
+  cal += TZ_ROME;
+  cal += TZ_NY;
+  cal += event("standup", "Standup",
+               "DTSTART;TZID=Europe/Rome:20250106T093000\r\n"
+               "DTEND;TZID=Europe/Rome:20250106T094500\r\n"
+               "RRULE:FREQ=WEEKLY;BYDAY=MO,WE,FR\r\n"
+               "EXDATE;TZID=Europe/Rome:20260610T093000\r\n"
+               "BEGIN:VALARM\r\nTRIGGER:-PT10M\r\nSUMMARY:allarme\r\n"
+               "DTSTART:20000101T000000Z\r\nEND:VALARM\r\n");
+  cal += event("standup", "Standup spostato",
+               "RECURRENCE-ID;TZID=Europe/Rome:20260612T093000\r\n"
+               "DTSTART;TZID=Europe/Rome:20260612T113000\r\n"
+               "DTEND;TZID=Europe/Rome:20260612T114500\r\n");
+  cal += event("fine-mese", "Chiusura mese",
+               "DTSTART:20250131T120000Z\r\nRRULE:FREQ=MONTHLY;BYMONTHDAY=-1\r\n");
+  cal += event("compleanno", "Compleanno",
+               "DTSTART;VALUE=DATE:19900614\r\nRRULE:FREQ=YEARLY\r\n");
+  cal += event("tre", "Tre volte",
+               "DTSTART:20260601T060000Z\r\nDURATION:PT1H\r\n"
+               "RRULE:FREQ=DAILY;COUNT=3\r\n");
+  cal += event("fino", "Fino al 5",
+               "DTSTART:20260603T180000Z\r\nRRULE:FREQ=DAILY;UNTIL=20260605\r\n");
+  cal += event("annullato", "Annullato",
+               "DTSTART:20260615T100000Z\r\nSTATUS:CANCELLED\r\n");
+  cal += event("secondo-martedi", "Secondo martedì",
+               "DTSTART:20260113T150000Z\r\nRRULE:FREQ=MONTHLY;BYDAY=2TU\r\n");
+  cal += event("ny", "Call NY", "DTSTART;TZID=America/New_York:20260610T090000\r\n");
+  cal += "BEGIN:VEVENT\r\nUID:piegato\r\nSUMMARY:Riunione con\r\n  il team\\, e \\n"
+         "note\r\nDESCRIPTION:" + std::string(2000, 'd') + "\r\n"
+         "DTSTART:20260620T100000Z\r\nDURATION:PT1H30M\r\nEND:VEVENT\r\n";
+  cal += "END:VCALENDAR\r\n";
+
+  // --- Giugno 2026: tutte le regole, qualunque taglio dei blocchi ---
+  {
+    std::vector<std::pair<time_t, std::string>> want;
+    for (int d : {1, 3, 5, 8, 15, 17, 19, 22, 24, 26, 29}) // 10 escluso, 12 spostato
+      want.push_back({utc(2026, 6, d, 7, 30), "Standup"});
+    want.push_back({utc(2026, 6, 12, 9, 30), "Standup spostato"});
+    want.push_back({utc(2026, 6, 30, 12), "Chiusura mese"});
+    want.push_back({utc(2026, 6, 14), "Compleanno"});
+    for (int d : {1, 2, 3})
+      want.push_back({utc(2026, 6, d, 6), "Tre volte"});
+    for (int d : {3, 4, 5})
+      want.push_back({utc(2026, 6, d, 18), "Fino al 5"});
+    want.push_back({utc(2026, 6, 9, 15), "Secondo martedì"});
+    want.push_back({utc(2026, 6, 10, 13), "Call NY"});
+    want.push_back({utc(2026, 6, 20, 10), "Riunione con il team, e  note"});
+    std::sort(want.begin(), want.end());
+
+    for (size_t chunk : {(size_t)1, (size_t)2, (size_t)7, (size_t)1460, cal.size()}) {
+      IcsEntry out[64];
+      const uint8_t n = parse(cal, chunk, out, 64, utc(2026, 6, 1), utc(2026, 7, 1));
+      CHECK_EQ(n, want.size());
+      for (uint8_t i = 0; i < n && i < want.size(); i++) {
+        CHECK_EQ(out[i].start, want[i].first);
+        CHECK_STR(out[i].summary, want[i].second);
+      }
+    }
+
+    IcsEntry out[64];
+    const uint8_t n = parse(cal, 1460, out, 64, utc(2026, 6, 1), utc(2026, 7, 1));
+    for (uint8_t i = 0; i < n; i++) {
+      const std::string s = out[i].summary;
+      if (s == "Standup")
+        CHECK_EQ(out[i].end - out[i].start, 15 * 60);
+      if (s == "Standup spostato")
+        CHECK(out[i].override);
+      if (s == "Compleanno")
+        CHECK(out[i].allDay && out[i].end - out[i].start == 86400);
+      if (s.rfind("Riunione", 0) == 0)
+        CHECK_EQ(out[i].end - out[i].start, 90 * 60);
+    }
+
+    // Indice pieno: restano i primi cap per inizio
+    IcsEntry few[4];
+    CHECK_EQ(parse(cal, 1460, few, 4, utc(2026, 6, 1), utc(2026, 7, 1)), 4);
+    for (int i = 0; i < 4; i++)
+      CHECK_EQ(few[i].start, want[i].first);
+  }
+
+  // --- Gennaio: ora solare di Roma ---
+  {
+    IcsEntry out[8];
+    const uint8_t n = parse(cal, 1460, out, 8, utc(2026, 1, 12), utc(2026, 1, 13));
+    CHECK_EQ(n, 1);
+    CHECK_EQ(out[0].start, utc(2026, 1, 12, 8, 30));
+  }
+
+  // --- Ora flottante = ora locale del dispositivo ---
+  {
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    const std::string f = "BEGIN:VCALENDAR\r\n" +
+                          event("f", "Flottante", "DTSTART:20260701T120000\r\n") +
+                          "END:VCALENDAR\r\n";
+    IcsEntry out[2];
+    CHECK_EQ(parse(f, 5, out, 2, utc(2026, 7, 1), utc(2026, 7, 2)), 1);
+    CHECK_EQ(out[0].start, utc(2026, 7, 1, 10));
+    setenv("TZ", "UTC0", 1);
+    tzset();
+  }
+
+  // --- Calendario condiviso da diversi MB: memoria costante ---
+  {
+    std::string big = "BEGIN:VCALENDAR\r\nVERSION:2.0\r\n";
+    big += TZ_ROME;
+    std::mt19937 rng(32);
+    std::vector<time_t> starts;
+    const time_t t0 = utc(2020, 1, 1), t1 = utc(2031, 1, 1);
+    for (int i = 0; big.size() < 4u * 1024 * 1024; i++) {
+      const time_t s = t0 + (time_t)(rng() % (uint32_t)(t1 - t0)) / 60 * 60;
+      struct tm g;
+      gmtime_r(&s, &g);
+      char dt[32];
+      strftime(dt, sizeof(dt), "%Y%m%dT%H%M%SZ", &g);
+      big += event("ev" + std::to_string(i), "Evento " + std::to_string(i),
+                   std::string("DTSTART:") + dt + "\r\nDURATION:PT30M\r\nDESCRIPTION:" +
+                       std::string(rng() % 300, 'x') + "\r\n");
+      starts.push_back(s);
+    }
+    big += "END:VCALENDAR\r\n";
+
+    const time_t a = utc(2026, 1, 10), b = utc(2026, 1, 17);
+    std::vector<time_t> in;
+    for (time_t s : starts)
+      if (s + 1800 > a && s < b)
+        in.push_back(s);
+    std::sort(in.begin(), in.end());
+
+    IcsEntry out[12];
+    tHeapReset();
+    const size_t heap0 = tHeapNow;
+    const double t = tNowUs();
+    const uint8_t n = parse(big, 1460, out, 12, a, b);
+    const double us = tNowUs() - t;
+    CHECK_EQ(tAllocs, 0);
+    CHECK_EQ(tHeapPeak, heap0);
+    CHECK_EQ(n, std::min<size_t>(12, in.size()));
+    for (uint8_t i = 0; i < n; i++)
+      CHECK_EQ(out[i].start, in[i]);
+    printf("  %zu B, %zu eventi (%zu nella settimana): %.1f ms (%.1f MB/s), "
+           "0 alloc, parser %zu B + indice %zu B\n",
+           big.size(), starts.size(), in.size(), us / 1000, big.size() / us,
+           sizeof(IcsParser), sizeof(out));
+  }
+
+  TEST_END();
+}
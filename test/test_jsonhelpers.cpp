@@ -0,0 +1,180 @@
+// jsonhelpers.h: tokenizer pull, query compilate (chiavi annidate, indici,
+// array), escape \uXXXX, JSON troncati, zero allocazioni e confronto con
+// il vecchio jsonNum (una String per chiave + riscansione dall'inizio)
+#include "test.h"
+
+#include "handlers/jsonhelpers.h"
+
+#include <vector>
+
+// jsonNum come era prima del tokenizer: riferimento per il benchmark
+static bool legacyJsonNum(const String &src, const char *key, float &out) {
+  String k = "\"";
+  k += key;
+  k += '"';
+  int p = src.indexOf(k);
+  if (p < 0)
+    return false;
+  p = src.indexOf(':', p);
+  if (p < 0)
+    return false;
+  const int N = src.length();
+  int s = p + 1;
+  while (s < N && (src[s] == ' ' || src[s] == '"'))
+    s++;
+  int e = s;
+  while (e < N && (isdigit(src[e]) || src[e] == '-' || src[e] == '+' || src[e] == '.'))
+    e++;
+  if (e <= s)
+    return false;
+  out = src.substring(s, e).toFloat();
+  return true;
+}
+
+static uint8_t extract(const char *j, JsonQuery *q, uint8_t n) {
+  return jsonExtract(j, strlen(j), q, n);
+}
+
+int main() {
+  // --- Tokenizer ---
+  {
+    const char *j = R"({"a": [1, -2.5e3, "x\"y", true, null], "b": {}})";
+    JsonPull jp(j, strlen(j));
+    const JsonTok want[] = {JT_OBJ, JT_KEY, JT_ARR, JT_NUM, JT_NUM, JT_STR, JT_LIT,
+                            JT_LIT, JT_ARR_END, JT_KEY, JT_OBJ, JT_OBJ_END, JT_OBJ_END,
+                            JT_END};
+    for (JsonTok w : want)
+      CHECK_EQ(jp.next(), w);
+
+    JsonPull sk(j, strlen(j));
+    sk.next();
+    sk.next();
+    sk.skip(); // array intero
+    CHECK_EQ(sk.next(), JT_KEY);
+    CHECK(sk.keyIs("b"));
+  }
+
+  // --- Query: oggetti, indici, array, stringhe, radice array ---
+  {
+    const char *j = R"({"rates":{"USD":1.1,"EUR":0.9},"base":"CHF",
+      "daily":{"weathercode":[1,2,3,4,5,6,7]},
+      "results":[{"latitude":45.1,"longitude":9.2},{"latitude":1}],
+      "current_weather":{"temperature":-3.5}})";
+    float usd, eur, chf, lat, lon, temp, wc[7];
+    char base[8];
+    JsonQuery q[] = {jqFloat("rates.USD", usd), jqFloat("rates.EUR", eur),
+                     jqFloat("rates.CHF", chf), jqFloats("daily.weathercode", wc, 7),
+                     jqFloat("results[0].latitude", lat),
+                     jqFloat("results[0].longitude", lon),
+                     jqFloat("current_weather.temperature", temp),
+                     jqStr("base", base, sizeof(base))};
+    CHECK_EQ(extract(j, q, 8), 7);
+    CHECK(usd == 1.1f && eur == 0.9f && std::isnan(chf));
+    CHECK(lat == 45.1f && lon == 9.2f && temp == -3.5f);
+    CHECK(wc[0] == 1 && wc[6] == 7);
+    CHECK_STR(base, "CHF");
+
+    const char *m = R"({"a":{"b":[[1,2],[3,4]],"c":5},"x":{"c":9}})";
+    float c, b10, arr[2];
+    JsonQuery q3[] = {jqFloat("x.c", c), jqFloat("a.b[1][0]", b10),
+                      jqFloats("a.b[0]", arr, 2)};
+    CHECK_EQ(extract(m, q3, 3), 3);
+    CHECK(c == 9 && b10 == 3 && arr[0] == 1 && arr[1] == 2);
+
+    const char *h = R"({"hourly":{"time":["a","b"],"temperature_2m":[1,2,null,4]}})";
+    float tt[24];
+    JsonQuery q4 = jqFloats("hourly.temperature_2m", tt, 24);
+    CHECK_EQ(extract(h, &q4, 1), 1);
+    CHECK_EQ(q4.count, 4);
+    CHECK(tt[1] == 2 && std::isnan(tt[2]) && tt[3] == 4);
+  }
+
+  // --- Escape e \uXXXX (coppie surrogate comprese) ---
+  {
+    const char *k = R"([{"q":"a \"b\" è 😀 \\ \/","a":"Auth"}])";
+    char qq[64], aa[8];
+    JsonQuery q[] = {jqStr("[0].q", qq, sizeof(qq)), jqStr("[0].a", aa, sizeof(aa))};
+    CHECK_EQ(extract(k, q, 2), 2);
+    CHECK_STR(qq, "a \"b\" \xC3\xA8 \xF0\x9F\x98\x80 \\ /");
+    CHECK_STR(aa, "Auth");
+
+    char tiny[4];
+    JsonQuery t = jqStr("[0].q", tiny, sizeof(tiny));
+    extract(k, &t, 1);
+    CHECK_EQ(strlen(tiny), 3); // troncato, sempre terminato
+  }
+
+  // --- Numeri come stringa, chiavi omonime a profondità diverse ---
+  {
+    const char *j = R"({"price":"42.5","nested":{"price":1},"price_24h":7})";
+    float p, n;
+    JsonQuery q[] = {jqFloat("price", p), jqFloat("nested.price", n)};
+    CHECK_EQ(extract(j, q, 2), 2);
+    CHECK(p == 42.5f && n == 1);
+  }
+
+  // --- JSON troncati o malformati: mai letture fuori dal buffer ---
+  {
+    const std::string j =
+        R"({"a":{"b":[1,2,{"c":"x\"y"}],"d":"è"},"e":[[[[1]]]],"f":-1.5e2})";
+    for (size_t cut = 0; cut <= j.size(); cut++) {
+      std::vector<char> buf(j.begin(), j.begin() + cut); // dimensione esatta
+      float f, b[4];
+      char d[8];
+      JsonQuery q[] = {jqFloat("f", f), jqFloats("a.b", b, 4), jqStr("a.d", d, sizeof(d))};
+      const uint8_t got = jsonExtract(buf.data(), buf.size(), q, 3);
+      CHECK(got <= 3);
+      if (cut == j.size())
+        CHECK(got == 3 && f == -150 && b[1] == 2 && !strcmp(d, "\xC3\xA8"));
+    }
+    for (const char *bad : {"", "{", "}", "]]]]", "{\"a\":", "\"", "[1,2,", "{{{{{{{{{{{{"}) {
+      float v;
+      JsonQuery q = jqFloat("a", v);
+      jsonExtract(bad, strlen(bad), &q, 1);
+      JsonPull jp(bad, strlen(bad));
+      for (int i = 0; i < 64 && jp.next() > JT_ERR; i++)
+        ;
+    }
+  }
+
+  // --- Zero allocazioni e benchmark contro il vecchio jsonNum ---
+  {
+    std::string body = R"({"amount":1.0,"base":"CHF","date":"2026-01-09","rates":{)";
+    for (int i = 0; i < 30; i++) // come Frankfurter con tutte le valute
+      body += "\"X" + std::to_string(i) + "\":" + std::to_string(1 + i * 0.37) + ",";
+    body += R"("CAD":1.74,"CNY":8.95,"EUR":1.07,"GBP":0.93,"INR":104.3,"JPY":188.1,"USD":1.24,"ZAR":22.1}})";
+    const char *keys[] = {"EUR", "USD", "GBP", "JPY", "CAD", "CNY", "INR", "CHF"};
+    const String sbody(body.c_str());
+    const int reps = tBench() ? 200000 : 20000;
+
+    double r[8];
+    tHeapReset();
+    size_t s0 = shim_strings;
+    double t0 = tNowUs();
+    for (int i = 0; i < reps; i++) {
+      JsonQuery q[] = {jqDouble("rates.EUR", r[0]), jqDouble("rates.USD", r[1]),
+                       jqDouble("rates.GBP", r[2]), jqDouble("rates.JPY", r[3]),
+                       jqDouble("rates.CAD", r[4]), jqDouble("rates.CNY", r[5]),
+                       jqDouble("rates.INR", r[6]), jqDouble("rates.CHF", r[7])};
+      jsonExtract(sbody, q, 8);
+    }
+    const double tNew = (tNowUs() - t0) / reps;
+    CHECK_EQ(tAllocs, 0);
+    CHECK_EQ(shim_strings - s0, 0);
+    CHECK(r[0] == 1.07 && r[5] == 8.95 && std::isnan(r[7]));
+
+    float v[8];
+    s0 = shim_strings;
+    t0 = tNowUs();
+    for (int i = 0; i < reps; i++)
+      for (int k = 0; k < 8; k++)
+        legacyJsonNum(sbody, keys[k], v[k]);
+    const double tOld = (tNowUs() - t0) / reps;
+    const size_t sOld = (shim_strings - s0) / reps;
+    CHECK(v[0] == 1.07f);
+    printf("  fx, 8 campi su %zu B: pull %.2f µs / 0 String, vecchio jsonNum %.2f µs / %zu String\n",
+           body.size(), tNew, tOld, sOld);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,302 @@
+// nightmode.h con backlight.h sul LEDC finto e l'ora del dispositivo
+// simulata: curva (rampe, fondo, fascia troppo corta per le rampe),
+// fascia a cavallo della mezzanotte, sveglia da tocco e ritorno alla
+// curva, tocco a schermo spento che accende soltanto, modem sleep fuori
+// dai fetch; infine 24 ore di loop con un modello di costo (CPU e radio)
+// per ora. Il rapporto ora per ora si stampa solo con make bench.
+#include "test.h"
+
+#include "handlers/nightmode.h"
+
+#include <string>
+
+NightCfg g_night = {true, 23, 7, 15, 30};
+bool g_timeSynced = true;
+
+// Orologio del dispositivo: mezzanotte UTC + shim_ms
+static const time_t MIDNIGHT = 1768003200; // 10/01/2026 00:00 UTC
+extern "C" time_t time(time_t *t) noexcept {
+  const time_t v = MIDNIGHT + shim_ms / 1000;
+  if (t)
+    *t = v;
+  return v;
+}
+
+static constexpr uint32_t H = 3600000, MIN = 60000;
+static constexpr uint8_t LOW15 = BL_MAX * 15 / 100; // 38
+
+static void reset(uint32_t at) {
+  bl_ramp = BlRamp();
+  bl_next = {0, 0, nullptr, false};
+  bl_hw_end.store(-1);
+  bl_ready = false;
+  shim_ledc = ShimLedc();
+  WiFi = ShimWiFi();
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false); // come wlBegin()
+  nm_in = nm_night = nm_ps = false;
+  nm_level = BL_MAX;
+  nm_next = nm_wake = nm_frame = 0;
+  shim_ms = at;
+  blFadeTo(BL_MAX, 0);
+}
+
+// Loop fino a t: nmTick, LEDC, blTick, pausa nmLoopMs()
+static void runUntil(uint32_t t, bool fetching = false) {
+  while ((int32_t)(t - shim_ms) > 0) {
+    nmTick(true, fetching);
+    shimLedcRun();
+    blTick();
+    shim_ms += std::min<uint32_t>(nmLoopMs(), t - shim_ms);
+  }
+}
+
+// ============================================================================
+// MODELLO DI COSTO (valori tipici ESP32-S3, non misure)
+// ============================================================================
+static constexpr double LOOP_CPU_MS = 0.12;   // giro di loop senza lavoro
+static constexpr double FRAME_CPU_MS = 1.5;   // fotogramma di particelle
+static constexpr uint32_t PAGE_TICK_MS = 40;  // particelle di giorno (25 fps)
+static constexpr double PAGE_CPU_MS = 14 + 25; // cambio pagina + layer
+static constexpr uint32_t PAGE_MS = 15000;
+static constexpr uint32_t REFRESH_MS = 600000;
+static constexpr uint8_t FETCHES = 10;        // un giro di refresh
+static constexpr double FETCH_CPU_MS = 350;
+static constexpr uint32_t FETCH_AIR_MS = 1200;
+static constexpr double SLEEP_AWAKE = 3.0 / 102.4; // DTIM 1: ~3 ms per beacon
+
+struct Hour {
+  double cpuMs = 0, radioMs = 0;
+  uint32_t frames = 0, fetches = 0, pages = 0;
+  uint64_t dutySum = 0; // duty campionato ogni secondo
+  uint32_t samples = 0;
+  bool night = false;
+};
+
+// Giornata intera dalle 00:00 con g_night attuale
+static void simulateDay(Hour *h) {
+  reset(0);
+  uint32_t lastRefresh = 0, lastPage = 0, lastTick = 0, lastSample = 0;
+  bool first = true;
+  while (shim_ms < 24 * H) {
+    Hour &cur = h[shim_ms / H];
+
+    // Giro di refresh: un fetch per giro di loop, radio accesa
+    if (first || shim_ms - lastRefresh >= nmRefreshMs(REFRESH_MS)) {
+      first = false;
+      lastRefresh = shim_ms;
+      for (uint8_t k = 0; k < FETCHES; k++) {
+        nmTick(true, true);
+        shim_ms += FETCH_AIR_MS;
+        shimLedcRun();
+        blTick();
+        Hour &f = h[std::min<uint32_t>(shim_ms / H, 23)];
+        f.cpuMs += FETCH_CPU_MS;
+        f.radioMs += FETCH_AIR_MS;
+        f.fetches++;
+      }
+      continue;
+    }
+
+    nmTick(true, false);
+    shimLedcRun();
+    blTick();
+    cur.cpuMs += LOOP_CPU_MS;
+    cur.night |= nmNight();
+
+    if (shim_ms - lastTick >= PAGE_TICK_MS && nmFrame()) {
+      lastTick = shim_ms;
+      cur.frames++;
+      cur.cpuMs += FRAME_CPU_MS;
+    }
+    // schermo spento di notte: rotazione ferma
+    if (!nmBacklight())
+      lastPage = shim_ms;
+    if (shim_ms - lastPage >= PAGE_MS) {
+      lastPage = shim_ms;
+      cur.pages++;
+      cur.cpuMs += PAGE_CPU_MS;
+    }
+    if (shim_ms - lastSample >= 1000) {
+      lastSample = shim_ms;
+      cur.dutySum += shim_ledc.duty;
+      cur.samples++;
+    }
+
+    const uint32_t dt = nmLoopMs();
+    cur.radioMs += WiFi.sleep ? dt * SLEEP_AWAKE : dt;
+    shim_ms += dt;
+  }
+}
+
+static void report(const char *title, const Hour *h) {
+  printf("  %s\n  ora  fascia   CPU     radio      fetch  fotogrammi  pagine  duty\n", title);
+  for (int i = 0; i < 24; i++)
+    printf("  %02d   %-6s  %5.2f %%  %6.1f s  %5u  %10u  %6u  %4llu\n", i,
+           h[i].night ? "notte" : "giorno", h[i].cpuMs / H * 100, h[i].radioMs / 1000,
+           h[i].fetches, h[i].frames, h[i].pages,
+           h[i].samples ? (unsigned long long)(h[i].dutySum / h[i].samples) : 0ULL);
+}
+
+int main() {
+  // --- Curva: 23→7, fondo 15 %, rampe di 30 minuti ---
+  {
+    const NightCfg c = {true, 23, 7, 15, 30};
+    CHECK_EQ(nmCurve(c, 22 * 60 + 59), BL_MAX);
+    CHECK_EQ(nmCurve(c, 23 * 60), BL_MAX); // inizio rampa
+    CHECK_EQ(nmCurve(c, 23 * 60 + 15), BL_MAX - (BL_MAX - LOW15) / 2);
+    CHECK_EQ(nmCurve(c, 23 * 60 + 30), LOW15);
+    CHECK_EQ(nmCurve(c, 3 * 60), LOW15);
+    CHECK_EQ(nmCurve(c, 6 * 60 + 45), BL_MAX - (BL_MAX - LOW15) / 2);
+    CHECK_EQ(nmCurve(c, 7 * 60), BL_MAX);
+    for (uint16_t m = 1; m < 1440; m++) // mai un salto lungo la curva
+      CHECK(abs(nmCurve(c, m) - nmCurve(c, m - 1)) <= (BL_MAX - LOW15) / 30 + 1);
+
+    // fascia di un'ora: rampe ridotte a metà fascia, fondo a metà
+    const NightCfg s = {true, 1, 2, 0, 180};
+    CHECK_EQ(nmCurve(s, 60 + 30), 0);
+    CHECK_EQ(nmCurve(s, 60 + 15), BL_MAX - BL_MAX / 2);
+
+    // spenta, o inizio = fine: mai notte
+    const NightCfg off = {false, 23, 7, 15, 30}, same = {true, 5, 5, 15, 30};
+    CHECK_EQ(nmInside(off, 0), -1);
+    CHECK_EQ(nmInside(same, 5 * 60), -1);
+  }
+
+  // --- Fascia a cavallo della mezzanotte ---
+  {
+    const NightCfg c = {true, 23, 7, 15, 30};
+    CHECK_EQ(nmInside(c, 23 * 60), 0);
+    CHECK_EQ(nmInside(c, 23 * 60 + 59), 59);
+    CHECK_EQ(nmInside(c, 0), 60);
+    CHECK_EQ(nmInside(c, 6 * 60 + 59), 479);
+    CHECK_EQ(nmInside(c, 7 * 60), -1);
+    CHECK_EQ(nmInside(c, 12 * 60), -1);
+    CHECK_EQ(nmInside(c, 22 * 60 + 59), -1);
+
+    // il loop passa la mezzanotte senza uscire dalla fascia
+    reset(23 * H + 50 * MIN);
+    runUntil(23 * H + 59 * MIN);
+    CHECK(nmNight() && nmBacklight() == LOW15);
+    shim_ms = 0; // 00:00 del giorno dopo (time() riparte da MIDNIGHT)
+    nm_next = 0;
+    runUntil(10 * MIN);
+    CHECK(nmNight() && nmBacklight() == LOW15);
+    CHECK_EQ(shim_ledc.overlaps, 0);
+  }
+
+  // --- Notte: curva sul LEDC, 4 fps, loop lento, refresh ×3, modem sleep ---
+  {
+    reset(3 * H);
+    runUntil(3 * H + 10000);
+    CHECK(nmNight());
+    CHECK_EQ(nmBacklight(), LOW15);
+    CHECK_EQ(shim_ledc.duty, LOW15);
+    CHECK(!blBusy());
+    CHECK_EQ(nmLoopMs(), NM_LOOP_MS);
+    CHECK_EQ(nmRefreshMs(REFRESH_MS), REFRESH_MS * NM_REFRESH_X);
+    CHECK(WiFi.sleep);
+    CHECK(nmFrame());
+    CHECK(!nmFrame());
+    shim_ms += NM_FRAME_MS;
+    CHECK(nmFrame());
+
+    // durante un fetch la radio resta sveglia
+    runUntil(shim_ms + 100, true);
+    CHECK(!WiFi.sleep);
+    runUntil(shim_ms + 100);
+    CHECK(WiFi.sleep);
+
+    // in AP (portale) niente modem sleep
+    WiFi.mode(WIFI_AP);
+    runUntil(shim_ms + 100, true);
+    runUntil(shim_ms + 100);
+    CHECK(!WiFi.sleep);
+
+    // senza ora valida la fascia non scatta mai
+    reset(3 * H);
+    g_timeSynced = false;
+    runUntil(3 * H + 5000);
+    CHECK(!nmNight());
+    CHECK_EQ(shim_ledc.duty, BL_MAX);
+    g_timeSynced = true;
+  }
+
+  // --- Sveglia da tocco: giorno per NM_WAKE_MS, poi di nuovo la curva ---
+  {
+    reset(3 * H);
+    runUntil(3 * H + 10000);
+    CHECK(!nmTouch()); // schermo acceso (15 %): il tocco vale come tocco
+    CHECK(!nmNight());
+    CHECK_EQ(nmBacklight(), BL_MAX);
+    CHECK_EQ(blTarget(), BL_MAX);
+    runUntil(shim_ms + 1000);
+    CHECK_EQ(shim_ledc.duty, BL_MAX);
+    CHECK(!WiFi.sleep);
+    CHECK_EQ(nmLoopMs(), NM_DAY_LOOP_MS);
+
+    const uint32_t touched = shim_ms - 1000;
+    runUntil(touched + NM_WAKE_MS - 50);
+    CHECK(!nmNight());
+    runUntil(touched + NM_WAKE_MS + 50);
+    CHECK(nmNight());
+    runUntil(shim_ms + NM_FADE_MS + 100);
+    CHECK_EQ(shim_ledc.duty, LOW15);
+    CHECK_EQ(shim_ledc.overlaps, 0);
+  }
+
+  // --- Schermo spento (fondo 0 %): il tocco accende soltanto ---
+  {
+    g_night.dim = 0;
+    reset(3 * H);
+    runUntil(3 * H + 10000);
+    CHECK_EQ(shim_ledc.duty, 0);
+    CHECK(!nmFrame()); // niente particelle a schermo spento
+    CHECK(nmTouch());  // accende, il gesto va ignorato
+    CHECK(!nmTouch()); // già sveglio: tocco normale
+    runUntil(shim_ms + 500);
+    CHECK_EQ(shim_ledc.duty, BL_MAX);
+    g_night.dim = 15;
+  }
+
+  // --- 24 ore: CPU e radio per ora, di giorno e di notte ---
+  {
+    static Hour off[24], dim[24], dark[24];
+    g_night.on = false;
+    simulateDay(off);
+    g_night.on = true;
+    simulateDay(dim);
+    g_night.dim = 0;
+    simulateDay(dark);
+    g_night.dim = 15;
+
+    // ore piene di notte (01–05) contro le stesse ore senza modalità notte
+    for (int i = 1; i <= 5; i++) {
+      CHECK(!off[i].night && dim[i].night && dark[i].night);
+      CHECK(dim[i].cpuMs < off[i].cpuMs / 2);
+      CHECK(dark[i].cpuMs < dim[i].cpuMs);
+      CHECK(off[i].radioMs > H - 1000);
+      CHECK(dim[i].radioMs < H / 10);
+      CHECK(dim[i].fetches < off[i].fetches);
+      CHECK(dim[i].frames <= 3600 * 1000 / NM_FRAME_MS);
+      CHECK_EQ(dark[i].frames, 0);
+      CHECK_EQ(dark[i].pages, 0);
+      CHECK_EQ(dim[i].dutySum / dim[i].samples, LOW15);
+    }
+    // di giorno le due configurazioni coincidono
+    for (int i = 8; i <= 22; i++) {
+      CHECK(!dim[i].night);
+      CHECK_EQ(dim[i].frames, off[i].frames);
+      CHECK_EQ(dim[i].dutySum / dim[i].samples, BL_MAX);
+    }
+    CHECK_EQ(shim_ledc.overlaps, 0);
+
+    if (tBench()) {
+      report("modalità notte spenta", off);
+      report("notte 23→7, fondo 15 %, rampe 30 min", dim);
+      report("notte 23→7, fondo 0 %", dark);
+    }
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,3 @@
+// nvconfig.h con CFG_BLOB 1: stessi scenari di test_nvconfig.cpp
+#define CFG_BLOB 1
+#include "test_nvconfig.cpp"
@@ -0,0 +1,286 @@
+// nvconfig.h: scritture NVS per salvataggio contate su Preferences finto.
+// Nessun cambio → NVS non viene nemmeno aperto; una chiave → una put;
+// nvSave(NV_LAT, NV_LON + 1) tocca solo le coordinate; ricarica identica.
+// test_nvblob.cpp ricompila questo file con CFG_BLOB 1: una sola putBytes
+// per salvataggio, byte del blob little-endian, CRC, versione e blob
+// troncato o corrotto → ritorno alle chiavi singole.
+#include "test.h"
+
+#include "handlers/nvconfig.h"
+
+#include <cmath>
+#include <zlib.h>
+
+Preferences prefs;
+
+String g_fiat, g_city, g_lang, g_ics, g_lat, g_lon, g_rss_url, g_oa_key, g_oa_topic, g_note,
+    g_ha_ip, g_ha_token, g_ha_ents;
+CDEvent cd[8];
+double g_btc_owned = NAN;
+bool g_splash_enabled = true;
+uint32_t PAGE_INTERVAL_MS = 15000;
+NightCfg g_night = {false, 23, 7, 20, 30};
+bool g_show[PAGES];
+
+// Come displayhelpers.h (maschera vuota → tutte le pagine)
+uint32_t pagesMaskFromArray() {
+  uint32_t m = 0;
+  for (int i = 0; i < PAGES; i++)
+    if (g_show[i])
+      m |= 1UL << i;
+  return m;
+}
+void pagesArrayFromMask(uint32_t m) {
+  if (!(m & ((1UL << PAGES) - 1)))
+    m = 0xFFFFFFFF;
+  for (int i = 0; i < PAGES; i++)
+    g_show[i] = m & (1UL << i);
+}
+
+// Globali ai valori di fabbrica, come a un avvio a freddo
+static void coldDefaults() {
+  for (String *s : {&g_fiat, &g_city, &g_lang, &g_ics, &g_lat, &g_lon, &g_rss_url, &g_oa_key,
+                    &g_oa_topic, &g_note, &g_ha_ip, &g_ha_token, &g_ha_ents})
+    *s = "";
+  g_fiat = "CHF";
+  g_city = "Bellinzona";
+  g_lang = "it";
+  for (CDEvent &e : cd)
+    e = {"", ""};
+  g_btc_owned = NAN;
+  g_splash_enabled = true;
+  PAGE_INTERVAL_MS = 15000;
+  g_night = {false, 23, 7, 20, 30};
+  pagesArrayFromMask(0xFFFFFFFF);
+}
+
+static void reboot() {
+  coldDefaults();
+  nvLoadAll();
+  prefs.resetCounters();
+}
+
+static uint16_t le16(const std::string &b, size_t i) {
+  return (uint8_t)b[i] | (uint8_t)b[i + 1] << 8;
+}
+static uint32_t le32(const std::string &b, size_t i) {
+  return le16(b, i) | (uint32_t)le16(b, i + 2) << 16;
+}
+
+int main() {
+#if CFG_BLOB
+  printf("  CFG_BLOB 1\n");
+#endif
+  // NVS di un dispositivo già configurato, a chiavi singole
+  prefs.kv["city"] = "Lugano";
+  prefs.kv["lat"] = "46.0037";
+  prefs.kv["lon"] = "8.9511";
+  prefs.kv["btc_owned"] = " 0.5 ";
+  prefs.kv["cd3n"] = "Vacanze";
+  prefs.kv["cd3t"] = "2026-08-01T00:00";
+  const uint32_t ms = 20000, mask = 0x1F;
+  prefs.kv["page_ms"].assign((const char *)&ms, 4);
+  prefs.kv["pages_mask"].assign((const char *)&mask, 4);
+  prefs.kv["splash"] = std::string(1, '\0');
+
+  reboot();
+  CHECK_STR(g_city.c_str(), "Lugano");
+  CHECK_STR(g_lat.c_str(), "46.0037");
+  CHECK(fabs(g_btc_owned - 0.5) < 1e-12);
+  CHECK_STR(cd[2].name.c_str(), "Vacanze");
+  CHECK_STR(cd[2].whenISO.c_str(), "2026-08-01T00:00");
+  CHECK_EQ(PAGE_INTERVAL_MS, 20000);
+  CHECK_EQ(pagesMaskFromArray(), 0x1F);
+  CHECK(!g_splash_enabled);
+  CHECK_STR(g_fiat.c_str(), "CHF"); // chiave assente: resta il default
+
+#if CFG_BLOB
+  // --- Migrazione: il primo salvataggio crea il blob, le chiavi restano ---
+  CHECK_EQ(nvSave(0, NV_COUNT), 1);
+  CHECK_EQ(prefs.puts, 1);
+  CHECK_EQ(prefs.putsPerKey["cfg"], 1);
+  prefs.resetCounters();
+#endif
+
+  // --- Nessun cambio: zero scritture, NVS nemmeno aperto ---
+  CHECK_EQ(nvSave(0, NV_COUNT), 0);
+  CHECK_EQ(prefs.puts, 0);
+  CHECK_EQ(prefs.begins, 0);
+
+  // --- Una chiave: una scrittura ---
+  g_city = "Locarno";
+  CHECK_EQ(nvSave(0, NV_COUNT), 1);
+  CHECK_EQ(prefs.puts, 1);
+#if CFG_BLOB
+  CHECK_EQ(prefs.putsPerKey["cfg"], 1);
+#else
+  CHECK_EQ(prefs.putsPerKey["city"], 1);
+  CHECK_STR(prefs.kv["city"], "Locarno");
+#endif
+  CHECK_EQ(prefs.opened, 0);
+  prefs.resetCounters();
+  CHECK_EQ(nvSave(0, NV_COUNT), 0);
+  CHECK_EQ(prefs.begins, 0);
+
+  // --- Geocoding: nvSave(NV_LAT, NV_LON + 1) non tocca il resto ---
+  g_note = "modificata nel form, non ancora salvata";
+  CHECK_EQ(nvSave(NV_LAT, NV_LON + 1), 0); // coordinate uguali
+  CHECK_EQ(prefs.begins, 0);
+  g_lat = "46.1700";
+  g_lon = "8.7990";
+  prefs.resetCounters();
+#if CFG_BLOB
+  CHECK_EQ(nvSave(NV_LAT, NV_LON + 1), 1); // il blob porta con sé anche la nota
+  CHECK_EQ(prefs.putsPerKey["cfg"], 1);
+  CHECK_EQ(prefs.puts, 1);
+  CHECK_EQ(nvSave(0, NV_COUNT), 0);
+#else
+  CHECK_EQ(nvSave(NV_LAT, NV_LON + 1), 2);
+  CHECK_EQ(prefs.putsPerKey["lat"], 1);
+  CHECK_EQ(prefs.putsPerKey["lon"], 1);
+  CHECK_EQ(prefs.puts, 2);
+  CHECK(!prefs.kv.count("note"));
+  prefs.resetCounters();
+  CHECK_EQ(nvSave(0, NV_COUNT), 1); // la nota arriva col salvataggio completo
+  CHECK_EQ(prefs.putsPerKey["note"], 1);
+#endif
+  prefs.resetCounters();
+
+  // --- Form salvato senza cambi reali: 16 countdown, btc, notte uguali ---
+  for (CDEvent &e : cd)
+    e = CDEvent{String(e.name.c_str()), String(e.whenISO.c_str())};
+  g_btc_owned = 0.5;
+  CHECK_EQ(nvSave(0, NV_COUNT), 0);
+
+  // Più chiavi di tipo diverso
+  cd[7].whenISO = "2027-01-01T00:00";
+  g_night.on = true;
+  g_night.dim = 5;
+  pagesArrayFromMask(0x3);
+  g_splash_enabled = true;
+#if CFG_BLOB
+  CHECK_EQ(nvSave(0, NV_COUNT), 1);
+#else
+  CHECK_EQ(nvSave(0, NV_COUNT), 4);
+  CHECK_EQ(prefs.putsPerKey["cd8t"], 1);
+  CHECK_EQ(prefs.putsPerKey["night"], 1);
+  CHECK_EQ(prefs.putsPerKey["pages_mask"], 1);
+  CHECK_EQ(prefs.putsPerKey["splash"], 1);
+#endif
+  CHECK_EQ(prefs.roPuts, 0);
+
+  // --- Riavvio: stessi valori, nessuna scrittura ---
+  reboot();
+  CHECK_STR(g_city.c_str(), "Locarno");
+  CHECK_STR(g_lat.c_str(), "46.1700");
+  CHECK_STR(g_lon.c_str(), "8.7990");
+  CHECK_STR(g_note.c_str(), "modificata nel form, non ancora salvata");
+  CHECK_STR(cd[7].whenISO.c_str(), "2027-01-01T00:00");
+  CHECK(g_night.on && g_night.from == 23 && g_night.to == 7 && g_night.dim == 5 &&
+        g_night.ramp == 30);
+  CHECK_EQ(pagesMaskFromArray(), 0x3);
+  CHECK(g_splash_enabled);
+  CHECK(fabs(g_btc_owned - 0.5) < 1e-12);
+  CHECK_EQ(nvSave(0, NV_COUNT), 0);
+  CHECK_EQ(prefs.begins, 0);
+
+  // btc vuoto = non impostato, anche dopo il giro in NVS
+  g_btc_owned = NAN;
+  CHECK_EQ(nvSave(0, NV_COUNT), 1);
+  reboot();
+  CHECK(std::isnan(g_btc_owned));
+  CHECK_EQ(nvSave(0, NV_COUNT), 0);
+
+#if CFG_BLOB
+  // --- Byte del blob: intestazione little-endian, CRC sul payload ---
+  {
+    const std::string b = prefs.kv["cfg"];
+    CHECK(b.size() > NV_BLOB_HDR);
+    CHECK(!b.compare(0, 4, "SQCF"));
+    CHECK_EQ((uint8_t)b[4], NV_BLOB_VER);
+    CHECK_EQ((uint8_t)b[5], NV_COUNT);
+    CHECK_EQ(le16(b, 6), b.size() - NV_BLOB_HDR);
+    CHECK_EQ(le32(b, 8), crc32(0, (const Bytef *)b.data() + NV_BLOB_HDR, b.size() - NV_BLOB_HDR));
+
+    // record id, u16 len, testo: tutti gli id in ordine
+    size_t i = NV_BLOB_HDR;
+    for (uint8_t id = 0; id < NV_COUNT; id++) {
+      CHECK_EQ((uint8_t)b[i], id);
+      const uint16_t n = le16(b, i + 1);
+      String t;
+      nvText(id, t);
+      CHECK_STR(b.substr(i + 3, n), t.c_str());
+      i += 3 + n;
+    }
+    CHECK_EQ(i, b.size());
+
+    // golden: blob minimo scritto a mano → letto
+    std::string p;
+    auto rec = [&](uint8_t id, const std::string &v) {
+      p += (char)id;
+      p += (char)(v.size() & 0xFF);
+      p += (char)(v.size() >> 8);
+      p += v;
+    };
+    rec(NV_CITY, "Chiasso");
+    rec(NV_PAGE_MS, "30000");
+    rec(200, "id futuro: ignorato");
+    const uint32_t crc = crc32(0, (const Bytef *)p.data(), p.size());
+    std::string g = "SQCF";
+    g += (char)NV_BLOB_VER;
+    g += (char)3;
+    g += (char)(p.size() & 0xFF);
+    g += (char)(p.size() >> 8);
+    for (int k = 0; k < 4; k++)
+      g += (char)(crc >> (8 * k));
+    const std::string golden = g + p;
+    prefs.kv["cfg"] = golden;
+    reboot();
+    CHECK_STR(g_city.c_str(), "Chiasso");
+    CHECK_EQ(PAGE_INTERVAL_MS, 30000);
+    CHECK_EQ(nvSave(0, NV_COUNT), 0); // blob valido: niente da migrare
+
+    // blob rifiutato → chiavi singole, ferme a prima della migrazione
+    // (city = "Lugano"); il primo salvataggio riscrive il blob
+    auto rejected = [&](const std::string &bad) {
+      prefs.kv["cfg"] = bad;
+      reboot();
+      CHECK_STR(g_city.c_str(), "Lugano");
+      CHECK_EQ(nvSave(0, NV_COUNT), 1);
+      CHECK(prefs.kv["cfg"] != bad);
+    };
+    std::string v = golden;
+    v[4] = NV_BLOB_VER + 1; // versione
+    rejected(v);
+    v = golden;
+    v[NV_BLOB_HDR + 4] ^= 1; // CRC
+    rejected(v);
+    v = golden;
+    v[6]++; // lunghezza del payload
+    rejected(v);
+    rejected(golden.substr(0, golden.size() - 1)); // troncato
+    rejected(golden.substr(0, NV_BLOB_HDR - 1));
+    rejected("");
+
+    // record che esce dal payload anche con CRC giusto: nemmeno i record
+    // precedenti (fiat) devono restare applicati
+    std::string q = std::string("\0\3\0EUR", 6) + p;
+    q[7] = (char)0xFF;
+    std::string h = "SQCF";
+    h += (char)NV_BLOB_VER;
+    h += (char)3;
+    h += (char)(q.size() & 0xFF);
+    h += (char)(q.size() >> 8);
+    const uint32_t qc = crc32(0, (const Bytef *)q.data(), q.size());
+    for (int k = 0; k < 4; k++)
+      h += (char)(qc >> (8 * k));
+    prefs.kv["cfg"] = h + q;
+    reboot();
+    CHECK_STR(g_city.c_str(), "Lugano");
+    CHECK_STR(g_fiat.c_str(), "CHF");
+  }
+#endif
+
+  CHECK_EQ(prefs.roPuts, 0);
+  TEST_END();
+}
@@ -0,0 +1,383 @@
+// screencap.h: PNG validi (CRC dei chunk, zlib, filtri Sub/Up) che zlib
+// decodifica nel frame RGB565 espanso, righe PackBits reversibili, .bin
+// completo e delta (solo righe cambiate, base scaduta o sconosciuta →
+// frame completo), 429 entro SCR_MIN_MS, 503 senza framebuffer, client
+// che chiude a metà, e benchmark degli encoder
+#include "test.h"
+
+// layers.h viene dopo displayhelpers.h nello sketch
+int adjacentEnabledPage(int p, int dir);
+
+#include "handlers/asyncweb.h"
+#include "handlers/screencap.h"
+
+#include <random>
+#include <vector>
+#include <zlib.h>
+
+AsyncWeb web(80);
+Arduino_RGB_Display *gfx = nullptr;
+int g_page = 0;
+
+struct Sink {
+  std::string d;
+  void s(const char *p, size_t n) { d.append(p, n); }
+};
+
+struct NullSink {
+  size_t n = 0;
+  void s(const char *, size_t k) { n += k; }
+};
+
+static uint32_t be32(const uint8_t *p) {
+  return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+static uint16_t le16(const uint8_t *p) { return p[0] | p[1] << 8; }
+static uint32_t le32(const uint8_t *p) { return le16(p) | (uint32_t)le16(p + 2) << 16; }
+
+// ---------------------------------------------------------------------------
+// PNG → RGB888 con zlib; false se un chunk o lo stream non è valido
+// ---------------------------------------------------------------------------
+static bool pngDecode(const std::string &png, uint32_t &w, uint32_t &h,
+                      std::vector<uint8_t> &rgb) {
+  static const uint8_t SIG[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  if (png.size() < 8 || memcmp(png.data(), SIG, 8))
+    return false;
+  const uint8_t *p = (const uint8_t *)png.data();
+  size_t off = 8;
+  std::string idat;
+  bool ihdr = false, iend = false;
+  while (off + 12 <= png.size() && !iend) {
+    const uint32_t len = be32(p + off);
+    if (off + 12 + len > png.size())
+      return false;
+    const std::string type((const char *)p + off + 4, 4);
+    if (crc32(0, p + off + 4, 4 + len) != be32(p + off + 8 + len))
+      return false;
+    const uint8_t *d = p + off + 8;
+    if (type == "IHDR") {
+      w = be32(d);
+      h = be32(d + 4);
+      ihdr = len == 13 && d[8] == 8 && d[9] == 2 && !d[10] && !d[11] && !d[12];
+    } else if (type == "IDAT") {
+      if (len > SCR_IDAT)
+        return false;
+      idat.append((const char *)d, len);
+    } else if (type == "IEND") {
+      iend = true;
+    }
+    off += 12 + len;
+  }
+  if (!ihdr || !iend || off != png.size())
+    return false;
+
+  const size_t stride = 1 + 3 * (size_t)w;
+  std::vector<uint8_t> raw(stride * h + 1);
+  uLongf n = raw.size();
+  if (uncompress(raw.data(), &n, (const Bytef *)idat.data(), idat.size()) != Z_OK ||
+      n != stride * h)
+    return false;
+
+  rgb.assign(3 * (size_t)w * h, 0);
+  for (uint32_t y = 0; y < h; y++) {
+    const uint8_t f = raw[y * stride];
+    const uint8_t *s = &raw[y * stride + 1];
+    uint8_t *o = &rgb[3 * (size_t)w * y];
+    for (size_t i = 0; i < 3 * (size_t)w; i++) {
+      if (f == 1)
+        o[i] = s[i] + (i >= 3 ? o[i - 3] : 0);
+      else if (f == 2)
+        o[i] = s[i] + (y ? o[i - 3 * (size_t)w] : 0);
+      else if (f == 0)
+        o[i] = s[i];
+      else
+        return false;
+    }
+  }
+  return true;
+}
+
+static std::vector<uint8_t> toRgb(const uint16_t *px, size_t n) {
+  std::vector<uint8_t> o;
+  for (size_t i = 0; i < n; i++) {
+    const uint8_t r = px[i] >> 11, g = (px[i] >> 5) & 0x3F, b = px[i] & 0x1F;
+    o.push_back(r << 3 | r >> 2);
+    o.push_back(g << 2 | g >> 4);
+    o.push_back(b << 3 | b >> 2);
+  }
+  return o;
+}
+
+static std::string encodePng(const uint16_t *fb, uint16_t w, uint16_t h) {
+  Sink s;
+  ScrPng<Sink> enc(s);
+  enc.begin(w, h);
+  for (uint16_t y = 0; y < h; y++)
+    enc.row(fb + (size_t)y * w);
+  enc.end();
+  return s.d;
+}
+
+// ---------------------------------------------------------------------------
+// PackBits: decodifica di una riga; false se non consuma esattamente n pixel
+// ---------------------------------------------------------------------------
+static bool unpackRow(const uint8_t *&p, const uint8_t *end, uint16_t *dst, uint16_t n) {
+  uint16_t x = 0;
+  while (x < n) {
+    if (p >= end)
+      return false;
+    const uint8_t c = *p++;
+    const uint16_t k = (c & 0x7F) + 1;
+    if (x + k > n)
+      return false;
+    if (c & 0x80) {
+      if (end - p < 2)
+        return false;
+      for (uint16_t i = 0; i < k; i++)
+        dst[x + i] = le16(p);
+      p += 2;
+    } else {
+      if (end - p < 2 * k)
+        return false;
+      for (uint16_t i = 0; i < k; i++)
+        dst[x + i] = le16(p + 2 * i);
+      p += 2 * k;
+    }
+    x += k;
+  }
+  return true;
+}
+
+// /screen.bin applicato sopra frame (il frame base per un delta)
+struct BinFrame {
+  uint32_t gen = 0, base = 0;
+  std::vector<uint16_t> rows; // y delle righe presenti
+};
+
+static bool binApply(const std::string &bin, std::vector<uint16_t> &frame, BinFrame &f) {
+  const uint8_t *p = (const uint8_t *)bin.data(), *end = p + bin.size();
+  if (bin.size() < 18 || memcmp(p, "SQF1", 4) || le16(p + 4) != SCR_W || le16(p + 6) != SCR_H)
+    return false;
+  f.gen = le32(p + 8);
+  f.base = le32(p + 12);
+  f.rows.clear();
+  p += 16;
+  while (end - p >= 2) {
+    const uint16_t y = le16(p);
+    p += 2;
+    if (y == 0xFFFF)
+      return p == end;
+    if (y >= SCR_H || (!f.rows.empty() && y <= f.rows.back()))
+      return false;
+    f.rows.push_back(y);
+    if (!unpackRow(p, end, &frame[(size_t)y * SCR_W], SCR_W))
+      return false;
+  }
+  return false;
+}
+
+// Frame di prova: tinta unita, sfumatura, rumore, righe ripetute, "UI"
+static void fill(std::vector<uint16_t> &fb, int kind, std::mt19937 &rng) {
+  for (size_t y = 0; y < SCR_H; y++)
+    for (size_t x = 0; x < SCR_W; x++) {
+      uint16_t &px = fb[y * SCR_W + x];
+      switch (kind) {
+      case 0: px = 0x18E3; break;
+      case 1: px = (uint16_t)((x * 31 / SCR_W) << 11 | (y * 63 / SCR_H) << 5 | (x + y) % 32); break;
+      case 2: px = (uint16_t)rng(); break;
+      case 3: px = (y / 40) % 2 ? 0xFFFF : (uint16_t)(x * 7); break;
+      default: // sfondo, header, testo sparso
+        px = y < 60 ? 0x2104 : ((x / 3 + y / 5) % 11 == 0 && rng() % 3 == 0 ? 0xFFFF : 0x0000);
+      }
+    }
+}
+
+int main() {
+  std::mt19937 rng(40);
+
+  // --- CRC: tabella a 4 bit contro zlib ---
+  for (int i = 0; i < 200; i++) {
+    std::string d;
+    for (int k = rng() % 3000; k; k--)
+      d += (char)rng();
+    const uint32_t c0 = rng();
+    CHECK_EQ(scrCrc32(c0, (const uint8_t *)d.data(), d.size()),
+             crc32(c0, (const Bytef *)d.data(), d.size()));
+  }
+
+  // --- PNG: decodifica zlib == RGB565 espanso, anche a dimensioni strane ---
+  std::vector<uint16_t> fb(SCR_W * SCR_H);
+  for (int kind = 0; kind < 5; kind++) {
+    fill(fb, kind, rng);
+    const std::string png = encodePng(fb.data(), SCR_W, SCR_H);
+    uint32_t w = 0, h = 0;
+    std::vector<uint8_t> rgb;
+    CHECK(pngDecode(png, w, h, rgb));
+    CHECK_EQ(w, SCR_W);
+    CHECK_EQ(h, SCR_H);
+    CHECK(rgb == toRgb(fb.data(), fb.size()));
+    if (kind == 0)
+      CHECK(png.size() < 8192); // tinta unita: solo run
+  }
+  for (uint16_t w : {1, 2, 3, 7, 258, 259, 479}) {
+    std::vector<uint16_t> small((size_t)w * 5);
+    for (auto &px : small)
+      px = rng() % 4 ? 0x1234 : (uint16_t)rng();
+    memcpy(&small[(size_t)w * 3], &small[(size_t)w * 2], w * 2); // riga Up
+    uint32_t ow = 0, oh = 0;
+    std::vector<uint8_t> rgb;
+    CHECK(pngDecode(encodePng(small.data(), w, 5), ow, oh, rgb));
+    CHECK(ow == w && oh == 5);
+    CHECK(rgb == toRgb(small.data(), small.size()));
+  }
+
+  // --- PackBits: righe casuali con run di ogni lunghezza ---
+  for (int i = 0; i < 5000; i++) {
+    uint16_t row[SCR_W];
+    for (uint16_t x = 0; x < SCR_W;) {
+      const uint16_t v = (uint16_t)rng();
+      for (uint16_t k = rng() % 2 ? 1 : 1 + rng() % 300; k && x < SCR_W; k--)
+        row[x++] = (rng() % 4 == 0) ? (uint16_t)rng() : v;
+    }
+    const uint16_t n = 1 + rng() % SCR_W;
+    Sink s;
+    scrPackRow(s, row, n);
+    CHECK(s.d.size() <= 2u * n + (n + 127) / 128); // caso peggiore: solo letterali
+    uint16_t back[SCR_W];
+    const uint8_t *p = (const uint8_t *)s.d.data();
+    CHECK(unpackRow(p, p + s.d.size(), back, n));
+    CHECK(p == (const uint8_t *)s.d.data() + s.d.size());
+    CHECK(!memcmp(back, row, n * 2));
+  }
+
+  // --- Rotte: niente framebuffer → 503 ---
+  web.on("/screen.bin", HTTP_GET, handleScreenBin, false);
+  web.on("/screen.png", HTTP_GET, handleScreenPng, false);
+  CHECK(web.begin());
+  shim_ms = 100000;
+  shimHttpdRequest(HTTP_GET, "/screen.png");
+  CHECK_STR(shim_httpd.status, "503 Service Unavailable");
+
+  // --- PNG dal framebuffer, senza lock; subito dopo 429 ---
+  gfx = new Arduino_RGB_Display(fb.data());
+  fill(fb, 4, rng);
+  shim_ms += SCR_MIN_MS;
+  shim_lock_takes = 0;
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, "/screen.png"), ESP_OK);
+  CHECK_EQ(shim_lock_takes, 0);
+  CHECK_STR(shim_httpd.status, "200 OK");
+  CHECK_STR(shim_httpd.type, "image/png");
+  {
+    uint32_t w, h;
+    std::vector<uint8_t> rgb;
+    CHECK(pngDecode(shim_httpd.body, w, h, rgb));
+    CHECK(rgb == toRgb(fb.data(), fb.size()));
+  }
+  shimHttpdRequest(HTTP_GET, "/screen.bin"); // meno di SCR_MIN_MS dall'inizio del PNG
+  CHECK_STR(shim_httpd.status, "429 Too Many Requests");
+  CHECK_STR(shim_httpd.header("Retry-After"), "1");
+
+  // --- .bin completo, poi delta con solo le righe toccate ---
+  std::vector<uint16_t> got(SCR_W * SCR_H, 0);
+  BinFrame f;
+  auto bin = [&](const char *uri) {
+    shim_ms += SCR_MIN_MS;
+    CHECK_EQ(shimHttpdRequest(HTTP_GET, uri), ESP_OK);
+    CHECK_STR(shim_httpd.type, "application/octet-stream");
+    CHECK(binApply(shim_httpd.body, got, f));
+  };
+  bin("/screen.bin");
+  CHECK_EQ(f.gen, 1);
+  CHECK_EQ(f.base, 0);
+  CHECK_EQ(f.rows.size(), SCR_H);
+  CHECK(got == fb);
+
+  fb[10 * SCR_W + 5] ^= 1;
+  for (size_t i = 200 * SCR_W; i < 204 * SCR_W; i++)
+    fb[i] = (uint16_t)rng();
+  bin("/screen.bin?since=1");
+  CHECK_EQ(f.gen, 2);
+  CHECK_EQ(f.base, 1);
+  CHECK((f.rows == std::vector<uint16_t>{10, 200, 201, 202, 203}));
+  CHECK(got == fb);
+  const size_t deltaBytes = shim_httpd.body.size();
+
+  bin("/screen.bin?since=2"); // niente di cambiato: solo header e fine
+  CHECK_EQ(f.base, 2);
+  CHECK(f.rows.empty());
+  CHECK_EQ(shim_httpd.body.size(), 18);
+
+  bin("/screen.bin?since=999"); // base sconosciuta
+  CHECK_EQ(f.base, 0);
+  CHECK_EQ(f.rows.size(), SCR_H);
+  CHECK(got == fb);
+
+  // base == gen - SCR_SLOTS: stesso slot, confronto prima della scrittura
+  fb[300 * SCR_W] ^= 0x8000;
+  bin("/screen.bin?since=1"); // gen 5: slot di 1, ancora valida
+  CHECK_EQ(f.gen, 5);
+  CHECK_EQ(f.base, 1);
+  CHECK((f.rows == std::vector<uint16_t>{10, 200, 201, 202, 203, 300}));
+  CHECK(got == fb);
+  bin("/screen.bin?since=1"); // sovrascritta da gen 5
+  CHECK_EQ(f.base, 0);
+  CHECK(got == fb);
+
+  // --- Client chiuso a metà: frame interrotto, la sua gen non è una base ---
+  fill(fb, 2, rng); // rumore: più chunk già nella prima banda
+  shim_ms += SCR_MIN_MS;
+  shim_httpd.failAt = 2;
+  const uint32_t t0 = shim_ms;
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, "/screen.bin"), ESP_FAIL);
+  shim_httpd.failAt = 0;
+  const uint32_t aborted = scr_gen;
+  CHECK_EQ(shim_ms - t0, 1); // fermato alla prima pausa
+  CHECK(!shim_httpd.chunkEnd);
+  shim_ms += SCR_MIN_MS;
+  const std::string since = "/screen.bin?since=" + std::to_string(aborted);
+  bin(since.c_str());
+  CHECK_EQ(f.base, 0);
+  CHECK(got == fb);
+
+  // Una pausa di un tick ogni SCR_BAND righe
+  shim_ms += SCR_MIN_MS;
+  const uint32_t t1 = shim_ms;
+  shimHttpdRequest(HTTP_GET, "/screen.png");
+  CHECK_EQ(shim_ms - t1, SCR_H / SCR_BAND);
+
+  // --- Benchmark: encoder su frame tipici ---
+  {
+    const int reps = tBench() ? 50 : 5;
+    const char *names[] = {"tinta unita", "sfumatura", "rumore", "bande", "UI"};
+    for (int kind = 0; kind < 5; kind++) {
+      fill(fb, kind, rng);
+      NullSink ps, bs;
+      double t = tNowUs();
+      for (int r = 0; r < reps; r++) {
+        ps.n = 0;
+        ScrPng<NullSink> enc(ps);
+        enc.begin(SCR_W, SCR_H);
+        for (uint16_t y = 0; y < SCR_H; y++)
+          enc.row(&fb[(size_t)y * SCR_W]);
+        enc.end();
+      }
+      const double tPng = (tNowUs() - t) / reps;
+      t = tNowUs();
+      for (int r = 0; r < reps; r++) {
+        bs.n = 0;
+        for (uint16_t y = 0; y < SCR_H; y++) {
+          scrRowHash(&fb[(size_t)y * SCR_W]);
+          scrPackRow(bs, &fb[(size_t)y * SCR_W], SCR_W);
+        }
+      }
+      const double tBin = (tNowUs() - t) / reps;
+      printf("  %-11s png %7zu B %6.0f µs | bin %7zu B %6.0f µs\n", names[kind], ps.n, tPng,
+             bs.n + 16 + 2 * SCR_H + 2, tBin);
+    }
+    printf("  delta di 5 righe: %zu B; ScrPng %zu B di stato\n", deltaBytes,
+           sizeof(ScrPng<NullSink>));
+  }
+
+  delete gfx;
+  TEST_END();
+}
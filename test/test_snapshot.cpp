@@ -0,0 +1,356 @@
+// snapshot.h su LittleFS finto: ogni sorgente torna identica dopo un
+// riavvio, byte del file little-endian contro un golden scritto a mano,
+// CRC32, versione, pagina, impostazioni cambiate, età massima e file
+// troncati o allungati rifiutati; scrittura corta o rename fallito
+// lasciano il file vecchio; debounce, riscritture evitate e /clock.bin
+#include "test.h"
+
+#include "handlers/globals.h"
+#include "handlers/icsparser.h"
+
+#include <cmath>
+#include <zlib.h>
+
+// Stato delle pagine come in pages/*.h, che nello sketch precedono snapshot.h
+static float w_now_tempC = NAN;
+static String w_now_desc;
+static String w_desc[3];
+static float aq_val[4];
+static float t24[24];
+static float cr_price = NAN, cr_chg24 = NAN;
+double fx_chf = NAN, fx_eur = NAN, fx_usd = NAN, fx_gbp = NAN, fx_jpy = NAN, fx_cad = NAN,
+       fx_cny = NAN, fx_inr = NAN;
+static const uint8_t NEWS_MAX = 5;
+static String news_title[NEWS_MAX];
+static const uint8_t CAL_MAX = 16;
+static IcsEntry cal[CAL_MAX];
+static uint8_t cal_count = 0;
+static char sun_rise[6], sun_set[6], sun_noon[6], sun_cb[6], sun_ce[6], sun_len[16], sun_uvi[8];
+static float g_moon_illum01 = -1.0f;
+static bool g_moon_waxing = true;
+static uint8_t g_moon_phase_idx = 0;
+static String qod_text, qod_author, qod_date_ymd;
+static bool qod_from_ai = false;
+
+String g_city = "Lugano", g_lang = "it", g_lat = "46.0037", g_lon = "8.9511", g_fiat = "CHF",
+       g_rss_url = "https://example.org/rss", g_ics = "", g_oa_topic = "";
+bool g_timeSynced = false;
+uint32_t g_fetchMs[PAGES];
+
+#include "handlers/snapshot.h"
+
+static const uint8_t SRC[] = {P_WEATHER, P_AIR, P_T24, P_BTC, P_FX,
+                              P_NEWS,    P_CAL, P_SUN, P_QOD};
+
+// Dati di una sessione: valori riconoscibili, stringhe al limite
+static void fillAll() {
+  w_now_tempC = -3.5f;
+  w_now_desc = "Nuvoloso";
+  for (int i = 0; i < 3; i++)
+    w_desc[i] = "Giorno " + String(i);
+  for (int i = 0; i < 4; i++)
+    aq_val[i] = 10.25f * (i + 1);
+  for (int i = 0; i < 24; i++)
+    t24[i] = i - 5.125f;
+  cr_price = 61234.5f;
+  cr_chg24 = -2.25f;
+  fx_chf = 1, fx_eur = 1.0712345678, fx_usd = 1.1, fx_gbp = 0.9, fx_jpy = 170.25,
+  fx_cad = 1.5, fx_cny = 7.75, fx_inr = NAN;
+  for (int i = 0; i < NEWS_MAX; i++)
+    news_title[i] = String(std::string(180 + i, 'a' + i).c_str());
+  cal_count = CAL_MAX;
+  for (int i = 0; i < CAL_MAX; i++) {
+    IcsEntry &e = cal[i];
+    e.start = (time_t)1780000000 + i * 3600;
+    e.end = e.start + (i % 2 ? 86400 : 1800);
+    e.uid = 0xA5000000u + i;
+    e.allDay = i % 2;
+    e.override = i % 3 == 0;
+    memset(e.summary, 'A' + i, sizeof(e.summary) - 1);
+    e.summary[sizeof(e.summary) - 1] = 0;
+  }
+  strcpy(sun_rise, "06:12");
+  strcpy(sun_set, "20:41");
+  strcpy(sun_noon, "13:26");
+  strcpy(sun_cb, "05:40");
+  strcpy(sun_ce, "21:13");
+  strcpy(sun_len, "14h 29m");
+  strcpy(sun_uvi, "7.2");
+  g_moon_illum01 = 0.625f;
+  g_moon_waxing = false;
+  g_moon_phase_idx = 5;
+  qod_text = "Chi va piano va sano e va lontano";
+  qod_author = "Proverbio";
+  qod_date_ymd = "2026-10-19";
+  qod_from_ai = true;
+}
+
+static void clearAll() {
+  w_now_tempC = NAN;
+  w_now_desc = "";
+  for (auto &s : w_desc)
+    s = "";
+  for (auto &v : aq_val)
+    v = 0;
+  for (auto &v : t24)
+    v = 0;
+  cr_price = cr_chg24 = NAN;
+  fx_chf = fx_eur = fx_usd = fx_gbp = fx_jpy = fx_cad = fx_cny = fx_inr = 0;
+  for (auto &s : news_title)
+    s = "";
+  cal_count = 0;
+  memset(cal, 0, sizeof(cal));
+  sun_rise[0] = sun_set[0] = sun_noon[0] = sun_cb[0] = sun_ce[0] = sun_len[0] = sun_uvi[0] = 0;
+  g_moon_illum01 = -1;
+  g_moon_waxing = true;
+  g_moon_phase_idx = 0;
+  qod_text = qod_author = qod_date_ymd = "";
+  qod_from_ai = false;
+}
+
+static bool same(float a, float b) { return !memcmp(&a, &b, 4); }
+static bool same(double a, double b) { return !memcmp(&a, &b, 8); }
+
+// Confronto con fillAll() per la pagina p
+static bool restored(uint8_t p) {
+  switch (p) {
+  case P_WEATHER:
+    return same(w_now_tempC, -3.5f) && w_now_desc == "Nuvoloso" && w_desc[2] == "Giorno 2";
+  case P_AIR:
+    return same(aq_val[0], 10.25f) && same(aq_val[3], 41.0f);
+  case P_T24:
+    return same(t24[0], -5.125f) && same(t24[23], 17.875f);
+  case P_BTC:
+    return same(cr_price, 61234.5f) && same(cr_chg24, -2.25f);
+  case P_FX:
+    return same(fx_eur, 1.0712345678) && same(fx_jpy, 170.25) && std::isnan(fx_inr);
+  case P_NEWS:
+    return news_title[0].length() == 180 && news_title[4] == std::string(184, 'e').c_str();
+  case P_CAL: {
+    bool ok = cal_count == CAL_MAX;
+    for (int i = 0; ok && i < CAL_MAX; i++)
+      ok = cal[i].start == (time_t)1780000000 + i * 3600 && cal[i].uid == 0xA5000000u + i &&
+           cal[i].allDay == (i % 2) && cal[i].override == (i % 3 == 0) &&
+           strlen(cal[i].summary) == ICS_SUMMARY_MAX - 1 && cal[i].summary[0] == 'A' + i;
+    return ok;
+  }
+  case P_SUN:
+    return !strcmp(sun_rise, "06:12") && !strcmp(sun_len, "14h 29m") &&
+           !strcmp(sun_uvi, "7.2") && same(g_moon_illum01, 0.625f) && !g_moon_waxing &&
+           g_moon_phase_idx == 5;
+  case P_QOD:
+    return qod_text == "Chi va piano va sano e va lontano" && qod_author == "Proverbio" &&
+           qod_date_ymd == "2026-10-19" && qod_from_ai;
+  }
+  return false;
+}
+
+// Riavvio: pagine vuote, stato di snapshot.h azzerato, FS montato di nuovo
+static uint8_t reboot() {
+  clearAll();
+  snap_fs = false;
+  snap_dirty = 0;
+  snap_clock = 0;
+  memset(snap_epoch, 0, sizeof(snap_epoch));
+  memset(snap_crc, 0, sizeof(snap_crc));
+  memset(g_fetchMs, 0, sizeof(g_fetchMs));
+  return snapLoadAll();
+}
+
+static uint32_t fnv(uint32_t h, const char *s) {
+  for (; *s; s++)
+    h = (h ^ (uint8_t)*s) * 16777619UL;
+  return (h ^ 0xFF) * 16777619UL;
+}
+
+static void put32(std::string &b, uint32_t v) {
+  for (int k = 0; k < 4; k++)
+    b += (char)(v >> (8 * k));
+}
+
+int main() {
+  shim_ms = 1000;
+  stateLockInit(); // snapWrite() serializza sotto StateLock
+
+  // --- Giro completo: tutte le sorgenti identiche dopo il riavvio ---
+  CHECK_EQ(reboot(), 0);
+  fillAll();
+  for (uint8_t p : SRC)
+    snapMark(p);
+  snapMark(P_CLOCK); // senza snapshot: ignorata
+  shim_ms += SNAP_DEBOUNCE_MS - 1;
+  snapTick();
+  CHECK_EQ(LittleFS.opensW, 0); // ancora nel debounce
+  shim_ms += 1;
+  snapTick();
+  CHECK_EQ(LittleFS.opensW, 9);
+  CHECK_EQ(LittleFS.renames, 9);
+  CHECK(!LittleFS.exists("/snap02.bin"));
+  for (auto &f : LittleFS.files) {
+    CHECK(f.first.find(".tmp") == std::string::npos);
+    CHECK(f.second.size() <= SNAP_HDR + SNAP_BUF);
+  }
+
+  CHECK_EQ(reboot(), 9);
+  for (uint8_t p : SRC)
+    CHECK(restored(p));
+
+  // Dati uguali, ora sconosciuta: nessuna riscrittura
+  LittleFS.opensW = 0;
+  for (uint8_t p : SRC)
+    snapMark(p);
+  snapFlush();
+  CHECK_EQ(LittleFS.opensW, 0);
+  cr_price = 60000;
+  snapMark(P_BTC);
+  snapFlush();
+  CHECK_EQ(LittleFS.opensW, 1);
+  cr_price = 61234.5f;
+  snapMark(P_BTC);
+  snapFlush();
+
+  // --- Golden: /snap05.bin (BTC) byte per byte ---
+  {
+    std::string pay;
+    put32(pay, 0x476F3280); // 61234.5f
+    put32(pay, 0xC0100000); // -2.25f
+    std::string g = "SQSN";
+    g += (char)SNAP_VER;
+    g += (char)P_BTC;
+    g += (char)pay.size();
+    g += (char)0;
+    put32(g, crc32(0, (const Bytef *)pay.data(), pay.size()));
+    put32(g, 0); // epoch sconosciuta
+    put32(g, fnv(2166136261UL, "CHF"));
+    g += pay;
+    CHECK_EQ(g.size(), SNAP_HDR + 8);
+    CHECK(LittleFS.files["/snap05.bin"] == g);
+
+    // golden scritto a mano → caricato
+    LittleFS.files["/snap05.bin"] = g;
+    reboot();
+    CHECK(restored(P_BTC));
+  }
+
+  // --- File rifiutati: lo stato della pagina resta vuoto ---
+  {
+    const std::string good = LittleFS.files["/snap05.bin"];
+    auto rejected = [&](const std::string &bad) {
+      LittleFS.files["/snap05.bin"] = bad;
+      clearAll();
+      CHECK(!snapRead(P_BTC));
+      CHECK(std::isnan(cr_price) && std::isnan(cr_chg24));
+    };
+    std::string b = good;
+    b[4] = SNAP_VER + 1; // versione
+    rejected(b);
+    b = good;
+    b[5] = P_FX; // pagina
+    rejected(b);
+    b = good;
+    b[SNAP_HDR + 3] ^= 0x40; // payload (CRC)
+    rejected(b);
+    b = good;
+    b[8] ^= 1; // CRC
+    rejected(b);
+    b = good;
+    b[6]++; // lunghezza
+    rejected(b);
+    for (size_t n = 0; n < good.size(); n++) // troncato in ogni punto
+      rejected(good.substr(0, n));
+    rejected(good + '\0'); // allungato
+    rejected(std::string(SNAP_HDR + SNAP_BUF + 1, 'x'));
+
+    // impostazioni cambiate: valuta diversa
+    LittleFS.files["/snap05.bin"] = good;
+    g_fiat = "EUR";
+    clearAll();
+    CHECK(!snapRead(P_BTC));
+    g_fiat = "CHF";
+    CHECK(snapRead(P_BTC));
+    CHECK(restored(P_BTC));
+
+    // troppo vecchio, ma solo con l'ora valida
+    const uint32_t now = time(nullptr);
+    b = good;
+    for (int k = 0; k < 4; k++)
+      b[12 + k] = (char)((now - SNAP_MAX_AGE_S - 60) >> (8 * k));
+    LittleFS.files["/snap05.bin"] = b;
+    g_timeSynced = true;
+    clearAll();
+    CHECK(!snapRead(P_BTC));
+    g_timeSynced = false;
+    CHECK(snapRead(P_BTC));
+    LittleFS.files["/snap05.bin"] = good;
+  }
+
+  // --- Scrittura fallita: resta il file vecchio, nessun .tmp ---
+  {
+    const std::string old = LittleFS.files["/snap05.bin"];
+    cr_price = 1;
+    LittleFS.fullAfter = 10; // flash piena a metà intestazione
+    CHECK(!snapWrite(P_BTC));
+    CHECK(LittleFS.files["/snap05.bin"] == old);
+    CHECK(!LittleFS.exists("/snap05.tmp"));
+    LittleFS.failRename = true;
+    CHECK(!snapWrite(P_BTC));
+    CHECK(LittleFS.files["/snap05.bin"] == old);
+    CHECK(!LittleFS.exists("/snap05.tmp"));
+    // interruzione di corrente tra write e rename: .tmp orfano ignorato
+    LittleFS.files["/snap05.tmp"] = "SQSN rotto";
+    CHECK(snapWrite(P_BTC));
+    CHECK(LittleFS.files["/snap05.bin"] != old);
+    CHECK(!LittleFS.exists("/snap05.tmp"));
+    reboot();
+    CHECK(same(cr_price, 1.0f));
+  }
+
+  // --- Ora persistente, età ripristinate ---
+  {
+    LittleFS.files.erase("/clock.bin");
+    g_timeSynced = true;
+    const uint32_t now = time(nullptr);
+    snap_clock = 0;
+    snapTick();
+    CHECK(LittleFS.exists("/clock.bin"));
+    CHECK_EQ(snap_clock, now);
+    const int w0 = LittleFS.opensW;
+    snapTick(); // al più ogni SNAP_CLOCK_S
+    CHECK_EQ(LittleFS.opensW, w0);
+
+    // BTC con epoch di 10 minuti fa: età in g_fetchMs
+    fillAll();
+    snapWrite(P_BTC);
+    std::string &f = LittleFS.files["/snap05.bin"];
+    for (int k = 0; k < 4; k++)
+      f[12 + k] = (char)((now - 600) >> (8 * k));
+    g_timeSynced = false;
+    reboot();
+    CHECK_EQ(snapLastEpoch(), now); // /clock.bin più recente del fetch
+    CHECK_EQ(snap_epoch[P_BTC], now - 600);
+    CHECK_EQ(g_fetchMs[P_BTC], 0); // ora non ancora valida
+    g_timeSynced = true;
+    shim_ms = 5000000;
+    snapRestoreAges();
+    const uint32_t age = shim_ms - g_fetchMs[P_BTC];
+    CHECK(age >= 599999 && age <= 603000); // | 1: 0 vuol dire "mai"
+
+    // complemento sbagliato: ignorato
+    LittleFS.files["/clock.bin"][7] ^= 1;
+    g_timeSynced = false;
+    reboot();
+    CHECK_EQ(snap_clock, 0);
+    CHECK_EQ(snapLastEpoch(), now - 600);
+  }
+
+  // FS non montabile: niente letture né scritture
+  LittleFS.mountOk = false;
+  CHECK_EQ(reboot(), 0);
+  LittleFS.opensW = 0;
+  fillAll();
+  snapMark(P_BTC);
+  snapFlush();
+  CHECK_EQ(LittleFS.opensW, 0);
+
+  TEST_END();
+}
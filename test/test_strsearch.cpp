@@ -0,0 +1,142 @@
+// strsearch.h: ssFind / ssFindCI / StrSearch contro una ricerca ingenua su
+// testi casuali (alfabeti piccoli = molti match parziali), tutti i rami
+// (memchr, SWAR disallineato, Horspool, pattern > 64 e > 255 byte) e
+// throughput contro String::indexOf su un ICS grande
+#include "test.h"
+
+#include "handlers/strsearch.h"
+
+#include <random>
+#include <vector>
+
+static int naive(const std::string &h, const std::string &p, size_t from, bool ci) {
+  if (p.empty())
+    return from <= h.size() ? (int)from : -1;
+  for (size_t i = from; i + p.size() <= h.size(); i++) {
+    size_t k = 0;
+    while (k < p.size() &&
+           (ci ? ssFold((uint8_t)h[i + k]) == ssFold((uint8_t)p[k]) : h[i + k] == p[k]))
+      k++;
+    if (k == p.size())
+      return (int)i;
+  }
+  return -1;
+}
+
+static std::string randomText(std::mt19937 &rng, size_t n, const char *alpha) {
+  const size_t a = strlen(alpha);
+  std::string s(n, ' ');
+  for (auto &c : s)
+    c = alpha[rng() % a];
+  return s;
+}
+
+int main() {
+  std::mt19937 rng(30);
+
+  // --- Confronto con la ricerca ingenua ---
+  {
+    const char *alphas[] = {"ab", "aAbB", "abcdefgh", "EVENTevent:\r\n"};
+    const size_t pats[] = {0, 1, 2, 3, 4, 5, 8, 16, 63, 64, 65, 200, 255, 256, 300};
+    int cases = 0;
+    for (const char *alpha : alphas)
+      for (size_t n : {0, 1, 7, 100, 255, 256, 257, 1000, 4096})
+        for (size_t m : pats) {
+          if (m > n + 1)
+            continue;
+          // buffer con 3 byte davanti: haystack a ogni allineamento
+          std::string buf = "xyz" + randomText(rng, n, alpha);
+          for (int rep = 0; rep < 6; rep++) {
+            const size_t off = rep & 3;
+            const std::string hay = buf.substr(off, n);
+            std::string pat;
+            if (rep < 3 && m <= n) {
+              const size_t at = n ? rng() % (n - m + 1) : 0; // presente
+              pat = hay.substr(at, m);
+              if (rep == 1)
+                for (auto &c : pat) // stesso testo, maiuscole diverse
+                  c = (rng() & 1) ? toupper(c) : c;
+            } else {
+              pat = randomText(rng, m, alpha);
+            }
+            const size_t from = (rep == 2 && n) ? rng() % n : 0;
+            const char *h = buf.data() + off;
+
+            CHECK_EQ(ssFind(h, n, pat.data(), m, from), naive(hay, pat, from, false));
+            CHECK_EQ(ssFindCI(h, n, pat.data(), m, from), naive(hay, pat, from, true));
+
+            StrSearch s(pat.data(), m, false), sci(pat.data(), m, true);
+            CHECK_EQ(s.in(h, n, from), naive(hay, pat, from, false));
+            CHECK_EQ(sci.in(h, n, from), naive(hay, pat, from, true));
+            cases++;
+          }
+        }
+    printf("  %d casi contro la ricerca ingenua\n", cases);
+  }
+
+  // --- Pattern lunghi: mai troncati ---
+  {
+    std::string pat(300, 'a');
+    pat[299] = 'b'; // differisce solo dopo il byte 255
+    std::string hay = std::string(1000, 'a');
+    CHECK_EQ(ssFind(hay.data(), hay.size(), pat.data(), pat.size()), -1);
+    CHECK_EQ(ssFindCI(hay.data(), hay.size(), pat.data(), pat.size()), -1);
+    hay += "b";
+    CHECK_EQ(ssFind(hay.data(), hay.size(), pat.data(), pat.size()), 701);
+
+    pat[70] = 'c'; // differisce dopo SS_MAX_PAT
+    StrSearch s(pat.data(), 71, true);
+    CHECK_EQ(s.in(hay.data(), hay.size()), -1);
+  }
+
+  // --- Riuso in loop (tabella costruita una volta), niente heap ---
+  {
+    std::string ics = "BEGIN:VCALENDAR\r\n";
+    for (int i = 0; i < 500; i++)
+      ics += "BEGIN:VEVENT\r\nDTSTART:20260110T0900" + std::to_string(i % 60) +
+             "Z\r\nSUMMARY:Evento " + std::to_string(i) + "\r\nEND:VEVENT\r\n";
+    const String body(ics.c_str());
+
+    tHeapReset();
+    StrSearch ev("begin:vevent", true);
+    int count = 0;
+    for (int p = 0; (p = ev.in(body.c_str(), body.length(), p)) >= 0; p++)
+      count++;
+    CHECK_EQ(count, 500);
+    CHECK_EQ(tAllocs, 0);
+
+    const int reps = tBench() ? 2000 : 200;
+    const struct {
+      const char *name, *pat;
+      bool ci;
+    } pats[] = {{"END:VCALENDAR", "END:VCALENDAR", false},
+                {"end:vcalendar (CI)", "end:vcalendar", true},
+                {"SUMMARY:Evento 499", "SUMMARY:Evento 499", false},
+                {"Z…Evento 77 (21 B)", "Z\r\nSUMMARY:Evento 77\r", false}};
+    for (const auto &p : pats) {
+      double t0 = tNowUs();
+      int r = 0;
+      for (int i = 0; i < reps; i++)
+        r = p.ci ? ssFindCI(body.c_str(), body.length(), p.pat, strlen(p.pat))
+                 : ssFind(body.c_str(), body.length(), p.pat, strlen(p.pat));
+      const double tNew = (tNowUs() - t0) / reps;
+
+      t0 = tNowUs();
+      int o = 0;
+      for (int i = 0; i < reps; i++) {
+        if (p.ci) {
+          String low = body; // come prima: copia + toLowerCase
+          low.toLowerCase();
+          o = low.indexOf(p.pat);
+        } else {
+          o = body.indexOf(p.pat);
+        }
+      }
+      const double tOld = (tNowUs() - t0) / reps;
+      CHECK_EQ(r, o);
+      printf("  %-20s %zu B: %7.1f µs, indexOf %7.1f µs\n", p.name, ics.size(), tNew, tOld);
+    }
+  }
+
+  TEST_END();
+}
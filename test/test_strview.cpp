@@ -0,0 +1,232 @@
+// strview.h: svFromChars contro strtol/strtod su input casuali, date
+// ISO-8601 (estese, base ICS, offset) contro timegm, metodi della vista,
+// zero allocazioni e confronto con substring().toFloat()
+#include "test.h"
+
+#include "handlers/strview.h"
+
+#include <random>
+
+static int32_t parseInt(const char *s, bool *ok = nullptr, size_t *used = nullptr) {
+  int32_t v = 0;
+  const SvParse r = svFromChars(s, s + strlen(s), v);
+  if (ok)
+    *ok = r.ok;
+  if (used)
+    *used = r.ptr - s;
+  return v;
+}
+
+static double parseDouble(const char *s, bool *ok = nullptr, size_t *used = nullptr) {
+  double v = 0;
+  const SvParse r = svFromChars(s, s + strlen(s), v);
+  if (ok)
+    *ok = r.ok;
+  if (used)
+    *used = r.ptr - s;
+  return v;
+}
+
+static bool iso(const char *s, IsoTime &t) {
+  return svParseIso8601(s, s + strlen(s), t).ok;
+}
+
+static time_t utc(int y, int mo, int d, int h, int mi, int s) {
+  struct tm tt = {};
+  tt.tm_year = y - 1900;
+  tt.tm_mon = mo - 1;
+  tt.tm_mday = d;
+  tt.tm_hour = h;
+  tt.tm_min = mi;
+  tt.tm_sec = s;
+  return timegm(&tt);
+}
+
+int main() {
+  // --- Interi ---
+  {
+    bool ok;
+    size_t used;
+    CHECK_EQ(parseInt("42"), 42);
+    CHECK_EQ(parseInt("-17abc", &ok, &used), -17);
+    CHECK(ok && used == 3);
+    CHECK_EQ(parseInt("+8"), 8);
+    parseInt("-", &ok, &used);
+    CHECK(!ok && used == 0);
+    parseInt("x1", &ok);
+    CHECK(!ok);
+    CHECK_EQ(parseInt("99999999999999999999", &ok, &used), INT32_MAX);
+    CHECK(ok && used == 20); // saturato, cifre consumate comunque
+    CHECK_EQ(parseInt("9999999999"), INT32_MAX);
+    CHECK_EQ(parseInt("-2147483648"), INT32_MIN);
+    CHECK_EQ(parseInt("-2147483649"), INT32_MIN);
+    CHECK_EQ(parseInt("2147483647"), INT32_MAX);
+
+    std::mt19937 rng(29);
+    for (int i = 0; i < 20000; i++) {
+      const int32_t v = (int32_t)rng() / (1 << (rng() % 31));
+      char b[16];
+      snprintf(b, sizeof(b), "%d", v);
+      CHECK_EQ(parseInt(b), strtol(b, nullptr, 10));
+    }
+  }
+
+  // --- Decimali: come strtod per i numeri delle API (≤ 15 cifre) ---
+  {
+    bool ok;
+    size_t used;
+    CHECK(parseDouble("1.07") == 1.07);
+    CHECK(parseDouble("-0.5,") == -0.5);
+    CHECK(parseDouble("-1.5e2", &ok, &used) == -150 && used == 6);
+    CHECK(parseDouble("3e", &ok, &used) == 3 && used == 1); // esponente vuoto
+    CHECK(parseDouble(".25") == 0.25);
+    CHECK(parseDouble("7.") == 7);
+    parseDouble(".", &ok);
+    CHECK(!ok);
+    parseDouble("null", &ok);
+    CHECK(!ok);
+    CHECK(parseDouble("0.000000000000000000001234") == 1.234e-21);
+    CHECK(parseDouble("12345678901234567890123") > 1.2345678901e22);
+
+    std::mt19937 rng(290);
+    int worst = 0;
+    for (int i = 0; i < 50000; i++) {
+      const int dec = rng() % 7;
+      const double v = ((int64_t)rng() - 0x7fffffff) / pow(10.0, rng() % 9);
+      char b[48];
+      snprintf(b, sizeof(b), "%.*f", dec, v);
+      const double want = strtod(b, nullptr), got = parseDouble(b);
+      const double ulp = fabs(want) * 2.3e-16;
+      CHECK(fabs(got - want) <= ulp);
+      if (got != want)
+        worst++;
+    }
+    printf("  decimali casuali: %d/50000 diversi da strtod (entro 1 ulp)\n", worst);
+
+    float f = 0;
+    const char *s = "22.1}";
+    CHECK(svFromChars(s, s + 5, f).ptr == s + 4 && f == 22.1f);
+  }
+
+  // --- ISO-8601 ---
+  {
+    IsoTime t;
+    CHECK(iso("2026-01-10T09:30:15Z", t) && t.hasTime && t.hasOffset);
+    CHECK_EQ(isoToUtcEpoch(t), utc(2026, 1, 10, 9, 30, 15));
+
+    CHECK(iso("2026-01-10T09:30+02:00", t) && t.offMin == 120);
+    CHECK_EQ(isoToUtcEpoch(t), utc(2026, 1, 10, 7, 30, 0));
+    CHECK(iso("2026-01-10T09:30:00.123-0530", t) && t.offMin == -330);
+    CHECK_EQ(isoToUtcEpoch(t), utc(2026, 1, 10, 15, 0, 0));
+
+    CHECK(iso("20260110T093015Z", t)); // ICS
+    CHECK_EQ(isoToUtcEpoch(t), utc(2026, 1, 10, 9, 30, 15));
+    CHECK(iso("20260110", t) && !t.hasTime && !t.hasOffset);
+    CHECK(iso("2026-03-29 02:30", t) && t.hasTime && t.hour == 2);
+
+    for (const char *bad : {"", "2026", "2026-1-10", "2026-13-01", "2026-01-00",
+                            "2026-01-32", "26-01-10", "2026-01", "abcd-ef-gh"})
+      CHECK(!iso(bad, t));
+
+    // Tronco a ogni lunghezza: mai letture oltre last
+    const char *full = "2026-01-10T09:30:15.5+01:00";
+    for (size_t n = 0; n <= strlen(full); n++) {
+      char *b = (char *)malloc(n ? n : 1); // dimensione esatta
+      memcpy(b, full, n);
+      svParseIso8601(b, b + n, t);
+      free(b);
+    }
+
+    // Epoch contro timegm su date casuali 1970..2100
+    std::mt19937 rng(8601);
+    for (int i = 0; i < 20000; i++) {
+      const time_t e = rng() % 4102444800u;
+      struct tm g;
+      gmtime_r(&e, &g);
+      char b[32];
+      strftime(b, sizeof(b), i & 1 ? "%Y%m%dT%H%M%SZ" : "%Y-%m-%dT%H:%M:%SZ", &g);
+      CHECK(iso(b, t) && isoToUtcEpoch(t) == e);
+    }
+
+    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
+    tzset();
+    CHECK(iso("2026-07-01T12:00", t));
+    CHECK_EQ(isoEpoch(t), utc(2026, 7, 1, 10, 0, 0));
+    CHECK(iso("2026-07-01T12:00Z", t));
+    CHECK_EQ(isoEpoch(t), utc(2026, 7, 1, 12, 0, 0));
+  }
+
+  // --- Vista ---
+  {
+    const String body = "  BEGIN:VEVENT\r\nDTSTART;TZID=Europe/Rome:20260110T090000  ";
+    const StrView v(body);
+    CHECK_EQ(v.find(':'), 7);
+    CHECK_EQ(v.find("VEVENT"), 8);
+    CHECK_EQ(v.findCI("dtstart"), 16);
+    CHECK_EQ(v.find('#'), -1);
+    CHECK_EQ(v.find(':', 1000), -1);
+    CHECK(v.trim().startsWith("BEGIN"));
+    CHECK(v.sub(2, 5).equalsCI("begin"));
+    CHECK(!v.sub(2, 5).equals("begin"));
+    CHECK_EQ(v.sub(1000).size(), 0);
+    CHECK_EQ(v.sub(v.size() - 2, 99).size(), 2);
+    char b[6];
+    CHECK_EQ(v.trim().copyTo(b, sizeof(b)), 5);
+    CHECK_STR(b, "BEGIN");
+    CHECK_EQ(StrView().copyTo(b, 0), 0);
+  }
+
+  // --- Zero allocazioni, confronto con substring().toFloat() ---
+  {
+    std::string arr = "[";
+    for (int i = 0; i < 168; i++) // temperature_2m di una settimana
+      arr += std::to_string(-5 + (i * 13) % 37) + "." + std::to_string(i % 10) + ",";
+    arr.back() = ']';
+    const String body(arr.c_str());
+    const int reps = tBench() ? 20000 : 2000;
+
+    float sum = 0;
+    tHeapReset();
+    size_t s0 = shim_strings;
+    double t0 = tNowUs();
+    for (int r = 0; r < reps; r++) {
+      const StrView v(body);
+      const char *p = v.begin() + 1, *e = v.end();
+      while (p < e) {
+        float f = 0;
+        const SvParse k = svFromChars(p, e, f);
+        if (!k.ok)
+          break;
+        sum += f;
+        p = k.ptr + 1;
+      }
+      IsoTime t;
+      svParseIso8601(StrView("2026-01-10T09:00"), t);
+    }
+    const double tNew = (tNowUs() - t0) / reps;
+    CHECK_EQ(tAllocs, 0);
+    CHECK_EQ(shim_strings - s0, 0);
+
+    float sumOld = 0;
+    s0 = shim_strings;
+    t0 = tNowUs();
+    for (int r = 0; r < reps; r++) {
+      int a = 1;
+      while (a < (int)body.length()) {
+        int c = body.indexOf(',', a);
+        if (c < 0)
+          c = body.indexOf(']', a);
+        sumOld += body.substring(a, c).toFloat();
+        a = c + 1;
+      }
+      body.substring(0, 4).toInt(); // come il vecchio isoToEpoch, per campo
+    }
+    const double tOld = (tNowUs() - t0) / reps;
+    const size_t sOld = (shim_strings - s0) / reps;
+    CHECK(fabs(sum - sumOld) <= fabs(sum) * 1e-5);
+    printf("  168 float + 1 data: svFromChars %.2f µs / 0 String, substring %.2f µs / %zu String\n",
+           tNew, tOld, sOld);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,309 @@
+// touchinput.h: tracce del GT911 in fixtures/touch/ rigiocate nel task
+// touch vero (polling, rotazione, debounce sui timestamp) → eventi in
+// coda → gesti decisi dal touchLoop() vero di touch_menu.h: rimbalzi,
+// swipe, doppio tap, trascinamenti; letture I²C a riposo; coda SPSC piena
+// e sotto stress con due thread
+#include "test.h"
+
+// layers.h viene dopo displayhelpers.h nello sketch
+int adjacentEnabledPage(int p, int dir);
+
+#include "handlers/nvconfig.h"
+#include "handlers/touch_menu.h"
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// SKETCH (globali di SquaredCoso.ino usate da touch_menu.h)
+// ============================================================================
+static std::vector<uint16_t> fb(480 * 480);
+static SqRGBDisplay display(fb.data());
+Arduino_RGB_Display *gfx = &display;
+
+Preferences prefs;
+String g_fiat, g_city, g_lang = "it", g_ics, g_lat, g_lon, g_rss_url, g_oa_key, g_oa_topic,
+    g_note, g_ha_ip, g_ha_token, g_ha_ents;
+CDEvent cd[8];
+double g_btc_owned = NAN;
+bool g_splash_enabled = true;
+uint32_t PAGE_INTERVAL_MS = 15000;
+NightCfg g_night = {false, 23, 7, 20, 30};
+bool g_show[PAGES];
+bool g_timeSynced = false;
+int g_page = 0;
+uint32_t lastPageSwitch = 0;
+const uint16_t COL_BG = 0x1B70;
+const uint16_t COL_ACCENT2 = 0xFD20;
+
+uint32_t pagesMaskFromArray() { return 0; }
+void pagesArrayFromMask(uint32_t) {}
+int adjacentEnabledPage(int p, int) { return p; }
+void drawCurrentPage() {}
+void softReboot() {}
+
+// Gesti riconosciuti da touchLoop(): swipeToPage() e apertura del menu
+static std::string gest;
+void swipeToPage(int8_t dir) { gest += dir > 0 ? "next " : "prev "; }
+
+struct Sample {
+  uint32_t ms;
+  uint8_t touches;
+  uint16_t x, y;
+};
+
+static std::vector<Sample> loadTrace(const char *name) {
+  std::vector<Sample> v;
+  std::istringstream in(tReadFile((std::string("fixtures/touch/") + name).c_str()));
+  std::string ln;
+  while (std::getline(in, ln)) {
+    if (ln.empty() || ln[0] == '#')
+      continue;
+    unsigned ms, t, x, y;
+    if (sscanf(ln.c_str(), "%u,%u,%u,%u", &ms, &t, &x, &y) == 4)
+      v.push_back({ms, (uint8_t)t, (uint16_t)x, (uint16_t)y});
+  }
+  return v;
+}
+
+struct TraceEnd {};
+
+// Stato del pannello all'istante ms
+static Sample sampleAt(const std::vector<Sample> &tr, uint32_t ms) {
+  Sample cur{ms, 0, 0, 0};
+  for (const Sample &s : tr)
+    if (s.ms <= ms)
+      cur = s;
+  return cur;
+}
+
+// Traccia nel task touch: ogni ts.read() vede lo stato del pannello
+// all'istante corrente e il loop svuota la coda tra una lettura e l'altra;
+// finita la traccia (+ 500 ms a vuoto) il task viene interrotto
+static std::vector<TouchEv> replay(const std::vector<Sample> &tr, uint32_t *reads = nullptr) {
+  touch_trk = TouchTracker(&touch_q);
+  TouchEv e;
+  while (touch_q.pop(e)) {
+  }
+  touch_q.dropped = 0;
+  touch_reads = 0;
+  shim_ms = 0;
+  std::vector<TouchEv> out;
+  const uint32_t end = tr.empty() ? 0 : tr.back().ms + 500;
+  shim_gt911_read = [&](TAMC_GT911 &g) {
+    while (touchPop(e))
+      out.push_back(e);
+    if (shim_ms > end)
+      throw TraceEnd();
+    const Sample s = sampleAt(tr, shim_ms);
+    g.touches = s.touches;
+    g.points[0].x = s.x;
+    g.points[0].y = s.y;
+  };
+  try {
+    touchTask(nullptr);
+  } catch (const TraceEnd &) {
+  }
+  shim_gt911_read = nullptr;
+  if (reads)
+    *reads = touch_reads;
+  while (touchPop(e))
+    out.push_back(e);
+  return out;
+}
+
+// Eventi nella coda del loop uno alla volta, touchLoop() dopo ognuno: un
+// tap a menu chiuso apre il menu, che qui si richiude subito
+static std::string gestures(const std::vector<TouchEv> &ev) {
+  gest.clear();
+  touchReady = true;
+  for (const TouchEv &e : ev) {
+    touch_q.push(e);
+    touchLoop();
+    if (menuActive) {
+      gest += "tap ";
+      menuActive = touchPaused = false;
+    }
+  }
+  return gest;
+}
+
+static std::string types(const std::vector<TouchEv> &ev) {
+  std::string s;
+  for (const TouchEv &e : ev)
+    s += "DMU"[e.type];
+  return s;
+}
+
+// Eventi ben formati: DOWN (MOVE)* UP, timestamp non decrescenti
+static bool wellFormed(const std::vector<TouchEv> &ev) {
+  bool down = false;
+  uint32_t last = 0;
+  for (const TouchEv &e : ev) {
+    if (e.ms < last || (e.type == TE_DOWN) == down)
+      return false;
+    down = e.type != TE_UP;
+    last = e.ms;
+  }
+  return !down;
+}
+
+int main() {
+  // --- Tracce registrate ---
+  const struct {
+    const char *file, *gestures;
+  } T[] = {
+      {"tap_bounce.csv", "tap "},   {"release_bounce.csv", "tap "},
+      {"swipe_left.csv", "next "},  {"swipe_right.csv", "prev "},
+      {"double_tap.csv", "tap tap "}, {"drag_slow.csv", ""},
+      {"vertical.csv", ""},         {"jitter.csv", "tap "},
+  };
+  for (const auto &t : T) {
+    const auto tr = loadTrace(t.file);
+    CHECK(!tr.empty());
+    const auto ev = replay(tr);
+    CHECK(wellFormed(ev));
+    const std::string g = gestures(ev);
+    if (g != t.gestures)
+      fprintf(stderr, "%s: gesti \"%s\", eventi %s\n", t.file, g.c_str(), types(ev).c_str());
+    CHECK(g == t.gestures);
+    CHECK_EQ(touch_q.dropped, 0);
+  }
+
+  // Menu aperto: lo swipe non cambia pagina
+  {
+    const auto ev = replay(loadTrace("swipe_left.csv"));
+    gest.clear();
+    menuActive = true;
+    for (const TouchEv &e : ev) {
+      touch_q.push(e);
+      touchLoop();
+    }
+    menuActive = touchPaused = false;
+    CHECK_STR(gest, "");
+  }
+
+  // Dettagli: un tocco solo nei rimbalzi, nessun MOVE col dito fermo
+  CHECK_STR(types(replay(loadTrace("tap_bounce.csv"))), "DU");
+  CHECK_STR(types(replay(loadTrace("release_bounce.csv"))), "DU");
+  CHECK_STR(types(replay(loadTrace("jitter.csv"))), "DU");
+  {
+    // UP col timestamp del distacco, non del campione che lo conferma
+    const auto ev = replay(loadTrace("double_tap.csv"));
+    CHECK_STR(types(ev), "DUDU");
+    if (ev.size() == 4) {
+      CHECK(ev[1].ms >= 180 && ev[1].ms < 190);
+      CHECK(ev[2].ms >= 300 && ev[2].ms < 310);
+      CHECK(ev[3].ms >= 370 && ev[3].ms < 380);
+    }
+    // rotazione del pannello: (x, y) schermo = (gt.y, 480 - gt.x)
+    const auto tr = loadTrace("swipe_left.csv");
+    const auto sw = replay(tr);
+    CHECK(sw.size() > 10);
+    CHECK_EQ(touch_q.dropped, 0);
+    for (const TouchEv &e : sw) {
+      if (e.type == TE_UP)
+        continue;
+      const Sample s = sampleAt(tr, e.ms);
+      CHECK_EQ(e.x, s.y);
+      CHECK_EQ(e.y, 480 - s.x);
+    }
+    if (!sw.empty())
+      CHECK(sw.back().x <= 125 && sw.back().y >= 248);
+  }
+
+  // --- Letture I²C: 25/s a riposo (TOUCH_POLL_IDLE_MS), 100/s col dito ---
+  {
+    uint32_t reads = 0;
+    replay({{10000, 0, 0, 0}}, &reads);
+    CHECK(reads >= 10500 / TOUCH_POLL_IDLE_MS - 1 && reads <= 10500 / TOUCH_POLL_IDLE_MS + 1);
+    replay({{0, 1, 100, 100}, {2000, 0, 0, 0}}, &reads);
+    CHECK(reads >= 2000 / TOUCH_POLL_DOWN_MS && reads <= 2000 / TOUCH_POLL_DOWN_MS + 15);
+
+    // UP in sospeso: campioni ancora fitti, nessun rimbalzo più breve di
+    // TOUCH_BOUNCE_MS meno un periodo di polling sfugge
+    for (uint32_t gap = 1; gap < TOUCH_BOUNCE_MS - TOUCH_POLL_DOWN_MS; gap += 3) {
+      const auto ev = replay({{0, 1, 100, 100}, {200, 0, 0, 0}, {200 + gap, 1, 100, 100},
+                              {400, 0, 0, 0}});
+      CHECK_STR(types(ev), "DU");
+    }
+  }
+
+  // --- Tracker a mano: tocco nuovo dopo il debounce in un solo campione ---
+  {
+    TouchQueue q;
+    TouchTracker t(&q);
+    t.feed(0, 1, 10, 10);
+    t.feed(10, 0, 0, 0);
+    CHECK(t.pending());
+    t.feed(10 + TOUCH_BOUNCE_MS, 1, 300, 300); // distacco lungo: UP + DOWN
+    TouchEv e;
+    CHECK(q.pop(e) && e.type == TE_DOWN);
+    CHECK(q.pop(e) && e.type == TE_UP && e.ms == 10 && e.x == 10);
+    CHECK(q.pop(e) && e.type == TE_DOWN && e.x == 300);
+    t.feed(100, 1, 302, 298); // sotto TOUCH_MOVE_PX
+    CHECK(!q.pop(e));
+    t.feed(110, 1, 303, 300);
+    CHECK(q.pop(e) && e.type == TE_MOVE && e.x == 303);
+    t.feed(120, 0, 0, 0);
+    t.feed(120 + TOUCH_BOUNCE_MS - 1, 0, 0, 0); // ancora nel debounce
+    CHECK(!q.pop(e));
+    t.feed(120 + TOUCH_BOUNCE_MS, 0, 0, 0);
+    CHECK(q.pop(e) && e.type == TE_UP && e.ms == 120);
+    t.feed(1000, 0, 0, 0); // a riposo: niente
+    CHECK(!q.pop(e) && !t.pending());
+  }
+
+  // --- Coda piena: i più recenti scartati e contati, ordine conservato ---
+  {
+    TouchQueue q;
+    for (uint32_t i = 0; i < 600; i++) {
+      // head e tail uint8_t girano più volte
+      for (uint32_t k = 0; k < 40; k++)
+        q.push({i * 40 + k, 0, 0, TE_MOVE});
+      TouchEv e;
+      for (uint32_t k = 0; k < TOUCH_QUEUE; k++)
+        CHECK(q.pop(e) && e.ms == i * 40 + k);
+      CHECK(!q.pop(e));
+    }
+    CHECK_EQ(q.dropped, 600 * (40 - TOUCH_QUEUE));
+  }
+
+  // --- SPSC: producer e consumer su due thread ---
+  // il producer ritenta a coda piena: tutto consegnato, in ordine, senza
+  // slot letti a metà; ogni push rifiutato conta in dropped (uint16_t)
+  {
+    static TouchQueue q;
+    const uint32_t N = 200000;
+    std::vector<TouchEv> got;
+    got.reserve(N);
+    std::thread cons([&] {
+      TouchEv e;
+      while (got.size() < N)
+        if (q.pop(e))
+          got.push_back(e);
+        else
+          std::this_thread::yield();
+    });
+    uint64_t full = 0;
+    for (uint32_t i = 0; i < N; i++)
+      while (!q.push({i, (int16_t)i, (int16_t)~i, TE_MOVE})) {
+        full++;
+        std::this_thread::yield();
+      }
+    cons.join();
+    CHECK_EQ(got.size(), N);
+    bool ok = true;
+    for (uint32_t i = 0; i < got.size(); i++)
+      ok &= got[i].ms == i && got[i].x == (int16_t)i && got[i].y == (int16_t)~i;
+    CHECK(ok);
+    CHECK_EQ(q.dropped, (uint16_t)full);
+    TouchEv e;
+    CHECK(!q.pop(e));
+    printf("  SPSC: %u eventi consegnati in ordine, %llu push a coda piena\n", N,
+           (unsigned long long)full);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,221 @@
+// translit.h: tutti i code point U+0000..U+10FFFF, sequenze non valide
+// (overlong, surrogati, continuazioni orfane, troncate), fuzz a byte
+// casuali, in place contro buffer separato, troncamento a cap esatto e
+// confronto col vecchio sanitizeText (solo accenti 0xC3 + replace ripetuti)
+#include "test.h"
+
+#include "handlers/translit.h"
+
+#include <random>
+#include <vector>
+
+static size_t utf8(uint32_t cp, char *b) {
+  if (cp < 0x80) {
+    b[0] = cp;
+    return 1;
+  }
+  if (cp < 0x800) {
+    b[0] = 0xC0 | cp >> 6;
+    b[1] = 0x80 | (cp & 0x3F);
+    return 2;
+  }
+  if (cp < 0x10000) {
+    b[0] = 0xE0 | cp >> 12;
+    b[1] = 0x80 | ((cp >> 6) & 0x3F);
+    b[2] = 0x80 | (cp & 0x3F);
+    return 3;
+  }
+  b[0] = 0xF0 | cp >> 18;
+  b[1] = 0x80 | ((cp >> 12) & 0x3F);
+  b[2] = 0x80 | ((cp >> 6) & 0x3F);
+  b[3] = 0x80 | (cp & 0x3F);
+  return 4;
+}
+
+// sanitizeText come era prima di translit.h: riferimento per il benchmark
+static String legacySanitize(const String &in) {
+  String out;
+  for (unsigned i = 0; i < in.length();) {
+    const uint8_t c = (uint8_t)in[i];
+    if (c < 0x80) {
+      out += (char)c;
+      i++;
+      continue;
+    }
+    if (c == 0xC3 && i + 1 < in.length()) {
+      switch ((uint8_t)in[i + 1]) {
+      case 0xA0: case 0xA1: out += 'a'; break;
+      case 0xA8: case 0xA9: out += 'e'; break;
+      case 0xAC: case 0xAD: out += 'i'; break;
+      case 0xB2: case 0xB3: out += 'o'; break;
+      case 0xB9: case 0xBA: out += 'u'; break;
+      default: out += '?';
+      }
+      i += 2;
+      continue;
+    }
+    out += '?';
+    i++;
+  }
+  while (out.indexOf("  ") >= 0)
+    out.replace("  ", " ");
+  out.trim();
+  return out;
+}
+
+static std::string conv(const std::string &in) {
+  std::vector<char> out(in.size() + 1);
+  tlToAscii(in.data(), in.size(), out.data(), out.size());
+  return out.data();
+}
+
+// Solo ASCII stampabile, spazi singoli, niente spazi ai bordi
+static bool clean(const char *s, size_t n) {
+  if (n && (s[0] == ' ' || s[n - 1] == ' '))
+    return false;
+  for (size_t i = 0; i < n; i++) {
+    if ((uint8_t)s[i] < 0x20 || (uint8_t)s[i] > 0x7E)
+      return false;
+    if (s[i] == ' ' && i && s[i - 1] == ' ')
+      return false;
+  }
+  return true;
+}
+
+int main() {
+  // --- Ogni code point, da solo e tra due lettere, in place ---
+  {
+    size_t mapped = 0, unknown = 0, dropped = 0;
+    for (uint32_t cp = 0; cp <= 0x10FFFF; cp++) {
+      if (cp >= 0xD800 && cp <= 0xDFFF)
+        continue;
+      char in[8], out[8];
+      const size_t n = utf8(cp, in);
+
+      const size_t k = tlToAscii(in, n, out, sizeof(out));
+      CHECK(k <= n);
+      CHECK(clean(out, k));
+
+      char ref[4];
+      tlMap(cp, ref);
+      if (!ref[0] || !strcmp(ref, " "))
+        dropped++;
+      else if (!strcmp(ref, "?"))
+        unknown++;
+      else
+        mapped++;
+      if (ref[0] != ' ')
+        CHECK(!strcmp(out, ref));
+
+      // "x" + cp + "y" in place: stesso risultato del buffer separato
+      if (!cp)
+        continue; // NUL chiude la stringa C di tlInPlace
+      char buf[8] = "x";
+      memcpy(buf + 1, in, n);
+      buf[n + 1] = 'y';
+      buf[n + 2] = 0;
+      std::string sep = conv(buf);
+      const size_t kk = tlInPlace(buf);
+      CHECK_EQ(kk, sep.size());
+      CHECK(sep == buf);
+      CHECK(kk <= n + 2);
+      CHECK(clean(buf, kk));
+      if (!strcmp(ref, " ")) // spazio Unicode: separatore unico
+        CHECK(!strcmp(buf, "x y"));
+      else if (!ref[0])
+        CHECK(!strcmp(buf, "xy"));
+    }
+    printf("  %zu code point: %zu traslitterati, %zu '?', %zu spazi/scartati\n",
+           mapped + unknown + dropped, mapped, unknown, dropped);
+    CHECK_EQ(mapped + unknown + dropped, 0x110000 - 0x800);
+  }
+
+  // --- Sequenze non valide: un '?' per byte non consumabile ---
+  {
+    const struct {
+      const char *in, *out;
+    } bad[] = {
+        {"\xC0\x80", "??"},                 // overlong di NUL
+        {"\xC1\xBF", "??"},                 // overlong 2 byte
+        {"\xE0\x80\xAF", "???"},            // overlong 3 byte
+        {"\xF0\x80\x80\xAF", "????"},       // overlong 4 byte
+        {"\xED\xA0\x80", "???"},            // surrogato alto
+        {"\xED\xBF\xBF", "???"},            // surrogato basso
+        {"\xF4\x90\x80\x80", "????"},       // oltre U+10FFFF
+        {"\xF8\x88\x80\x80\x80", "?????"},  // 5 byte
+        {"\xFF\xFE", "??"},                 // mai validi
+        {"\x80", "?"},                      // continuazione orfana
+        {"a\xC3", "a?"},                    // troncata in coda
+        {"a\xE2\x82", "a??"},               // troncata in coda
+        {"\xC3" "a", "?a"},                 // continuazione mancante
+        {"\xE2\x82" "a\xE2\x82\xAC", "??aEUR"},
+        {"Perch\xC3\xA9 \xC3\xA8 cos\xC3\xAC", "Perche e cosi"},
+        {"\xE2\x82\xAC 5 \xE2\x80\x94 \xE2\x80\x9Cok\xE2\x80\x9D", "EUR 5 - \"ok\""},
+        {"  \t\xC2\xA0 a \r\n\xE2\x80\x83 b\xE2\x80\x8B" "c  ", "a bc"},
+        {"\xEF\xBB\xBFtitolo", "titolo"},   // BOM
+        {"\xF0\x9F\x98\x80!", "?!"},
+    };
+    for (const auto &b : bad) {
+      CHECK_STR(conv(b.in), b.out);
+      CHECK(conv(b.in).size() <= strlen(b.in));
+    }
+  }
+
+  // --- Fuzz: byte casuali, in place == separato, uscita ≤ ingresso ---
+  {
+    std::mt19937 rng(35);
+    const uint8_t pool[] = {'a', ' ', '\t', 0xC3, 0xA8, 0xE2, 0x80, 0x82, 0xAC,
+                            0xF0, 0x9F, 0x98, 0xED, 0xA0, 0xC0, 0xFF, 0xC2, 0xA0};
+    for (int i = 0; i < 200000; i++) {
+      std::string s;
+      for (int k = rng() % 24; k; k--)
+        s += (char)((rng() & 1) ? pool[rng() % sizeof(pool)] : 1 + rng() % 255);
+
+      const std::string ref = conv(s);
+      CHECK(ref.size() <= s.size());
+      CHECK(clean(ref.data(), ref.size()));
+
+      std::vector<char> inplace(s.begin(), s.end());
+      inplace.push_back(0);
+      tlToAscii(inplace.data(), s.size(), inplace.data(), inplace.size());
+      CHECK(ref == inplace.data());
+
+      // cap esatto (buffer della dimensione giusta): prefisso, terminato
+      const size_t cap = rng() % (ref.size() + 2);
+      if (cap) {
+        char *o = (char *)malloc(cap);
+        const size_t k = tlToAscii(s.data(), s.size(), o, cap);
+        CHECK(k < cap && o[k] == 0);
+        CHECK(!ref.compare(0, k, o));
+        free(o);
+      }
+    }
+  }
+
+  // --- Benchmark: titolo di news e paragrafo con spazi ripetuti ---
+  {
+    std::string title = "Citt\xC3\xA0 \xE2\x80\x94 \xE2\x80\x9CPerch\xC3\xA9 "
+                        "cos\xC3\xAC?\xE2\x80\x9D: l\xE2\x80\x99" "economia cresce "
+                        "dell\xE2\x80\x99" "1,2 % \xE2\x82\xAC";
+    std::string para;
+    for (int i = 0; i < 20; i++)
+      para += title + "          \r\n\t  ";
+    const int reps = tBench() ? 20000 : 2000;
+    for (const std::string *src : {&title, &para}) {
+      const String in(src->c_str());
+      std::vector<char> out(src->size() + 1);
+      double t0 = tNowUs();
+      for (int r = 0; r < reps; r++)
+        tlToAscii(in.c_str(), in.length(), out.data(), out.size());
+      const double tNew = (tNowUs() - t0) / reps;
+      t0 = tNowUs();
+      for (int r = 0; r < reps; r++)
+        legacySanitize(in);
+      const double tOld = (tNowUs() - t0) / reps;
+      printf("  %4zu B: tlToAscii %6.2f µs, vecchio sanitizeText %7.2f µs\n",
+             src->size(), tNew, tOld);
+    }
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,280 @@
+// webassets.h + asyncweb.h: i byte gzip in PROGMEM ridanno web/*.css|js
+// minificati come tools/gen_webassets.py, l'hash nell'URL è quello del
+// contenuto, e le risposte (asset senza lock, pagine con lock bufferizzate)
+// hanno gli header giusti e non toccano il socket con StateLock preso;
+// pagina lunga raccolta sotto lock contro unlock(): primo byte e heap
+#include "test.h"
+
+#include "handlers/asyncweb.h"
+#include "handlers/htmlwriter.h"
+#include "handlers/webassets.h"
+
+#include <regex>
+#include <zlib.h>
+
+// ---------------------------------------------------------------------------
+// SHA-256 (solo per l'hash degli URL)
+// ---------------------------------------------------------------------------
+static std::string sha256hex(const std::string &msg) {
+  static const uint32_t K[64] = {
+      0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4,
+      0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe,
+      0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f,
+      0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+      0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc,
+      0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+      0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116,
+      0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+      0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7,
+      0xc67178f2};
+  uint32_t h[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                   0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+  auto rotr = [](uint32_t x, int n) { return (x >> n) | (x << (32 - n)); };
+
+  std::string m = msg;
+  const uint64_t bits = (uint64_t)msg.size() * 8;
+  m += (char)0x80;
+  while (m.size() % 64 != 56)
+    m += (char)0;
+  for (int i = 7; i >= 0; i--)
+    m += (char)(bits >> (i * 8));
+
+  for (size_t off = 0; off < m.size(); off += 64) {
+    uint32_t w[64];
+    for (int i = 0; i < 16; i++)
+      w[i] = (uint8_t)m[off + i * 4] << 24 | (uint8_t)m[off + i * 4 + 1] << 16 |
+             (uint8_t)m[off + i * 4 + 2] << 8 | (uint8_t)m[off + i * 4 + 3];
+    for (int i = 16; i < 64; i++) {
+      const uint32_t s0 = rotr(w[i - 15], 7) ^ rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+      const uint32_t s1 = rotr(w[i - 2], 17) ^ rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+    uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4], f = h[5], g = h[6], k = h[7];
+    for (int i = 0; i < 64; i++) {
+      const uint32_t t1 = k + (rotr(e, 6) ^ rotr(e, 11) ^ rotr(e, 25)) + ((e & f) ^ (~e & g)) +
+                          K[i] + w[i];
+      const uint32_t t2 = (rotr(a, 2) ^ rotr(a, 13) ^ rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+      k = g, g = f, f = e, e = d + t1, d = c, c = b, b = a, a = t1 + t2;
+    }
+    h[0] += a, h[1] += b, h[2] += c, h[3] += d, h[4] += e, h[5] += f, h[6] += g, h[7] += k;
+  }
+  char hex[65];
+  for (int i = 0; i < 8; i++)
+    snprintf(hex + i * 8, 9, "%08x", h[i]);
+  return hex;
+}
+
+// ---------------------------------------------------------------------------
+// Stessa minificazione di tools/gen_webassets.py
+// ---------------------------------------------------------------------------
+static std::string minifyCss(std::string s) {
+  s = std::regex_replace(s, std::regex(R"(/\*[\s\S]*?\*/)"), "");
+  s = std::regex_replace(s, std::regex(R"(\s+)"), " ");
+  s = std::regex_replace(s, std::regex(R"(\s*([{};:,>])\s*)"), "$1");
+  for (size_t p; (p = s.find(";}")) != std::string::npos;)
+    s.replace(p, 2, "}");
+  const size_t a = s.find_first_not_of(' '), b = s.find_last_not_of(' ');
+  return a == std::string::npos ? "" : s.substr(a, b - a + 1);
+}
+
+static std::string minifyJs(const std::string &s) {
+  std::string out, ln;
+  for (size_t i = 0; i <= s.size(); i++) {
+    if (i < s.size() && s[i] != '\n' && s[i] != '\r') {
+      ln += s[i];
+      continue;
+    }
+    const size_t a = ln.find_first_not_of(" \t\f\v"), b = ln.find_last_not_of(" \t\f\v");
+    if (a != std::string::npos && ln.compare(a, 2, "//")) {
+      if (!out.empty())
+        out += '\n';
+      out += ln.substr(a, b - a + 1);
+    }
+    ln.clear();
+  }
+  return out;
+}
+
+static bool gunzip(const uint8_t *d, size_t n, std::string &out) {
+  z_stream z{};
+  if (inflateInit2(&z, 16 + 15) != Z_OK)
+    return false;
+  z.next_in = (Bytef *)d;
+  z.avail_in = n;
+  char buf[4096];
+  int r;
+  do {
+    z.next_out = (Bytef *)buf;
+    z.avail_out = sizeof(buf);
+    r = inflate(&z, Z_NO_FLUSH);
+    out.append(buf, sizeof(buf) - z.avail_out);
+  } while (r == Z_OK);
+  inflateEnd(&z);
+  return r == Z_STREAM_END && z.avail_in == 0;
+}
+
+AsyncWeb web(80);
+
+// Pagina tipo impostazioni (~12 KB): copia della configurazione sotto
+// lock, poi con stream = true unlock() e chunk dritti al socket
+static void settingsLike(bool stream) {
+  const String city = "Lugano <Paradiso> & \"lago\"";
+  if (stream)
+    web.unlock();
+  HtmlWriter w(web);
+  w.begin(200);
+  w.s("<html><body><form>");
+  for (int k = 0; k < 120; k++) {
+    w.s("<label class='field'>Nome #");
+    w.num((long)k);
+    w.s("</label><input name='cd' type='text' value='");
+    w.esc(city);
+    w.s("'/>");
+  }
+  w.s("</form></body></html>");
+  w.end();
+}
+
+int main() {
+  // --- Byte degli asset contro i sorgenti in web/ ---
+  size_t raw = 0, gz = 0;
+  for (uint8_t i = 0; i < WEB_ASSET_COUNT; i++) {
+    const WebAsset &a = WEB_ASSETS[i];
+    const std::string url = a.url;
+    std::smatch m;
+    const bool named = std::regex_match(url, m, std::regex(R"(/a/(\w+)\.([0-9a-f]{8})\.(css|js))"));
+    CHECK(named);
+    if (!named)
+      continue;
+
+    // header gzip deterministico: metodo deflate, mtime 0
+    CHECK(a.len > 18 && a.gz[0] == 0x1f && a.gz[1] == 0x8b && a.gz[2] == 8);
+    CHECK(!a.gz[4] && !a.gz[5] && !a.gz[6] && !a.gz[7]);
+
+    std::string body;
+    CHECK(gunzip(a.gz, a.len, body));
+    const std::string src = tReadFile(("../web/" + m[1].str() + "." + m[3].str()).c_str());
+    const bool css = m[3] == "css";
+    CHECK(body == (css ? minifyCss(src) : minifyJs(src)));
+    CHECK_STR(sha256hex(body).substr(0, 8), m[2].str());
+    CHECK_STR(a.type, css ? "text/css" : "application/javascript");
+    CHECK(a.len < body.size());
+    raw += body.size();
+    gz += a.len;
+  }
+  printf("  %u asset: %zu B minificati → %zu B gzip in flash\n", WEB_ASSET_COUNT, raw, gz);
+
+  // --- Risposte: asset senza lock, pagine con lock bufferizzate ---
+  for (uint8_t i = 0; i < WEB_ASSET_COUNT; i++)
+    web.on(WEB_ASSETS[i].url, HTTP_GET, [i]() { webSendAsset(web, WEB_ASSETS[i]); }, false);
+  web.on("/", HTTP_GET, []() {
+    HtmlWriter w(web);
+    w.begin(200);
+    w.s("<html><head><link rel='stylesheet' href='" ASSET_HOME_CSS "'/></head><body>");
+    for (int k = 0; k < 300; k++) { // oltre HTML_CHUNK: più chunk
+      w.s("<p>");
+      w.esc("riga <" + String(k) + "> & \"altro\"");
+      w.s("</p>");
+    }
+    w.s("</body></html>");
+    w.end();
+  });
+  web.on("/big", HTTP_GET, []() {
+    HtmlWriter w(web);
+    w.begin(200);
+    for (size_t k = 0; k < WEB_MAX_RESP / 16 + 1; k++)
+      w.s("0123456789abcdef", 16);
+    w.end();
+  });
+  web.on("/save", HTTP_POST, []() {
+    web.send(200, "text/plain; charset=utf-8", web.arg("city") + "|" + web.arg("note"));
+  });
+  web.on("/set-locked", HTTP_GET, []() { settingsLike(false); });
+  web.on("/set-stream", HTTP_GET, []() { settingsLike(true); });
+  CHECK(web.begin());
+
+  // --- Pagina lunga: tutta raccolta sotto lock (prima) o unlock() (ora) ---
+  // byte e tempo al primo invio, picco di heap (new + heap_caps) della
+  // richiesta; web_out nasce qui, streaming prima
+  {
+    struct Run {
+      size_t first, body, heap, caps;
+      int sends;
+      double ttfbUs;
+    };
+    auto run = [](const char *uri) {
+      const size_t heap0 = tHeapNow, caps0 = shim_caps_now;
+      tHeapReset();
+      shim_caps_peak = caps0;
+      shimHttpdRequest(HTTP_GET, uri);
+      return Run{shim_httpd.firstBytes, shim_httpd.bytes, tHeapPeak - heap0,
+                 shim_caps_peak - caps0, shim_httpd.sends,
+                 (double)(shim_httpd.firstUs - shim_httpd.t0Us)};
+    };
+    shim_httpd.keepBody = false;
+    const Run st = run("/set-stream");
+    const Run lk = run("/set-locked");
+    shim_httpd.keepBody = true;
+    CHECK_EQ(st.body, lk.body);
+    CHECK(st.body > 8192 && st.body < WEB_MAX_RESP);
+    CHECK_EQ(lk.sends, 1);
+    CHECK_EQ(lk.first, lk.body); // primo byte a pagina finita
+    CHECK(lk.caps >= lk.body);
+    CHECK(st.sends > 8);
+    CHECK_EQ(st.first, HTML_CHUNK); // primo chunk appena pieno
+    CHECK_EQ(st.caps, 0);
+    CHECK(st.heap < 512);
+    CHECK_EQ(shim_httpd.lockedSends, 0);
+    printf("  pagina da %zu B: sotto lock primo invio %zu B dopo %.1f µs, heap +%zu B; "
+           "unlock() primo invio %zu B dopo %.1f µs, heap +%zu B\n",
+           st.body, lk.first, lk.ttfbUs, lk.heap + lk.caps, st.first, st.ttfbUs,
+           st.heap + st.caps);
+  }
+
+  for (uint8_t i = 0; i < WEB_ASSET_COUNT; i++) {
+    const WebAsset &a = WEB_ASSETS[i];
+    shim_lock_takes = 0;
+    CHECK_EQ(shimHttpdRequest(HTTP_GET, a.url), ESP_OK);
+    CHECK_EQ(shim_lock_takes, 0);
+    CHECK_STR(shim_httpd.status, "200 OK");
+    CHECK_STR(shim_httpd.type, a.type);
+    CHECK_STR(shim_httpd.header("Content-Encoding"), "gzip");
+    CHECK_STR(shim_httpd.header("Cache-Control"), "public, max-age=31536000, immutable");
+    CHECK(shim_httpd.body == std::string((const char *)a.gz, a.len));
+    CHECK_EQ(shim_httpd.sends, 1);
+  }
+
+  // Query string ignorata nel routing; URL con hash vecchio → 404
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, (String(ASSET_HOME_JS) + "?v=1").c_str()), ESP_OK);
+  CHECK_STR(shim_httpd.header("Content-Encoding"), "gzip");
+  shimHttpdRequest(HTTP_GET, "/a/home.00000000.css");
+  CHECK_STR(shim_httpd.status, "404 Not Found");
+  CHECK_EQ(shim_httpd.lockedSends, 0);
+
+  // Pagina con lock: tutta la risposta parte in un colpo a lock rilasciato
+  shim_lock_takes = 0;
+  CHECK_EQ(shimHttpdRequest(HTTP_GET, "/"), ESP_OK);
+  CHECK_EQ(shim_lock_takes, 1);
+  CHECK_EQ(shim_lock_depth, 0);
+  CHECK_EQ(shim_httpd.lockedSends, 0);
+  CHECK_EQ(shim_httpd.sends, 1);
+  CHECK_STR(shim_httpd.status, "200 OK");
+  CHECK_STR(shim_httpd.header("Cache-Control"), "no-store");
+  CHECK(shim_httpd.body.size() > HTML_CHUNK);
+  CHECK(shim_httpd.body.find(ASSET_HOME_CSS) != std::string::npos);
+  CHECK(shim_httpd.body.find("<p>riga &lt;299&gt; &amp; &quot;altro&quot;</p></body></html>") !=
+        std::string::npos);
+
+  // Oltre WEB_MAX_RESP: 500, ancora fuori dal lock
+  shimHttpdRequest(HTTP_GET, "/big");
+  CHECK_STR(shim_httpd.status, "500 Internal Server Error");
+  CHECK_EQ(shim_httpd.lockedSends, 0);
+
+  // Form: body letto prima del lock, argomenti decodificati
+  CHECK_EQ(shimHttpdRequest(HTTP_POST, "/save", "city=Lugano+Paradiso&note=a%26b%3D%C3%A8"),
+           ESP_OK);
+  CHECK_STR(shim_httpd.body, "Lugano Paradiso|a&b=\xC3\xA8");
+  CHECK_EQ(shim_httpd.lockedSends, 0);
+
+  TEST_END();
+}
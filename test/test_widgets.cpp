@@ -0,0 +1,279 @@
+// widgets.h su un raster che conta i pixel scritti: etichette e righe
+// riscritte una volta sola sul proprio rettangolo, nulla se lo stato non
+// cambia, barre solo al pixel successivo, figli tagliati sul genitore e
+// nascosti col fondo del genitore; poi il menu vero di touch_menu.h
+// guidato da touchTap(): pixel per interazione contro il ridisegno
+// completo di prima, e ogni schermata incrementale identica a quella
+// disegnata da zero
+#include "test.h"
+
+// layers.h viene dopo displayhelpers.h nello sketch
+int adjacentEnabledPage(int p, int dir);
+
+#include "handlers/nvconfig.h"
+#include "handlers/touch_menu.h"
+
+#include <cmath>
+#include <vector>
+
+static constexpr uint32_t SCREEN = 480 * 480;
+
+static std::vector<uint16_t> fb(SCREEN), fbRef(SCREEN);
+static std::vector<uint8_t> perPx(SCREEN);
+static SqRGBDisplay display(fb.data());
+Arduino_RGB_Display *gfx = &display;
+
+Preferences prefs;
+String g_fiat, g_city, g_lang = "it", g_ics, g_lat, g_lon, g_rss_url, g_oa_key, g_oa_topic,
+    g_note, g_ha_ip, g_ha_token, g_ha_ents;
+CDEvent cd[8];
+double g_btc_owned = NAN;
+bool g_splash_enabled = true;
+uint32_t PAGE_INTERVAL_MS = 15000;
+NightCfg g_night = {false, 23, 7, 20, 30};
+bool g_show[PAGES];
+bool g_timeSynced = false;
+int g_page = 0;
+uint32_t lastPageSwitch = 0;
+const uint16_t COL_BG = 0x1B70;
+const uint16_t COL_ACCENT2 = 0xFD20;
+
+uint32_t pagesMaskFromArray() {
+  uint32_t m = 0;
+  for (int i = 0; i < PAGES; i++)
+    if (g_show[i])
+      m |= 1UL << i;
+  return m;
+}
+void pagesArrayFromMask(uint32_t m) {
+  for (int i = 0; i < PAGES; i++)
+    g_show[i] = m & (1UL << i);
+}
+int adjacentEnabledPage(int p, int) { return p; }
+void swipeToPage(int8_t) {}
+void drawCurrentPage() {}
+void softReboot() {}
+
+// Pixel scritti (e scritti più di una volta) da f()
+struct Paint {
+  uint64_t px;
+  uint32_t twice;
+  int16_t x0, y0, x1, y1; // riquadro dei pixel toccati
+};
+
+template <class F> static Paint paint(F f) {
+  std::fill(perPx.begin(), perPx.end(), 0);
+  display.perPx = perPx.data();
+  display.writes = 0;
+  f();
+  display.perPx = nullptr;
+  Paint p = {display.writes, 0, 480, 480, -1, -1};
+  for (int y = 0; y < 480; y++)
+    for (int x = 0; x < 480; x++) {
+      const uint8_t n = perPx[y * 480 + x];
+      if (!n)
+        continue;
+      p.twice += n > 1;
+      p.x0 = std::min<int16_t>(p.x0, x);
+      p.y0 = std::min<int16_t>(p.y0, y);
+      p.x1 = std::max<int16_t>(p.x1, x);
+      p.y1 = std::max<int16_t>(p.y1, y);
+    }
+  return p;
+}
+
+static bool inside(const Paint &p, const Widget &w) {
+  return p.x0 >= w.x && p.y0 >= w.y && p.x1 < w.x + w.w && p.y1 < w.y + w.h;
+}
+
+// Schermata del menu ridisegnata da zero (come drawPauseOverlay()), in fbRef
+static bool menuMatchesFullRepaint() {
+  display.retarget(fbRef.data());
+  wgInvalidate(menuUi);
+  wgRender(menuUi);
+  gfx->fillRect(0, 0, 480, 3, MENU_ACCENT);
+  gfx->drawFastHLine(M_MARGIN, M_HEADER_H - 4, 480 - M_MARGIN * 2, MENU_BORDER);
+  display.retarget(fb.data());
+  return fb == fbRef;
+}
+
+static void tapOn(const Widget &w) { touchTap(w.x + w.w / 2, w.y + w.h / 2); }
+
+int main() {
+  // =========================================================================
+  // Albero di prova: pannello con etichetta, riga, barra, badge e un figlio
+  // che sporge dal genitore
+  // =========================================================================
+  {
+    static const WgStyle ROOT = {0x0000, 0, 0, 0, 0, 0, 0, 0};
+    static const WgStyle CARD = {0x18C3, 0xFFFF, 0x2945, 0, 0, 0, 6, 1};
+    static const WgStyle TXT = {0x18C3, 0xE71C, 0, 0, 0, 0, 0, 2};
+    static Widget w[8];
+    WgTree t = {w, 8, 0, 0x0000};
+    wgAdd(t, WG_PANEL, 0, 0, 480, 480, &ROOT);
+    Widget &card = wgAdd(t, WG_PANEL, 20, 100, 440, 200, &CARD, 0);
+    Widget &lbl = wgAdd(t, WG_LABEL, 40, 120, 300, 16, &TXT, 1);
+    Widget &row = wgAdd(t, WG_ROW, 40, 150, 400, 16, &TXT, 1);
+    Widget &bar = wgAdd(t, WG_BAR, 40, 190, 400, 20, &CARD, 1);
+    Widget &badge = wgAdd(t, WG_BADGE, 400, 120, 40, 16, &CARD, 1);
+    Widget &out = wgAdd(t, WG_LABEL, 380, 260, 200, 16, &TXT, 1, WG_RIGHT);
+    wgText(lbl, "Uptime");
+    wgText(row, "Heap");
+    wgVal(row, "120k");
+    wgText(out, "fuori dal pannello");
+    wgColor(badge, 0x07E0);
+
+    CHECK(paint([&] { CHECK_EQ(wgRender(t), 7); }).px >= SCREEN);
+    CHECK_EQ(paint([&] { CHECK_EQ(wgRender(t), 0); }).px, 0); // niente di sporco
+
+    // stesso stato: nessun widget sporco
+    wgText(lbl, "Uptime");
+    wgVal(row, "120k");
+    wgColor(badge, 0x07E0);
+    wgShow(badge, true);
+    CHECK_EQ(paint([&] { wgRender(t); }).px, 0);
+
+    // etichetta: il suo rettangolo, ogni pixel una volta
+    wgText(lbl, "Uptime 3d");
+    Paint p = paint([&] { CHECK_EQ(wgRender(t), 1); });
+    CHECK_EQ(p.px, lbl.w * lbl.h);
+    CHECK_EQ(p.twice, 0);
+    CHECK(inside(p, lbl));
+
+    // riga: valore nuovo → la riga, ogni pixel una volta
+    wgVal(row, "96k");
+    p = paint([&] { wgRender(t); });
+    CHECK_EQ(p.px, row.w * row.h);
+    CHECK_EQ(p.twice, 0);
+
+    // testo più lungo del rettangolo: troncato, mai fuori
+    wgText(lbl, "una frase molto più lunga dei trecento pixel dell'etichetta");
+    p = paint([&] { wgRender(t); });
+    CHECK_EQ(p.px, lbl.w * lbl.h);
+    CHECK(inside(p, lbl));
+
+    // figlio che sporge: tagliato sul genitore (card finisce a x = 460)
+    wgText(out, "altro testo");
+    p = paint([&] { wgRender(t); });
+    CHECK_EQ(p.px, (card.x + card.w - out.x) * out.h);
+    CHECK(p.x1 < card.x + card.w);
+    CHECK_EQ(p.twice, 0);
+
+    // barra: sotto il pixel nessun ridisegno, poi solo la barra
+    wgBar(bar, 500);
+    paint([&] { wgRender(t); });
+    wgBar(bar, 502); // 396 px di corsa: 198,8 → ancora 198
+    CHECK_EQ(paint([&] { wgRender(t); }).px, 0);
+    wgBar(bar, 503);
+    p = paint([&] { CHECK_EQ(wgRender(t), 1); });
+    CHECK(p.px > 0 && inside(p, bar));
+
+    // nascosto: fondo del genitore sul rettangolo, una volta
+    wgShow(badge, false);
+    p = paint([&] { wgRender(t); });
+    CHECK_EQ(p.px, badge.w * badge.h);
+    CHECK_EQ(fb[badge.y * 480 + badge.x], CARD.bg);
+    CHECK_EQ(wgHit(badge, badge.x + 1, badge.y + 1), 0);
+    wgShow(badge, true);
+    CHECK(wgHit(badge, badge.x + 1, badge.y + 1));
+
+    // genitore ridisegnato: ridisegna i figli, niente fuori dal genitore
+    wgColor(badge, 0xF800);
+    wgOn(card, true);
+    p = paint([&] { CHECK_EQ(wgRender(t), 6); });
+    CHECK(inside(p, card));
+
+    // genitore nascosto: i figli non si disegnano sopra il fondo radice
+    wgShow(card, false);
+    wgText(lbl, "invisibile");
+    p = paint([&] { CHECK_EQ(wgRender(t), 1); });
+    CHECK_EQ(p.px, card.w * card.h);
+    CHECK_EQ(fb[lbl.y * 480 + lbl.x], ROOT.bg);
+  }
+
+  // =========================================================================
+  // Menu pagine di touch_menu.h, guidato dai tap
+  // =========================================================================
+  for (bool &s : g_show)
+    s = true;
+  g_show[P_BTC] = g_show[P_NEWS] = false;
+
+  // pagina sotto il menu: un disegno qualunque, da ritrovare alla chiusura
+  for (uint32_t i = 0; i < SCREEN; i++)
+    fb[i] = (uint16_t)(i * 2654435761u >> 16);
+  const std::vector<uint16_t> page = fb;
+
+  struct Row {
+    const char *what;
+    Paint p;
+  };
+  std::vector<Row> rows;
+
+  // apertura: fondo a schermo intero, widget sopra e righe d'accento
+  Paint p = paint([] { touchTap(240, 240); });
+  CHECK(menuActive);
+  CHECK(p.px >= SCREEN);
+  CHECK(menuMatchesFullRepaint());
+  rows.push_back({"apertura menu", p});
+
+  // toggle di una pagina: il suo bottone e il contatore
+  const Widget &b1 = menuW[MW_BTN0 + 1];
+  p = paint([&] { tapOn(b1); });
+  CHECK_EQ(g_show[1], 0);
+  CHECK(p.px > 0 && p.px < (uint64_t)2 * b1.w * b1.h + menuW[MW_COUNT].w * menuW[MW_COUNT].h);
+  CHECK(p.y0 >= menuW[MW_COUNT].y && p.y1 < b1.y + b1.h);
+  CHECK(menuMatchesFullRepaint());
+  rows.push_back({"toggle pagina", p});
+  p = paint([&] { tapOn(b1); });
+  CHECK_EQ(g_show[1], 1);
+  CHECK(menuMatchesFullRepaint());
+
+  // freccia destra: etichette dei bottoni, frecce e numero di pagina
+  p = paint([&] { tapOn(menuW[MW_ARROW_R]); });
+  CHECK_EQ(menuPage, 1);
+  CHECK(p.px < SCREEN / 2);
+  CHECK(menuMatchesFullRepaint());
+  rows.push_back({"freccia, pagina 2", p});
+
+  // ultima pagina: bottoni vuoti nascosti col fondo del menu
+  p = paint([&] { tapOn(menuW[MW_ARROW_R]); });
+  CHECK_EQ(menuPage, 2);
+  CHECK(menuW[MW_BTN0 + 1].hidden);
+  CHECK(menuMatchesFullRepaint());
+  rows.push_back({"freccia, pagina 3", p});
+
+  // freccia disabilitata e tap fuori dai bottoni: zero pixel
+  p = paint([&] { tapOn(menuW[MW_ARROW_R]); });
+  CHECK_EQ(p.px, 0);
+  CHECK_EQ(menuPage, 2);
+  p = paint([] { touchTap(240, M_HEADER_H + M_BTN_H + M_GAP_Y / 2); });
+  CHECK_EQ(p.px, 0);
+  p = paint([&] { tapOn(menuW[MW_BTN0 + 3]); }); // nascosto: niente
+  CHECK_EQ(p.px, 0);
+  rows.push_back({"tap a vuoto", p});
+
+  p = paint([&] { tapOn(menuW[MW_ARROW_L]); });
+  CHECK_EQ(menuPage, 1);
+  CHECK(menuMatchesFullRepaint());
+
+  // annulla: la pagina salvata torna con una copia, nessun disegno
+  p = paint([&] { tapOn(menuW[MW_CANCEL]); });
+  CHECK(!menuActive && !touchPaused);
+  CHECK_EQ(p.px, 0);
+  CHECK(fb == page);
+  rows.push_back({"annulla (copia)", p});
+
+  // riapertura: menu di nuovo completo, dalla prima pagina
+  paint([] { touchTap(240, 240); });
+  CHECK_EQ(menuPage, 0);
+  CHECK(menuMatchesFullRepaint());
+
+  // prima ogni tap ridisegnava il menu intero, come l'apertura
+  const double full = rows[0].p.px;
+  printf("  pixel scritti per interazione (ridisegno completo: %.0f):\n", full);
+  for (const Row &r : rows)
+    printf("    %-20s %7llu  (%5.1f %%)\n", r.what, (unsigned long long)r.p.px,
+           100.0 * r.p.px / full);
+
+  TEST_END();
+}
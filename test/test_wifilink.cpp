@@ -0,0 +1,214 @@
+// wifilink.h con eventi del driver scritti a copione: tentativo col BSSID
+// salvato → scansione allo scadere di WL_FAST_MS, scansione fallita →
+// backoff 2 s · 2^n (max 60 s) con jitter ±25 %, GOT_IP durante WAIT,
+// LOST da UP → nuovo tentativo immediato, BSSID/canale in NVS solo se
+// cambiati, millis() che passa per lo zero e IP statico (dns assente →
+// gateway)
+#include "test.h"
+
+#define SQUARED_STATIC_IP "192.168.1.60, 192.168.1.1,255.255.255.0"
+
+#include "handlers/wifilink.h"
+
+#include <algorithm>
+#include <vector>
+
+Preferences prefs;
+String sta_ssid, sta_pass;
+
+// Stato del modulo come dopo un reset
+static void reset(bool withCache) {
+  wl = WlLink();
+  wl_event.store(WLE_NONE);
+  wl_channel = 0;
+  memset(wl_bssid, 0, sizeof(wl_bssid));
+  WiFi = ShimWiFi();
+  prefs = Preferences();
+  prefs.kv["ssid"] = "Casa";
+  prefs.kv["pass"] = "segreta";
+  if (withCache) {
+    prefs.kv["bssid"] = std::string("\x24\x5A\x4C\x01\x02\x03", 6);
+    prefs.kv["ch"] = std::string(1, '\x06');
+  }
+}
+
+// wlTick() ogni 10 ms fino a t (come il loop), conta i giri "link su"
+static int runUntil(uint32_t t) {
+  int ups = 0;
+  while ((int32_t)(t - shim_ms) > 0) {
+    shim_ms += std::min<uint32_t>(10, t - shim_ms);
+    ups += wlTick();
+  }
+  return ups;
+}
+
+int main() {
+  // --- Senza credenziali: niente driver ---
+  reset(false);
+  prefs.kv.erase("ssid");
+  CHECK(!wlBegin());
+  CHECK_EQ(WiFi.beginsFast + WiFi.beginsScan, 0);
+
+  // --- Primo avvio con cache: BSSID/canale, poi scansione a WL_FAST_MS ---
+  shim_ms = 0xFFFFF000; // millis() passa per lo zero durante il test
+  const uint32_t t0 = shim_ms;
+  reset(true);
+  CHECK(wlBegin());
+  CHECK(!WiFi.autoReconnect && !WiFi.persist && !WiFi.sleep);
+  CHECK_EQ(WiFi.m, WIFI_STA);
+  CHECK_EQ(WiFi.cbs.size(), 3);
+  CHECK_EQ(WiFi.configs, 1);
+  CHECK_EQ(WiFi.cfg[0][3], 60);
+  CHECK_EQ(WiFi.cfg[1][2], 1);
+  CHECK_EQ(WiFi.cfg[2][0], 255);
+  CHECK_EQ(WiFi.cfg[2][3], 0);
+  CHECK_EQ(WiFi.cfg[3][3], 1); // dns = gateway
+  CHECK_EQ(WiFi.beginsFast, 1);
+  CHECK_EQ(WiFi.lastChannel, 6);
+  CHECK_EQ(WiFi.lastBssid[5], 0x03);
+  CHECK_STR(wlStateName(), "connecting");
+
+  // DISCONNECTED transitorio durante l'associazione: ignorato
+  shim_ms += 500;
+  shimWifiEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, 15);
+  CHECK(!wlTick());
+  CHECK_EQ(wl_reason, 15);
+  CHECK_EQ(WiFi.beginsScan, 0);
+  runUntil(t0 + WL_FAST_MS - 10);
+  CHECK_EQ(WiFi.beginsScan, 0);
+  runUntil(t0 + WL_FAST_MS);
+  CHECK_EQ(WiFi.beginsScan, 1); // AP spostato: scansione subito
+  CHECK_EQ(wl.fails, 0);
+
+  // Scansione fallita → WAIT con backoff del primo giro (2 s ±25 %)
+  runUntil(t0 + WL_FAST_MS + WL_SCAN_MS);
+  CHECK_STR(wlStateName(), "wait");
+  CHECK_EQ(wl.fails, 1);
+  CHECK(wl.wait >= 1500 && wl.wait <= 2500);
+
+  // GOT_IP durante WAIT (driver riagganciato da solo): UP, cache in NVS
+  WiFi.apChannel = 11; // AP cambiato di canale
+  prefs.resetCounters();
+  shim_ms += 100;
+  shimWifiEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  CHECK(wlTick());
+  CHECK(wlUp());
+  CHECK_EQ(wl.fails, 0);
+  CHECK_EQ(prefs.putsPerKey["ch"], 1);
+  CHECK_EQ(prefs.putsPerKey["bssid"], 1);
+  CHECK_EQ((uint8_t)prefs.kv["ch"][0], 11);
+  CHECK(!wlTick()); // true solo al giro della transizione
+  CHECK_EQ(WiFi.beginsFast + WiFi.beginsScan, 2);
+
+  // --- LOST da UP: tentativo immediato col nuovo canale ---
+  shim_ms += 60000;
+  shimWifiEvent(ARDUINO_EVENT_WIFI_STA_LOST_IP);
+  CHECK(!wlTick());
+  CHECK_STR(wlStateName(), "connecting");
+  CHECK_EQ(wl.drops, 1);
+  CHECK_EQ(WiFi.beginsFast, 2);
+  CHECK_EQ(WiFi.lastChannel, 11);
+  CHECK(WiFi.disconnects >= 2);
+
+  // Riconnesso allo stesso AP: nessuna scrittura NVS
+  prefs.resetCounters();
+  shim_ms += 800;
+  shimWifiEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  CHECK(wlTick());
+  CHECK_EQ(prefs.puts, 0);
+  CHECK_EQ(prefs.begins, 0);
+
+  // DISCONNECTED da UP: stessa cosa
+  shimWifiEvent(ARDUINO_EVENT_WIFI_STA_DISCONNECTED, 8);
+  wlTick();
+  CHECK_EQ(wl.drops, 2);
+  CHECK_EQ(WiFi.beginsFast, 3);
+
+  // --- Interruzione lunga: fast → scan → wait, backoff che raddoppia ---
+  {
+    uint32_t prevBase = 0;
+    for (uint8_t n = 1; n <= 8; n++) {
+      const int fast0 = WiFi.beginsFast, scan0 = WiFi.beginsScan;
+      runUntil(wl.t0 + WL_FAST_MS);
+      CHECK_EQ(WiFi.beginsScan, scan0 + 1);
+      runUntil(wl.t0 + WL_SCAN_MS);
+      CHECK_STR(wlStateName(), "wait");
+      CHECK_EQ(wl.fails, n);
+      const uint32_t base = std::min<uint32_t>(WL_BACKOFF_MS << std::min(n - 1, 5),
+                                               WL_BACKOFF_MAX_MS);
+      CHECK(wl.wait >= base - base / 4 && wl.wait <= base + base / 4);
+      CHECK(base >= prevBase);
+      prevBase = base;
+      // nessun tentativo prima della fine dell'attesa, poi col BSSID
+      runUntil(wl.t0 + wl.wait - 10);
+      CHECK_EQ(WiFi.beginsFast, fast0);
+      runUntil(shim_ms + 10);
+      CHECK_EQ(WiFi.beginsFast, fast0 + 1);
+    }
+    CHECK_EQ(prevBase, WL_BACKOFF_MAX_MS);
+  }
+
+  // --- Senza cache: solo scansioni; il primo GOT_IP scrive la cache ---
+  reset(false);
+  CHECK(wlBegin());
+  CHECK_EQ(WiFi.beginsScan, 1);
+  CHECK_EQ(WiFi.beginsFast, 0);
+  shim_ms += 4000;
+  shimWifiEvent(ARDUINO_EVENT_WIFI_STA_GOT_IP);
+  CHECK(wlTick());
+  CHECK_EQ(prefs.putsPerKey["bssid"], 1);
+  CHECK(wl.cached);
+  // canale in NVS fuori da 1..14: cache ignorata al boot
+  reset(true);
+  prefs.kv["ch"] = std::string(1, '\x0F');
+  CHECK(wlBegin());
+  CHECK_EQ(WiFi.beginsFast, 0);
+  CHECK_EQ(WiFi.beginsScan, 1);
+
+  // --- Jitter: distribuzione su tutto ±25 %, dispositivi desincronizzati ---
+  {
+    WlLink a;
+    a.fails = 3; // 8 s
+    uint32_t lo = UINT32_MAX, hi = 0;
+    std::vector<int> bins(10, 0);
+    for (int i = 0; i < 20000; i++) {
+      const uint32_t w = a.backoff();
+      CHECK(w >= 6000 && w <= 10000);
+      lo = std::min(lo, w);
+      hi = std::max(hi, w);
+      bins[std::min<uint32_t>((w - 6000) / 400, 9)]++;
+    }
+    CHECK(lo < 6100 && hi > 9900);
+    for (int b : bins)
+      CHECK(b > 1500 && b < 2500); // circa uniforme
+
+    // due dispositivi con esp_random diverso: attese diverse
+    int same = 0;
+    for (uint32_t s = 1; s <= 100; s++) {
+      WlLink x, y;
+      x.rnd ^= s * 2654435761u;
+      y.rnd ^= (s + 1000) * 2654435761u;
+      x.fails = y.fails = 1;
+      same += x.backoff() == y.backoff();
+    }
+    CHECK(same < 5);
+
+    // fails saturato (anche dopo il giro di uint8_t): mai oltre il tetto
+    WlLink z;
+    for (int n = 1; n < 600; n++) {
+      z.fails = n;
+      const uint32_t w = z.backoff();
+      CHECK(w >= 1500 && w <= WL_BACKOFF_MAX_MS + WL_BACKOFF_MAX_MS / 4);
+    }
+  }
+
+  // --- OFF: nessuna azione qualunque evento ---
+  {
+    WlLink off;
+    CHECK_EQ(off.step(WLE_GOT_IP, 0), WLA_NONE);
+    CHECK_EQ(off.step(WLE_LOST, 100000), WLA_NONE);
+    CHECK_EQ(off.st, WLS_OFF);
+  }
+
+  TEST_END();
+}
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+SquaredCoso — asset statici della WebUI → handlers/webassets.h
+
+Legge web/*.css e web/*.js, toglie commenti e spazi superflui, comprime
+con gzip (deterministico: mtime 0) e scrive un header con:
+
+    • un array PROGMEM per asset (byte già compressi)
+    • l'URL con hash del contenuto   /a/<nome>.<hash8>.<ext>
+    • la tabella WEB_ASSETS[] usata dal WebServer
+    • webSendAsset(): header gzip + cache immutable, poi i byte
+
+Cambiando un file cambia l'hash e quindi l'URL: il browser può tenere in
+cache ogni asset per sempre (Cache-Control: immutable).
+
+    python3 tools/gen_webassets.py           rigenera l'header
+    python3 tools/gen_webassets.py --check   verifica che sia aggiornato
+                                             (exit 1 se diverso)
+
+Autore: Davide “gat” Nasato
+Repository: https://github.com/davidegat/SquaredCoso
+Licenza: CC BY-NC 4.0
+"""
+
+import argparse
+import gzip
+import hashlib
+import re
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+SRC = ROOT / "web"
+OUT = ROOT / "handlers" / "webassets.h"
+
+TYPES = {".css": "text/css", ".js": "application/javascript"}
+
+
+# ---------------------------------------------------------------------------
+# Minificazione minima (niente dipendenze esterne)
+# ---------------------------------------------------------------------------
+def minify_css(s):
+    s = re.sub(r"/\*.*?\*/", "", s, flags=re.S)
+    s = re.sub(r"\s+", " ", s)
+    s = re.sub(r"\s*([{};:,>])\s*", r"\1", s)
+    return s.replace(";}", "}").strip()
+
+
+def minify_js(s):
+    out = []
+    for ln in s.splitlines():
+        ln = ln.strip()
+        if ln and not ln.startswith("//"):
+            out.append(ln)
+    return "\n".join(out)
+
+
+def build(path):
+    raw = path.read_text(encoding="utf-8")
+    body = (minify_css(raw) if path.suffix == ".css" else minify_js(raw)).encode()
+    digest = hashlib.sha256(body).hexdigest()[:8]
+    gz = gzip.compress(body, compresslevel=9, mtime=0)
+    ident = re.sub(r"\W", "_", path.stem).upper() + "_" + path.suffix[1:].upper()
+    return {
+        "ident": ident,
+        "url": "/a/%s.%s%s" % (path.stem, digest, path.suffix),
+        "type": TYPES[path.suffix],
+        "raw": len(body),
+        "gz": gz,
+    }
+
+
+# ---------------------------------------------------------------------------
+# Header C++
+# ---------------------------------------------------------------------------
+def render(assets):
+    o = []
+    o.append("""/*
+===============================================================================
+   SQUARED — WEB ASSETS (generato da tools/gen_webassets.py, non modificare)
+   Descrizione: CSS/JS della WebUI compressi gzip in PROGMEM, con URL che
+                contengono l'hash del contenuto (cache immutable).
+   Autore: Davide “gat” Nasato
+   Repository: https://github.com/davidegat/SquaredCoso
+   Licenza: CC BY-NC 4.0
+===============================================================================
+*/
+
+#pragma once
+
+#include <Arduino.h>
+
+struct WebAsset {
+  const char *url;
+  const char *type;
+  const uint8_t *gz;
+  uint32_t len;
+};
+""")
+    for a in assets:
+        o.append("// %s → %d byte, gzip %d byte" % (a["url"], a["raw"], len(a["gz"])))
+        o.append('#define ASSET_%s "%s"' % (a["ident"], a["url"]))
+        o.append("static const uint8_t ASSET_%s_GZ[] PROGMEM = {" % a["ident"])
+        gz = a["gz"]
+        for i in range(0, len(gz), 16):
+            o.append("    " + ", ".join("0x%02x" % b for b in gz[i:i + 16]) + ",")
+        o.append("};")
+        o.append("")
+    o.append("static const WebAsset WEB_ASSETS[] = {")
+    for a in assets:
+        o.append('    {ASSET_%s, "%s", ASSET_%s_GZ, sizeof(ASSET_%s_GZ)},'
+                 % (a["ident"], a["type"], a["ident"], a["ident"]))
+    o.append("};")
+    o.append("static constexpr uint8_t WEB_ASSET_COUNT =")
+    o.append("    sizeof(WEB_ASSETS) / sizeof(WEB_ASSETS[0]);")
+    o.append("""
+// Risposta di un asset: byte gzip così come sono, cache permanente (l'URL
+// cambia con il contenuto). Template: basta un server con l'API WebServer.
+template <class Server>
+static void webSendAsset(Server &web, const WebAsset &a) {
+  web.sendHeader(F("Content-Encoding"), F("gzip"));
+  web.sendHeader(F("Cache-Control"), F("public, max-age=31536000, immutable"));
+  web.send_P(200, a.type, (PGM_P)a.gz, a.len);
+}""")
+    return "\n".join(o) + "\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description="SquaredCoso web assets")
+    ap.add_argument("--check", action="store_true",
+                    help="verifica che l'header sia aggiornato")
+    cfg = ap.parse_args()
+
+    files = sorted(p for p in SRC.iterdir() if p.suffix in TYPES)
+    assets = [build(p) for p in files]
+
+    # i byte compressi devono ridare esattamente il sorgente minificato
+    for p, a in zip(files, assets):
+        assert len(gzip.decompress(a["gz"])) == a["raw"], p
+
+    text = render(assets)
+
+    if cfg.check:
+        cur = OUT.read_text(encoding="utf-8") if OUT.exists() else ""
+        if cur != text:
+            print("webassets.h non aggiornato: eseguire tools/gen_webassets.py",
+                  file=sys.stderr)
+            return 1
+        print("webassets.h aggiornato (%d asset)" % len(assets))
+        return 0
+
+    OUT.write_text(text, encoding="utf-8")
+    for a in assets:
+        print("%-32s %5d → %5d byte" % (a["url"], a["raw"], len(a["gz"])))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,186 @@
+#!/usr/bin/env python3
+"""
+SquaredCoso — carico concorrente sulla WebUI
+
+Apre N client simultanei verso il pannello (o verso qualsiasi server che
+risponda sulle stesse rotte) e misura latenza ed errori per rotta:
+
+    /                 guscio dashboard
+    /settings         form impostazioni (chunked)
+    /api/state        stato JSON
+    /api/config       configurazione JSON
+    PATCH /api/config rimanda il valore attuale di page_s (--patch, innocuo)
+
+Con --slow N si aggiungono N client "lenti" che inviano la richiesta un
+byte alla volta e leggono la risposta a rilento: gli altri client non
+devono risentirne e il pannello deve continuare ad animare.
+
+    python3 tools/load_web.py 192.168.1.42 --clients 8 --seconds 30
+    python3 tools/load_web.py 192.168.1.42 --clients 4 --slow 2 --patch
+
+Autore: Davide “gat” Nasato
+Repository: https://github.com/davidegat/SquaredCoso
+Licenza: CC BY-NC 4.0
+"""
+
+import argparse
+import asyncio
+import json
+import random
+import sys
+import time
+
+ROUTES = ["/", "/settings", "/api/state", "/api/config"]
+
+
+# ---------------------------------------------------------------------------
+# HTTP/1.1 minimale (Connection: close, body letto fino a EOF)
+# ---------------------------------------------------------------------------
+async def request(host, port, method, path, body=b"", timeout=10.0,
+                  slow=0.0):
+    head = ("%s %s HTTP/1.1\r\nHost: %s\r\nConnection: close\r\n"
+            % (method, path, host))
+    if body:
+        head += ("Content-Type: application/json\r\nContent-Length: %d\r\n"
+                 % len(body))
+    raw = (head + "\r\n").encode() + body
+
+    reader, writer = await asyncio.wait_for(
+        asyncio.open_connection(host, port), timeout)
+    try:
+        if slow:
+            for i in range(len(raw)):
+                writer.write(raw[i:i + 1])
+                await writer.drain()
+                await asyncio.sleep(slow)
+        else:
+            writer.write(raw)
+            await writer.drain()
+
+        data = b""
+        while True:
+            chunk = await asyncio.wait_for(reader.read(512 if slow else 65536),
+                                           timeout)
+            if not chunk:
+                break
+            data += chunk
+            if slow:
+                await asyncio.sleep(slow)
+    finally:
+        writer.close()
+
+    status = int(data.split(b" ", 2)[1]) if data.startswith(b"HTTP/") else 0
+    hdr, _, payload = data.partition(b"\r\n\r\n")
+    if b"transfer-encoding: chunked" in hdr.lower():
+        payload = dechunk(payload)
+    return status, payload
+
+
+def dechunk(p):
+    out = b""
+    while p:
+        line, _, p = p.partition(b"\r\n")
+        n = int(line.split(b";")[0] or b"0", 16)
+        if n == 0:
+            break
+        out += p[:n]
+        p = p[n + 2:]
+    return out
+
+
+# ---------------------------------------------------------------------------
+# Client
+# ---------------------------------------------------------------------------
+class Stats:
+    def __init__(self):
+        self.lat = {}
+        self.err = {}
+
+    def add(self, route, ms, ok):
+        self.lat.setdefault(route, []).append(ms)
+        if not ok:
+            self.err[route] = self.err.get(route, 0) + 1
+
+    def report(self, seconds):
+        total = sum(len(v) for v in self.lat.values())
+        print("%-20s %6s %6s %8s %8s %8s" %
+              ("rotta", "req", "err", "p50 ms", "p95 ms", "max ms"))
+        for route in sorted(self.lat):
+            v = sorted(self.lat[route])
+            print("%-20s %6d %6d %8.0f %8.0f %8.0f" % (
+                route, len(v), self.err.get(route, 0), v[len(v) // 2],
+                v[min(len(v) - 1, int(len(v) * 0.95))], v[-1]))
+        print("totale %d richieste in %.0f s → %.1f req/s" %
+              (total, seconds, total / seconds))
+        # i client lenti possono essere tagliati dal server: non contano
+        return sum(n for r, n in self.err.items() if not r.startswith("slow"))
+
+
+async def worker(cfg, stats, patch_body, deadline):
+    while time.monotonic() < deadline:
+        if patch_body and random.random() < 0.2:
+            method, route, body = "PATCH", "/api/config", patch_body
+        else:
+            method, route, body = "GET", random.choice(ROUTES), b""
+        label = method + " " + route if method != "GET" else route
+        t0 = time.monotonic()
+        try:
+            status, payload = await request(cfg.host, cfg.port, method, route,
+                                            body, cfg.timeout)
+            ok = status == 200
+            if ok and route.startswith("/api/"):
+                json.loads(payload)
+        except (OSError, asyncio.TimeoutError, ValueError):
+            ok = False
+        stats.add(label, (time.monotonic() - t0) * 1000, ok)
+
+
+async def slow_worker(cfg, stats, deadline):
+    while time.monotonic() < deadline:
+        t0 = time.monotonic()
+        try:
+            status, _ = await request(cfg.host, cfg.port, "GET", "/settings",
+                                      timeout=cfg.timeout * 3, slow=0.02)
+            ok = status == 200
+        except (OSError, asyncio.TimeoutError, ValueError):
+            ok = False  # atteso se il server taglia i client troppo lenti
+        stats.add("slow /settings", (time.monotonic() - t0) * 1000, ok)
+
+
+async def run(cfg):
+    patch_body = b""
+    if cfg.patch:
+        _, payload = await request(cfg.host, cfg.port, "GET", "/api/config")
+        page_s = json.loads(payload)["page_s"]
+        patch_body = json.dumps({"page_s": page_s}).encode()
+
+    stats = Stats()
+    deadline = time.monotonic() + cfg.seconds
+    tasks = [worker(cfg, stats, patch_body, deadline)
+             for _ in range(cfg.clients)]
+    tasks += [slow_worker(cfg, stats, deadline) for _ in range(cfg.slow)]
+    t0 = time.monotonic()
+    await asyncio.gather(*tasks)
+    return stats.report(time.monotonic() - t0)
+
+
+def main():
+    ap = argparse.ArgumentParser(description="SquaredCoso WebUI load test")
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=80)
+    ap.add_argument("--clients", type=int, default=6,
+                    help="client concorrenti")
+    ap.add_argument("--slow", type=int, default=0,
+                    help="client lenti aggiuntivi")
+    ap.add_argument("--seconds", type=float, default=20)
+    ap.add_argument("--timeout", type=float, default=10)
+    ap.add_argument("--patch", action="store_true",
+                    help="includi PATCH /api/config (rimanda page_s attuale)")
+    cfg = ap.parse_args()
+
+    errors = asyncio.run(run(cfg))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
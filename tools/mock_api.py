@@ -0,0 +1,252 @@
+#!/usr/bin/env python3
+"""
+SquaredCoso — mock API server (record / replay)
+
+Il firmware compilato con SQUARED_MOCK_API riscrive ogni URL
+    https://api.open-meteo.com/v1/forecast?...
+in
+    http://<mock>/https/api.open-meteo.com/v1/forecast?...
+
+record : inoltra la richiesta al servizio reale, salva la risposta in
+         fixtures/<host>/ e la restituisce al dispositivo.
+replay : risponde solo dalle fixture salvate, con latenza, perdita e
+         gonfiamento del body configurabili.
+
+Autore: Davide “gat” Nasato
+Repository: https://github.com/davidegat/SquaredCoso
+Licenza: CC BY-NC 4.0
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import random
+import re
+import sys
+import time
+import urllib.error
+import urllib.request
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+from pathlib import Path
+
+FORWARD_HEADERS = ("Authorization", "Content-Type", "Accept")
+
+
+# ---------------------------------------------------------------------------
+# Fixture
+# ---------------------------------------------------------------------------
+def upstream_url(path):
+    """'/https/host/p?q' -> 'https://host/p?q' (None se non riconosciuto)."""
+    m = re.match(r"^/(https?)/([^/?]+)(.*)$", path)
+    if not m:
+        return None
+    return f"{m.group(1)}://{m.group(2)}{m.group(3) or '/'}"
+
+
+def fixture_key(method, url, body):
+    h = hashlib.sha1()
+    h.update(method.encode())
+    h.update(b"\0")
+    h.update(url.encode())
+    if body:
+        h.update(b"\0")
+        h.update(body)
+    return h.hexdigest()[:16]
+
+
+def fixture_paths(root, method, url, body):
+    host = re.sub(r"[^A-Za-z0-9._-]", "_", url.split("/")[2])
+    key = fixture_key(method, url, body)
+    base = Path(root) / host / f"{method.lower()}-{key}"
+    return base.with_suffix(".body"), base.with_suffix(".json")
+
+
+def save_fixture(root, method, url, body, status, ctype, payload):
+    body_p, meta_p = fixture_paths(root, method, url, body)
+    body_p.parent.mkdir(parents=True, exist_ok=True)
+    body_p.write_bytes(payload)
+    meta_p.write_text(
+        json.dumps(
+            {
+                "method": method,
+                "url": url,
+                "status": status,
+                "content_type": ctype,
+                "size": len(payload),
+                "recorded": int(time.time()),
+            },
+            indent=2,
+        )
+    )
+
+
+def load_fixture(root, method, url, body):
+    body_p, meta_p = fixture_paths(root, method, url, body)
+    if not body_p.exists() or not meta_p.exists():
+        return None
+    meta = json.loads(meta_p.read_text())
+    return meta["status"], meta.get("content_type", ""), body_p.read_bytes()
+
+
+# ---------------------------------------------------------------------------
+# Gonfiamento del body (stessi dati, più byte da parsare)
+# ---------------------------------------------------------------------------
+def inflate_json(payload, factor):
+    """Aggiunge spazi dopo ',' e ':' fuori dalle stringhe."""
+    text = payload.decode("utf-8", "replace")
+    target = int(len(text) * factor)
+    seps = sum(1 for c in text if c in ",:") or 1
+    pad = " " * max(1, (target - len(text)) // seps)
+
+    out = []
+    in_str = esc = False
+    for c in text:
+        out.append(c)
+        if in_str:
+            if esc:
+                esc = False
+            elif c == "\\":
+                esc = True
+            elif c == '"':
+                in_str = False
+        elif c == '"':
+            in_str = True
+        elif c in ",:":
+            out.append(pad)
+    return "".join(out).encode()
+
+
+def inflate_body(payload, ctype, factor):
+    if factor <= 1.0 or not payload:
+        return payload
+    if "json" in ctype:
+        return inflate_json(payload, factor)
+    # XML / ICS / testo: righe vuote in coda, ignorate dai parser
+    extra = int(len(payload) * (factor - 1.0))
+    return payload + b"\r\n" * (extra // 2)
+
+
+# ---------------------------------------------------------------------------
+# Handler HTTP
+# ---------------------------------------------------------------------------
+class MockHandler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    cfg = None
+
+    def log_message(self, fmt, *args):
+        if not self.cfg.quiet:
+            sys.stderr.write("[mock] " + (fmt % args) + "\n")
+
+    def do_GET(self):
+        self.handle_any("GET")
+
+    def do_POST(self):
+        self.handle_any("POST")
+
+    # -----------------------------------------------------------------------
+    def handle_any(self, method):
+        cfg = self.cfg
+        url = upstream_url(self.path)
+        if not url:
+            self.send_error(404, "path must be /<scheme>/<host>/...")
+            return
+
+        n = int(self.headers.get("Content-Length") or 0)
+        req_body = self.rfile.read(n) if n else b""
+
+        if cfg.mode == "record":
+            hit = self.fetch_upstream(method, url, req_body)
+            if hit is None:
+                return
+            save_fixture(cfg.fixtures, method, url, req_body, *hit)
+        else:
+            hit = load_fixture(cfg.fixtures, method, url, req_body)
+            if hit is None:
+                self.send_error(404, "no fixture for " + url)
+                return
+
+        status, ctype, payload = hit
+        self.reply(status, ctype, payload)
+
+    # -----------------------------------------------------------------------
+    def fetch_upstream(self, method, url, body):
+        headers = {k: self.headers[k] for k in FORWARD_HEADERS if self.headers[k]}
+        headers["User-Agent"] = "SquaredCoso-mock/1.0"
+        req = urllib.request.Request(url, data=body or None, headers=headers,
+                                     method=method)
+        try:
+            with urllib.request.urlopen(req, timeout=20) as r:
+                return r.status, r.headers.get("Content-Type", ""), r.read()
+        except urllib.error.HTTPError as e:
+            return e.code, e.headers.get("Content-Type", ""), e.read()
+        except Exception as e:  # rete assente, DNS, TLS...
+            self.send_error(502, str(e))
+            return None
+
+    # -----------------------------------------------------------------------
+    def reply(self, status, ctype, payload):
+        cfg = self.cfg
+
+        if cfg.latency or cfg.jitter:
+            time.sleep(max(0, cfg.latency + random.uniform(-cfg.jitter, cfg.jitter)) / 1000)
+
+        payload = inflate_body(payload, ctype, cfg.inflate)
+
+        gz = (not cfg.no_gzip
+              and "gzip" in (self.headers.get("Accept-Encoding") or ""))
+        if gz:
+            payload = gzip.compress(payload, 6)
+
+        lost = cfg.loss > 0 and random.random() < cfg.loss
+        if lost and random.random() < 0.5:
+            # perdita totale: connessione chiusa senza risposta
+            self.close_connection = True
+            return
+
+        self.send_response(status)
+        self.send_header("Content-Type", ctype or "application/octet-stream")
+        self.send_header("Content-Length", str(len(payload)))
+        if gz:
+            self.send_header("Content-Encoding", "gzip")
+        self.send_header("Connection", "close")
+        self.end_headers()
+
+        if lost:
+            # perdita a metà body: il client vede un trasferimento troncato
+            self.wfile.write(payload[: len(payload) // 2])
+        else:
+            self.wfile.write(payload)
+        self.close_connection = True
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+def main():
+    ap = argparse.ArgumentParser(description="SquaredCoso mock API server")
+    ap.add_argument("mode", choices=("record", "replay"))
+    ap.add_argument("--bind", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=8080)
+    ap.add_argument("--fixtures", default=str(Path(__file__).parent / "fixtures"))
+    ap.add_argument("--latency", type=float, default=0, help="ms per risposta")
+    ap.add_argument("--jitter", type=float, default=0, help="± ms casuali")
+    ap.add_argument("--loss", type=float, default=0, help="probabilità 0..1")
+    ap.add_argument("--inflate", type=float, default=1.0,
+                    help="fattore di gonfiamento del body (>= 1)")
+    ap.add_argument("--no-gzip", action="store_true",
+                    help="non comprimere anche se il client lo accetta")
+    ap.add_argument("--quiet", action="store_true")
+    cfg = ap.parse_args()
+
+    MockHandler.cfg = cfg
+    srv = ThreadingHTTPServer((cfg.bind, cfg.port), MockHandler)
+    print(f"[mock] {cfg.mode} su {cfg.bind}:{cfg.port} · fixtures {cfg.fixtures}")
+    try:
+        srv.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
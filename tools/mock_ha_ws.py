@@ -0,0 +1,322 @@
+#!/usr/bin/env python3
+"""
+SquaredCoso — Home Assistant stand-in (WebSocket + REST)
+
+Emula quanto basta di Home Assistant per provare la pagina HA senza un
+server reale:
+
+    ws://<ip>:8123/api/websocket   auth → get_states → subscribe_events
+                                   (state_changed) con eventi casuali
+    http://<ip>:8123/api/states    lista completa (ripiego REST)
+    http://<ip>:8123/api/states/<entity_id>
+                                   singola entità (lista configurata)
+
+Gli stati iniziali arrivano da --states <file.json> (es. una fixture
+registrata con mock_api.py) oppure vengono generati.
+
+Autore: Davide “gat” Nasato
+Repository: https://github.com/davidegat/SquaredCoso
+Licenza: CC BY-NC 4.0
+"""
+
+import argparse
+import asyncio
+import base64
+import hashlib
+import json
+import random
+import struct
+import sys
+import time
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+
+
+# ---------------------------------------------------------------------------
+# Stati
+# ---------------------------------------------------------------------------
+def now_iso():
+    return time.strftime("%Y-%m-%dT%H:%M:%S+00:00", time.gmtime())
+
+
+def make_state(entity_id, state, name):
+    ts = now_iso()
+    return {
+        "entity_id": entity_id,
+        "state": state,
+        "attributes": {"friendly_name": name},
+        "last_changed": ts,
+        "last_updated": ts,
+        "context": {"id": "%032x" % random.getrandbits(128)},
+    }
+
+
+def generate_states(n):
+    """Mix di entità mostrate dalla pagina e rumore filtrato."""
+    kinds = [
+        ("light.sala_{}", lambda: random.choice(["on", "off"]), "Luce sala {}"),
+        ("switch.presa_{}", lambda: random.choice(["on", "off"]), "Presa {}"),
+        ("sensor.temperature_{}", lambda: "%.1f" % random.uniform(18, 25),
+         "Temperatura {}"),
+        ("sensor.phone_{}_battery", lambda: str(random.randint(5, 100)),
+         "Telefono {}"),
+        ("sensor.power_{}", lambda: str(random.randint(0, 3000)), "Potenza {}"),
+        ("automation.rule_{}", lambda: "on", "Regola {}"),
+    ]
+    out = [make_state("sun.sun", "above_horizon", "Sun")]
+    for i in range(n):
+        eid, st, name = kinds[i % len(kinds)]
+        out.append(make_state(eid.format(i), st(), name.format(i)))
+    return out
+
+
+def next_value(s):
+    v = s["state"]
+    if v in ("on", "off"):
+        return "off" if v == "on" else "on"
+    try:
+        f = float(v)
+        return ("%.1f" % (f + random.uniform(-0.5, 0.5))) if "." in v \
+            else str(max(0, int(f) + random.randint(-3, 3)))
+    except ValueError:
+        return v
+
+
+# ---------------------------------------------------------------------------
+# Frame WebSocket (server → client: non mascherati)
+# ---------------------------------------------------------------------------
+def ws_frame(payload, op=0x1, frag=0):
+    """frag > 0: spezza il messaggio in frame da frag byte (test client)."""
+    if isinstance(payload, str):
+        payload = payload.encode()
+    chunks = [payload[i:i + frag] for i in range(0, len(payload), frag)] \
+        if frag and len(payload) > frag else [payload]
+    out = b""
+    for i, c in enumerate(chunks):
+        fin = 0x80 if i == len(chunks) - 1 else 0
+        code = op if i == 0 else 0x0
+        n = len(c)
+        if n < 126:
+            hdr = struct.pack("!BB", fin | code, n)
+        elif n < 65536:
+            hdr = struct.pack("!BBH", fin | code, 126, n)
+        else:
+            hdr = struct.pack("!BBQ", fin | code, 127, n)
+        out += hdr + c
+    return out
+
+
+async def ws_read(reader):
+    """Ritorna (opcode, payload) di un frame client (mascherato)."""
+    b0, b1 = await reader.readexactly(2)
+    op = b0 & 0x0F
+    n = b1 & 0x7F
+    if n == 126:
+        n = struct.unpack("!H", await reader.readexactly(2))[0]
+    elif n == 127:
+        n = struct.unpack("!Q", await reader.readexactly(8))[0]
+    mask = await reader.readexactly(4) if b1 & 0x80 else b"\0\0\0\0"
+    data = bytearray(await reader.readexactly(n))
+    for i in range(n):
+        data[i] ^= mask[i & 3]
+    return op, bytes(data)
+
+
+# ---------------------------------------------------------------------------
+# Server
+# ---------------------------------------------------------------------------
+class MockHA:
+    def __init__(self, cfg, states):
+        self.cfg = cfg
+        self.states = {s["entity_id"]: s for s in states}
+
+    def log(self, *a):
+        if not self.cfg.quiet:
+            print("[ha]", *a, file=sys.stderr)
+
+    async def handle(self, reader, writer):
+        try:
+            head = await reader.readuntil(b"\r\n\r\n")
+        except (asyncio.IncompleteReadError, asyncio.LimitOverrunError):
+            writer.close()
+            return
+
+        lines = head.decode("latin-1").split("\r\n")
+        method, path = (lines[0].split(" ") + ["", ""])[:2]
+        hdrs = {}
+        for ln in lines[1:]:
+            if ":" in ln:
+                k, v = ln.split(":", 1)
+                hdrs[k.strip().lower()] = v.strip()
+
+        if path.startswith("/api/websocket") and "sec-websocket-key" in hdrs:
+            await self.websocket(reader, writer, hdrs["sec-websocket-key"])
+        elif path.startswith("/api/states"):
+            await self.rest(writer, hdrs, path)
+        else:
+            writer.write(b"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+                         b"Connection: close\r\n\r\n")
+        try:
+            await writer.drain()
+        except ConnectionError:
+            pass
+        writer.close()
+
+    async def rest(self, writer, hdrs, path):
+        auth = hdrs.get("authorization", "")
+        if self.cfg.token and auth != "Bearer " + self.cfg.token:
+            writer.write(b"HTTP/1.1 401 Unauthorized\r\nContent-Length: 0\r\n"
+                         b"Connection: close\r\n\r\n")
+            return
+        eid = path[len("/api/states/"):] if path.startswith("/api/states/") else ""
+        if eid and eid not in self.states:
+            writer.write(b"HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\n"
+                         b"Connection: close\r\n\r\n")
+            self.log("REST", path, "404")
+            return
+        data = self.states[eid] if eid else list(self.states.values())
+        body = json.dumps(data).encode()
+        writer.write(b"HTTP/1.1 200 OK\r\nContent-Type: application/json\r\n"
+                     b"Content-Length: %d\r\nConnection: close\r\n\r\n"
+                     % len(body) + body)
+        self.log("REST", path, len(body), "byte")
+
+    async def websocket(self, reader, writer, key):
+        acc = base64.b64encode(
+            hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+        writer.write(("HTTP/1.1 101 Switching Protocols\r\n"
+                      "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                      "Sec-WebSocket-Accept: %s\r\n\r\n" % acc).encode())
+
+        frag = self.cfg.fragment
+
+        def send(obj):
+            writer.write(ws_frame(json.dumps(obj), frag=frag))
+
+        send({"type": "auth_required", "ha_version": "2024.10.0"})
+        await writer.drain()
+
+        subscribed = None
+        pusher = None
+        last_id = 0
+        try:
+            while True:
+                op, data = await ws_read(reader)
+                if op == 0x8:
+                    writer.write(ws_frame(data[:2], op=0x8))
+                    break
+                if op == 0x9:
+                    writer.write(ws_frame(data, op=0xA))
+                    continue
+                if op != 0x1:
+                    continue
+
+                msg = json.loads(data)
+                t = msg.get("type")
+                self.log("<-", t, msg.get("id", ""))
+
+                if t == "auth":
+                    if self.cfg.token and msg.get("access_token") != self.cfg.token:
+                        send({"type": "auth_invalid", "message": "Invalid access token"})
+                        await writer.drain()
+                        break
+                    send({"type": "auth_ok", "ha_version": "2024.10.0"})
+                    await writer.drain()
+                    if self.cfg.ping:
+                        writer.write(ws_frame(b"hi", op=0x9))
+                    continue
+
+                mid = msg.get("id", 0)
+                if mid <= last_id:
+                    send({"id": mid, "type": "result", "success": False,
+                          "error": {"code": "id_reuse",
+                                    "message": "Identifier values have to increase."}})
+                    continue
+                last_id = mid
+
+                if t == "get_states":
+                    send({"id": mid, "type": "result", "success": True,
+                          "result": list(self.states.values())})
+                elif t == "subscribe_events":
+                    subscribed = mid
+                    send({"id": mid, "type": "result", "success": True,
+                          "result": None})
+                    pusher = asyncio.ensure_future(self.push(writer, mid))
+                elif t == "ping":
+                    send({"id": mid, "type": "pong"})
+                else:
+                    send({"id": mid, "type": "result", "success": False,
+                          "error": {"code": "unknown_command"}})
+                await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError, json.JSONDecodeError):
+            pass
+        finally:
+            if pusher:
+                pusher.cancel()
+            self.log("websocket chiuso", "(subscribe id %s)" % subscribed)
+
+    async def push(self, writer, sub_id):
+        """state_changed casuali a --rate eventi/s."""
+        ids = list(self.states)
+        while True:
+            await asyncio.sleep(1.0 / self.cfg.rate)
+            eid = random.choice(ids)
+            old = self.states[eid]
+            new = dict(old, state=next_value(old),
+                       last_changed=now_iso(), last_updated=now_iso())
+            self.states[eid] = new
+            ev = {"id": sub_id, "type": "event",
+                  "event": {"event_type": "state_changed",
+                            "data": {"entity_id": eid, "old_state": old,
+                                     "new_state": new},
+                            "origin": "LOCAL", "time_fired": now_iso()}}
+            try:
+                writer.write(ws_frame(json.dumps(ev), frag=self.cfg.fragment))
+                await writer.drain()
+            except ConnectionError:
+                return
+            self.log("->", eid, new["state"])
+
+
+def main():
+    ap = argparse.ArgumentParser(description="SquaredCoso Home Assistant stand-in")
+    ap.add_argument("--bind", default="0.0.0.0")
+    ap.add_argument("--port", type=int, default=8123)
+    ap.add_argument("--token", default="", help="token atteso (vuoto = qualsiasi)")
+    ap.add_argument("--states", help="JSON di /api/states da usare come base")
+    ap.add_argument("--entities", type=int, default=40,
+                    help="entità generate se --states non è indicato")
+    ap.add_argument("--rate", type=float, default=1.0, help="eventi al secondo")
+    ap.add_argument("--fragment", type=int, default=0,
+                    help="spezza i messaggi in frame da N byte")
+    ap.add_argument("--ping", action="store_true",
+                    help="invia un ping WebSocket dopo auth_ok")
+    ap.add_argument("--seed", type=int)
+    ap.add_argument("--quiet", action="store_true")
+    cfg = ap.parse_args()
+
+    if cfg.seed is not None:
+        random.seed(cfg.seed)
+
+    if cfg.states:
+        with open(cfg.states, encoding="utf-8") as f:
+            states = json.load(f)
+    else:
+        states = generate_states(cfg.entities)
+
+    ha = MockHA(cfg, states)
+
+    async def run():
+        srv = await asyncio.start_server(ha.handle, cfg.bind, cfg.port)
+        print(f"[ha] stand-in su {cfg.bind}:{cfg.port} · {len(states)} entità")
+        async with srv:
+            await srv.serve_forever()
+
+    try:
+        asyncio.run(run())
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
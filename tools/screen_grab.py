@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+SquaredCoso — cattura dello schermo da /screen.bin
+
+Scarica il framebuffer del pannello in formato SQF1 (RGB565, righe
+PackBits), poi in modalità --watch chiede solo le righe cambiate
+(?since=<generazione>) e ricostruisce il frame in locale. Ogni frame
+viene salvato come PNG (solo libreria standard).
+
+    python3 tools/screen_grab.py 192.168.1.42 -o pannello.png
+    python3 tools/screen_grab.py 192.168.1.42 -o pannello.png --watch 2
+
+Autore: Davide “gat” Nasato
+Repository: https://github.com/davidegat/SquaredCoso
+Licenza: CC BY-NC 4.0
+"""
+
+import argparse
+import struct
+import sys
+import time
+import urllib.error
+import urllib.request
+import zlib
+
+
+# ---------------------------------------------------------------------------
+# Decodifica SQF1
+# ---------------------------------------------------------------------------
+def decode(data, frame):
+    """Applica un frame SQF1 a frame (lista di righe); ritorna gen, base, righe."""
+    if data[:4] != b"SQF1":
+        raise ValueError("formato sconosciuto")
+    w, h, gen, base = struct.unpack_from("<HHII", data, 4)
+    if base == 0 or len(frame) != h:
+        frame[:] = [[0] * w for _ in range(h)]
+
+    i, rows = 16, 0
+    while True:
+        (y,) = struct.unpack_from("<H", data, i)
+        i += 2
+        if y == 0xFFFF:
+            break
+        row = []
+        while len(row) < w:
+            c = data[i]
+            i += 1
+            if c & 0x80:
+                (p,) = struct.unpack_from("<H", data, i)
+                i += 2
+                row += [p] * ((c & 0x7F) + 1)
+            else:
+                n = c + 1
+                row += struct.unpack_from("<%dH" % n, data, i)
+                i += 2 * n
+        frame[y] = row[:w]
+        rows += 1
+    return gen, base, rows
+
+
+# ---------------------------------------------------------------------------
+# PNG RGB minimale
+# ---------------------------------------------------------------------------
+def rgb(p):
+    r, g, b = p >> 11, (p >> 5) & 63, p & 31
+    return (r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)
+
+
+def write_png(path, frame):
+    h, w = len(frame), len(frame[0])
+    raw = bytearray()
+    for row in frame:
+        raw.append(0)
+        for p in row:
+            raw += bytes(rgb(p))
+
+    def chunk(t, d):
+        return (struct.pack(">I", len(d)) + t + d +
+                struct.pack(">I", zlib.crc32(t + d)))
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(bytes(raw), 6)))
+        f.write(chunk(b"IEND", b""))
+
+
+# ---------------------------------------------------------------------------
+# Main
+# ---------------------------------------------------------------------------
+def grab(host, since, timeout):
+    url = "http://%s/screen.bin" % host
+    if since:
+        url += "?since=%d" % since
+    with urllib.request.urlopen(url, timeout=timeout) as r:
+        return r.read()
+
+
+def main():
+    ap = argparse.ArgumentParser(description="SquaredCoso screen capture")
+    ap.add_argument("host")
+    ap.add_argument("-o", "--out", default="screen.png")
+    ap.add_argument("--watch", type=float, default=0,
+                    help="secondi fra un frame e l'altro (0 = un solo frame)")
+    ap.add_argument("--timeout", type=float, default=10)
+    cfg = ap.parse_args()
+
+    frame, gen = [], 0
+    while True:
+        t0 = time.monotonic()
+        try:
+            data = grab(cfg.host, gen, cfg.timeout)
+        except urllib.error.HTTPError as e:
+            if e.code != 429:
+                raise
+            time.sleep(1)  # limite del pannello: un frame al secondo
+            continue
+        gen, base, rows = decode(data, frame)
+        ms = (time.monotonic() - t0) * 1000
+        write_png(cfg.out, frame)
+        print("gen %d %s: %d righe, %d byte, %.0f ms" % (
+            gen, "delta" if base else "completo", rows, len(data), ms))
+        if not cfg.watch:
+            return 0
+        time.sleep(cfg.watch)
+
+
+if __name__ == "__main__":
+    try:
+        sys.exit(main())
+    except KeyboardInterrupt:
+        sys.exit(0)
@@ -0,0 +1,166 @@
+// SquaredCoso — dashboard (modalità STA): disegnata nel browser da
+// /api/state (ogni 5 s) e /api/config; le pagine si attivano con PATCH.
+
+const TXT = {
+  it: {
+    status: 'Stato pannello', page: 'Pagina corrente', next: 'Prossimo cambio',
+    uptime: 'Acceso da', heap: 'Heap libero', rssi: 'Segnale Wi-Fi',
+    pages: 'Pagine', age: 'dati di', never: 'mai',
+    live: 'Dati correnti', weather: 'Meteo', btc: 'Bitcoin', qod: 'Frase del giorno',
+    news: 'News', cal: 'Calendario', ha: 'Home Assistant', note: 'Post-it',
+    profile: 'Profilo pannello', city: 'Città', lang: 'Lingua interfaccia',
+    fiat: 'Valuta base', ics: 'Calendario ICS', interval: 'Intervallo cambio pagina',
+    cds: 'Countdown configurati', none: 'Nessun countdown attivo',
+    settings: 'Apri impostazioni', offline: 'Pannello non raggiungibile'
+  },
+  en: {
+    status: 'Panel status', page: 'Current page', next: 'Next switch',
+    uptime: 'Uptime', heap: 'Free heap', rssi: 'Wi-Fi signal',
+    pages: 'Pages', age: 'data from', never: 'never',
+    live: 'Live data', weather: 'Weather', btc: 'Bitcoin', qod: 'Quote of the Day',
+    news: 'News', cal: 'Calendar', ha: 'Home Assistant', note: 'Sticky Note',
+    profile: 'Panel profile', city: 'City', lang: 'UI language',
+    fiat: 'Base currency', ics: 'ICS calendar URL', interval: 'Page switch interval',
+    cds: 'Configured countdowns', none: 'No active countdowns',
+    settings: 'Open settings', offline: 'Panel unreachable'
+  }
+};
+
+const NAMES = {
+  it: {
+    WEATHER: 'Meteo', AIR: 'Aria', CLOCK: 'Orologio', BINARY: 'Orologio Binario',
+    CAL: 'Calendario ICS', BTC: 'Bitcoin', QOD: 'Frase del giorno', INFO: 'Info',
+    COUNT: 'Countdown', FX: 'Valute', T24: 'T24', SUN: 'Ore di luce', NEWS: 'News',
+    HA: 'Home Assistant', STELLAR: 'Sistema Solare', NOTES: 'Post-it', CHRONOS: 'Chronos'
+  },
+  en: {
+    WEATHER: 'Weather', AIR: 'Air', CLOCK: 'Clock', BINARY: 'Binary Clock',
+    CAL: 'Calendar', BTC: 'Bitcoin', QOD: 'Quote of the Day', INFO: 'Info',
+    COUNT: 'Countdown', FX: 'FX', T24: 'T24', SUN: 'Sunlight', NEWS: 'News',
+    HA: 'Home Assistant', STELLAR: 'Solar System', NOTES: 'Sticky Note', CHRONOS: 'Chronos'
+  }
+};
+
+let cfg = null;
+let st = null;
+
+// Elemento con testo (textContent: nessun escape da gestire)
+function el(tag, cls, text) {
+  const e = document.createElement(tag);
+  if (cls) e.className = cls;
+  if (text !== undefined) e.textContent = text;
+  return e;
+}
+
+function card(label) {
+  const c = el('div', 'card');
+  c.appendChild(el('div', 'label', label));
+  return c;
+}
+
+function kv(parent, key, value) {
+  const d = el('div', 'kv');
+  d.appendChild(el('b', '', key + ':'));
+  d.appendChild(document.createTextNode(' ' + (value === '' || value == null ? '-' : value)));
+  parent.appendChild(d);
+}
+
+function dur(s) {
+  if (s == null) return null;
+  if (s < 90) return s + ' s';
+  if (s < 5400) return Math.round(s / 60) + ' min';
+  if (s < 172800) return Math.round(s / 3600) + ' h';
+  return Math.round(s / 86400) + ' d';
+}
+
+function setPage(key, on) {
+  const body = {};
+  body['p_' + key] = on;
+  fetch('/api/config', {
+    method: 'PATCH',
+    headers: { 'Content-Type': 'application/json' },
+    body: JSON.stringify(body)
+  }).then(r => r.json()).then(c => { cfg = c; load(); });
+}
+
+function render() {
+  const T = TXT[cfg.lang] || TXT.it;
+  const N = NAMES[cfg.lang] || NAMES.it;
+  const d = st.data;
+  const app = el('div');
+
+  // --- Stato ---
+  const s = card(T.status);
+  kv(s, T.page, N[st.page] || st.page);
+  kv(s, T.next, dur(st.next_s));
+  kv(s, T.uptime, dur(st.uptime));
+  kv(s, T.heap, Math.round(st.metrics.heap / 1024) + ' KB');
+  kv(s, T.rssi, st.metrics.rssi + ' dBm');
+  app.appendChild(s);
+
+  // --- Pagine: attivazione immediata + età dei dati ---
+  const p = card(T.pages);
+  const g = el('div', 'grid-pages');
+  st.pages.forEach(pg => {
+    const l = el('label', 'chk');
+    const c = el('input');
+    c.type = 'checkbox';
+    c.checked = pg.on;
+    c.onchange = () => setPage(pg.key, c.checked);
+    l.appendChild(c);
+    l.appendChild(el('span', '', N[pg.key] || pg.key));
+    if (pg.age != null) l.appendChild(el('small', '', T.age + ' ' + dur(pg.age)));
+    g.appendChild(l);
+  });
+  p.appendChild(g);
+  app.appendChild(p);
+
+  // --- Dati correnti ---
+  const v = card(T.live);
+  if (d.weather.temp != null) kv(v, T.weather, d.weather.temp + ' °C ' + d.weather.desc);
+  if (d.btc.price != null) kv(v, T.btc, d.btc.price + ' ' + cfg.fiat);
+  if (d.qod.text) kv(v, T.qod, d.qod.text + (d.qod.author ? ' — ' + d.qod.author : ''));
+  if (d.news.length) kv(v, T.news, d.news[0]);
+  d.cal.slice(0, 3).forEach(e =>
+    kv(v, T.cal, new Date(e.start * 1000).toLocaleString(cfg.lang) + ' ' + e.summary));
+  d.ha.forEach(h => kv(v, h.name, h.state));
+  if (d.note) kv(v, T.note, d.note);
+  app.appendChild(v);
+
+  // --- Profilo ---
+  const f = card(T.profile);
+  kv(f, T.city, cfg.city);
+  kv(f, T.lang, cfg.lang);
+  kv(f, T.fiat, cfg.fiat);
+  kv(f, T.ics, cfg.ics);
+  kv(f, T.interval, cfg.page_s + ' s');
+  app.appendChild(f);
+
+  // --- Countdown ---
+  const k = card(T.cds);
+  let n = 0;
+  for (let i = 1; i <= 8; i++) {
+    if (!cfg['cd' + i + 'n'] && !cfg['cd' + i + 't']) continue;
+    kv(k, cfg['cd' + i + 'n'], cfg['cd' + i + 't'].replace('T', ' '));
+    n++;
+  }
+  if (!n) k.appendChild(el('p', 'value', T.none));
+  app.appendChild(k);
+
+  document.getElementById('app').replaceWith(app);
+  app.id = 'app';
+  document.getElementById('set').textContent = T.settings;
+}
+
+function load() {
+  const get = u => fetch(u).then(r => r.json());
+  Promise.all([st && cfg ? cfg : get('/api/config'), get('/api/state')])
+    .then(([c, s]) => { cfg = c; st = s; render(); })
+    .catch(() => {
+      const a = document.getElementById('app');
+      a.textContent = (TXT[cfg && cfg.lang] || TXT.it).offline;
+    });
+}
+
+load();
+setInterval(load, 5000);
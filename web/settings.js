@@ -0,0 +1,59 @@
+// SquaredCoso — pagina impostazioni: seleziona / deseleziona tutte le pagine
+document.getElementById('toggleAll').onclick = function () {
+  const boxes = document.querySelectorAll('.grid-pages input[type=checkbox]');
+  let allChecked = true;
+  boxes.forEach(b => { if (!b.checked) allChecked = false; });
+  boxes.forEach(b => { b.checked = !allChecked; });
+};
+
+// Salvataggio: solo i campi cambiati via PATCH /api/config, senza ricaricare
+// la pagina; se l'API non risponde si ripiega sul POST classico del form.
+(function () {
+  const form = document.querySelector('form[action="/settings"]');
+
+  function snapshot() {
+    const o = {};
+    for (const e of form.elements) {
+      if (!e.name) continue;
+      o[e.name] = e.type === 'checkbox' ? e.checked : e.value;
+    }
+    return o;
+  }
+
+  function notice(text) {
+    let a = document.querySelector('main > .alert');
+    if (!a) {
+      a = document.createElement('div');
+      document.querySelector('main').prepend(a);
+    }
+    a.className = 'alert ok';
+    a.textContent = text;
+  }
+
+  let saved = snapshot();
+
+  form.addEventListener('submit', ev => {
+    if (ev.submitter && ev.submitter.hasAttribute('formaction')) return;
+    ev.preventDefault();
+
+    const now = snapshot();
+    const diff = {};
+    for (const k in now) if (now[k] !== saved[k]) diff[k] = now[k];
+    if (!Object.keys(diff).length) {
+      notice(form.dataset.applied);
+      return;
+    }
+
+    fetch('/api/config', {
+      method: 'PATCH',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify(diff)
+    })
+      .then(r => r.ok ? r.json() : Promise.reject(r.status))
+      .then(() => {
+        saved = now;
+        notice(form.dataset.applied);
+      })
+      .catch(() => form.submit());
+  });
+})();